@@ -0,0 +1,101 @@
+// Configuration parser benchmark
+//
+// Times ConfigManager::loadFromString() on the shipped node_config.json and
+// on a synthetic ~2 MB document (thousands of unknown records the binder
+// has to skip) to check the parser stays linear in input size.
+//
+// Usage: sentinel_config_bench [config.json] [iterations]
+
+#include "core/config_manager.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace sentinel;
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Build a large but valid config: the real schema followed by thousands of
+// site survey records the binder must skip.
+std::string makeLargeConfig(const std::string& base, int records) {
+    std::string doc = base;
+    size_t end = doc.rfind('}');
+    if (end == std::string::npos) {
+        return doc;
+    }
+    doc.resize(end);
+
+    std::ostringstream extra;
+    extra << ",\n  \"site_survey\": [\n";
+    for (int i = 0; i < records; i++) {
+        extra << "    {\"id\": " << i
+              << ", \"label\": \"tower-" << i << "\\/north\""
+              << ", \"rssi\": [-" << (60 + i % 40) << ", -" << (70 + i % 30) << "]"
+              << ", \"snr\": " << (i % 20) * 0.25
+              << ", \"active\": " << ((i % 3) ? "true" : "false") << "}"
+              << (i + 1 < records ? ",\n" : "\n");
+    }
+    extra << "  ]\n}\n";
+    doc += extra.str();
+    return doc;
+}
+
+void runCase(const char* name, const std::string& doc, int iterations) {
+    ConfigManager manager;
+
+    // Warm-up (also validates the document)
+    if (!manager.loadFromString(doc, name)) {
+        std::cerr << name << ": parse failed: " << manager.getLastError() << std::endl;
+        std::exit(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        manager.loadFromString(doc, name);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    double total_us = std::chrono::duration<double, std::micro>(elapsed).count();
+    double per_parse_us = total_us / iterations;
+    double mb_per_sec = (static_cast<double>(doc.size()) * iterations) / total_us;
+
+    std::cout << name << ": " << doc.size() << " bytes, "
+              << per_parse_us << " us/parse, "
+              << mb_per_sec << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string config_path = std::string(SENTINEL_SOURCE_DIR) + "/configs/node_config.json";
+    int iterations = 2000;
+
+    if (argc > 1) config_path = argv[1];
+    if (argc > 2) iterations = std::atoi(argv[2]);
+
+    // Unknown-key warnings would dominate the timing
+    Logger::setLevel(LogLevel::ERROR);
+
+    std::string base = readFile(config_path);
+    if (base.empty()) {
+        std::cerr << "Cannot read " << config_path << std::endl;
+        return 1;
+    }
+
+    runCase("node_config", base, iterations);
+    runCase("large_config", makeLargeConfig(base, 20000), std::max(1, iterations / 200));
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+// Night mode CPU savings on replayed day/night footage
+//
+// Replays the same footage through a SmokeDetector twice, once with
+// vision.night_mode off and once with it on, and measures process CPU
+// time (all threads, TFLite's included) per frame. With night mode, frames
+// are split by the mode they were handled in, and night frames by whether
+// the glow detector let the model run. The footage is taken as a sample
+// of a whole day (a time-lapse of 24 h works best): the day/night split
+// it shows is extrapolated to 24 h at --fps frames per second.
+//
+// The mode switch hold is 0 by default, because replay runs faster than
+// real time; hysteresis then comes from the luminance band alone.
+//
+// Usage: sentinel_daynight_bench --video FILE --model FILE [--frames N]
+//                                [--fps F] [--hold-sec S] [--light-sensor DIR]
+
+#include "vision/smoke_detector.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include <opencv2/videoio.hpp>
+#include <sys/resource.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace sentinel;
+
+namespace {
+
+double cpuSeconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct PassStats {
+    int frames = 0;
+    int day_frames = 0;
+    int night_frames = 0;
+    int night_model_runs = 0;
+    int detections = 0;
+    double cpu_total = 0.0;
+    double cpu_day = 0.0;
+    double cpu_night = 0.0;
+};
+
+bool runPass(const std::string& model_path, VisionConfig config, int frames, PassStats& stats) {
+    SmokeDetector detector(model_path, config);
+    if (!detector.initialize()) {
+        return false;
+    }
+    for (int i = 0; i < frames; i++) {
+        double start = cpuSeconds();
+        DetectionResult result = detector.detectSmoke();
+        double cpu = cpuSeconds() - start;
+
+        stats.frames++;
+        stats.cpu_total += cpu;
+        stats.detections += result.detected ? 1 : 0;
+        if (result.night) {
+            stats.night_frames++;
+            stats.cpu_night += cpu;
+            stats.night_model_runs += result.inference_time_ms > 0.0f ? 1 : 0;
+        } else {
+            stats.day_frames++;
+            stats.cpu_day += cpu;
+        }
+    }
+    detector.shutdown();
+    return true;
+}
+
+double perFrameMs(double cpu, int frames) {
+    return frames > 0 ? 1000.0 * cpu / frames : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string video_path;
+    std::string model_path;
+    std::string light_sensor;
+    int frames = 0;
+    double fps = 5.0;
+    int hold_sec = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--video" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            fps = std::atof(argv[++i]);
+        } else if (arg == "--hold-sec" && i + 1 < argc) {
+            hold_sec = std::atoi(argv[++i]);
+        } else if (arg == "--light-sensor" && i + 1 < argc) {
+            light_sensor = argv[++i];
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (video_path.empty() || model_path.empty() || fps <= 0.0) {
+        std::fprintf(stderr,
+                     "Usage: %s --video FILE --model FILE [--frames N] [--fps F] "
+                     "[--hold-sec S] [--light-sensor DIR]\n", argv[0]);
+        return 1;
+    }
+
+    // Default: the whole footage once
+    if (frames <= 0) {
+        cv::VideoCapture video(video_path);
+        frames = static_cast<int>(video.get(cv::CAP_PROP_FRAME_COUNT));
+        if (frames <= 0) {
+            std::fprintf(stderr, "Cannot count frames of %s; pass --frames\n",
+                         video_path.c_str());
+            return 1;
+        }
+    }
+
+    Logger::setLevel(LogLevel::WARN);
+    Executor::start(0);
+
+    VisionConfig config;
+    config.video_source = video_path;
+    config.night_hold_sec = hold_sec;
+    config.light_sensor = light_sensor;
+
+    PassStats off;
+    config.night_mode = false;
+    if (!runPass(model_path, config, frames, off)) {
+        Executor::stop();
+        return 1;
+    }
+    PassStats on;
+    config.night_mode = true;
+    if (!runPass(model_path, config, frames, on)) {
+        Executor::stop();
+        return 1;
+    }
+    Executor::stop();
+
+    std::printf("Day/night: %s, %d frames\n", video_path.c_str(), frames);
+    std::printf("  night mode off   %7.2f ms CPU/frame, %d detections\n",
+                perFrameMs(off.cpu_total, off.frames), off.detections);
+    std::printf("  night mode on    %7.2f ms CPU/frame, %d detections\n",
+                perFrameMs(on.cpu_total, on.frames), on.detections);
+    std::printf("    day frames     %7d  %7.2f ms CPU/frame\n", on.day_frames,
+                perFrameMs(on.cpu_day, on.day_frames));
+    std::printf("    night frames   %7d  %7.2f ms CPU/frame, model ran on %d\n",
+                on.night_frames, perFrameMs(on.cpu_night, on.night_frames),
+                on.night_model_runs);
+
+    // The footage's mix of day and night, over 24 h at fps
+    double frames_per_day = fps * 86400.0;
+    double cpu_off = frames_per_day * off.cpu_total / off.frames;
+    double cpu_on = frames_per_day * on.cpu_total / on.frames;
+    std::printf("Per 24 h at %.1f fps (%.0f%% night)\n", fps,
+                100.0 * on.night_frames / on.frames);
+    std::printf("  CPU off          %9.0f s\n", cpu_off);
+    std::printf("  CPU on           %9.0f s\n", cpu_on);
+    std::printf("  saved            %9.0f s (%.1f%%)\n", cpu_off - cpu_on,
+                cpu_off > 0.0 ? 100.0 * (cpu_off - cpu_on) / cpu_off : 0.0);
+    return 0;
+}
\ No newline at end of file
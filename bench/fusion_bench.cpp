@@ -0,0 +1,537 @@
+// Time to decision: SPRT evidence fusion against the OR of two votes
+//
+// Replays a labelled trace of sensor and vision samples through two local
+// detectors and compares how long each takes to declare a fire at the
+// same false alarm rate:
+//
+//   vote    what fusion.enabled = false does: MQ-2 3-of-5 vote above
+//           sensor.smoke_threshold_ppm, OR the 10-frame mean confidence
+//           above vision.confidence_threshold. Swept over both thresholds.
+//   sprt    EvidenceFusion with likelihoods fitted from the trace (the
+//           fitted values are printed as a fusion config). Swept over
+//           fusion.false_alarm_rate, fusion.max_step and a discount on
+//           the fitted vision scale and bias, since consecutive frames
+//           are far from independent evidence.
+//
+// For each false alarm budget the fastest setting of each detector within
+// it is reported (mean and p90 onset-to-detection time, fires missed).
+// Fusion also skips the consensus wait when peers already agree, which
+// the vote detector pays in full (--consensus-sec).
+//
+// The trace is CSV, one sample per line: "time_sec,kind,value,label" with
+// kind s (sensor PPM) or v (vision confidence) and label 0 (clean air),
+// 1 (fire) or 2 (clearing after a fire; not scored). Without --trace a
+// synthetic one is generated: 20 min of clean air with nuisance events
+// (exhaust or dust spikes on the gas sensor, fog or glare on the camera),
+// a 4 min fire whose gas and smoke arrive after random delays, and 2 min
+// of clearing, repeated --episodes times. The fit uses the first half of
+// the trace and the comparison the second half.
+//
+// Usage: sentinel_fusion_bench [--trace FILE] [--episodes N] [--seed N]
+//                              [--fps F] [--consensus-sec S]
+//                              [--write-trace FILE]
+
+#include "core/evidence_fusion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+// The vote detector's windows (MQ2Sensor::DETECTION_WINDOW, and the
+// SmokeDetector confidence history)
+constexpr int SENSOR_WINDOW = 5;
+constexpr int SENSOR_VOTES = 3;
+constexpr int VISION_WINDOW = 10;
+
+enum Label : uint8_t { CLEAN = 0, FIRE = 1, CLEARING = 2 };
+
+struct Sample {
+    double time;
+    bool vision;
+    float value;                     // PPM or confidence
+    uint8_t label;
+};
+
+using Trace = std::vector<Sample>;
+
+// --- Synthetic trace ---
+
+float logit(float p) {
+    p = std::clamp(p, 1e-4f, 1.0f - 1e-4f);
+    return std::log(p / (1.0f - p));
+}
+
+float sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+void syntheticTrace(int episodes, double fps, uint32_t seed, Trace& trace) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    constexpr double CLEAN_SEC = 1200.0;
+    constexpr double FIRE_SEC = 240.0;
+    constexpr double CLEARING_SEC = 120.0;
+    constexpr float CLEAN_LOG_PPM = 1.6f;        // ~40 PPM
+    constexpr float CLEAN_LOGIT = -2.5f;         // ~0.08 confidence
+
+    // AR(1) noise: sensor per second, vision per frame
+    float gas_noise = 0.0f;
+    float vision_noise = 0.0f;
+    const float gas_rho = 0.9f;
+    const float vision_rho = 0.95f;
+
+    double t = 0.0;
+    double frame_dt = 1.0 / fps;
+    for (int e = 0; e < episodes; e++) {
+        double fire_start = t + CLEAN_SEC;
+        double fire_end = fire_start + FIRE_SEC;
+        double end = fire_end + CLEARING_SEC;
+
+        // Fire: gas reaches the sensor after 5-60 s and climbs for 60 s to
+        // 300-1300 PPM; smoke is visible after 0-20 s and takes 20-60 s to
+        // reach full confidence
+        double gas_delay = 5.0 + 55.0 * uniform(rng);
+        float gas_peak = std::log10(300.0f + 1000.0f * uniform(rng));
+        double smoke_delay = 20.0 * uniform(rng);
+        double smoke_ramp = 20.0 + 40.0 * uniform(rng);
+        float smoke_logit = 1.5f + 1.5f * uniform(rng);
+
+        // Nuisance events in clean air: start time and length (s)
+        double spike_at = t + CLEAN_SEC * uniform(rng);
+        double spike_len = 3.0 + 5.0 * uniform(rng);
+        float spike_log = std::log10(3.0f + 5.0f * uniform(rng));
+        double fog_at = t + CLEAN_SEC * uniform(rng);
+        double fog_len = 5.0 + 15.0 * uniform(rng);
+
+        // Level of a fire signal at time x: 0 before, 1 at full strength,
+        // fading during clearing
+        auto level = [&](double x, double delay, double ramp) {
+            double onset = fire_start + delay;
+            if (x < onset) {
+                return 0.0;
+            }
+            double rise = std::min(1.0, (x - onset) / ramp);
+            if (x > fire_end) {
+                rise *= std::max(0.0, 1.0 - (x - fire_end) / 60.0);
+            }
+            return rise;
+        };
+        auto labelAt = [&](double x) {
+            return x < fire_start ? CLEAN : x < fire_end ? FIRE : CLEARING;
+        };
+
+        double next_gas = t;
+        for (double x = t; x < end; x += frame_dt) {
+            if (x >= next_gas) {
+                gas_noise = gas_rho * gas_noise + 0.15f * std::sqrt(1.0f - gas_rho * gas_rho) * normal(rng);
+                float log_ppm = CLEAN_LOG_PPM + gas_noise +
+                                static_cast<float>(level(x, gas_delay, 60.0)) * (gas_peak - CLEAN_LOG_PPM);
+                if (x >= spike_at && x < spike_at + spike_len) {
+                    log_ppm += spike_log;
+                }
+                trace.push_back({x, false, std::pow(10.0f, log_ppm), labelAt(x)});
+                next_gas += 1.0;
+            }
+            vision_noise = vision_rho * vision_noise + 1.0f * std::sqrt(1.0f - vision_rho * vision_rho) * normal(rng);
+            float z = CLEAN_LOGIT + vision_noise +
+                      static_cast<float>(level(x, smoke_delay, smoke_ramp)) * (smoke_logit - CLEAN_LOGIT);
+            if (x >= fog_at && x < fog_at + fog_len) {
+                z += 3.5f;
+            }
+            trace.push_back({x, true, sigmoid(z), labelAt(x)});
+        }
+        t = end;
+    }
+}
+
+bool readTrace(const std::string& path, Trace& trace) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string time, kind, value, label;
+        if (!std::getline(fields, time, ',') || !std::getline(fields, kind, ',') ||
+            !std::getline(fields, value, ',') || !std::getline(fields, label, ',')) {
+            std::fprintf(stderr, "Bad trace line: %s\n", line.c_str());
+            return false;
+        }
+        trace.push_back({std::atof(time.c_str()), kind == "v", std::strtof(value.c_str(), nullptr),
+                         static_cast<uint8_t>(std::atoi(label.c_str()))});
+    }
+    std::stable_sort(trace.begin(), trace.end(),
+                     [](const Sample& a, const Sample& b) { return a.time < b.time; });
+    return !trace.empty();
+}
+
+bool writeTrace(const std::string& path, const Trace& trace) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# time_sec,kind,value,label\n");
+    for (const Sample& s : trace) {
+        std::fprintf(file, "%.3f,%c,%.5g,%d\n", s.time, s.vision ? 'v' : 's', s.value, s.label);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// --- Likelihood fit ---
+
+// Sensor: log10(PPM) mean per class and pooled spread. Vision: logistic
+// regression of the label on logit(confidence) (Platt scaling), by Newton
+// iterations.
+FusionConfig fitLikelihoods(const Trace& trace, size_t begin, size_t end) {
+    FusionConfig config;
+    config.enabled = true;
+
+    double sum[2] = {0.0, 0.0};
+    double sum_sq[2] = {0.0, 0.0};
+    size_t count[2] = {0, 0};
+    for (size_t i = begin; i < end; i++) {
+        const Sample& s = trace[i];
+        if (s.vision || s.label == CLEARING) {
+            continue;
+        }
+        double x = std::log10(std::max(s.value, 0.1f));
+        sum[s.label] += x;
+        sum_sq[s.label] += x * x;
+        count[s.label]++;
+    }
+    if (count[0] > 1 && count[1] > 1) {
+        double mu0 = sum[0] / count[0];
+        double mu1 = sum[1] / count[1];
+        double var = (sum_sq[0] - count[0] * mu0 * mu0 + sum_sq[1] - count[1] * mu1 * mu1) /
+                     (count[0] + count[1] - 2);
+        config.clean_ppm = static_cast<float>(std::pow(10.0, mu0));
+        config.smoke_ppm = static_cast<float>(std::pow(10.0, mu1));
+        config.ppm_spread = static_cast<float>(std::sqrt(std::max(var, 1e-4)));
+    }
+
+    // Weighted so both classes count equally: the ratio, not the posterior
+    size_t frames[2] = {0, 0};
+    for (size_t i = begin; i < end; i++) {
+        if (trace[i].vision && trace[i].label != CLEARING) {
+            frames[trace[i].label]++;
+        }
+    }
+    if (frames[0] == 0 || frames[1] == 0) {
+        return config;
+    }
+    double weight[2] = {0.5 / frames[0], 0.5 / frames[1]};
+    double a = 1.0;
+    double b = 0.0;
+    for (int iter = 0; iter < 25; iter++) {
+        double g_a = 0.0, g_b = 0.0, h_aa = 0.0, h_ab = 0.0, h_bb = 0.0;
+        for (size_t i = begin; i < end; i++) {
+            const Sample& s = trace[i];
+            if (!s.vision || s.label == CLEARING) {
+                continue;
+            }
+            double x = logit(s.value);
+            double p = 1.0 / (1.0 + std::exp(-(a * x + b)));
+            double w = weight[s.label];
+            double r = p - s.label;
+            g_a += w * r * x;
+            g_b += w * r;
+            double v = w * p * (1.0 - p);
+            h_aa += v * x * x;
+            h_ab += v * x;
+            h_bb += v;
+        }
+        double det = h_aa * h_bb - h_ab * h_ab;
+        if (std::fabs(det) < 1e-12) {
+            break;
+        }
+        a -= (h_bb * g_a - h_ab * g_b) / det;
+        b -= (h_aa * g_b - h_ab * g_a) / det;
+    }
+    config.vision_scale = static_cast<float>(std::clamp(a, 0.0, 10.0));
+    config.vision_bias = static_cast<float>(std::clamp(b, -20.0, 20.0));
+    return config;
+}
+
+// --- Scoring ---
+
+struct Score {
+    double false_alarms_per_hour = 0.0;
+    double mean_ttd = 0.0;           // Onset to detection (s), detected fires
+    double p90_ttd = 0.0;
+    int fires = 0;
+    int missed = 0;
+    std::string setting;
+};
+
+// Replays samples [begin, end) through decide(sample) -> detected and
+// scores rising edges: in clean air as false alarms, in a fire as the
+// detection of that fire.
+template <typename Decide>
+Score score(const Trace& trace, size_t begin, size_t end, Decide decide) {
+    Score result;
+    std::vector<double> ttd;
+    double clean_sec = 0.0;
+    int false_alarms = 0;
+    bool detected = false;
+    bool in_fire = false;
+    bool fire_found = false;
+    double onset = 0.0;
+    double last_time = trace[begin].time;
+    for (size_t i = begin; i < end; i++) {
+        const Sample& s = trace[i];
+        if (s.label == CLEAN) {
+            clean_sec += s.time - last_time;
+        }
+        last_time = s.time;
+
+        if (s.label == FIRE && !in_fire) {
+            in_fire = true;
+            fire_found = detected;
+            onset = s.time;
+            result.fires++;
+            if (fire_found) {
+                ttd.push_back(0.0);
+            }
+        } else if (s.label != FIRE && in_fire) {
+            in_fire = false;
+            result.missed += fire_found ? 0 : 1;
+        }
+
+        bool now = decide(s);
+        if (now && !detected) {
+            if (s.label == CLEAN) {
+                false_alarms++;
+            } else if (in_fire && !fire_found) {
+                fire_found = true;
+                ttd.push_back(s.time - onset);
+            }
+        }
+        detected = now;
+    }
+    if (in_fire && !fire_found) {
+        result.missed++;
+    }
+
+    result.false_alarms_per_hour = clean_sec > 0.0 ? false_alarms * 3600.0 / clean_sec : 0.0;
+    if (!ttd.empty()) {
+        double total = 0.0;
+        for (double d : ttd) {
+            total += d;
+        }
+        result.mean_ttd = total / ttd.size();
+        std::sort(ttd.begin(), ttd.end());
+        result.p90_ttd = ttd[std::min(ttd.size() - 1, ttd.size() * 9 / 10)];
+    }
+    return result;
+}
+
+Score scoreVote(const Trace& trace, size_t begin, size_t end, float ppm_threshold,
+                float confidence_threshold) {
+    bool votes[SENSOR_WINDOW] = {};
+    float confidences[VISION_WINDOW] = {};
+    int vote_pos = 0, vote_count = 0, votes_total = 0;
+    int conf_pos = 0, conf_count = 0;
+    float conf_sum = 0.0f;
+    bool sensor_detected = false;
+    bool vision_detected = false;
+    Score result = score(trace, begin, end, [&](const Sample& s) {
+        if (s.vision) {
+            conf_sum += s.value - (conf_count == VISION_WINDOW ? confidences[conf_pos] : 0.0f);
+            confidences[conf_pos] = s.value;
+            conf_pos = (conf_pos + 1) % VISION_WINDOW;
+            conf_count = std::min(conf_count + 1, VISION_WINDOW);
+            vision_detected = conf_sum / conf_count > confidence_threshold;
+        } else {
+            bool vote = s.value > ppm_threshold;
+            votes_total += vote - (vote_count == SENSOR_WINDOW ? votes[vote_pos] : 0);
+            votes[vote_pos] = vote;
+            vote_pos = (vote_pos + 1) % SENSOR_WINDOW;
+            vote_count = std::min(vote_count + 1, SENSOR_WINDOW);
+            sensor_detected = votes_total >= SENSOR_VOTES;
+        }
+        return sensor_detected || vision_detected;
+    });
+    char setting[64];
+    std::snprintf(setting, sizeof(setting), "%.0f PPM, %.2f", ppm_threshold, confidence_threshold);
+    result.setting = setting;
+    return result;
+}
+
+Score scoreSprt(const Trace& trace, size_t begin, size_t end, const FusionConfig& config) {
+    EvidenceFusion fusion(config);
+    Score result = score(trace, begin, end, [&](const Sample& s) {
+        if (s.vision) {
+            fusion.addVision(s.value);
+        } else {
+            fusion.addSensor(s.value);
+        }
+        return fusion.detected();
+    });
+    char setting[64];
+    std::snprintf(setting, sizeof(setting), "alpha %.0e, vision %.3f x + %.3f, step %.1f",
+                  config.false_alarm_rate, config.vision_scale, config.vision_bias,
+                  config.max_step);
+    result.setting = setting;
+    return result;
+}
+
+// Fastest setting within a false alarm budget; fewest misses first
+const Score* fastest(const std::vector<Score>& scores, double budget) {
+    const Score* best = nullptr;
+    for (const Score& s : scores) {
+        if (s.false_alarms_per_hour > budget || s.fires == s.missed) {
+            continue;
+        }
+        if (!best || s.missed < best->missed ||
+            (s.missed == best->missed && s.mean_ttd < best->mean_ttd)) {
+            best = &s;
+        }
+    }
+    return best;
+}
+
+void printScore(const char* name, const Score* s) {
+    if (!s) {
+        std::printf("  %-5s  none within budget\n", name);
+        return;
+    }
+    std::printf("  %-5s  %6.3f FA/h  mean %6.1f s  p90 %6.1f s  missed %d/%d  (%s)\n", name,
+                s->false_alarms_per_hour, s->mean_ttd, s->p90_ttd, s->missed, s->fires,
+                s->setting.c_str());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string trace_path;
+    std::string write_path;
+    int episodes = 200;
+    uint32_t seed = 1;
+    double fps = 5.0;
+    double consensus_sec = 5.0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--episodes" && i + 1 < argc) {
+            episodes = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "--fps" && i + 1 < argc) {
+            fps = std::atof(argv[++i]);
+        } else if (arg == "--consensus-sec" && i + 1 < argc) {
+            consensus_sec = std::atof(argv[++i]);
+        } else if (arg == "--write-trace" && i + 1 < argc) {
+            write_path = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--trace FILE] [--episodes N] [--seed N] [--fps F] "
+                         "[--consensus-sec S] [--write-trace FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (episodes < 2 || fps <= 0.0) {
+        std::fprintf(stderr, "Need at least 2 episodes and a positive fps\n");
+        return 1;
+    }
+
+    Trace trace;
+    if (!trace_path.empty()) {
+        if (!readTrace(trace_path, trace)) {
+            std::fprintf(stderr, "Cannot read trace %s\n", trace_path.c_str());
+            return 1;
+        }
+    } else {
+        syntheticTrace(episodes, fps, seed, trace);
+    }
+    if (!write_path.empty() && !writeTrace(write_path, trace)) {
+        std::fprintf(stderr, "Cannot write %s\n", write_path.c_str());
+        return 1;
+    }
+
+    // Fit on the first half, compare on the second (split in clean air)
+    size_t split = trace.size() / 2;
+    while (split < trace.size() && trace[split].label != CLEAN) {
+        split++;
+    }
+    if (split == trace.size()) {
+        std::fprintf(stderr, "Trace has no clean air after its midpoint\n");
+        return 1;
+    }
+    FusionConfig fitted = fitLikelihoods(trace, 0, split);
+
+    std::printf("Trace: %s, %zu samples, %.1f h\n",
+                trace_path.empty() ? "synthetic" : trace_path.c_str(), trace.size(),
+                (trace.back().time - trace.front().time) / 3600.0);
+    std::printf("Fitted fusion config (first half):\n");
+    std::printf("  \"clean_ppm\": %.1f, \"smoke_ppm\": %.1f, \"ppm_spread\": %.3f,\n",
+                fitted.clean_ppm, fitted.smoke_ppm, fitted.ppm_spread);
+    std::printf("  \"vision_scale\": %.3f, \"vision_bias\": %.3f\n",
+                fitted.vision_scale, fitted.vision_bias);
+
+    std::vector<Score> vote;
+    for (float ppm = 100.0f; ppm <= 1000.0f; ppm += 50.0f) {
+        for (float confidence = 0.5f; confidence < 0.99f; confidence += 0.05f) {
+            vote.push_back(scoreVote(trace, split, trace.size(), ppm, confidence));
+        }
+    }
+    // The fit treats frames as independent, which they are not: vision
+    // evidence is also swept with a discount
+    std::vector<Score> sprt;
+    for (float max_step : {3.0f, 1.0f}) {
+        for (float discount : {1.0f, 0.5f, 0.25f, 0.125f, 0.0625f}) {
+            for (int exponent = 1; exponent <= 12; exponent++) {
+                for (float mantissa : {1.0f, 3.0f}) {
+                    FusionConfig config = fitted;
+                    config.max_step = max_step;
+                    config.vision_scale *= discount;
+                    config.vision_bias *= discount;
+                    config.false_alarm_rate = mantissa * std::pow(10.0f, -static_cast<float>(exponent));
+                    if (config.false_alarm_rate <= 0.5f) {
+                        sprt.push_back(scoreSprt(trace, split, trace.size(), config));
+                    }
+                }
+            }
+        }
+    }
+
+    // Budgets: what the defaults (200 PPM, 0.75) achieve, and fixed rates
+    Score defaults = scoreVote(trace, split, trace.size(), 200.0f, 0.75f);
+    std::printf("Vote detector at the defaults: %.3f false alarms/h, mean %.1f s, missed %d/%d\n",
+                defaults.false_alarms_per_hour, defaults.mean_ttd, defaults.missed,
+                defaults.fires);
+
+    std::vector<double> budgets = {defaults.false_alarms_per_hour, 1.0, 0.3, 0.1, 0.03, 0.0};
+    for (double budget : budgets) {
+        std::printf("False alarm budget %.3f/h\n", budget);
+        const Score* v = fastest(vote, budget);
+        const Score* f = fastest(sprt, budget);
+        printScore("vote", v);
+        printScore("sprt", f);
+        if (v && f && v->mean_ttd > 0.0) {
+            std::printf("  time to decision %+.0f%%; to alert with peers agreeing %+.0f%% "
+                        "(vote waits %.0f s for consensus)\n",
+                        100.0 * (f->mean_ttd - v->mean_ttd) / v->mean_ttd,
+                        100.0 * (f->mean_ttd - (v->mean_ttd + consensus_sec)) /
+                            (v->mean_ttd + consensus_sec),
+                        consensus_sec);
+        }
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+// Interpreter pool: memory per interpreter and throughput scaling
+//
+// Memory: builds interpreters one at a time, pooled (one mapped model) and
+// then as separate TFLiteInference instances (one model each), invoking
+// each once so its weights and arena are resident, and prints the resident
+// set after every step. Throughput: 1 to N threads each check an
+// interpreter out of the pool and invoke it in a loop, one inference thread
+// per interpreter; prints invokes/sec and the speedup over one caller.
+//
+// Usage: sentinel_pool_bench --model FILE [--max N] [--seconds S]
+
+#include "vision/interpreter_pool.h"
+#include "utils/memory_tracker.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+static double residentMb() {
+    return MemoryTracker::residentBytes() / (1024.0 * 1024.0);
+}
+
+int main(int argc, char** argv) {
+    std::string model_path;
+    int max_interpreters = static_cast<int>(std::thread::hardware_concurrency());
+    double seconds = 5.0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (arg == "--max" && i + 1 < argc) {
+            max_interpreters = std::atoi(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (model_path.empty() || max_interpreters <= 0 || seconds <= 0.0) {
+        std::fprintf(stderr, "Usage: %s --model FILE [--max N] [--seconds S]\n", argv[0]);
+        return 1;
+    }
+
+    // Fixed pseudo-random input at the model's input size
+    std::vector<float> input;
+    auto fillInput = [&](TFLiteInference& engine) {
+        int height = 0;
+        int width = 0;
+        int channels = 0;
+        engine.getInputDimensions(height, width, channels);
+        input.resize(static_cast<size_t>(height) * width * channels);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> pixel(0.0f, 1.0f);
+        for (float& value : input) {
+            value = pixel(rng);
+        }
+    };
+
+    std::printf("Resident memory (MB)\n");
+    std::printf("  interpreters   pooled  separate\n");
+    double base_mb = residentMb();
+    std::vector<double> pooled_mb;
+    {
+        InterpreterPool pool;
+        for (int n = 1; n <= max_interpreters; n++) {
+            if (!pool.load(model_path, n)) {
+                return 1;
+            }
+            fillInput(pool.interpreter(0));
+            InferenceResult result;
+            pool.setNumThreads(1);
+            for (int i = 0; i < n; i++) {
+                pool.interpreter(i).runInference(input.data(), input.size(), result);
+            }
+            pooled_mb.push_back(residentMb() - base_mb);
+        }
+    }
+
+    base_mb = residentMb();
+    {
+        std::vector<std::unique_ptr<TFLiteInference>> engines;
+        for (int n = 1; n <= max_interpreters; n++) {
+            auto engine = std::make_unique<TFLiteInference>();
+            if (!engine->loadModel(model_path)) {
+                return 1;
+            }
+            engine->setNumThreads(1);
+            InferenceResult result;
+            engine->runInference(input.data(), input.size(), result);
+            engines.push_back(std::move(engine));
+            std::printf("  %12d  %7.1f  %8.1f\n", n, pooled_mb[n - 1], residentMb() - base_mb);
+        }
+    }
+
+    InterpreterPool pool;
+    if (!pool.load(model_path, max_interpreters)) {
+        return 1;
+    }
+    pool.setNumThreads(1);
+    std::printf("Model mapping: %.1f MB shared\n", pool.modelBytes() / (1024.0 * 1024.0));
+
+    std::printf("Throughput (1 inference thread per interpreter)\n");
+    std::printf("  callers  invokes/sec  speedup\n");
+    double single_rate = 0.0;
+    for (int callers = 1; callers <= max_interpreters; callers++) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> invokes{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < callers; t++) {
+            threads.emplace_back([&]() {
+                InferenceResult result;
+                uint64_t count = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    InterpreterPool::Lease lease = pool.acquire();
+                    if (!lease->runInference(input.data(), input.size(), result)) {
+                        break;
+                    }
+                    count++;
+                }
+                invokes += count;
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        double rate = invokes.load() / elapsed;
+        if (callers == 1) {
+            single_rate = rate;
+        }
+        std::printf("  %7d  %11.1f  %6.2fx\n", callers, rate,
+                    single_rate > 0.0 ? rate / single_rate : 0.0);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+// Live export benchmark
+//
+// Publishes synthetic camera frames and state through LiveExport while a
+// forked LiveReader process follows them, and reports:
+//   - writer cost of publishFrame() and publishState()
+//   - publish-to-observe latency in the reader (frame timestamp to the
+//     reader noticing the new frame number)
+//   - reader cost of readState() and of latestFrame() + valid()
+//   - frames the reader missed or saw torn (valid() false after use)
+//
+// Usage: sentinel_live_bench [frames] [interval_us] [width height]
+
+#include "core/live_export.h"
+#include "core/live_reader.h"
+#include "utils/logger.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+constexpr int CV_8UC3_TYPE = 16;
+
+void printPercentiles(const char* name, std::vector<int64_t>& samples_ns) {
+    if (samples_ns.empty()) {
+        std::cout << name << ": no samples" << std::endl;
+        return;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto at = [&](double q) {
+        return samples_ns[static_cast<size_t>(q * (samples_ns.size() - 1))] / 1000.0;
+    };
+    std::cout << name << ": p50 " << at(0.5) << " us, p99 " << at(0.99)
+              << " us, max " << at(1.0) << " us (" << samples_ns.size() << " samples)"
+              << std::endl;
+}
+
+template <typename Fn>
+double nsPerCall(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+// Reader process: follow frames until the last one, then time the reads
+int runReader(const std::string& socket_path, int frames) {
+    LiveReader reader;
+    for (int attempt = 0; !reader.open(socket_path); attempt++) {
+        if (attempt == 100) {
+            std::cerr << "reader: " << reader.getLastError() << std::endl;
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<int64_t> latency_ns;
+    latency_ns.reserve(frames);
+    uint64_t last = 0;
+    uint64_t missed = 0;
+    uint64_t torn = 0;
+    uint64_t checksum = 0;
+    while (last < static_cast<uint64_t>(frames)) {
+        uint64_t number = reader.latestFrameNumber();
+        if (number == last) {
+            continue;
+        }
+        int64_t seen_ns = liveMonotonicNs();
+        LiveFrame frame;
+        if (!reader.latestFrame(frame)) {
+            continue;
+        }
+        latency_ns.push_back(seen_ns - frame.timestamp_ns);
+        missed += frame.frame_number - last - 1;
+        last = frame.frame_number;
+
+        // Use the frame in place: touch one byte per row
+        for (int y = 0; y < frame.height; y++) {
+            checksum += frame.data[y * frame.step];
+        }
+        if (!reader.valid(frame)) {
+            torn++;
+        }
+    }
+
+    printPercentiles("publish_to_observe", latency_ns);
+    std::cout << "reader: missed " << missed << " frames, " << torn << " torn, checksum "
+              << checksum << std::endl;
+
+    LiveState state;
+    std::cout << "read_state: "
+              << nsPerCall(1000000, [&] { reader.readState(state); }) << " ns/call" << std::endl;
+    LiveFrame frame;
+    std::cout << "latest_frame_view: "
+              << nsPerCall(1000000, [&] { reader.latestFrame(frame) && reader.valid(frame); })
+              << " ns/call" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int interval_us = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int width = argc > 4 ? std::atoi(argv[3]) : 640;
+    int height = argc > 4 ? std::atoi(argv[4]) : 480;
+    size_t row_bytes = static_cast<size_t>(width) * 3;
+
+    Logger::setLevel(LogLevel::WARN);
+
+    LiveExportConfig config;
+    config.enabled = true;
+    LiveExport live(config, row_bytes * height);
+    std::string socket_path = "/tmp/sentinel-live-bench-" + std::to_string(getpid()) + ".sock";
+    if (!live.start(socket_path)) {
+        return 1;
+    }
+
+    std::cout << "live export: " << frames << " frames of " << width << "x" << height
+              << " every " << interval_us << " us, " << config.frame_slots << " slots"
+              << std::endl;
+
+    pid_t child = fork();
+    if (child == 0) {
+        std::_Exit(runReader(socket_path, frames));
+    }
+    if (child < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+    }
+
+    // Give the reader time to connect and map before the first frame
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<uint8_t> image(row_bytes * height);
+    for (size_t i = 0; i < image.size(); i++) {
+        image[i] = static_cast<uint8_t>(i * 31);
+    }
+
+    std::vector<int64_t> frame_cost_ns;
+    std::vector<int64_t> state_cost_ns;
+    frame_cost_ns.reserve(frames);
+    state_cost_ns.reserve(frames);
+    LiveState state{};
+    for (int i = 0; i < frames; i++) {
+        image[0] = static_cast<uint8_t>(i);
+
+        int64_t start = liveMonotonicNs();
+        live.publishFrame(image.data(), width, height, CV_8UC3_TYPE, row_bytes, row_bytes,
+                          start);
+        int64_t mid = liveMonotonicNs();
+        state.timestamp_ns = mid;
+        state.smoke_ppm = static_cast<float>(i % 500);
+        state.vision_frames = i + 1;
+        live.publishState(state);
+        int64_t end = liveMonotonicNs();
+
+        frame_cost_ns.push_back(mid - start);
+        state_cost_ns.push_back(end - mid);
+        std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    printPercentiles("publish_frame", frame_cost_ns);
+    printPercentiles("publish_state", state_cost_ns);
+    live.stop();
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
\ No newline at end of file
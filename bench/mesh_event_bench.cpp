@@ -0,0 +1,158 @@
+// Mesh event queue under a flood of simulated traffic
+//
+// Producer threads push frames through LoraMesh::receiveFrame() (the
+// receive thread's path) at a combined rate far above what a LoRa channel
+// carries, a quarter of them detection reports. A core thread calls
+// processMessages() every 10 ms like the main loop, with a detection
+// callback that busy-waits to stand in for real handling. An observer
+// thread reads getDetectingNodeCount() every 10 us, so its call time is
+// what any thread waiting on the node table lock sees.
+//
+// Reports receiveFrame() time (the lock hold on the receive path plus
+// decoding and queueing), node table read time, event queue counters and
+// receive-to-callback latency. The callback's cost must not appear in
+// either of the first two.
+//
+// Usage: sentinel_mesh_event_bench [producers] [seconds] [frames_per_sec] [callback_us]
+
+#include "network/lora_mesh.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint8_t SELF_ID = 1;
+
+void spin(std::chrono::microseconds duration) {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+uint64_t elapsedNs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+void printPercentiles(const char* label, std::vector<uint64_t>& samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    std::cout << label << ": " << samples.size() << " calls, p50 " << at(0.50) << " ns, p99 "
+              << at(0.99) << " ns, p99.9 " << at(0.999) << " ns, max " << samples.back()
+              << " ns" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int producers = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2;
+    int seconds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    int rate = argc > 3 ? std::max(1, std::atoi(argv[3])) : 50000;
+    int callback_us = argc > 4 ? std::max(0, std::atoi(argv[4])) : 20;
+
+    // Detection reports are logged at INFO; keep the log out of the timing
+    Logger::setLevel(LogLevel::WARN);
+
+    LoraConfig config;
+    config.node_timeout_sec = 86400;
+    LoraMesh mesh(SELF_ID, config);
+
+    std::atomic<uint64_t> callbacks{0};
+    mesh.setDetectionCallback([&](uint8_t, bool) {
+        spin(std::chrono::microseconds(callback_us));
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    std::atomic<bool> running{true};
+    std::vector<std::vector<uint64_t>> receive_ns(producers);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            auto& samples = receive_ns[p];
+            samples.reserve(static_cast<size_t>(rate / producers + 1) * seconds);
+            auto period = std::chrono::nanoseconds(1000000000LL * producers / rate);
+            auto next = Clock::now();
+            uint8_t buffer[MAX_PAYLOAD_SIZE + 5];
+            for (uint64_t i = 0; running.load(std::memory_order_relaxed); i++) {
+                MeshMessage msg{};
+                msg.type = i % 4 == 0 ? 0x02 : 0x01;
+                msg.source_id = static_cast<uint8_t>(2 + (i * producers + p) % 200);
+                msg.destination_id = 0xFF;
+                msg.payload[0] = (i / 4) % 2;
+                msg.payload_len = msg.type == 0x02 ? 1 : 0;
+                size_t len = LoraMesh::serializeMessage(msg, buffer);
+
+                auto start = Clock::now();
+                mesh.receiveFrame(buffer, len, -90, 5.0f);
+                samples.push_back(elapsedNs(start, Clock::now()));
+
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+
+    std::vector<uint64_t> read_ns;
+    read_ns.reserve(static_cast<size_t>(seconds) * 100000);
+    threads.emplace_back([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            auto start = Clock::now();
+            volatile int detecting = mesh.getDetectingNodeCount();
+            (void)detecting;
+            read_ns.push_back(elapsedNs(start, Clock::now()));
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+    });
+
+    // The core thread: processMessages() every 10 ms
+    std::vector<uint64_t> process_ns;
+    auto end = Clock::now() + std::chrono::seconds(seconds);
+    auto next = Clock::now();
+    while (Clock::now() < end) {
+        auto start = Clock::now();
+        mesh.processMessages();
+        process_ns.push_back(elapsedNs(start, Clock::now()));
+        next += std::chrono::milliseconds(10);
+        std::this_thread::sleep_until(next);
+    }
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    mesh.processMessages();
+
+    std::vector<uint64_t> all_receive;
+    for (const auto& samples : receive_ns) {
+        all_receive.insert(all_receive.end(), samples.begin(), samples.end());
+    }
+
+    std::cout << producers << " producers, " << rate << " frames/s for " << seconds
+              << " s, " << callback_us << " us callback" << std::endl;
+    printPercentiles("receiveFrame", all_receive);
+    printPercentiles("getDetectingNodeCount", read_ns);
+    printPercentiles("processMessages", process_ns);
+
+    MeshEventStats stats = mesh.getEventStats();
+    std::cout << "events: " << stats.queued << " queued, " << stats.dropped << " dropped, "
+              << stats.handled << " handled in " << stats.batches << " batches (max "
+              << stats.max_batch << "), " << callbacks.load() << " callbacks" << std::endl;
+    std::cout << "receive to callback: mean " << stats.latency->meanUs() << " us, p99 <"
+              << stats.latency->percentileUs(99) << " us, max " << stats.latency->maxUs()
+              << " us" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,1832 @@
+// Discrete-event LoRa mesh simulator
+//
+// Places --nodes nodes at random in a square sized for an average of
+// --degree neighbours within radio range (unit disk), and runs a mesh
+// protocol on each for --hours of simulated time. The radio is a shared
+// channel without carrier sense: every frame is on the air for its LoRa
+// time on air (LoraMesh::airtimeMs with the lora section's parameters),
+// a receiver loses frames that overlap at it, and a node cannot receive
+// while it transmits. Protocol logic comes from the same classes the
+// nodes run (TrickleTimer, LoraMesh::peerTimeout, the join constants and
+// round decisions, link costs and acknowledgement timeouts), driven by
+// simulated time instead of the executor. Node ids are ints here, so meshes larger
+// than the 8-bit on-air ids allow can be studied.
+//
+// Scenarios (--scenario):
+//   heartbeat   fixed-interval heartbeats against Trickle heartbeats.
+//               A few nodes start detecting during the run and --failures
+//               nodes die at the midpoint. Reports heartbeat airtime per
+//               node, duty cycle, frames lost to collisions, peers timed
+//               out while alive, and how long dead nodes stay listed.
+//               Fixed heartbeats keep their boot phase, so neighbours
+//               whose phases overlap collide every time and never hear
+//               each other; they count as lost frames, not timeouts.
+//   join        --reboots nodes restart one by one in a settled Trickle
+//               mesh, with and without the join handshake (--slots reply
+//               slots). Reports how long a restarted node takes to list
+//               90% and all of its live neighbours, and the handshake's
+//               airtime per boot.
+//   routing     every node but --gateways gateways sends a report every
+//               --report-interval seconds, by flooding and along the
+//               gradient (LoraMesh routing). Links lose frames: each
+//               frame's SNR margin varies by --fading dB around the
+//               link's, which falls with distance. --failures of the
+//               busiest relays die at the midpoint. Reports delivery
+//               ratio, latency, airtime per delivered report, and how
+//               long the first report of a node whose parent died takes.
+//   update      a new model version spreads from --sources random nodes
+//               (MeshTransfer) while every node holds the old one. Runs
+//               a full transfer and a deduplicated one that reuses local
+//               chunks; servers get --duty percent of airtime. The files
+//               are --old/--new if given, otherwise a random --file-kb
+//               model with --changed-percent of it rewritten and a few
+//               bytes inserted near the start. Reports completion times,
+//               data frames, bytes and airtime on air, and the share of
+//               the file found in local chunks.
+//
+// Usage: sentinel_mesh_sim [--scenario NAME] [--nodes N[,N...]] [--degree D]
+//                          [--hours H] [--seed S] [--failures N]
+//                          [--sf SF] [--interval SEC] [--max-interval SEC]
+//                          [--redundancy K] [--max-suppressed N]
+//                          [--slots N] [--reboots N] [--gateways N]
+//                          [--report-interval SEC] [--fading DB]
+//                          [--sources N] [--duty PERCENT] [--file-kb KB]
+//                          [--changed-percent P] [--old FILE --new FILE]
+
+#include "network/lora_mesh.h"
+#include "network/mesh_transfer.h"
+#include "network/trickle_timer.h"
+#include "utils/content_chunker.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+// Wire sizes: type, source, destination, length, payload, checksum
+constexpr size_t FRAME_OVERHEAD = 5;
+
+enum FrameType : uint8_t {
+    HEARTBEAT = 1,
+    DETECTION = 2,
+    ACK = 3,
+    SOLICIT = 4,
+    DIGEST = 5,
+    UPSTREAM = 6,
+    FLOOD = 0x80                     // Simulator only: a flooded report
+};
+
+// Upstream payload: origin, sequence number, hops left (top bit: detour),
+// sender's cost
+constexpr size_t UPSTREAM_HEADER_LEN = 5;
+constexpr uint8_t UPSTREAM_DETOUR = 0x80;
+
+struct Frame {
+    uint8_t type;
+    int source;
+    int destination;                 // -1 = broadcast
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    uint8_t payload_len;             // On-air length, ids included
+    std::vector<int> ids;            // Node ids listed after the fixed payload
+    int origin = -1;                 // Reports and acknowledgements
+    uint32_t seq = 0;
+};
+
+// --- Simulation engine ---
+
+class Simulator;
+
+class Protocol {
+public:
+    virtual ~Protocol() = default;
+    virtual void start(Simulator& sim, int node) = 0;
+    virtual void timer(Simulator& sim, int node, int kind, uint64_t tag) = 0;
+    // snr_margin: the frame's SNR above the demodulation floor, dB
+    virtual void receive(Simulator& sim, int node, const Frame& frame, double snr_margin) = 0;
+};
+
+struct TrafficStats {
+    uint64_t frames[256] = {};
+    double airtime_sec[256] = {};
+    uint64_t receptions = 0;         // Frame reached a neighbour intact
+    uint64_t collisions = 0;         // ...or did not, overlapping another
+    uint64_t faded = 0;              // ...or arrived below the demodulation floor
+};
+
+class Simulator {
+public:
+    // fading_db: spread of the per-frame SNR around the link's margin
+    // (0 = every frame in range arrives)
+    Simulator(int nodes, double degree, const LoraConfig& lora, uint32_t seed,
+              double fading_db = 0.0)
+        : lora_(lora), rng_(seed), fading_db_(fading_db), now_(0.0), sequence_(0) {
+        // Unit radio range; side length for the requested mean degree
+        double side = std::sqrt(nodes * M_PI / std::max(degree, 0.1));
+        std::uniform_real_distribution<double> coordinate(0.0, side);
+        x_.resize(nodes);
+        y_.resize(nodes);
+        for (int i = 0; i < nodes; i++) {
+            x_[i] = coordinate(rng_);
+            y_[i] = coordinate(rng_);
+        }
+        // Log-distance path loss, exponent 3: the margin above the
+        // demodulation floor is 0 dB at the edge of the range, 9 dB at
+        // half of it
+        neighbours_.resize(nodes);
+        margins_.resize(nodes);
+        for (int i = 0; i < nodes; i++) {
+            for (int j = i + 1; j < nodes; j++) {
+                double dx = x_[i] - x_[j];
+                double dy = y_[i] - y_[j];
+                double d2 = dx * dx + dy * dy;
+                if (d2 <= 1.0) {
+                    double margin = std::min(-15.0 * std::log10(std::max(d2, 1e-6)), 30.0);
+                    neighbours_[i].push_back(j);
+                    neighbours_[j].push_back(i);
+                    margins_[i].push_back(margin);
+                    margins_[j].push_back(margin);
+                }
+            }
+        }
+        radios_.resize(nodes);
+    }
+
+    int nodes() const { return static_cast<int>(neighbours_.size()); }
+    double now() const { return now_; }
+    std::mt19937& rng() { return rng_; }
+    const std::vector<int>& neighbours(int node) const { return neighbours_[node]; }
+    const TrafficStats& traffic() const { return traffic_; }
+    const LoraConfig& lora() const { return lora_; }
+
+    // Steady-clock stand-in for protocol classes. Rounded up, so a timer
+    // woken at seconds(due) sees a time at or after due.
+    static TrickleTimer::Clock::time_point clock(double t) {
+        return TrickleTimer::Clock::time_point(
+            std::chrono::ceil<TrickleTimer::Clock::duration>(
+                std::chrono::duration<double>(t)));
+    }
+
+    static double seconds(TrickleTimer::Clock::time_point t) {
+        return std::chrono::duration<double>(t.time_since_epoch()).count();
+    }
+
+    // Protocol timer at time t
+    void at(double t, int node, int kind, uint64_t tag = 0) {
+        push({std::max(t, now_), node, EVENT_TIMER, kind, tag, 0});
+    }
+
+    // Queue a frame; sent as soon as the node's radio is free
+    void transmit(int node, const Frame& frame) {
+        Radio& radio = radios_[node];
+        radio.queue.push_back(frame);
+        if (!radio.sending) {
+            startNext(node);
+        }
+    }
+
+    // A node that stopped (failure) neither sends nor receives
+    void setAlive(int node, bool alive) {
+        radios_[node].alive = alive;
+        if (!alive) {
+            radios_[node].queue.clear();
+        }
+    }
+    bool alive(int node) const { return radios_[node].alive; }
+
+    void run(Protocol& protocol, double end) {
+        for (int i = 0; i < nodes(); i++) {
+            protocol.start(*this, i);
+        }
+        while (!events_.empty() && events_.top().time <= end) {
+            Event event = events_.top();
+            events_.pop();
+            now_ = event.time;
+            switch (event.type) {
+                case EVENT_TIMER:
+                    if (radios_[event.node].alive) {
+                        protocol.timer(*this, event.node, event.kind, event.tag);
+                    }
+                    break;
+                case EVENT_TX_END:
+                    finishTransmission(protocol, event.node, event.tag);
+                    break;
+            }
+        }
+        now_ = end;
+    }
+
+private:
+    enum EventType { EVENT_TIMER, EVENT_TX_END };
+
+    struct Event {
+        double time;
+        int node;
+        EventType type;
+        int kind;
+        uint64_t tag;
+        uint64_t sequence;           // FIFO among equal times
+        bool operator>(const Event& other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    struct Reception {
+        uint64_t transmission;
+        double end;
+        bool intact;
+        double snr_margin;
+    };
+
+    struct Radio {
+        bool alive = true;
+        bool sending = false;
+        double busy_until = 0.0;
+        uint64_t transmission = 0;   // On the air now
+        Frame frame;
+        std::vector<Frame> queue;
+        std::vector<Reception> receiving;
+    };
+
+    void push(Event event) {
+        event.sequence = sequence_++;
+        events_.push(event);
+    }
+
+    void startNext(int node) {
+        Radio& radio = radios_[node];
+        if (radio.queue.empty() || !radio.alive) {
+            radio.sending = false;
+            return;
+        }
+        radio.frame = radio.queue.front();
+        radio.queue.erase(radio.queue.begin());
+        radio.sending = true;
+
+        size_t len = FRAME_OVERHEAD + radio.frame.payload_len;
+        double airtime = LoraMesh::airtimeMs(lora_, len) / 1000.0;
+        radio.busy_until = now_ + airtime;
+        radio.transmission = ++transmissions_;
+        traffic_.frames[radio.frame.type]++;
+        traffic_.airtime_sec[radio.frame.type] += airtime;
+
+        // Half duplex: whatever this node was receiving is lost
+        for (Reception& r : radio.receiving) {
+            r.intact = false;
+        }
+        // At each neighbour, overlapping frames destroy each other
+        std::normal_distribution<double> fading(0.0, std::max(fading_db_, 1e-9));
+        for (size_t k = 0; k < neighbours_[node].size(); k++) {
+            Radio& rx = radios_[neighbours_[node][k]];
+            bool intact = rx.alive && !(rx.sending && rx.busy_until > now_);
+            for (Reception& r : rx.receiving) {
+                r.intact = false;
+                intact = false;
+            }
+            double margin = margins_[node][k] + (fading_db_ > 0.0 ? fading(rng_) : 0.0);
+            rx.receiving.push_back({radio.transmission, radio.busy_until, intact, margin});
+        }
+        push({radio.busy_until, node, EVENT_TX_END, 0, radio.transmission, 0});
+    }
+
+    void finishTransmission(Protocol& protocol, int node, uint64_t transmission) {
+        Radio& radio = radios_[node];
+        Frame frame = radio.frame;
+        for (int n : neighbours_[node]) {
+            Radio& rx = radios_[n];
+            auto it = std::find_if(rx.receiving.begin(), rx.receiving.end(),
+                                   [&](const Reception& r) { return r.transmission == transmission; });
+            if (it == rx.receiving.end()) {
+                continue;
+            }
+            bool intact = it->intact && rx.alive;
+            double margin = it->snr_margin;
+            rx.receiving.erase(it);
+            if (!intact) {
+                traffic_.collisions++;
+                continue;
+            }
+            if (margin < 0.0) {
+                traffic_.faded++;
+                continue;
+            }
+            // Radios hear everything; protocols look at the destination
+            traffic_.receptions++;
+            protocol.receive(*this, n, frame, margin);
+        }
+        startNext(node);
+    }
+
+    LoraConfig lora_;
+    std::mt19937 rng_;
+    double fading_db_;
+    double now_;
+    uint64_t sequence_;
+    uint64_t transmissions_ = 0;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<std::vector<int>> neighbours_;
+    std::vector<std::vector<double>> margins_;   // Per neighbour, dB
+    std::vector<Radio> radios_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_;
+    TrafficStats traffic_;
+};
+
+// --- Heartbeat, join and routing protocol ---
+
+enum class Routing {
+    NONE,
+    GRADIENT,                        // Unicast to the parent, as LoraMesh
+    FLOOD                            // Every node rebroadcasts each report once
+};
+
+// Alert report as SentinelCore sends it
+constexpr size_t REPORT_LEN = 5;
+
+struct MeshOptions {
+    bool trickle = true;
+    int interval_sec = 30;
+    int max_interval_sec = 120;
+    int redundancy = 3;
+    int max_suppressed = LoraMesh::MAX_SUPPRESSED_HEARTBEATS;
+    int node_timeout_sec = 90;
+    int failures = 5;
+    int detections = 5;
+    int join_slots = 0;              // 0 = no join handshake
+    int reboots = 0;                 // Nodes restarted after warmup_sec
+    double warmup_sec = 1200.0;
+    double reboot_spacing_sec = 120.0;
+    Routing routing = Routing::NONE;
+    int gateways = 3;
+    double report_interval_sec = 14400.0;   // Per node, after warmup_sec
+    bool fail_relays = false;        // Failures hit the relays on the most shortest paths
+};
+
+struct MeshResult {
+    double heartbeat_airtime_sec = 0.0;
+    double total_airtime_sec = 0.0;
+    double join_airtime_sec = 0.0;   // Solicitations and digests
+    uint64_t heartbeats = 0;
+    uint64_t suppressed = 0;
+    uint64_t false_timeouts = 0;     // Live peer dropped from a table
+    std::vector<double> dead_listed_sec;    // Death to removal, per neighbour
+    uint64_t dead_still_listed = 0;  // At the end of the run
+    std::vector<double> full_view_sec;      // Reboot to knowing every neighbour
+    std::vector<double> most_view_sec;      // ...90% of them
+    uint64_t views_incomplete = 0;   // Rebooted nodes still missing neighbours
+    uint64_t collisions = 0;
+    uint64_t receptions = 0;
+    uint64_t faded = 0;
+    uint64_t reports = 0;            // From nodes with a path to a gateway
+    uint64_t delivered = 0;          // Reached a gateway
+    uint64_t duplicates = 0;         // Reached a gateway again
+    std::vector<double> latency_sec;
+    std::vector<double> reroute_sec; // First report of each node whose parent died
+    uint64_t reroutes = 0;
+    double data_airtime_sec = 0.0;   // Reports and acknowledgements
+    uint64_t fallbacks = 0;
+    uint64_t parent_changes = 0;
+};
+
+// Mirrors LoraMesh: heartbeats announce the detection flag, silence bound
+// and route cost, a heartbeat from a known peer repeating what we know is
+// consistent, anything else (new peer, change, detection, timeout) resets
+// the Trickle timer; solicitations are answered by digests instead.
+// Detecting nodes stay at the shortest interval and a peer's detection
+// expires after node_timeout_sec. Fixed
+// mode is the old behaviour: an empty heartbeat every interval from a
+// random phase, node_timeout_sec for all. With join_slots, a (re)started
+// node runs the join handshake instead of announcing itself with a
+// heartbeat. With routing, every node but the gateways sends a report
+// every report_interval_sec, along the gradient (parent selection,
+// acknowledgements and fallback as LoraMesh) or by flooding.
+class MeshProtocol : public Protocol {
+public:
+    enum Timer { WAKE, CLEANUP, DETECT, FAIL, BOOT, JOIN_TICK, REPLY, REPORT, ROUTE, RELAY };
+
+    MeshProtocol(const MeshOptions& options, int nodes, double hours, uint32_t seed)
+        : options_(options), nodes_(nodes), death_(nodes, -1.0) {
+        for (int i = 0; i < nodes; i++) {
+            nodes_[i].trickle = TrickleTimer(seed * 7919u + i + 1);
+        }
+        // Detections spread over the run; failures at the midpoint;
+        // reboots of distinct nodes one after another after the warmup
+        std::mt19937 rng(seed + 1);
+        std::uniform_int_distribution<int> pick(0, nodes - 1);
+        std::uniform_real_distribution<double> when(0.1, 0.9);
+        for (int i = 0; i < options.detections; i++) {
+            detect_at_.push_back({pick(rng), when(rng) * hours * 3600.0});
+        }
+        for (int i = 0; i < options.failures; i++) {
+            fail_at_.push_back({pick(rng), 0.5 * hours * 3600.0});
+        }
+        std::vector<int> order(nodes);
+        for (int i = 0; i < nodes; i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int i = 0; i < std::min(options.reboots, nodes); i++) {
+            reboot_at_.push_back({order[i], options.warmup_sec + i * options.reboot_spacing_sec});
+        }
+        if (options.routing != Routing::NONE) {
+            for (int i = 0; i < std::min(options.gateways, nodes); i++) {
+                nodes_[order[nodes - 1 - i]].gateway = true;
+            }
+        }
+    }
+
+    void start(Simulator& sim, int id) override {
+        std::uniform_real_distribution<double> phase(0.0, options_.interval_sec);
+        // Boots are spread over one interval
+        sim.at(phase(sim.rng()), id, options_.trickle ? BOOT : WAKE);
+        sim.at(options_.interval_sec, id, CLEANUP);
+        if (options_.routing != Routing::NONE && !nodes_[id].gateway) {
+            std::uniform_real_distribution<double> report(0.0, options_.report_interval_sec);
+            sim.at(options_.warmup_sec + report(sim.rng()), id, REPORT);
+        }
+        if (id == 0) {
+            mapTopology(sim);
+            for (const auto& d : detect_at_) {
+                sim.at(d.second, d.first, DETECT);
+            }
+            for (const auto& f : fail_at_) {
+                sim.at(f.second, f.first, FAIL);
+            }
+            for (const auto& r : reboot_at_) {
+                sim.at(r.second, r.first, BOOT, 1);
+            }
+        }
+    }
+
+    void timer(Simulator& sim, int id, int kind, uint64_t tag) override {
+        Node& node = nodes_[id];
+        switch (kind) {
+            case BOOT:
+                boot(sim, id, tag == 1);
+                break;
+            case WAKE:
+                if (!options_.trickle) {
+                    sendHeartbeat(sim, id);
+                    sim.at(sim.now() + options_.interval_sec, id, WAKE);
+                } else if (tag == node.generation) {
+                    TrickleTimer::Action action = node.trickle.poll(Simulator::clock(sim.now()));
+                    if (action == TrickleTimer::Action::TRANSMIT || node.announce) {
+                        node.announce = false;
+                        sendHeartbeat(sim, id);
+                    }
+                    if (node.detecting) {
+                        node.trickle.reset(Simulator::clock(sim.now()));
+                    }
+                    arm(sim, id);
+                }
+                break;
+            case CLEANUP:
+                cleanup(sim, id);
+                sim.at(sim.now() + options_.interval_sec, id, CLEANUP);
+                break;
+            case DETECT: {
+                node.detecting = true;
+                Frame frame{};
+                frame.type = DETECTION;
+                frame.source = id;
+                frame.destination = -1;
+                frame.payload[0] = 1;
+                frame.payload_len = 1;
+                sim.transmit(id, frame);
+                reset(sim, id);
+                break;
+            }
+            case FAIL:
+                fail(sim, options_.fail_relays ? busiestRelay(sim) : id);
+                break;
+            case JOIN_TICK:
+                if (tag == node.epoch) {
+                    joinTick(sim, id);
+                }
+                break;
+            case REPLY:
+                if ((tag >> 20) == node.epoch) {
+                    node.reply_pending = false;
+                    sendDigest(sim, id, static_cast<int>(tag & 0xFFFFF));
+                }
+                break;
+            case REPORT:
+                sim.at(sim.now() + options_.report_interval_sec, id, REPORT);
+                report(sim, id);
+                break;
+            case ROUTE:
+                routeTick(sim, id);
+                break;
+            case RELAY: {
+                auto it = node.relays.find(tag);
+                if (it != node.relays.end()) {
+                    sim.transmit(id, it->second);
+                    node.relays.erase(it);
+                }
+                break;
+            }
+        }
+    }
+
+    void receive(Simulator& sim, int id, const Frame& frame, double snr_margin) override {
+        Node& node = nodes_[id];
+        auto existing = node.peers.find(frame.source);
+        bool known = existing != node.peers.end();
+        Peer& peer = node.peers[frame.source];
+        peer.last_seen = sim.now();
+
+        // Smoothed link margin, as LoraMesh
+        bool route_changed = peer.unreachable;
+        peer.unreachable = false;
+        uint16_t link_before = peer.link;
+        peer.snr_margin = link_before ? peer.snr_margin + 0.25 * (snr_margin - peer.snr_margin)
+                                      : snr_margin;
+        peer.link = LoraMesh::linkCost(static_cast<float>(peer.snr_margin), link_before);
+        route_changed = route_changed || peer.link != link_before;
+
+        bool announcement = frame.type == HEARTBEAT || frame.type == SOLICIT ||
+                            frame.type == DIGEST;
+        bool consistent = false;
+        if (frame.type == DETECTION) {
+            peer.detecting = frame.payload[0] == 1;
+        } else if (announcement) {
+            consistent = known;
+            if (frame.payload_len >= 5) {
+                bool detecting = frame.payload[0] & 1;
+                uint16_t bound = static_cast<uint16_t>(frame.payload[1] | (frame.payload[2] << 8));
+                uint16_t cost = static_cast<uint16_t>(frame.payload[3] | (frame.payload[4] << 8));
+                consistent = consistent && detecting == peer.detecting && bound == peer.bound &&
+                             !LoraMesh::routeCostChanged(peer.cost, cost);
+                peer.detecting = detecting;
+                peer.bound = bound;
+                route_changed = route_changed || cost != peer.cost;
+                peer.cost = cost;
+            }
+        }
+        if (route_changed && options_.routing == Routing::GRADIENT) {
+            updateRoute(sim, id);
+        }
+        if (frame.type == UPSTREAM && frame.destination == id) {
+            receiveUpstream(sim, id, frame);
+        } else if (frame.type == ACK && frame.destination == id) {
+            receiveAck(id, frame);
+        } else if (frame.type == FLOOD) {
+            receiveFlood(sim, id, frame);
+        }
+        if (frame.type == DIGEST && frame.destination == id && node.joining) {
+            node.candidates.insert(frame.ids.begin(), frame.ids.end());
+        }
+        if (frame.type == SOLICIT && !node.reply_pending &&
+            std::find(frame.ids.begin(), frame.ids.end(), id) == frame.ids.end()) {
+            int slots = std::max<int>(frame.payload[5], 1);
+            int slot = std::uniform_int_distribution<int>(0, slots - 1)(sim.rng());
+            node.reply_pending = true;
+            sim.at(sim.now() + slot * joinSlot(sim), id, REPLY,
+                   (node.epoch << 20) | static_cast<uint64_t>(frame.source));
+        }
+        if (options_.trickle && (announcement || frame.type == DETECTION) &&
+            frame.type != SOLICIT) {
+            if (consistent) {
+                node.trickle.hearConsistent();
+            } else {
+                reset(sim, id);
+            }
+        }
+        checkView(sim, id);
+    }
+
+    MeshResult result(const Simulator& sim) const {
+        MeshResult r = result_;
+        r.heartbeat_airtime_sec = sim.traffic().airtime_sec[HEARTBEAT];
+        r.join_airtime_sec = sim.traffic().airtime_sec[SOLICIT] + sim.traffic().airtime_sec[DIGEST];
+        r.total_airtime_sec = r.heartbeat_airtime_sec + r.join_airtime_sec +
+                              sim.traffic().airtime_sec[DETECTION];
+        r.heartbeats = sim.traffic().frames[HEARTBEAT];
+        r.collisions = sim.traffic().collisions;
+        r.receptions = sim.traffic().receptions;
+        r.faded = sim.traffic().faded;
+        r.data_airtime_sec = sim.traffic().airtime_sec[UPSTREAM] + sim.traffic().airtime_sec[ACK] +
+                             sim.traffic().airtime_sec[FLOOD];
+        for (int i = 0; i < static_cast<int>(nodes_.size()); i++) {
+            if (!sim.alive(i)) {
+                continue;
+            }
+            r.suppressed += nodes_[i].trickle.suppressed();
+            for (const auto& p : nodes_[i].peers) {
+                r.dead_still_listed += death_[p.first] >= 0.0 ? 1 : 0;
+            }
+            r.views_incomplete += nodes_[i].measuring && !nodes_[i].view_full ? 1 : 0;
+        }
+        return r;
+    }
+
+private:
+    struct Peer {
+        double last_seen = 0.0;
+        bool detecting = false;
+        uint16_t bound = 0;
+        uint16_t cost = ROUTE_COST_NONE;
+        double snr_margin = 0.0;
+        uint16_t link = 0;           // Link cost
+        bool unreachable = false;
+    };
+
+    // A report waiting for the next hop's acknowledgement
+    struct Pending {
+        int origin;
+        uint32_t seq;
+        int ttl;
+        int next_hop = -1;
+        int attempts = 0;
+        int parents = 0;
+        std::unordered_set<int> excluded;
+        double due = 0.0;
+    };
+
+    struct Node {
+        TrickleTimer trickle;
+        uint64_t generation = 0;     // Wake-ups from before a reset are stale
+        uint64_t epoch = 0;          // Join timers from before a reboot are stale
+        bool announce = false;
+        bool detecting = false;
+        uint16_t bound = 0;
+        std::unordered_map<int, Peer> peers;
+
+        bool joining = false;
+        int join_round = 0;
+        size_t join_known = 0;
+        std::unordered_set<int> candidates;
+        bool reply_pending = false;
+
+        bool measuring = false;      // Rebooted: time the view
+        bool view_most = false;
+        bool view_full = false;
+        double booted = 0.0;
+
+        bool gateway = false;
+        uint16_t cost = ROUTE_COST_NONE;
+        int parent = -1;
+        std::vector<Pending> upstream;
+        std::vector<uint64_t> seen = std::vector<uint64_t>(32, UINT64_MAX);
+        size_t seen_next = 0;
+        uint32_t seq = 0;
+        bool orphaned = false;       // Parent died: time the next report
+        std::unordered_map<uint64_t, Frame> relays;    // Flooding, by report
+    };
+
+    static double joinSlot(const Simulator& sim) {
+        return std::chrono::duration<double>(LoraMesh::joinSlot(sim.lora())).count();
+    }
+
+    void boot(Simulator& sim, int id, bool measure) {
+        Node& node = nodes_[id];
+        node.epoch++;
+        node.peers.clear();
+        node.reply_pending = false;
+        node.trickle.configure(std::chrono::seconds(options_.interval_sec),
+                               std::chrono::seconds(options_.max_interval_sec),
+                               options_.redundancy, options_.max_suppressed);
+        node.trickle.start(Simulator::clock(sim.now()));
+        node.bound = static_cast<uint16_t>(std::ceil(
+            std::chrono::duration<double>(node.trickle.silenceBound()).count()));
+        node.cost = ROUTE_COST_NONE;
+        node.parent = -1;
+        node.upstream.clear();
+        if (options_.routing == Routing::GRADIENT) {
+            updateRoute(sim, id);
+        }
+        arm(sim, id);
+        node.measuring = measure;
+        node.view_most = false;
+        node.view_full = false;
+        node.booted = sim.now();
+
+        if (options_.join_slots > 0) {
+            node.joining = true;
+            node.join_round = 0;
+            node.join_known = 0;
+            node.candidates.clear();
+            sim.at(sim.now() + sendSolicitation(sim, id, options_.join_slots), id,
+                   JOIN_TICK, node.epoch);
+        } else {
+            node.announce = true;
+            sim.at(sim.now(), id, WAKE, node.generation);
+        }
+    }
+
+    void joinTick(Simulator& sim, int id) {
+        // Same decision as LoraMesh::joinTick()
+        Node& node = nodes_[id];
+        node.join_round++;
+        size_t missing = 0;
+        for (int candidate : node.candidates) {
+            missing += candidate != id && node.peers.count(candidate) == 0 ? 1 : 0;
+        }
+        size_t found = node.peers.size() - std::min(node.peers.size(), node.join_known);
+        node.join_known = node.peers.size();
+        int slots = LoraMesh::joinNextSlots(node.join_round, missing, found, options_.join_slots);
+        if (slots > 0) {
+            sim.at(sim.now() + sendSolicitation(sim, id, slots), id, JOIN_TICK, node.epoch);
+        } else {
+            node.joining = false;
+        }
+    }
+
+    void fillAnnouncement(Frame& frame, int id) const {
+        frame.payload[0] = nodes_[id].detecting ? 1 : 0;
+        frame.payload[1] = static_cast<uint8_t>(nodes_[id].bound & 0xFF);
+        frame.payload[2] = static_cast<uint8_t>(nodes_[id].bound >> 8);
+        frame.payload[3] = static_cast<uint8_t>(nodes_[id].cost & 0xFF);
+        frame.payload[4] = static_cast<uint8_t>(nodes_[id].cost >> 8);
+        frame.payload_len = 5;
+    }
+
+    // Returns the round length
+    double sendSolicitation(Simulator& sim, int id, int slots) {
+        Frame frame{};
+        frame.type = SOLICIT;
+        frame.source = id;
+        frame.destination = -1;
+        fillAnnouncement(frame, id);
+        frame.payload[5] = static_cast<uint8_t>(std::min(slots, 255));
+        for (const auto& p : nodes_[id].peers) {
+            if (frame.ids.size() + 6 == MAX_PAYLOAD_SIZE) {
+                break;
+            }
+            frame.ids.push_back(p.first);
+        }
+        frame.payload_len = static_cast<uint8_t>(6 + frame.ids.size());
+        sim.transmit(id, frame);
+        double on_air = LoraMesh::airtimeMs(sim.lora(), FRAME_OVERHEAD + frame.payload_len) / 1000.0;
+        return on_air + joinSlot(sim) * (slots + 1);
+    }
+
+    void sendDigest(Simulator& sim, int id, int solicitor) {
+        Frame frame{};
+        frame.type = DIGEST;
+        frame.source = id;
+        frame.destination = solicitor;
+        fillAnnouncement(frame, id);
+        std::vector<std::pair<double, int>> recent;
+        for (const auto& p : nodes_[id].peers) {
+            if (p.first != solicitor) {
+                recent.push_back({p.second.last_seen, p.first});
+            }
+        }
+        size_t entries = std::min(recent.size(), LoraMesh::JOIN_DIGEST_ENTRIES);
+        std::partial_sort(recent.begin(), recent.begin() + entries, recent.end(),
+                          [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (size_t i = 0; i < entries; i++) {
+            frame.ids.push_back(recent[i].second);
+        }
+        frame.payload_len = static_cast<uint8_t>(5 + entries);
+        sim.transmit(id, frame);
+    }
+
+    void sendHeartbeat(Simulator& sim, int id) {
+        Frame frame{};
+        frame.type = HEARTBEAT;
+        frame.source = id;
+        frame.destination = -1;
+        if (options_.trickle) {
+            fillAnnouncement(frame, id);
+        }
+        sim.transmit(id, frame);
+    }
+
+    void checkView(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        if (!node.measuring || node.view_full) {
+            return;
+        }
+        size_t live = 0;
+        size_t known = 0;
+        for (int n : sim.neighbours(id)) {
+            if (sim.alive(n)) {
+                live++;
+                known += node.peers.count(n);
+            }
+        }
+        if (!node.view_most && known * 10 >= live * 9) {
+            node.view_most = true;
+            result_.most_view_sec.push_back(sim.now() - node.booted);
+        }
+        if (known == live) {
+            node.view_full = true;
+            result_.full_view_sec.push_back(sim.now() - node.booted);
+        }
+    }
+
+    void reset(Simulator& sim, int id) {
+        if (!options_.trickle) {
+            return;
+        }
+        nodes_[id].trickle.reset(Simulator::clock(sim.now()));
+        arm(sim, id);
+    }
+
+    void arm(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        sim.at(Simulator::seconds(node.trickle.nextDue()), id, WAKE, ++node.generation);
+    }
+
+    void cleanup(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        bool expired = false;
+        bool cleared = false;
+        for (auto it = node.peers.begin(); it != node.peers.end();) {
+            double timeout = options_.trickle
+                ? LoraMesh::peerTimeout(options_.node_timeout_sec, options_.interval_sec,
+                                        it->second.bound).count()
+                : options_.node_timeout_sec;
+            if (sim.now() - it->second.last_seen > timeout) {
+                if (death_[it->first] < 0.0) {
+                    result_.false_timeouts++;
+                } else {
+                    result_.dead_listed_sec.push_back(sim.now() - death_[it->first]);
+                }
+                it = node.peers.erase(it);
+                expired = true;
+                continue;
+            }
+            if (it->second.detecting &&
+                sim.now() - it->second.last_seen > options_.node_timeout_sec) {
+                it->second.detecting = false;
+                cleared = true;
+            }
+            ++it;
+        }
+        if (expired || cleared) {
+            reset(sim, id);
+        }
+        if (expired) {
+            if (options_.routing == Routing::GRADIENT) {
+                updateRoute(sim, id);
+            }
+        }
+    }
+
+    // --- Routing ---
+
+    static uint64_t key(int origin, uint32_t seq) {
+        return (static_cast<uint64_t>(origin) << 32) | seq;
+    }
+
+    // Same 32-entry memory as LoraMesh
+    static bool seen(const Node& node, uint64_t k) {
+        return std::find(node.seen.begin(), node.seen.end(), k) != node.seen.end();
+    }
+
+    static void remember(Node& node, uint64_t k) {
+        node.seen[node.seen_next] = k;
+        node.seen_next = (node.seen_next + 1) % node.seen.size();
+    }
+
+    // Nodes with a path to a gateway when all are alive, and the relays
+    // ordered by how many nodes' shortest (hop count) paths cross them.
+    // The order depends only on the topology, so every mode loses the
+    // same relays.
+    void mapTopology(const Simulator& sim) {
+        size_t count = nodes_.size();
+        connected_.assign(count, false);
+        std::vector<int> tree_parent(count, -1);
+        std::vector<int> order;
+        for (int i = 0; i < static_cast<int>(count); i++) {
+            if (nodes_[i].gateway) {
+                connected_[i] = true;
+                order.push_back(i);
+            }
+        }
+        for (size_t next = 0; next < order.size(); next++) {
+            for (int m : sim.neighbours(order[next])) {
+                if (!connected_[m]) {
+                    connected_[m] = true;
+                    tree_parent[m] = order[next];
+                    order.push_back(m);
+                }
+            }
+        }
+        std::vector<int> descendants(count, 0);
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            if (tree_parent[*it] >= 0) {
+                descendants[tree_parent[*it]] += descendants[*it] + 1;
+            }
+        }
+        relays_.clear();
+        for (int n : order) {
+            if (!nodes_[n].gateway) {
+                relays_.push_back(n);
+            }
+        }
+        std::stable_sort(relays_.begin(), relays_.end(),
+                         [&](int a, int b) { return descendants[a] > descendants[b]; });
+    }
+
+    int busiestRelay(const Simulator& sim) const {
+        for (int n : relays_) {
+            if (sim.alive(n)) {
+                return n;
+            }
+        }
+        return 0;
+    }
+
+    void fail(Simulator& sim, int id) {
+        death_[id] = sim.now();
+        sim.setAlive(id, false);
+        nodes_[id].upstream.clear();
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            if (nodes_[i].parent == id && sim.alive(static_cast<int>(i))) {
+                nodes_[i].orphaned = true;
+            }
+        }
+    }
+
+    void report(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        if (!connected_[id]) {
+            return;
+        }
+        uint32_t seq = node.seq++;
+        uint64_t k = key(id, seq);
+        born_[k] = sim.now();
+        result_.reports++;
+        if (node.orphaned) {
+            node.orphaned = false;
+            rerouted_.insert(k);
+            result_.reroutes++;
+        }
+        remember(node, k);
+
+        if (options_.routing == Routing::FLOOD) {
+            Frame frame{};
+            frame.type = FLOOD;
+            frame.source = id;
+            frame.destination = -1;
+            frame.origin = id;
+            frame.seq = seq;
+            frame.payload[2] = LoraMesh::ROUTE_MAX_HOPS;
+            frame.payload_len = UPSTREAM_HEADER_LEN + REPORT_LEN;
+            sim.transmit(id, frame);
+        } else if (node.cost != ROUTE_COST_NONE &&
+                   node.upstream.size() < LoraMesh::ROUTE_QUEUE_SIZE) {
+            Pending pending;
+            pending.origin = id;
+            pending.seq = seq;
+            pending.ttl = LoraMesh::ROUTE_MAX_HOPS;
+            pending.due = sim.now();
+            node.upstream.push_back(pending);
+            routeTick(sim, id);
+        }
+    }
+
+    void deliver(Simulator& sim, uint64_t k) {
+        if (!delivered_.insert(k).second) {
+            result_.duplicates++;
+            return;
+        }
+        result_.delivered++;
+        double latency = sim.now() - born_[k];
+        result_.latency_sec.push_back(latency);
+        if (rerouted_.count(k)) {
+            result_.reroute_sec.push_back(latency);
+        }
+    }
+
+    // Plain flooding: rebroadcast each report once after a random delay
+    // of up to four frames, gateways keep it
+    void receiveFlood(Simulator& sim, int id, const Frame& frame) {
+        Node& node = nodes_[id];
+        uint64_t k = key(frame.origin, frame.seq);
+        if (seen(node, k)) {
+            return;
+        }
+        remember(node, k);
+        if (node.gateway) {
+            deliver(sim, k);
+            return;
+        }
+        if (frame.payload[2] == 0) {
+            return;
+        }
+        Frame relay = frame;
+        relay.source = id;
+        relay.payload[2]--;
+        node.relays[k] = relay;
+        double on_air = LoraMesh::airtimeMs(sim.lora(), FRAME_OVERHEAD + frame.payload_len) / 1000.0;
+        std::uniform_real_distribution<double> delay(0.0, 4.0 * on_air);
+        sim.at(sim.now() + delay(sim.rng()), id, RELAY, k);
+    }
+
+    // Same choice as LoraMesh::updateRoute()
+    void updateRoute(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        int parent = -1;
+        uint32_t cost = node.gateway ? 0 : ROUTE_COST_NONE;
+        if (!node.gateway) {
+            uint32_t current = ROUTE_COST_NONE;
+            for (const auto& p : node.peers) {
+                if (p.second.cost == ROUTE_COST_NONE || p.second.unreachable) {
+                    continue;
+                }
+                uint32_t path = p.second.cost + p.second.link;
+                if (p.first == node.parent) {
+                    current = path;
+                }
+                if (path < cost) {
+                    cost = path;
+                    parent = p.first;
+                }
+            }
+            if (current != ROUTE_COST_NONE && current <= cost + LoraMesh::ROUTE_SWITCH_THRESHOLD) {
+                cost = current;
+                parent = node.parent;
+            }
+            if (cost > LoraMesh::ROUTE_MAX_COST) {
+                cost = ROUTE_COST_NONE;
+                parent = -1;
+            }
+        }
+        if (parent != node.parent) {
+            result_.parent_changes++;
+            node.parent = parent;
+        }
+        uint16_t before = node.cost;
+        node.cost = static_cast<uint16_t>(cost);
+        if (LoraMesh::routeCostChanged(before, node.cost)) {
+            reset(sim, id);
+        }
+    }
+
+    int nextHop(const Node& node, const std::unordered_set<int>& excluded) const {
+        if (node.parent >= 0 && !excluded.count(node.parent)) {
+            return node.parent;
+        }
+        int best = -1;
+        uint32_t best_cost = LoraMesh::ROUTE_MAX_COST + 1;
+        for (const auto& p : node.peers) {
+            if (p.second.cost == ROUTE_COST_NONE || p.second.unreachable || excluded.count(p.first)) {
+                continue;
+            }
+            uint32_t path = p.second.cost + p.second.link;
+            if (path < best_cost) {
+                best_cost = path;
+                best = p.first;
+            }
+        }
+        return best;
+    }
+
+    // Same steps as LoraMesh::routeTick()
+    void routeTick(Simulator& sim, int id) {
+        Node& node = nodes_[id];
+        double timeout = std::chrono::duration<double>(LoraMesh::ackTimeout(sim.lora())).count();
+        double next_due = -1.0;
+        for (auto it = node.upstream.begin(); it != node.upstream.end();) {
+            Pending& entry = *it;
+            if (entry.due > sim.now()) {
+                next_due = next_due < 0.0 ? entry.due : std::min(next_due, entry.due);
+                ++it;
+                continue;
+            }
+            if (entry.next_hop >= 0 && entry.attempts >= LoraMesh::ROUTE_ATTEMPTS) {
+                auto peer = node.peers.find(entry.next_hop);
+                if (peer != node.peers.end()) {
+                    peer->second.unreachable = true;
+                }
+                entry.excluded.insert(entry.next_hop);
+                entry.next_hop = -1;
+                result_.fallbacks++;
+                updateRoute(sim, id);
+            }
+            if (entry.next_hop < 0) {
+                entry.next_hop = entry.parents < LoraMesh::ROUTE_MAX_PARENTS
+                    ? nextHop(node, entry.excluded) : -1;
+                entry.attempts = 0;
+                entry.parents++;
+            }
+            if (entry.next_hop < 0) {
+                it = node.upstream.erase(it);
+                continue;
+            }
+
+            Frame frame{};
+            frame.type = UPSTREAM;
+            frame.source = id;
+            frame.destination = entry.next_hop;
+            frame.origin = entry.origin;
+            frame.seq = entry.seq;
+            frame.payload[2] = static_cast<uint8_t>(entry.ttl) |
+                               (entry.next_hop != node.parent ? UPSTREAM_DETOUR : 0);
+            frame.payload[3] = static_cast<uint8_t>(node.cost & 0xFF);
+            frame.payload[4] = static_cast<uint8_t>(node.cost >> 8);
+            frame.payload_len = UPSTREAM_HEADER_LEN + REPORT_LEN;
+            sim.transmit(id, frame);
+
+            entry.attempts++;
+            std::uniform_real_distribution<double> extra(0.0, timeout / 2.0);
+            entry.due = sim.now() + timeout + extra(sim.rng());
+            next_due = next_due < 0.0 ? entry.due : std::min(next_due, entry.due);
+            ++it;
+        }
+        if (next_due >= 0.0) {
+            sim.at(next_due, id, ROUTE);
+        }
+    }
+
+    void receiveUpstream(Simulator& sim, int id, const Frame& frame) {
+        Node& node = nodes_[id];
+        uint64_t k = key(frame.origin, frame.seq);
+        int ttl = frame.payload[2] & ~UPSTREAM_DETOUR;
+        bool detour = (frame.payload[2] & UPSTREAM_DETOUR) != 0;
+        uint16_t sender_cost = static_cast<uint16_t>(frame.payload[3] | (frame.payload[4] << 8));
+        bool accepted = true;
+        bool forward = false;
+        if (seen(node, k)) {
+            // Already handled
+        } else if (node.gateway) {
+            remember(node, k);
+            deliver(sim, k);
+        } else if (ttl == 0) {
+            remember(node, k);
+        } else {
+            if (!detour && node.cost >= sender_cost) {
+                reset(sim, id);
+            }
+            forward = node.cost != ROUTE_COST_NONE &&
+                      node.upstream.size() < LoraMesh::ROUTE_QUEUE_SIZE;
+            if (forward) {
+                Pending pending;
+                pending.origin = frame.origin;
+                pending.seq = frame.seq;
+                pending.ttl = ttl - 1;
+                pending.excluded.insert(frame.source);
+                pending.due = sim.now();
+                node.upstream.push_back(pending);
+                remember(node, k);
+            }
+            accepted = forward;
+        }
+        if (accepted) {
+            Frame ack{};
+            ack.type = ACK;
+            ack.source = id;
+            ack.destination = frame.source;
+            ack.origin = frame.origin;
+            ack.seq = frame.seq;
+            ack.payload_len = 2;
+            sim.transmit(id, ack);
+        }
+        if (forward) {
+            routeTick(sim, id);
+        }
+    }
+
+    void receiveAck(int id, const Frame& frame) {
+        Node& node = nodes_[id];
+        for (auto it = node.upstream.begin(); it != node.upstream.end(); ++it) {
+            if (it->origin == frame.origin && it->seq == frame.seq &&
+                it->next_hop == frame.source) {
+                node.upstream.erase(it);
+                break;
+            }
+        }
+    }
+
+    MeshOptions options_;
+    std::vector<Node> nodes_;
+    std::vector<double> death_;      // Failure time, -1 while alive
+    std::vector<std::pair<int, double>> detect_at_;
+    std::vector<std::pair<int, double>> fail_at_;
+    std::vector<std::pair<int, double>> reboot_at_;
+    std::vector<bool> connected_;
+    std::vector<int> relays_;       // Busiest first
+    std::unordered_map<uint64_t, double> born_;     // Report creation times
+    std::unordered_set<uint64_t> delivered_;
+    std::unordered_set<uint64_t> rerouted_;
+    MeshResult result_;
+};
+
+// --- Model and config distribution ---
+
+struct UpdateOptions {
+    int sources = 3;                 // Nodes holding the new version at the start
+    bool dedup = true;               // Others hold the old version as a chunk base
+};
+
+struct UpdateResult {
+    std::vector<double> done_sec;    // Per node that verified the new version
+    uint64_t reachable = 0;          // Nodes with a path to a source
+    int max_hops = 0;
+    uint64_t bytes_on_air = 0;       // Update frames, headers included
+    double airtime_sec = 0.0;
+    uint64_t data_frames = 0;
+    uint64_t requests = 0;
+    uint64_t adverts = 0;
+    uint64_t deduplicated_bytes = 0; // By the nodes that finished
+    uint64_t verify_failures = 0;
+};
+
+// Runs MeshTransfer on every node, as LoraMesh does: the same timings
+// (LoraMesh::updatePacketGap and updateRequestTimeout, adverts from the
+// shortest heartbeat interval to update_advert_max_sec) and frames. Only
+// the update frames are simulated, no heartbeats. Sources start with the
+// new file; the others with the old one (dedup) or with nothing to
+// deduplicate against (full transfer).
+class UpdateProtocol : public Protocol {
+public:
+    enum Timer { POLL };
+
+    UpdateProtocol(const UpdateOptions& options, int nodes, uint32_t seed,
+                   const std::vector<uint8_t>& old_file, const std::vector<uint8_t>& new_file)
+        : options_(options), old_file_(old_file), new_file_(new_file), nodes_(nodes) {
+        std::mt19937 rng(seed + 1);
+        std::vector<int> order(nodes);
+        for (int i = 0; i < nodes; i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int i = 0; i < std::min(options.sources, nodes); i++) {
+            nodes_[order[i]].source = true;
+        }
+    }
+
+    void start(Simulator& sim, int id) override {
+        const LoraConfig& lora = sim.lora();
+        Node& node = nodes_[id];
+        node.transfer = std::make_unique<MeshTransfer>(id * 2246822519u + 1u);
+        node.transfer->setKey(MeshTransfer::Key{});
+        node.transfer->configure(std::chrono::seconds(lora.heartbeat_interval_sec),
+                                 std::chrono::seconds(std::max(lora.update_advert_max_sec,
+                                                               lora.heartbeat_interval_sec)),
+                                 lora.heartbeat_redundancy, LoraMesh::updateRequestTimeout(lora),
+                                 LoraMesh::updatePacketGap(lora));
+        if (node.source) {
+            node.transfer->setFile(TransferKind::MODEL, 2, new_file_.data(), new_file_.size());
+        } else if (options_.dedup) {
+            node.transfer->setFile(TransferKind::MODEL, 1, old_file_.data(), old_file_.size());
+        } else {
+            node.transfer->setFile(TransferKind::MODEL, 1, nullptr, 0);
+        }
+        node.transfer->start(Simulator::clock(0.0));
+        // Nodes come up over one shortest interval
+        std::uniform_real_distribution<double> phase(0.0, lora.heartbeat_interval_sec);
+        wake(sim, id, phase(sim.rng()));
+    }
+
+    void timer(Simulator& sim, int id, int kind, uint64_t tag) override {
+        Node& node = nodes_[id];
+        if (kind != POLL || tag != node.generation) {
+            return;
+        }
+        node.due = -1.0;
+        auto now = Simulator::clock(sim.now());
+        MeshTransfer::Frame out;
+        while (node.transfer->poll(now, out)) {
+            Frame frame{};
+            frame.type = out.type;
+            frame.source = id;
+            frame.destination = out.destination;
+            std::memcpy(frame.payload, out.payload, out.len);
+            frame.payload_len = static_cast<uint8_t>(out.len);
+            bytes_on_air_ += FRAME_OVERHEAD + out.len;
+            sim.transmit(id, frame);
+        }
+        schedule(sim, id);
+    }
+
+    void receive(Simulator& sim, int id, const Frame& frame, double) override {
+        Node& node = nodes_[id];
+        node.transfer->receive(frame.type, frame.source, frame.destination == id, frame.payload,
+                               frame.payload_len, Simulator::clock(sim.now()));
+        TransferKind kind;
+        uint32_t version;
+        while (node.transfer->takeCompleted(kind, version)) {
+            node.done_sec = sim.now();
+        }
+        schedule(sim, id);
+    }
+
+    UpdateResult result(const Simulator& sim) const {
+        UpdateResult r;
+        // Hops from the nearest source
+        std::vector<int> hops(nodes_.size(), -1);
+        std::vector<int> order;
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            if (nodes_[i].source) {
+                hops[i] = 0;
+                order.push_back(static_cast<int>(i));
+            }
+        }
+        for (size_t next = 0; next < order.size(); next++) {
+            for (int m : sim.neighbours(order[next])) {
+                if (hops[m] < 0) {
+                    hops[m] = hops[order[next]] + 1;
+                    order.push_back(m);
+                }
+            }
+        }
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            const Node& node = nodes_[i];
+            if (!node.source && hops[i] > 0) {
+                r.reachable++;
+                r.max_hops = std::max(r.max_hops, hops[i]);
+            }
+            if (node.done_sec >= 0.0) {
+                r.done_sec.push_back(node.done_sec);
+            }
+            const MeshTransferStats& stats = node.transfer->stats();
+            r.data_frames += stats.data_sent;
+            r.requests += stats.requests_sent;
+            r.adverts += stats.adverts_sent;
+            if (node.done_sec >= 0.0) {
+                r.deduplicated_bytes += stats.deduplicated_bytes;
+            }
+            r.verify_failures += stats.verify_failures;
+        }
+        r.bytes_on_air = bytes_on_air_;
+        for (uint8_t type : {MeshTransfer::FRAME_ADVERT, MeshTransfer::FRAME_REQUEST,
+                             MeshTransfer::FRAME_DATA}) {
+            r.airtime_sec += sim.traffic().airtime_sec[type];
+        }
+        return r;
+    }
+
+private:
+    struct Node {
+        bool source = false;
+        std::unique_ptr<MeshTransfer> transfer;
+        uint64_t generation = 0;     // Of the pending POLL timer
+        double due = -1.0;           // ...and its time, -1 = none
+        double done_sec = -1.0;
+    };
+
+    // Poll at the transfer's next due time, unless already sooner
+    void schedule(Simulator& sim, int id) {
+        double due = Simulator::seconds(nodes_[id].transfer->nextDue());
+        if (nodes_[id].due < 0.0 || due < nodes_[id].due) {
+            wake(sim, id, due);
+        }
+    }
+
+    void wake(Simulator& sim, int id, double t) {
+        Node& node = nodes_[id];
+        node.due = std::max(t, sim.now());
+        sim.at(node.due, id, POLL, ++node.generation);
+    }
+
+    UpdateOptions options_;
+    const std::vector<uint8_t>& old_file_;
+    const std::vector<uint8_t>& new_file_;
+    std::vector<Node> nodes_;
+    uint64_t bytes_on_air_ = 0;
+};
+
+double mean(const std::vector<double>& values) {
+    double total = 0.0;
+    for (double v : values) {
+        total += v;
+    }
+    return values.empty() ? 0.0 : total / values.size();
+}
+
+double maximum(const std::vector<double>& values) {
+    return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+void runHeartbeat(const std::vector<int>& sizes, double degree, double hours, uint32_t seed,
+                  const LoraConfig& lora, const MeshOptions& base) {
+    std::printf("Heartbeats: SF%d/%d kHz, mean degree %.0f, %.1f h, %d failures at %.1f h\n",
+                lora.spreading_factor, lora.bandwidth, degree, hours, base.failures, hours / 2);
+    std::printf("  fixed: every %d s, timeout %d s; trickle: %d-%d s, redundancy %d, "
+                "at most %d skipped in a row\n", base.interval_sec, base.node_timeout_sec,
+                base.interval_sec, base.max_interval_sec, base.redundancy, base.max_suppressed);
+    std::printf("%6s %-8s %10s %9s %8s %9s %9s %12s\n", "nodes", "mode", "hb s/node/h",
+                "duty %", "lost %", "skipped", "false TO", "dead listed");
+    for (int nodes : sizes) {
+        double fixed_airtime = 0.0;
+        for (bool trickle : {false, true}) {
+            MeshOptions options = base;
+            options.trickle = trickle;
+            options.join_slots = 0;
+            options.reboots = 0;
+            Simulator sim(nodes, degree, lora, seed);
+            MeshProtocol protocol(options, nodes, hours, seed);
+            sim.run(protocol, hours * 3600.0);
+            MeshResult r = protocol.result(sim);
+
+            double per_node_hour = r.heartbeat_airtime_sec / nodes / hours;
+            if (!trickle) {
+                fixed_airtime = per_node_hour;
+            }
+            uint64_t heard = r.receptions + r.collisions;
+            char dead[48];
+            std::snprintf(dead, sizeof(dead), "%.0f/%.0f s", mean(r.dead_listed_sec),
+                          maximum(r.dead_listed_sec));
+            std::printf("%6d %-8s %10.1f %9.3f %8.1f %9llu %9llu %12s\n", nodes,
+                        trickle ? "trickle" : "fixed", per_node_hour,
+                        100.0 * r.total_airtime_sec / nodes / (hours * 3600.0),
+                        heard ? 100.0 * r.collisions / heard : 0.0,
+                        static_cast<unsigned long long>(r.suppressed),
+                        static_cast<unsigned long long>(r.false_timeouts), dead);
+            if (trickle && fixed_airtime > 0.0) {
+                std::printf("%6s %-8s %9.0f%% less heartbeat airtime%s\n", "", "",
+                            100.0 * (fixed_airtime - per_node_hour) / fixed_airtime,
+                            r.dead_still_listed ? " (some dead nodes still listed at the end)" : "");
+            }
+        }
+    }
+    std::printf("  dead listed: mean/max time from a node's failure to its removal from a "
+                "neighbour's table\n");
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+void runJoin(const std::vector<int>& sizes, double degree, uint32_t seed,
+             const LoraConfig& lora, const MeshOptions& base) {
+    std::printf("Join: SF%d/%d kHz, mean degree %.0f, Trickle heartbeats %d-%d s; "
+                "%d nodes restart one by one after a %.0f s warmup\n", lora.spreading_factor,
+                lora.bandwidth, degree, base.interval_sec, base.max_interval_sec, base.reboots,
+                base.warmup_sec);
+    std::printf("  reply slot %.0f ms, %d slots in the first round, at most %d rounds\n",
+                std::chrono::duration<double, std::milli>(LoraMesh::joinSlot(lora)).count(),
+                base.join_slots, LoraMesh::JOIN_MAX_ROUNDS);
+    std::printf("%6s %-10s %22s %22s %10s %12s\n", "nodes", "mode", "90% view p50/p90 s",
+                "full view p50/p90 s", "not full", "join s/boot");
+    for (int nodes : sizes) {
+        for (int slots : {0, base.join_slots}) {
+            MeshOptions options = base;
+            options.trickle = true;
+            options.failures = 0;
+            options.detections = 0;
+            options.join_slots = slots;
+            double hours = (options.warmup_sec + options.reboots * options.reboot_spacing_sec) / 3600.0;
+            Simulator sim(nodes, degree, lora, seed);
+            MeshProtocol protocol(options, nodes, hours, seed);
+            sim.run(protocol, hours * 3600.0);
+            MeshResult r = protocol.result(sim);
+
+            // Nodes that never got there count as slower than any that did
+            auto spread = [&](std::vector<double> times, char* text, size_t size) {
+                times.resize(std::min(options.reboots, nodes), 1e9);
+                double p50 = percentile(times, 0.5);
+                double p90 = percentile(times, 0.9);
+                std::snprintf(text, size, p90 < 1e9 ? "%.1f/%.1f" : "%.1f/-", p50, p90);
+                if (p50 >= 1e9) {
+                    std::snprintf(text, size, "-/-");
+                }
+            };
+            char most[32];
+            char full[32];
+            spread(r.most_view_sec, most, sizeof(most));
+            spread(r.full_view_sec, full, sizeof(full));
+            // Boots: every node once at the start, then the restarts
+            int boots = nodes + std::min(options.reboots, nodes);
+            std::printf("%6d %-10s %22s %22s %10llu %12.2f\n", nodes,
+                        slots ? "handshake" : "heartbeat", most, full,
+                        static_cast<unsigned long long>(r.views_incomplete),
+                        r.join_airtime_sec / boots);
+        }
+    }
+    std::printf("  view: time from restart until the node lists 90%% / all of its live "
+                "neighbours;\n  not full: restarted nodes still missing one at the next restart\n");
+}
+
+void runRouting(const std::vector<int>& sizes, double degree, double hours, uint32_t seed,
+                double fading_db, const LoraConfig& lora, const MeshOptions& base) {
+    std::printf("Routing: SF%d/%d kHz, mean degree %.0f, %.1f h, %d gateways, fading %.0f dB; "
+                "a %zu-byte report per node every %.0f s after a %.0f s warmup\n",
+                lora.spreading_factor, lora.bandwidth, degree, hours, base.gateways, fading_db,
+                REPORT_LEN, base.report_interval_sec, base.warmup_sec);
+    std::printf("  %d busiest relays fail at %.1f h; acknowledgement timeout %.0f ms\n",
+                base.failures, hours / 2,
+                std::chrono::duration<double, std::milli>(LoraMesh::ackTimeout(lora)).count());
+    std::printf("%6s %-9s %10s %18s %12s %9s %18s %10s\n", "nodes", "mode", "delivered",
+                "latency p50/p90 s", "data s/rep", "duty %", "reroute p50/p90 s", "rerouted");
+    for (int nodes : sizes) {
+        double flood_per_report = 0.0;
+        for (Routing routing : {Routing::FLOOD, Routing::GRADIENT}) {
+            MeshOptions options = base;
+            options.trickle = true;
+            options.detections = 0;
+            options.reboots = 0;
+            options.fail_relays = true;
+            options.routing = routing;
+            Simulator sim(nodes, degree, lora, seed, fading_db);
+            MeshProtocol protocol(options, nodes, hours, seed);
+            sim.run(protocol, hours * 3600.0);
+            MeshResult r = protocol.result(sim);
+
+            double per_report = r.delivered ? r.data_airtime_sec / r.delivered : 0.0;
+            if (routing == Routing::FLOOD) {
+                flood_per_report = per_report;
+            }
+            char latency[32];
+            char reroute[32];
+            std::snprintf(latency, sizeof(latency), "%.1f/%.1f", percentile(r.latency_sec, 0.5),
+                          percentile(r.latency_sec, 0.9));
+            std::snprintf(reroute, sizeof(reroute), "%.1f/%.1f", percentile(r.reroute_sec, 0.5),
+                          percentile(r.reroute_sec, 0.9));
+            char rerouted[32];
+            std::snprintf(rerouted, sizeof(rerouted), "%zu/%llu", r.reroute_sec.size(),
+                          static_cast<unsigned long long>(r.reroutes));
+            double airtime = 0.0;
+            for (double a : sim.traffic().airtime_sec) {
+                airtime += a;
+            }
+            std::printf("%6d %-9s %9.1f%% %18s %12.2f %9.3f %18s %10s\n", nodes,
+                        routing == Routing::FLOOD ? "flood" : "gradient",
+                        r.reports ? 100.0 * r.delivered / r.reports : 0.0, latency, per_report,
+                        100.0 * airtime / nodes / (hours * 3600.0), r.reroutes ? reroute : "-",
+                        rerouted);
+            if (routing == Routing::GRADIENT && flood_per_report > 0.0 && per_report > 0.0) {
+                std::printf("%6s %-9s %9.0f%% less airtime per delivered report, "
+                            "%llu fallbacks, %llu parent changes\n", "", "",
+                            100.0 * (flood_per_report - per_report) / flood_per_report,
+                            static_cast<unsigned long long>(r.fallbacks),
+                            static_cast<unsigned long long>(r.parent_changes));
+            }
+        }
+    }
+    std::printf("  delivered: reports from nodes with a path to a gateway that reached one;\n"
+                "  data: report and acknowledgement airtime per delivered report;\n"
+                "  reroute: latency of the first report of each node whose parent failed\n");
+}
+
+// Stand-in for a fine-tuned model: random weights (they do not
+// compress), changed_percent of them rewritten in 4 KB runs at random
+// places, and 16 bytes inserted near the start, which shifts every
+// offset after it
+void syntheticModel(size_t size, double changed_percent, uint32_t seed,
+                    std::vector<uint8_t>& old_file, std::vector<uint8_t>& new_file) {
+    std::mt19937 rng(seed);
+    old_file.resize(size);
+    for (uint8_t& b : old_file) {
+        b = static_cast<uint8_t>(rng());
+    }
+    new_file = old_file;
+    constexpr size_t RUN = 4096;
+    size_t runs = static_cast<size_t>(size * changed_percent / 100.0 / RUN + 0.5);
+    std::uniform_int_distribution<size_t> where(0, size > RUN ? size - RUN : 0);
+    for (size_t i = 0; i < runs; i++) {
+        size_t start = where(rng);
+        for (size_t j = start; j < std::min(start + RUN, size); j++) {
+            new_file[j] = static_cast<uint8_t>(rng());
+        }
+    }
+    std::vector<uint8_t> inserted(16);
+    for (uint8_t& b : inserted) {
+        b = static_cast<uint8_t>(rng());
+    }
+    new_file.insert(new_file.begin() + std::min<size_t>(size, 256), inserted.begin(),
+                    inserted.end());
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return false;
+    }
+    data.clear();
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+    return true;
+}
+
+void runUpdate(const std::vector<int>& sizes, double degree, double hours, uint32_t seed,
+               const LoraConfig& lora, const UpdateOptions& base,
+               const std::vector<uint8_t>& old_file, const std::vector<uint8_t>& new_file) {
+    // What the deduplication can save at best: the new file's chunks
+    // found in the old one
+    std::vector<ContentChunk> old_chunks = chunkContent(old_file.data(), old_file.size());
+    std::vector<ContentChunk> new_chunks = chunkContent(new_file.data(), new_file.size());
+    std::unordered_set<uint64_t> known;
+    for (const ContentChunk& c : old_chunks) {
+        known.insert(static_cast<uint64_t>(c.hash) << 32 | c.length);
+    }
+    size_t shared = 0;
+    for (const ContentChunk& c : new_chunks) {
+        if (known.count(static_cast<uint64_t>(c.hash) << 32 | c.length)) {
+            shared += c.length;
+        }
+    }
+    size_t object = MeshTransfer::buildObject(TransferKind::MODEL, 2, new_file.data(),
+                                              new_file.size(), MeshTransfer::Key{}).size();
+
+    std::printf("Update: SF%d/%d kHz, mean degree %.0f, %.1f h, %d sources; "
+                "%.1f%% of the airtime for updates\n", lora.spreading_factor, lora.bandwidth,
+                degree, hours, base.sources, static_cast<double>(lora.update_duty_percent));
+    std::printf("  %zu-byte file over %zu-byte version: %zu chunks, %.1f%% of the bytes in "
+                "chunks of the old file; %zu bytes with header and manifest\n",
+                new_file.size(), old_file.size(), new_chunks.size(),
+                new_file.empty() ? 0.0 : 100.0 * shared / new_file.size(), object);
+    std::printf("  data frame every %.1f s per sender, request timeout %.1f s\n",
+                std::chrono::duration<double>(LoraMesh::updatePacketGap(lora)).count(),
+                std::chrono::duration<double>(LoraMesh::updateRequestTimeout(lora)).count());
+    std::printf("%6s %-6s %5s %9s %22s %10s %12s %11s %9s\n", "nodes", "mode", "hops",
+                "done", "done p50/p90/max h", "data", "bytes on air", "airtime s", "dedup %");
+    for (int nodes : sizes) {
+        uint64_t full_bytes = 0;
+        for (bool dedup : {false, true}) {
+            UpdateOptions options = base;
+            options.dedup = dedup;
+            Simulator sim(nodes, degree, lora, seed);
+            UpdateProtocol protocol(options, nodes, seed, old_file, new_file);
+            sim.run(protocol, hours * 3600.0);
+            UpdateResult r = protocol.result(sim);
+
+            if (!dedup) {
+                full_bytes = r.bytes_on_air;
+            }
+            // Nodes that never finished count as slower than any that did
+            std::vector<double> times = r.done_sec;
+            times.resize(std::max<size_t>(r.reachable, times.size()), 1e9);
+            char done[48];
+            double p50 = percentile(times, 0.5);
+            double p90 = percentile(times, 0.9);
+            double worst = maximum(times);
+            auto hoursText = [](double t, char* text, size_t size) {
+                std::snprintf(text, size, t < 1e9 ? "%.1f" : "-", t / 3600.0);
+            };
+            char a[16];
+            char b[16];
+            char c[16];
+            hoursText(p50, a, sizeof(a));
+            hoursText(p90, b, sizeof(b));
+            hoursText(worst, c, sizeof(c));
+            std::snprintf(done, sizeof(done), "%s/%s/%s", a, b, c);
+            char count[32];
+            std::snprintf(count, sizeof(count), "%zu/%llu", r.done_sec.size(),
+                          static_cast<unsigned long long>(r.reachable));
+            uint64_t received = r.done_sec.size() * new_file.size();
+            std::printf("%6d %-6s %5d %9s %22s %10llu %12llu %11.0f %9.1f\n", nodes,
+                        dedup ? "dedup" : "full", r.max_hops, count, done,
+                        static_cast<unsigned long long>(r.data_frames),
+                        static_cast<unsigned long long>(r.bytes_on_air), r.airtime_sec,
+                        received ? 100.0 * r.deduplicated_bytes / received : 0.0);
+            if (dedup && full_bytes > 0) {
+                std::printf("%6s %-6s %5s %8.0f%% fewer bytes on air than a full transfer%s\n",
+                            "", "", "", 100.0 * (static_cast<double>(full_bytes) - r.bytes_on_air) /
+                            full_bytes, r.verify_failures ? " (some hash checks failed)" : "");
+            }
+        }
+    }
+    std::printf("  done: nodes with a path to a source that verified the new file, and when;\n"
+                "  data: data frames sent; bytes on air: all update frames, headers included;\n"
+                "  dedup: file bytes copied from the old version instead of received\n");
+}
+
+std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string scenario = "heartbeat";
+    std::vector<int> sizes = {100, 500};
+    double degree = 12.0;
+    double hours = 0.0;              // 0 = per scenario
+    uint32_t seed = 1;
+    double fading = 3.0;
+    LoraConfig lora;
+    lora.update_duty_percent = 10;   // Off by default on nodes
+    MeshOptions options;
+    options.join_slots = LoraConfig().join_slots;
+    options.reboots = 50;
+    UpdateOptions update;
+    size_t file_kb = 64;
+    double changed_percent = 5.0;
+    std::string old_path;
+    std::string new_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--scenario" && has_value) {
+            scenario = argv[++i];
+        } else if (arg == "--nodes" && has_value) {
+            sizes = parseList(argv[++i]);
+        } else if (arg == "--degree" && has_value) {
+            degree = std::atof(argv[++i]);
+        } else if (arg == "--hours" && has_value) {
+            hours = std::atof(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            seed = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "--failures" && has_value) {
+            options.failures = std::atoi(argv[++i]);
+        } else if (arg == "--sf" && has_value) {
+            lora.spreading_factor = std::atoi(argv[++i]);
+        } else if (arg == "--interval" && has_value) {
+            options.interval_sec = std::atoi(argv[++i]);
+        } else if (arg == "--max-interval" && has_value) {
+            options.max_interval_sec = std::atoi(argv[++i]);
+        } else if (arg == "--redundancy" && has_value) {
+            options.redundancy = std::atoi(argv[++i]);
+        } else if (arg == "--max-suppressed" && has_value) {
+            options.max_suppressed = std::atoi(argv[++i]);
+        } else if (arg == "--slots" && has_value) {
+            options.join_slots = std::atoi(argv[++i]);
+        } else if (arg == "--reboots" && has_value) {
+            options.reboots = std::atoi(argv[++i]);
+        } else if (arg == "--gateways" && has_value) {
+            options.gateways = std::atoi(argv[++i]);
+        } else if (arg == "--report-interval" && has_value) {
+            options.report_interval_sec = std::atof(argv[++i]);
+        } else if (arg == "--fading" && has_value) {
+            fading = std::atof(argv[++i]);
+        } else if (arg == "--sources" && has_value) {
+            update.sources = std::atoi(argv[++i]);
+        } else if (arg == "--duty" && has_value) {
+            lora.update_duty_percent = std::atoi(argv[++i]);
+        } else if (arg == "--file-kb" && has_value) {
+            file_kb = static_cast<size_t>(std::atoi(argv[++i]));
+        } else if (arg == "--changed-percent" && has_value) {
+            changed_percent = std::atof(argv[++i]);
+        } else if (arg == "--old" && has_value) {
+            old_path = argv[++i];
+        } else if (arg == "--new" && has_value) {
+            new_path = argv[++i];
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--scenario heartbeat|join|routing|update] "
+                         "[--nodes N[,N...]] [--degree D] [--hours H] [--seed S] "
+                         "[--failures N] [--sf SF] [--interval SEC] [--max-interval SEC] "
+                         "[--redundancy K] [--max-suppressed N] [--slots N] [--reboots N] "
+                         "[--gateways N] [--report-interval SEC] [--fading DB] "
+                         "[--sources N] [--duty PCT] [--file-kb KB] [--changed-percent PCT] "
+                         "[--old FILE --new FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    for (int nodes : sizes) {
+        if (nodes < 2) {
+            std::fprintf(stderr, "Need at least 2 nodes\n");
+            return 1;
+        }
+    }
+    Logger::setLevel(LogLevel::WARN);
+    if (hours <= 0.0) {
+        hours = scenario == "update" ? 48.0 : 6.0;
+    }
+
+    if (scenario == "heartbeat") {
+        runHeartbeat(sizes, degree, hours, seed, lora, options);
+    } else if (scenario == "join") {
+        runJoin(sizes, degree, seed, lora, options);
+    } else if (scenario == "routing") {
+        runRouting(sizes, degree, hours, seed, fading, lora, options);
+    } else if (scenario == "update") {
+        std::vector<uint8_t> old_file;
+        std::vector<uint8_t> new_file;
+        if (old_path.empty() != new_path.empty()) {
+            std::fprintf(stderr, "--old and --new go together\n");
+            return 1;
+        }
+        if (!old_path.empty()) {
+            if (!readFile(old_path, old_file) || !readFile(new_path, new_file)) {
+                return 1;
+            }
+        } else {
+            syntheticModel(file_kb * 1024, changed_percent, seed, old_file, new_file);
+        }
+        if (new_file.size() > MeshTransfer::MAX_FILE_SIZE || lora.update_duty_percent <= 0) {
+            std::fprintf(stderr, "Need a file of at most %zu bytes and a positive --duty\n",
+                         MeshTransfer::MAX_FILE_SIZE);
+            return 1;
+        }
+        runUpdate(sizes, degree, hours, seed, lora, update, old_file, new_file);
+    } else {
+        std::fprintf(stderr, "Unknown scenario: %s\n", scenario.c_str());
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
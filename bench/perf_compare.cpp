@@ -0,0 +1,526 @@
+// Performance regression gate
+//
+// Runs sentinel_bench several times (or reads result files), takes the
+// median of each benchmark across runs with a distribution-free confidence
+// interval, and compares it with the checked-in baseline for the hardware
+// profile (bench/baselines/<profile>.json).
+//
+// A benchmark regresses when the whole confidence interval lies above the
+// baseline by more than its tolerance; a median over the tolerance with an
+// interval that still overlaps is reported as noisy but does not fail.
+// Exit status: 0 = no regression, 1 = regression, 2 = usage or I/O error.
+//
+// Usage: sentinel_perf_compare --bench PATH [--runs N] [--samples N]
+//            [--filter SUBSTR] [--profile NAME] [--baseline-dir DIR]
+//            [--update-baseline]
+//        sentinel_perf_compare --results FILE... [options]
+
+#include "utils/json_parser.h"
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+constexpr double DEFAULT_TOLERANCE_PCT = 10.0;
+constexpr double CONFIDENCE = 0.95;
+
+struct Options {
+    std::string bench_path;
+    std::vector<std::string> result_files;
+    int runs = 7;               // Fewest runs whose full range is a 95% CI
+    int samples = 15;
+    std::string filter;
+    std::string profile;
+    std::string baseline_dir = "bench/baselines";
+    bool update_baseline = false;
+};
+
+// Median and confidence interval of one benchmark over all runs
+struct Summary {
+    std::vector<double> runs_ns;
+    double median_ns = 0.0;
+    double ci_low_ns = 0.0;
+    double ci_high_ns = 0.0;
+    double coverage = 0.0;           // Actual confidence of the interval
+};
+
+struct BaselineEntry {
+    double median_ns = 0.0;
+    double ci_low_ns = 0.0;
+    double ci_high_ns = 0.0;
+};
+
+struct Baseline {
+    std::string profile;
+    double default_tolerance_pct = DEFAULT_TOLERANCE_PCT;
+    std::map<std::string, double> tolerance_pct;    // Name or "prefix/"
+    std::map<std::string, BaselineEntry> benchmarks;
+};
+
+std::string readFile(const std::string& path, bool& ok) {
+    std::ifstream file(path, std::ios::binary);
+    ok = file.is_open();
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Split "prefix.NAME.field" into NAME and field (names contain no dots)
+bool splitEntryPath(std::string_view path, std::string_view prefix,
+                    std::string& name, std::string& field) {
+    if (path.substr(0, prefix.size()) != prefix) {
+        return false;
+    }
+    std::string_view rest = path.substr(prefix.size());
+    size_t dot = rest.rfind('.');
+    if (dot == std::string_view::npos) {
+        return false;
+    }
+    name = std::string(rest.substr(0, dot));
+    field = std::string(rest.substr(dot + 1));
+    return true;
+}
+
+// sentinel_bench output: benchmarks[i].name / benchmarks[i].median_ns
+class ResultVisitor : public JsonVisitor {
+public:
+    bool onValue(const JsonPath& path, const JsonValue& value) override {
+        std::string index;
+        std::string field;
+        if (!splitEntryPath(path.str(), "benchmarks", index, field)) {
+            return true;
+        }
+        if (field == "name") {
+            names[index] = value.asString();
+        } else if (field == "median_ns") {
+            double ns = 0.0;
+            if (value.asDouble(ns)) {
+                medians[index] = ns;
+            }
+        }
+        return true;
+    }
+
+    std::map<std::string, std::string> names;      // "[i]" -> name
+    std::map<std::string, double> medians;         // "[i]" -> ns/op
+};
+
+class BaselineVisitor : public JsonVisitor {
+public:
+    explicit BaselineVisitor(Baseline& baseline) : baseline_(baseline) {}
+
+    bool onValue(const JsonPath& path, const JsonValue& value) override {
+        std::string_view key = path.str();
+        std::string name;
+        std::string field;
+        double number = 0.0;
+
+        if (key == "profile") {
+            baseline_.profile = value.asString();
+        } else if (key == "default_tolerance_pct") {
+            value.asDouble(baseline_.default_tolerance_pct);
+        } else if (key.substr(0, 14) == "tolerance_pct.") {
+            if (value.asDouble(number)) {
+                baseline_.tolerance_pct[std::string(key.substr(14))] = number;
+            }
+        } else if (splitEntryPath(key, "benchmarks.", name, field) && value.asDouble(number)) {
+            BaselineEntry& entry = baseline_.benchmarks[name];
+            if (field == "median_ns") {
+                entry.median_ns = number;
+            } else if (field == "ci_low_ns") {
+                entry.ci_low_ns = number;
+            } else if (field == "ci_high_ns") {
+                entry.ci_high_ns = number;
+            }
+        }
+        return true;
+    }
+
+private:
+    Baseline& baseline_;
+};
+
+// P(X <= k) for X ~ Binomial(n, 1/2)
+double binomialCdf(int n, int k) {
+    double sum = 0.0;
+    double term = std::pow(0.5, n);     // C(n, 0) / 2^n
+    for (int i = 0; i <= k; i++) {
+        sum += term;
+        term = term * (n - i) / (i + 1);
+    }
+    return sum;
+}
+
+// Median with an order-statistic confidence interval: [x(k), x(n-k+1)]
+// covers the true median with probability 1 - 2 P(X < k). With fewer than
+// six runs no k reaches 95%, so the full range is used and its actual
+// coverage reported.
+void summarize(Summary& summary) {
+    std::vector<double>& v = summary.runs_ns;
+    std::sort(v.begin(), v.end());
+    const int n = static_cast<int>(v.size());
+
+    summary.median_ns = n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+
+    int k = 1;
+    for (int candidate = n / 2; candidate >= 1; candidate--) {
+        if (1.0 - 2.0 * binomialCdf(n, candidate - 1) >= CONFIDENCE) {
+            k = candidate;
+            break;
+        }
+    }
+    summary.ci_low_ns = v[k - 1];
+    summary.ci_high_ns = v[n - k];
+    summary.coverage = 1.0 - 2.0 * binomialCdf(n, k - 1);
+}
+
+std::string detectProfile() {
+    // Raspberry Pi boards identify themselves in the device tree
+    bool ok = false;
+    std::string model = readFile("/proc/device-tree/model", ok);
+    if (ok) {
+        if (model.find("Raspberry Pi 4") != std::string::npos) {
+            return "pi4";
+        }
+        if (model.find("Raspberry Pi 5") != std::string::npos) {
+            return "pi5";
+        }
+    }
+
+    struct utsname system_info;
+    if (uname(&system_info) == 0) {
+        return system_info.machine;
+    }
+    return "unknown";
+}
+
+double toleranceFor(const Baseline& baseline, const std::string& name) {
+    auto exact = baseline.tolerance_pct.find(name);
+    if (exact != baseline.tolerance_pct.end()) {
+        return exact->second;
+    }
+
+    // Longest matching "group/" prefix
+    double tolerance = baseline.default_tolerance_pct;
+    size_t best = 0;
+    for (const auto& pair : baseline.tolerance_pct) {
+        const std::string& prefix = pair.first;
+        if (!prefix.empty() && prefix.back() == '/' && prefix.size() > best &&
+            name.compare(0, prefix.size(), prefix) == 0) {
+            tolerance = pair.second;
+            best = prefix.size();
+        }
+    }
+    return tolerance;
+}
+
+// Run sentinel_bench once, writing JSON to output_path
+bool runBench(const Options& options, const std::string& output_path) {
+    std::vector<std::string> args = {
+        options.bench_path, "--output", output_path,
+        "--samples", std::to_string(options.samples),
+    };
+    if (!options.filter.empty()) {
+        args.push_back("--filter");
+        args.push_back(options.filter);
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        std::vector<char*> argv;
+        for (std::string& arg : args) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(nullptr);
+        execv(argv[0], argv.data());
+        std::perror(argv[0]);
+        _exit(127);
+    }
+
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::fprintf(stderr, "%s failed\n", options.bench_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool loadResults(const std::string& path, std::map<std::string, Summary>& summaries) {
+    bool ok = false;
+    std::string text = readFile(path, ok);
+    if (!ok) {
+        std::fprintf(stderr, "Cannot read %s\n", path.c_str());
+        return false;
+    }
+
+    JsonParser parser;
+    ResultVisitor visitor;
+    if (!parser.parse(text, visitor)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), parser.getError().c_str());
+        return false;
+    }
+    for (const auto& pair : visitor.names) {
+        auto median = visitor.medians.find(pair.first);
+        if (median != visitor.medians.end()) {
+            summaries[pair.second].runs_ns.push_back(median->second);
+        }
+    }
+    return true;
+}
+
+bool loadBaseline(const std::string& path, Baseline& baseline, bool& exists) {
+    std::string text = readFile(path, exists);
+    if (!exists) {
+        return true;
+    }
+
+    JsonParser parser;
+    BaselineVisitor visitor(baseline);
+    if (!parser.parse(text, visitor)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), parser.getError().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool writeBaseline(const std::string& path, const Baseline& baseline,
+                   const std::map<std::string, Summary>& summaries) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+        return false;
+    }
+
+    char number[64];
+    auto format = [&number](double value) {
+        std::snprintf(number, sizeof(number), "%.2f", value);
+        return std::string(number);
+    };
+
+    file << "{\n";
+    file << "  \"profile\": \"" << baseline.profile << "\",\n";
+    file << "  \"default_tolerance_pct\": " << format(baseline.default_tolerance_pct) << ",\n";
+    file << "  \"tolerance_pct\": {";
+    size_t i = 0;
+    for (const auto& pair : baseline.tolerance_pct) {
+        file << (i++ ? ",\n" : "\n") << "    \"" << pair.first << "\": " << format(pair.second);
+    }
+    file << (baseline.tolerance_pct.empty() ? "},\n" : "\n  },\n");
+    file << "  \"benchmarks\": {";
+    i = 0;
+    for (const auto& pair : summaries) {
+        const Summary& s = pair.second;
+        file << (i++ ? ",\n" : "\n") << "    \"" << pair.first << "\": {"
+             << "\"median_ns\": " << format(s.median_ns)
+             << ", \"ci_low_ns\": " << format(s.ci_low_ns)
+             << ", \"ci_high_ns\": " << format(s.ci_high_ns) << "}";
+    }
+    file << (summaries.empty() ? "}\n" : "\n  }\n");
+    file << "}\n";
+    return static_cast<bool>(file);
+}
+
+std::string formatNs(double ns) {
+    char buffer[32];
+    if (ns >= 1e6) {
+        std::snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+    } else if (ns >= 1e3) {
+        std::snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f ns", ns);
+    }
+    return buffer;
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s --bench PATH [--runs N] [--samples N] [--filter SUBSTR]\n"
+                 "          [--profile NAME] [--baseline-dir DIR] [--update-baseline]\n"
+                 "       %s --results FILE... [--profile NAME] [--baseline-dir DIR]\n"
+                 "          [--update-baseline]\n", argv0, argv0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bench" && i + 1 < argc) {
+            options.bench_path = argv[++i];
+        } else if (arg == "--results") {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                options.result_files.push_back(argv[++i]);
+            }
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--profile" && i + 1 < argc) {
+            options.profile = argv[++i];
+        } else if (arg == "--baseline-dir" && i + 1 < argc) {
+            options.baseline_dir = argv[++i];
+        } else if (arg == "--update-baseline") {
+            options.update_baseline = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (options.bench_path.empty() == options.result_files.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (options.profile.empty()) {
+        options.profile = detectProfile();
+    }
+
+    // Collect per-run medians
+    std::map<std::string, Summary> summaries;
+    if (!options.bench_path.empty()) {
+        char path[] = "/tmp/sentinel-perf-XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            std::perror("mkstemp");
+            return 2;
+        }
+        close(fd);
+
+        for (int run = 0; run < options.runs; run++) {
+            std::fprintf(stderr, "Run %d/%d\n", run + 1, options.runs);
+            if (!runBench(options, path) || !loadResults(path, summaries)) {
+                unlink(path);
+                return 2;
+            }
+        }
+        unlink(path);
+    } else {
+        for (const std::string& file : options.result_files) {
+            if (!loadResults(file, summaries)) {
+                return 2;
+            }
+        }
+    }
+
+    if (summaries.empty()) {
+        std::fprintf(stderr, "No benchmark results\n");
+        return 2;
+    }
+    for (auto& pair : summaries) {
+        summarize(pair.second);
+    }
+
+    std::string baseline_path = options.baseline_dir + "/" + options.profile + ".json";
+    Baseline baseline;
+    baseline.profile = options.profile;
+    bool baseline_exists = false;
+    if (!loadBaseline(baseline_path, baseline, baseline_exists)) {
+        return 2;
+    }
+
+    if (options.update_baseline) {
+        // Tolerances are kept; measurements are replaced
+        if (!writeBaseline(baseline_path, baseline, summaries)) {
+            return 2;
+        }
+        std::printf("Baseline %s updated with %zu benchmarks\n",
+                    baseline_path.c_str(), summaries.size());
+        return 0;
+    }
+
+    if (!baseline_exists) {
+        std::fprintf(stderr, "No baseline for profile '%s' (%s).\n"
+                     "Record one on that hardware with --update-baseline.\n",
+                     options.profile.c_str(), baseline_path.c_str());
+        return 2;
+    }
+
+    // Comparison table
+    const Summary& any = summaries.begin()->second;
+    std::printf("Profile %s, %zu runs, %.0f%% CI of the median\n\n", options.profile.c_str(),
+                any.runs_ns.size(), any.coverage * 100.0);
+    std::printf("%-38s %12s %12s %25s %9s %6s  %s\n", "Benchmark", "Baseline", "Current",
+                "CI", "Delta", "Tol", "Status");
+
+    int regressions = 0;
+    int noisy = 0;
+    for (const auto& pair : summaries) {
+        const std::string& name = pair.first;
+        const Summary& current = pair.second;
+        std::string ci = formatNs(current.ci_low_ns) + " - " + formatNs(current.ci_high_ns);
+
+        auto entry = baseline.benchmarks.find(name);
+        if (entry == baseline.benchmarks.end() || entry->second.median_ns <= 0.0) {
+            std::printf("%-38s %12s %12s %25s %9s %6s  %s\n", name.c_str(), "-",
+                        formatNs(current.median_ns).c_str(), ci.c_str(), "-", "-", "NEW");
+            continue;
+        }
+
+        double base = entry->second.median_ns;
+        double tolerance = toleranceFor(baseline, name) / 100.0;
+        double delta = (current.median_ns - base) / base * 100.0;
+
+        const char* status = "ok";
+        if (current.ci_low_ns > base * (1.0 + tolerance)) {
+            status = "REGRESSION";
+            regressions++;
+        } else if (current.median_ns > base * (1.0 + tolerance)) {
+            status = "noisy";
+            noisy++;
+        } else if (current.ci_high_ns < base * (1.0 - tolerance)) {
+            status = "faster";
+        }
+
+        char delta_text[16];
+        char tolerance_text[16];
+        std::snprintf(delta_text, sizeof(delta_text), "%+.1f%%", delta);
+        std::snprintf(tolerance_text, sizeof(tolerance_text), "%.0f%%", tolerance * 100.0);
+        std::printf("%-38s %12s %12s %25s %9s %6s  %s\n", name.c_str(), formatNs(base).c_str(),
+                    formatNs(current.median_ns).c_str(), ci.c_str(), delta_text,
+                    tolerance_text, status);
+    }
+
+    for (const auto& pair : baseline.benchmarks) {
+        if (!summaries.count(pair.first) && options.filter.empty()) {
+            std::printf("%-38s %12s %12s %25s %9s %6s  %s\n", pair.first.c_str(),
+                        formatNs(pair.second.median_ns).c_str(), "-", "-", "-", "-", "MISSING");
+        }
+    }
+
+    std::printf("\n");
+    if (baseline.benchmarks.empty()) {
+        std::printf("Baseline %s has no measurements yet; record them on %s hardware "
+                    "with --update-baseline\n", baseline_path.c_str(), options.profile.c_str());
+    }
+    if (regressions) {
+        std::printf("FAIL: %d regression%s beyond tolerance\n", regressions,
+                    regressions == 1 ? "" : "s");
+        return 1;
+    }
+    if (noisy) {
+        std::printf("OK (%d noisy result%s; rerun with more --runs to resolve)\n", noisy,
+                    noisy == 1 ? "" : "s");
+    } else {
+        std::printf("OK\n");
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,272 @@
+// Plume tracker cost and behaviour on replayed footage
+//
+// Collects one mask per frame, then replays the masks through a
+// PlumeTracker at the given frame rate and times every update(). Masks
+// come from, in order of preference:
+//
+//   --video FILE --model FILE   the segmentation model run on each frame
+//   --video FILE                a stand-in mask: low-saturation pixels that
+//                               differ from a slow running background
+//                               (drifting grey smoke), at 56x56
+//   (neither)                   a synthetic 56x56 sequence: a plume that
+//                               appears at frame 50 and grows while it
+//                               drifts up, a flickering blob that does not
+//                               grow, and speckle noise
+//
+// Reports update() time per frame (p50/p99/max), tracks started, frames
+// with a plume, and when the first plume counted as persistently growing.
+//
+// Usage: sentinel_plume_bench [--video FILE [--model FILE]] [--frames N]
+//                             [--fps F] [--threshold P] [--growth-frames N]
+
+#include "vision/plume_tracker.h"
+#include "vision/tflite_inference.h"
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+constexpr int MASK_SIZE = 56;
+constexpr int PLUME_ONSET = 50;
+
+struct Masks {
+    int height = MASK_SIZE;
+    int width = MASK_SIZE;
+    int channels = 1;
+    std::vector<std::vector<float>> frames;
+};
+
+void syntheticMasks(int frames, Masks& masks) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_int_distribution<int> pixel(0, MASK_SIZE - 1);
+    for (int f = 0; f < frames; f++) {
+        std::vector<float> mask(MASK_SIZE * MASK_SIZE, 0.0f);
+        auto blob = [&](float cx, float cy, float radius, float strength) {
+            for (int y = 0; y < MASK_SIZE; y++) {
+                for (int x = 0; x < MASK_SIZE; x++) {
+                    float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                    float value = strength * std::exp(-d2 / (2.0f * radius * radius));
+                    mask[y * MASK_SIZE + x] = std::max(mask[y * MASK_SIZE + x], value);
+                }
+            }
+        };
+
+        // Growing plume, rising from the lower left
+        if (f >= PLUME_ONSET) {
+            float age = static_cast<float>(f - PLUME_ONSET);
+            blob(14.0f + 0.05f * age, 44.0f - 0.08f * age, std::min(2.0f + 0.06f * age, 14.0f),
+                 0.95f);
+        }
+        // A bright patch that flickers but does not grow (glare, fog)
+        if (f % 7 < 4) {
+            blob(44.0f, 12.0f, 3.0f, 0.8f);
+        }
+        // Speckle
+        for (int i = 0; i < 20; i++) {
+            mask[pixel(rng) * MASK_SIZE + pixel(rng)] = noise(rng);
+        }
+        masks.frames.push_back(std::move(mask));
+    }
+}
+
+bool videoMasks(const std::string& video_path, const std::string& model_path, int frames,
+                Masks& masks) {
+    cv::VideoCapture video(video_path);
+    if (!video.isOpened()) {
+        std::fprintf(stderr, "Cannot open %s\n", video_path.c_str());
+        return false;
+    }
+
+    TFLiteInference engine;
+    int input_height = 0;
+    int input_width = 0;
+    int input_channels = 0;
+    if (!model_path.empty()) {
+        if (!engine.loadModel(model_path)) {
+            return false;
+        }
+        if (!engine.isSegmentation()) {
+            std::fprintf(stderr, "%s is not a segmentation model\n", model_path.c_str());
+            return false;
+        }
+        engine.getInputDimensions(input_height, input_width, input_channels);
+        engine.getOutputShape(masks.height, masks.width, masks.channels);
+    }
+
+    cv::Mat frame;
+    cv::Mat resized;
+    cv::Mat rgb;
+    cv::Mat processed;
+    cv::Mat hsv;
+    cv::Mat background;
+    InferenceResult result;
+    while (static_cast<int>(masks.frames.size()) < frames && video.read(frame) &&
+           !frame.empty()) {
+        if (!model_path.empty()) {
+            cv::resize(frame, resized, cv::Size(input_width, input_height));
+            cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+            rgb.convertTo(processed, CV_32F, 1.0 / 255.0);
+            if (!engine.runInference(processed.ptr<float>(), processed.total() * 3, result)) {
+                return false;
+            }
+            masks.frames.push_back(result.output);
+            continue;
+        }
+
+        // Stand-in mask: grey pixels that changed against the background
+        cv::resize(frame, resized, cv::Size(MASK_SIZE, MASK_SIZE), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(resized, hsv, cv::COLOR_BGR2HSV);
+        resized.convertTo(processed, CV_32F, 1.0 / 255.0);
+        if (background.empty()) {
+            background = processed.clone();
+        }
+        std::vector<float> mask(MASK_SIZE * MASK_SIZE);
+        for (int y = 0; y < MASK_SIZE; y++) {
+            for (int x = 0; x < MASK_SIZE; x++) {
+                cv::Vec3f now = processed.at<cv::Vec3f>(y, x);
+                cv::Vec3f then = background.at<cv::Vec3f>(y, x);
+                float change = (std::abs(now[0] - then[0]) + std::abs(now[1] - then[1]) +
+                                std::abs(now[2] - then[2])) / 3.0f;
+                float grey = 1.0f - hsv.at<cv::Vec3b>(y, x)[1] / 255.0f;
+                mask[y * MASK_SIZE + x] = std::min(1.0f, change * 8.0f) * grey;
+            }
+        }
+        cv::accumulateWeighted(processed, background, 0.02);
+        masks.frames.push_back(std::move(mask));
+    }
+    return !masks.frames.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string video_path;
+    std::string model_path;
+    int frames = 2000;
+    double fps = 5.0;
+    PlumeTrackerConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--video" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            fps = std::atof(argv[++i]);
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            config.threshold = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--growth-frames" && i + 1 < argc) {
+            config.growth_frames = std::atoi(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (frames <= 0 || fps <= 0.0 || (!model_path.empty() && video_path.empty())) {
+        std::fprintf(stderr,
+                     "Usage: %s [--video FILE [--model FILE]] [--frames N] [--fps F] "
+                     "[--threshold P] [--growth-frames N]\n", argv[0]);
+        return 1;
+    }
+
+    Masks masks;
+    const char* source = "synthetic";
+    if (video_path.empty()) {
+        syntheticMasks(frames, masks);
+    } else {
+        if (!videoMasks(video_path, model_path, frames, masks)) {
+            return 1;
+        }
+        source = model_path.empty() ? "video, stand-in masks" : "video, segmentation model";
+    }
+
+    PlumeTracker tracker(config);
+    auto clock = std::chrono::steady_clock::time_point();
+    auto frame_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / fps));
+
+    std::vector<uint64_t> update_ns;
+    update_ns.reserve(masks.frames.size());
+    uint32_t max_id = 0;
+    int plume_frames = 0;
+    int growing_frames = 0;
+    int first_growing = -1;
+    PlumeTrack last{};
+    for (size_t f = 0; f < masks.frames.size(); f++) {
+        auto start = std::chrono::steady_clock::now();
+        tracker.update(masks.frames[f].data(), masks.height, masks.width, masks.channels, clock);
+        const PlumeTrack* plume = tracker.primary();
+        auto end = std::chrono::steady_clock::now();
+        update_ns.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        clock += frame_period;
+
+        for (const PlumeTrack& track : tracker.tracks()) {
+            max_id = std::max(max_id, track.id);
+        }
+        if (plume) {
+            plume_frames++;
+            last = *plume;
+            if (tracker.isPersistent(*plume)) {
+                growing_frames++;
+                if (first_growing < 0) {
+                    first_growing = static_cast<int>(f);
+                    std::printf("First growing plume at frame %zu: track %u, %.1f%% of frame "
+                                "at (%.2f, %.2f), %+.2f%%/s\n",
+                                f, plume->id, 100.0f * plume->area, plume->centroid_x,
+                                plume->centroid_y, 100.0f * plume->growth_rate);
+                }
+            }
+        }
+    }
+
+    std::vector<uint64_t> sorted = update_ns;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double p) {
+        return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+    };
+    double mean = 0.0;
+    for (uint64_t ns : sorted) {
+        mean += ns;
+    }
+    mean /= sorted.size();
+
+    std::printf("Plume tracker: %zu frames (%s), %dx%dx%d masks, %dx%d cells\n",
+                masks.frames.size(), source, masks.height, masks.width, masks.channels,
+                std::min(config.grid, masks.width), std::min(config.grid, masks.height));
+    std::printf("  update() per frame   p50 %.1f us  p99 %.1f us  max %.1f us  mean %.1f us\n",
+                percentile(0.50) / 1000.0, percentile(0.99) / 1000.0, sorted.back() / 1000.0,
+                mean / 1000.0);
+    std::printf("  tracks started       %u\n", max_id);
+    std::printf("  frames with a plume  %d\n", plume_frames);
+    std::printf("  growing plume frames %d\n", growing_frames);
+    if (first_growing >= 0) {
+        std::printf("  first growing frame  %d", first_growing);
+        if (video_path.empty()) {
+            std::printf(" (%d frames, %.1f s after onset)", first_growing - PLUME_ONSET,
+                        (first_growing - PLUME_ONSET) / fps);
+        }
+        std::printf("\n");
+    }
+    if (plume_frames > 0) {
+        std::printf("  last plume           track %u, %.1f%% of frame at (%.2f, %.2f), "
+                    "%+.2f%%/s, %d frames\n",
+                    last.id, 100.0f * last.area, last.centroid_x, last.centroid_y,
+                    100.0f * last.growth_rate, last.frames);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+// Camera preview throughput benchmark
+//
+// Runs a PreviewServer on loopback with simulated viewers (default 10)
+// reading the MJPEG stream, and feeds it synthetic 640x480 frames as fast
+// as the server accepts them. One viewer can be made slow to show that it
+// only drops frames for itself. Reports encodes per offered frame (must
+// be 1: each frame is encoded once for all viewers), frames and bytes
+// delivered per viewer, frames skipped, and the time offerFrame() costs
+// the detection loop.
+//
+// Usage: sentinel_preview_bench [clients] [seconds] [fps] [slow_clients]
+
+#include "vision/preview_server.h"
+#include "utils/logger.h"
+#include <opencv2/core.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+// One simulated viewer: parses the multipart stream and counts frames
+struct Viewer {
+    int fd = -1;
+    bool slow = false;
+    std::string header;              // Response or part header being read
+    size_t body_left = 0;            // JPEG bytes (+ CRLF) still to skip
+    bool in_response = true;         // Still reading the HTTP response header
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+
+    void consume(const char* data, size_t len) {
+        bytes += len;
+        while (len > 0) {
+            if (body_left > 0) {
+                size_t take = std::min(body_left, len);
+                body_left -= take;
+                data += take;
+                len -= take;
+                if (body_left == 0) {
+                    frames++;
+                }
+                continue;
+            }
+            header.push_back(*data++);
+            len--;
+            if (header.size() >= 4 && header.compare(header.size() - 4, 4, "\r\n\r\n") == 0) {
+                if (!in_response) {
+                    size_t at = header.find("Content-Length: ");
+                    body_left = at == std::string::npos ? 0 :
+                                std::strtoul(header.c_str() + at + 16, nullptr, 10) + 2;
+                }
+                in_response = false;
+                header.clear();
+            }
+        }
+    }
+};
+
+int connectViewer(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    const char request[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int clients = argc > 1 ? std::atoi(argv[1]) : 10;
+    int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    int fps = argc > 3 ? std::atoi(argv[3]) : 30;
+    int slow_clients = argc > 4 ? std::atoi(argv[4]) : 1;
+
+    Logger::setLevel(LogLevel::WARN);
+
+    PreviewConfig config;
+    config.enabled = true;
+    config.bind_address = "127.0.0.1";
+    config.port = 0;
+    config.max_clients = clients;
+    config.max_fps = fps;
+    PreviewServer server(config);
+    if (!server.start()) {
+        return 1;
+    }
+
+    std::vector<Viewer> viewers(clients);
+    for (int i = 0; i < clients; i++) {
+        viewers[i].fd = connectViewer(server.port());
+        viewers[i].slow = i < slow_clients;
+        if (viewers[i].fd < 0) {
+            std::cerr << "viewer " << i << ": connect failed" << std::endl;
+            return 1;
+        }
+    }
+
+    // Viewers: fast ones read whatever is there, slow ones 4 KB every 20 ms
+    std::atomic<bool> reading(true);
+    std::thread reader([&] {
+        std::vector<struct pollfd> fds(clients);
+        std::vector<std::chrono::steady_clock::time_point> next_read(clients);
+        char buffer[65536];
+        while (reading) {
+            auto now = std::chrono::steady_clock::now();
+            for (int i = 0; i < clients; i++) {
+                bool due = !viewers[i].slow || now >= next_read[i];
+                fds[i] = {viewers[i].fd, static_cast<short>(due ? POLLIN : 0), 0};
+            }
+            poll(fds.data(), fds.size(), 5);
+            for (int i = 0; i < clients; i++) {
+                if (!(fds[i].revents & POLLIN)) {
+                    continue;
+                }
+                size_t max_len = viewers[i].slow ? 4096 : sizeof(buffer);
+                ssize_t n = recv(viewers[i].fd, buffer, max_len, MSG_DONTWAIT);
+                if (n > 0) {
+                    viewers[i].consume(buffer, static_cast<size_t>(n));
+                }
+                if (viewers[i].slow) {
+                    next_read[i] = now + std::chrono::milliseconds(20);
+                }
+            }
+        }
+    });
+
+    // Synthetic camera frame (noise is the worst case for JPEG)
+    cv::Mat frame(480, 640, CV_8UC3);
+    cv::randu(frame, 0, 255);
+
+    // Let the server register the viewers' requests
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<double> offer_us;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::seconds(seconds);
+    int calls = 0;
+    while (std::chrono::steady_clock::now() < end) {
+        auto now = std::chrono::steady_clock::now();
+        calls++;
+        if (server.wantsFrame(now)) {
+            server.offerFrame(frame, 0.42f, false, 2, now);
+            offer_us.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - now).count());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    reading = false;
+    reader.join();
+
+    PreviewStats stats = server.stats();
+    std::sort(offer_us.begin(), offer_us.end());
+    double offer_p50 = offer_us.empty() ? 0.0 : offer_us[offer_us.size() / 2];
+
+    uint64_t fast_frames = 0;
+    uint64_t fast_bytes = 0;
+    int fast = 0;
+    for (const Viewer& viewer : viewers) {
+        if (!viewer.slow) {
+            fast_frames += viewer.frames;
+            fast_bytes += viewer.bytes;
+            fast++;
+        }
+    }
+
+    std::cout << "preview: " << clients << " viewers (" << slow_clients << " slow), "
+              << elapsed << " s, max " << fps << " fps" << std::endl;
+    std::cout << "offered " << stats.frames_offered << " frames ("
+              << stats.frames_offered / elapsed << " fps), encoded " << stats.frames_encoded
+              << " (" << (stats.frames_offered ? static_cast<double>(stats.frames_encoded) /
+                                                 stats.frames_offered : 0.0)
+              << " per frame)" << std::endl;
+    std::cout << "offerFrame p50 " << offer_p50 << " us; wantsFrame false on "
+              << calls - static_cast<int>(offer_us.size()) << " of " << calls << " calls"
+              << std::endl;
+    if (fast > 0) {
+        std::cout << "fast viewers: " << static_cast<double>(fast_frames) / fast
+                  << " frames each, " << fast_bytes / elapsed / 1e6 << " MB/s total" << std::endl;
+    }
+    for (const Viewer& viewer : viewers) {
+        if (viewer.slow) {
+            std::cout << "slow viewer: " << viewer.frames << " frames" << std::endl;
+        }
+    }
+    std::cout << "server: sent " << stats.frames_sent << " frames, skipped "
+              << stats.frames_skipped << ", " << stats.bytes_sent / 1e6 << " MB" << std::endl;
+
+    for (Viewer& viewer : viewers) {
+        close(viewer.fd);
+    }
+    server.stop();
+    return stats.frames_encoded == stats.frames_offered ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,660 @@
+// Microbenchmarks for the detection hot paths
+//
+// Covers frame preprocessing, mesh message (de)serialization and receive,
+// detecting-node counts, MQ-2 PPM conversion, SensorUtils, the Logger,
+// the jitter monitor and the executor.
+// Inputs are replayed or generated - video frames (or synthetic frames),
+// a synthetic ADC trace and generated mesh traffic - so it runs on any
+// Linux machine without a camera, I2C bus or radio.
+//
+// Results are written as JSON (to stdout, or --output FILE).
+//
+// Usage: sentinel_bench [--filter SUBSTR] [--samples N] [--min-time-ms N]
+//                       [--video FILE] [--output FILE] [--list]
+
+#include "core/config_manager.h"
+#include "network/lora_mesh.h"
+#include "sensors/mq2_sensor.h"
+#include "sensors/sensor_interface.h"
+#include "vision/smoke_detector.h"
+#include "utils/executor.h"
+#include "utils/jitter_monitor.h"
+#include "utils/logger.h"
+#include <fcntl.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+using namespace sentinel;
+
+namespace {
+
+// Keep the compiler from discarding a result
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Options {
+    std::string filter;
+    int samples = 15;
+    int min_time_ms = 20;              // Per sample
+    std::string video_path;
+    std::string output_path;
+    bool list = false;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;               // Per sample
+    int samples;
+    double min_ns;
+    double median_ns;
+    double mean_ns;
+    double p90_ns;
+    double stddev_ns;
+};
+
+// A benchmark body runs its operation `iterations` times
+using BenchBody = std::function<void(uint64_t iterations)>;
+
+struct Benchmark {
+    std::string name;
+    BenchBody body;
+    std::function<void()> setup;       // Runs once before timing (optional)
+    std::function<void()> teardown;    // Runs once after timing (optional)
+};
+
+double elapsedNs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+BenchResult run(const Benchmark& bench, const Options& options) {
+    // Grow the batch until one sample takes at least min_time_ms
+    const double target_ns = options.min_time_ms * 1e6;
+    uint64_t iterations = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        bench.body(iterations);
+        double ns = elapsedNs(start);
+        if (ns >= target_ns || iterations >= (1ull << 32)) {
+            break;
+        }
+        double scale = ns > 0 ? target_ns / ns : 100.0;
+        iterations = static_cast<uint64_t>(iterations * std::clamp(scale * 1.2, 2.0, 100.0));
+    }
+
+    std::vector<double> per_op(options.samples);
+    for (int i = 0; i < options.samples; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench.body(iterations);
+        per_op[i] = elapsedNs(start) / iterations;
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    double sum = 0.0;
+    for (double value : per_op) {
+        sum += value;
+    }
+    double mean = sum / per_op.size();
+    double variance = 0.0;
+    for (double value : per_op) {
+        variance += (value - mean) * (value - mean);
+    }
+
+    BenchResult result;
+    result.name = bench.name;
+    result.iterations = iterations;
+    result.samples = options.samples;
+    result.min_ns = per_op.front();
+    result.median_ns = per_op[per_op.size() / 2];
+    result.mean_ns = mean;
+    result.p90_ns = per_op[std::min(per_op.size() - 1, per_op.size() * 9 / 10)];
+    result.stddev_ns = per_op.size() > 1 ? std::sqrt(variance / (per_op.size() - 1)) : 0.0;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Inputs
+
+// Frames from the video file, or synthetic 640x480 BGR frames (gradient
+// plus noise, so resize and colour conversion see realistic data)
+std::vector<cv::Mat> loadFrames(const std::string& video_path, size_t count) {
+    std::vector<cv::Mat> frames;
+    if (!video_path.empty()) {
+        cv::VideoCapture capture(video_path);
+        cv::Mat frame;
+        while (frames.size() < count && capture.read(frame)) {
+            frames.push_back(frame.clone());
+        }
+        if (frames.empty()) {
+            std::fprintf(stderr, "No frames read from %s, using synthetic frames\n",
+                         video_path.c_str());
+        }
+    }
+
+    cv::RNG rng(0x5e17);
+    while (frames.size() < count) {
+        cv::Mat frame(480, 640, CV_8UC3);
+        for (int y = 0; y < frame.rows; y++) {
+            auto* row = frame.ptr<uint8_t>(y);
+            for (int x = 0; x < frame.cols; x++) {
+                row[x * 3 + 0] = static_cast<uint8_t>((x + frames.size() * 7) & 0xFF);
+                row[x * 3 + 1] = static_cast<uint8_t>(y & 0xFF);
+                row[x * 3 + 2] = static_cast<uint8_t>(rng.uniform(0, 256));
+            }
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+// Clean air with a smoke episode, as 12-bit ADC readings
+std::string writeSensorTrace(const std::string& directory) {
+    std::string path = directory + "/adc_trace.txt";
+    std::ofstream file(path);
+    for (int i = 0; i < 1000; i++) {
+        double base = 400.0 + 25.0 * std::sin(i * 0.05);
+        double smoke = (i % 250 > 180) ? 1600.0 : 0.0;
+        file << static_cast<int>(base + smoke) << "\n";
+    }
+    return path;
+}
+
+// Heartbeats and detection reports from nodes 2..(nodes + 1), serialized
+std::vector<std::vector<uint8_t>> generateMeshTraffic(int nodes, size_t count) {
+    std::vector<std::vector<uint8_t>> frames;
+    frames.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        MeshMessage msg{};
+        msg.source_id = static_cast<uint8_t>(2 + i % nodes);
+        msg.destination_id = 0xFF;
+        if (i % 4 == 0) {
+            msg.type = 0x02;           // Detection
+            msg.payload[0] = (i / nodes) % 3 == 0 ? 1 : 0;
+            msg.payload_len = 1;
+        } else {
+            msg.type = 0x01;           // Heartbeat
+            msg.payload_len = 0;
+        }
+        std::vector<uint8_t> buffer(MAX_PAYLOAD_SIZE + 5);
+        buffer.resize(LoraMesh::serializeMessage(msg, buffer.data()));
+        frames.push_back(std::move(buffer));
+    }
+    return frames;
+}
+
+// Fill a mesh with nodes, of which every third is detecting
+void populateMesh(LoraMesh& mesh, int nodes) {
+    for (int i = 0; i < nodes; i++) {
+        MeshMessage msg{};
+        msg.type = 0x02;
+        msg.source_id = static_cast<uint8_t>(2 + i);
+        msg.destination_id = 0xFF;
+        msg.payload[0] = i % 3 == 0 ? 1 : 0;
+        msg.payload_len = 1;
+        uint8_t buffer[MAX_PAYLOAD_SIZE + 5];
+        size_t len = LoraMesh::serializeMessage(msg, buffer);
+        mesh.receiveFrame(buffer, len);
+    }
+}
+
+// Logger writes to stdout; send it to /dev/null while timing
+class StdoutToNull {
+public:
+    StdoutToNull() : saved_(-1) {}
+    void begin() {
+        std::fflush(stdout);
+        saved_ = dup(STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    void end() {
+        std::fflush(stdout);
+        if (saved_ >= 0) {
+            dup2(saved_, STDOUT_FILENO);
+            close(saved_);
+            saved_ = -1;
+        }
+    }
+
+private:
+    int saved_;
+};
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// ---------------------------------------------------------------------------
+// Output
+
+std::string jsonEscape(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+void writeJson(std::FILE* out, const std::vector<BenchResult>& results) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::tm tm_buf;
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime_r(&now, &tm_buf));
+
+    struct utsname system_info;
+    uname(&system_info);
+
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"context\": {\n");
+    std::fprintf(out, "    \"date\": \"%s\",\n", date);
+    std::fprintf(out, "    \"host\": \"%s\",\n", jsonEscape(system_info.nodename).c_str());
+    std::fprintf(out, "    \"machine\": \"%s\",\n", jsonEscape(system_info.machine).c_str());
+    std::fprintf(out, "    \"kernel\": \"%s\",\n", jsonEscape(system_info.release).c_str());
+    std::fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    std::fprintf(out, "    \"compiler\": \"%s\",\n", jsonEscape(__VERSION__).c_str());
+    std::fprintf(out, "    \"build\": \"%s\"\n", build);
+    std::fprintf(out, "  },\n");
+    std::fprintf(out, "  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        std::fprintf(out, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %d, "
+                     "\"min_ns\": %.2f, \"median_ns\": %.2f, \"mean_ns\": %.2f, "
+                     "\"p90_ns\": %.2f, \"stddev_ns\": %.2f}",
+                     i ? "," : "", jsonEscape(r.name).c_str(),
+                     static_cast<unsigned long long>(r.iterations), r.samples,
+                     r.min_ns, r.median_ns, r.mean_ns, r.p90_ns, r.stddev_ns);
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s [--filter SUBSTR] [--samples N] [--min-time-ms N]\n"
+                 "          [--video FILE] [--output FILE] [--list]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            options.min_time_ms = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--video" && i + 1 < argc) {
+            options.video_path = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (arg == "--list") {
+            options.list = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Subsystem logging would otherwise interleave with the JSON
+    Logger::setLevel(LogLevel::ERROR);
+
+    char scratch_dir[] = "/tmp/sentinel-bench-XXXXXX";
+    if (!mkdtemp(scratch_dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+
+    // Shared inputs
+    std::vector<cv::Mat> frames;
+    SmokeDetector detector("", VisionConfig());
+
+    SensorConfig sensor_config;
+    sensor_config.calibration_time_sec = 0;
+    sensor_config.trace_file = writeSensorTrace(scratch_dir);
+    MQ2Sensor sensor(0x48, sensor_config);
+    bool sensor_ready = false;
+
+    LoraConfig lora_config;
+    std::vector<std::vector<uint8_t>> traffic;
+    LoraMesh receive_mesh(1, lora_config);
+    LoraMesh mesh_8(1, lora_config);
+    LoraMesh mesh_64(1, lora_config);
+    LoraMesh mesh_254(1, lora_config);
+
+    MeshMessage detection_msg{};
+    detection_msg.type = 0x02;
+    detection_msg.source_id = 7;
+    detection_msg.destination_id = 0xFF;
+    detection_msg.payload[0] = 1;
+    detection_msg.payload_len = 1;
+    uint8_t wire[MAX_PAYLOAD_SIZE + 5];
+    size_t wire_len = LoraMesh::serializeMessage(detection_msg, wire);
+
+    std::vector<float> window(64);
+    for (size_t i = 0; i < window.size(); i++) {
+        window[i] = 300.0f + 40.0f * std::sin(i * 0.3f);
+    }
+
+    std::string config_doc = readFile(std::string(SENTINEL_SOURCE_DIR) + "/configs/node_config.json");
+    StdoutToNull quiet;
+
+    std::vector<Benchmark> benchmarks;
+
+    // Vision
+    benchmarks.push_back({"vision/preprocess_frame_640x480",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(detector.preprocessFrame(frames[i % frames.size()]).data);
+            }
+        },
+        [&]() { if (frames.empty()) frames = loadFrames(options.video_path, 30); },
+        nullptr});
+    benchmarks.push_back({"vision/preprocess_frame_640x480_executor",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(detector.preprocessFrame(frames[i % frames.size()]).data);
+            }
+        },
+        [&]() {
+            if (frames.empty()) frames = loadFrames(options.video_path, 30);
+            Executor::start(0);
+        },
+        []() { Executor::stop(); }});
+
+    // Mesh
+    benchmarks.push_back({"mesh/serialize_detection",
+        [&](uint64_t n) {
+            uint8_t buffer[MAX_PAYLOAD_SIZE + 5];
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(LoraMesh::serializeMessage(detection_msg, buffer));
+                doNotOptimize(buffer[0]);
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"mesh/deserialize_detection",
+        [&](uint64_t n) {
+            MeshMessage msg;
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(LoraMesh::deserializeMessage(wire, wire_len, msg));
+                doNotOptimize(msg.payload[0]);
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"mesh/receive_frame_64_nodes",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                const auto& frame = traffic[i % traffic.size()];
+                receive_mesh.receiveFrame(frame.data(), frame.size());
+            }
+        },
+        [&]() { if (traffic.empty()) traffic = generateMeshTraffic(64, 4096); },
+        nullptr});
+    benchmarks.push_back({"mesh/detecting_node_count_8",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(mesh_8.getDetectingNodeCount());
+            }
+        },
+        [&]() { populateMesh(mesh_8, 8); }, nullptr});
+    benchmarks.push_back({"mesh/detecting_node_count_64",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(mesh_64.getDetectingNodeCount());
+            }
+        },
+        [&]() { populateMesh(mesh_64, 64); }, nullptr});
+    benchmarks.push_back({"mesh/detecting_node_count_254",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(mesh_254.getDetectingNodeCount());
+            }
+        },
+        [&]() { populateMesh(mesh_254, 254); }, nullptr});
+
+    // Sensor
+    auto initSensor = [&]() {
+        if (!sensor_ready) {
+            sensor_ready = sensor.initialize();
+        }
+    };
+    benchmarks.push_back({"sensor/get_ppm_trace",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(sensor.getPPM());
+            }
+        }, initSensor, nullptr});
+    benchmarks.push_back({"sensor/analog_to_ppm",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(sensor.analogToPPM(static_cast<int>(300 + (i & 2047))));
+            }
+        }, initSensor, nullptr});
+    benchmarks.push_back({"sensor/detect_smoke_trace",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(sensor.detectSmoke());
+            }
+        }, initSensor, nullptr});
+
+    // SensorUtils
+    benchmarks.push_back({"sensor_utils/resistance_ratio_to_ppm",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                float ratio = 0.5f + (i & 1023) * 0.004f;
+                doNotOptimize(SensorUtils::resistanceRatioToPPM(ratio, -0.44f, 0.53f));
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"sensor_utils/apply_ema",
+        [&](uint64_t n) {
+            float value = 0.0f;
+            for (uint64_t i = 0; i < n; i++) {
+                value = SensorUtils::applyEMA(window[i & 63], value, 0.3f);
+            }
+            doNotOptimize(value);
+        }, nullptr, nullptr});
+    benchmarks.push_back({"sensor_utils/median_of_three",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(SensorUtils::medianOfThree(window[i & 63], window[(i + 1) & 63],
+                                                         window[(i + 2) & 63]));
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"sensor_utils/moving_average_64",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(SensorUtils::calculateMovingAverage(window.data(), 64));
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"sensor_utils/std_dev_64",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(SensorUtils::calculateStdDev(window.data(), 64));
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"sensor_utils/is_outlier_64",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(SensorUtils::isOutlier(window[i & 63] * 1.5f, window.data(), 64, 3.0f));
+            }
+        }, nullptr, nullptr});
+
+    // Logger (output to /dev/null; includes the write and flush)
+    auto quietInfo = [&]() { quiet.begin(); Logger::setLevel(LogLevel::INFO); };
+    auto restore = [&]() { Logger::setLevel(LogLevel::ERROR); quiet.end(); };
+    benchmarks.push_back({"logger/info_string",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                Logger::info("Node " + std::to_string(i & 255) + " detection: TRUE");
+            }
+        }, quietInfo, restore});
+    benchmarks.push_back({"logger/info_literal",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                Logger::info("Sentinel detection loop heartbeat");
+            }
+        }, quietInfo, restore});
+    benchmarks.push_back({"logger/logf",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                Logger::logf(LogLevel::INFO, "Node %u detection: %s",
+                             static_cast<unsigned>(i & 255), "TRUE");
+            }
+        }, quietInfo, restore});
+    benchmarks.push_back({"logger/logf_filtered",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                Logger::logf(LogLevel::DEBUG, "Received heartbeat from node %u",
+                             static_cast<unsigned>(i & 255));
+            }
+        }, quietInfo, restore});
+
+    // Jitter monitor (instrumentation cost per task execution)
+    benchmarks.push_back({"jitter/scope",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                JitterScope timing(JitterTask::MESH_PROCESS);
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"jitter/record_wakeup",
+        [&](uint64_t n) {
+            auto now = JitterMonitor::Clock::now();
+            const auto period = std::chrono::milliseconds(200);
+            for (uint64_t i = 0; i < n; i++) {
+                auto scheduled = now + period * i;
+                JitterMonitor::recordWakeup(JitterTask::VISION_TICK, scheduled,
+                                            scheduled + std::chrono::microseconds(i & 4095),
+                                            period);
+            }
+        }, nullptr, nullptr});
+
+    // Executor: round trip of posted tasks, and the row-parallel loop used
+    // by preprocessing (224 rows of 224 RGB pixels normalized to float)
+    std::atomic<uint64_t> tasks_done(0);
+    std::vector<uint8_t> pixels(224 * 224 * 3);
+    std::vector<float> normalized(pixels.size());
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = static_cast<uint8_t>(i * 7);
+    }
+    auto normalizeRows = [&](size_t begin, size_t end) {
+        for (size_t i = begin * 224 * 3; i < end * 224 * 3; i++) {
+            normalized[i] = pixels[i] * (1.0f / 255.0f);
+        }
+    };
+    benchmarks.push_back({"executor/post_and_run",
+        [&](uint64_t n) {
+            uint64_t target = tasks_done.load() + n;
+            for (uint64_t i = 0; i < n; i++) {
+                Executor::post([&tasks_done]() { tasks_done.fetch_add(1); });
+            }
+            while (tasks_done.load() < target) {
+                std::this_thread::yield();
+            }
+        },
+        []() { Executor::start(0); },
+        []() { Executor::stop(); }});
+    benchmarks.push_back({"executor/normalize_224_sequential",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                normalizeRows(0, 224);
+                doNotOptimize(normalized[i % normalized.size()]);
+            }
+        }, nullptr, nullptr});
+    benchmarks.push_back({"executor/normalize_224_parallel_for",
+        [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                Executor::parallelFor(224, 16, normalizeRows);
+                doNotOptimize(normalized[i % normalized.size()]);
+            }
+        },
+        []() { Executor::start(0); },
+        []() { Executor::stop(); }});
+
+    // Configuration (live reload parses the whole file)
+    benchmarks.push_back({"config/load_node_config",
+        [&](uint64_t n) {
+            ConfigManager manager;
+            for (uint64_t i = 0; i < n; i++) {
+                doNotOptimize(manager.loadFromString(config_doc, "node_config.json"));
+            }
+        }, nullptr, nullptr});
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& bench : benchmarks) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        if (options.list) {
+            std::printf("%s\n", bench.name.c_str());
+            continue;
+        }
+
+        if (bench.setup) {
+            bench.setup();
+        }
+        results.push_back(run(bench, options));
+        if (bench.teardown) {
+            bench.teardown();
+        }
+        std::fprintf(stderr, "%-40s %12.1f ns/op\n", bench.name.c_str(), results.back().median_ns);
+    }
+
+    if (options.list) {
+        return 0;
+    }
+
+    std::FILE* out = stdout;
+    if (!options.output_path.empty()) {
+        out = std::fopen(options.output_path.c_str(), "w");
+        if (!out) {
+            std::perror(options.output_path.c_str());
+            return 2;
+        }
+    }
+    writeJson(out, results);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    std::remove(sensor_config.trace_file.c_str());
+    rmdir(scratch_dir);
+    return 0;
+}
\ No newline at end of file
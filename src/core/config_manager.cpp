@@ -1,62 +1,702 @@
 #include "core/config_manager.h"
+#include "network/mesh_transfer.h"
+#include "utils/json_parser.h"
 #include "utils/logger.h"
+#include "utils/realtime.h"
+#include <cstdio>
 #include <fstream>
 #include <sstream>
-#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace sentinel {
 
+namespace {
+
+// Conversion helpers shared by the binding table. Each returns false and
+// fills in a message describing the problem; the caller adds the location.
+
+bool bindInt(const JsonValue& value, int& out, long long min_val, long long max_val,
+             std::string& error) {
+    long long parsed = 0;
+    if (!value.asInt(parsed)) {
+        error = std::string("expected integer, got ") +
+                (value.type == JsonType::NUMBER ? "non-integer number" : value.typeName());
+        return false;
+    }
+    if (parsed < min_val || parsed > max_val) {
+        error = "value " + std::to_string(parsed) + " out of range [" +
+                std::to_string(min_val) + ", " + std::to_string(max_val) + "]";
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+bool bindDouble(const JsonValue& value, double& out, double min_val, double max_val,
+                std::string& error) {
+    double parsed = 0.0;
+    if (!value.asDouble(parsed)) {
+        error = std::string("expected number, got ") + value.typeName();
+        return false;
+    }
+    if (parsed < min_val || parsed > max_val) {
+        std::ostringstream ss;
+        ss << "value " << parsed << " out of range [" << min_val << ", " << max_val << "]";
+        error = ss.str();
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+bool bindFloat(const JsonValue& value, float& out, double min_val, double max_val,
+               std::string& error) {
+    double parsed = 0.0;
+    if (!bindDouble(value, parsed, min_val, max_val, error)) {
+        return false;
+    }
+    out = static_cast<float>(parsed);
+    return true;
+}
+
+bool bindBool(const JsonValue& value, bool& out, std::string& error) {
+    if (!value.asBool(out)) {
+        error = std::string("expected boolean, got ") + value.typeName();
+        return false;
+    }
+    return true;
+}
+
+bool bindString(const JsonValue& value, std::string& out, std::string& error) {
+    if (value.type != JsonType::STRING) {
+        error = std::string("expected string, got ") + value.typeName();
+        return false;
+    }
+    out = value.asString();
+    return true;
+}
+
+// Byte fields accept either "0x48" style strings or plain numbers
+bool bindByte(const JsonValue& value, uint8_t& out, std::string& error) {
+    long long parsed = 0;
+    if (value.type == JsonType::STRING) {
+        std::string text = value.asString();
+        try {
+            size_t consumed = 0;
+            parsed = std::stoll(text, &consumed, 0);
+            if (consumed != text.size()) {
+                throw std::invalid_argument(text);
+            }
+        } catch (const std::exception&) {
+            error = "invalid byte value \"" + text + "\"";
+            return false;
+        }
+    } else if (!value.asInt(parsed)) {
+        error = std::string("expected byte, got ") + value.typeName();
+        return false;
+    }
+
+    if (parsed < 0 || parsed > 0xFF) {
+        error = "value " + std::to_string(parsed) + " out of range [0x00, 0xFF]";
+        return false;
+    }
+    out = static_cast<uint8_t>(parsed);
+    return true;
+}
+
+bool bindLogLevel(const JsonValue& value, std::string& out, std::string& error) {
+    std::string level;
+    if (!bindString(value, level, error)) {
+        return false;
+    }
+    if (level != "DEBUG" && level != "INFO" && level != "WARN" && level != "ERROR") {
+        error = "unknown log level \"" + level + "\" (expected DEBUG, INFO, WARN or ERROR)";
+        return false;
+    }
+    out = level;
+    return true;
+}
+
+bool bindCpuList(const JsonValue& value, std::string& out, std::string& error) {
+    std::string list;
+    if (!bindString(value, list, error)) {
+        return false;
+    }
+    cpu_set_t cpus;
+    if (!Realtime::parseCpuList(list, cpus)) {
+        error = "invalid CPU list \"" + list + "\" (expected e.g. \"3\" or \"0-2\")";
+        return false;
+    }
+    out = list;
+    return true;
+}
+
+bool bindUpdateKey(const JsonValue& value, std::string& out, std::string& error) {
+    std::string key;
+    if (!bindString(value, key, error)) {
+        return false;
+    }
+    MeshTransfer::Key parsed;
+    if (!key.empty() && !MeshTransfer::parseKey(key, parsed)) {
+        error = "invalid key (expected 32 hex digits)";
+        return false;
+    }
+    out = key;
+    return true;
+}
+
+using Binder = bool (*)(Config&, const JsonValue&, std::string&);
+
+// Every field of node_config.json, keyed by its full path. Array elements
+// use "[]" in place of the index.
+const std::unordered_map<std::string_view, Binder>& bindingTable() {
+    static const std::unordered_map<std::string_view, Binder> table = {
+        // node
+        {"node.id", [](Config& c, const JsonValue& v, std::string& e) {
+            int id = 0;
+            if (!bindInt(v, id, 1, 254, e)) return false; // 0xFF is broadcast
+            c.node_id = static_cast<uint8_t>(id);
+            return true;
+        }},
+        {"node.name", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.node_name, e);
+        }},
+        {"node.location.latitude", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindDouble(v, c.latitude, -90.0, 90.0, e);
+        }},
+        {"node.location.longitude", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindDouble(v, c.longitude, -180.0, 180.0, e);
+        }},
+        {"node.location.elevation", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.elevation, -500.0, 9000.0, e);
+        }},
+
+        // sensor
+        {"sensor.i2c_address", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindByte(v, c.i2c_address, e);
+        }},
+        {"sensor.calibration_time_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.sensor_config.calibration_time_sec, 0, 3600, e);
+        }},
+        {"sensor.smoke_threshold_ppm", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.sensor_config.smoke_threshold_ppm, 1.0, 10000.0, e);
+        }},
+        {"sensor.sampling_interval_ms", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.sensor_config.sampling_interval_ms, 10, 60000, e);
+        }},
+        {"sensor.trace_file", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.sensor_config.trace_file, e);
+        }},
+        {"sensor.trace_rate_hz", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.sensor_config.trace_rate_hz, 0, 10000, e);
+        }},
+
+        // vision
+        {"vision.model_path", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.model_path, e);
+        }},
+        {"vision.camera_device", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.camera_device, 0, 63, e);
+        }},
+        {"vision.frame_width", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.frame_width, 16, 4096, e);
+        }},
+        {"vision.frame_height", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.frame_height, 16, 4096, e);
+        }},
+        {"vision.fps", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.fps, 1, 60, e);
+        }},
+        {"vision.confidence_threshold", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.confidence_threshold, 0.0, 1.0, e);
+        }},
+        {"vision.tile_grid", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.tile_grid, 1, MAX_TILE_GRID, e);
+        }},
+        {"vision.interpreters", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.interpreters, 0, 16, e);
+        }},
+        {"vision.lite_model_path", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.vision_config.lite_model_path, e);
+        }},
+        {"vision.video_source", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.vision_config.video_source, e);
+        }},
+        {"vision.profile_invokes", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.profile_invokes, 0, 100000, e);
+        }},
+        {"vision.profile_path", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.vision_config.profile_path, e);
+        }},
+        {"vision.plume_threshold", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.plume_threshold, 0.0, 1.0, e);
+        }},
+        {"vision.plume_growth_frames", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.plume_growth_frames, 1, 100, e);
+        }},
+        {"vision.night_mode", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.vision_config.night_mode, e);
+        }},
+        {"vision.light_sensor", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.vision_config.light_sensor, e);
+        }},
+        {"vision.night_luma", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.night_luma, 0.0, 255.0, e);
+        }},
+        {"vision.day_luma", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.day_luma, 0.0, 255.0, e);
+        }},
+        {"vision.night_lux", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.night_lux, 0.0, 100000.0, e);
+        }},
+        {"vision.day_lux", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.day_lux, 0.0, 100000.0, e);
+        }},
+        {"vision.night_hold_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.vision_config.night_hold_sec, 0, 3600, e);
+        }},
+        {"vision.night_glow_fraction", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.vision_config.night_glow_fraction, 0.0, 1.0, e);
+        }},
+
+        // lora
+        {"lora.frequency_mhz", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.lora_config.frequency, 137.0, 1020.0, e);
+        }},
+        {"lora.bandwidth_khz", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.bandwidth, 7, 500, e);
+        }},
+        {"lora.spreading_factor", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.spreading_factor, 7, 12, e);
+        }},
+        {"lora.coding_rate", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.coding_rate, 5, 8, e);
+        }},
+        {"lora.tx_power_dbm", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.tx_power, 2, 20, e);
+        }},
+        {"lora.sync_word", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindByte(v, c.lora_config.sync_word, e);
+        }},
+        {"lora.preamble_length", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.preamble_length, 6, 65535, e);
+        }},
+        {"lora.crc_enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.lora_config.crc_enabled, e);
+        }},
+
+        // mesh
+        {"mesh.heartbeat_interval_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.heartbeat_interval_sec, 1, 3600, e);
+        }},
+        {"mesh.heartbeat_max_interval_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.heartbeat_max_interval_sec, 1, 3600, e);
+        }},
+        {"mesh.heartbeat_redundancy", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.heartbeat_redundancy, 0, 255, e);
+        }},
+        {"mesh.join_slots", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.join_slots, 0, 255, e);
+        }},
+        {"mesh.gateway", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.lora_config.gateway, e);
+        }},
+        {"mesh.update_duty_percent", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.update_duty_percent, 0, 100, e);
+        }},
+        {"mesh.update_advert_max_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.update_advert_max_sec, 1, 86400, e);
+        }},
+        {"mesh.update_key", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindUpdateKey(v, c.lora_config.update_key, e);
+        }},
+        {"mesh.node_timeout_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.node_timeout_sec, 1, 86400, e);
+        }},
+        {"mesh.max_retries", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.max_retries, 0, 10, e);
+        }},
+        {"mesh.retry_delay_ms", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.lora_config.retry_delay_ms, 0, 60000, e);
+        }},
+        {"mesh.capture_file", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.lora_config.capture_file, e);
+        }},
+
+        // consensus
+        {"consensus.threshold", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.consensus_threshold, 0.0, 1.0, e);
+        }},
+        {"consensus.timeout_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.consensus_timeout_sec, 0, 600, e);
+        }},
+        {"consensus.min_nodes", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.consensus_min_nodes, 1, 254, e);
+        }},
+
+        // fusion
+        {"fusion.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.fusion_config.enabled, e);
+        }},
+        {"fusion.false_alarm_rate", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.false_alarm_rate, 1e-9, 0.5, e);
+        }},
+        {"fusion.miss_rate", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.miss_rate, 1e-9, 0.5, e);
+        }},
+        {"fusion.clean_ppm", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.clean_ppm, 0.1, 10000.0, e);
+        }},
+        {"fusion.smoke_ppm", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.smoke_ppm, 0.1, 10000.0, e);
+        }},
+        {"fusion.ppm_spread", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.ppm_spread, 0.01, 2.0, e);
+        }},
+        {"fusion.vision_scale", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.vision_scale, 0.0, 10.0, e);
+        }},
+        {"fusion.vision_bias", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.vision_bias, -20.0, 20.0, e);
+        }},
+        {"fusion.max_step", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.fusion_config.max_step, 0.1, 20.0, e);
+        }},
+
+        // alert
+        {"alert.duration_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.alert_duration_sec, 0, 86400, e);
+        }},
+        {"alert.cooldown_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.alert_cooldown_sec, 0, 86400, e);
+        }},
+        {"alert.notification_methods[]", [](Config& c, const JsonValue& v, std::string& e) {
+            std::string method;
+            if (!bindString(v, method, e)) return false;
+            c.notification_methods.push_back(method);
+            return true;
+        }},
+
+        // memory
+        {"memory.report_interval_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.report_interval_sec, 0, 86400, e);
+        }},
+        {"memory.vision_budget_kb", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.vision_budget_kb, 0, 4194304, e);
+        }},
+        {"memory.mesh_budget_kb", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.mesh_budget_kb, 0, 4194304, e);
+        }},
+        {"memory.sensor_budget_kb", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.sensor_budget_kb, 0, 4194304, e);
+        }},
+        {"memory.logging_budget_kb", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.logging_budget_kb, 0, 4194304, e);
+        }},
+        {"memory.storage_budget_kb", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.memory_config.storage_budget_kb, 0, 4194304, e);
+        }},
+        {"memory.shed_load", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.memory_config.shed_load, e);
+        }},
+
+        // jitter
+        {"jitter.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.jitter_config.enabled, e);
+        }},
+        {"jitter.report_interval_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.jitter_config.report_interval_sec, 0, 86400, e);
+        }},
+        {"jitter.overrun_pct", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.jitter_config.overrun_pct, 1, 1000, e);
+        }},
+
+        // realtime
+        {"realtime.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.realtime_config.enabled, e);
+        }},
+        {"realtime.lock_memory", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.realtime_config.lock_memory, e);
+        }},
+        {"realtime.core_cpus", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindCpuList(v, c.realtime_config.core_cpus, e);
+        }},
+        {"realtime.inference_cpus", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindCpuList(v, c.realtime_config.inference_cpus, e);
+        }},
+        {"realtime.core_priority", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.realtime_config.core_priority, 0, 99, e);
+        }},
+        {"realtime.radio_priority", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.realtime_config.radio_priority, 0, 99, e);
+        }},
+
+        // executor
+        {"executor.threads", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.executor_config.threads, 0, 64, e);
+        }},
+
+        // governor
+        {"governor.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.governor_config.enabled, e);
+        }},
+        {"governor.sysfs_root", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.governor_config.sysfs_root, e);
+        }},
+        {"governor.max_temp_c", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.governor_config.max_temp_c, 30.0, 110.0, e);
+        }},
+        {"governor.temp_hysteresis_c", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.governor_config.temp_hysteresis_c, 0.0, 30.0, e);
+        }},
+        {"governor.target_latency_ms", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindFloat(v, c.governor_config.target_latency_ms, 1.0, 10000.0, e);
+        }},
+        {"governor.latency_hysteresis_pct", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.latency_hysteresis_pct, 0, 90, e);
+        }},
+        {"governor.min_fps", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.min_fps, 1, 60, e);
+        }},
+        {"governor.min_threads", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.min_threads, 1, 64, e);
+        }},
+        {"governor.poll_interval_ms", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.poll_interval_ms, 100, 60000, e);
+        }},
+        {"governor.step_down_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.step_down_sec, 0, 3600, e);
+        }},
+        {"governor.step_up_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.governor_config.step_up_sec, 0, 3600, e);
+        }},
+
+        // live
+        {"live.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.live_config.enabled, e);
+        }},
+        {"live.socket_path", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.live_config.socket_path, e);
+        }},
+        {"live.frame_slots", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.live_config.frame_slots, 1, 64, e);
+        }},
+        {"live.frames", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.live_config.frames, e);
+        }},
+
+        // preview
+        {"preview.enabled", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.preview_config.enabled, e);
+        }},
+        {"preview.bind_address", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.preview_config.bind_address, e);
+        }},
+        {"preview.allow_remote", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.preview_config.allow_remote, e);
+        }},
+        {"preview.port", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.preview_config.port, 0, 65535, e);
+        }},
+        {"preview.max_clients", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.preview_config.max_clients, 1, 64, e);
+        }},
+        {"preview.max_fps", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.preview_config.max_fps, 1, 30, e);
+        }},
+        {"preview.jpeg_quality", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.preview_config.jpeg_quality, 10, 100, e);
+        }},
+        {"preview.overlay", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.preview_config.overlay, e);
+        }},
+
+        // system
+        {"system.debug_mode", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.debug_mode, e);
+        }},
+        {"system.log_level", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindLogLevel(v, c.log_level, e);
+        }},
+        {"system.log_file", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.log_file, e);
+        }},
+        {"system.data_directory", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindString(v, c.data_directory, e);
+        }},
+        {"system.warm_restart", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindBool(v, c.warm_restart, e);
+        }},
+        {"system.state_max_age_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.state_max_age_sec, 0, 86400, e);
+        }},
+        {"system.calibration_max_age_sec", [](Config& c, const JsonValue& v, std::string& e) {
+            return bindInt(v, c.calibration_max_age_sec, 0, 604800, e);
+        }},
+    };
+    return table;
+}
+
+// Binds scalars into a Config as the tokenizer reaches them
+class ConfigBinder : public JsonVisitor {
+public:
+    explicit ConfigBinder(Config& config) : config_(config), unknown_count_(0) {}
+
+    bool onValue(const JsonPath& path, const JsonValue& value) override {
+        std::string_view key = path.str();
+
+        // Collapse a trailing array index: "a.b[3]" -> "a.b[]"
+        if (!key.empty() && key.back() == ']') {
+            size_t open = key.rfind('[');
+            array_key_.assign(key.data(), open + 1);
+            array_key_ += ']';
+            key = array_key_;
+        }
+
+        const auto& table = bindingTable();
+        auto it = table.find(key);
+        if (it == table.end()) {
+            if (unknown_count_++ < MAX_UNKNOWN_WARNINGS) {
+                Logger::warn("Ignoring unknown configuration key: " + std::string(path.str()));
+            }
+            return true;
+        }
+
+        std::string message;
+        if (!it->second(config_, value, message)) {
+            error_ = std::to_string(value.line) + ":" + std::to_string(value.column) + ": " +
+                     std::string(path.str()) + ": " + message;
+            return false;
+        }
+        return true;
+    }
+
+    bool onContainer(const JsonPath& path, bool is_array) override {
+        // A configured list replaces the defaults instead of appending to them
+        if (is_array && path.str() == "alert.notification_methods") {
+            config_.notification_methods.clear();
+        }
+        return true;
+    }
+
+    const std::string& getError() const { return error_; }
+    size_t getUnknownCount() const { return unknown_count_; }
+
+private:
+    static constexpr size_t MAX_UNKNOWN_WARNINGS = 8;
+
+    Config& config_;
+    std::string error_;
+    std::string array_key_;
+    size_t unknown_count_;
+};
+
+std::string escapeJson(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() + 2);
+    for (char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    return out;
+}
+
+std::string hexByte(uint8_t value) {
+    char buffer[8];
+    std::snprintf(buffer, sizeof(buffer), "0x%02x", value);
+    return buffer;
+}
+
+} // namespace
+
 ConfigManager::ConfigManager() : is_loaded_(false) {}
 
 ConfigManager::~ConfigManager() {}
 
 bool ConfigManager::loadFromFile(const std::string& filepath) {
     Logger::info("Loading configuration from: " + filepath);
-    
-    std::ifstream file(filepath);
+
+    std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
+        last_error_ = filepath + ": cannot open file";
         Logger::error("Failed to open config file: " + filepath);
         return false;
     }
-    
-    // Parse JSON manually (simple parser for this use case)
-    // In production, use a JSON library like nlohmann/json
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    
-    // Parse node configuration
-    config_.node_id = parseUInt8(content, "\"id\"");
-    
-    // Parse sensor configuration
-    std::string i2c_addr_str = parseString(content, "\"i2c_address\"");
-    config_.i2c_address = static_cast<uint8_t>(std::stoi(i2c_addr_str, nullptr, 16));
-    
-    // Parse vision configuration
-    config_.model_path = parseString(content, "\"model_path\"");
-    
-    // Parse LoRa configuration
-    config_.lora_config.frequency = parseFloat(content, "\"frequency_mhz\"");
-    config_.lora_config.bandwidth = parseInt(content, "\"bandwidth_khz\"");
-    config_.lora_config.spreading_factor = parseInt(content, "\"spreading_factor\"");
-    config_.lora_config.tx_power = parseInt(content, "\"tx_power_dbm\"");
-    config_.lora_config.heartbeat_interval_sec = parseInt(content, "\"heartbeat_interval_sec\"");
-    config_.lora_config.node_timeout_sec = parseInt(content, "\"node_timeout_sec\"");
-    
-    // Parse consensus configuration
-    config_.consensus_threshold = parseFloat(content, "\"threshold\"");
-    config_.consensus_timeout_sec = parseInt(content, "\"timeout_sec\"");
-    
-    // Parse alert configuration
-    config_.alert_duration_sec = parseInt(content, "\"duration_sec\"");
-    
-    // Parse system configuration
-    std::string log_level = parseString(content, "\"log_level\"");
-    config_.debug_mode = (log_level == "DEBUG");
-    
-    is_loaded_ = true;
+
+    // Read the whole file once; the tokenizer works on views into it
+    std::string content;
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    if (size > 0) {
+        content.resize(static_cast<size_t>(size));
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], size);
+    }
+
+    if (!loadFromString(content, filepath)) {
+        return false;
+    }
+
     Logger::info("Configuration loaded successfully");
-    
+    return true;
+}
+
+bool ConfigManager::loadFromString(std::string_view content, const std::string& source) {
+    // Bind into a copy so a bad file never leaves a half-applied config
+    Config parsed;
+    ConfigBinder binder(parsed);
+    JsonParser parser;
+
+    if (!parser.parse(content, binder)) {
+        const std::string& detail = binder.getError().empty() ? parser.getError()
+                                                              : binder.getError();
+        last_error_ = source + ":" + detail;
+        Logger::error("Invalid configuration: " + last_error_);
+        return false;
+    }
+
+    if (binder.getUnknownCount() > 0) {
+        Logger::warn(std::to_string(binder.getUnknownCount()) +
+                    " unknown configuration key(s) ignored in " + source);
+    }
+
+    // Derived settings
+    if (parsed.log_level == "DEBUG") {
+        parsed.debug_mode = true;
+    }
+    parsed.lora_config.debug_mode = parsed.debug_mode;
+
+    if (parsed.lora_config.node_timeout_sec <= parsed.lora_config.heartbeat_interval_sec) {
+        Logger::warn("mesh.node_timeout_sec (" +
+                    std::to_string(parsed.lora_config.node_timeout_sec) +
+                    ") should exceed mesh.heartbeat_interval_sec (" +
+                    std::to_string(parsed.lora_config.heartbeat_interval_sec) + ")");
+    }
+    if (parsed.lora_config.heartbeat_max_interval_sec < parsed.lora_config.heartbeat_interval_sec) {
+        Logger::warn("mesh.heartbeat_max_interval_sec is below mesh.heartbeat_interval_sec - "
+                     "heartbeats stay at the shorter interval");
+        parsed.lora_config.heartbeat_max_interval_sec = parsed.lora_config.heartbeat_interval_sec;
+    }
+
+    config_ = std::move(parsed);
+    last_error_.clear();
+    is_loaded_ = true;
     return true;
 }
 
@@ -66,33 +706,192 @@ bool ConfigManager::saveToFile(const std::string& filepath) const {
         Logger::error("Failed to open config file for writing: " + filepath);
         return false;
     }
-    
-    // Write JSON configuration
+
+    const LoraConfig& lora = config_.lora_config;
+    const SensorConfig& sensor = config_.sensor_config;
+    const VisionConfig& vision = config_.vision_config;
+
+    // Write JSON configuration (same schema as configs/node_config.json)
     file << "{\n";
     file << "  \"node\": {\n";
-    file << "    \"id\": " << static_cast<int>(config_.node_id) << "\n";
+    file << "    \"id\": " << static_cast<int>(config_.node_id) << ",\n";
+    file << "    \"name\": \"" << escapeJson(config_.node_name) << "\",\n";
+    file << "    \"location\": {\n";
+    file << std::setprecision(10);
+    file << "      \"latitude\": " << config_.latitude << ",\n";
+    file << "      \"longitude\": " << config_.longitude << ",\n";
+    file << std::setprecision(6);
+    file << "      \"elevation\": " << config_.elevation << "\n";
+    file << "    }\n";
     file << "  },\n";
     file << "  \"sensor\": {\n";
-    file << "    \"i2c_address\": \"0x" << std::hex << static_cast<int>(config_.i2c_address) << "\"\n";
+    file << "    \"i2c_address\": \"" << hexByte(config_.i2c_address) << "\",\n";
+    file << "    \"calibration_time_sec\": " << sensor.calibration_time_sec << ",\n";
+    file << "    \"smoke_threshold_ppm\": " << sensor.smoke_threshold_ppm << ",\n";
+    file << "    \"sampling_interval_ms\": " << sensor.sampling_interval_ms;
+    // Test inputs are only written when set
+    if (!sensor.trace_file.empty()) {
+        file << ",\n    \"trace_file\": \"" << escapeJson(sensor.trace_file) << "\"";
+        file << ",\n    \"trace_rate_hz\": " << sensor.trace_rate_hz;
+    }
+    file << "\n";
     file << "  },\n";
     file << "  \"vision\": {\n";
-    file << "    \"model_path\": \"" << config_.model_path << "\"\n";
+    file << "    \"model_path\": \"" << escapeJson(config_.model_path) << "\",\n";
+    file << "    \"camera_device\": " << vision.camera_device << ",\n";
+    file << "    \"frame_width\": " << vision.frame_width << ",\n";
+    file << "    \"frame_height\": " << vision.frame_height << ",\n";
+    file << "    \"fps\": " << vision.fps << ",\n";
+    file << "    \"confidence_threshold\": " << vision.confidence_threshold << ",\n";
+    file << "    \"tile_grid\": " << vision.tile_grid << ",\n";
+    file << "    \"interpreters\": " << vision.interpreters << ",\n";
+    file << "    \"plume_threshold\": " << vision.plume_threshold << ",\n";
+    file << "    \"plume_growth_frames\": " << vision.plume_growth_frames << ",\n";
+    file << "    \"night_mode\": " << (vision.night_mode ? "true" : "false") << ",\n";
+    file << "    \"night_luma\": " << vision.night_luma << ",\n";
+    file << "    \"day_luma\": " << vision.day_luma << ",\n";
+    file << "    \"night_lux\": " << vision.night_lux << ",\n";
+    file << "    \"day_lux\": " << vision.day_lux << ",\n";
+    file << "    \"night_hold_sec\": " << vision.night_hold_sec << ",\n";
+    file << "    \"night_glow_fraction\": " << vision.night_glow_fraction;
+    if (!vision.light_sensor.empty()) {
+        file << ",\n    \"light_sensor\": \"" << escapeJson(vision.light_sensor) << "\"";
+    }
+    if (!vision.lite_model_path.empty()) {
+        file << ",\n    \"lite_model_path\": \"" << escapeJson(vision.lite_model_path) << "\"";
+    }
+    if (!vision.video_source.empty()) {
+        file << ",\n    \"video_source\": \"" << escapeJson(vision.video_source) << "\"";
+    }
+    if (vision.profile_invokes > 0) {
+        file << ",\n    \"profile_invokes\": " << vision.profile_invokes;
+    }
+    if (!vision.profile_path.empty()) {
+        file << ",\n    \"profile_path\": \"" << escapeJson(vision.profile_path) << "\"";
+    }
+    file << "\n";
     file << "  },\n";
     file << "  \"lora\": {\n";
-    file << "    \"frequency_mhz\": " << config_.lora_config.frequency << ",\n";
-    file << "    \"bandwidth_khz\": " << config_.lora_config.bandwidth << ",\n";
-    file << "    \"spreading_factor\": " << config_.lora_config.spreading_factor << ",\n";
-    file << "    \"tx_power_dbm\": " << config_.lora_config.tx_power << "\n";
+    file << "    \"frequency_mhz\": " << lora.frequency << ",\n";
+    file << "    \"bandwidth_khz\": " << lora.bandwidth << ",\n";
+    file << "    \"spreading_factor\": " << lora.spreading_factor << ",\n";
+    file << "    \"coding_rate\": " << lora.coding_rate << ",\n";
+    file << "    \"tx_power_dbm\": " << lora.tx_power << ",\n";
+    file << "    \"sync_word\": \"" << hexByte(lora.sync_word) << "\",\n";
+    file << "    \"preamble_length\": " << lora.preamble_length << ",\n";
+    file << "    \"crc_enabled\": " << (lora.crc_enabled ? "true" : "false") << "\n";
+    file << "  },\n";
+    file << "  \"mesh\": {\n";
+    file << "    \"heartbeat_interval_sec\": " << lora.heartbeat_interval_sec << ",\n";
+    file << "    \"heartbeat_max_interval_sec\": " << lora.heartbeat_max_interval_sec << ",\n";
+    file << "    \"heartbeat_redundancy\": " << lora.heartbeat_redundancy << ",\n";
+    file << "    \"join_slots\": " << lora.join_slots << ",\n";
+    file << "    \"gateway\": " << (lora.gateway ? "true" : "false") << ",\n";
+    file << "    \"update_duty_percent\": " << lora.update_duty_percent << ",\n";
+    file << "    \"update_advert_max_sec\": " << lora.update_advert_max_sec << ",\n";
+    file << "    \"update_key\": \"" << escapeJson(lora.update_key) << "\",\n";
+    file << "    \"node_timeout_sec\": " << lora.node_timeout_sec << ",\n";
+    file << "    \"max_retries\": " << lora.max_retries << ",\n";
+    file << "    \"retry_delay_ms\": " << lora.retry_delay_ms << ",\n";
+    file << "    \"capture_file\": \"" << escapeJson(lora.capture_file) << "\"\n";
     file << "  },\n";
     file << "  \"consensus\": {\n";
     file << "    \"threshold\": " << config_.consensus_threshold << ",\n";
-    file << "    \"timeout_sec\": " << config_.consensus_timeout_sec << "\n";
+    file << "    \"timeout_sec\": " << config_.consensus_timeout_sec << ",\n";
+    file << "    \"min_nodes\": " << config_.consensus_min_nodes << "\n";
+    file << "  },\n";
+    const FusionConfig& fusion = config_.fusion_config;
+    file << "  \"fusion\": {\n";
+    file << "    \"enabled\": " << (fusion.enabled ? "true" : "false") << ",\n";
+    file << "    \"false_alarm_rate\": " << fusion.false_alarm_rate << ",\n";
+    file << "    \"miss_rate\": " << fusion.miss_rate << ",\n";
+    file << "    \"clean_ppm\": " << fusion.clean_ppm << ",\n";
+    file << "    \"smoke_ppm\": " << fusion.smoke_ppm << ",\n";
+    file << "    \"ppm_spread\": " << fusion.ppm_spread << ",\n";
+    file << "    \"vision_scale\": " << fusion.vision_scale << ",\n";
+    file << "    \"vision_bias\": " << fusion.vision_bias << ",\n";
+    file << "    \"max_step\": " << fusion.max_step << "\n";
+    file << "  },\n";
+    file << "  \"alert\": {\n";
+    file << "    \"duration_sec\": " << config_.alert_duration_sec << ",\n";
+    file << "    \"cooldown_sec\": " << config_.alert_cooldown_sec << ",\n";
+    file << "    \"notification_methods\": [";
+    for (size_t i = 0; i < config_.notification_methods.size(); i++) {
+        file << (i > 0 ? ", " : "") << "\"" << escapeJson(config_.notification_methods[i]) << "\"";
+    }
+    file << "]\n";
+    file << "  },\n";
+    file << "  \"memory\": {\n";
+    file << "    \"report_interval_sec\": " << config_.memory_config.report_interval_sec << ",\n";
+    file << "    \"vision_budget_kb\": " << config_.memory_config.vision_budget_kb << ",\n";
+    file << "    \"mesh_budget_kb\": " << config_.memory_config.mesh_budget_kb << ",\n";
+    file << "    \"sensor_budget_kb\": " << config_.memory_config.sensor_budget_kb << ",\n";
+    file << "    \"logging_budget_kb\": " << config_.memory_config.logging_budget_kb << ",\n";
+    file << "    \"storage_budget_kb\": " << config_.memory_config.storage_budget_kb << ",\n";
+    file << "    \"shed_load\": " << (config_.memory_config.shed_load ? "true" : "false") << "\n";
+    file << "  },\n";
+    file << "  \"jitter\": {\n";
+    file << "    \"enabled\": " << (config_.jitter_config.enabled ? "true" : "false") << ",\n";
+    file << "    \"report_interval_sec\": " << config_.jitter_config.report_interval_sec << ",\n";
+    file << "    \"overrun_pct\": " << config_.jitter_config.overrun_pct << "\n";
+    file << "  },\n";
+    file << "  \"realtime\": {\n";
+    file << "    \"enabled\": " << (config_.realtime_config.enabled ? "true" : "false") << ",\n";
+    file << "    \"lock_memory\": " << (config_.realtime_config.lock_memory ? "true" : "false") << ",\n";
+    file << "    \"core_cpus\": \"" << escapeJson(config_.realtime_config.core_cpus) << "\",\n";
+    file << "    \"inference_cpus\": \"" << escapeJson(config_.realtime_config.inference_cpus) << "\",\n";
+    file << "    \"core_priority\": " << config_.realtime_config.core_priority << ",\n";
+    file << "    \"radio_priority\": " << config_.realtime_config.radio_priority << "\n";
+    file << "  },\n";
+    file << "  \"executor\": {\n";
+    file << "    \"threads\": " << config_.executor_config.threads << "\n";
+    file << "  },\n";
+    const GovernorConfig& governor = config_.governor_config;
+    file << "  \"governor\": {\n";
+    file << "    \"enabled\": " << (governor.enabled ? "true" : "false") << ",\n";
+    file << "    \"sysfs_root\": \"" << escapeJson(governor.sysfs_root) << "\",\n";
+    file << "    \"max_temp_c\": " << governor.max_temp_c << ",\n";
+    file << "    \"temp_hysteresis_c\": " << governor.temp_hysteresis_c << ",\n";
+    file << "    \"target_latency_ms\": " << governor.target_latency_ms << ",\n";
+    file << "    \"latency_hysteresis_pct\": " << governor.latency_hysteresis_pct << ",\n";
+    file << "    \"min_fps\": " << governor.min_fps << ",\n";
+    file << "    \"min_threads\": " << governor.min_threads << ",\n";
+    file << "    \"poll_interval_ms\": " << governor.poll_interval_ms << ",\n";
+    file << "    \"step_down_sec\": " << governor.step_down_sec << ",\n";
+    file << "    \"step_up_sec\": " << governor.step_up_sec << "\n";
+    file << "  },\n";
+    const LiveExportConfig& live = config_.live_config;
+    file << "  \"live\": {\n";
+    file << "    \"enabled\": " << (live.enabled ? "true" : "false") << ",\n";
+    file << "    \"socket_path\": \"" << escapeJson(live.socket_path) << "\",\n";
+    file << "    \"frame_slots\": " << live.frame_slots << ",\n";
+    file << "    \"frames\": " << (live.frames ? "true" : "false") << "\n";
+    file << "  },\n";
+    const PreviewConfig& preview = config_.preview_config;
+    file << "  \"preview\": {\n";
+    file << "    \"enabled\": " << (preview.enabled ? "true" : "false") << ",\n";
+    file << "    \"bind_address\": \"" << escapeJson(preview.bind_address) << "\",\n";
+    file << "    \"allow_remote\": " << (preview.allow_remote ? "true" : "false") << ",\n";
+    file << "    \"port\": " << preview.port << ",\n";
+    file << "    \"max_clients\": " << preview.max_clients << ",\n";
+    file << "    \"max_fps\": " << preview.max_fps << ",\n";
+    file << "    \"jpeg_quality\": " << preview.jpeg_quality << ",\n";
+    file << "    \"overlay\": " << (preview.overlay ? "true" : "false") << "\n";
+    file << "  },\n";
+    file << "  \"system\": {\n";
+    file << "    \"debug_mode\": " << (config_.debug_mode ? "true" : "false") << ",\n";
+    file << "    \"log_level\": \"" << escapeJson(config_.log_level) << "\",\n";
+    file << "    \"log_file\": \"" << escapeJson(config_.log_file) << "\",\n";
+    file << "    \"data_directory\": \"" << escapeJson(config_.data_directory) << "\",\n";
+    file << "    \"warm_restart\": " << (config_.warm_restart ? "true" : "false") << ",\n";
+    file << "    \"state_max_age_sec\": " << config_.state_max_age_sec << ",\n";
+    file << "    \"calibration_max_age_sec\": " << config_.calibration_max_age_sec << "\n";
     file << "  }\n";
     file << "}\n";
-    
+
     file.close();
     Logger::info("Configuration saved to: " + filepath);
-    
+
     return true;
 }
 
@@ -109,80 +908,8 @@ bool ConfigManager::isLoaded() const {
     return is_loaded_;
 }
 
-// Helper parsing functions
-uint8_t ConfigManager::parseUInt8(const std::string& content, const std::string& key) {
-    size_t pos = content.find(key);
-    if (pos == std::string::npos) return 0;
-    
-    pos = content.find(":", pos);
-    if (pos == std::string::npos) return 0;
-    
-    // Skip whitespace and find number
-    pos++;
-    while (pos < content.size() && (content[pos] == ' ' || content[pos] == '\t')) pos++;
-    
-    std::string number;
-    while (pos < content.size() && (isdigit(content[pos]) || content[pos] == '-')) {
-        number += content[pos++];
-    }
-    
-    return static_cast<uint8_t>(std::stoi(number));
-}
-
-int ConfigManager::parseInt(const std::string& content, const std::string& key) {
-    size_t pos = content.find(key);
-    if (pos == std::string::npos) return 0;
-    
-    pos = content.find(":", pos);
-    if (pos == std::string::npos) return 0;
-    
-    pos++;
-    while (pos < content.size() && (content[pos] == ' ' || content[pos] == '\t')) pos++;
-    
-    std::string number;
-    while (pos < content.size() && (isdigit(content[pos]) || content[pos] == '-')) {
-        number += content[pos++];
-    }
-    
-    return std::stoi(number);
-}
-
-float ConfigManager::parseFloat(const std::string& content, const std::string& key) {
-    size_t pos = content.find(key);
-    if (pos == std::string::npos) return 0.0f;
-    
-    pos = content.find(":", pos);
-    if (pos == std::string::npos) return 0.0f;
-    
-    pos++;
-    while (pos < content.size() && (content[pos] == ' ' || content[pos] == '\t')) pos++;
-    
-    std::string number;
-    while (pos < content.size() && (isdigit(content[pos]) || content[pos] == '.' || content[pos] == '-')) {
-        number += content[pos++];
-    }
-    
-    return std::stof(number);
-}
-
-std::string ConfigManager::parseString(const std::string& content, const std::string& key) {
-    size_t pos = content.find(key);
-    if (pos == std::string::npos) return "";
-    
-    pos = content.find(":", pos);
-    if (pos == std::string::npos) return "";
-    
-    pos = content.find("\"", pos);
-    if (pos == std::string::npos) return "";
-    
-    pos++; // Skip opening quote
-    
-    std::string value;
-    while (pos < content.size() && content[pos] != '\"') {
-        value += content[pos++];
-    }
-    
-    return value;
+const std::string& ConfigManager::getLastError() const {
+    return last_error_;
 }
 
 } // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef SENTINEL_CONFIG_MANAGER_H
+#define SENTINEL_CONFIG_MANAGER_H
+
+#include "core/sentinel_core.h"
+#include <string>
+#include <string_view>
+
+namespace sentinel {
+
+class ConfigManager {
+public:
+    ConfigManager();
+    ~ConfigManager();
+
+    // Load configuration from JSON file
+    bool loadFromFile(const std::string& filepath);
+
+    // Parse configuration from an in-memory JSON document. The document is
+    // tokenized once and every known field is bound as it is encountered;
+    // on error the current configuration is left untouched.
+    bool loadFromString(std::string_view content, const std::string& source = "<string>");
+
+    // Save configuration to JSON file
+    bool saveToFile(const std::string& filepath) const;
+
+    // Access configuration
+    Config getConfig() const;
+    void setConfig(const Config& config);
+    bool isLoaded() const;
+
+    // Path-qualified description of the last load failure
+    // (e.g. "node_config.json:27:28: lora.spreading_factor: value 13 out of range [7, 12]")
+    const std::string& getLastError() const;
+
+private:
+    Config config_;
+    bool is_loaded_;
+    std::string last_error_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_CONFIG_MANAGER_H
\ No newline at end of file
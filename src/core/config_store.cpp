@@ -0,0 +1,100 @@
+#include "core/config_store.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace sentinel {
+
+ConfigStore::ConfigStore(const Config& initial)
+    : current_(new ConfigSnapshot{initial, 1}),
+      next_version_(1) {
+    for (auto& slot : reader_versions_) {
+        slot.store(INACTIVE, std::memory_order_relaxed);
+    }
+}
+
+ConfigStore::~ConfigStore() {
+    // Readers must be gone by now
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    for (const ConfigSnapshot* snapshot : retired_) {
+        delete snapshot;
+    }
+    retired_.clear();
+    delete current_.load();
+}
+
+void ConfigStore::publish(const Config& config) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+
+    auto* snapshot = new ConfigSnapshot{config, ++next_version_};
+    const ConfigSnapshot* previous = current_.exchange(snapshot, std::memory_order_acq_rel);
+    retired_.push_back(previous);
+
+    Logger::info("Published configuration version " + std::to_string(snapshot->version));
+}
+
+void ConfigStore::reclaim() {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+
+    if (retired_.empty()) {
+        return;
+    }
+
+    // Oldest version any reader may still reference
+    uint64_t min_version = INACTIVE;
+    for (const auto& slot : reader_versions_) {
+        min_version = std::min(min_version, slot.load(std::memory_order_seq_cst));
+    }
+
+    auto it = std::remove_if(retired_.begin(), retired_.end(),
+        [min_version](const ConfigSnapshot* snapshot) {
+            if (snapshot->version < min_version) {
+                delete snapshot;
+                return true;
+            }
+            return false;
+        });
+    retired_.erase(it, retired_.end());
+}
+
+size_t ConfigStore::registerReader() {
+    for (size_t i = 0; i < MAX_READERS; i++) {
+        uint64_t expected = INACTIVE;
+        // Version 0 pins everything until the first acquire()
+        if (reader_versions_[i].compare_exchange_strong(expected, 0)) {
+            return i;
+        }
+    }
+
+    // Not recoverable without risking use-after-free in readers
+    Logger::error("ConfigStore: too many readers (max " + std::to_string(MAX_READERS) + ")");
+    std::abort();
+}
+
+void ConfigStore::unregisterReader(size_t slot) {
+    reader_versions_[slot].store(INACTIVE, std::memory_order_release);
+}
+
+// ConfigReader implementation
+
+ConfigReader::ConfigReader(ConfigStore& store)
+    : store_(store),
+      slot_(store.registerReader()),
+      held_(nullptr) {
+    acquire();
+}
+
+ConfigReader::~ConfigReader() {
+    store_.unregisterReader(slot_);
+}
+
+const Config& ConfigReader::acquire() {
+    // Load first, then advertise: the advertised version is never newer
+    // than a snapshot this thread might still be looking at.
+    const ConfigSnapshot* next = store_.current_.load(std::memory_order_seq_cst);
+    store_.reader_versions_[slot_].store(next->version, std::memory_order_seq_cst);
+    held_ = next;
+    return held_->config;
+}
+
+} // namespace sentinel
\ No newline at end of file
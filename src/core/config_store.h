@@ -0,0 +1,94 @@
+#ifndef SENTINEL_CONFIG_STORE_H
+#define SENTINEL_CONFIG_STORE_H
+
+#include "core/sentinel_core.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace sentinel {
+
+class ConfigReader;
+
+// Immutable published configuration
+struct ConfigSnapshot {
+    Config config;
+    uint64_t version;
+};
+
+// Holds the live configuration as an immutable snapshot behind an atomic
+// pointer (quiescent-state RCU). Readers never block: each reader thread
+// owns a ConfigReader and calls acquire() once per cycle, which fetches the
+// newest snapshot and tells the store the previous one is no longer
+// referenced. Old snapshots are freed by reclaim() once every registered
+// reader has moved past them.
+class ConfigStore {
+public:
+    static constexpr size_t MAX_READERS = 16;
+
+    explicit ConfigStore(const Config& initial);
+    ~ConfigStore();
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // Publish a new snapshot (writer side, may be called from any thread)
+    void publish(const Config& config);
+
+    // Version of the newest snapshot
+    uint64_t version() const {
+        return current_.load(std::memory_order_acquire)->version;
+    }
+
+    // Free retired snapshots that no reader can still hold
+    void reclaim();
+
+private:
+    friend class ConfigReader;
+
+    // Slot value for unused reader slots
+    static constexpr uint64_t INACTIVE = UINT64_MAX;
+
+    size_t registerReader();
+    void unregisterReader(size_t slot);
+
+    std::atomic<const ConfigSnapshot*> current_;
+    std::atomic<uint64_t> reader_versions_[MAX_READERS];
+
+    // Writer-side state (never touched by readers)
+    std::mutex writer_mutex_;
+    std::vector<const ConfigSnapshot*> retired_;
+    uint64_t next_version_;
+};
+
+// Per-thread read handle on a ConfigStore
+class ConfigReader {
+public:
+    explicit ConfigReader(ConfigStore& store);
+    ~ConfigReader();
+
+    ConfigReader(const ConfigReader&) = delete;
+    ConfigReader& operator=(const ConfigReader&) = delete;
+
+    // Quiescent point: release the previously acquired snapshot and
+    // return the newest one. The reference stays valid until the next
+    // acquire() or until the reader is destroyed.
+    const Config& acquire();
+
+    // True when a newer snapshot than the one held has been published
+    bool stale() const {
+        return store_.current_.load(std::memory_order_acquire) != held_;
+    }
+
+    uint64_t version() const { return held_->version; }
+
+private:
+    ConfigStore& store_;
+    size_t slot_;
+    const ConfigSnapshot* held_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_CONFIG_STORE_H
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "core/config_watcher.h"
+#include "core/config_manager.h"
+#include "core/config_store.h"
+#include "utils/logger.h"
+#include "utils/realtime.h"
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace sentinel {
+
+ConfigWatcher::ConfigWatcher(const std::string& config_path, ConfigStore& store)
+    : config_path_(config_path),
+      store_(store),
+      inotify_fd_(-1),
+      watch_fd_(-1),
+      wake_fd_(-1),
+      running_(false) {
+    // Watch the directory rather than the file: editors and deploy scripts
+    // usually replace the file via rename, which would orphan a file watch.
+    size_t slash = config_path_.rfind('/');
+    if (slash == std::string::npos) {
+        directory_ = ".";
+        filename_ = config_path_;
+    } else {
+        directory_ = slash == 0 ? "/" : config_path_.substr(0, slash);
+        filename_ = config_path_.substr(slash + 1);
+    }
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start() {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+        Logger::error("inotify_init1 failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    watch_fd_ = inotify_add_watch(inotify_fd_, directory_.c_str(),
+                                  IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watch_fd_ < 0) {
+        Logger::error("Failed to watch " + directory_ + ": " + std::strerror(errno));
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        Logger::error("eventfd failed: " + std::string(std::strerror(errno)));
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    watch_thread_ = std::thread(&ConfigWatcher::watchLoop, this);
+
+    Logger::info("Watching " + config_path_ + " for changes");
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        Logger::warn("Failed to wake config watcher");
+    }
+
+    if (watch_thread_.joinable()) {
+        watch_thread_.join();
+    }
+
+    close(wake_fd_);
+    close(inotify_fd_);
+    wake_fd_ = -1;
+    inotify_fd_ = -1;
+    watch_fd_ = -1;
+}
+
+void ConfigWatcher::watchLoop() {
+    pthread_setname_np(pthread_self(), "config-watch");
+    Realtime::applyRole(ThreadRole::BACKGROUND);
+    alignas(struct inotify_event) char buffer[4096];
+    bool pending = false;
+
+    while (running_) {
+        struct pollfd fds[2];
+        fds[0].fd = inotify_fd_;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake_fd_;
+        fds[1].events = POLLIN;
+
+        // Short timeout while a reload is pending (debounce), otherwise
+        // wake up once a second to free retired snapshots
+        int ready = poll(fds, 2, pending ? DEBOUNCE_MS : 1000);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            Logger::error("Config watcher poll failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        if (ready == 0) {
+            if (pending) {
+                pending = false;
+                reload();
+            }
+            store_.reclaim();
+            continue;
+        }
+
+        // Drain events and check whether any of them concern our file
+        ssize_t len;
+        while ((len = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+            for (char* ptr = buffer; ptr < buffer + len;) {
+                auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+                if (event->len > 0 && filename_ == event->name) {
+                    pending = true;
+                }
+                ptr += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+}
+
+void ConfigWatcher::reload() {
+    Logger::info("Configuration file changed, reloading: " + config_path_);
+
+    ConfigManager manager;
+    if (!manager.loadFromFile(config_path_)) {
+        Logger::error("Keeping current configuration: " + manager.getLastError());
+        return;
+    }
+
+    store_.publish(manager.getConfig());
+}
+
+} // namespace sentinel
\ No newline at end of file
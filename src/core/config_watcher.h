@@ -0,0 +1,50 @@
+#ifndef SENTINEL_CONFIG_WATCHER_H
+#define SENTINEL_CONFIG_WATCHER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace sentinel {
+
+class ConfigStore;
+
+// Watches the configuration file with inotify and publishes a freshly
+// parsed snapshot to the ConfigStore whenever it changes. Parsing happens
+// on the watcher thread, never on the detection loop. Invalid files are
+// logged and ignored so a bad edit cannot take a running node down.
+class ConfigWatcher {
+public:
+    ConfigWatcher(const std::string& config_path, ConfigStore& store);
+    ~ConfigWatcher();
+
+    // Start watching (spawns the watcher thread)
+    bool start();
+
+    // Stop watching and join the thread
+    void stop();
+
+private:
+    void watchLoop();
+    void reload();
+
+    std::string config_path_;
+    std::string directory_;
+    std::string filename_;
+    ConfigStore& store_;
+
+    int inotify_fd_;
+    int watch_fd_;
+    int wake_fd_;     // eventfd used to interrupt poll() on stop()
+
+    std::atomic<bool> running_;
+    std::thread watch_thread_;
+
+    // Delay between the last file event and the re-parse, so editors that
+    // write in several steps are reloaded once
+    static constexpr int DEBOUNCE_MS = 200;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_CONFIG_WATCHER_H
\ No newline at end of file
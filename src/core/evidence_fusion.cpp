@@ -0,0 +1,77 @@
+#include "core/evidence_fusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sentinel {
+
+namespace {
+
+// Floors keeping the logarithms finite
+constexpr float MIN_PPM = 0.1f;
+constexpr float MIN_PROBABILITY = 1e-4f;
+
+} // namespace
+
+EvidenceFusion::EvidenceFusion(const FusionConfig& config)
+    : statistic_(0.0f),
+      detected_(false),
+      decisions_(0) {
+    setConfig(config);
+}
+
+void EvidenceFusion::setConfig(const FusionConfig& config) {
+    double alpha = std::clamp(static_cast<double>(config.false_alarm_rate), 1e-9, 0.5);
+    double beta = std::clamp(static_cast<double>(config.miss_rate), 1e-9, 0.5);
+    upper_ = static_cast<float>(std::log((1.0 - beta) / alpha));
+    lower_ = static_cast<float>(std::log(beta / (1.0 - alpha)));
+
+    // log N(x; mu1, s) - log N(x; mu0, s) = (mu1 - mu0) / s^2 * (x - (mu0 + mu1) / 2)
+    float mu0 = std::log10(std::max(config.clean_ppm, MIN_PPM));
+    float mu1 = std::log10(std::max(config.smoke_ppm, MIN_PPM));
+    float spread = std::max(config.ppm_spread, 0.01f);
+    ppm_gain_ = (mu1 - mu0) / (spread * spread);
+    ppm_mid_ = 0.5f * (mu0 + mu1);
+
+    vision_scale_ = config.vision_scale;
+    vision_bias_ = config.vision_bias;
+    max_step_ = std::max(config.max_step, 0.1f);
+}
+
+float EvidenceFusion::sensorRatio(float ppm) const {
+    return ppm_gain_ * (std::log10(std::max(ppm, MIN_PPM)) - ppm_mid_);
+}
+
+float EvidenceFusion::visionRatio(float confidence) const {
+    float c = std::clamp(confidence, MIN_PROBABILITY, 1.0f - MIN_PROBABILITY);
+    return vision_scale_ * std::log(c / (1.0f - c)) + vision_bias_;
+}
+
+bool EvidenceFusion::addSensor(float ppm) {
+    return add(sensorRatio(ppm));
+}
+
+bool EvidenceFusion::addVision(float confidence) {
+    return add(visionRatio(confidence));
+}
+
+bool EvidenceFusion::add(float ratio) {
+    statistic_ += std::clamp(ratio, -max_step_, max_step_);
+    if (statistic_ > lower_ && statistic_ < upper_) {
+        return false;
+    }
+
+    // A decision: record it and start the next test
+    bool was_detected = detected_;
+    detected_ = statistic_ >= upper_;
+    statistic_ = 0.0f;
+    decisions_++;
+    return detected_ != was_detected;
+}
+
+void EvidenceFusion::reset() {
+    statistic_ = 0.0f;
+    detected_ = false;
+    decisions_ = 0;
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef SENTINEL_EVIDENCE_FUSION_H
+#define SENTINEL_EVIDENCE_FUSION_H
+
+#include "core/sentinel_core.h"
+#include <cstdint>
+
+namespace sentinel {
+
+// Wald sequential probability ratio test over sensor and vision evidence.
+//
+// Each sample adds its log-likelihood ratio log(p(x | smoke) / p(x | clean))
+// to a running sum. The test accepts smoke when the sum reaches
+// log((1 - beta) / alpha) and clean air when it falls to
+// log(beta / (1 - alpha)); after either decision a new test starts from
+// zero, and detected() keeps the last decision. Strong evidence therefore
+// decides within a few samples, weak or conflicting evidence keeps
+// sampling, and clean air keeps resetting the sum instead of letting it
+// run away from the upper bound.
+//
+// Likelihoods:
+//   sensor  log10(PPM) is normal with spread ppm_spread around
+//           log10(clean_ppm) in clean air and log10(smoke_ppm) in smoke.
+//           With equal spreads the ratio is linear in log10(PPM).
+//   vision  the model's confidence c, Platt-calibrated: the ratio is
+//           vision_scale * logit(c) + vision_bias (scale 1, bias 0 for a
+//           model whose scores are calibrated on balanced classes, less
+//           to discount frames that repeat the same scene).
+// Each sample's ratio is clamped to +-max_step, so no single outlier can
+// decide a test.
+//
+// Samples are correlated in practice (frames of the same scene), so
+// alpha and beta are nominal; sentinel_fusion_bench measures the actual
+// false alarm rate and fits the likelihood parameters from a trace.
+class EvidenceFusion {
+public:
+    explicit EvidenceFusion(const FusionConfig& config);
+
+    // New parameters; the running test continues with the new bounds
+    void setConfig(const FusionConfig& config);
+
+    // Add one sample. Returns true when detected() changed. O(1).
+    bool addSensor(float ppm);
+    bool addVision(float confidence);
+
+    // Per-sample log-likelihood ratios, before clamping
+    float sensorRatio(float ppm) const;
+    float visionRatio(float confidence) const;
+
+    bool detected() const { return detected_; }
+    float statistic() const { return statistic_; }
+    float upperBound() const { return upper_; }
+    float lowerBound() const { return lower_; }
+    uint64_t decisions() const { return decisions_; }
+
+    // Clean state: no decision yet, statistic 0
+    void reset();
+
+private:
+    bool add(float ratio);
+
+    float upper_;                    // log((1 - beta) / alpha)
+    float lower_;                    // log(beta / (1 - alpha))
+    float ppm_gain_;                 // Sensor ratio = gain * (log10(PPM) - mid)
+    float ppm_mid_;
+    float vision_scale_;
+    float vision_bias_;
+    float max_step_;
+
+    float statistic_;
+    bool detected_;
+    uint64_t decisions_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_EVIDENCE_FUSION_H
\ No newline at end of file
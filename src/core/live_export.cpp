@@ -0,0 +1,276 @@
+#include "core/live_export.h"
+#include "utils/logger.h"
+#include "utils/realtime.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010   // Linux 5.1
+#endif
+
+namespace sentinel {
+
+LiveExport::LiveExport(const LiveExportConfig& config, size_t frame_capacity)
+    : config_(config),
+      frame_capacity_(config.frames ? frame_capacity : 0),
+      memfd_(-1),
+      reader_fd_(-1),
+      listen_fd_(-1),
+      wake_fd_(-1),
+      region_(nullptr),
+      region_size_(0),
+      header_(nullptr),
+      slots_(0),
+      slot_size_(0),
+      frames_published_(0),
+      frames_dropped_(0),
+      running_(false) {
+    if (config_.frame_slots < 1) {
+        config_.frame_slots = 1;
+    }
+}
+
+LiveExport::~LiveExport() {
+    stop();
+}
+
+bool LiveExport::start(const std::string& socket_path) {
+    socket_path_ = socket_path;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path_.size() >= sizeof(addr.sun_path)) {
+        Logger::error("Live export socket path too long: " + socket_path_);
+        return false;
+    }
+    std::memcpy(addr.sun_path, socket_path_.c_str(), socket_path_.size() + 1);
+
+    slots_ = frame_capacity_ > 0 ? static_cast<size_t>(config_.frame_slots) : 0;
+    slot_size_ = liveSlotSize(frame_capacity_);
+    frames_published_ = 0;
+    region_size_ = liveHeaderSize() + slots_ * slot_size_;
+
+    memfd_ = memfd_create("sentinel-live", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd_ < 0) {
+        Logger::error("memfd_create failed: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    if (ftruncate(memfd_, static_cast<off_t>(region_size_)) < 0) {
+        Logger::error("Failed to size live export region: " + std::string(std::strerror(errno)));
+        stop();
+        return false;
+    }
+    // Readers map the full size; make sure it can never change under them
+    fcntl(memfd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+
+    void* map = mmap(nullptr, region_size_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+    if (map == MAP_FAILED) {
+        Logger::error("Failed to map live export region: " + std::string(std::strerror(errno)));
+        stop();
+        return false;
+    }
+    region_ = static_cast<uint8_t*>(map);
+
+    // Only our mapping may write: no new writable mappings or write()s,
+    // and clients get a read-only descriptor as well
+    if (fcntl(memfd_, F_ADD_SEALS, F_SEAL_FUTURE_WRITE) < 0) {
+        Logger::warn("Live export region cannot be sealed against writes: " +
+                     std::string(std::strerror(errno)));
+    }
+    fcntl(memfd_, F_ADD_SEALS, F_SEAL_SEAL);
+    std::string fd_path = "/proc/self/fd/" + std::to_string(memfd_);
+    reader_fd_ = open(fd_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (reader_fd_ < 0) {
+        Logger::error("Failed to open live export region read-only: " +
+                      std::string(std::strerror(errno)));
+        stop();
+        return false;
+    }
+
+    // The region is zero-filled, so every sequence starts even (no data)
+    header_ = new (region_) LiveHeader();
+    header_->magic = LIVE_MAGIC;
+    header_->version = LIVE_FORMAT_VERSION;
+    header_->header_size = sizeof(LiveHeader);
+    header_->frame_slots = static_cast<uint32_t>(slots_);
+    header_->slot_size = slot_size_;
+    header_->slot_capacity = frame_capacity_;
+    header_->writer_pid = getpid();
+    for (size_t i = 0; i < slots_; i++) {
+        new (region_ + liveHeaderSize() + i * slot_size_) LiveSlotHeader();
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        Logger::error("Failed to create live export socket: " + std::string(std::strerror(errno)));
+        stop();
+        return false;
+    }
+    // A socket left behind by a previous run would make bind() fail
+    unlink(socket_path_.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 8) < 0) {
+        Logger::error("Failed to listen on " + socket_path_ + ": " + std::strerror(errno));
+        stop();
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        Logger::error("eventfd failed: " + std::string(std::strerror(errno)));
+        stop();
+        return false;
+    }
+
+    running_ = true;
+    serve_thread_ = std::thread(&LiveExport::serveLoop, this);
+
+    Logger::logf(LogLevel::INFO, "Live export at %s (%zu KB, %zu frame slots)",
+                 socket_path_.c_str(), region_size_ / 1024, slots_);
+    return true;
+}
+
+void LiveExport::stop() {
+    if (running_.exchange(false)) {
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            Logger::warn("Failed to wake live export");
+        }
+        if (serve_thread_.joinable()) {
+            serve_thread_.join();
+        }
+    }
+
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(socket_path_.c_str());
+    }
+    // Readers keep their own mapping; the memory goes once they unmap
+    if (region_) {
+        munmap(region_, region_size_);
+        region_ = nullptr;
+        header_ = nullptr;
+    }
+    if (reader_fd_ >= 0) {
+        close(reader_fd_);
+        reader_fd_ = -1;
+    }
+    if (memfd_ >= 0) {
+        close(memfd_);
+        memfd_ = -1;
+    }
+}
+
+void LiveExport::publishState(const LiveState& state) {
+    if (!header_) {
+        return;
+    }
+    liveWriteBegin(header_->state_seq);
+    std::memcpy(&header_->state, &state, sizeof(state));
+    liveWriteEnd(header_->state_seq);
+}
+
+bool LiveExport::publishFrame(const uint8_t* data, int width, int height, int type,
+                              size_t row_bytes, size_t step, int64_t timestamp_ns) {
+    if (!header_ || slots_ == 0) {
+        return false;
+    }
+    size_t bytes = row_bytes * static_cast<size_t>(height);
+    if (bytes > frame_capacity_) {
+        frames_dropped_++;
+        return false;
+    }
+
+    uint64_t number = ++frames_published_;
+    uint8_t* slot = region_ + liveHeaderSize() + ((number - 1) % slots_) * slot_size_;
+    auto* slot_header = reinterpret_cast<LiveSlotHeader*>(slot);
+    uint8_t* pixels = slot + LIVE_SLOT_HEADER_SIZE;
+
+    liveWriteBegin(slot_header->seq);
+    slot_header->frame_number = number;
+    slot_header->timestamp_ns = timestamp_ns;
+    slot_header->width = width;
+    slot_header->height = height;
+    slot_header->type = type;
+    slot_header->step = static_cast<uint32_t>(row_bytes);
+    slot_header->bytes = bytes;
+    if (step == row_bytes) {
+        std::memcpy(pixels, data, bytes);
+    } else {
+        for (int y = 0; y < height; y++) {
+            std::memcpy(pixels + y * row_bytes, data + y * step, row_bytes);
+        }
+    }
+    liveWriteEnd(slot_header->seq);
+
+    header_->latest_frame.store(number, std::memory_order_release);
+    return true;
+}
+
+void LiveExport::serveLoop() {
+    pthread_setname_np(pthread_self(), "live-export");
+    Realtime::applyRole(ThreadRole::BACKGROUND);
+
+    while (running_) {
+        struct pollfd fds[2];
+        fds[0].fd = listen_fd_;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake_fd_;
+        fds[1].events = POLLIN;
+
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            Logger::error("Live export poll failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+
+        // Hand each client the read-only memfd and the region size, then
+        // hang up; everything after that goes through the mapping
+        int client;
+        while ((client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) {
+            uint64_t size = region_size_;
+            struct iovec iov;
+            iov.iov_base = &size;
+            iov.iov_len = sizeof(size);
+
+            alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            struct msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &reader_fd_, sizeof(int));
+
+            if (sendmsg(client, &msg, MSG_NOSIGNAL) < 0) {
+                Logger::warn("Failed to send live export region: " +
+                             std::string(std::strerror(errno)));
+            }
+            close(client);
+        }
+    }
+}
+
+} // namespace sentinel
\ No newline at end of file
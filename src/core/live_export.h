@@ -0,0 +1,76 @@
+#ifndef SENTINEL_LIVE_EXPORT_H
+#define SENTINEL_LIVE_EXPORT_H
+
+#include "core/live_layout.h"
+#include "core/sentinel_core.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace sentinel {
+
+// Publishes the latest detection state and camera frames to local
+// processes (dashboard, recorder) through one memfd-backed shared region.
+//
+// The region holds a header with the state block and a ring of frame
+// slots, all seqlock-versioned (see live_layout.h). Readers get the memfd
+// once over a Unix socket (SCM_RIGHTS) and map it read-only; after that,
+// reading state or a frame takes no syscalls and no copies, and any number
+// of readers can follow without the node knowing about them.
+//
+// The publish calls run on the detection loop: they never block,
+// allocate or make syscalls. A frame costs one copy into its slot, and a
+// slot is reused only every frame_slots frames, which gives readers that
+// long to use a frame in place.
+class LiveExport {
+public:
+    // frame_capacity: largest frame in bytes (width * height * channels)
+    LiveExport(const LiveExportConfig& config, size_t frame_capacity);
+    ~LiveExport();
+
+    // Create and map the region and start serving it at socket_path
+    bool start(const std::string& socket_path);
+    void stop();
+
+    void publishState(const LiveState& state);
+
+    // Copy a frame (rows of row_bytes, step bytes apart in data) into the
+    // next slot, where rows are packed. Returns false (and counts a drop)
+    // if it is larger than the slot capacity.
+    bool publishFrame(const uint8_t* data, int width, int height, int type,
+                      size_t row_bytes, size_t step, int64_t timestamp_ns);
+
+    uint64_t framesPublished() const { return frames_published_; }
+    uint64_t framesDropped() const { return frames_dropped_; }
+
+private:
+    void serveLoop();
+
+    LiveExportConfig config_;
+    size_t frame_capacity_;
+    std::string socket_path_;
+
+    int memfd_;
+    int reader_fd_;                  // Read-only descriptor of the memfd, sent to clients
+    int listen_fd_;
+    int wake_fd_;                    // eventfd used to interrupt poll() on stop()
+    uint8_t* region_;
+    size_t region_size_;
+    LiveHeader* header_;
+
+    // Ring geometry and frame count, never read back from the region:
+    // readers share it and could have changed it
+    size_t slots_;
+    size_t slot_size_;
+    uint64_t frames_published_;
+    uint64_t frames_dropped_;
+
+    std::atomic<bool> running_;
+    std::thread serve_thread_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_LIVE_EXPORT_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef SENTINEL_LIVE_LAYOUT_H
+#define SENTINEL_LIVE_LAYOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <time.h>
+
+namespace sentinel {
+
+// Layout of the live export region shared by LiveExport (the node) and
+// LiveReader (local consumers). Plain structs at fixed offsets; bump
+// LIVE_FORMAT_VERSION when changing any of them.
+//
+//   LiveHeader | frame slot 0 | frame slot 1 | ...
+//
+// Every block is guarded by a seqlock: the single writer makes the
+// sequence odd, writes, and makes it even again. Readers copy (or use in
+// place) and retry if the sequence was odd or changed meanwhile.
+
+constexpr uint32_t LIVE_MAGIC = 0x564c4e53;          // "SNLV"
+constexpr uint32_t LIVE_FORMAT_VERSION = 1;
+constexpr size_t LIVE_SLOT_HEADER_SIZE = 64;
+constexpr size_t LIVE_PAGE_SIZE = 4096;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "seqlocks in shared memory need lock-free 64-bit atomics");
+
+// Latest detection state
+struct LiveState {
+    int64_t timestamp_ns;            // CLOCK_MONOTONIC when published
+    int64_t sensor_time_ms;          // system_clock of the last sensor reading
+    int64_t vision_time_ms;          // system_clock of the last frame
+    float smoke_ppm;
+    float vision_confidence;
+    uint8_t sensor_detected;
+    uint8_t vision_detected;
+    uint8_t alert_state;             // AlertState: 0 idle, 1 pending, 2 alert
+    uint8_t reserved;
+    int32_t active_nodes;            // Mesh peers heard within the node timeout
+    int32_t detecting_nodes;
+    uint32_t reserved2;
+    uint64_t vision_frames;          // Frames classified since start
+};
+
+struct LiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;            // sizeof(LiveHeader)
+    uint32_t frame_slots;
+    uint64_t slot_size;              // Bytes per slot, header included
+    uint64_t slot_capacity;          // Pixel bytes per slot
+    int32_t writer_pid;
+    uint32_t reserved;
+
+    alignas(64) std::atomic<uint64_t> state_seq;
+    LiveState state;
+
+    // Number of the newest complete frame (0 = none yet); frame n lives in
+    // slot (n - 1) % frame_slots
+    alignas(64) std::atomic<uint64_t> latest_frame;
+};
+
+struct LiveSlotHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t frame_number;
+    int64_t timestamp_ns;            // CLOCK_MONOTONIC of the capture
+    int32_t width;
+    int32_t height;
+    int32_t type;                    // OpenCV type, CV_8UC3 (BGR) for camera frames
+    uint32_t step;                   // Bytes per row
+    uint64_t bytes;
+};
+static_assert(sizeof(LiveSlotHeader) <= LIVE_SLOT_HEADER_SIZE, "slot header too large");
+
+inline size_t liveHeaderSize() {
+    return (sizeof(LiveHeader) + LIVE_PAGE_SIZE - 1) / LIVE_PAGE_SIZE * LIVE_PAGE_SIZE;
+}
+
+inline size_t liveSlotSize(size_t capacity) {
+    size_t size = LIVE_SLOT_HEADER_SIZE + capacity;
+    return (size + LIVE_PAGE_SIZE - 1) / LIVE_PAGE_SIZE * LIVE_PAGE_SIZE;
+}
+
+// CLOCK_MONOTONIC in ns, the time base of the region's timestamps
+inline int64_t liveMonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Seqlock writer side (single writer)
+inline void liveWriteBegin(std::atomic<uint64_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void liveWriteEnd(std::atomic<uint64_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Seqlock reader side: copy size bytes from source, retrying while a
+// write is in progress. Returns false after max_attempts torn reads.
+inline bool liveRead(const std::atomic<uint64_t>& seq, const void* source, void* out,
+                     size_t size, int max_attempts = 1000) {
+    for (int attempt = 0; attempt < max_attempts; attempt++) {
+        uint64_t before = seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        std::memcpy(out, source, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace sentinel
+
+#endif // SENTINEL_LIVE_LAYOUT_H
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "core/live_reader.h"
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace sentinel {
+
+LiveReader::LiveReader()
+    : region_(nullptr),
+      region_size_(0),
+      header_(nullptr) {
+}
+
+LiveReader::~LiveReader() {
+    close();
+}
+
+bool LiveReader::open(const std::string& socket_path) {
+    close();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        last_error_ = "Socket path too long: " + socket_path;
+        return false;
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        last_error_ = "socket failed: " + std::string(std::strerror(errno));
+        return false;
+    }
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        last_error_ = "Cannot connect to " + socket_path + ": " + std::strerror(errno);
+        ::close(sock);
+        return false;
+    }
+
+    uint64_t size = 0;
+    struct iovec iov;
+    iov.iov_base = &size;
+    iov.iov_len = sizeof(size);
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    ::close(sock);
+
+    int fd = -1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    if (received != sizeof(size) || fd < 0) {
+        last_error_ = "No live export region received from " + socket_path;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    // Trust the file, not the message, for the size we map
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<uint64_t>(st.st_size) != size ||
+        size < liveHeaderSize()) {
+        last_error_ = "Live export region has an unexpected size";
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        last_error_ = "mmap failed: " + std::string(std::strerror(errno));
+        return false;
+    }
+
+    region_ = static_cast<const uint8_t*>(map);
+    region_size_ = size;
+    header_ = reinterpret_cast<const LiveHeader*>(region_);
+
+    if (header_->magic != LIVE_MAGIC || header_->version != LIVE_FORMAT_VERSION ||
+        header_->header_size != sizeof(LiveHeader) ||
+        liveHeaderSize() + header_->frame_slots * header_->slot_size > region_size_) {
+        last_error_ = "Incompatible live export region (format version " +
+                      std::to_string(header_->version) + ")";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void LiveReader::close() {
+    if (region_) {
+        munmap(const_cast<uint8_t*>(region_), region_size_);
+    }
+    region_ = nullptr;
+    region_size_ = 0;
+    header_ = nullptr;
+}
+
+bool LiveReader::readState(LiveState& state) const {
+    if (!header_ || header_->state_seq.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    return liveRead(header_->state_seq, &header_->state, &state, sizeof(state));
+}
+
+uint64_t LiveReader::latestFrameNumber() const {
+    return header_ ? header_->latest_frame.load(std::memory_order_acquire) : 0;
+}
+
+const LiveSlotHeader* LiveReader::slot(uint64_t frame_number) const {
+    return reinterpret_cast<const LiveSlotHeader*>(
+        region_ + liveHeaderSize() +
+        ((frame_number - 1) % header_->frame_slots) * header_->slot_size);
+}
+
+bool LiveReader::latestFrame(LiveFrame& frame) const {
+    if (!header_ || header_->frame_slots == 0) {
+        return false;
+    }
+
+    // The newest frame's slot is only rewritten frame_slots frames later,
+    // so a retry is rare; it starts over from the then-newest frame
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint64_t number = header_->latest_frame.load(std::memory_order_acquire);
+        if (number == 0) {
+            return false;
+        }
+        const LiveSlotHeader* source = slot(number);
+        uint64_t seq = source->seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+
+        frame.frame_number = source->frame_number;
+        frame.timestamp_ns = source->timestamp_ns;
+        frame.width = source->width;
+        frame.height = source->height;
+        frame.type = source->type;
+        frame.step = source->step;
+        frame.bytes = source->bytes;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source->seq.load(std::memory_order_relaxed) != seq || frame.frame_number != number ||
+            frame.bytes > header_->slot_capacity) {
+            continue;
+        }
+
+        frame.data = reinterpret_cast<const uint8_t*>(source) + LIVE_SLOT_HEADER_SIZE;
+        frame.seq = seq;
+        return true;
+    }
+    return false;
+}
+
+bool LiveReader::valid(const LiveFrame& frame) const {
+    if (!header_ || frame.frame_number == 0) {
+        return false;
+    }
+    // Order the caller's pixel reads before the check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(frame.frame_number)->seq.load(std::memory_order_relaxed) == frame.seq;
+}
+
+} // namespace sentinel
\ No newline at end of file
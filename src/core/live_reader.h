@@ -0,0 +1,79 @@
+#ifndef SENTINEL_LIVE_READER_H
+#define SENTINEL_LIVE_READER_H
+
+#include "core/live_layout.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sentinel {
+
+// A frame in the live export region, used in place
+struct LiveFrame {
+    const uint8_t* data = nullptr;   // Packed rows of step bytes
+    uint64_t frame_number = 0;
+    int64_t timestamp_ns = 0;        // CLOCK_MONOTONIC of the capture
+    int width = 0;
+    int height = 0;
+    int type = 0;                    // OpenCV type (CV_8UC3, BGR)
+    size_t step = 0;
+    size_t bytes = 0;
+    uint64_t seq = 0;                // Slot sequence the view was taken at
+};
+
+// Reader side of LiveExport, for local consumers (link sentinel_live).
+// open() fetches the region once from the node's socket and maps it
+// read-only; reads after that are plain memory accesses.
+//
+//   LiveReader reader;
+//   reader.open("/var/lib/sentinel/live.sock");
+//   LiveFrame frame;
+//   if (reader.latestFrame(frame)) {
+//       cv::Mat view(frame.height, frame.width, frame.type,
+//                    const_cast<uint8_t*>(frame.data), frame.step);
+//       ... use view ...
+//       if (!reader.valid(frame)) { /* overwritten meanwhile, discard */ }
+//   }
+//
+// The node reuses a slot every live.frame_slots frames, so a view stays
+// valid for that long; copy the pixels if they are needed for longer.
+class LiveReader {
+public:
+    LiveReader();
+    ~LiveReader();
+
+    LiveReader(const LiveReader&) = delete;
+    LiveReader& operator=(const LiveReader&) = delete;
+
+    bool open(const std::string& socket_path);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Copy of the latest state. False if nothing was published yet or the
+    // writer kept it busy for too long.
+    bool readState(LiveState& state) const;
+
+    // View of the newest frame. False if there is none.
+    bool latestFrame(LiveFrame& frame) const;
+
+    // Number of the newest frame (0 = none), to poll for new frames cheaply
+    uint64_t latestFrameNumber() const;
+
+    // True if the frame's slot has not been rewritten since latestFrame()
+    bool valid(const LiveFrame& frame) const;
+
+    int writerPid() const { return header_ ? header_->writer_pid : 0; }
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    const LiveSlotHeader* slot(uint64_t frame_number) const;
+
+    const uint8_t* region_;
+    size_t region_size_;
+    const LiveHeader* header_;
+    std::string last_error_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_LIVE_READER_H
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include "core/pipeline_benchmark.h"
+#include "network/lora_mesh.h"
+#include "utils/executor.h"
+#include "utils/jitter_monitor.h"
+#include "utils/logger.h"
+#include "utils/realtime.h"
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace sentinel {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Scenario timeline, repeated for the whole run
+constexpr double CLEAN_SEC = 15.0;
+constexpr double FIRE_SEC = 20.0;
+constexpr double CLEAR_SEC = 20.0;
+constexpr double EPISODE_SEC = CLEAN_SEC + FIRE_SEC + CLEAR_SEC;
+
+// Gas trace: 12-bit ADC readings at TRACE_RATE_HZ. Clean air calibrates to
+// R0 ~4.7 kOhm; the fire plateau reads ~1300 PPM, well above the default
+// 200 PPM threshold.
+constexpr int TRACE_RATE_HZ = 10;
+constexpr int CLEAN_ADC = 400;
+constexpr int FIRE_ADC = 3600;
+constexpr double RAMP_SEC = 3.0;
+
+// Alert timers shortened so every episode can alert and clear again
+constexpr int BENCH_ALERT_DURATION_SEC = 5;
+constexpr int BENCH_ALERT_COOLDOWN_SEC = 5;
+
+constexpr uint8_t MSG_HEARTBEAT = 0x01;
+constexpr uint8_t MSG_DETECTION = 0x02;
+
+bool inFire(double t) {
+    if (t < 0) {
+        return false;
+    }
+    double phase = std::fmod(t, EPISODE_SEC);
+    return phase >= CLEAN_SEC && phase < CLEAN_SEC + FIRE_SEC;
+}
+
+// Fire episodes that have started within sec seconds
+int fireEpisodes(double sec) {
+    return sec < CLEAN_SEC ? 0 : static_cast<int>((sec - CLEAN_SEC) / EPISODE_SEC) + 1;
+}
+
+double seconds(Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+// Peers heartbeating at the configured interval and reporting detections
+// during each fire, staggered over two seconds. Polled from the mesh
+// receive thread only.
+class SimulatedMesh {
+public:
+    SimulatedMesh(int peers, uint8_t own_id, int heartbeat_sec)
+        : epoch_ns_(0), heartbeat_sec_(std::max(1, heartbeat_sec)) {
+        uint8_t id = 1;
+        for (int i = 0; i < peers; i++) {
+            if (++id == own_id) {
+                ++id;
+            }
+            Peer peer;
+            peer.id = id;
+            peer.detecting = false;
+            peer.next_heartbeat = 0.05 * i;
+            peer.report_delay = 1.0 + 2.0 * i / std::max(1, peers);
+            peers_.push_back(peer);
+        }
+    }
+
+    void start(Clock::time_point t0) {
+        epoch_ns_.store(t0.time_since_epoch().count(), std::memory_order_release);
+    }
+
+    int poll(uint8_t* buffer, size_t max_len) {
+        int64_t epoch = epoch_ns_.load(std::memory_order_acquire);
+        if (epoch == 0 || max_len < MAX_PAYLOAD_SIZE + 5) {
+            return 0;
+        }
+        double t = seconds(Clock::now().time_since_epoch() - Clock::duration(epoch));
+
+        for (Peer& peer : peers_) {
+            MeshMessage msg{};
+            msg.source_id = peer.id;
+            msg.destination_id = 0xFF;
+
+            bool detecting = inFire(t - peer.report_delay);
+            if (detecting != peer.detecting) {
+                peer.detecting = detecting;
+                msg.type = MSG_DETECTION;
+                msg.payload[0] = detecting ? 1 : 0;
+                msg.payload_len = 1;
+            } else if (t >= peer.next_heartbeat) {
+                peer.next_heartbeat += heartbeat_sec_;
+                msg.type = MSG_HEARTBEAT;
+                msg.payload_len = 0;
+            } else {
+                continue;
+            }
+            return static_cast<int>(LoraMesh::serializeMessage(msg, buffer));
+        }
+        return 0;
+    }
+
+private:
+    struct Peer {
+        uint8_t id;
+        bool detecting;
+        double next_heartbeat;       // Seconds since start
+        double report_delay;         // Seconds after the fire starts
+    };
+
+    std::vector<Peer> peers_;
+    std::atomic<int64_t> epoch_ns_;  // Clock::time_point of start(), 0 before
+    int heartbeat_sec_;
+};
+
+struct ThreadCpu {
+    int tid;
+    std::string name;
+    double cpu_sec;
+    unsigned long voluntary_switches;        // Blocked or slept
+    unsigned long involuntary_switches;      // Preempted
+};
+
+// Context switch counts of one thread, from /proc/self/task/<tid>/status
+void readContextSwitches(const char* tid, ThreadCpu& thread) {
+    std::ifstream file(std::string("/proc/self/task/") + tid + "/status");
+    std::string line;
+    while (std::getline(file, line)) {
+        std::sscanf(line.c_str(), "voluntary_ctxt_switches: %lu", &thread.voluntary_switches);
+        std::sscanf(line.c_str(), "nonvoluntary_ctxt_switches: %lu",
+                    &thread.involuntary_switches);
+    }
+}
+
+// User + system time and context switches of every live thread, from
+// /proc/self/task/*/stat and status
+std::vector<ThreadCpu> sampleThreadCpu() {
+    std::vector<ThreadCpu> threads;
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) {
+        return threads;
+    }
+
+    const double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::ifstream file(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        std::string stat;
+        std::getline(file, stat);
+
+        // "tid (comm) state ppid ... utime stime": comm may contain spaces
+        size_t open = stat.find('(');
+        size_t close = stat.rfind(')');
+        if (open == std::string::npos || close == std::string::npos) {
+            continue;
+        }
+        unsigned long utime = 0;
+        unsigned long stime = 0;
+        if (std::sscanf(stat.c_str() + close + 2,
+                        "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+                        &utime, &stime) != 2) {
+            continue;
+        }
+
+        ThreadCpu thread;
+        thread.tid = std::atoi(entry->d_name);
+        thread.name = stat.substr(open + 1, close - open - 1);
+        thread.cpu_sec = (utime + stime) / ticks;
+        thread.voluntary_switches = 0;
+        thread.involuntary_switches = 0;
+        readContextSwitches(entry->d_name, thread);
+        threads.push_back(thread);
+    }
+    closedir(dir);
+    return threads;
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::min(values.size() - 1, index > 0 ? index - 1 : 0)];
+}
+
+void printLatency(const char* label, std::vector<double>& values_ms) {
+    if (values_ms.empty()) {
+        std::printf("  %-24s no samples\n", label);
+        return;
+    }
+    double max_ms = *std::max_element(values_ms.begin(), values_ms.end());
+    std::printf("  %-24s p50 %9.2f  p90 %9.2f  p99 %9.2f  max %9.2f ms  (n=%zu)\n",
+                label, percentile(values_ms, 50), percentile(values_ms, 90),
+                percentile(values_ms, 99), max_ms, values_ms.size());
+}
+
+} // namespace
+
+PipelineBenchmark::PipelineBenchmark(const Config& config, const BenchmarkOptions& options)
+    : config_(config),
+      options_(options) {
+}
+
+PipelineBenchmark::~PipelineBenchmark() {
+    if (!work_dir_.empty()) {
+        std::remove((work_dir_ + "/gas_trace.txt").c_str());
+        std::remove((work_dir_ + "/op_profile.txt").c_str());
+        rmdir(work_dir_.c_str());
+    }
+}
+
+std::string PipelineBenchmark::writeGasTrace() {
+    std::string path = work_dir_ + "/gas_trace.txt";
+    std::ofstream file(path);
+
+    // One episode; the sensor loops it in step with the scenario clock
+    const int samples = static_cast<int>(EPISODE_SEC * TRACE_RATE_HZ);
+    for (int i = 0; i < samples; i++) {
+        double t = static_cast<double>(i) / TRACE_RATE_HZ;
+        double level = 0.0;
+        if (t >= CLEAN_SEC && t < CLEAN_SEC + FIRE_SEC) {
+            level = std::min(1.0, (t - CLEAN_SEC) / RAMP_SEC);
+        } else if (t >= CLEAN_SEC + FIRE_SEC) {
+            level = std::max(0.0, 1.0 - (t - CLEAN_SEC - FIRE_SEC) / RAMP_SEC);
+        }
+        // Small deterministic ripple so the readings are not constant
+        double ripple = 15.0 * std::sin(i * 0.7);
+        file << static_cast<int>(CLEAN_ADC + level * (FIRE_ADC - CLEAN_ADC) + ripple) << "\n";
+    }
+    return file ? path : std::string();
+}
+
+bool PipelineBenchmark::run() {
+    char dir_template[] = "/tmp/sentinel-benchmark-XXXXXX";
+    if (!mkdtemp(dir_template)) {
+        Logger::error("Failed to create benchmark directory: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    work_dir_ = dir_template;
+
+    std::string trace_path = writeGasTrace();
+    if (trace_path.empty()) {
+        Logger::error("Failed to write gas trace");
+        return false;
+    }
+
+    // Scenario inputs in place of the hardware; no state is persisted
+    Config config = config_;
+    config.vision_config.video_source = options_.video_path;
+    config.vision_config.fps = options_.fps > 0 ? options_.fps : 1000;
+    config.sensor_config.trace_file = trace_path;
+    config.sensor_config.trace_rate_hz = TRACE_RATE_HZ;
+    config.sensor_config.calibration_time_sec = 0;
+    config.alert_duration_sec = BENCH_ALERT_DURATION_SEC;
+    config.alert_cooldown_sec = BENCH_ALERT_COOLDOWN_SEC;
+    config.warm_restart = false;
+    config.vision_config.profile_invokes = options_.profile_invokes;
+    config.vision_config.profile_path = work_dir_ + "/op_profile.txt";
+
+    // Declared before the core so the mesh threads stop polling it first
+    SimulatedMesh mesh(std::clamp(options_.peers, 0, 250), config.node_id,
+                       config.lora_config.heartbeat_interval_sec);
+
+    SentinelCore core(config);
+    core.setMeshFrameSource([&mesh](uint8_t* buffer, size_t max_len) {
+        return mesh.poll(buffer, max_len);
+    });
+    if (!core.initialize()) {
+        return false;
+    }
+
+    std::printf("Benchmark: %s, %d peers, %d s (%d fire episodes)\n",
+                options_.video_path.c_str(), options_.peers, options_.duration_sec,
+                fireEpisodes(options_.duration_sec));
+    std::fflush(stdout);
+
+    // Harness bookkeeping is reserved up front so it does not disturb the
+    // allocation-free loop
+    std::vector<double> cycle_ms;
+    std::vector<double> frame_ms;
+    std::vector<double> fire_to_alert_ms;
+    std::vector<double> detection_to_alert_ms;
+    cycle_ms.reserve(static_cast<size_t>(options_.duration_sec) * 1000);
+    frame_ms.reserve(static_cast<size_t>(options_.duration_sec) * 1000);
+
+    // The harness loop stands in for run()
+    Realtime::applyRole(ThreadRole::CORE);
+    
+    std::vector<ThreadCpu> cpu_start = sampleThreadCpu();
+    const Clock::time_point t0 = Clock::now();
+    const Clock::time_point end = t0 + std::chrono::seconds(options_.duration_sec);
+    mesh.start(t0);
+
+    PipelineStats last = core.getStats();
+    Clock::time_point now = t0;
+    while (now < end && !SentinelCore::shutdownRequested()) {
+        core.runCycle(now);
+        Clock::time_point done = Clock::now();
+        double elapsed_ms = std::chrono::duration<double, std::milli>(done - now).count();
+        cycle_ms.push_back(elapsed_ms);
+
+        const PipelineStats& stats = core.getStats();
+        if (stats.vision_frames != last.vision_frames) {
+            frame_ms.push_back(elapsed_ms);
+        }
+        if (stats.alerts != last.alerts) {
+            // Fire onset of the episode the alert fell in
+            double t_alert = seconds(stats.alert_time - t0);
+            double onset = std::floor(t_alert / EPISODE_SEC) * EPISODE_SEC + CLEAN_SEC;
+            fire_to_alert_ms.push_back((t_alert - onset) * 1000.0);
+            detection_to_alert_ms.push_back(
+                seconds(stats.alert_time - stats.detection_time) * 1000.0);
+        }
+        last = stats;
+
+        // Shorter than run()'s 10 ms poll so the frame rate is bounded by
+        // the pipeline rather than the loop period
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        now = Clock::now();
+    }
+
+    const double wall_sec = seconds(Clock::now() - t0);
+    std::vector<ThreadCpu> cpu_end = sampleThreadCpu();
+    const PipelineStats& stats = core.getStats();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::printf("\nThroughput (%.1f s)\n", wall_sec);
+    std::printf("  vision frames/sec        %.2f\n", stats.vision_frames / wall_sec);
+    std::printf("  loop cycles/sec          %.1f\n", stats.cycles / wall_sec);
+    std::printf("  sensor checks            %llu\n",
+                static_cast<unsigned long long>(stats.sensor_checks));
+    std::printf("  vision quality level     %zu at end (%llu changes)\n", stats.quality_level,
+                static_cast<unsigned long long>(stats.quality_changes));
+
+    std::printf("\nLatency\n");
+    printLatency("cycle", cycle_ms);
+    printLatency("cycle with frame", frame_ms);
+    printLatency("fire onset -> alert", fire_to_alert_ms);
+    printLatency("detection -> alert", detection_to_alert_ms);
+    std::printf("  alerts                   %llu of %d fire episodes\n",
+                static_cast<unsigned long long>(stats.alerts), fireEpisodes(wall_sec));
+
+    // CPU and context switches per live thread over the run; threads that
+    // exited are not listed
+    std::printf("\nCPU per thread                       cpu            ctx switches\n");
+    std::sort(cpu_end.begin(), cpu_end.end(), [](const ThreadCpu& a, const ThreadCpu& b) {
+        return a.cpu_sec > b.cpu_sec;
+    });
+    double total_cpu = 0.0;
+    unsigned long total_voluntary = 0;
+    unsigned long total_involuntary = 0;
+    for (const ThreadCpu& thread : cpu_end) {
+        ThreadCpu before = {thread.tid, std::string(), 0.0, 0, 0};
+        for (const ThreadCpu& start : cpu_start) {
+            if (start.tid == thread.tid) {
+                before = start;
+                break;
+            }
+        }
+        double used = thread.cpu_sec - before.cpu_sec;
+        unsigned long voluntary = thread.voluntary_switches - before.voluntary_switches;
+        unsigned long involuntary = thread.involuntary_switches - before.involuntary_switches;
+        total_cpu += used;
+        total_voluntary += voluntary;
+        total_involuntary += involuntary;
+        std::printf("  %-16s %6d  %8.2f s  %6.1f%%  %8lu vol %6lu invol\n",
+                    thread.name.c_str(), thread.tid, used, 100.0 * used / wall_sec,
+                    voluntary, involuntary);
+    }
+    std::printf("  %-16s %6d  %8.2f s  %6.1f%%  %8lu vol %6lu invol\n", "total",
+                static_cast<int>(cpu_end.size()), total_cpu, 100.0 * total_cpu / wall_sec,
+                total_voluntary, total_involuntary);
+    std::printf("  context switches/sec     %.1f\n",
+                (total_voluntary + total_involuntary) / wall_sec);
+    if (stats.vision_frames > 0) {
+        // CPU efficiency: all threads' CPU time per processed frame
+        std::printf("  CPU per vision frame     %.2f ms\n",
+                    1000.0 * total_cpu / stats.vision_frames);
+    }
+
+    ExecutorStats executor = Executor::stats();
+    std::printf("\nExecutor (%d workers)\n", executor.workers);
+    std::printf("  tasks run                %llu (%llu stolen, %llu inline)\n",
+                static_cast<unsigned long long>(executor.tasks_run),
+                static_cast<unsigned long long>(executor.steals),
+                static_cast<unsigned long long>(executor.inline_runs));
+    std::printf("  timers fired             %llu\n",
+                static_cast<unsigned long long>(executor.timers_fired));
+    std::printf("  parallel jobs            %llu (%llu chunks run by workers)\n",
+                static_cast<unsigned long long>(executor.parallel_jobs),
+                static_cast<unsigned long long>(executor.chunks_helped));
+
+    // Wakeup lateness of the periodic tasks (the harness drives its own
+    // loop, so LOOP is not measured here)
+    std::printf("\nJitter (log2 bucket bounds)\n");
+    JitterReport jitter = JitterMonitor::report();
+    for (const JitterTaskStats& task : jitter.tasks) {
+        if (task.lateness->count() == 0) {
+            continue;
+        }
+        std::printf("  %-24s late p50 %8.2f  p99 %8.2f  max %8.2f ms  overruns %llu\n",
+                    task.name, task.lateness->percentileUs(50) / 1000.0,
+                    task.lateness->percentileUs(99) / 1000.0, task.lateness->maxUs() / 1000.0,
+                    static_cast<unsigned long long>(task.overruns));
+    }
+
+    std::printf("\nMemory\n");
+    std::printf("  peak RSS                 %ld KB\n", usage.ru_maxrss);
+    
+    // Written by the detector once the profiled invokes are done
+    std::ifstream profile(config.vision_config.profile_path);
+    if (options_.profile_invokes > 0 && profile) {
+        std::printf("\n%s", std::string(std::istreambuf_iterator<char>(profile),
+                                         std::istreambuf_iterator<char>()).c_str());
+    }
+    std::fflush(stdout);
+    return true;
+}
+
+} // namespace sentinel
\ No newline at end of file
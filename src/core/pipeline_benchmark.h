@@ -0,0 +1,49 @@
+#ifndef SENTINEL_PIPELINE_BENCHMARK_H
+#define SENTINEL_PIPELINE_BENCHMARK_H
+
+#include "core/sentinel_core.h"
+#include <string>
+
+namespace sentinel {
+
+struct BenchmarkOptions {
+    std::string video_path;          // Replaces the camera (looped)
+    int peers = 8;                   // Simulated mesh nodes
+    int duration_sec = 300;
+    int fps = 0;                     // Vision rate cap, 0 = as fast as possible
+    int profile_invokes = 100;       // Per-operator profile of the first invokes, 0 = off
+};
+
+// End-to-end benchmark (sentinel --benchmark). Runs the real SentinelCore,
+// with all of its threads, against a video file, a synthetic MQ-2 trace
+// and a simulated mesh, through repeated fire episodes:
+//
+//   clean air (15 s) -> fire (20 s) -> clearing (20 s)
+//
+// During a fire the gas trace rises above the smoke threshold and every
+// simulated peer reports a detection a few seconds apart, so each episode
+// should end in a consensus alert. Reports sustained vision frames/sec,
+// cycle and frame latency, fire-to-alert and detection-to-alert latency
+// percentiles, CPU time per thread and peak RSS, then the per-operator
+// profile of the model.
+class PipelineBenchmark {
+public:
+    PipelineBenchmark(const Config& config, const BenchmarkOptions& options);
+    ~PipelineBenchmark();
+
+    // Run the scenario and print the report. Returns false if the
+    // pipeline could not be started.
+    bool run();
+
+private:
+    // Write the per-episode gas trace; returns its path
+    std::string writeGasTrace();
+
+    Config config_;
+    BenchmarkOptions options_;
+    std::string work_dir_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_PIPELINE_BENCHMARK_H
\ No newline at end of file
@@ -1,12 +1,31 @@
-#include "sentinel_core.h"
+#include "core/sentinel_core.h"
+#include "core/config_manager.h"
+#include "core/config_store.h"
+#include "core/evidence_fusion.h"
+#include "core/live_export.h"
+#include "core/state_snapshot.h"
+#include "core/thermal_governor.h"
 #include "sensors/mq2_sensor.h"
+#include "vision/preview_server.h"
 #include "vision/smoke_detector.h"
 #include "network/lora_mesh.h"
+#include "utils/executor.h"
+#include "utils/jitter_monitor.h"
 #include "utils/logger.h"
+#include "utils/memory_tracker.h"
+#include "utils/realtime.h"
+#include "utils/scratch_arena.h"
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace sentinel {
 
@@ -18,12 +37,154 @@ void signalHandler(int signum) {
     g_running = false;
 }
 
+// Initial per-cycle scratch size; grows to the observed high-water mark
+constexpr size_t SCRATCH_ARENA_SIZE = 16 * 1024;
+
+// Main loop poll period
+constexpr std::chrono::milliseconds LOOP_PERIOD(10);
+
+// Alert report sent upstream to the gateways: kind, detecting nodes,
+// sensor PPM (little-endian), vision confidence in percent
+constexpr uint8_t REPORT_ALERT = 0x01;
+constexpr size_t ALERT_REPORT_LEN = 5;
+
+// Mesh update files in <data_directory>/updates, by TransferKind
+static const char* const UPDATE_FILES[] = {"model.tflite", "config.json"};
+constexpr size_t UPDATE_KINDS = static_cast<size_t>(TransferKind::COUNT);
+
+// How often the updates directory is checked for new files
+constexpr std::chrono::seconds UPDATE_CHECK_PERIOD(30);
+
+// Install per-subsystem memory budgets
+static void applyMemoryConfig(const MemoryConfig& config) {
+    MemoryTracker::setBudget(MemorySubsystem::VISION, config.vision_budget_kb * size_t(1024));
+    MemoryTracker::setBudget(MemorySubsystem::MESH, config.mesh_budget_kb * size_t(1024));
+    MemoryTracker::setBudget(MemorySubsystem::SENSOR, config.sensor_budget_kb * size_t(1024));
+    MemoryTracker::setBudget(MemorySubsystem::LOGGING, config.logging_budget_kb * size_t(1024));
+    MemoryTracker::setBudget(MemorySubsystem::STORAGE, config.storage_budget_kb * size_t(1024));
+    MemoryTracker::setShedLoad(config.shed_load);
+}
+
+// Install per-role scheduling policies for real-time mode: the loop and
+// the radio share the isolated core, everything else runs on the others
+static void applyRealtimeConfig(const RealtimeConfig& config) {
+    cpu_set_t core_cpus;
+    cpu_set_t inference_cpus;
+    if (!Realtime::parseCpuList(config.core_cpus, core_cpus)) {
+        Logger::warn("Invalid realtime.core_cpus - not pinning the core threads");
+        CPU_ZERO(&core_cpus);
+    }
+    if (!Realtime::parseCpuList(config.inference_cpus, inference_cpus)) {
+        Logger::warn("Invalid realtime.inference_cpus - not pinning inference threads");
+        CPU_ZERO(&inference_cpus);
+    }
+    Realtime::setPolicy(ThreadRole::CORE, config.core_priority, core_cpus);
+    Realtime::setPolicy(ThreadRole::RADIO, config.radio_priority, core_cpus);
+    Realtime::setPolicy(ThreadRole::INFERENCE, 0, inference_cpus);
+    Realtime::setPolicy(ThreadRole::BACKGROUND, 0, inference_cpus);
+    Realtime::setEnabled(config.enabled);
+}
+
+static bool sameRealtimeConfig(const RealtimeConfig& a, const RealtimeConfig& b) {
+    return a.enabled == b.enabled && a.lock_memory == b.lock_memory &&
+           a.core_cpus == b.core_cpus && a.inference_cpus == b.inference_cpus &&
+           a.core_priority == b.core_priority && a.radio_priority == b.radio_priority;
+}
+
+static void applyJitterConfig(const JitterConfig& config) {
+    JitterMonitor::setEnabled(config.enabled);
+    JitterMonitor::setOverrunPercent(config.overrun_pct);
+}
+
+// Top of the governor's quality ladder: the configured vision settings
+static VisionQuality configuredQuality(const VisionConfig& config) {
+    VisionQuality quality;
+    quality.fps = config.fps;
+    quality.tile_grid = config.tile_grid;
+    quality.lite_model = false;
+    quality.threads = Executor::threadBudget();
+    return quality;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    file.seekg(0, std::ios::beg);
+    return file.read(reinterpret_cast<char*>(data.data()), data.size()).good() || data.empty();
+}
+
+// Modification time in seconds, -1 if the file does not exist
+static int64_t modificationTime(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? static_cast<int64_t>(st.st_mtime) : -1;
+}
+
+// Replace path with data in one step (temporary file and rename), so a
+// reader never sees half a file. mtime -1 keeps the current time.
+static bool writeFileAtomic(const std::string& path, const uint8_t* data, size_t len,
+                            int64_t mtime) {
+    std::string temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd >= 0;
+    size_t written = 0;
+    while (ok && written < len) {
+        ssize_t n = write(fd, data + written, len - written);
+        if (n < 0 && errno != EINTR) {
+            ok = false;
+        } else if (n > 0) {
+            written += static_cast<size_t>(n);
+        }
+    }
+    ok = ok && fsync(fd) == 0;
+    if (ok && mtime >= 0) {
+        struct timespec times[2] = {{static_cast<time_t>(mtime), 0}, {static_cast<time_t>(mtime), 0}};
+        ok = futimens(fd, times) == 0;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+        Logger::logf(LogLevel::ERROR, "Failed to write %s: %s", path.c_str(), std::strerror(errno));
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Record the wakeup of a periodic task last run at last; the first run
+// has no schedule to be late against
+static void recordDue(JitterTask task, std::chrono::steady_clock::time_point last,
+                      std::chrono::steady_clock::duration interval,
+                      std::chrono::steady_clock::time_point now) {
+    if (last.time_since_epoch().count() != 0) {
+        JitterMonitor::recordWakeup(task, last + interval, now, interval);
+    }
+}
+
 SentinelCore::SentinelCore(const Config& config) 
     : config_(config),
       sensor_(nullptr),
       detector_(nullptr),
       mesh_(nullptr),
+      peer_table_(&MemoryTracker::resource(MemorySubsystem::STORAGE)),
+      update_versions_(UPDATE_KINDS, 0),
+      update_pending_(UPDATE_KINDS, false),
       alert_state_(AlertState::IDLE) {
+    scratch_ = std::make_unique<ScratchArena>(SCRATCH_ARENA_SIZE,
+                                              &MemoryTracker::resource(MemorySubsystem::STORAGE));
+    applyMemoryConfig(config_.memory_config);
+    applyJitterConfig(config_.jitter_config);
+    sensor_interval_ = std::chrono::milliseconds(config_.sensor_config.sampling_interval_ms);
+    vision_interval_ = std::chrono::milliseconds(1000 / config_.vision_config.fps);
+    fusion_ = std::make_unique<EvidenceFusion>(config_.fusion_config);
+    for (const char* name : UPDATE_FILES) {
+        update_paths_.push_back(config_.data_directory + "/updates/" + name);
+    }
 }
 
 SentinelCore::~SentinelCore() {
@@ -37,24 +198,85 @@ bool SentinelCore::initialize() {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
-    // Initialize sensor module
-    sensor_ = std::make_unique<MQ2Sensor>(config_.i2c_address);
+    // Real-time mode is set up first. The subsystems initialize under the
+    // inference policy, so the worker pools started from this thread (the
+    // executor's and TFLite's) inherit it; run() then moves this thread to
+    // the core policy.
+    applyRealtimeConfig(config_.realtime_config);
+    if (config_.realtime_config.enabled) {
+        Logger::logf(LogLevel::INFO, "Real-time mode: core CPUs %s (priority %d, radio %d), "
+                     "inference CPUs %s", config_.realtime_config.core_cpus.c_str(),
+                     config_.realtime_config.core_priority, config_.realtime_config.radio_priority,
+                     config_.realtime_config.inference_cpus.c_str());
+        if (config_.realtime_config.lock_memory) {
+            Realtime::lockMemory();
+        }
+        Realtime::applyRole(ThreadRole::INFERENCE);
+    }
+    
+    // Before the subsystems: the detector sizes TFLite's pool from the
+    // executor's thread budget and the mesh schedules its timers on it
+    Executor::start(config_.executor_config.threads);
+    
+    openStateSnapshot();
+    
+    // Initialize sensor module (skips calibration if a recent one is restored)
+    sensor_ = std::make_unique<MQ2Sensor>(config_.i2c_address, config_.sensor_config);
+    restoreCalibration();
     if (!sensor_->initialize()) {
         Logger::error("Failed to initialize MQ2 sensor");
         return false;
     }
     Logger::info("MQ2 sensor initialized successfully");
     
-    // Initialize vision detector
-    detector_ = std::make_unique<SmokeDetector>(config_.model_path);
-    if (!detector_->initialize()) {
-        Logger::error("Failed to initialize smoke detector");
-        return false;
+    // Initialize vision detector, unless a vision source stands in for it
+    if (!vision_source_) {
+        detector_ = std::make_unique<SmokeDetector>(config_.model_path, config_.vision_config);
+        if (!detector_->initialize()) {
+            Logger::error("Failed to initialize smoke detector");
+            return false;
+        }
+        Logger::info("Smoke detector initialized successfully");
     }
-    Logger::info("Smoke detector initialized successfully");
+    
+    // Vision quality follows temperature and inference latency
+    governor_ = std::make_unique<ThermalGovernor>(config_.governor_config,
+                                                  configuredQuality(config_.vision_config),
+                                                  detector_ && detector_->hasLiteModel());
+    governor_->start();
+    applyQuality();
     
     // Initialize LoRa mesh
+    if (!initializeMesh()) {
+        return false;
+    }
+    
+    restoreRuntimeState();
+    
+    if (config_.live_config.enabled) {
+        startLiveExport();
+    }
+    
+    // Camera preview for technicians; fed from checkVision()
+    if (config_.preview_config.enabled) {
+        preview_ = std::make_unique<PreviewServer>(config_.preview_config);
+        if (!preview_->start()) {
+            Logger::error("Camera preview disabled");
+            preview_.reset();
+        }
+    }
+    
+    Logger::info("Sentinel Core initialization complete");
+    return true;
+}
+
+bool SentinelCore::initializeMesh() {
     mesh_ = std::make_unique<LoraMesh>(config_.node_id, config_.lora_config);
+    if (mesh_frame_source_) {
+        mesh_->setFrameSource(mesh_frame_source_);
+    }
+    // Before the join handshake, so known peers are not asked again
+    restorePeerTable();
     if (!mesh_->initialize()) {
         Logger::error("Failed to initialize LoRa mesh");
         return false;
@@ -65,65 +287,533 @@ bool SentinelCore::initialize() {
     mesh_->setDetectionCallback([this](uint8_t node_id, bool detected) {
         this->handleMeshDetection(node_id, detected);
     });
-    
-    Logger::info("Sentinel Core initialization complete");
+    mesh_->setUpstreamCallback([this](uint8_t origin, const uint8_t* data, size_t len) {
+        this->handleUpstreamReport(origin, data, len);
+    });
+    mesh_->setUpdateCallback([this](TransferKind kind, uint32_t version, const uint8_t* data,
+                                    size_t len) {
+        this->handleMeshUpdate(kind, version, data, len);
+    });
+    loadUpdateFiles();
     return true;
 }
 
+void SentinelCore::loadUpdateFiles() {
+    if (!LoraMesh::updatesEnabled(config_.lora_config)) {
+        return;
+    }
+    std::vector<uint8_t> data;
+    for (size_t k = 0; k < UPDATE_KINDS; k++) {
+        auto kind = static_cast<TransferKind>(k);
+        int64_t version = modificationTime(update_paths_[k].c_str());
+        if (version > 0 && readFile(update_paths_[k], data)) {
+            mesh_->setUpdateFile(kind, static_cast<uint32_t>(version), data.data(), data.size());
+            update_versions_[k] = version;
+            Logger::logf(LogLevel::INFO, "Serving %s version %lld to the mesh",
+                         UPDATE_FILES[k], static_cast<long long>(version));
+        } else if (kind == TransferKind::MODEL && readFile(config_.model_path, data)) {
+            // Nothing to serve yet, but the installed model is where most
+            // chunks of the next one come from
+            mesh_->setUpdateFile(kind, 0, data.data(), data.size());
+        }
+    }
+}
+
+void SentinelCore::checkUpdateFiles(std::chrono::steady_clock::time_point now) {
+    if (!LoraMesh::updatesEnabled(config_.lora_config) ||
+        now - last_update_check_ < UPDATE_CHECK_PERIOD) {
+        return;
+    }
+    last_update_check_ = now;
+    
+    // A file newer than the one held was placed here: distribute and
+    // install it
+    for (size_t k = 0; k < UPDATE_KINDS; k++) {
+        int64_t version = modificationTime(update_paths_[k].c_str());
+        if (version <= update_versions_[k]) {
+            continue;
+        }
+        std::vector<uint8_t> data;
+        if (!readFile(update_paths_[k], data)) {
+            continue;
+        }
+        update_versions_[k] = version;
+        if (mesh_->setUpdateFile(static_cast<TransferKind>(k), static_cast<uint32_t>(version),
+                                 data.data(), data.size())) {
+            Logger::logf(LogLevel::INFO, "Distributing %s version %lld (%zu bytes)",
+                         UPDATE_FILES[k], static_cast<long long>(version), data.size());
+            update_pending_[k] = true;
+        }
+    }
+}
+
+void SentinelCore::handleMeshUpdate(TransferKind kind, uint32_t version, const uint8_t* data,
+                                    size_t len) {
+    // Saved with its version as modification time, so this node serves
+    // the same version after a restart
+    size_t k = static_cast<size_t>(kind);
+    std::string directory = config_.data_directory + "/updates";
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        Logger::logf(LogLevel::ERROR, "Cannot create %s: %s", directory.c_str(),
+                     std::strerror(errno));
+        return;
+    }
+    if (writeFileAtomic(update_paths_[k], data, len, version)) {
+        update_versions_[k] = version;
+        update_pending_[k] = true;
+    }
+}
+
+void SentinelCore::installUpdates() {
+    std::vector<uint8_t> data;
+    for (size_t k = 0; k < UPDATE_KINDS; k++) {
+        if (!update_pending_[k]) {
+            continue;
+        }
+        update_pending_[k] = false;
+        if (!readFile(update_paths_[k], data)) {
+            Logger::logf(LogLevel::ERROR, "Cannot read %s", update_paths_[k].c_str());
+            continue;
+        }
+        if (static_cast<TransferKind>(k) == TransferKind::MODEL) {
+            installModel(data);
+        } else {
+            installConfig(data);
+        }
+    }
+}
+
+void SentinelCore::installModel(const std::vector<uint8_t>& data) {
+    // The detector maps the model file: replace it, do not rewrite it
+    std::vector<uint8_t> previous;
+    bool have_previous = readFile(config_.model_path, previous);
+    if (!writeFileAtomic(config_.model_path, data.data(), data.size(), -1)) {
+        return;
+    }
+    Logger::warn("Model updated - restarting smoke detector");
+    if (!restartDetector() && have_previous) {
+        Logger::error("Updated model failed to load - restoring the previous one");
+        if (writeFileAtomic(config_.model_path, previous.data(), previous.size(), -1)) {
+            restartDetector();
+        }
+    }
+}
+
+void SentinelCore::installConfig(const std::vector<uint8_t>& data) {
+    ConfigManager manager;
+    if (!manager.loadFromString(std::string_view(reinterpret_cast<const char*>(data.data()),
+                                                 data.size()), "mesh config update")) {
+        return;
+    }
+    
+    // Detection tuning only. Identity, radio, paths, devices, local
+    // interfaces, scheduling and the update settings stay as configured
+    // here, whatever the sender put in its file.
+    const Config& shared = manager.getConfig();
+    Config next = config_;
+    next.consensus_threshold = shared.consensus_threshold;
+    next.consensus_timeout_sec = shared.consensus_timeout_sec;
+    next.consensus_min_nodes = shared.consensus_min_nodes;
+    next.alert_duration_sec = shared.alert_duration_sec;
+    next.alert_cooldown_sec = shared.alert_cooldown_sec;
+    next.sensor_config.calibration_time_sec = shared.sensor_config.calibration_time_sec;
+    next.sensor_config.smoke_threshold_ppm = shared.sensor_config.smoke_threshold_ppm;
+    next.sensor_config.sampling_interval_ms = shared.sensor_config.sampling_interval_ms;
+    const VisionConfig& vision = shared.vision_config;
+    next.vision_config.fps = vision.fps;
+    next.vision_config.confidence_threshold = vision.confidence_threshold;
+    next.vision_config.tile_grid = vision.tile_grid;
+    next.vision_config.plume_threshold = vision.plume_threshold;
+    next.vision_config.plume_growth_frames = vision.plume_growth_frames;
+    next.vision_config.night_mode = vision.night_mode;
+    next.vision_config.night_luma = vision.night_luma;
+    next.vision_config.day_luma = vision.day_luma;
+    next.vision_config.night_lux = vision.night_lux;
+    next.vision_config.day_lux = vision.day_lux;
+    next.vision_config.night_hold_sec = vision.night_hold_sec;
+    next.vision_config.night_glow_fraction = vision.night_glow_fraction;
+    next.lora_config.heartbeat_interval_sec = shared.lora_config.heartbeat_interval_sec;
+    next.lora_config.heartbeat_max_interval_sec = shared.lora_config.heartbeat_max_interval_sec;
+    next.lora_config.heartbeat_redundancy = shared.lora_config.heartbeat_redundancy;
+    next.lora_config.node_timeout_sec = shared.lora_config.node_timeout_sec;
+    next.fusion_config = shared.fusion_config;
+    
+    Logger::info("Configuration updated from the mesh");
+    if (!config_path_.empty()) {
+        manager.setConfig(next);
+        std::string temporary = config_path_ + ".tmp";
+        if (!manager.saveToFile(temporary) ||
+            rename(temporary.c_str(), config_path_.c_str()) != 0) {
+            Logger::logf(LogLevel::ERROR, "Failed to save %s", config_path_.c_str());
+        } else if (config_reader_) {
+            // The config watcher picks it up
+            return;
+        }
+    }
+    applyConfig(next);
+}
+
+bool SentinelCore::restartDetector() {
+    if (!detector_) {
+        return true;
+    }
+    bool ok;
+    {
+        // As in initialize(): the detector's threads must not inherit the
+        // loop thread's real-time priority and isolated core
+        RealtimeRoleScope inference(ThreadRole::INFERENCE);
+        detector_->shutdown();
+        detector_ = std::make_unique<SmokeDetector>(config_.model_path, config_.vision_config);
+        ok = detector_->initialize();
+    }
+    if (!ok) {
+        Logger::error("Failed to restart smoke detector");
+    }
+    governor_->applyConfig(config_.governor_config, configuredQuality(config_.vision_config),
+                           detector_->hasLiteModel());
+    applyQuality();
+    return ok;
+}
+
+void SentinelCore::startLiveExport() {
+    std::string socket_path = config_.live_config.socket_path.empty() ?
+                              config_.data_directory + "/live.sock" :
+                              config_.live_config.socket_path;
+    // Slots hold the configured resolution in BGR
+    size_t frame_capacity = static_cast<size_t>(config_.vision_config.frame_width) *
+                            config_.vision_config.frame_height * 3;
+    live_ = std::make_unique<LiveExport>(config_.live_config, frame_capacity);
+    if (!live_->start(socket_path)) {
+        Logger::error("Live export disabled");
+        live_.reset();
+    }
+}
+
+void SentinelCore::publishLiveState() {
+    auto epochMs = [](std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            time.time_since_epoch()).count();
+    };
+    
+    LiveState state{};
+    state.timestamp_ns = liveMonotonicNs();
+    state.sensor_time_ms = epochMs(detection_data_.sensor_timestamp);
+    state.vision_time_ms = epochMs(detection_data_.vision_timestamp);
+    state.smoke_ppm = detection_data_.smoke_ppm;
+    state.vision_confidence = detection_data_.vision_confidence;
+    state.sensor_detected = detection_data_.sensor_detected;
+    state.vision_detected = detection_data_.vision_detected;
+    state.alert_state = static_cast<uint8_t>(alert_state_);
+    state.active_nodes = mesh_->getActiveNodeCount();
+    state.detecting_nodes = mesh_->getDetectingNodeCount();
+    state.vision_frames = stats_.vision_frames;
+    live_->publishState(state);
+}
+
+void SentinelCore::setMeshFrameSource(MeshFrameSource source) {
+    mesh_frame_source_ = std::move(source);
+}
+
+void SentinelCore::setVisionSource(VisionSource source) {
+    vision_source_ = std::move(source);
+}
+
+bool SentinelCore::shutdownRequested() {
+    return !g_running;
+}
+
+void SentinelCore::setConfigPath(const std::string& path) {
+    config_path_ = path;
+}
+
+void SentinelCore::setConfigStore(ConfigStore* store) {
+    config_reader_ = store ? std::make_unique<ConfigReader>(*store) : nullptr;
+}
+
+void SentinelCore::applyConfig(const Config& next) {
+    Logger::info("Applying configuration update");
+    
+    Logger::setLevel(next.debug_mode ? LogLevel::DEBUG : Logger::levelFromString(next.log_level));
+    applyMemoryConfig(next.memory_config);
+    applyJitterConfig(next.jitter_config);
+    if (!sameRealtimeConfig(next.realtime_config, config_.realtime_config)) {
+        Logger::warn("Real-time settings take effect after a restart");
+    }
+    if (next.executor_config.threads != config_.executor_config.threads) {
+        Logger::warn("Executor thread count takes effect after a restart");
+    }
+    if (next.log_file != config_.log_file) {
+        Logger::warn("Log file takes effect after a restart");
+    }
+    if (next.live_config.enabled != config_.live_config.enabled ||
+        next.live_config.socket_path != config_.live_config.socket_path ||
+        next.live_config.frame_slots != config_.live_config.frame_slots ||
+        next.live_config.frames != config_.live_config.frames) {
+        Logger::warn("Live export settings take effect after a restart");
+    }
+    if (next.preview_config.enabled != config_.preview_config.enabled ||
+        next.preview_config.bind_address != config_.preview_config.bind_address ||
+        next.preview_config.allow_remote != config_.preview_config.allow_remote ||
+        next.preview_config.port != config_.preview_config.port ||
+        next.preview_config.max_clients != config_.preview_config.max_clients ||
+        next.preview_config.max_fps != config_.preview_config.max_fps ||
+        next.preview_config.jpeg_quality != config_.preview_config.jpeg_quality ||
+        next.preview_config.overlay != config_.preview_config.overlay) {
+        Logger::warn("Preview settings take effect after a restart");
+    }
+    
+    // Sensor: a different I2C address means reopening and recalibrating
+    if (next.i2c_address != config_.i2c_address) {
+        Logger::warn("Sensor I2C address changed - restarting sensor");
+        sensor_->shutdown();
+        sensor_ = std::make_unique<MQ2Sensor>(next.i2c_address, next.sensor_config);
+        if (!sensor_->initialize()) {
+            Logger::error("Failed to restart MQ2 sensor");
+        }
+    } else {
+        sensor_->applyConfig(next.sensor_config);
+    }
+    
+    // Vision: a different model or interpreter pool needs a fresh detector.
+    // Threads it creates take the inference role, not the loop thread's.
+    if (detector_) {
+        RealtimeRoleScope inference(ThreadRole::INFERENCE);
+        if (next.model_path != config_.model_path ||
+            next.vision_config.lite_model_path != config_.vision_config.lite_model_path ||
+            next.vision_config.interpreters != config_.vision_config.interpreters) {
+            Logger::warn("Model or interpreters changed - restarting smoke detector");
+            detector_->shutdown();
+            detector_ = std::make_unique<SmokeDetector>(next.model_path, next.vision_config);
+            if (!detector_->initialize()) {
+                Logger::error("Failed to restart smoke detector");
+            }
+        } else if (!detector_->applyConfig(next.vision_config)) {
+            Logger::error("Failed to apply vision configuration");
+        }
+    }
+    governor_->applyConfig(next.governor_config, configuredQuality(next.vision_config),
+                           detector_ && detector_->hasLiteModel());
+    
+    // Mesh: node identity changes need a new mesh instance, radio changes
+    // only reconfigure the radio and keep the peer table
+    bool updates_enabled = LoraMesh::updatesEnabled(next.lora_config) &&
+                           !LoraMesh::updatesEnabled(config_.lora_config);
+    if (next.node_id != config_.node_id) {
+        Logger::warn("Node ID changed - restarting LoRa mesh");
+        mesh_->shutdown();
+        config_.node_id = next.node_id;
+        config_.lora_config = next.lora_config;
+        initializeMesh();
+    } else if (mesh_->requiresRadioRestart(next.lora_config)) {
+        if (!mesh_->restartRadio(next.lora_config)) {
+            Logger::error("Failed to restart LoRa radio");
+        }
+    } else {
+        mesh_->applyConfig(next.lora_config);
+    }
+    
+    // Fusion: new likelihoods and bounds apply to the running test; turning
+    // it on starts from no evidence
+    fusion_->setConfig(next.fusion_config);
+    if (next.fusion_config.enabled && !config_.fusion_config.enabled) {
+        fusion_->reset();
+        detection_data_.evidence = 0.0f;
+    }
+    
+    config_ = next;
+    sensor_interval_ = std::chrono::milliseconds(config_.sensor_config.sampling_interval_ms);
+    applyQuality();
+    if (updates_enabled) {
+        loadUpdateFiles();
+    }
+}
+
+void SentinelCore::applyQuality() {
+    const VisionQuality& quality = governor_->quality();
+    vision_interval_ = std::chrono::milliseconds(1000 / quality.fps);
+    if (detector_) {
+        detector_->setQuality(quality.tile_grid, quality.lite_model, quality.threads);
+    }
+    stats_.quality_level = governor_->level();
+}
+
 void SentinelCore::run() {
     Logger::info("Starting Sentinel detection loop...");
     
-    auto last_sensor_check = std::chrono::steady_clock::now();
-    auto last_vision_check = std::chrono::steady_clock::now();
+    Realtime::applyRole(ThreadRole::CORE);
     
     while (g_running) {
-        auto now = std::chrono::steady_clock::now();
-        
-        // Check smoke sensor (every 1 second)
-        if (now - last_sensor_check >= std::chrono::seconds(1)) {
-            checkSensor();
-            last_sensor_check = now;
+        // Pick up a newly published configuration
+        if (config_reader_ && config_reader_->stale()) {
+            JitterScope timing(JitterTask::CONFIG_APPLY);
+            applyConfig(config_reader_->acquire());
         }
         
-        // Check vision system (every 200ms)
-        if (now - last_vision_check >= std::chrono::milliseconds(200)) {
-            checkVision();
-            last_vision_check = now;
-        }
-        
-        // Process mesh messages
-        mesh_->processMessages();
-        
-        // Update alert state
-        updateAlertState();
+        runCycle(std::chrono::steady_clock::now());
         
-        // Small sleep to prevent CPU spinning
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Small sleep to prevent CPU spinning; oversleeping is scheduling
+        // latency
+        auto wake_at = std::chrono::steady_clock::now() + LOOP_PERIOD;
+        std::this_thread::sleep_for(LOOP_PERIOD);
+        JitterMonitor::recordWakeup(JitterTask::LOOP, wake_at, std::chrono::steady_clock::now(),
+                                    LOOP_PERIOD);
     }
     
     Logger::info("Detection loop terminated");
 }
 
+void SentinelCore::runCycle(std::chrono::steady_clock::time_point now) {
+    scratch_->reset();
+    stats_.cycles++;
+    
+    bool checked = false;
+    
+    // Check smoke sensor (every sensor.sampling_interval_ms, default 1 second)
+    if (now - last_sensor_check_ >= sensor_interval_) {
+        checked = true;
+        recordDue(JitterTask::SENSOR_POLL, last_sensor_check_, sensor_interval_, now);
+        checkSensor();
+        last_sensor_check_ = now;
+        stats_.sensor_checks++;
+    }
+    
+    // Check vision system (every 1/vision.fps, default 200ms; a quarter
+    // of that rate while vision is shedding load for its memory budget)
+    auto vision_interval = MemoryTracker::shouldShed(MemorySubsystem::VISION) ?
+                           vision_interval_ * 4 : vision_interval_;
+    if (now - last_vision_check_ >= vision_interval) {
+        checked = true;
+        recordDue(JitterTask::VISION_TICK, last_vision_check_, vision_interval, now);
+        checkVision();
+        last_vision_check_ = now;
+        stats_.vision_frames++;
+    }
+    
+    // Step vision quality with temperature and latency (sysfs is read on
+    // an executor timer; this only compares the published readings)
+    if (governor_ && governor_->update(now)) {
+        applyQuality();
+        stats_.quality_changes++;
+    }
+    
+    // Process mesh messages
+    {
+        JitterScope timing(JitterTask::MESH_PROCESS);
+        mesh_->processMessages();
+    }
+    
+    // Model and config updates: new files to distribute, and installs of
+    // files placed there or fetched from the mesh
+    checkUpdateFiles(now);
+    if (std::find(update_pending_.begin(), update_pending_.end(), true) != update_pending_.end()) {
+        installUpdates();
+    }
+    
+    // Update alert state
+    updateAlertState(now);
+    
+    // Share the new readings with local consumers
+    if (live_ && checked) {
+        publishLiveState();
+    }
+    
+    // Persist state for warm restarts (only changed sections are written);
+    // skipped while storage is shedding load
+    if (state_ && now - last_state_save_ >= std::chrono::seconds(1) &&
+        !MemoryTracker::shouldShed(MemorySubsystem::STORAGE)) {
+        recordDue(JitterTask::STATE_SAVE, last_state_save_, std::chrono::seconds(1), now);
+        saveState();
+        last_state_save_ = now;
+    }
+    
+    // Reconcile per-subsystem accounting against RSS
+    if (config_.memory_config.report_interval_sec > 0 &&
+        now - last_memory_report_ >= std::chrono::seconds(config_.memory_config.report_interval_sec)) {
+        JitterScope timing(JitterTask::MEMORY_REPORT);
+        MemoryTracker::logReport();
+        last_memory_report_ = now;
+    }
+    
+    // Scheduling jitter histograms and overrun attribution
+    if (config_.jitter_config.report_interval_sec > 0 &&
+        now - last_jitter_report_ >= std::chrono::seconds(config_.jitter_config.report_interval_sec)) {
+        JitterMonitor::logReport();
+        last_jitter_report_ = now;
+    }
+}
+
 void SentinelCore::checkSensor() {
+    JitterScope timing(JitterTask::SENSOR_POLL);
     float ppm = sensor_->getPPM();
     bool smoke_detected = sensor_->detectSmoke();
     
     if (config_.debug_mode) {
-        Logger::debug("Sensor PPM: " + std::to_string(ppm) + 
-                     " Detected: " + std::to_string(smoke_detected));
+        Logger::logf(LogLevel::DEBUG, "Sensor PPM: %f Detected: %d", ppm, smoke_detected);
     }
     
     detection_data_.sensor_detected = smoke_detected;
     detection_data_.smoke_ppm = ppm;
     detection_data_.sensor_timestamp = std::chrono::system_clock::now();
+    
+    if (config_.fusion_config.enabled) {
+        if (fusion_->addSensor(ppm)) {
+            Logger::logf(LogLevel::INFO, "Evidence fusion: %s (sensor %.0f PPM)",
+                         fusion_->detected() ? "smoke" : "clear", ppm);
+        }
+        detection_data_.evidence = fusion_->statistic();
+    }
 }
 
 void SentinelCore::checkVision() {
-    auto result = detector_->detectSmoke();
+    JitterScope timing(JitterTask::VISION_TICK);
+    DetectionResult result{};
+    if (vision_source_) {
+        vision_source_(result);
+    } else {
+        // Capture and inference leave the isolated core while they run
+        RealtimeRoleScope inference(ThreadRole::INFERENCE);
+        result = detector_->detectSmoke();
+    }
     
     if (config_.debug_mode) {
-        Logger::debug("Vision confidence: " + std::to_string(result.confidence) +
-                     " Detected: " + std::to_string(result.detected));
+        Logger::logf(LogLevel::DEBUG, "Vision confidence: %f Detected: %d",
+                     result.confidence, result.detected);
+        if (result.plume) {
+            Logger::logf(LogLevel::DEBUG, "Plume %u: area %f at (%f, %f) growth %f/s%s",
+                         result.plume_id, result.plume_area, result.plume_x, result.plume_y,
+                         result.plume_growth_rate, result.plume_growing ? " (growing)" : "");
+        }
+    }
+    
+    // A frame was analysed: the model ran, or night mode looked at it
+    if (result.inference_time_ms > 0.0f || result.night) {
+        if (result.inference_time_ms > 0.0f) {
+            governor_->recordFrame(result.inference_time_ms);
+            
+            // Only frames the model scored are evidence; night frames it
+            // skipped say nothing about smoke
+            if (config_.fusion_config.enabled) {
+                if (fusion_->addVision(result.confidence)) {
+                    Logger::logf(LogLevel::INFO, "Evidence fusion: %s (vision %.2f)",
+                                 fusion_->detected() ? "smoke" : "clear", result.confidence);
+                }
+                detection_data_.evidence = fusion_->statistic();
+            }
+        }
+        
+        // The classified frame, into the next slot (the one copy it gets)
+        if (live_ && detector_) {
+            const cv::Mat& frame = detector_->lastFrame();
+            live_->publishFrame(frame.data, frame.cols, frame.rows, frame.type(),
+                                frame.cols * frame.elemSize(), frame.step, liveMonotonicNs());
+        }
+        
+        // Preview: copied only while someone is watching, at preview.max_fps
+        auto now = std::chrono::steady_clock::now();
+        if (preview_ && detector_ && preview_->wantsFrame(now)) {
+            preview_->offerFrame(detector_->lastFrame(), result.confidence, result.detected,
+                                 governor_->quality().tile_grid, now);
+        }
     }
     
     detection_data_.vision_detected = result.detected;
@@ -131,34 +821,73 @@ void SentinelCore::checkVision() {
     detection_data_.vision_timestamp = std::chrono::system_clock::now();
 }
 
-void SentinelCore::updateAlertState() {
-    bool local_detection = detection_data_.sensor_detected || 
-                          detection_data_.vision_detected;
+bool SentinelCore::localDetection() const {
+    if (config_.fusion_config.enabled) {
+        return fusion_->detected();
+    }
+    return detection_data_.sensor_detected || detection_data_.vision_detected;
+}
+
+float SentinelCore::consensusRatio(int& detecting_nodes, int& total_nodes) const {
+    total_nodes = mesh_->getActiveNodeCount() + 1; // +1 for self
+    detecting_nodes = mesh_->getDetectingNodeCount() + (localDetection() ? 1 : 0);
+    return static_cast<float>(detecting_nodes) / total_nodes;
+}
+
+bool SentinelCore::consensusReached(float ratio, int detecting_nodes, int total_nodes) const {
+    // With no peers known there is nobody to confirm: this node decides
+    // alone rather than never alerting
+    int min_nodes = total_nodes > 1 ? config_.consensus_min_nodes : 1;
+    return ratio >= config_.consensus_threshold && detecting_nodes >= min_nodes;
+}
+
+void SentinelCore::updateAlertState(std::chrono::steady_clock::time_point now) {
+    bool local_detection = localDetection();
     
     if (local_detection) {
+        if (alert_state_ == AlertState::IDLE &&
+            now < cooldown_end_time_) {
+            // Suppress re-alerting until alert.cooldown_sec has passed
+            return;
+        }
+        
         if (alert_state_ == AlertState::IDLE) {
             Logger::info("Local detection triggered - entering PENDING state");
             alert_state_ = AlertState::PENDING;
-            consensus_start_time_ = std::chrono::steady_clock::now();
+            consensus_start_time_ = now;
+            stats_.detection_time = consensus_start_time_;
             
             // Broadcast detection to mesh
             mesh_->broadcastDetection(true);
         }
         
-        // Check if consensus window expired
-        if (alert_state_ == AlertState::PENDING) {
-            auto elapsed = std::chrono::steady_clock::now() - consensus_start_time_;
-            if (elapsed >= std::chrono::seconds(config_.consensus_timeout_sec)) {
-                evaluateConsensus();
+        // Check if consensus window expired. Peers only ever add
+        // detections during the window, so with fusion (a confident local
+        // decision) a ratio that is already met is acted on right away.
+        // Right after startup the mesh may not know its neighbours yet:
+        // wait for the join handshake rather than decide alone.
+        if (alert_state_ == AlertState::PENDING && !mesh_->joining()) {
+            auto elapsed = now - consensus_start_time_;
+            bool decide = elapsed >= std::chrono::seconds(config_.consensus_timeout_sec);
+            if (!decide && config_.fusion_config.enabled) {
+                int detecting_nodes = 0;
+                int total_nodes = 0;
+                float ratio = consensusRatio(detecting_nodes, total_nodes);
+                decide = consensusReached(ratio, detecting_nodes, total_nodes);
+            }
+            if (decide) {
+                evaluateConsensus(now);
             }
         }
     } else {
         if (alert_state_ == AlertState::ALERT) {
             // Check if alert should be cleared
-            auto elapsed = std::chrono::steady_clock::now() - alert_start_time_;
+            auto elapsed = now - alert_start_time_;
             if (elapsed >= std::chrono::seconds(config_.alert_duration_sec)) {
                 Logger::info("Alert cleared - returning to IDLE");
                 alert_state_ = AlertState::IDLE;
+                cooldown_end_time_ = now +
+                                     std::chrono::seconds(config_.alert_cooldown_sec);
                 mesh_->broadcastDetection(false);
             }
         } else if (alert_state_ == AlertState::PENDING) {
@@ -169,22 +898,20 @@ void SentinelCore::updateAlertState() {
     }
 }
 
-void SentinelCore::evaluateConsensus() {
-    int total_nodes = mesh_->getActiveNodeCount() + 1; // +1 for self
-    int detecting_nodes = mesh_->getDetectingNodeCount() + 
-                         (detection_data_.sensor_detected || 
-                          detection_data_.vision_detected ? 1 : 0);
+void SentinelCore::evaluateConsensus(std::chrono::steady_clock::time_point now) {
+    int detecting_nodes = 0;
+    int total_nodes = 0;
+    float consensus_ratio = consensusRatio(detecting_nodes, total_nodes);
     
-    float consensus_ratio = static_cast<float>(detecting_nodes) / total_nodes;
+    Logger::logf(LogLevel::INFO, "Consensus evaluation: %d/%d nodes (%f%%)",
+                 detecting_nodes, total_nodes, consensus_ratio * 100);
     
-    Logger::info("Consensus evaluation: " + std::to_string(detecting_nodes) + 
-                "/" + std::to_string(total_nodes) + " nodes (" +
-                std::to_string(consensus_ratio * 100) + "%)");
-    
-    if (consensus_ratio >= config_.consensus_threshold) {
+    if (consensusReached(consensus_ratio, detecting_nodes, total_nodes)) {
         Logger::warn("ALERT: Wildfire detection confirmed by consensus!");
         alert_state_ = AlertState::ALERT;
-        alert_start_time_ = std::chrono::steady_clock::now();
+        alert_start_time_ = now;
+        stats_.alerts++;
+        stats_.alert_time = alert_start_time_;
         
         // Trigger alert actions
         triggerAlert();
@@ -196,31 +923,248 @@ void SentinelCore::evaluateConsensus() {
 
 void SentinelCore::handleMeshDetection(uint8_t node_id, bool detected) {
     if (config_.debug_mode) {
-        Logger::debug("Mesh detection from node " + std::to_string(node_id) +
-                     ": " + std::to_string(detected));
+        Logger::logf(LogLevel::DEBUG, "Mesh detection from node %u: %d", node_id, detected);
+    }
+}
+
+void SentinelCore::handleUpstreamReport(uint8_t origin, const uint8_t* data, size_t len) {
+    if (len < ALERT_REPORT_LEN || data[0] != REPORT_ALERT) {
+        Logger::logf(LogLevel::WARN, "Unknown upstream report from node %u (%zu bytes)",
+                     origin, len);
+        return;
     }
+    Logger::logf(LogLevel::WARN, "Alert reported by node %u: %u detecting nodes, %u PPM, "
+                 "vision %u%%", origin, data[1], data[2] | (data[3] << 8), data[4]);
 }
 
 void SentinelCore::triggerAlert() {
     // Log alert with all detection data
+    int detecting_nodes = mesh_->getDetectingNodeCount() + 1;
     Logger::warn("=== WILDFIRE ALERT ===");
-    Logger::warn("Sensor PPM: " + std::to_string(detection_data_.smoke_ppm));
-    Logger::warn("Vision Confidence: " + 
-                std::to_string(detection_data_.vision_confidence));
-    Logger::warn("Detecting Nodes: " + 
-                std::to_string(mesh_->getDetectingNodeCount() + 1));
+    Logger::logf(LogLevel::WARN, "Sensor PPM: %f", detection_data_.smoke_ppm);
+    Logger::logf(LogLevel::WARN, "Vision Confidence: %f", detection_data_.vision_confidence);
+    Logger::logf(LogLevel::WARN, "Detecting Nodes: %d", detecting_nodes);
     Logger::warn("=====================");
     
+    // Report to the gateways along the routing gradient
+    uint8_t report[ALERT_REPORT_LEN];
+    auto ppm = static_cast<uint16_t>(std::clamp(detection_data_.smoke_ppm, 0.0f, 65535.0f));
+    report[0] = REPORT_ALERT;
+    report[1] = static_cast<uint8_t>(std::min(detecting_nodes, 255));
+    report[2] = static_cast<uint8_t>(ppm & 0xFF);
+    report[3] = static_cast<uint8_t>(ppm >> 8);
+    report[4] = static_cast<uint8_t>(std::clamp(detection_data_.vision_confidence, 0.0f, 1.0f) * 100.0f);
+    if (!mesh_->sendUpstream(report, sizeof(report))) {
+        Logger::warn("Alert not reported upstream - no route to a gateway");
+    }
+    
     // TODO: Add additional alert mechanisms
     // - Send notification via MQTT
     // - Activate sirens/lights
     // - Log to central database
 }
 
+void SentinelCore::openStateSnapshot() {
+    if (!config_.warm_restart || config_.data_directory.empty()) {
+        return;
+    }
+    
+    state_ = std::make_unique<StateSnapshot>(config_.data_directory + "/sentinel.state",
+                                             config_.node_id);
+    if (!state_->open()) {
+        Logger::warn("Warm restart disabled: state file unavailable");
+        state_.reset();
+        return;
+    }
+    
+    peer_table_.resize(1);
+    
+    if (state_->hasPreviousState()) {
+        Logger::info("Found state from previous run");
+    }
+}
+
+void SentinelCore::restoreCalibration() {
+    if (!state_) {
+        return;
+    }
+    
+    CalibrationRecord record;
+    auto max_age = std::chrono::seconds(config_.calibration_max_age_sec);
+    if (state_->read(StateSection::CALIBRATION, &record, sizeof(record), max_age) != sizeof(record)) {
+        return;
+    }
+    
+    CalibrationData data;
+    data.offset = record.offset;
+    data.scale_factor = record.r0;
+    data.calibration_time = std::chrono::system_clock::time_point(
+        std::chrono::milliseconds(record.calibration_time_ms));
+    data.is_valid = true;
+    
+    auto age = std::chrono::system_clock::now() - data.calibration_time;
+    if (age > max_age || age < std::chrono::seconds(0)) {
+        return;
+    }
+    
+    if (sensor_->restoreCalibration(data)) {
+        Logger::info("Restored sensor calibration (R0=" + std::to_string(record.r0) + " kOhms)");
+    }
+}
+
+void SentinelCore::restorePeerTable() {
+    if (!state_ || !state_->hasPreviousState()) {
+        return;
+    }
+    
+    PeerTableRecord* peers = peer_table_.data();
+    auto max_age = std::chrono::seconds(config_.state_max_age_sec);
+    if (state_->read(StateSection::PEERS, peers, sizeof(*peers), max_age) == sizeof(*peers) &&
+        peers->count <= STATE_MAX_PEERS) {
+        std::vector<NodeInfo> nodes;
+        for (uint32_t i = 0; i < peers->count; i++) {
+            const PeerRecord& peer = peers->peers[i];
+            NodeInfo node;
+            node.node_id = peer.node_id;
+            node.detecting = peer.detecting != 0;
+            node.rssi = peer.rssi;
+            node.silence_bound_sec = peer.silence_bound_sec;
+            node.last_seen = std::chrono::steady_clock::time_point(
+                std::chrono::milliseconds(peer.last_seen_ms));
+            nodes.push_back(node);
+        }
+        mesh_->restoreNodes(nodes);
+    }
+}
+
+void SentinelCore::restoreRuntimeState() {
+    if (!state_ || !state_->hasPreviousState()) {
+        return;
+    }
+    
+    auto max_age = std::chrono::seconds(config_.state_max_age_sec);
+    
+    SensorWindowRecord sensor_window;
+    if (state_->read(StateSection::SENSOR_WINDOW, &sensor_window, sizeof(sensor_window), max_age) ==
+            sizeof(sensor_window) &&
+        sensor_window.count <= STATE_MAX_SENSOR_WINDOW) {
+        std::vector<bool> history(sensor_window.detections,
+                                  sensor_window.detections + sensor_window.count);
+        sensor_->restoreDetectionHistory(history);
+    }
+    
+    VisionWindowRecord vision_window;
+    if (detector_ &&
+        state_->read(StateSection::VISION_WINDOW, &vision_window, sizeof(vision_window), max_age) ==
+            sizeof(vision_window) &&
+        vision_window.count <= STATE_MAX_CONFIDENCE_WINDOW) {
+        std::vector<float> history(vision_window.confidences,
+                                   vision_window.confidences + vision_window.count);
+        detector_->restoreConfidenceHistory(history);
+    }
+    
+    // steady_clock is system-wide, so timestamps from the same boot still
+    // line up and an in-flight consensus window resumes where it left off
+    AlertRecord alert;
+    if (state_->read(StateSection::ALERT, &alert, sizeof(alert), max_age) == sizeof(alert) &&
+        alert.alert_state <= static_cast<uint8_t>(AlertState::ALERT)) {
+        auto fromMs = [](int64_t ms) {
+            return std::chrono::steady_clock::time_point(std::chrono::milliseconds(ms));
+        };
+        alert_state_ = static_cast<AlertState>(alert.alert_state);
+        detection_data_.sensor_detected = alert.sensor_detected != 0;
+        detection_data_.vision_detected = alert.vision_detected != 0;
+        detection_data_.smoke_ppm = alert.smoke_ppm;
+        detection_data_.vision_confidence = alert.vision_confidence;
+        consensus_start_time_ = fromMs(alert.consensus_start_ms);
+        alert_start_time_ = fromMs(alert.alert_start_ms);
+        cooldown_end_time_ = fromMs(alert.cooldown_end_ms);
+    }
+    
+    Logger::info("Restored runtime state: " + std::to_string(mesh_->getActiveNodeCount()) +
+                " peers, alert state " + std::to_string(static_cast<int>(alert_state_)));
+}
+
+void SentinelCore::saveState() {
+    JitterScope timing(JitterTask::STATE_SAVE);
+    auto toMs = [](std::chrono::steady_clock::time_point t) {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            t.time_since_epoch()).count());
+    };
+    
+    if (sensor_) {
+        CalibrationData calibration = sensor_->getCalibration();
+        if (calibration.is_valid) {
+            CalibrationRecord record{};
+            record.r0 = calibration.scale_factor;
+            record.offset = calibration.offset;
+            record.calibration_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                calibration.calibration_time.time_since_epoch()).count();
+            state_->write(StateSection::CALIBRATION, &record, sizeof(record));
+        }
+        
+        SensorWindowRecord sensor_window{};
+        const auto& history = sensor_->getDetectionHistory();
+        sensor_window.count = std::min(history.size(), STATE_MAX_SENSOR_WINDOW);
+        for (uint32_t i = 0; i < sensor_window.count; i++) {
+            sensor_window.detections[i] = history[history.size() - sensor_window.count + i];
+        }
+        state_->write(StateSection::SENSOR_WINDOW, &sensor_window, sizeof(sensor_window));
+    }
+    
+    if (detector_) {
+        VisionWindowRecord vision_window{};
+        const auto& history = detector_->getConfidenceHistory();
+        vision_window.count = std::min(history.size(), STATE_MAX_CONFIDENCE_WINDOW);
+        for (uint32_t i = 0; i < vision_window.count; i++) {
+            vision_window.confidences[i] = history[history.size() - vision_window.count + i];
+        }
+        state_->write(StateSection::VISION_WINDOW, &vision_window, sizeof(vision_window));
+    }
+    
+    if (mesh_) {
+        PeerTableRecord* peers = peer_table_.data();
+        std::memset(peers, 0, sizeof(*peers));
+        
+        std::pmr::vector<NodeInfo> nodes(scratch_->resource());
+        mesh_->getNodes(nodes);
+        for (const auto& node : nodes) {
+            if (peers->count == STATE_MAX_PEERS) {
+                break;
+            }
+            PeerRecord& peer = peers->peers[peers->count++];
+            peer.node_id = node.node_id;
+            peer.detecting = node.detecting ? 1 : 0;
+            peer.rssi = static_cast<int16_t>(node.rssi);
+            peer.silence_bound_sec = node.silence_bound_sec;
+            peer.last_seen_ms = toMs(node.last_seen);
+        }
+        state_->write(StateSection::PEERS, peers, sizeof(*peers));
+    }
+    
+    AlertRecord alert{};
+    alert.alert_state = static_cast<uint8_t>(alert_state_);
+    alert.sensor_detected = detection_data_.sensor_detected ? 1 : 0;
+    alert.vision_detected = detection_data_.vision_detected ? 1 : 0;
+    alert.smoke_ppm = detection_data_.smoke_ppm;
+    alert.vision_confidence = detection_data_.vision_confidence;
+    alert.consensus_start_ms = toMs(consensus_start_time_);
+    alert.alert_start_ms = toMs(alert_start_time_);
+    alert.cooldown_end_ms = toMs(cooldown_end_time_);
+    state_->write(StateSection::ALERT, &alert, sizeof(alert));
+    
+    state_->flush();
+}
+
 void SentinelCore::shutdown() {
     Logger::info("Shutting down Sentinel Core...");
     g_running = false;
     
+    if (state_) {
+        saveState();
+        state_.reset();
+    }
+    
     if (mesh_) {
         mesh_->shutdown();
     }
@@ -233,48 +1177,22 @@ void SentinelCore::shutdown() {
         sensor_->shutdown();
     }
     
-    Logger::info("Shutdown complete");
-}
-
-} // namespace sentinel
-
-int main(int argc, char* argv[]) {
-    using namespace sentinel;
-    
-    Logger::info("Sentinel Edge-AI Wildfire Detection System v1.0");
-    Logger::info("================================================");
-    
-    // Load configuration
-    Config config;
-    config.debug_mode = false;
-    config.i2c_address = 0x48;
-    config.model_path = "../models/smoke_detection.tflite";
-    config.node_id = 1;
-    config.consensus_threshold = 0.6f;
-    config.consensus_timeout_sec = 5;
-    config.alert_duration_sec = 60;
-    
-    // Parse command line arguments
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        if (arg == "--debug") {
-            config.debug_mode = true;
-            Logger::setLevel(LogLevel::DEBUG);
-        } else if (arg == "--config" && i + 1 < argc) {
-            // TODO: Load config from file
-            i++;
-        }
+    if (governor_) {
+        governor_->stop();
     }
     
-    // Initialize and run
-    SentinelCore core(config);
+    if (live_) {
+        live_->stop();
+    }
     
-    if (!core.initialize()) {
-        Logger::error("Failed to initialize Sentinel Core");
-        return 1;
+    if (preview_) {
+        preview_->stop();
     }
     
-    core.run();
+    // After the subsystems have cancelled their timers
+    Executor::stop();
     
-    return 0;
-}
\ No newline at end of file
+    Logger::info("Shutdown complete");
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -3,7 +3,10 @@
 
 #include <memory>
 #include <chrono>
+#include <functional>
 #include <string>
+#include <vector>
+#include <memory_resource>
 #include <cstdint>
 
 namespace sentinel {
@@ -12,16 +15,159 @@ namespace sentinel {
 class MQ2Sensor;
 class SmokeDetector;
 class LoraMesh;
+class ConfigStore;
+class ConfigReader;
+class StateSnapshot;
+class ThermalGovernor;
+class LiveExport;
+class PreviewServer;
+class ScratchArena;
+class EvidenceFusion;
+struct PeerTableRecord;
+struct DetectionResult;
+enum class TransferKind : uint8_t;
 
 // Configuration structures
 struct LoraConfig {
     float frequency = 433.0f;        // MHz
     int bandwidth = 125;             // kHz
     int spreading_factor = 12;
+    int coding_rate = 5;             // 4/x
     int tx_power = 20;               // dBm
-    int heartbeat_interval_sec = 30;
-    int node_timeout_sec = 90;
+    uint8_t sync_word = 0x12;
+    int preamble_length = 8;
+    bool crc_enabled = true;
+    int heartbeat_interval_sec = 30;      // Shortest heartbeat interval (Trickle imin)
+    int heartbeat_max_interval_sec = 120; // Doubles up to this while nothing changes
+    int heartbeat_redundancy = 3;         // Skip a heartbeat after hearing this many
+                                          // consistent ones (0 = never skip)
+    int join_slots = 16;                  // Reply slots for the join handshake at
+                                          // startup (0 = wait for heartbeats)
+    bool gateway = false;                 // Sink for upstream messages (has a backhaul)
+    int update_duty_percent = 0;          // Airtime share for serving model and config
+                                          // updates (0 = no mesh updates)
+    std::string update_key;               // Shared key authenticating updates, 32 hex
+                                          // digits (required for mesh updates)
+    int update_advert_max_sec = 1800;     // Longest interval between update adverts
+    int node_timeout_sec = 90;            // Minimum; peers announcing longer silences get
+                                          // more (LoraMesh::peerTimeout), detections
+                                          // expire after this
+    int max_retries = 3;
+    int retry_delay_ms = 500;
     bool debug_mode = false;
+    std::string capture_file;        // Record all mesh frames here (empty = off)
+};
+
+struct SensorConfig {
+    int calibration_time_sec = 30;
+    float smoke_threshold_ppm = 200.0f;
+    int sampling_interval_ms = 1000;
+    std::string trace_file;          // Replay ADC samples instead of I2C (testing)
+    int trace_rate_hz = 0;           // Trace sample rate; 0 = one sample per read
+};
+
+// Largest vision.tile_grid: the detector keeps one confidence per tile on
+// the stack
+constexpr int MAX_TILE_GRID = 4;
+
+struct VisionConfig {
+    int camera_device = 0;
+    int frame_width = 640;
+    int frame_height = 480;
+    int fps = 5;
+    float confidence_threshold = 0.75f;
+    int tile_grid = 1;               // Classify an NxN grid of tiles (1 = whole frame,
+                                     // at most MAX_TILE_GRID)
+    std::string lite_model_path;     // Smaller model the governor may fall back to
+    int interpreters = 1;            // Interpreters classifying tiles in parallel (0 = one per executor worker)
+    std::string video_source;        // Video file instead of camera_device (testing)
+    int profile_invokes = 0;         // Profile this many invokes per operator, then report (0 = off)
+    std::string profile_path;        // Also append the profile report here
+    float plume_threshold = 0.5f;    // Segmentation models: mask probability counted as plume
+    int plume_growth_frames = 5;     // Frames a plume must keep growing to count as a detection
+    bool night_mode = false;         // Dark scenes: glow detector, the model only when something glows
+    std::string light_sensor;        // IIO light sensor directory; empty = mean frame luminance
+    float night_luma = 40.0f;        // Mean frame luminance (0-255) below which it is night
+    float day_luma = 60.0f;          // ...and above which it is day again
+    float night_lux = 10.0f;         // The same thresholds with a light sensor
+    float day_lux = 30.0f;
+    int night_hold_sec = 30;         // A new mode must be indicated this long before switching
+    float night_glow_fraction = 0.0005f;  // Glowing share of the frame that runs the model at night
+};
+
+struct MemoryConfig {
+    int report_interval_sec = 60;    // 0 disables the periodic report
+    int vision_budget_kb = 0;        // Per-subsystem budgets, 0 = unlimited
+    int mesh_budget_kb = 0;
+    int sensor_budget_kb = 0;
+    int logging_budget_kb = 0;
+    int storage_budget_kb = 0;
+    bool shed_load = false;          // Shed load when over budget (else warn only)
+};
+
+struct RealtimeConfig {
+    bool enabled = false;            // SCHED_FIFO, CPU pinning and locked memory
+    bool lock_memory = true;
+    std::string core_cpus = "3";     // Detection loop and radio threads (ideally isolcpus)
+    std::string inference_cpus = "0-2";   // TFLite, OpenCV and background threads (empty = all)
+    int core_priority = 50;          // SCHED_FIFO priorities, 0 = SCHED_OTHER
+    int radio_priority = 60;
+};
+
+struct ExecutorConfig {
+    int threads = 0;                 // Shared worker threads, 0 = one per usable CPU
+};
+
+struct GovernorConfig {
+    bool enabled = true;             // Step vision quality with temperature and latency
+    std::string sysfs_root = "/sys"; // Point at a fake tree for testing
+    float max_temp_c = 75.0f;        // Step down at or above (or when throttled)
+    float temp_hysteresis_c = 5.0f;  // Step up only below max_temp_c minus this
+    float target_latency_ms = 150.0f;    // Mean inference time per frame, all tiles
+    int latency_hysteresis_pct = 30; // Step up only below target minus this %
+    int min_fps = 1;                 // Lower bounds of the quality ladder
+    int min_threads = 1;
+    int poll_interval_ms = 2000;     // sysfs reads and decisions
+    int step_down_sec = 4;           // Minimum time at a level before stepping down
+    int step_up_sec = 30;            // ... and before stepping up
+};
+
+struct LiveExportConfig {
+    bool enabled = false;            // Share state and frames with local processes
+    std::string socket_path;         // Unix socket handing out the region, empty =
+                                     // <data_directory>/live.sock
+    int frame_slots = 4;             // Frame ring size
+    bool frames = true;              // Publish camera frames, not just state
+};
+
+struct PreviewConfig {
+    bool enabled = false;            // MJPEG camera preview over HTTP
+    std::string bind_address = "127.0.0.1";
+    bool allow_remote = false;       // Permit a non-loopback bind_address (no authentication)
+    int port = 8081;
+    int max_clients = 10;
+    int max_fps = 5;                 // Encoded frames per second at most
+    int jpeg_quality = 70;
+    bool overlay = true;             // Confidence and tile grid
+};
+
+struct JitterConfig {
+    bool enabled = true;             // Record wakeup lateness and run times
+    int report_interval_sec = 300;   // 0 disables the periodic report
+    int overrun_pct = 50;            // Lateness, in % of the period, that is an overrun
+};
+
+struct FusionConfig {
+    bool enabled = false;            // SPRT over sensor and vision evidence instead of
+                                     // the OR of the sensor vote and vision average
+    float false_alarm_rate = 0.001f; // Nominal alpha and beta of each test
+    float miss_rate = 0.01f;
+    float clean_ppm = 50.0f;         // Typical PPM in clean air...
+    float smoke_ppm = 400.0f;        // ...and in smoke
+    float ppm_spread = 0.3f;         // Standard deviation of log10(PPM) around either
+    float vision_scale = 0.25f;      // Platt calibration of the model's logit, discounted
+    float vision_bias = 0.0f;        // for consecutive frames being correlated
+    float max_step = 3.0f;           // Largest log-likelihood ratio of one sample
 };
 
 struct Config {
@@ -29,12 +175,48 @@ struct Config {
     uint8_t i2c_address = 0x48;
     std::string model_path;
     uint8_t node_id = 1;
+    std::string node_name;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    float elevation = 0.0f;          // meters
     float consensus_threshold = 0.6f;
     int consensus_timeout_sec = 5;
+    int consensus_min_nodes = 2;     // Detecting nodes needed for an alert, this one included
+                                     // (1 while no peers are known)
     int alert_duration_sec = 60;
+    int alert_cooldown_sec = 300;
+    std::vector<std::string> notification_methods;
+    std::string log_level = "INFO";
+    std::string log_file;            // Also log here (empty = stdout only)
+    std::string data_directory = "/var/lib/sentinel";
+    bool warm_restart = true;        // Restore state snapshot on startup
+    int state_max_age_sec = 60;      // Oldest runtime state worth restoring
+    int calibration_max_age_sec = 3600;
+    SensorConfig sensor_config;
+    VisionConfig vision_config;
     LoraConfig lora_config;
+    MemoryConfig memory_config;
+    JitterConfig jitter_config;
+    RealtimeConfig realtime_config;
+    ExecutorConfig executor_config;
+    GovernorConfig governor_config;
+    LiveExportConfig live_config;
+    PreviewConfig preview_config;
+    FusionConfig fusion_config;
 };
 
+// Source of raw mesh frames replacing the radio receiver (simulation and
+// replay). Returns the frame length, or 0 if nothing is pending.
+using MeshFrameSource = std::function<int(uint8_t* buffer, size_t max_len)>;
+
+// Sink handed every transmitted mesh frame alongside the radio (tests)
+using MeshFrameSink = std::function<void(const uint8_t* frame, size_t len)>;
+
+// Source of vision results replacing the camera and model (tests). Fills
+// in one frame's result; a frame counts as analysed with
+// inference_time_ms > 0.
+using VisionSource = std::function<void(DetectionResult& result)>;
+
 // Detection data structure
 struct DetectionData {
     bool sensor_detected = false;
@@ -44,6 +226,8 @@ struct DetectionData {
     bool vision_detected = false;
     float vision_confidence = 0.0f;
     std::chrono::system_clock::time_point vision_timestamp;
+    
+    float evidence = 0.0f;           // fusion.enabled: running SPRT log-likelihood ratio
 };
 
 // Alert states
@@ -53,6 +237,18 @@ enum class AlertState {
     ALERT
 };
 
+// Loop counters for monitoring and benchmarking (updated by runCycle)
+struct PipelineStats {
+    uint64_t cycles = 0;
+    uint64_t sensor_checks = 0;
+    uint64_t vision_frames = 0;
+    uint64_t alerts = 0;
+    size_t quality_level = 0;        // ThermalGovernor level (0 = configured quality)
+    uint64_t quality_changes = 0;
+    std::chrono::steady_clock::time_point detection_time;   // Latest IDLE -> PENDING
+    std::chrono::steady_clock::time_point alert_time;       // Latest alert
+};
+
 class SentinelCore {
 public:
     explicit SentinelCore(const Config& config);
@@ -61,9 +257,38 @@ public:
     // Initialize all subsystems
     bool initialize();
     
+    // Follow configuration updates published to store (optional). Changes
+    // are applied at the start of the next loop iteration.
+    void setConfigStore(ConfigStore* store);
+    
     // Main detection loop
     void run();
     
+    // One iteration of the detection loop at time now: poll the subsystems
+    // that are due, update the alert state and persist state. Does not
+    // sleep or pick up configuration changes. After warm-up a cycle does
+    // not allocate.
+    void runCycle(std::chrono::steady_clock::time_point now);
+    
+    // Receive mesh frames from source instead of the radio (simulation).
+    // Must be called before initialize().
+    void setMeshFrameSource(MeshFrameSource source);
+    
+    // Take vision results from source instead of the camera and model.
+    // No detector is created, so there are no frames for the live export
+    // or the preview. Must be called before initialize().
+    void setVisionSource(VisionSource source);
+    
+    // The file the configuration came from. Config updates from the mesh
+    // are saved there (and applied by the config watcher, if one is set).
+    void setConfigPath(const std::string& path);
+    
+    const PipelineStats& getStats() const { return stats_; }
+    AlertState getAlertState() const { return alert_state_; }
+    
+    // True once SIGINT or SIGTERM was received
+    static bool shutdownRequested();
+    
     // Shutdown and cleanup
     void shutdown();
     
@@ -71,27 +296,101 @@ private:
     // Subsystem checks
     void checkSensor();
     void checkVision();
-    void updateAlertState();
-    void evaluateConsensus();
+    void updateAlertState(std::chrono::steady_clock::time_point now);
+    void evaluateConsensus(std::chrono::steady_clock::time_point now);
     
-    // Mesh network callbacks
+    // This node's vote: the SPRT decision with fusion.enabled, else either
+    // subsystem's
+    bool localDetection() const;
+    
+    // Detecting share of the active nodes, this one included
+    float consensusRatio(int& detecting_nodes, int& total_nodes) const;
+    
+    // The share reaches consensus.threshold with at least
+    // consensus.min_nodes detecting, or this node alone if it knows no peers
+    bool consensusReached(float ratio, int detecting_nodes, int total_nodes) const;
+    
+    // Mesh network setup and callbacks
+    bool initializeMesh();
     void handleMeshDetection(uint8_t node_id, bool detected);
+    void handleUpstreamReport(uint8_t origin, const uint8_t* data, size_t len);
+    
+    // Model and config distribution (mesh.update_duty_percent and
+    // mesh.update_key). Files in <data_directory>/updates are served to
+    // the mesh, versioned by their modification time; a newer file placed
+    // there is distributed and installed here too. Files fetched from the
+    // mesh are saved there and installed once processMessages() returns.
+    void loadUpdateFiles();
+    void checkUpdateFiles(std::chrono::steady_clock::time_point now);
+    void handleMeshUpdate(TransferKind kind, uint32_t version, const uint8_t* data, size_t len);
+    void installUpdates();
+    void installModel(const std::vector<uint8_t>& data);
+    void installConfig(const std::vector<uint8_t>& data);
+    bool restartDetector();
+    
+    // Apply a new configuration snapshot, restarting only the subsystems
+    // whose hardware settings changed
+    void applyConfig(const Config& next);
+    
+    // Apply the governor's current vision quality
+    void applyQuality();
+    
+    // Shared-memory export for local consumers (live.enabled)
+    void startLiveExport();
+    void publishLiveState();
     
     // Alert handling
     void triggerAlert();
     
+    // Warm restart: state snapshot in data_directory
+    void openStateSnapshot();
+    void restoreCalibration();
+    void restorePeerTable();
+    void restoreRuntimeState();
+    void saveState();
+    
     Config config_;
+    std::unique_ptr<ConfigReader> config_reader_;
+    std::chrono::milliseconds sensor_interval_;
+    std::chrono::milliseconds vision_interval_;
+    
+    // Loop schedule (see runCycle)
+    std::chrono::steady_clock::time_point last_sensor_check_;
+    std::chrono::steady_clock::time_point last_vision_check_;
+    std::chrono::steady_clock::time_point last_state_save_;
+    std::chrono::steady_clock::time_point last_memory_report_;
+    std::chrono::steady_clock::time_point last_jitter_report_;
+    std::chrono::steady_clock::time_point last_update_check_;
+    
+    // Scratch memory released at the start of every cycle
+    std::unique_ptr<ScratchArena> scratch_;
     
     // Subsystem instances
     std::unique_ptr<MQ2Sensor> sensor_;
     std::unique_ptr<SmokeDetector> detector_;
     std::unique_ptr<LoraMesh> mesh_;
+    MeshFrameSource mesh_frame_source_;
+    VisionSource vision_source_;
+    std::unique_ptr<StateSnapshot> state_;
+    std::unique_ptr<ThermalGovernor> governor_;
+    std::unique_ptr<LiveExport> live_;
+    std::unique_ptr<PreviewServer> preview_;
+    std::unique_ptr<EvidenceFusion> fusion_;
+    std::pmr::vector<PeerTableRecord> peer_table_;   // Staging for the PEERS section
+    
+    // Mesh updates, by TransferKind
+    std::string config_path_;
+    std::vector<std::string> update_paths_;
+    std::vector<int64_t> update_versions_;  // Modification time of the file held
+    std::vector<bool> update_pending_;      // Saved, not installed yet
     
     // State tracking
     DetectionData detection_data_;
     AlertState alert_state_;
     std::chrono::steady_clock::time_point consensus_start_time_;
     std::chrono::steady_clock::time_point alert_start_time_;
+    std::chrono::steady_clock::time_point cooldown_end_time_;
+    PipelineStats stats_;
 };
 
 } // namespace sentinel
@@ -0,0 +1,282 @@
+#include "core/state_snapshot.h"
+#include "utils/checksum.h"
+#include "utils/logger.h"
+#include "utils/memory_tracker.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+namespace sentinel {
+
+namespace {
+
+constexpr char STATE_MAGIC[8] = {'S', 'N', 'T', 'L', 'S', 'T', 'A', 'T'};
+constexpr size_t BOOT_ID_LEN = 40;
+constexpr size_t SECTION_COUNT = static_cast<size_t>(StateSection::COUNT);
+
+struct FileHeader {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t file_size;
+    uint8_t node_id;
+    uint8_t reserved[7];
+    char boot_id[BOOT_ID_LEN];
+    int64_t heartbeat_ms;          // Last flush; unchanged sections are current as of this
+};
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+struct StateSnapshot::SlotHeader {
+    uint64_t sequence;       // Written last; higher is newer
+    int64_t written_ms;      // steady_clock
+    uint32_t length;
+    uint32_t crc;            // Over written_ms, length and data
+};
+
+size_t StateSnapshot::sectionCapacity(StateSection section) {
+    switch (section) {
+        case StateSection::CALIBRATION:   return sizeof(CalibrationRecord);
+        case StateSection::SENSOR_WINDOW: return sizeof(SensorWindowRecord);
+        case StateSection::VISION_WINDOW: return sizeof(VisionWindowRecord);
+        case StateSection::ALERT:         return sizeof(AlertRecord);
+        case StateSection::PEERS:         return sizeof(PeerTableRecord);
+        default:                          return 0;
+    }
+}
+
+size_t StateSnapshot::sectionOffset(StateSection section) const {
+    size_t offset = alignUp(sizeof(FileHeader), 64);
+    for (size_t i = 0; i < static_cast<size_t>(section); i++) {
+        size_t slot_size = alignUp(sizeof(SlotHeader) + sectionCapacity(static_cast<StateSection>(i)), 64);
+        offset += 2 * slot_size;
+    }
+    return offset;
+}
+
+StateSnapshot::SlotHeader* StateSnapshot::slot(StateSection section, int index) const {
+    size_t slot_size = alignUp(sizeof(SlotHeader) + sectionCapacity(section), 64);
+    return reinterpret_cast<SlotHeader*>(base_ + sectionOffset(section) + index * slot_size);
+}
+
+uint8_t* StateSnapshot::lastWritten(StateSection section) {
+    size_t offset = 0;
+    for (size_t i = 0; i < static_cast<size_t>(section); i++) {
+        offset += sectionCapacity(static_cast<StateSection>(i));
+    }
+    return last_written_.data() + offset;
+}
+
+StateSnapshot::StateSnapshot(const std::string& path, uint8_t node_id)
+    : path_(path),
+      node_id_(node_id),
+      fd_(-1),
+      base_(nullptr),
+      size_(0),
+      has_previous_state_(false),
+      dirty_(false),
+      last_written_(&MemoryTracker::resource(MemorySubsystem::STORAGE)) {
+    for (size_t i = 0; i < SECTION_COUNT; i++) {
+        last_length_[i] = 0;
+    }
+}
+
+StateSnapshot::~StateSnapshot() {
+    close();
+}
+
+bool StateSnapshot::open() {
+    size_ = sectionOffset(StateSection::COUNT);
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        Logger::error("Failed to open state file " + path_ + ": " + std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    bool existing = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == size_;
+    if (!existing && ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+        Logger::error("Failed to size state file " + path_ + ": " + std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        Logger::error("Failed to map state file " + path_ + ": " + std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(mapping);
+
+    // Only state from this node and this boot is meaningful: steady_clock
+    // timestamps restart from zero after a reboot
+    auto* header = reinterpret_cast<FileHeader*>(base_);
+    std::string boot_id = readBootId();
+    bool compatible = existing &&
+                      std::memcmp(header->magic, STATE_MAGIC, sizeof(STATE_MAGIC)) == 0 &&
+                      header->format_version == STATE_FORMAT_VERSION &&
+                      header->file_size == size_;
+    has_previous_state_ = compatible &&
+                          header->node_id == node_id_ &&
+                          !boot_id.empty() &&
+                          std::strncmp(header->boot_id, boot_id.c_str(), BOOT_ID_LEN) == 0;
+
+    if (!has_previous_state_) {
+        if (existing) {
+            Logger::info("Discarding state file " + path_ + " (different boot, node or format)");
+        }
+        resetFile();
+    }
+
+    size_t shadow_size = 0;
+    for (size_t i = 0; i < SECTION_COUNT; i++) {
+        shadow_size += sectionCapacity(static_cast<StateSection>(i));
+        last_length_[i] = 0;
+    }
+    last_written_.assign(shadow_size, 0);
+
+    return true;
+}
+
+void StateSnapshot::resetFile() {
+    std::memset(base_, 0, size_);
+
+    auto* header = reinterpret_cast<FileHeader*>(base_);
+    std::memcpy(header->magic, STATE_MAGIC, sizeof(STATE_MAGIC));
+    header->format_version = STATE_FORMAT_VERSION;
+    header->file_size = static_cast<uint32_t>(size_);
+    header->node_id = node_id_;
+    std::strncpy(header->boot_id, readBootId().c_str(), BOOT_ID_LEN - 1);
+
+    dirty_ = true;
+}
+
+void StateSnapshot::close() {
+    if (base_) {
+        msync(base_, size_, MS_ASYNC);
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool StateSnapshot::write(StateSection section, const void* data, size_t len) {
+    if (!base_) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>(section);
+    if (len > sectionCapacity(section)) {
+        len = sectionCapacity(section);
+    }
+
+    // Unchanged sections cost one memcmp
+    if (len == last_length_[index] &&
+        std::memcmp(lastWritten(section), data, len) == 0) {
+        return false;
+    }
+
+    SlotHeader* first = slot(section, 0);
+    SlotHeader* second = slot(section, 1);
+    SlotHeader* target = (first->sequence <= second->sequence) ? first : second;
+    uint64_t sequence = std::max(first->sequence, second->sequence) + 1;
+
+    target->written_ms = nowMs();
+    target->length = static_cast<uint32_t>(len);
+    std::memcpy(reinterpret_cast<uint8_t*>(target) + sizeof(SlotHeader), data, len);
+
+    uint32_t crc = crc32(&target->written_ms, sizeof(target->written_ms));
+    crc = crc32(&target->length, sizeof(target->length), crc);
+    crc = crc32(data, len, crc);
+    target->crc = crc;
+
+    // Publish the slot only after its contents are in place
+    std::atomic_thread_fence(std::memory_order_release);
+    target->sequence = sequence;
+
+    std::memcpy(lastWritten(section), data, len);
+    last_length_[index] = len;
+    dirty_ = true;
+    return true;
+}
+
+size_t StateSnapshot::read(StateSection section, void* out, size_t max_len,
+                           std::chrono::milliseconds max_age) const {
+    if (!base_ || !has_previous_state_) {
+        return 0;
+    }
+
+    const SlotHeader* best = nullptr;
+    for (int i = 0; i < 2; i++) {
+        const SlotHeader* candidate = slot(section, i);
+        if (candidate->sequence == 0 || candidate->length > sectionCapacity(section)) {
+            continue;
+        }
+
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(candidate) + sizeof(SlotHeader);
+        uint32_t crc = crc32(&candidate->written_ms, sizeof(candidate->written_ms));
+        crc = crc32(&candidate->length, sizeof(candidate->length), crc);
+        crc = crc32(payload, candidate->length, crc);
+        if (crc != candidate->crc) {
+            continue;
+        }
+
+        if (!best || candidate->sequence > best->sequence) {
+            best = candidate;
+        }
+    }
+
+    // A section is only rewritten when it changes, so its newest copy was
+    // still current at the last heartbeat
+    const auto* header = reinterpret_cast<const FileHeader*>(base_);
+    int64_t current_as_of = std::max(best ? best->written_ms : 0, header->heartbeat_ms);
+    if (!best || nowMs() - current_as_of > max_age.count()) {
+        return 0;
+    }
+
+    size_t len = std::min<size_t>(best->length, max_len);
+    std::memcpy(out, reinterpret_cast<const uint8_t*>(best) + sizeof(SlotHeader), len);
+    return len;
+}
+
+void StateSnapshot::flush() {
+    if (!base_) {
+        return;
+    }
+    
+    reinterpret_cast<FileHeader*>(base_)->heartbeat_ms = nowMs();
+    if (dirty_) {
+        msync(base_, size_, MS_ASYNC);
+        dirty_ = false;
+    }
+}
+
+std::string StateSnapshot::readBootId() {
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string boot_id;
+    std::getline(file, boot_id);
+    return boot_id;
+}
+
+int64_t StateSnapshot::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace sentinel
\ No newline at end of file
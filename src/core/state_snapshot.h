@@ -0,0 +1,142 @@
+#ifndef SENTINEL_STATE_SNAPSHOT_H
+#define SENTINEL_STATE_SNAPSHOT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace sentinel {
+
+// Persisted state records. These are plain structs copied byte-for-byte
+// into the state file; bump STATE_FORMAT_VERSION when changing any of them.
+
+constexpr uint32_t STATE_FORMAT_VERSION = 1;
+constexpr size_t STATE_MAX_SENSOR_WINDOW = 16;
+constexpr size_t STATE_MAX_CONFIDENCE_WINDOW = 32;
+constexpr size_t STATE_MAX_PEERS = 254;
+
+struct CalibrationRecord {
+    float r0;                      // MQ-2 clean-air resistance (kOhms)
+    float offset;
+    int64_t calibration_time_ms;   // system_clock, ms since epoch
+};
+
+struct SensorWindowRecord {
+    uint32_t count;
+    uint8_t detections[STATE_MAX_SENSOR_WINDOW];
+};
+
+struct VisionWindowRecord {
+    uint32_t count;
+    float confidences[STATE_MAX_CONFIDENCE_WINDOW];
+};
+
+struct AlertRecord {
+    uint8_t alert_state;
+    uint8_t sensor_detected;
+    uint8_t vision_detected;
+    uint8_t reserved;
+    float smoke_ppm;
+    float vision_confidence;
+    int64_t consensus_start_ms;    // steady_clock, ms
+    int64_t alert_start_ms;
+    int64_t cooldown_end_ms;
+};
+
+struct PeerRecord {
+    uint8_t node_id;
+    uint8_t detecting;
+    int16_t rssi;
+    uint16_t silence_bound_sec;    // 0 in files written before it was recorded
+    uint16_t reserved;
+    int64_t last_seen_ms;          // steady_clock, ms
+};
+
+struct PeerTableRecord {
+    uint32_t count;
+    uint32_t reserved;
+    PeerRecord peers[STATE_MAX_PEERS];
+};
+
+enum class StateSection {
+    CALIBRATION = 0,
+    SENSOR_WINDOW,
+    VISION_WINDOW,
+    ALERT,
+    PEERS,
+    COUNT
+};
+
+// Memory-mapped, checksummed store for warm restarts.
+//
+// Each section has two slots. A write goes to the older slot and only
+// happens when the section's bytes actually changed, so steady-state cost
+// is a memcmp per section. Readers take the newest slot whose CRC checks
+// out, which keeps the previous copy usable if the process dies mid-write.
+//
+// Timestamps are steady_clock (CLOCK_MONOTONIC), which survives process
+// restarts but not reboots; the file records the kernel boot id and is
+// treated as empty after a reboot or when it belongs to another node.
+class StateSnapshot {
+public:
+    StateSnapshot(const std::string& path, uint8_t node_id);
+    ~StateSnapshot();
+
+    StateSnapshot(const StateSnapshot&) = delete;
+    StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+    // Create or map the state file; resets it if the layout is incompatible
+    bool open();
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    // True if the file held state from this boot and node when opened
+    bool hasPreviousState() const { return has_previous_state_; }
+
+    // Store a section if its contents changed. Returns true if written.
+    bool write(StateSection section, const void* data, size_t len);
+
+    // Copy the newest valid copy of a section if the previous process was
+    // still running it within max_age (last write or flush). Returns the
+    // number of bytes copied, or 0 if nothing usable exists.
+    size_t read(StateSection section, void* out, size_t max_len,
+                std::chrono::milliseconds max_age) const;
+
+    // Record a heartbeat and schedule write-back of modified pages
+    // (non-blocking). Call periodically while the state is current.
+    void flush();
+
+    // Capacity of each section in bytes
+    static size_t sectionCapacity(StateSection section);
+
+private:
+    struct SlotHeader;
+
+    SlotHeader* slot(StateSection section, int index) const;
+    size_t sectionOffset(StateSection section) const;
+    uint8_t* lastWritten(StateSection section);
+    void resetFile();
+
+    static std::string readBootId();
+    static int64_t nowMs();
+
+    std::string path_;
+    uint8_t node_id_;
+    int fd_;
+    uint8_t* base_;
+    size_t size_;
+    bool has_previous_state_;
+    bool dirty_;
+
+    // Last bytes written per section, back to back, for change detection
+    // (storage memory resource)
+    std::pmr::vector<uint8_t> last_written_;
+    size_t last_length_[static_cast<size_t>(StateSection::COUNT)];
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_STATE_SNAPSHOT_H
\ No newline at end of file
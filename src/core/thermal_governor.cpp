@@ -0,0 +1,279 @@
+#include "core/thermal_governor.h"
+#include "utils/logger.h"
+#include <dirent.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace sentinel {
+
+namespace {
+
+// Raspberry Pi firmware get_throttled bits: currently capped or throttled
+constexpr unsigned THROTTLED_NOW = 0x2 | 0x4;
+
+// Maximum backoff of the step-up dwell after a step up was reversed
+constexpr int MAX_UP_BACKOFF = 8;
+
+bool readLong(const std::string& path, long& value, int base = 10) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    char text[32];
+    bool ok = std::fgets(text, sizeof(text), file) != nullptr;
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtol(text, &end, base);
+    return end != text;
+}
+
+// Numeric suffix of a directory entry named prefix<N>, or -1
+int entryIndex(const char* name, const char* prefix) {
+    size_t len = std::strlen(prefix);
+    if (std::strncmp(name, prefix, len) != 0 || name[len] < '0' || name[len] > '9') {
+        return -1;
+    }
+    char* end = nullptr;
+    long index = std::strtol(name + len, &end, 10);
+    return *end == '\0' && index < 4096 ? static_cast<int>(index) : -1;
+}
+
+} // namespace
+
+ThermalGovernor::ThermalGovernor(const GovernorConfig& config, const VisionQuality& best,
+                                 bool lite_model)
+    : config_(config),
+      lite_model_(lite_model),
+      level_(0),
+      up_backoff_(1),
+      last_step_up_(false),
+      latency_sum_ms_(0.0),
+      latency_frames_(0),
+      temp_mc_(INT_MIN),
+      cur_freq_khz_(0),
+      throttled_(false),
+      timer_(0) {
+    buildLadder(best);
+}
+
+ThermalGovernor::~ThermalGovernor() {
+    stop();
+}
+
+void ThermalGovernor::start() {
+    if (timer_ != 0 || !config_.enabled) {
+        return;
+    }
+    poll_root_ = config_.sysfs_root;
+    timer_ = Executor::schedule(std::chrono::milliseconds(0),
+                                std::chrono::milliseconds(config_.poll_interval_ms),
+                                [this]() { poll(); }, TaskPriority::LOW);
+}
+
+void ThermalGovernor::stop() {
+    if (timer_ != 0) {
+        // Waits for a poll in progress
+        Executor::cancel(timer_);
+        timer_ = 0;
+    }
+}
+
+void ThermalGovernor::applyConfig(const GovernorConfig& config, const VisionQuality& best,
+                                  bool lite_model) {
+    bool restart = config.enabled != config_.enabled ||
+                   config.sysfs_root != config_.sysfs_root ||
+                   config.poll_interval_ms != config_.poll_interval_ms;
+    if (restart) {
+        stop();
+        max_freq_khz_.clear();
+    }
+    config_ = config;
+    lite_model_ = lite_model;
+    buildLadder(best);
+    if (!config_.enabled) {
+        level_ = 0;
+    }
+    if (restart) {
+        start();
+    }
+}
+
+void ThermalGovernor::buildLadder(const VisionQuality& best) {
+    // From the configured quality down: fewer tiles, the lite model, half
+    // the frame rate at a time, then fewer threads
+    ladder_.clear();
+    VisionQuality quality = best;
+    ladder_.push_back(quality);
+    while (quality.tile_grid > 1) {
+        quality.tile_grid--;
+        ladder_.push_back(quality);
+    }
+    if (lite_model_ && !quality.lite_model) {
+        quality.lite_model = true;
+        ladder_.push_back(quality);
+    }
+    int min_fps = std::max(1, std::min(config_.min_fps, best.fps));
+    while (quality.fps > min_fps) {
+        quality.fps = std::max(min_fps, quality.fps / 2);
+        ladder_.push_back(quality);
+    }
+    int min_threads = std::max(1, std::min(config_.min_threads, best.threads));
+    while (quality.threads > min_threads) {
+        quality.threads--;
+        ladder_.push_back(quality);
+    }
+    level_ = std::min(level_, ladder_.size() - 1);
+}
+
+void ThermalGovernor::recordFrame(float latency_ms) {
+    latency_sum_ms_ += latency_ms;
+    latency_frames_++;
+}
+
+ThermalReading ThermalGovernor::reading() const {
+    ThermalReading reading;
+    reading.temp_mc = temp_mc_.load(std::memory_order_relaxed);
+    reading.cur_freq_khz = cur_freq_khz_.load(std::memory_order_relaxed);
+    reading.throttled = throttled_.load(std::memory_order_relaxed);
+    return reading;
+}
+
+bool ThermalGovernor::update(Clock::time_point now) {
+    if (!config_.enabled ||
+        now - last_update_ < std::chrono::milliseconds(config_.poll_interval_ms)) {
+        return false;
+    }
+    last_update_ = now;
+
+    float latency_ms = latency_frames_ > 0 ?
+                       static_cast<float>(latency_sum_ms_ / latency_frames_) : -1.0f;
+    latency_sum_ms_ = 0.0;
+    latency_frames_ = 0;
+
+    ThermalReading current = reading();
+    bool known_temp = current.temp_mc != INT_MIN;
+    float temp_c = known_temp ? current.temp_mc / 1000.0f : 0.0f;
+
+    bool hot = current.throttled || (known_temp && temp_c >= config_.max_temp_c);
+    bool slow = latency_ms > config_.target_latency_ms;
+    bool cool = !current.throttled &&
+                (!known_temp || temp_c < config_.max_temp_c - config_.temp_hysteresis_c);
+    bool fast = latency_ms < config_.target_latency_ms *
+                             (100 - config_.latency_hysteresis_pct) / 100.0f;
+
+    auto since_change = now - last_change_;
+    auto step_up_dwell = std::chrono::seconds(config_.step_up_sec) * up_backoff_;
+    if (last_step_up_ && since_change >= std::chrono::seconds(config_.step_up_sec)) {
+        // The last step up held: back to the normal dwell
+        up_backoff_ = 1;
+        last_step_up_ = false;
+    }
+
+    size_t next = level_;
+    const char* reason = nullptr;
+    if ((hot || slow) && level_ + 1 < ladder_.size() &&
+        since_change >= std::chrono::seconds(config_.step_down_sec)) {
+        // Latency alone only steps to lighter frames, or to a lower frame
+        // rate while frames take longer than the frame interval. Fewer
+        // threads relieve heat but make each frame slower.
+        const VisionQuality& current_quality = ladder_[level_];
+        const VisionQuality& lower = ladder_[level_ + 1];
+        bool lighter = lower.tile_grid < current_quality.tile_grid ||
+                       (lower.lite_model && !current_quality.lite_model);
+        bool behind = latency_ms > 1000.0f / current_quality.fps &&
+                      lower.threads == current_quality.threads;
+        if (hot || lighter || behind) {
+            next = level_ + 1;
+            reason = hot ? (current.throttled ? "throttled" : "hot") : "slow";
+            if (last_step_up_) {
+                up_backoff_ = std::min(up_backoff_ * 2, MAX_UP_BACKOFF);
+                last_step_up_ = false;
+            }
+        }
+    } else if (!hot && !slow && cool && fast && level_ > 0 && since_change >= step_up_dwell) {
+        next = level_ - 1;
+        reason = "recovered";
+        last_step_up_ = true;
+    }
+    if (next == level_) {
+        return false;
+    }
+
+    level_ = next;
+    last_change_ = now;
+    const VisionQuality& q = ladder_[level_];
+    Logger::logf(LogLevel::INFO, "Vision quality %zu/%zu (%s, %.1f C, %.0f ms/frame): "
+                 "%d fps, %dx%d tiles, %s model, %d threads", level_, ladder_.size() - 1,
+                 reason, temp_c, latency_ms, q.fps, q.tile_grid, q.tile_grid,
+                 q.lite_model ? "lite" : "full", q.threads);
+    return true;
+}
+
+void ThermalGovernor::poll() {
+    ThermalReading current = readSysfs(poll_root_, max_freq_khz_);
+    temp_mc_.store(current.temp_mc, std::memory_order_relaxed);
+    cur_freq_khz_.store(current.cur_freq_khz, std::memory_order_relaxed);
+    throttled_.store(current.throttled, std::memory_order_relaxed);
+}
+
+ThermalReading ThermalGovernor::readSysfs(const std::string& root,
+                                          std::vector<int>& max_freq_khz) {
+    ThermalReading reading;
+
+    std::string thermal = root + "/class/thermal";
+    if (DIR* dir = opendir(thermal.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            long temp = 0;
+            if (entryIndex(entry->d_name, "thermal_zone") >= 0 &&
+                readLong(thermal + "/" + entry->d_name + "/temp", temp)) {
+                reading.temp_mc = std::max(reading.temp_mc, static_cast<int>(temp));
+            }
+        }
+        closedir(dir);
+    }
+
+    std::string cpus = root + "/devices/system/cpu";
+    if (DIR* dir = opendir(cpus.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            int cpu = entryIndex(entry->d_name, "cpu");
+            std::string cpufreq = cpus + "/" + entry->d_name + "/cpufreq/";
+            long cur = 0;
+            long max = 0;
+            if (cpu < 0 || !readLong(cpufreq + "scaling_cur_freq", cur) ||
+                !readLong(cpufreq + "scaling_max_freq", max)) {
+                continue;
+            }
+            if (reading.cur_freq_khz == 0 || cur < reading.cur_freq_khz) {
+                reading.cur_freq_khz = static_cast<int>(cur);
+            }
+
+            // The thermal framework caps a hot CPU by lowering its policy
+            // maximum below the one it started with
+            if (max_freq_khz.size() <= static_cast<size_t>(cpu)) {
+                max_freq_khz.resize(cpu + 1, 0);
+            }
+            if (max_freq_khz[cpu] == 0) {
+                max_freq_khz[cpu] = static_cast<int>(max);
+            }
+            if (max < max_freq_khz[cpu]) {
+                reading.throttled = true;
+            }
+        }
+        closedir(dir);
+    }
+
+    // The Raspberry Pi firmware throttles behind cpufreq's back
+    long flags = 0;
+    if (readLong(root + "/devices/platform/soc/soc:firmware/get_throttled", flags, 16) &&
+        (static_cast<unsigned long>(flags) & THROTTLED_NOW)) {
+        reading.throttled = true;
+    }
+    return reading;
+}
+
+} // namespace sentinel
\ No newline at end of file
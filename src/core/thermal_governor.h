@@ -0,0 +1,109 @@
+#ifndef SENTINEL_THERMAL_GOVERNOR_H
+#define SENTINEL_THERMAL_GOVERNOR_H
+
+#include "core/sentinel_core.h"
+#include "utils/executor.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <string>
+#include <vector>
+
+namespace sentinel {
+
+// One step of the vision quality ladder
+struct VisionQuality {
+    int fps;
+    int tile_grid;                   // Tiles per side (1 = whole frame)
+    bool lite_model;                 // vision.lite_model_path instead of the full model
+    int threads;                     // TFLite threads
+};
+
+struct ThermalReading {
+    int temp_mc = INT_MIN;           // Hottest thermal zone (millidegrees C), INT_MIN if none
+    int cur_freq_khz = 0;            // Slowest CPU's current frequency, 0 if unknown
+    bool throttled = false;          // cpufreq capped below its initial maximum, or
+                                     // firmware throttling (Raspberry Pi)
+};
+
+// Steps vision quality down and back up to hold a latency and temperature
+// target. The ladder runs from the configured quality (level 0) through
+// fewer tiles, the lite model, lower frame rates and finally fewer
+// threads, within the governor's bounds.
+//
+// Temperature and CPU frequency are read from sysfs on an executor timer,
+// so the detection loop never does file I/O for it. The loop reports each
+// frame's inference time and calls update(), which decides on the
+// published readings: step down when hot, throttled or slower than the
+// target; step up only when comfortably below both (hysteresis) and after
+// a longer dwell. Latency alone steps to lighter frames, and to a lower
+// frame rate only while frames take longer than the frame interval; it
+// never sheds threads, since that would make inference slower still.
+class ThermalGovernor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // lite_model: a lite model is loaded and may be stepped down to
+    ThermalGovernor(const GovernorConfig& config, const VisionQuality& best, bool lite_model);
+    ~ThermalGovernor();
+
+    // Start/stop sysfs polling
+    void start();
+    void stop();
+
+    // New bounds or best quality; keeps the current level where possible
+    void applyConfig(const GovernorConfig& config, const VisionQuality& best, bool lite_model);
+
+    // Inference time of one frame (all tiles), from the detection loop
+    void recordFrame(float latency_ms);
+
+    // Re-evaluate if a poll interval has passed. Returns true if the
+    // quality changed; the caller then applies quality().
+    bool update(Clock::time_point now);
+
+    const VisionQuality& quality() const { return ladder_[level_]; }
+    size_t level() const { return level_; }
+    size_t levels() const { return ladder_.size(); }
+    ThermalReading reading() const;
+
+    // Read temperature and CPU frequency under root (normally "/sys"):
+    //   class/thermal/thermal_zone*/temp                     millidegrees
+    //   devices/system/cpu/cpu*/cpufreq/scaling_cur_freq     kHz
+    //   devices/system/cpu/cpu*/cpufreq/scaling_max_freq     kHz
+    //   devices/platform/soc/soc:firmware/get_throttled      hex, optional
+    // max_freq_khz holds each CPU's scaling_max_freq from the first read,
+    // so a cap set by the administrator does not count as throttling.
+    static ThermalReading readSysfs(const std::string& root, std::vector<int>& max_freq_khz);
+
+private:
+    void buildLadder(const VisionQuality& best);
+    void poll();
+
+    GovernorConfig config_;
+    bool lite_model_;
+    std::vector<VisionQuality> ladder_;
+    size_t level_;
+    Clock::time_point last_change_;
+    Clock::time_point last_update_;
+
+    // A step up reversed within step_up_sec doubles the next step-up dwell
+    int up_backoff_;
+    bool last_step_up_;
+
+    // Frame latencies since the last decision (detection loop only)
+    double latency_sum_ms_;
+    int latency_frames_;
+
+    // Published by poll() on an executor worker. The poll side's members
+    // are only written while the timer is cancelled, never from config_.
+    std::string poll_root_;                  // Poll side only
+    std::vector<int> max_freq_khz_;          // Poll side only
+    std::atomic<int> temp_mc_;
+    std::atomic<int> cur_freq_khz_;
+    std::atomic<bool> throttled_;
+    Executor::TimerId timer_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_THERMAL_GOVERNOR_H
\ No newline at end of file
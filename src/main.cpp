@@ -0,0 +1,119 @@
+#include "core/sentinel_core.h"
+#include "core/config_manager.h"
+#include "core/config_store.h"
+#include "core/config_watcher.h"
+#include "core/pipeline_benchmark.h"
+#include "utils/logger.h"
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    using namespace sentinel;
+    
+    Logger::info("Sentinel Edge-AI Wildfire Detection System v1.0");
+    Logger::info("================================================");
+    
+    // Default configuration
+    Config config;
+    config.debug_mode = false;
+    config.i2c_address = 0x48;
+    config.model_path = "../models/smoke_detection.tflite";
+    config.node_id = 1;
+    config.consensus_threshold = 0.6f;
+    config.consensus_timeout_sec = 5;
+    config.alert_duration_sec = 60;
+    
+    // Parse command line arguments
+    bool debug_flag = false;
+    bool watch_config = true;
+    bool realtime_flag = false;
+    bool benchmark = false;
+    BenchmarkOptions benchmark_options;
+    std::string config_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--debug") {
+            debug_flag = true;
+        } else if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+            ConfigManager config_manager;
+            if (!config_manager.loadFromFile(config_path)) {
+                Logger::error("Failed to load configuration: " + config_manager.getLastError());
+                return 1;
+            }
+            config = config_manager.getConfig();
+        } else if (arg == "--no-watch") {
+            watch_config = false;
+        } else if (arg == "--realtime") {
+            realtime_flag = true;
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            benchmark = true;
+            benchmark_options.video_path = argv[++i];
+        } else if (arg == "--peers" && i + 1 < argc) {
+            benchmark_options.peers = std::atoi(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            benchmark_options.duration_sec = std::atoi(argv[++i]);
+        } else if (arg == "--fps" && i + 1 < argc) {
+            benchmark_options.fps = std::atoi(argv[++i]);
+        } else if (arg == "--profile-ops" && i + 1 < argc) {
+            benchmark_options.profile_invokes = std::atoi(argv[++i]);
+        }
+    }
+    
+    if (debug_flag) {
+        config.debug_mode = true;
+        config.lora_config.debug_mode = true;
+    }
+    if (realtime_flag) {
+        config.realtime_config.enabled = true;
+    }
+    
+    Logger::setLevel(config.debug_mode ? LogLevel::DEBUG : Logger::levelFromString(config.log_level));
+    
+    // Scripted end-to-end run against recorded and simulated inputs;
+    // only warnings are logged unless --debug is given
+    if (benchmark) {
+        if (!debug_flag) {
+            Logger::setLevel(LogLevel::WARN);
+        }
+        PipelineBenchmark pipeline_benchmark(config, benchmark_options);
+        return pipeline_benchmark.run() ? 0 : 1;
+    }
+    
+    Logger::setFile(config.log_file);
+    
+    // Initialize and run
+    SentinelCore core(config);
+    if (!config_path.empty()) {
+        core.setConfigPath(config_path);
+    }
+    
+    if (!core.initialize()) {
+        Logger::error("Failed to initialize Sentinel Core");
+        return 1;
+    }
+    
+    // Live reload: re-parse the config file on change and publish it as a
+    // new snapshot; the core applies it between loop iterations
+    std::unique_ptr<ConfigStore> config_store;
+    std::unique_ptr<ConfigWatcher> config_watcher;
+    if (!config_path.empty() && watch_config) {
+        config_store = std::make_unique<ConfigStore>(config);
+        config_watcher = std::make_unique<ConfigWatcher>(config_path, *config_store);
+        if (config_watcher->start()) {
+            core.setConfigStore(config_store.get());
+        } else {
+            Logger::warn("Live configuration reload disabled");
+        }
+    }
+    
+    core.run();
+    
+    if (config_watcher) {
+        config_watcher->stop();
+    }
+    core.setConfigStore(nullptr);
+    
+    return 0;
+}
\ No newline at end of file
@@ -1,7 +1,13 @@
 #include "network/lora_mesh.h"
+#include "utils/jitter_monitor.h"
 #include "utils/logger.h"
+#include "utils/memory_tracker.h"
+#include "utils/realtime.h"
+#include <pthread.h>
 #include <cstring>
 #include <algorithm>
+#include <array>
+#include <cmath>
 
 namespace sentinel {
 
@@ -9,12 +15,118 @@ namespace sentinel {
 constexpr uint8_t MSG_TYPE_HEARTBEAT = 0x01;
 constexpr uint8_t MSG_TYPE_DETECTION = 0x02;
 constexpr uint8_t MSG_TYPE_ACK = 0x03;
+constexpr uint8_t MSG_TYPE_SOLICIT = 0x04;
+constexpr uint8_t MSG_TYPE_DIGEST = 0x05;
+constexpr uint8_t MSG_TYPE_UPSTREAM = 0x06;
+constexpr uint8_t MSG_TYPE_UPDATE_ADVERT = MeshTransfer::FRAME_ADVERT;
+constexpr uint8_t MSG_TYPE_UPDATE_REQUEST = MeshTransfer::FRAME_REQUEST;
+constexpr uint8_t MSG_TYPE_UPDATE_DATA = MeshTransfer::FRAME_DATA;
+
+// Header and checksum around the payload
+constexpr size_t FRAME_OVERHEAD = 5;
+
+// Events handed to the callbacks per clock read in processMessages()
+constexpr size_t MESH_EVENT_BATCH = 64;
+
+// Heartbeat payload: flags, then the sender's silence bound in seconds
+// and its cost to a gateway (both little-endian). Older nodes send an
+// empty heartbeat.
+constexpr uint8_t HEARTBEAT_PAYLOAD_LEN = 5;
+constexpr uint8_t HEARTBEAT_DETECTING = 0x01;
+
+// Solicitations and digests start with the same five bytes. A
+// solicitation goes on with its reply slot count and the ids it already
+// knows, a digest with the ids its sender heard most recently.
+constexpr size_t SOLICIT_SLOTS_OFFSET = HEARTBEAT_PAYLOAD_LEN;
+constexpr size_t SOLICIT_IDS_OFFSET = SOLICIT_SLOTS_OFFSET + 1;
+
+// Reply slot margin beyond a digest's time on air
+constexpr std::chrono::milliseconds JOIN_SLOT_GUARD(20);
+
+// Trickle timer poll period
+constexpr std::chrono::milliseconds HEARTBEAT_TICK(250);
+
+// Upstream payload: origin, sequence number, hops left, the sender's
+// cost (little-endian), then the data. The top bit of the hops byte marks
+// a detour: the next hop is not the sender's parent. An acknowledgement
+// names the origin and sequence number it answers.
+constexpr size_t UPSTREAM_HEADER_LEN = 5;
+constexpr uint8_t UPSTREAM_DETOUR = 0x80;
+constexpr size_t ACK_PAYLOAD_LEN = 2;
+
+// Beyond the frames' time on air, for turnaround and processing
+constexpr std::chrono::milliseconds ACK_GUARD(100);
+
+// Update request timeout in data frame gaps, beyond an acknowledgement
+// timeout: a server answering other requests too still gets through
+constexpr int UPDATE_TIMEOUT_GAPS = 3;
+
+// Demodulation floor at SF7 and per step above, dB (SX127x datasheet)
+constexpr float SNR_FLOOR_SF7 = -7.5f;
+constexpr float SNR_FLOOR_STEP = -2.5f;
+
+// Weight of a new SNR sample in the smoothed link margin
+constexpr float SNR_SMOOTHING = 0.25f;
 
 LoraMesh::LoraMesh(uint8_t node_id, const LoraConfig& config)
     : node_id_(node_id),
       config_(config),
       is_initialized_(false),
-      detection_callback_(nullptr) {
+      heartbeat_interval_sec_(config.heartbeat_interval_sec),
+      node_timeout_sec_(config.node_timeout_sec),
+      max_retries_(config.max_retries),
+      retry_delay_ms_(config.retry_delay_ms),
+      debug_mode_(config.debug_mode),
+      active_nodes_(&MemoryTracker::resource(MemorySubsystem::MESH)),
+      trickle_(node_id * 2654435761u),
+      announce_(false),
+      detecting_(false),
+      silence_bound_sec_(0),
+      joining_(false),
+      join_round_(0),
+      join_known_(0),
+      join_timer_(0),
+      reply_timer_(0),
+      reply_pending_(false),
+      reply_rng_(node_id + 1u),
+      route_cost_(ROUTE_COST_NONE),
+      parent_(-1),
+      seen_upstream_(),
+      seen_next_(0),
+      upstream_seq_(0),
+      route_rng_(node_id * 40503u + 1u),
+      upstream_originated_(0),
+      upstream_forwarded_(0),
+      upstream_delivered_(0),
+      upstream_dropped_(0),
+      route_fallbacks_(0),
+      parent_changes_(0),
+      route_tasks_(0),
+      transfer_(node_id * 2246822519u + 1u),
+      update_duty_percent_(updatesEnabled(config) ? config.update_duty_percent : 0),
+      transfer_timer_(0),
+      frames_sent_(0),
+      heartbeats_sent_(0),
+      solicitations_sent_(0),
+      digests_sent_(0),
+      update_frames_sent_(0),
+      update_airtime_us_(0),
+      airtime_us_(0),
+      heartbeat_timer_(0),
+      cleanup_timer_(0),
+      detection_callback_(nullptr),
+      upstream_callback_(nullptr),
+      update_callback_(nullptr),
+      frames_rejected_(0),
+      events_queued_(0),
+      events_dropped_(0),
+      events_handled_(0),
+      event_batches_(0),
+      max_event_batch_(0),
+      drops_reported_(0),
+      spi_fd_(-1),
+      last_rssi_(0),
+      last_snr_(0.0f) {
 }
 
 LoraMesh::~LoraMesh() {
@@ -37,15 +149,184 @@ bool LoraMesh::initialize() {
         return false;
     }
     
+    if (!config_.capture_file.empty()) {
+        startCapture(config_.capture_file);
+    }
+    
     // Start network threads
-    receive_thread_ = std::thread(&LoraMesh::receiveLoop, this);
-    heartbeat_thread_ = std::thread(&LoraMesh::heartbeatLoop, this);
+    startThreads();
     
-    is_initialized_ = true;
     Logger::info("LoRa mesh network initialized successfully");
     return true;
 }
 
+void LoraMesh::startThreads() {
+    // Set before spawning so the loops do not exit immediately
+    is_initialized_ = true;
+    receive_thread_ = std::thread(&LoraMesh::receiveLoop, this);
+    
+    // Ask the neighbours for their tables (join handshake), or just
+    // announce ourselves with a heartbeat. Heartbeats then follow the
+    // Trickle timer; cleanup runs every shortest interval.
+    int join_slots;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        configureTrickle(config_);
+        join_started_ = std::chrono::steady_clock::now();
+        updateRoute(join_started_);
+        join_round_ = 0;
+        join_known_ = active_nodes_.size();
+        join_candidates_.reset();
+        join_slots = config_.join_slots;
+    }
+    if (join_slots > 0) {
+        joining_ = true;
+        auto round = sendSolicitation(join_slots);
+        join_timer_ = Executor::schedule(round, round, [this]() { joinTick(); },
+                                         TaskPriority::HIGH);
+    } else {
+        announce_ = true;
+    }
+    auto period = std::chrono::seconds(heartbeat_interval_sec_.load());
+    heartbeat_timer_ = Executor::schedule(std::chrono::seconds(0), HEARTBEAT_TICK,
+                                          [this]() { heartbeatTick(); },
+                                          TaskPriority::HIGH, JitterTask::HEARTBEAT);
+    cleanup_timer_ = Executor::schedule(period, period, [this]() { cleanupStaleNodes(); },
+                                        TaskPriority::LOW, JitterTask::NODE_CLEANUP);
+    
+    // Updates are background work: low priority, paced by their duty share
+    {
+        std::lock_guard<std::mutex> lock(transfer_mutex_);
+        configureTransfer(config_);
+    }
+    transfer_timer_ = Executor::schedule(HEARTBEAT_TICK, HEARTBEAT_TICK,
+                                         [this]() { transferTick(); }, TaskPriority::LOW);
+}
+
+void LoraMesh::stopThreads() {
+    is_initialized_ = false;
+    
+    if (receive_thread_.joinable()) {
+        receive_thread_.join();
+    }
+    
+    // Waits for a heartbeat in progress
+    Executor::cancel(heartbeat_timer_);
+    Executor::cancel(cleanup_timer_);
+    Executor::cancel(join_timer_);
+    Executor::cancel(reply_timer_);
+    Executor::cancel(transfer_timer_);
+    heartbeat_timer_ = 0;
+    cleanup_timer_ = 0;
+    join_timer_ = 0;
+    reply_timer_ = 0;
+    transfer_timer_ = 0;
+    joining_ = false;
+    reply_pending_ = false;
+    
+    // Posted routing tasks hold this; a stopped executor has dropped the
+    // ones it had queued, and they never run
+    while (route_tasks_.load() > 0 && Executor::running()) {
+        std::this_thread::yield();
+    }
+    route_tasks_ = 0;
+    
+    // Queued upstream messages are lost; their origins retry
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    for (auto& entry : upstream_) {
+        if (entry.active) {
+            entry.active = false;
+            upstream_dropped_++;
+        }
+    }
+}
+
+void LoraMesh::applyConfig(const LoraConfig& config) {
+    // Update adverts start at the shortest heartbeat interval
+    bool transfer_changed = config.update_duty_percent != config_.update_duty_percent ||
+                            config.update_key != config_.update_key ||
+                            config.update_advert_max_sec != config_.update_advert_max_sec ||
+                            config.heartbeat_interval_sec != heartbeat_interval_sec_;
+    if (config.heartbeat_interval_sec != heartbeat_interval_sec_ ||
+        config.heartbeat_max_interval_sec != config_.heartbeat_max_interval_sec ||
+        config.heartbeat_redundancy != config_.heartbeat_redundancy) {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        config_.heartbeat_interval_sec = config.heartbeat_interval_sec;
+        config_.heartbeat_max_interval_sec = config.heartbeat_max_interval_sec;
+        config_.heartbeat_redundancy = config.heartbeat_redundancy;
+        configureTrickle(config_);
+    }
+    heartbeat_interval_sec_ = config.heartbeat_interval_sec;
+    Executor::reschedule(cleanup_timer_, std::chrono::seconds(config.heartbeat_interval_sec));
+    node_timeout_sec_ = config.node_timeout_sec;
+    max_retries_ = config.max_retries;
+    retry_delay_ms_ = config.retry_delay_ms;
+    debug_mode_ = config.debug_mode;
+    
+    if (config.gateway != config_.gateway) {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        config_.gateway = config.gateway;
+        updateRoute(std::chrono::steady_clock::now());
+    }
+    
+    if (transfer_changed) {
+        std::lock_guard<std::mutex> lock(transfer_mutex_);
+        config_.update_duty_percent = config.update_duty_percent;
+        config_.update_advert_max_sec = config.update_advert_max_sec;
+        config_.update_key = config.update_key;
+        configureTransfer(config_);
+    }
+    update_duty_percent_ = updatesEnabled(config) ? config.update_duty_percent : 0;
+    
+    if (config.capture_file != capture_path_) {
+        if (config.capture_file.empty()) {
+            stopCapture();
+        } else {
+            startCapture(config.capture_file);
+        }
+    }
+}
+
+bool LoraMesh::startCapture(const std::string& path) {
+    // Reopening truncates, so a new path starts a new capture
+    capture_path_ = path;
+    return capture_.open(path, node_id_);
+}
+
+void LoraMesh::stopCapture() {
+    capture_.close();
+    capture_path_.clear();
+}
+
+bool LoraMesh::requiresRadioRestart(const LoraConfig& config) const {
+    return config.frequency != config_.frequency ||
+           config.bandwidth != config_.bandwidth ||
+           config.spreading_factor != config_.spreading_factor ||
+           config.coding_rate != config_.coding_rate ||
+           config.tx_power != config_.tx_power ||
+           config.sync_word != config_.sync_word ||
+           config.preamble_length != config_.preamble_length ||
+           config.crc_enabled != config_.crc_enabled;
+}
+
+bool LoraMesh::restartRadio(const LoraConfig& config) {
+    Logger::info("Restarting LoRa radio with new parameters");
+    
+    stopThreads();
+    
+    // Radio parameters are only read while the threads are stopped
+    config_ = config;
+    applyConfig(config);
+    
+    if (!configureLoRa()) {
+        Logger::error("Failed to reconfigure LoRa module");
+        return false;
+    }
+    
+    startThreads();
+    return true;
+}
+
 bool LoraMesh::initializeSPI() {
     // TODO: Implement actual SPI initialization for your hardware
     // This is a placeholder that would use wiringPi or similar library
@@ -75,6 +356,13 @@ bool LoraMesh::configureLoRa() {
 }
 
 void LoraMesh::broadcastDetection(bool detected) {
+    // A detection is news: heartbeats back to the shortest interval
+    detecting_ = detected;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        trickle_.reset(std::chrono::steady_clock::now());
+    }
+    
     MeshMessage msg;
     msg.type = MSG_TYPE_DETECTION;
     msg.source_id = node_id_;
@@ -85,7 +373,7 @@ void LoraMesh::broadcastDetection(bool detected) {
     
     sendMessage(msg);
     
-    Logger::info("Broadcast detection: " + std::string(detected ? "TRUE" : "FALSE"));
+    Logger::logf(LogLevel::INFO, "Broadcast detection: %s", detected ? "TRUE" : "FALSE");
 }
 
 void LoraMesh::sendMessage(const MeshMessage& msg) {
@@ -95,32 +383,45 @@ void LoraMesh::sendMessage(const MeshMessage& msg) {
     uint8_t buffer[256];
     size_t len = serializeMessage(msg, buffer);
     
-    // Send via LoRa
-    // TODO: Implement actual LoRa transmission
-    // This would use the SPI interface to send data
+    // Send via LoRa, retrying up to mesh.max_retries times
+    bool sent = transmitData(buffer, len);
+    int attempts = 1;
+    const int max_retries = max_retries_;
+    for (int attempt = 0; !sent && attempt < max_retries; attempt++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(retry_delay_ms_.load()));
+        sent = transmitData(buffer, len);
+        attempts++;
+    }
+    frames_sent_.fetch_add(attempts, std::memory_order_relaxed);
+    airtime_us_.fetch_add(static_cast<uint64_t>(attempts * airtimeMs(config_, len) * 1000.0),
+                          std::memory_order_relaxed);
+    
+    if (!sent) {
+        Logger::logf(LogLevel::ERROR, "Failed to send message type %u after %d attempts",
+                     msg.type, max_retries + 1);
+        return;
+    }
     
-    if (config_.debug_mode) {
-        Logger::debug("Sent message type " + std::to_string(msg.type) +
-                     " from node " + std::to_string(msg.source_id) +
-                     " to node " + std::to_string(msg.destination_id));
+    if (debug_mode_) {
+        Logger::logf(LogLevel::DEBUG, "Sent message type %u from node %u to node %u",
+                     msg.type, msg.source_id, msg.destination_id);
     }
 }
 
 void LoraMesh::receiveLoop() {
+    pthread_setname_np(pthread_self(), "mesh-rx");
+    Realtime::applyRole(ThreadRole::RADIO);
     Logger::info("Starting receive loop");
     
     while (is_initialized_) {
         // TODO: Implement actual LoRa receive
         // This would poll the LoRa module via SPI
         
-        // Check if data is available
+        // Drain everything pending before sleeping
         uint8_t buffer[256];
-        int len = receiveData(buffer, sizeof(buffer));
-        
-        if (len > 0) {
-            // Deserialize and process message
-            MeshMessage msg = deserializeMessage(buffer, len);
-            processMessage(msg);
+        int len;
+        while (is_initialized_ && (len = receiveData(buffer, sizeof(buffer))) > 0) {
+            receiveFrame(buffer, len, last_rssi_, last_snr_);
         }
         
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -129,89 +430,905 @@ void LoraMesh::receiveLoop() {
     Logger::info("Receive loop terminated");
 }
 
-void LoraMesh::heartbeatLoop() {
-    Logger::info("Starting heartbeat loop");
+void LoraMesh::receiveFrame(const uint8_t* buffer, size_t len, int rssi, float snr) {
+    capture_.record(CaptureDirection::RX, buffer, len, rssi, snr);
     
-    while (is_initialized_) {
-        // Send periodic heartbeat
-        MeshMessage msg;
-        msg.type = MSG_TYPE_HEARTBEAT;
-        msg.source_id = node_id_;
-        msg.destination_id = 0xFF; // Broadcast
-        msg.payload_len = 0;
-        msg.timestamp = std::chrono::system_clock::now();
-        
-        sendMessage(msg);
-        
-        // Clean up stale nodes
-        cleanupStaleNodes();
-        
-        // Wait for next heartbeat interval
-        std::this_thread::sleep_for(std::chrono::seconds(config_.heartbeat_interval_sec));
+    // Noise and collisions: counted, not logged frame by frame
+    MeshMessage msg;
+    if (!deserializeMessage(buffer, len, msg)) {
+        frames_rejected_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    processMessage(msg, rssi, snr);
+}
+
+void LoraMesh::heartbeatTick() {
+    TrickleTimer::Action action;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        action = trickle_.poll(now);
+        // Detecting: stay at the shortest interval, peers expire the flag
+        // after node_timeout_sec without a heartbeat
+        if (detecting_) {
+            trickle_.reset(now);
+        }
+    }
+    if (announce_.exchange(false)) {
+        action = TrickleTimer::Action::TRANSMIT;
+    }
+    
+    if (action == TrickleTimer::Action::TRANSMIT) {
+        sendHeartbeat();
+    } else if (action == TrickleTimer::Action::SUPPRESS && debug_mode_) {
+        Logger::debug("Heartbeat suppressed - neighbours consistent");
     }
     
-    Logger::info("Heartbeat loop terminated");
+    // Upstream retries and fallbacks come due on this tick too
+    routeTick();
 }
 
-void LoraMesh::processMessage(const MeshMessage& msg) {
+void LoraMesh::sendHeartbeat() {
+    // Keep the radio thread's priority while on the air
+    RealtimeRoleScope role(ThreadRole::RADIO);
+    
+    MeshMessage msg;
+    msg.type = MSG_TYPE_HEARTBEAT;
+    msg.source_id = node_id_;
+    msg.destination_id = 0xFF; // Broadcast
+    fillAnnouncement(msg);
+    msg.payload_len = HEARTBEAT_PAYLOAD_LEN;
+    msg.timestamp = std::chrono::system_clock::now();
+    
+    sendMessage(msg);
+    heartbeats_sent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoraMesh::fillAnnouncement(MeshMessage& msg) const {
+    uint16_t bound = silence_bound_sec_;
+    uint16_t cost = route_cost_;
+    msg.payload[0] = detecting_ ? HEARTBEAT_DETECTING : 0;
+    msg.payload[1] = static_cast<uint8_t>(bound & 0xFF);
+    msg.payload[2] = static_cast<uint8_t>(bound >> 8);
+    msg.payload[3] = static_cast<uint8_t>(cost & 0xFF);
+    msg.payload[4] = static_cast<uint8_t>(cost >> 8);
+}
+
+void LoraMesh::joinTick() {
+    // A round just ended. Peers named in digests that we have not heard
+    // ourselves may be neighbours whose replies collided: ask again.
+    int slots;
+    int round;
+    size_t peers;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        join_round_++;
+        round = join_round_;
+        peers = active_nodes_.size();
+        size_t missing = 0;
+        for (size_t id = 0; id < join_candidates_.size(); id++) {
+            if (join_candidates_[id] && id != node_id_ && active_nodes_.count(id) == 0) {
+                missing++;
+            }
+        }
+        slots = joinNextSlots(round, missing, peers - std::min(peers, join_known_),
+                              config_.join_slots);
+        join_known_ = peers;
+    }
+    
+    if (slots > 0 && is_initialized_) {
+        Executor::reschedule(join_timer_, sendSolicitation(slots));
+        return;
+    }
+    
+    joining_ = false;
+    Executor::cancel(join_timer_);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - join_started_);
+    Logger::logf(LogLevel::INFO, "Joined mesh: %zu peers after %d round(s), %lld ms",
+                 peers, round, static_cast<long long>(elapsed.count()));
+}
+
+std::chrono::microseconds LoraMesh::sendSolicitation(int slots) {
+    RealtimeRoleScope role(ThreadRole::RADIO);
+    
+    MeshMessage msg;
+    msg.type = MSG_TYPE_SOLICIT;
+    msg.source_id = node_id_;
+    msg.destination_id = 0xFF; // Broadcast
+    fillAnnouncement(msg);
+    msg.payload[SOLICIT_SLOTS_OFFSET] = static_cast<uint8_t>(std::min(slots, 255));
+    
+    // Peers already known stay quiet. Any that do not fit reply anyway.
+    size_t len = SOLICIT_IDS_OFFSET;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        for (const auto& pair : active_nodes_) {
+            if (len == MAX_PAYLOAD_SIZE) {
+                break;
+            }
+            msg.payload[len++] = pair.first;
+        }
+    }
+    msg.payload_len = static_cast<uint8_t>(len);
+    msg.timestamp = std::chrono::system_clock::now();
+    
+    sendMessage(msg);
+    solicitations_sent_.fetch_add(1, std::memory_order_relaxed);
+    
+    // Replies start once the solicitation is received; one spare slot
+    // lets the last one finish
+    auto on_air = std::chrono::microseconds(
+        static_cast<int64_t>(airtimeMs(config_, len + FRAME_OVERHEAD) * 1000.0));
+    return on_air + joinSlot(config_) * (slots + 1);
+}
+
+void LoraMesh::sendDigest(uint8_t solicitor) {
+    RealtimeRoleScope role(ThreadRole::RADIO);
+    
+    MeshMessage msg;
+    msg.type = MSG_TYPE_DIGEST;
+    msg.source_id = node_id_;
+    msg.destination_id = solicitor;
+    fillAnnouncement(msg);
+    
+    // The most recently heard peers are the likeliest to be alive and
+    // within the solicitor's range too
+    std::array<std::pair<std::chrono::steady_clock::time_point, uint8_t>, 256> peers;
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        for (const auto& pair : active_nodes_) {
+            if (pair.first != solicitor) {
+                peers[count++] = {pair.second.last_seen, pair.first};
+            }
+        }
+    }
+    size_t entries = std::min(count, JOIN_DIGEST_ENTRIES);
+    std::partial_sort(peers.begin(), peers.begin() + entries, peers.begin() + count,
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < entries; i++) {
+        msg.payload[HEARTBEAT_PAYLOAD_LEN + i] = peers[i].second;
+    }
+    msg.payload_len = static_cast<uint8_t>(HEARTBEAT_PAYLOAD_LEN + entries);
+    msg.timestamp = std::chrono::system_clock::now();
+    
+    sendMessage(msg);
+    digests_sent_.fetch_add(1, std::memory_order_relaxed);
+    reply_pending_ = false;
+}
+
+std::chrono::microseconds LoraMesh::joinSlot(const LoraConfig& config) {
+    size_t digest_len = FRAME_OVERHEAD + HEARTBEAT_PAYLOAD_LEN + JOIN_DIGEST_ENTRIES;
+    auto on_air = std::chrono::microseconds(
+        static_cast<int64_t>(airtimeMs(config, digest_len) * 1000.0));
+    return on_air + JOIN_SLOT_GUARD;
+}
+
+int LoraMesh::joinNextSlots(int rounds_done, size_t missing, size_t found, int first_slots) {
+    if (missing == 0 || rounds_done >= JOIN_MAX_ROUNDS || (rounds_done > 1 && found == 0)) {
+        return 0;
+    }
+    size_t most = static_cast<size_t>(std::max(first_slots, JOIN_MIN_SLOTS));
+    return static_cast<int>(std::clamp<size_t>(2 * missing, JOIN_MIN_SLOTS, most));
+}
+
+void LoraMesh::configureTrickle(const LoraConfig& config) {
+    trickle_.configure(std::chrono::seconds(config.heartbeat_interval_sec),
+                       std::chrono::seconds(config.heartbeat_max_interval_sec),
+                       config.heartbeat_redundancy, MAX_SUPPRESSED_HEARTBEATS);
+    trickle_.start(std::chrono::steady_clock::now());
+    
+    auto bound = std::chrono::ceil<std::chrono::seconds>(trickle_.silenceBound()).count();
+    silence_bound_sec_ = static_cast<uint16_t>(std::min<int64_t>(bound, UINT16_MAX));
+}
+
+std::chrono::seconds LoraMesh::peerTimeout(int node_timeout_sec, int heartbeat_interval_sec,
+                                           uint16_t silence_bound_sec) {
+    int64_t scaled = static_cast<int64_t>(silence_bound_sec) * node_timeout_sec /
+                     std::max(heartbeat_interval_sec, 1);
+    int64_t capped = std::min<int64_t>(scaled, 2 * int64_t(silence_bound_sec) + node_timeout_sec);
+    return std::chrono::seconds(std::max<int64_t>(node_timeout_sec, capped));
+}
+
+double LoraMesh::airtimeMs(const LoraConfig& config, size_t frame_len) {
+    int sf = config.spreading_factor;
+    double symbol_ms = std::ldexp(1.0, sf) / config.bandwidth;
+    int low_rate = symbol_ms > 16.0 ? 1 : 0;
+    double bits = 8.0 * frame_len - 4.0 * sf + 28.0 + (config.crc_enabled ? 16.0 : 0.0);
+    double blocks = std::ceil(bits / (4.0 * (sf - 2 * low_rate)));
+    double payload_symbols = 8.0 + std::max(blocks * config.coding_rate, 0.0);
+    return (config.preamble_length + 4.25 + payload_symbols) * symbol_ms;
+}
+
+uint16_t LoraMesh::linkCost(float snr_margin) {
+    int steps = static_cast<int>(std::ceil((10.0f - snr_margin) / 5.0f));
+    return static_cast<uint16_t>(ROUTE_HOP_COST * (1 + std::clamp(steps, 0, 3)));
+}
+
+uint16_t LoraMesh::linkCost(float snr_margin, uint16_t current) {
+    if (linkCost(snr_margin + LINK_HYSTERESIS_DB) <= current &&
+        current <= linkCost(snr_margin - LINK_HYSTERESIS_DB)) {
+        return current;
+    }
+    return linkCost(snr_margin);
+}
+
+float LoraMesh::snrMargin(const LoraConfig& config, float snr) {
+    return snr - (SNR_FLOOR_SF7 + SNR_FLOOR_STEP * (config.spreading_factor - 7));
+}
+
+bool LoraMesh::routeCostChanged(uint16_t before, uint16_t after) {
+    if ((before == ROUTE_COST_NONE) != (after == ROUTE_COST_NONE)) {
+        return true;
+    }
+    return std::abs(static_cast<int>(before) - static_cast<int>(after)) >= ROUTE_RESET_COST;
+}
+
+std::chrono::microseconds LoraMesh::ackTimeout(const LoraConfig& config) {
+    double upstream_ms = airtimeMs(config, FRAME_OVERHEAD + UPSTREAM_HEADER_LEN + UPSTREAM_MAX_DATA);
+    double ack_ms = airtimeMs(config, FRAME_OVERHEAD + ACK_PAYLOAD_LEN);
+    return std::chrono::microseconds(static_cast<int64_t>((2.0 * upstream_ms + ack_ms) * 1000.0)) +
+           ACK_GUARD;
+}
+
+std::chrono::microseconds LoraMesh::updatePacketGap(const LoraConfig& config) {
+    double data_ms = airtimeMs(config, FRAME_OVERHEAD + MeshTransfer::MAX_FRAME_PAYLOAD);
+    double share = std::max(config.update_duty_percent, 1) / 100.0;
+    return std::chrono::microseconds(static_cast<int64_t>(data_ms / share * 1000.0));
+}
+
+std::chrono::microseconds LoraMesh::updateRequestTimeout(const LoraConfig& config) {
+    return updatePacketGap(config) * UPDATE_TIMEOUT_GAPS + ackTimeout(config);
+}
+
+bool LoraMesh::updatesEnabled(const LoraConfig& config) {
+    MeshTransfer::Key key;
+    return config.update_duty_percent > 0 && MeshTransfer::parseKey(config.update_key, key);
+}
+
+void LoraMesh::updateRoute(std::chrono::steady_clock::time_point now) {
+    int parent = -1;
+    uint32_t cost = config_.gateway ? 0 : ROUTE_COST_NONE;
+    if (!config_.gateway) {
+        // Cheapest path, but keep the current parent unless the best beats
+        // it by the threshold
+        uint32_t current = ROUTE_COST_NONE;
+        for (const auto& pair : active_nodes_) {
+            const NodeInfo& node = pair.second;
+            if (node.route_cost == ROUTE_COST_NONE || node.unreachable) {
+                continue;
+            }
+            uint32_t path = node.route_cost +
+                            (node.link_cost ? node.link_cost : ROUTE_HOP_COST);
+            if (pair.first == parent_) {
+                current = path;
+            }
+            if (path < cost) {
+                cost = path;
+                parent = pair.first;
+            }
+        }
+        if (current != ROUTE_COST_NONE && current <= cost + ROUTE_SWITCH_THRESHOLD) {
+            cost = current;
+            parent = parent_;
+        }
+        if (cost > ROUTE_MAX_COST) {
+            cost = ROUTE_COST_NONE;
+            parent = -1;
+        }
+    }
+    
+    if (parent != parent_) {
+        parent_changes_++;
+        if (debug_mode_) {
+            Logger::logf(LogLevel::DEBUG, "Route parent %d -> %d, cost %u", parent_, parent, cost);
+        }
+        parent_ = parent;
+    }
+    uint16_t before = route_cost_;
+    route_cost_ = static_cast<uint16_t>(cost);
+    if (routeCostChanged(before, route_cost_)) {
+        trickle_.reset(now);
+    }
+}
+
+int LoraMesh::nextHop(const std::bitset<256>& excluded) const {
+    if (parent_ >= 0 && !excluded[parent_]) {
+        return parent_;
+    }
+    int best = -1;
+    uint32_t best_cost = ROUTE_MAX_COST + 1;
+    for (const auto& pair : active_nodes_) {
+        const NodeInfo& node = pair.second;
+        if (node.route_cost == ROUTE_COST_NONE || node.unreachable || excluded[pair.first]) {
+            continue;
+        }
+        uint32_t path = node.route_cost +
+                        (node.link_cost ? node.link_cost : ROUTE_HOP_COST);
+        if (path < best_cost) {
+            best_cost = path;
+            best = pair.first;
+        }
+    }
+    return best;
+}
+
+bool LoraMesh::queueUpstream(uint8_t origin, uint8_t seq, int ttl, int prev_hop,
+                             const uint8_t* data, size_t len) {
+    for (auto& entry : upstream_) {
+        if (entry.active) {
+            continue;
+        }
+        entry.active = true;
+        entry.origin = origin;
+        entry.seq = seq;
+        entry.ttl = static_cast<uint8_t>(ttl);
+        entry.data_len = static_cast<uint8_t>(len);
+        std::memcpy(entry.data, data, len);
+        entry.next_hop = -1;
+        entry.attempts = 0;
+        entry.parents = 0;
+        entry.excluded.reset();
+        if (prev_hop >= 0) {
+            entry.excluded.set(prev_hop);
+        }
+        entry.due = std::chrono::steady_clock::now();
+        return true;
+    }
+    return false;
+}
+
+bool LoraMesh::seenUpstream(uint8_t origin, uint8_t seq) const {
+    uint32_t key = 0x10000u | (static_cast<uint32_t>(origin) << 8) | seq;
+    return std::find(seen_upstream_.begin(), seen_upstream_.end(), key) != seen_upstream_.end();
+}
+
+void LoraMesh::rememberUpstream(uint8_t origin, uint8_t seq) {
+    seen_upstream_[seen_next_] = 0x10000u | (static_cast<uint32_t>(origin) << 8) | seq;
+    seen_next_ = (seen_next_ + 1) % seen_upstream_.size();
+}
+
+bool LoraMesh::sendUpstream(const uint8_t* data, size_t len) {
+    if (len > UPSTREAM_MAX_DATA) {
+        return false;
+    }
+    
+    auto now = std::chrono::steady_clock::now();
+    bool gateway;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        gateway = config_.gateway;
+        if (gateway) {
+            upstream_delivered_++;
+        } else {
+            uint8_t seq = upstream_seq_;
+            if (route_cost_ == ROUTE_COST_NONE ||
+                !queueUpstream(node_id_, seq, ROUTE_MAX_HOPS, -1, data, len)) {
+                return false;
+            }
+            upstream_seq_++;
+            rememberUpstream(node_id_, seq);
+        }
+        upstream_originated_++;
+    }
+    
+    if (gateway) {
+        queueUpstreamEvent(node_id_, data, len, now);
+    } else {
+        postRouteTick();
+    }
+    return true;
+}
+
+void LoraMesh::routeTick() {
+    std::array<MeshMessage, ROUTE_QUEUE_SIZE> outgoing;
+    size_t count = 0;
+    size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        auto timeout = ackTimeout(config_);
+        for (auto& entry : upstream_) {
+            if (!entry.active || now < entry.due) {
+                continue;
+            }
+            
+            // The next hop never acknowledged: stop using it until we hear
+            // from it again, and fall back to the next cheapest neighbour
+            if (entry.next_hop >= 0 && entry.attempts >= ROUTE_ATTEMPTS) {
+                auto it = active_nodes_.find(static_cast<uint8_t>(entry.next_hop));
+                if (it != active_nodes_.end()) {
+                    it->second.unreachable = true;
+                }
+                entry.excluded.set(entry.next_hop);
+                entry.next_hop = -1;
+                route_fallbacks_++;
+                updateRoute(now);
+            }
+            if (entry.next_hop < 0) {
+                entry.next_hop = entry.parents < ROUTE_MAX_PARENTS ? nextHop(entry.excluded) : -1;
+                entry.attempts = 0;
+                entry.parents++;
+            }
+            if (entry.next_hop < 0) {
+                entry.active = false;
+                upstream_dropped_++;
+                dropped++;
+                continue;
+            }
+            
+            MeshMessage& msg = outgoing[count++];
+            uint16_t cost = route_cost_;
+            msg.type = MSG_TYPE_UPSTREAM;
+            msg.source_id = node_id_;
+            msg.destination_id = static_cast<uint8_t>(entry.next_hop);
+            msg.payload[0] = entry.origin;
+            msg.payload[1] = entry.seq;
+            msg.payload[2] = entry.ttl | (entry.next_hop != parent_ ? UPSTREAM_DETOUR : 0);
+            msg.payload[3] = static_cast<uint8_t>(cost & 0xFF);
+            msg.payload[4] = static_cast<uint8_t>(cost >> 8);
+            std::memcpy(msg.payload + UPSTREAM_HEADER_LEN, entry.data, entry.data_len);
+            msg.payload_len = static_cast<uint8_t>(UPSTREAM_HEADER_LEN + entry.data_len);
+            msg.timestamp = std::chrono::system_clock::now();
+            
+            // Retries wait a random extra half timeout, so two senders
+            // that collided once do not collide again
+            entry.attempts++;
+            entry.due = now + timeout +
+                        std::chrono::microseconds(route_rng_() % (timeout.count() / 2 + 1));
+        }
+    }
+    
+    if (dropped > 0) {
+        Logger::logf(LogLevel::INFO, "Dropped %zu upstream message(s) - no parent answering",
+                     dropped);
+    }
+    if (count > 0) {
+        RealtimeRoleScope role(ThreadRole::RADIO);
+        for (size_t i = 0; i < count; i++) {
+            sendMessage(outgoing[i]);
+        }
+    }
+}
+
+void LoraMesh::receiveUpstream(const MeshMessage& msg, std::chrono::steady_clock::time_point now) {
+    // Overheard on the way to someone else: only the node table cares
+    if (msg.destination_id != node_id_ || msg.payload_len < UPSTREAM_HEADER_LEN) {
+        return;
+    }
+    uint8_t origin = msg.payload[0];
+    uint8_t seq = msg.payload[1];
+    uint8_t ttl = msg.payload[2] & ~UPSTREAM_DETOUR;
+    bool detour = (msg.payload[2] & UPSTREAM_DETOUR) != 0;
+    uint16_t sender_cost = static_cast<uint16_t>(msg.payload[3] | (msg.payload[4] << 8));
+    const uint8_t* data = msg.payload + UPSTREAM_HEADER_LEN;
+    size_t len = std::min<size_t>(msg.payload_len - UPSTREAM_HEADER_LEN, UPSTREAM_MAX_DATA);
+    
+    // Acknowledge only what we take on, so the sender falls back while we
+    // have no route or no room. Duplicates are acknowledged again: our
+    // first acknowledgement may have been lost.
+    bool accepted = true;
+    bool deliver = false;
+    bool forward = false;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        if (seenUpstream(origin, seq)) {
+            // Already handled
+        } else if (config_.gateway) {
+            rememberUpstream(origin, seq);
+            upstream_delivered_++;
+            deliver = true;
+        } else if (ttl == 0) {
+            rememberUpstream(origin, seq);
+            upstream_dropped_++;
+        } else {
+            if (!detour && route_cost_ >= sender_cost) {
+                // The sender took us for its parent, but we are no closer
+                // than it is: tell the neighbourhood our cost soon. Detours
+                // after a fallback may go sideways on purpose.
+                trickle_.reset(now);
+            }
+            forward = route_cost_ != ROUTE_COST_NONE &&
+                      queueUpstream(origin, seq, ttl - 1, msg.source_id, data, len);
+            if (forward) {
+                rememberUpstream(origin, seq);
+            }
+            accepted = forward;
+        }
+    }
+    
+    if (accepted) {
+        postAck(msg.source_id, origin, seq);
+    }
+    if (deliver) {
+        queueUpstreamEvent(origin, data, len, now);
+    }
+    if (forward) {
+        postRouteTick();
+    }
+}
+
+bool LoraMesh::beginRouteTask() {
+    // Counted before the check, so stopThreads() either sees the task or
+    // the task sees the mesh stopping
+    route_tasks_.fetch_add(1);
+    if (!is_initialized_) {
+        route_tasks_.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+void LoraMesh::postRouteTick() {
+    if (beginRouteTask()) {
+        Executor::post([this]() {
+            routeTick();
+            route_tasks_.fetch_sub(1);
+        }, TaskPriority::HIGH);
+    }
+}
+
+void LoraMesh::postAck(uint8_t destination, uint8_t origin, uint8_t seq) {
+    if (!beginRouteTask()) {
+        return;
+    }
+    uint32_t ack = (static_cast<uint32_t>(destination) << 16) |
+                   (static_cast<uint32_t>(origin) << 8) | seq;
+    Executor::post([this, ack]() {
+        sendAck(static_cast<uint8_t>(ack >> 16), static_cast<uint8_t>(ack >> 8),
+                static_cast<uint8_t>(ack));
+        route_tasks_.fetch_sub(1);
+    }, TaskPriority::HIGH);
+}
+
+void LoraMesh::receiveAck(const MeshMessage& msg) {
+    if (msg.destination_id != node_id_ || msg.payload_len < ACK_PAYLOAD_LEN) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    for (auto& entry : upstream_) {
+        if (entry.active && entry.origin == msg.payload[0] && entry.seq == msg.payload[1] &&
+            entry.next_hop == msg.source_id) {
+            entry.active = false;
+            upstream_forwarded_++;
+            break;
+        }
+    }
+}
+
+void LoraMesh::sendAck(uint8_t destination, uint8_t origin, uint8_t seq) {
+    RealtimeRoleScope role(ThreadRole::RADIO);
+    
+    MeshMessage msg;
+    msg.type = MSG_TYPE_ACK;
+    msg.source_id = node_id_;
+    msg.destination_id = destination;
+    msg.payload[0] = origin;
+    msg.payload[1] = seq;
+    msg.payload_len = ACK_PAYLOAD_LEN;
+    msg.timestamp = std::chrono::system_clock::now();
+    
+    sendMessage(msg);
+}
+
+void LoraMesh::queueUpstreamEvent(uint8_t origin, const uint8_t* data, size_t len,
+                                  std::chrono::steady_clock::time_point now) {
+    MeshEvent event;
+    event.type = MeshEventType::UPSTREAM;
+    event.node_id = origin;
+    event.detected = false;
+    event.data_len = static_cast<uint8_t>(len);
+    std::memcpy(event.data, data, len);
+    event.received = now;
+    if (events_.push(event)) {
+        events_queued_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool LoraMesh::setUpdateFile(TransferKind kind, uint32_t version, const uint8_t* data,
+                             size_t len) {
+    std::lock_guard<std::mutex> lock(transfer_mutex_);
+    if (!transfer_.setFile(kind, version, data, len)) {
+        Logger::logf(LogLevel::ERROR, "Update file too large (%zu bytes)", len);
+        return false;
+    }
+    return true;
+}
+
+void LoraMesh::configureTransfer(const LoraConfig& config) {
+    // Unauthenticated updates would let any radio replace the model
+    MeshTransfer::Key key{};
+    if (!MeshTransfer::parseKey(config.update_key, key) && config.update_duty_percent > 0) {
+        Logger::warn("mesh.update_duty_percent is set without mesh.update_key - "
+                     "mesh updates stay off");
+    }
+    transfer_.setKey(key);
+    
+    // Adverts follow the heartbeats' shortest interval, then back off
+    // much further: new versions are rare
+    auto imin = std::chrono::seconds(config.heartbeat_interval_sec);
+    auto imax = std::chrono::seconds(std::max(config.update_advert_max_sec,
+                                              config.heartbeat_interval_sec));
+    transfer_.configure(imin, imax, config.heartbeat_redundancy, updateRequestTimeout(config),
+                        updatePacketGap(config));
+    transfer_.start(std::chrono::steady_clock::now());
+}
+
+void LoraMesh::transferTick() {
+    if (update_duty_percent_ <= 0) {
+        return;
+    }
+    MeshTransfer::Frame frame;
+    {
+        std::lock_guard<std::mutex> lock(transfer_mutex_);
+        if (!transfer_.poll(std::chrono::steady_clock::now(), frame)) {
+            return;
+        }
+    }
+    
+    MeshMessage msg;
+    msg.type = frame.type;
+    msg.source_id = node_id_;
+    msg.destination_id = frame.destination < 0 ? 0xFF : static_cast<uint8_t>(frame.destination);
+    std::memcpy(msg.payload, frame.payload, frame.len);
+    msg.payload_len = static_cast<uint8_t>(frame.len);
+    msg.timestamp = std::chrono::system_clock::now();
+    
+    sendMessage(msg);
+    update_frames_sent_.fetch_add(1, std::memory_order_relaxed);
+    update_airtime_us_.fetch_add(
+        static_cast<uint64_t>(airtimeMs(config_, FRAME_OVERHEAD + frame.len) * 1000.0),
+        std::memory_order_relaxed);
+}
+
+void LoraMesh::receiveTransfer(const MeshMessage& msg, std::chrono::steady_clock::time_point now) {
+    if (update_duty_percent_ <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(transfer_mutex_);
+    transfer_.receive(msg.type, msg.source_id, msg.destination_id == node_id_, msg.payload,
+                      msg.payload_len, now);
+    
+    // The file is handed over by processMessages()
+    TransferKind kind;
+    uint32_t version;
+    while (transfer_.takeCompleted(kind, version)) {
+        MeshEvent event;
+        event.type = MeshEventType::UPDATE;
+        event.node_id = static_cast<uint8_t>(kind);
+        event.detected = false;
+        event.data_len = sizeof(version);
+        std::memcpy(event.data, &version, sizeof(version));
+        event.received = now;
+        if (events_.push(event)) {
+            events_queued_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            events_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void LoraMesh::processMessage(const MeshMessage& msg, int rssi, float snr) {
     // Ignore messages from self
     if (msg.source_id == node_id_) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    
+    // Only the node table and the heartbeat timer are touched under the
+    // lock; logging and callbacks happen outside it
+    bool tracked;
+    bool detection_changed = false;
+    {
+        std::lock_guard<std::mutex> lock(nodes_mutex_);
+        
+        // Over the mesh memory budget, keep serving known nodes but do not
+        // start tracking new ones
+        auto existing = active_nodes_.find(msg.source_id);
+        tracked = existing != active_nodes_.end() ||
+                  !MemoryTracker::shouldShed(MemorySubsystem::MESH);
+        if (tracked) {
+            // Update node info
+            bool known = existing != active_nodes_.end();
+            if (!known) {
+                NodeInfo info{};
+                existing = active_nodes_.emplace(msg.source_id, info).first;
+            }
+            auto& node = existing->second;
+            node.node_id = msg.source_id;
+            node.last_seen = now;
+            
+            // Anything that changes a neighbour's path cost re-runs parent
+            // selection: its advertised cost, its link, or hearing from a
+            // parent we had given up on
+            bool route_changed = node.unreachable;
+            node.unreachable = false;
+            if (rssi != 0) {
+                node.rssi = rssi;
+                uint16_t link_before = node.link_cost;
+                float margin = snrMargin(config_, snr);
+                node.snr_margin = link_before
+                    ? node.snr_margin + SNR_SMOOTHING * (margin - node.snr_margin)
+                    : margin;
+                node.link_cost = linkCost(node.snr_margin, link_before);
+                route_changed = route_changed || node.link_cost != link_before;
+            }
+            
+            // A heartbeat (or digest) from a known peer announcing what we
+            // already know is consistent; anything else is news. A
+            // solicitation is answered by our digest instead, so it leaves
+            // the heartbeat timer alone.
+            bool announcement = msg.type == MSG_TYPE_HEARTBEAT ||
+                                msg.type == MSG_TYPE_SOLICIT ||
+                                msg.type == MSG_TYPE_DIGEST;
+            bool consistent = false;
+            if (msg.type == MSG_TYPE_DETECTION) {
+                node.detecting = (msg.payload[0] == 1);
+            } else if (announcement) {
+                consistent = known;
+                if (msg.payload_len >= HEARTBEAT_PAYLOAD_LEN) {
+                    bool detecting = (msg.payload[0] & HEARTBEAT_DETECTING) != 0;
+                    uint16_t bound = static_cast<uint16_t>(msg.payload[1] | (msg.payload[2] << 8));
+                    uint16_t cost = static_cast<uint16_t>(msg.payload[3] | (msg.payload[4] << 8));
+                    consistent = consistent && detecting == node.detecting &&
+                                 bound == node.silence_bound_sec &&
+                                 !routeCostChanged(node.route_cost, cost);
+                    // The detection broadcast was missed: catch up
+                    detection_changed = detecting != node.detecting;
+                    node.detecting = detecting;
+                    node.silence_bound_sec = bound;
+                    route_changed = route_changed || cost != node.route_cost;
+                    node.route_cost = cost;
+                }
+            }
+            if (route_changed) {
+                updateRoute(now);
+            }
+            if (msg.type == MSG_TYPE_DIGEST && msg.destination_id == node_id_ && joining_) {
+                for (size_t i = HEARTBEAT_PAYLOAD_LEN; i < msg.payload_len; i++) {
+                    join_candidates_.set(msg.payload[i]);
+                }
+            }
+            if (msg.type == MSG_TYPE_DETECTION ||
+                (announcement && msg.type != MSG_TYPE_SOLICIT)) {
+                if (consistent) {
+                    trickle_.hearConsistent();
+                } else {
+                    trickle_.reset(now);
+                }
+            }
+        }
+    }
     
-    // Update node info
-    auto& node = active_nodes_[msg.source_id];
-    node.node_id = msg.source_id;
-    node.last_seen = std::chrono::steady_clock::now();
+    if (!tracked) {
+        if (debug_mode_) {
+            Logger::logf(LogLevel::DEBUG, "Mesh over memory budget - ignoring new node %u",
+                         msg.source_id);
+        }
+        return;
+    }
+    
+    // An announcement showed a detection change we missed
+    if (detection_changed) {
+        queueDetection(msg.source_id, (msg.payload[0] & HEARTBEAT_DETECTING) != 0, now);
+    }
     
     // Process based on message type
     switch (msg.type) {
         case MSG_TYPE_HEARTBEAT:
-            if (config_.debug_mode) {
-                Logger::debug("Received heartbeat from node " + 
-                            std::to_string(msg.source_id));
+            if (debug_mode_) {
+                Logger::logf(LogLevel::DEBUG, "Received heartbeat from node %u", msg.source_id);
+            }
+            break;
+            
+        case MSG_TYPE_SOLICIT: {
+            if (debug_mode_) {
+                Logger::logf(LogLevel::DEBUG, "Received solicitation from node %u", msg.source_id);
+            }
+            // Reply in a random slot unless listed as known or already
+            // replying to someone
+            if (msg.payload_len < SOLICIT_IDS_OFFSET || reply_pending_ || !is_initialized_ ||
+                std::memchr(msg.payload + SOLICIT_IDS_OFFSET, node_id_,
+                            msg.payload_len - SOLICIT_IDS_OFFSET) != nullptr) {
+                break;
+            }
+            int slots = std::max<int>(msg.payload[SOLICIT_SLOTS_OFFSET], 1);
+            int slot = std::uniform_int_distribution<int>(0, slots - 1)(reply_rng_);
+            uint8_t solicitor = msg.source_id;
+            reply_pending_ = true;
+            reply_timer_ = Executor::schedule(joinSlot(config_) * slot, std::chrono::seconds(0),
+                                              [this, solicitor]() { sendDigest(solicitor); },
+                                              TaskPriority::HIGH);
+            break;
+        }
+        
+        case MSG_TYPE_DIGEST:
+            if (debug_mode_) {
+                Logger::logf(LogLevel::DEBUG, "Received digest from node %u", msg.source_id);
             }
             break;
             
         case MSG_TYPE_DETECTION:
-            node.detecting = (msg.payload[0] == 1);
-            Logger::info("Node " + std::to_string(msg.source_id) + 
-                        " detection: " + (node.detecting ? "TRUE" : "FALSE"));
+            queueDetection(msg.source_id, msg.payload[0] == 1, now);
+            break;
             
-            // Notify callback
-            if (detection_callback_) {
-                detection_callback_(msg.source_id, node.detecting);
-            }
+        case MSG_TYPE_UPSTREAM:
+            receiveUpstream(msg, now);
             break;
             
         case MSG_TYPE_ACK:
-            if (config_.debug_mode) {
-                Logger::debug("Received ACK from node " + 
-                            std::to_string(msg.source_id));
+            if (debug_mode_) {
+                Logger::logf(LogLevel::DEBUG, "Received ACK from node %u", msg.source_id);
             }
+            receiveAck(msg);
+            break;
+            
+        case MSG_TYPE_UPDATE_ADVERT:
+        case MSG_TYPE_UPDATE_REQUEST:
+        case MSG_TYPE_UPDATE_DATA:
+            receiveTransfer(msg, now);
             break;
             
         default:
-            Logger::warn("Unknown message type: " + std::to_string(msg.type));
+            Logger::logf(LogLevel::WARN, "Unknown message type: %u", msg.type);
             break;
     }
 }
 
+void LoraMesh::queueDetection(uint8_t node_id, bool detected,
+                              std::chrono::steady_clock::time_point now) {
+    // Logged and passed to the callback by processMessages()
+    MeshEvent event;
+    event.type = MeshEventType::DETECTION;
+    event.node_id = node_id;
+    event.detected = detected;
+    event.data_len = 0;
+    event.received = now;
+    if (events_.push(event)) {
+        events_queued_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        events_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
 void LoraMesh::cleanupStaleNodes() {
     std::lock_guard<std::mutex> lock(nodes_mutex_);
     
     auto now = std::chrono::steady_clock::now();
-    auto timeout = std::chrono::seconds(config_.node_timeout_sec);
+    const int node_timeout_sec = node_timeout_sec_;
+    const int heartbeat_interval_sec = heartbeat_interval_sec_;
     
+    // Each peer gets the silence its heartbeat schedule allows. A detection
+    // only lasts node_timeout_sec, as detecting peers send heartbeats at the
+    // shortest interval.
+    bool expired = false;
+    bool cleared = false;
     for (auto it = active_nodes_.begin(); it != active_nodes_.end();) {
-        if (now - it->second.last_seen > timeout) {
-            Logger::info("Node " + std::to_string(it->first) + " timed out");
+        NodeInfo& node = it->second;
+        auto silent = now - node.last_seen;
+        if (silent > peerTimeout(node_timeout_sec, heartbeat_interval_sec,
+                                 node.silence_bound_sec)) {
+            Logger::logf(LogLevel::INFO, "Node %u timed out", it->first);
             it = active_nodes_.erase(it);
-        } else {
-            ++it;
+            expired = true;
+            continue;
+        }
+        if (node.detecting && silent > std::chrono::seconds(node_timeout_sec)) {
+            node.detecting = false;
+            queueDetection(it->first, false, now);
+            cleared = true;
         }
+        ++it;
+    }
+    if (expired || cleared) {
+        trickle_.reset(now);
+    }
+    if (expired) {
+        updateRoute(now);
     }
 }
 
@@ -236,12 +1353,9 @@ size_t LoraMesh::serializeMessage(const MeshMessage& msg, uint8_t* buffer) {
     return offset;
 }
 
-MeshMessage LoraMesh::deserializeMessage(const uint8_t* buffer, size_t len) {
-    MeshMessage msg;
-    
+bool LoraMesh::deserializeMessage(const uint8_t* buffer, size_t len, MeshMessage& msg) {
     if (len < 5) {
-        Logger::error("Invalid message length");
-        return msg;
+        return false;
     }
     
     size_t offset = 0;
@@ -251,9 +1365,13 @@ MeshMessage LoraMesh::deserializeMessage(const uint8_t* buffer, size_t len) {
     msg.payload_len = buffer[offset++];
     
     if (msg.payload_len > MAX_PAYLOAD_SIZE) {
-        Logger::error("Payload too large");
         msg.payload_len = 0;
-        return msg;
+        return false;
+    }
+    
+    if (offset + msg.payload_len + 1 > len) {
+        msg.payload_len = 0;
+        return false;
     }
     
     std::memcpy(msg.payload, buffer + offset, msg.payload_len);
@@ -267,14 +1385,32 @@ MeshMessage LoraMesh::deserializeMessage(const uint8_t* buffer, size_t len) {
     }
     
     if (received_checksum != calculated_checksum) {
-        Logger::warn("Checksum mismatch");
+        msg.payload_len = 0;
+        return false;
     }
     
     msg.timestamp = std::chrono::system_clock::now();
-    return msg;
+    return true;
+}
+
+bool LoraMesh::transmitData(const uint8_t* buffer, size_t len) {
+    capture_.record(CaptureDirection::TX, buffer, len);
+    if (frame_sink_) {
+        frame_sink_(buffer, len);
+    }
+    
+    // TODO: Implement actual LoRa transmission via SPI
+    // This is a placeholder
+    return true;
 }
 
 int LoraMesh::receiveData(uint8_t* buffer, size_t max_len) {
+    last_rssi_ = 0;
+    last_snr_ = 0.0f;
+    if (frame_source_) {
+        return frame_source_(buffer, max_len);
+    }
+    
     // TODO: Implement actual LoRa receive via SPI
     // This is a placeholder
     return 0;
@@ -297,24 +1433,172 @@ int LoraMesh::getDetectingNodeCount() const {
     return count;
 }
 
-void LoraMesh::processMessages() {
-    // This is called from the main loop to ensure thread-safe processing
-    // Additional message processing can be done here if needed
+void LoraMesh::getNodes(std::pmr::vector<NodeInfo>& nodes) const {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    
+    nodes.clear();
+    nodes.reserve(active_nodes_.size());
+    for (const auto& pair : active_nodes_) {
+        nodes.push_back(pair.second);
+    }
 }
 
-void LoraMesh::shutdown() {
-    Logger::info("Shutting down LoRa mesh network");
+void LoraMesh::restoreNodes(const std::vector<NodeInfo>& nodes) {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
     
-    is_initialized_ = false;
+    auto now = std::chrono::steady_clock::now();
+    const int node_timeout_sec = node_timeout_sec_;
+    const int heartbeat_interval_sec = heartbeat_interval_sec_;
     
-    // Wait for threads to finish
-    if (receive_thread_.joinable()) {
-        receive_thread_.join();
+    for (const auto& node : nodes) {
+        if (node.node_id == node_id_ ||
+            now - node.last_seen > peerTimeout(node_timeout_sec, heartbeat_interval_sec,
+                                               node.silence_bound_sec)) {
+            continue;
+        }
+        active_nodes_.emplace(node.node_id, node);
+    }
+}
+
+void LoraMesh::processMessages() {
+    // Drain in batches, one clock read each, and at most one queue's
+    // worth per call so a flood cannot stall the main loop
+    MeshEvent batch[MESH_EVENT_BATCH];
+    size_t budget = MESH_EVENT_QUEUE_SIZE;
+    while (budget > 0) {
+        size_t count = 0;
+        while (count < MESH_EVENT_BATCH && count < budget && events_.pop(batch[count])) {
+            count++;
+        }
+        if (count == 0) {
+            break;
+        }
+        budget -= count;
+        
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            const MeshEvent& event = batch[i];
+            event_latency_.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                now - event.received).count());
+            
+            switch (event.type) {
+                case MeshEventType::DETECTION:
+                    Logger::logf(LogLevel::INFO, "Node %u detection: %s",
+                                 event.node_id, event.detected ? "TRUE" : "FALSE");
+                    if (detection_callback_) {
+                        detection_callback_(event.node_id, event.detected);
+                    }
+                    break;
+                    
+                case MeshEventType::UPSTREAM:
+                    if (debug_mode_) {
+                        Logger::logf(LogLevel::DEBUG, "Upstream message from node %u (%u bytes)",
+                                     event.node_id, event.data_len);
+                    }
+                    if (upstream_callback_) {
+                        upstream_callback_(event.node_id, event.data, event.data_len);
+                    }
+                    break;
+                    
+                case MeshEventType::UPDATE: {
+                    // A newer version may have replaced this one since;
+                    // its own event follows
+                    auto kind = static_cast<TransferKind>(event.node_id);
+                    uint32_t version;
+                    std::memcpy(&version, event.data, sizeof(version));
+                    {
+                        std::lock_guard<std::mutex> lock(transfer_mutex_);
+                        if (transfer_.version(kind) != version) {
+                            break;
+                        }
+                        size_t len;
+                        const uint8_t* data = transfer_.file(kind, len);
+                        update_buffer_.assign(data, data + len);
+                    }
+                    Logger::logf(LogLevel::INFO, "Mesh update: %s version %u (%zu bytes)",
+                                 kind == TransferKind::MODEL ? "model" : "config", version,
+                                 update_buffer_.size());
+                    if (update_callback_) {
+                        update_callback_(kind, version, update_buffer_.data(),
+                                         update_buffer_.size());
+                    }
+                    break;
+                }
+            }
+        }
+        
+        events_handled_.fetch_add(count, std::memory_order_relaxed);
+        event_batches_.fetch_add(1, std::memory_order_relaxed);
+        if (count > max_event_batch_.load(std::memory_order_relaxed)) {
+            max_event_batch_.store(count, std::memory_order_relaxed);
+        }
     }
     
-    if (heartbeat_thread_.joinable()) {
-        heartbeat_thread_.join();
+    uint64_t dropped = events_dropped_.load(std::memory_order_relaxed);
+    if (dropped != drops_reported_) {
+        Logger::logf(LogLevel::WARN, "Mesh event queue full - dropped %llu events",
+                     static_cast<unsigned long long>(dropped - drops_reported_));
+        drops_reported_ = dropped;
     }
+}
+
+MeshEventStats LoraMesh::getEventStats() const {
+    MeshEventStats stats;
+    stats.frames_rejected = frames_rejected_.load(std::memory_order_relaxed);
+    stats.queued = events_queued_.load(std::memory_order_relaxed);
+    stats.dropped = events_dropped_.load(std::memory_order_relaxed);
+    stats.handled = events_handled_.load(std::memory_order_relaxed);
+    stats.batches = event_batches_.load(std::memory_order_relaxed);
+    stats.max_batch = max_event_batch_.load(std::memory_order_relaxed);
+    stats.latency = &event_latency_;
+    return stats;
+}
+
+MeshRouteStats LoraMesh::getRouteStats() const {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    MeshRouteStats stats;
+    stats.cost = route_cost_;
+    stats.parent = parent_;
+    stats.originated = upstream_originated_;
+    stats.forwarded = upstream_forwarded_;
+    stats.delivered = upstream_delivered_;
+    stats.dropped = upstream_dropped_;
+    stats.fallbacks = route_fallbacks_;
+    stats.parent_changes = parent_changes_;
+    return stats;
+}
+
+MeshTransferStats LoraMesh::getTransferStats() const {
+    std::lock_guard<std::mutex> lock(transfer_mutex_);
+    return transfer_.stats();
+}
+
+TransferProgress LoraMesh::getTransferProgress(TransferKind kind) const {
+    std::lock_guard<std::mutex> lock(transfer_mutex_);
+    return transfer_.progress(kind);
+}
+
+MeshAirtimeStats LoraMesh::getAirtimeStats() const {
+    MeshAirtimeStats stats;
+    stats.frames_sent = frames_sent_.load(std::memory_order_relaxed);
+    stats.heartbeats_sent = heartbeats_sent_.load(std::memory_order_relaxed);
+    stats.solicitations_sent = solicitations_sent_.load(std::memory_order_relaxed);
+    stats.digests_sent = digests_sent_.load(std::memory_order_relaxed);
+    stats.update_frames_sent = update_frames_sent_.load(std::memory_order_relaxed);
+    stats.update_airtime_sec = update_airtime_us_.load(std::memory_order_relaxed) / 1e6;
+    stats.airtime_sec = airtime_us_.load(std::memory_order_relaxed) / 1e6;
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    stats.heartbeats_suppressed = trickle_.suppressed();
+    stats.trickle_resets = trickle_.resets();
+    return stats;
+}
+
+void LoraMesh::shutdown() {
+    Logger::info("Shutting down LoRa mesh network");
+    
+    // Wait for threads to finish
+    stopThreads();
+    capture_.close();
     
     // TODO: Close SPI interface
     
@@ -1,21 +1,37 @@
 #ifndef LORA_MESH_H
 #define LORA_MESH_H
 
+#include <array>
+#include <bitset>
 #include <cstdint>
+#include <random>
 #include <string>
 #include <map>
+#include <memory_resource>
+#include <vector>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <functional>
 #include <chrono>
+#include "core/sentinel_core.h"
+#include "network/mesh_capture.h"
+#include "network/mesh_transfer.h"
+#include "network/trickle_timer.h"
+#include "utils/executor.h"
+#include "utils/jitter_monitor.h"
+#include "utils/mpsc_queue.h"
 
 namespace sentinel {
 
-// Forward declaration from sentinel_core.h
-struct LoraConfig;
-
 constexpr size_t MAX_PAYLOAD_SIZE = 64;
 
+// Cost to a gateway of a node without a route
+constexpr uint16_t ROUTE_COST_NONE = 0xFFFF;
+
+// Application data carried by one upstream message
+constexpr size_t UPSTREAM_MAX_DATA = 16;
+
 struct MeshMessage {
     uint8_t type;
     uint8_t source_id;
@@ -30,6 +46,66 @@ struct NodeInfo {
     bool detecting;
     std::chrono::steady_clock::time_point last_seen;
     int rssi; // Signal strength
+    uint16_t silence_bound_sec;          // Longest gap between its heartbeats (0 = unknown)
+    uint16_t route_cost = ROUTE_COST_NONE;   // Advertised cost to a gateway
+    float snr_margin = 0.0f;             // Smoothed SNR above the demodulation floor, dB
+    uint16_t link_cost = 0;              // From snr_margin (0 = no signal reports)
+    bool unreachable = false;            // Stopped acknowledging: no parent until heard again
+};
+
+// Events the receive path hands over to processMessages()
+enum class MeshEventType : uint8_t {
+    DETECTION,
+    UPSTREAM,                            // Reached this gateway (node_id = origin)
+    UPDATE                               // File verified (node_id = kind, data = version)
+};
+
+struct MeshEvent {
+    MeshEventType type;
+    uint8_t node_id;
+    bool detected;
+    uint8_t data_len;
+    uint8_t data[UPSTREAM_MAX_DATA];
+    std::chrono::steady_clock::time_point received;
+};
+
+// Queued events, ~40 KB. Enough for every node to toggle its detection
+// twice between two main loop cycles.
+constexpr size_t MESH_EVENT_QUEUE_SIZE = 1024;
+
+// Transmit counters; airtime from the LoRa time-on-air formula
+struct MeshAirtimeStats {
+    uint64_t frames_sent;                // Including retries
+    uint64_t heartbeats_sent;
+    uint64_t heartbeats_suppressed;      // Redundant (Trickle)
+    uint64_t trickle_resets;
+    uint64_t solicitations_sent;         // Join handshake, both sides
+    uint64_t digests_sent;
+    uint64_t update_frames_sent;         // Model and config distribution
+    double update_airtime_sec;
+    double airtime_sec;
+};
+
+// Gradient routing toward the gateways
+struct MeshRouteStats {
+    uint16_t cost;                       // ROUTE_COST_NONE without a route
+    int parent;                          // -1 without a route
+    uint64_t originated;                 // sendUpstream() calls queued
+    uint64_t forwarded;                  // Acknowledged by the next hop, own and relayed
+    uint64_t delivered;                  // Gateway: unique messages received
+    uint64_t dropped;                    // No parent left, hop limit or queue full
+    uint64_t fallbacks;                  // Parent stopped acknowledging, next one tried
+    uint64_t parent_changes;
+};
+
+struct MeshEventStats {
+    uint64_t frames_rejected;            // Received with a bad length or checksum
+    uint64_t queued;
+    uint64_t dropped;                    // Queue full
+    uint64_t handled;
+    uint64_t batches;                    // processMessages() rounds with events
+    uint64_t max_batch;
+    const LatencyHistogram* latency;     // Receive to callback, microseconds
 };
 
 class LoraMesh {
@@ -46,21 +122,215 @@ public:
     // Send a message to the mesh
     void sendMessage(const MeshMessage& msg);
     
-    // Process incoming messages (call from main loop)
+    // Hand queued events to the callbacks (call from main loop). The
+    // receive path only updates the node table and queues events, so
+    // callbacks run here, on the caller's thread, with no lock held.
     void processMessages();
     
+    // Rejected frames, event queue counters and receive-to-callback latency
+    MeshEventStats getEventStats() const;
+    
+    // Frames and airtime sent so far
+    MeshAirtimeStats getAirtimeStats() const;
+    
+    // Time on air of a frame_len-byte frame (Semtech SX127x formula,
+    // explicit header; low data rate optimization above 16 ms symbols)
+    static double airtimeMs(const LoraConfig& config, size_t frame_len);
+    
+    // Heartbeats follow a Trickle timer (see trickle_timer.h): the interval
+    // doubles from heartbeat_interval_sec to heartbeat_max_interval_sec
+    // while peers announce nothing new, a heartbeat is skipped when
+    // heartbeat_redundancy peers already sent consistent ones, and any
+    // change (new peer, detection, timeout) goes back to the shortest
+    // interval. At most this many heartbeats in a row are skipped.
+    static constexpr int MAX_SUPPRESSED_HEARTBEATS = 1;
+    
+    // How long a peer may stay unheard before it times out. A fixed-interval
+    // peer gets node_timeout_sec; one advertising a silence bound gets as
+    // many bounds as node_timeout_sec holds heartbeat intervals, so the
+    // same number of lost announcements is tolerated at any interval, but
+    // at most two bounds plus node_timeout_sec. A peer's detection flag
+    // expires after node_timeout_sec regardless (a detecting node sends
+    // heartbeats at the shortest interval).
+    static std::chrono::seconds peerTimeout(int node_timeout_sec, int heartbeat_interval_sec,
+                                            uint16_t silence_bound_sec);
+    
+    // Join handshake: at startup the node broadcasts a solicitation listing
+    // the peers it already knows and a number of reply slots. Every other
+    // neighbour answers in a random slot with a digest of its own most
+    // recently heard peers. Peers named in digests but not heard directly
+    // may be neighbours whose replies were lost, so the node solicits again
+    // with two slots per missing peer. Candidates two hops away never
+    // answer, so the handshake ends when a repeat round finds nobody new,
+    // or after JOIN_MAX_ROUNDS rounds.
+    static constexpr int JOIN_MAX_ROUNDS = 5;
+    static constexpr int JOIN_MIN_SLOTS = 4;
+    static constexpr size_t JOIN_DIGEST_ENTRIES = 16;
+    
+    // One reply slot: a full digest on the air plus turnaround
+    static std::chrono::microseconds joinSlot(const LoraConfig& config);
+    
+    // Slots for the next round after rounds_done rounds, the last of which
+    // found `found` new peers; 0 ends the handshake
+    static int joinNextSlots(int rounds_done, size_t missing, size_t found, int first_slots);
+    
+    // True until the join handshake finishes; the node table may still be
+    // missing neighbours
+    bool joining() const { return joining_; }
+    
+    // Gradient routing. Gateways (mesh.gateway) advertise cost 0 in their
+    // announcements; every other node adds the link cost to the cheapest
+    // advertised neighbour cost and announces the sum. That neighbour is
+    // its parent. A new parent must be cheaper than the current one by
+    // ROUTE_SWITCH_THRESHOLD, so noise on a link does not flip the parent.
+    // Gaining or losing a route, or a cost change of ROUTE_RESET_COST or
+    // more, resets the Trickle timer, so it spreads at the shortest
+    // heartbeat interval. Smaller changes wait for the next heartbeat:
+    // resetting on each one floods a busy channel with announcements.
+    //
+    // Upstream messages go hop by hop to the parent, which acknowledges
+    // each one. After ROUTE_ATTEMPTS unanswered tries the parent is marked
+    // unreachable and the message goes to the next cheapest neighbour,
+    // so a dead parent costs a few acknowledgement timeouts, not a
+    // heartbeat timeout. Each message carries its sender's cost: a parent
+    // that receives it with a cost no lower than the sender's has a stale
+    // gradient (a possible loop) and resets its Trickle timer. Messages
+    // sent to a fallback neighbour are flagged as detours and skip this
+    // check, since they may go sideways. No node sends a message back to
+    // the neighbour it came from.
+    static constexpr uint16_t ROUTE_HOP_COST = 16;
+    static constexpr uint16_t ROUTE_SWITCH_THRESHOLD = ROUTE_HOP_COST / 2;
+    static constexpr uint16_t ROUTE_RESET_COST = 4 * ROUTE_HOP_COST;
+    static constexpr int ROUTE_MAX_HOPS = 32;
+    static constexpr int ROUTE_ATTEMPTS = 3;     // Per parent
+    static constexpr int ROUTE_MAX_PARENTS = 3;  // Tried per message
+    static constexpr size_t ROUTE_QUEUE_SIZE = 8;
+    
+    // Costs beyond ROUTE_MAX_HOPS worst-case links count as no route,
+    // which ends counting to infinity around a lost gateway
+    static constexpr uint32_t ROUTE_MAX_COST = ROUTE_MAX_HOPS * 4 * ROUTE_HOP_COST;
+    
+    // Cost of one link: a hop, plus a hop for every 5 dB its SNR margin
+    // falls short of 10 dB (at most three), since weak links lose frames.
+    // Given the link's current cost, that cost is kept until the margin is
+    // LINK_HYSTERESIS_DB into another band, so a link near a band edge
+    // does not keep changing the route.
+    static constexpr float LINK_HYSTERESIS_DB = 2.0f;
+    static uint16_t linkCost(float snr_margin);
+    static uint16_t linkCost(float snr_margin, uint16_t current);
+    
+    // SNR above the demodulation floor of the configured spreading factor
+    static float snrMargin(const LoraConfig& config, float snr);
+    
+    // True if peers should hear about a change from before to after:
+    // gaining or losing a route, or a change of ROUTE_RESET_COST or more
+    static bool routeCostChanged(uint16_t before, uint16_t after);
+    
+    // Wait for a hop's acknowledgement: the message and the acknowledgement
+    // on the air, with room for a frame the next hop was already sending
+    static std::chrono::microseconds ackTimeout(const LoraConfig& config);
+    
+    // Send up to UPSTREAM_MAX_DATA bytes to the nearest gateway. Returns
+    // false without a route, with too much data or with the queue full.
+    // On a gateway the data goes straight to the upstream callback.
+    bool sendUpstream(const uint8_t* data, size_t len);
+    
+    MeshRouteStats getRouteStats() const;
+    
+    // Model and config distribution (see mesh_transfer.h). The file this
+    // node holds is advertised and served with mesh.update_duty_percent of
+    // the airtime, and is the chunk base for the next version. A newer
+    // version heard from a neighbour is fetched in the background and
+    // verified, then handed to the update callback. version 0 keeps the
+    // file as a chunk base only. Off unless updatesEnabled().
+    bool setUpdateFile(TransferKind kind, uint32_t version, const uint8_t* data, size_t len);
+    MeshTransferStats getTransferStats() const;
+    TransferProgress getTransferProgress(TransferKind kind) const;
+    
+    // Time between two update data frames this node sends (their airtime
+    // over the duty share), and the quiet time before asking again
+    static std::chrono::microseconds updatePacketGap(const LoraConfig& config);
+    static std::chrono::microseconds updateRequestTimeout(const LoraConfig& config);
+    
+    // A duty share and a valid mesh.update_key are both set
+    static bool updatesEnabled(const LoraConfig& config);
+    
+    // Handle one raw frame as received from the radio (also used to
+    // inject recorded or generated traffic, see MeshReplay). rssi in dBm
+    // (0 = unknown), snr in dB.
+    void receiveFrame(const uint8_t* buffer, size_t len, int rssi = 0, float snr = 0.0f);
+    
+    // Record every received and transmitted frame to a capture file (see
+    // mesh_capture.h) until stopCapture()
+    bool startCapture(const std::string& path);
+    void stopCapture();
+    
+    // Wire format: type, source, destination, length, payload, XOR checksum.
+    // buffer must hold MAX_PAYLOAD_SIZE + 5 bytes. deserializeMessage
+    // returns false for short, truncated or oversized frames and on a
+    // checksum mismatch; receiveFrame() counts those in frames_rejected.
+    static size_t serializeMessage(const MeshMessage& msg, uint8_t* buffer);
+    static bool deserializeMessage(const uint8_t* buffer, size_t len, MeshMessage& msg);
+    
     // Get number of active nodes
     int getActiveNodeCount() const;
     
     // Get number of nodes currently detecting smoke
     int getDetectingNodeCount() const;
     
-    // Set callback for detection events from other nodes
+    // Copy the known nodes into nodes (replacing its contents). Pass a
+    // vector backed by scratch memory to avoid heap allocation.
+    void getNodes(std::pmr::vector<NodeInfo>& nodes) const;
+    
+    // Seed the node table (e.g. after a warm restart). Entries older than
+    // the node timeout are ignored and existing entries are kept.
+    void restoreNodes(const std::vector<NodeInfo>& nodes);
+    
+    // Apply settings that may change while running (heartbeat interval,
+    // node timeout, retries, debug). Takes effect at the next loop iteration.
+    void applyConfig(const LoraConfig& config);
+    
+    // True if switching to config needs the radio to be reconfigured
+    bool requiresRadioRestart(const LoraConfig& config) const;
+    
+    // Stop the network threads, reconfigure the radio and resume.
+    // The table of known nodes is preserved.
+    bool restartRadio(const LoraConfig& config);
+    
+    // Set callback for detection events from other nodes (called from
+    // processMessages())
     using DetectionCallback = std::function<void(uint8_t node_id, bool detected)>;
     void setDetectionCallback(DetectionCallback callback) {
         detection_callback_ = callback;
     }
     
+    // Set callback for upstream messages reaching this gateway (called
+    // from processMessages())
+    using UpstreamCallback = std::function<void(uint8_t origin, const uint8_t* data, size_t len)>;
+    void setUpstreamCallback(UpstreamCallback callback) {
+        upstream_callback_ = callback;
+    }
+    
+    // Set callback for files fetched from the mesh and verified (called
+    // from processMessages(); data is valid during the call)
+    using UpdateCallback = std::function<void(TransferKind kind, uint32_t version,
+                                              const uint8_t* data, size_t len)>;
+    void setUpdateCallback(UpdateCallback callback) {
+        update_callback_ = callback;
+    }
+    
+    // Receive from source instead of the radio. Must be set before
+    // initialize(); frames are polled by the receive thread.
+    void setFrameSource(MeshFrameSource source) {
+        frame_source_ = std::move(source);
+    }
+    
+    // Also hand every transmitted frame to sink. Must be set before
+    // initialize(); called from the transmitting thread.
+    void setFrameSink(MeshFrameSink sink) {
+        frame_sink_ = std::move(sink);
+    }
+    
     // Cleanup
     void shutdown();
     
@@ -71,39 +341,184 @@ private:
     // Configure LoRa radio parameters
     bool configureLoRa();
     
-    // Network threads
+    // Start/stop the receive thread and the heartbeat and cleanup timers
+    void startThreads();
+    void stopThreads();
+    
+    // Receive thread; heartbeats run as executor timers
     void receiveLoop();
-    void heartbeatLoop();
+    void heartbeatTick();
+    void sendHeartbeat();
+    
+    // Apply heartbeat settings and restart the Trickle timer (nodes_mutex_ held)
+    void configureTrickle(const LoraConfig& config);
+    
+    // Join handshake: joinTick() runs once per round on join_timer_
+    void joinTick();
+    std::chrono::microseconds sendSolicitation(int slots);
+    void sendDigest(uint8_t solicitor);
+    
+    // Flags, silence bound and route cost at the start of heartbeat,
+    // solicitation and digest payloads
+    void fillAnnouncement(MeshMessage& msg) const;
+    
+    // Hand a peer's detection change to processMessages()
+    void queueDetection(uint8_t node_id, bool detected,
+                        std::chrono::steady_clock::time_point now);
+    
+    // Gradient routing. updateRoute() picks the parent and cost from the
+    // node table; routeTick() sends the upstream messages that are due and
+    // falls back to another parent when one stays unanswered. The helpers
+    // up to rememberUpstream() expect nodes_mutex_ held.
+    void updateRoute(std::chrono::steady_clock::time_point now);
+    int nextHop(const std::bitset<256>& excluded) const;
+    bool queueUpstream(uint8_t origin, uint8_t seq, int ttl, int prev_hop,
+                       const uint8_t* data, size_t len);
+    bool seenUpstream(uint8_t origin, uint8_t seq) const;
+    void rememberUpstream(uint8_t origin, uint8_t seq);
+    void routeTick();
+    void receiveUpstream(const MeshMessage& msg, std::chrono::steady_clock::time_point now);
+    void receiveAck(const MeshMessage& msg);
+    void sendAck(uint8_t destination, uint8_t origin, uint8_t seq);
+    
+    // Post routeTick() or sendAck() to the executor. Both are counted in
+    // route_tasks_ until they have run, and stopThreads() waits for them;
+    // nothing is posted once the mesh is stopping.
+    void postRouteTick();
+    void postAck(uint8_t destination, uint8_t origin, uint8_t seq);
+    bool beginRouteTask();
+    void queueUpstreamEvent(uint8_t origin, const uint8_t* data, size_t len,
+                            std::chrono::steady_clock::time_point now);
+    
+    // Model and config distribution: transferTick() sends what the
+    // transfer has due, on transfer_timer_ (transfer_mutex_ not held)
+    void configureTransfer(const LoraConfig& config);
+    void transferTick();
+    void receiveTransfer(const MeshMessage& msg, std::chrono::steady_clock::time_point now);
     
     // Message processing
-    void processMessage(const MeshMessage& msg);
+    void processMessage(const MeshMessage& msg, int rssi, float snr);
     void cleanupStaleNodes();
     
-    // Message serialization
-    size_t serializeMessage(const MeshMessage& msg, uint8_t* buffer);
-    MeshMessage deserializeMessage(const uint8_t* buffer, size_t len);
-    
-    // Low-level LoRa communication
+    // Low-level LoRa communication. receiveData also reports the frame's
+    // signal quality in last_rssi_ and last_snr_.
+    bool transmitData(const uint8_t* buffer, size_t len);
     int receiveData(uint8_t* buffer, size_t max_len);
     
     uint8_t node_id_;
     LoraConfig config_;
-    bool is_initialized_;
+    std::atomic<bool> is_initialized_;
+    
+    // Runtime-adjustable settings (see applyConfig)
+    std::atomic<int> heartbeat_interval_sec_;
+    std::atomic<int> node_timeout_sec_;
+    std::atomic<int> max_retries_;
+    std::atomic<int> retry_delay_ms_;
+    std::atomic<bool> debug_mode_;
     
-    // Active nodes in the mesh
-    std::map<uint8_t, NodeInfo> active_nodes_;
+    // Active nodes in the mesh (mesh memory resource)
+    std::pmr::map<uint8_t, NodeInfo> active_nodes_;
     mutable std::mutex nodes_mutex_;
     
+    // Heartbeat schedule (nodes_mutex_), and what the heartbeats announce
+    TrickleTimer trickle_;
+    std::atomic<bool> announce_;             // Heartbeat on the next tick regardless
+    std::atomic<bool> detecting_;
+    std::atomic<uint16_t> silence_bound_sec_;
+    
+    // Join handshake. Round state is guarded by nodes_mutex_; the reply
+    // timer and RNG belong to the receive thread.
+    std::atomic<bool> joining_;
+    int join_round_;
+    size_t join_known_;                      // Peers known when the round started
+    std::bitset<256> join_candidates_;       // Named in digests
+    std::chrono::steady_clock::time_point join_started_;
+    Executor::TimerId join_timer_;
+    Executor::TimerId reply_timer_;
+    std::atomic<bool> reply_pending_;
+    std::minstd_rand reply_rng_;
+    
+    // Gradient routing (nodes_mutex_; the cost is also read to announce it)
+    struct PendingUpstream {
+        bool active = false;
+        uint8_t origin = 0;
+        uint8_t seq = 0;
+        uint8_t ttl = 0;
+        uint8_t data_len = 0;
+        uint8_t data[UPSTREAM_MAX_DATA];
+        int next_hop = -1;                   // -1 = not chosen yet
+        int attempts = 0;                    // To next_hop
+        int parents = 0;                     // Next hops tried
+        std::bitset<256> excluded;           // Previous hop and parents that failed
+        std::chrono::steady_clock::time_point due;
+    };
+    std::atomic<uint16_t> route_cost_;
+    int parent_;
+    std::array<PendingUpstream, ROUTE_QUEUE_SIZE> upstream_;
+    std::array<uint32_t, 32> seen_upstream_;     // Ring of 0x10000 | origin << 8 | seq
+    size_t seen_next_;
+    uint8_t upstream_seq_;
+    std::minstd_rand route_rng_;
+    uint64_t upstream_originated_;
+    uint64_t upstream_forwarded_;
+    uint64_t upstream_delivered_;
+    uint64_t upstream_dropped_;
+    uint64_t route_fallbacks_;
+    uint64_t parent_changes_;
+    std::atomic<int> route_tasks_;           // Posted routeTick()/sendAck() not yet run
+    
+    // Model and config distribution (transfer_mutex_). The buffer hands
+    // files to the update callback (processMessages() only).
+    MeshTransfer transfer_;
+    mutable std::mutex transfer_mutex_;
+    std::atomic<int> update_duty_percent_;   // 0 while !updatesEnabled()
+    Executor::TimerId transfer_timer_;
+    std::vector<uint8_t> update_buffer_;
+    
+    // Transmit counters
+    std::atomic<uint64_t> frames_sent_;
+    std::atomic<uint64_t> heartbeats_sent_;
+    std::atomic<uint64_t> solicitations_sent_;
+    std::atomic<uint64_t> digests_sent_;
+    std::atomic<uint64_t> update_frames_sent_;
+    std::atomic<uint64_t> update_airtime_us_;
+    std::atomic<uint64_t> airtime_us_;
+    
     // Threading
     std::thread receive_thread_;
-    std::thread heartbeat_thread_;
+    Executor::TimerId heartbeat_timer_;
+    Executor::TimerId cleanup_timer_;
     std::mutex send_mutex_;
     
-    // Callback
+    // Callbacks
     DetectionCallback detection_callback_;
+    UpstreamCallback upstream_callback_;
+    UpdateCallback update_callback_;
+    MeshFrameSource frame_source_;
+    MeshFrameSink frame_sink_;
+    
+    // Receive path to processMessages(). A full queue drops the event;
+    // the node table still has the sender's state.
+    MpscQueue<MeshEvent, MESH_EVENT_QUEUE_SIZE> events_;
+    std::atomic<uint64_t> frames_rejected_;
+    std::atomic<uint64_t> events_queued_;
+    std::atomic<uint64_t> events_dropped_;
+    std::atomic<uint64_t> events_handled_;
+    std::atomic<uint64_t> event_batches_;
+    std::atomic<uint64_t> max_event_batch_;
+    uint64_t drops_reported_;            // processMessages() only
+    LatencyHistogram event_latency_;
     
     // SPI file descriptor
     int spi_fd_;
+    
+    // Signal quality of the last received frame (receive thread only)
+    int last_rssi_;
+    float last_snr_;
+    
+    // mesh.capture_file
+    MeshCaptureWriter capture_;
+    std::string capture_path_;
 };
 
 } // namespace sentinel
@@ -0,0 +1,232 @@
+#include "network/mesh_capture.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+
+namespace sentinel {
+
+// Buffered records are written out at this size or after FLUSH_INTERVAL
+static constexpr size_t FLUSH_SIZE = 4096;
+static constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+static void putLe(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static uint64_t getLe(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+MeshCaptureWriter::MeshCaptureWriter()
+    : file_(nullptr),
+      last_us_(0),
+      open_(false),
+      records_(0) {
+}
+
+MeshCaptureWriter::~MeshCaptureWriter() {
+    close();
+}
+
+bool MeshCaptureWriter::open(const std::string& path, uint8_t node_id) {
+    close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        Logger::error("Cannot create mesh capture " + path + ": " + std::strerror(errno));
+        return false;
+    }
+
+    int64_t start_unix_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    buffer_.clear();
+    buffer_.reserve(FLUSH_SIZE * 2);
+    putLe(buffer_, CAPTURE_MAGIC, 4);
+    putLe(buffer_, CAPTURE_VERSION, 2);
+    putLe(buffer_, node_id, 1);
+    putLe(buffer_, 0, 1);
+    putLe(buffer_, static_cast<uint64_t>(start_unix_ns), 8);
+    putLe(buffer_, 0, 8);
+    flushLocked();
+
+    start_ = std::chrono::steady_clock::now();
+    last_flush_ = start_;
+    last_us_ = 0;
+    records_ = 0;
+    open_ = true;
+    Logger::info("Capturing mesh traffic to " + path);
+    return true;
+}
+
+void MeshCaptureWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;
+    }
+    open_ = false;
+    flushLocked();
+    std::fclose(file_);
+    file_ = nullptr;
+    Logger::logf(LogLevel::INFO, "Mesh capture closed (%llu frames)",
+                 static_cast<unsigned long long>(records_.load()));
+}
+
+void MeshCaptureWriter::record(CaptureDirection direction, const uint8_t* frame, size_t len,
+                               int rssi, float snr) {
+    if (!open_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    CaptureRecord record;
+    record.time_us = std::max<uint64_t>(last_us_,
+        std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count());
+    record.direction = direction;
+    record.rssi = rssi;
+    record.snr = snr;
+    record.data = frame;
+    record.len = len;
+    append(record);
+
+    if (buffer_.size() >= FLUSH_SIZE || now - last_flush_ >= FLUSH_INTERVAL) {
+        flushLocked();
+        last_flush_ = now;
+    }
+}
+
+bool MeshCaptureWriter::write(const CaptureRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_ || record.time_us < last_us_) {
+        return false;
+    }
+    append(record);
+    if (buffer_.size() >= FLUSH_SIZE) {
+        flushLocked();
+    }
+    return true;
+}
+
+void MeshCaptureWriter::append(const CaptureRecord& record) {
+    // Time delta as a LEB128 varint: one byte below 128 us, three below 2 s
+    uint64_t delta = record.time_us - last_us_;
+    last_us_ = record.time_us;
+    do {
+        uint8_t byte = delta & 0x7F;
+        delta >>= 7;
+        buffer_.push_back(delta ? (byte | 0x80) : byte);
+    } while (delta);
+
+    size_t len = std::min(record.len, CAPTURE_MAX_FRAME);
+    int rssi = std::min(255, std::max(0, -record.rssi));
+    int snr = static_cast<int>(std::lround(record.snr * 4.0f));
+    buffer_.push_back(record.direction == CaptureDirection::TX ? 1 : 0);
+    buffer_.push_back(static_cast<uint8_t>(rssi));
+    buffer_.push_back(static_cast<uint8_t>(static_cast<int8_t>(std::min(127, std::max(-128, snr)))));
+    buffer_.push_back(static_cast<uint8_t>(len));
+    buffer_.insert(buffer_.end(), record.data, record.data + len);
+    records_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MeshCaptureWriter::flushLocked() {
+    if (buffer_.empty()) {
+        return;
+    }
+    if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size() ||
+        std::fflush(file_) != 0) {
+        Logger::logf(LogLevel::ERROR, "Mesh capture write failed: %s", std::strerror(errno));
+    }
+    buffer_.clear();
+}
+
+MeshCaptureReader::MeshCaptureReader()
+    : file_(nullptr),
+      node_id_(0),
+      start_unix_ns_(0),
+      time_us_(0) {
+}
+
+MeshCaptureReader::~MeshCaptureReader() {
+    close();
+}
+
+bool MeshCaptureReader::open(const std::string& path) {
+    close();
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        last_error_ = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    uint8_t header[CAPTURE_HEADER_SIZE];
+    if (std::fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+        getLe(header, 4) != CAPTURE_MAGIC) {
+        last_error_ = path + " is not a mesh capture";
+        close();
+        return false;
+    }
+    if (getLe(header + 4, 2) != CAPTURE_VERSION) {
+        last_error_ = path + ": unsupported capture version " + std::to_string(getLe(header + 4, 2));
+        close();
+        return false;
+    }
+    node_id_ = header[6];
+    start_unix_ns_ = static_cast<int64_t>(getLe(header + 8, 8));
+    time_us_ = 0;
+    return true;
+}
+
+void MeshCaptureReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool MeshCaptureReader::next(CaptureRecord& record) {
+    if (!file_) {
+        return false;
+    }
+
+    uint64_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+        int byte = std::fgetc(file_);
+        if (byte == EOF || shift > 63) {
+            return false;
+        }
+        delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    uint8_t fields[4];
+    if (std::fread(fields, 1, sizeof(fields), file_) != sizeof(fields) ||
+        std::fread(frame_, 1, fields[3], file_) != fields[3]) {
+        return false;
+    }
+
+    time_us_ += delta;
+    record.time_us = time_us_;
+    record.direction = (fields[0] & 1) ? CaptureDirection::TX : CaptureDirection::RX;
+    record.rssi = -static_cast<int>(fields[1]);
+    record.snr = static_cast<int8_t>(fields[2]) / 4.0f;
+    record.data = frame_;
+    record.len = fields[3];
+    return true;
+}
+
+} // namespace sentinel
\ No newline at end of file
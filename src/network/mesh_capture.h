@@ -0,0 +1,120 @@
+#ifndef SENTINEL_MESH_CAPTURE_H
+#define SENTINEL_MESH_CAPTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sentinel {
+
+// Mesh capture file: every raw frame a node received or transmitted, for
+// replaying field traffic later (see MeshReplay and sentinel_mesh_replay).
+//
+// Little-endian. A 24-byte header:
+//   u32 magic "SNMC", u16 version, u8 node id, u8 reserved,
+//   i64 capture start (Unix time, ns), u64 reserved
+// followed by one record per frame:
+//   varint  microseconds since the previous record (the first: since start)
+//   u8      flags (bit 0: transmitted)
+//   u8      -RSSI in dBm (0 = unknown)
+//   i8      SNR in 0.25 dB steps
+//   u8      frame length
+//   bytes   the frame as on the air
+// A heartbeat costs about 10 bytes.
+
+constexpr uint32_t CAPTURE_MAGIC = 0x434d4e53;       // "SNMC"
+constexpr uint16_t CAPTURE_VERSION = 1;
+constexpr size_t CAPTURE_HEADER_SIZE = 24;
+constexpr size_t CAPTURE_MAX_FRAME = 255;
+
+enum class CaptureDirection : uint8_t {
+    RX = 0,
+    TX = 1
+};
+
+struct CaptureRecord {
+    uint64_t time_us = 0;            // Since capture start
+    CaptureDirection direction = CaptureDirection::RX;
+    int rssi = 0;                    // dBm, 0 = unknown
+    float snr = 0.0f;                // dB
+    const uint8_t* data = nullptr;   // Owned by the reader; valid until its next call
+    size_t len = 0;
+};
+
+// Appends frames to a capture file. Thread-safe: the receive thread and
+// the transmitting threads share one writer. Records are buffered and
+// written out every 4 KB or once a second.
+class MeshCaptureWriter {
+public:
+    MeshCaptureWriter();
+    ~MeshCaptureWriter();
+
+    MeshCaptureWriter(const MeshCaptureWriter&) = delete;
+    MeshCaptureWriter& operator=(const MeshCaptureWriter&) = delete;
+
+    // Create (truncate) path and write the header
+    bool open(const std::string& path, uint8_t node_id);
+    void close();
+    bool isOpen() const { return open_.load(std::memory_order_relaxed); }
+
+    // Record a frame stamped with the current time. Frames longer than
+    // CAPTURE_MAX_FRAME are truncated.
+    void record(CaptureDirection direction, const uint8_t* frame, size_t len, int rssi = 0,
+                float snr = 0.0f);
+
+    // Record with an explicit time (e.g. synthesized or rescaled traffic);
+    // times must not decrease
+    bool write(const CaptureRecord& record);
+
+    uint64_t records() const { return records_.load(std::memory_order_relaxed); }
+
+private:
+    void append(const CaptureRecord& record);
+    void flushLocked();
+
+    std::mutex mutex_;
+    std::FILE* file_;
+    std::vector<uint8_t> buffer_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point last_flush_;
+    uint64_t last_us_;
+    std::atomic<bool> open_;
+    std::atomic<uint64_t> records_;
+};
+
+// Reads a capture file record by record
+class MeshCaptureReader {
+public:
+    MeshCaptureReader();
+    ~MeshCaptureReader();
+
+    MeshCaptureReader(const MeshCaptureReader&) = delete;
+    MeshCaptureReader& operator=(const MeshCaptureReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Next record, or false at the end (or on a truncated record, which
+    // is what a capture cut short by power loss ends with)
+    bool next(CaptureRecord& record);
+
+    uint8_t nodeId() const { return node_id_; }
+    int64_t startUnixNs() const { return start_unix_ns_; }
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    std::FILE* file_;
+    uint8_t node_id_;
+    int64_t start_unix_ns_;
+    uint64_t time_us_;
+    uint8_t frame_[CAPTURE_MAX_FRAME];
+    std::string last_error_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_MESH_CAPTURE_H
\ No newline at end of file
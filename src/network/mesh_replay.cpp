@@ -0,0 +1,163 @@
+#include "network/mesh_replay.h"
+#include "network/lora_mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace sentinel {
+
+bool MeshReplay::load(const std::string& path) {
+    MeshCaptureReader reader;
+    if (!reader.open(path)) {
+        last_error_ = reader.getLastError();
+        return false;
+    }
+    frames_.clear();
+    data_.clear();
+
+    CaptureRecord record;
+    while (reader.next(record)) {
+        add(record);
+    }
+    return true;
+}
+
+void MeshReplay::add(const CaptureRecord& record) {
+    Frame frame;
+    frame.time_us = record.time_us;
+    frame.direction = record.direction;
+    frame.rssi = static_cast<int16_t>(record.rssi);
+    frame.snr = record.snr;
+    frame.offset = static_cast<uint32_t>(data_.size());
+    frame.len = static_cast<uint8_t>(std::min(record.len, CAPTURE_MAX_FRAME));
+    data_.insert(data_.end(), record.data, record.data + frame.len);
+    frames_.push_back(frame);
+}
+
+bool MeshReplay::save(const std::string& path, uint8_t node_id) const {
+    MeshCaptureWriter writer;
+    if (!writer.open(path, node_id)) {
+        return false;
+    }
+    for (const Frame& frame : frames_) {
+        CaptureRecord record;
+        record.time_us = frame.time_us;
+        record.direction = frame.direction;
+        record.rssi = frame.rssi;
+        record.snr = frame.snr;
+        record.data = data_.data() + frame.offset;
+        record.len = frame.len;
+        writer.write(record);
+    }
+    writer.close();
+    return true;
+}
+
+size_t MeshReplay::receivedCount() const {
+    return std::count_if(frames_.begin(), frames_.end(), [](const Frame& frame) {
+        return frame.direction == CaptureDirection::RX;
+    });
+}
+
+MeshReplay MeshReplay::scaled(int factor, uint8_t self_id) const {
+    MeshReplay result;
+    factor = std::max(1, factor);
+
+    // Received frames only; the capturing node's own traffic does not scale
+    std::vector<const Frame*> received;
+    for (const Frame& frame : frames_) {
+        if (frame.direction == CaptureDirection::RX) {
+            received.push_back(&frame);
+        }
+    }
+
+    // Copies are interleaved with later originals, so collect and sort
+    struct Pending {
+        uint64_t time_us;
+        size_t source;               // Index into received
+        int copy;
+    };
+    std::vector<Pending> pending;
+    pending.reserve(received.size() * factor);
+    for (size_t i = 0; i < received.size(); i++) {
+        uint64_t gap = i + 1 < received.size() ?
+                       received[i + 1]->time_us - received[i]->time_us : 1000;
+        for (int copy = 0; copy < factor; copy++) {
+            pending.push_back({received[i]->time_us + gap * copy / factor, i, copy});
+        }
+    }
+    std::stable_sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.time_us < b.time_us;
+    });
+
+    uint8_t buffer[CAPTURE_MAX_FRAME];
+    for (const Pending& item : pending) {
+        const Frame& source = *received[item.source];
+        std::copy(data_.begin() + source.offset, data_.begin() + source.offset + source.len,
+                  buffer);
+
+        // Wire format: type, source, destination, length, payload, XOR
+        // checksum. Move copies to another sender, skipping 0, 0xFF and
+        // the replaying node, and fix up the checksum.
+        if (item.copy > 0 && source.len >= 5) {
+            int id = buffer[1];
+            for (int step = 0; step < item.copy; step++) {
+                do {
+                    id = id % 254 + 1;
+                } while (id == self_id);
+            }
+            buffer[1] = static_cast<uint8_t>(id);
+            uint8_t checksum = 0;
+            for (size_t i = 0; i + 1 < source.len; i++) {
+                checksum ^= buffer[i];
+            }
+            buffer[source.len - 1] = checksum;
+        }
+
+        CaptureRecord record;
+        record.time_us = item.time_us;
+        record.direction = CaptureDirection::RX;
+        record.rssi = source.rssi;
+        record.snr = source.snr;
+        record.data = buffer;
+        record.len = source.len;
+        result.add(record);
+    }
+    return result;
+}
+
+ReplayStats MeshReplay::run(LoraMesh& mesh, double speed) const {
+    using Clock = std::chrono::steady_clock;
+    ReplayStats stats;
+    if (frames_.empty()) {
+        return stats;
+    }
+
+    const uint64_t first_us = frames_.front().time_us;
+    auto start = Clock::now();
+    for (const Frame& frame : frames_) {
+        if (frame.direction != CaptureDirection::RX) {
+            continue;
+        }
+        if (speed > 0.0) {
+            auto due = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::micro>((frame.time_us - first_us) / speed));
+            auto now = Clock::now();
+            if (now < due) {
+                std::this_thread::sleep_until(due);
+            } else {
+                stats.max_lag_ms = std::max(stats.max_lag_ms,
+                    std::chrono::duration<double, std::milli>(now - due).count());
+            }
+        }
+        mesh.receiveFrame(data_.data() + frame.offset, frame.len, frame.rssi, frame.snr);
+        stats.frames++;
+    }
+
+    stats.elapsed_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    stats.capture_sec = (frames_.back().time_us - first_us) / 1e6;
+    stats.frames_per_sec = stats.elapsed_sec > 0.0 ? stats.frames / stats.elapsed_sec : 0.0;
+    return stats;
+}
+
+} // namespace sentinel
\ No newline at end of file
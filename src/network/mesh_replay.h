@@ -0,0 +1,67 @@
+#ifndef SENTINEL_MESH_REPLAY_H
+#define SENTINEL_MESH_REPLAY_H
+
+#include "network/mesh_capture.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sentinel {
+
+class LoraMesh;
+
+struct ReplayStats {
+    uint64_t frames = 0;             // Frames fed to the mesh
+    double capture_sec = 0.0;        // Span of the traffic replayed
+    double elapsed_sec = 0.0;        // Wall time taken
+    double frames_per_sec = 0.0;
+    double max_lag_ms = 0.0;         // Worst lateness against the schedule (timed replay)
+};
+
+// Feeds received frames from a capture back into a LoraMesh through
+// receiveFrame(), the path radio frames take, for load and regression
+// tests. Transmitted frames are kept for inspection but not replayed.
+class MeshReplay {
+public:
+    // Load every record of a capture into memory
+    bool load(const std::string& path);
+
+    // Add a frame (synthesized traffic); times must not decrease
+    void add(const CaptureRecord& record);
+
+    // Write the frames to a new capture file
+    bool save(const std::string& path, uint8_t node_id) const;
+
+    // N-times-denser traffic: each received frame is followed by
+    // factor - 1 copies from other node ids, spread evenly over the gap to
+    // the next received frame. Copies get new source ids and checksums;
+    // with 8-bit node ids, more than 253 distinct senders wrap around.
+    MeshReplay scaled(int factor, uint8_t self_id) const;
+
+    // Replay received frames into mesh. speed 1 is real time, 10 ten times
+    // faster, 0 as fast as possible (receive-path throughput).
+    ReplayStats run(LoraMesh& mesh, double speed) const;
+
+    size_t size() const { return frames_.size(); }
+    size_t receivedCount() const;
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    struct Frame {
+        uint64_t time_us;
+        CaptureDirection direction;
+        int16_t rssi;
+        float snr;
+        uint32_t offset;             // Into data_
+        uint8_t len;
+    };
+
+    std::vector<Frame> frames_;
+    std::vector<uint8_t> data_;
+    std::string last_error_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_MESH_REPLAY_H
\ No newline at end of file
@@ -0,0 +1,669 @@
+#include "network/mesh_transfer.h"
+#include "utils/checksum.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace sentinel {
+
+namespace {
+
+constexpr uint8_t OBJECT_FORMAT = 1;
+
+// Advert: the version of every kind, little-endian
+constexpr size_t ADVERT_LEN = 4 * static_cast<size_t>(TransferKind::COUNT);
+
+void put16(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put24(uint8_t* p, uint32_t v) {
+    put16(p, v);
+    p[2] = static_cast<uint8_t>(v >> 16);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+
+uint32_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t get24(const uint8_t* p) {
+    return get16(p) | (static_cast<uint32_t>(p[2]) << 16);
+}
+
+uint32_t get32(const uint8_t* p) {
+    return get16(p) | (get16(p + 2) << 16);
+}
+
+void put64(uint8_t* p, uint64_t v) {
+    put32(p, static_cast<uint32_t>(v));
+    put32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+uint64_t get64(const uint8_t* p) {
+    return get32(p) | (static_cast<uint64_t>(get32(p + 4)) << 32);
+}
+
+// Kind, version and packet index at the start of requests and data
+void putFrameHeader(uint8_t* p, size_t kind, uint32_t version, size_t packet) {
+    p[0] = static_cast<uint8_t>(kind);
+    put32(p + 1, version);
+    put24(p + 5, static_cast<uint32_t>(packet));
+}
+
+} // namespace
+
+MeshTransfer::MeshTransfer(uint32_t seed)
+    : trickle_(seed),
+      request_timeout_(std::chrono::seconds(10)),
+      packet_gap_(std::chrono::seconds(1)),
+      started_(false),
+      changed_(false),
+      rejected_(),
+      data_kind_(0),
+      key_(),
+      rng_(~seed ? ~seed : 1),
+      stats_() {
+}
+
+void MeshTransfer::configure(Clock::duration advert_imin, Clock::duration advert_imax,
+                             int redundancy, Clock::duration request_timeout,
+                             Clock::duration packet_gap) {
+    // Adverts only carry news, so a node may stay quiet indefinitely
+    trickle_.configure(advert_imin, advert_imax, redundancy, std::numeric_limits<int>::max());
+    request_timeout_ = request_timeout;
+    packet_gap_ = packet_gap;
+}
+
+std::vector<uint8_t> MeshTransfer::buildObject(TransferKind kind, uint32_t version,
+                                               const uint8_t* data, size_t len, const Key& key) {
+    std::vector<ContentChunk> chunks = chunkContent(data, len);
+    std::vector<uint8_t> object(HEADER_SIZE + chunks.size() * MANIFEST_ENTRY_SIZE + len);
+    uint8_t* p = object.data();
+    p[0] = OBJECT_FORMAT;
+    p[1] = static_cast<uint8_t>(kind);
+    put16(p + 2, static_cast<uint32_t>(chunks.size()));
+    put32(p + 4, static_cast<uint32_t>(len));
+    put64(p + 8, siphash24(key.data(), data, len));
+    put64(p + 16, headerMac(key, version, p));
+    p += HEADER_SIZE;
+    for (const ContentChunk& chunk : chunks) {
+        put32(p, chunk.hash);
+        put16(p + 4, chunk.length);
+        p += MANIFEST_ENTRY_SIZE;
+    }
+    if (len > 0) {
+        std::memcpy(p, data, len);
+    }
+    return object;
+}
+
+bool MeshTransfer::parseKey(const std::string& text, Key& key) {
+    if (text.size() != 2 * key.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        int digit = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+        if (digit < 0) {
+            return false;
+        }
+        key[i / 2] = static_cast<uint8_t>(i % 2 ? key[i / 2] << 4 | digit : digit);
+    }
+    return true;
+}
+
+uint64_t MeshTransfer::headerMac(const Key& key, uint32_t version, const uint8_t* header) {
+    // The version is not in the object, but must not be forged either
+    uint8_t message[4 + 16];
+    put32(message, version);
+    std::memcpy(message + 4, header, 16);
+    return siphash24(key.data(), message, sizeof(message));
+}
+
+const uint8_t* MeshTransfer::fileData(const std::vector<uint8_t>& object, size_t& len) {
+    if (object.size() < HEADER_SIZE) {
+        len = 0;
+        return nullptr;
+    }
+    len = get32(object.data() + 4);
+    return object.data() + HEADER_SIZE + get16(object.data() + 2) * MANIFEST_ENTRY_SIZE;
+}
+
+void MeshTransfer::index(Held& held) {
+    held.chunks.clear();
+    const uint8_t* p = held.object.data();
+    size_t count = get16(p + 2);
+    held.chunks.reserve(count);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = p + HEADER_SIZE + i * MANIFEST_ENTRY_SIZE;
+        ContentChunk chunk{offset, get16(entry + 4), get32(entry)};
+        held.chunks.emplace(chunk.hash, chunk);
+        offset += chunk.length;
+    }
+    size_t packets = (held.object.size() + PACKET_SIZE - 1) / PACKET_SIZE;
+    held.pending.assign(packets, false);
+    held.pending_count = 0;
+    held.cursor = 0;
+    held.loaded = true;
+}
+
+size_t MeshTransfer::packetLength(size_t object_size, size_t packet) {
+    return std::min(PACKET_SIZE, object_size - packet * PACKET_SIZE);
+}
+
+bool MeshTransfer::setFile(TransferKind kind, uint32_t version, const uint8_t* data, size_t len) {
+    size_t k = static_cast<size_t>(kind);
+    if (k >= KINDS || len > MAX_FILE_SIZE) {
+        return false;
+    }
+    Held& held = held_[k];
+    held.version = version;
+    held.object = buildObject(kind, version, data, len, key_);
+    index(held);
+
+    // A fetch of this version or an older one is moot now
+    Incoming& in = incoming_[k];
+    if (in.version != 0 && in.version <= version) {
+        in = Incoming();
+    }
+    changed_ = version != 0;
+    return true;
+}
+
+void MeshTransfer::setKey(const Key& key) {
+    key_ = key;
+    for (size_t k = 0; k < KINDS; k++) {
+        Held& held = held_[k];
+        if (held.loaded) {
+            size_t len;
+            const uint8_t* data = fileData(held.object, len);
+            std::vector<uint8_t> file(data, data + len);
+            held.object = buildObject(static_cast<TransferKind>(k), held.version, file.data(),
+                                      file.size(), key_);
+            index(held);
+        }
+    }
+}
+
+void MeshTransfer::start(Clock::time_point now) {
+    trickle_.start(now);
+    next_data_ = now;
+    started_ = true;
+}
+
+uint32_t MeshTransfer::version(TransferKind kind) const {
+    return held_[static_cast<size_t>(kind)].version;
+}
+
+const uint8_t* MeshTransfer::file(TransferKind kind, size_t& len) const {
+    return fileData(held_[static_cast<size_t>(kind)].object, len);
+}
+
+TransferProgress MeshTransfer::progress(TransferKind kind) const {
+    const Incoming& in = incoming_[static_cast<size_t>(kind)];
+    return {in.version, in.packets, in.have};
+}
+
+bool MeshTransfer::takeCompleted(TransferKind& kind, uint32_t& version) {
+    if (completed_.empty()) {
+        return false;
+    }
+    kind = completed_.front();
+    completed_.erase(completed_.begin());
+    version = held_[static_cast<size_t>(kind)].version;
+    return true;
+}
+
+void MeshTransfer::receive(uint8_t type, int source, bool addressed, const uint8_t* payload,
+                           size_t len, Clock::time_point now) {
+    switch (type) {
+        case FRAME_ADVERT:
+            hearAdvert(source, payload, len, now);
+            break;
+        case FRAME_REQUEST:
+            hearRequest(source, addressed, payload, len, now);
+            break;
+        case FRAME_DATA:
+            hearData(source, payload, len, now);
+            break;
+        default:
+            break;
+    }
+}
+
+void MeshTransfer::hearAdvert(int source, const uint8_t* payload, size_t len,
+                              Clock::time_point now) {
+    if (len < ADVERT_LEN) {
+        return;
+    }
+    bool consistent = true;
+    for (size_t k = 0; k < KINDS; k++) {
+        uint32_t theirs = get32(payload + 4 * k);
+        uint32_t ours = held_[k].version;
+        if (theirs == ours) {
+            continue;
+        }
+        // Older: they will ask us once they hear our advert
+        consistent = false;
+        if (theirs < ours || theirs == rejected_[k]) {
+            continue;
+        }
+        // A fetch with advertisers keeps going whatever else is heard;
+        // one that ran out of them gives way to any newer version
+        Incoming& in = incoming_[k];
+        if (in.version == theirs) {
+            addHolder(in, source);
+            if (in.server < 0) {
+                in.server = source;
+                in.stalls = 0;
+                in.next_request = now + backoff();
+            }
+        } else if (in.version == 0 || in.server < 0) {
+            beginIncoming(k, theirs, source, now);
+        }
+    }
+    if (consistent) {
+        trickle_.hearConsistent();
+    } else {
+        trickle_.reset(now);
+    }
+}
+
+void MeshTransfer::hearRequest(int source, bool addressed, const uint8_t* payload, size_t len,
+                               Clock::time_point now) {
+    (void)source;
+    if (len < FRAME_HEADER || payload[0] >= KINDS) {
+        return;
+    }
+    size_t k = payload[0];
+    uint32_t version = get32(payload + 1);
+    size_t base = get24(payload + 5);
+    const uint8_t* bitmap = payload + FRAME_HEADER;
+    size_t bits = (len - FRAME_HEADER) * 8;
+
+    Held& held = held_[k];
+    if (addressed) {
+        if (held.version == 0 || version != held.version) {
+            return;
+        }
+        size_t packets = held.pending.size();
+        for (size_t i = 0; i < bits && base + i < packets; i++) {
+            if (((bitmap[i / 8] >> (i % 8)) & 1) && !held.pending[base + i]) {
+                held.pending[base + i] = true;
+                held.pending_count++;
+            }
+        }
+        return;
+    }
+
+    // A neighbour on the same version asked: what it gets, we hear too
+    Incoming& in = incoming_[k];
+    if (in.version != 0 && version == in.version) {
+        in.next_request = std::max(in.next_request, now + request_timeout_ + backoff());
+    }
+}
+
+void MeshTransfer::hearData(int source, const uint8_t* payload, size_t len,
+                            Clock::time_point now) {
+    (void)source;
+    if (len < FRAME_HEADER || payload[0] >= KINDS) {
+        return;
+    }
+    size_t k = payload[0];
+    uint32_t version = get32(payload + 1);
+    size_t packet = get24(payload + 5);
+
+    // Someone else answered: no need to send it again
+    Held& held = held_[k];
+    if (held.version != 0 && version == held.version && packet < held.pending.size() &&
+        held.pending[packet]) {
+        held.pending[packet] = false;
+        held.pending_count--;
+    }
+
+    Incoming& in = incoming_[k];
+    if (in.version == 0 || version != in.version) {
+        return;
+    }
+    // Data still flowing: wait for it to end before asking again. Every
+    // neighbour heard the same frame, so each waits a little differently.
+    in.next_request = now + request_timeout_ + backoff();
+    storePacket(k, packet, payload + FRAME_HEADER, len - FRAME_HEADER, now);
+}
+
+void MeshTransfer::beginIncoming(size_t kind, uint32_t version, int source,
+                                 Clock::time_point now) {
+    Incoming& in = incoming_[kind];
+    in = Incoming();
+    in.version = version;
+    in.server = source;
+    addHolder(in, source);
+    in.next_request = now + backoff();
+}
+
+void MeshTransfer::addHolder(Incoming& in, int source) {
+    auto end = in.holders.begin() + in.holder_count;
+    auto it = std::find(in.holders.begin(), end, source);
+    if (it == end) {
+        in.holder_count = std::min(in.holder_count + 1, in.holders.size());
+        it = in.holders.begin() + in.holder_count - 1;
+    }
+    // Most recent first
+    std::rotate(in.holders.begin(), it, it + 1);
+    in.holders[0] = source;
+}
+
+bool MeshTransfer::readHeader(size_t kind, const uint8_t* data, size_t len) {
+    if (len < HEADER_SIZE || data[0] != OBJECT_FORMAT || data[1] != kind) {
+        return false;
+    }
+    Incoming& in = incoming_[kind];
+    if (get64(data + 16) != headerMac(key_, in.version, data)) {
+        stats_.verify_failures++;
+        return false;
+    }
+    size_t chunks = get16(data + 2);
+    size_t size = get32(data + 4);
+    if (size > MAX_FILE_SIZE) {
+        return false;
+    }
+    size_t manifest_end = HEADER_SIZE + chunks * MANIFEST_ENTRY_SIZE;
+    in.object.assign(manifest_end + size, 0);
+    in.packets = (in.object.size() + PACKET_SIZE - 1) / PACKET_SIZE;
+    in.filled.assign(in.packets, 0);
+    in.manifest_packets = (manifest_end + PACKET_SIZE - 1) / PACKET_SIZE;
+    return true;
+}
+
+void MeshTransfer::storePacket(size_t kind, size_t packet, const uint8_t* data, size_t len,
+                               Clock::time_point now) {
+    Incoming& in = incoming_[kind];
+    if (in.packets == 0) {
+        // Nothing makes sense before the header
+        if (packet != 0 || !readHeader(kind, data, len)) {
+            return;
+        }
+    }
+    if (packet >= in.packets || len != packetLength(in.object.size(), packet)) {
+        return;
+    }
+    if (in.filled[packet] == len) {
+        stats_.data_duplicates++;
+        return;
+    }
+    std::memcpy(in.object.data() + packet * PACKET_SIZE, data, len);
+    in.filled[packet] = static_cast<uint8_t>(len);
+    in.have++;
+    stats_.data_received++;
+
+    if (!in.manifest_done && packet < in.manifest_packets &&
+        std::all_of(in.filled.begin(), in.filled.begin() + in.manifest_packets,
+                    [](uint8_t f) { return f != 0; })) {
+        copyLocalChunks(kind);
+    }
+    if (in.have == in.packets) {
+        finish(kind, now);
+    }
+}
+
+void MeshTransfer::copyLocalChunks(size_t kind) {
+    Incoming& in = incoming_[kind];
+    const Held& held = held_[kind];
+    in.manifest_done = true;
+    if (!in.local_chunks || !held.loaded) {
+        return;
+    }
+
+    size_t local_len;
+    const uint8_t* local = fileData(held.object, local_len);
+    size_t count = get16(in.object.data() + 2);
+    size_t offset = HEADER_SIZE + count * MANIFEST_ENTRY_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* entry = in.object.data() + HEADER_SIZE + i * MANIFEST_ENTRY_SIZE;
+        uint32_t hash = get32(entry);
+        size_t length = get16(entry + 4);
+        auto range = held.chunks.equal_range(hash);
+        auto match = std::find_if(range.first, range.second, [&](const auto& pair) {
+            return pair.second.length == length;
+        });
+        if (match != range.second && offset + length <= in.object.size()) {
+            std::memcpy(in.object.data() + offset, local + match->second.offset, length);
+            stats_.deduplicated_bytes += length;
+            in.deduplicated = true;
+
+            // Count the bytes into every packet the chunk touches
+            for (size_t p = offset / PACKET_SIZE; p * PACKET_SIZE < offset + length; p++) {
+                size_t full = packetLength(in.object.size(), p);
+                if (in.filled[p] == full) {
+                    continue;
+                }
+                size_t begin = std::max(offset, p * PACKET_SIZE);
+                size_t end = std::min(offset + length, p * PACKET_SIZE + full);
+                in.filled[p] = static_cast<uint8_t>(in.filled[p] + (end - begin));
+                if (in.filled[p] == full) {
+                    in.have++;
+                }
+            }
+        }
+        offset += length;
+    }
+}
+
+void MeshTransfer::finish(size_t kind, Clock::time_point now) {
+    Incoming& in = incoming_[kind];
+    size_t len;
+    const uint8_t* data = fileData(in.object, len);
+    if (siphash24(key_.data(), data, len) != get64(in.object.data() + 8)) {
+        stats_.verify_failures++;
+        if (in.deduplicated) {
+            // A local chunk with the same CRC held other bytes: fetch the
+            // whole file, keeping the header and manifest
+            in.local_chunks = false;
+            in.deduplicated = false;
+            size_t first = (data - in.object.data()) / PACKET_SIZE;
+            for (size_t p = first; p < in.packets; p++) {
+                if (in.filled[p] == packetLength(in.object.size(), p)) {
+                    in.have--;
+                }
+                in.filled[p] = 0;
+            }
+            in.stalls = 0;
+            in.next_request = now;
+            return;
+        }
+        rejected_[kind] = in.version;
+        in = Incoming();
+        return;
+    }
+
+    Held& held = held_[kind];
+    held.version = in.version;
+    held.object = std::move(in.object);
+    index(held);
+    in = Incoming();
+    stats_.completed++;
+    completed_.push_back(static_cast<TransferKind>(kind));
+
+    // News for the neighbours still on the old version
+    trickle_.reset(now);
+}
+
+bool MeshTransfer::poll(Clock::time_point now, Frame& frame) {
+    if (!started_) {
+        return false;
+    }
+    if (changed_) {
+        changed_ = false;
+        trickle_.reset(now);
+    }
+
+    // Adverts, except while fetching: the requests speak for us then
+    TrickleTimer::Action action = trickle_.poll(now);
+    bool fetching = std::any_of(incoming_.begin(), incoming_.end(),
+                                [](const Incoming& in) { return in.version != 0; });
+    if (action == TrickleTimer::Action::TRANSMIT && !fetching) {
+        frame.type = FRAME_ADVERT;
+        frame.destination = -1;
+        frame.len = ADVERT_LEN;
+        for (size_t k = 0; k < KINDS; k++) {
+            put32(frame.payload + 4 * k, held_[k].version);
+        }
+        stats_.adverts_sent++;
+        stats_.bytes_sent += frame.len;
+        return true;
+    }
+    if (action == TrickleTimer::Action::SUPPRESS) {
+        stats_.adverts_suppressed++;
+    }
+
+    for (size_t k = 0; k < KINDS; k++) {
+        if (buildRequest(k, now, frame)) {
+            return true;
+        }
+    }
+    if (now >= next_data_) {
+        for (size_t i = 0; i < KINDS; i++) {
+            size_t k = (data_kind_ + i) % KINDS;
+            if (buildData(k, frame)) {
+                data_kind_ = k + 1;
+                // Up to half a gap more: two servers that cannot hear each
+                // other would otherwise collide at a common neighbour in
+                // lockstep
+                next_data_ = now + packet_gap_ + random(packet_gap_ / 2);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool MeshTransfer::buildRequest(size_t kind, Clock::time_point now, Frame& frame) {
+    Incoming& in = incoming_[kind];
+    if (in.version == 0 || in.server < 0 || now < in.next_request) {
+        return false;
+    }
+
+    // No progress since the last request: try another advertiser, or wait
+    // for the next advert
+    if (in.requested && in.have == in.have_at_request) {
+        if (++in.stalls >= STALL_LIMIT) {
+            in.stalls = 0;
+            auto end = in.holders.begin() + in.holder_count;
+            auto other = std::find_if(in.holders.begin(), end,
+                                      [&](int holder) { return holder != in.server; });
+            in.server = other != end ? *other : -1;
+            if (in.server < 0) {
+                // Without a valid header the version may not exist at
+                // all: listen to every advert again
+                if (in.packets == 0) {
+                    in = Incoming();
+                }
+                return false;
+            }
+        }
+    } else {
+        in.stalls = 0;
+    }
+
+    // Header first, then the manifest, then whatever local chunks left
+    size_t scope = in.packets == 0 ? 1 : !in.manifest_done ? in.manifest_packets : in.packets;
+    size_t base = 0;
+    while (in.packets > 0 && base < scope &&
+           in.filled[base] == packetLength(in.object.size(), base)) {
+        base++;
+    }
+    if (base >= scope) {
+        return false;
+    }
+    size_t window = std::min(REQUEST_WINDOW, scope - base);
+    size_t bytes = 0;
+    std::memset(frame.payload + FRAME_HEADER, 0, (window + 7) / 8);
+    for (size_t i = 0; i < window; i++) {
+        size_t p = base + i;
+        if (in.packets == 0 || in.filled[p] != packetLength(in.object.size(), p)) {
+            frame.payload[FRAME_HEADER + i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+            bytes = i / 8 + 1;
+        }
+    }
+    frame.type = FRAME_REQUEST;
+    frame.destination = in.server;
+    frame.len = FRAME_HEADER + bytes;
+    putFrameHeader(frame.payload, kind, in.version, base);
+
+    in.requested = true;
+    in.have_at_request = in.have;
+    in.next_request = now + request_timeout_ + backoff();
+    stats_.requests_sent++;
+    stats_.bytes_sent += frame.len;
+    return true;
+}
+
+bool MeshTransfer::buildData(size_t kind, Frame& frame) {
+    Held& held = held_[kind];
+    if (held.pending_count == 0) {
+        return false;
+    }
+    size_t packets = held.pending.size();
+    size_t p = held.cursor;
+    while (!held.pending[p]) {
+        p = (p + 1) % packets;
+    }
+    held.pending[p] = false;
+    held.pending_count--;
+    held.cursor = (p + 1) % packets;
+
+    size_t len = packetLength(held.object.size(), p);
+    frame.type = FRAME_DATA;
+    frame.destination = -1;
+    frame.len = FRAME_HEADER + len;
+    putFrameHeader(frame.payload, kind, held.version, p);
+    std::memcpy(frame.payload + FRAME_HEADER, held.object.data() + p * PACKET_SIZE, len);
+    stats_.data_sent++;
+    stats_.bytes_sent += frame.len;
+    return true;
+}
+
+MeshTransfer::Clock::time_point MeshTransfer::nextDue() const {
+    Clock::time_point due = trickle_.nextDue();
+    for (size_t k = 0; k < KINDS; k++) {
+        const Incoming& in = incoming_[k];
+        if (in.version != 0 && in.server >= 0) {
+            due = std::min(due, in.next_request);
+        }
+        if (held_[k].pending_count > 0) {
+            due = std::min(due, next_data_);
+        }
+    }
+    return due;
+}
+
+MeshTransfer::Clock::duration MeshTransfer::backoff() {
+    // Up to one request timeout, so neighbours that heard the same advert
+    // do not all ask at once and most can ride on the first request
+    return random(request_timeout_);
+}
+
+MeshTransfer::Clock::duration MeshTransfer::random(Clock::duration limit) {
+    auto ticks = static_cast<uint64_t>(std::max<Clock::rep>(limit.count(), 1));
+    uint64_t value = static_cast<uint64_t>(next()) << 32 | next();
+    return Clock::duration(static_cast<Clock::rep>(value % ticks));
+}
+
+uint32_t MeshTransfer::next() {
+    // xorshift32, as TrickleTimer
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return rng_;
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,232 @@
+#ifndef SENTINEL_MESH_TRANSFER_H
+#define SENTINEL_MESH_TRANSFER_H
+
+#include "network/trickle_timer.h"
+#include "utils/content_chunker.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sentinel {
+
+// Files distributed over the mesh
+enum class TransferKind : uint8_t {
+    MODEL = 0,                       // The .tflite at vision.model_path
+    CONFIG,                          // Shared configuration (JSON)
+    COUNT
+};
+
+struct MeshTransferStats {
+    uint64_t adverts_sent;
+    uint64_t adverts_suppressed;     // Redundant (Trickle)
+    uint64_t requests_sent;
+    uint64_t data_sent;
+    uint64_t data_received;          // Packets we were missing
+    uint64_t data_duplicates;        // Overheard packets we already had
+    uint64_t bytes_sent;             // Payload bytes of all the frames above
+    uint64_t completed;              // Verified files
+    uint64_t verify_failures;        // Header or file MAC mismatches
+    uint64_t deduplicated_bytes;     // File bytes found in local chunks, not fetched
+};
+
+struct TransferProgress {
+    uint32_t version;                // 0 = nothing in progress
+    size_t packets;                  // 0 until the header arrived
+    size_t have;
+};
+
+// Distributes files (model, config) through the mesh, Deluge style:
+//
+// - Every node advertises the version of each file it holds on its own
+//   Trickle timer. A neighbour with an older version makes the advert
+//   inconsistent, so news spreads at the shortest interval and settles to
+//   the longest one.
+// - A file travels as an object: a 24-byte header (kind, chunk count,
+//   size, MAC of the file, MAC of the header and version), a manifest of
+//   the file's content-defined chunks (CRC-32 and length each), then the
+//   file. The object is cut into PACKET_SIZE packets. MACs are SipHash-2-4
+//   under the mesh key, so only key holders can publish a version.
+// - A node that hears a newer version asks the advertiser for the header,
+//   then the manifest. It copies every chunk it already holds (same CRC
+//   and length in its current file) into place, and requests only the
+//   packets still missing. A retrained model that keeps most weights
+//   costs little more than its changed chunks.
+// - Requests carry a bitmap of missing packets. The server broadcasts the
+//   union of what it was asked for, paced to packet_gap, and every
+//   neighbour on the same version keeps what it misses, so one
+//   retransmission serves them all. Overheard requests and data postpone
+//   a node's own request; a server that overhears another sending a packet
+//   drops it from its own queue.
+// - A node with no progress after STALL_LIMIT requests turns to another
+//   advertiser. A header whose MAC does not match is dropped. A fetch
+//   whose advertisers run out before a valid header arrived is dropped
+//   too, so an advert alone cannot hold a node on a version nobody can
+//   serve, and while a fetch has no advertiser left any newer version
+//   replaces it. Versions only order updates; the MACs decide what is
+//   installed.
+// - The finished file must match the header's MAC. If it does not and
+//   local chunks were used, the node fetches the whole file; otherwise
+//   the version is rejected.
+//
+// Like TrickleTimer it has no clock or radio of its own: the caller
+// passes the time, hands over received frames and sends what poll()
+// returns, so the same code runs on LoraMesh and in the mesh simulator.
+// Not thread-safe.
+class MeshTransfer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint8_t FRAME_ADVERT = 0x07;
+    static constexpr uint8_t FRAME_REQUEST = 0x08;
+    static constexpr uint8_t FRAME_DATA = 0x09;
+
+    static constexpr size_t HEADER_SIZE = 24;
+    static constexpr size_t KEY_SIZE = 16;
+    static constexpr size_t MANIFEST_ENTRY_SIZE = 6;
+    static constexpr size_t PACKET_SIZE = 56;
+    static constexpr size_t REQUEST_WINDOW = 448;        // Packets per request bitmap
+    static constexpr size_t MAX_FILE_SIZE = 8u << 20;
+    static constexpr int STALL_LIMIT = 3;                // Requests without progress
+    static constexpr size_t FRAME_HEADER = 8;            // Kind, version, packet (24-bit)
+    static constexpr size_t MAX_FRAME_PAYLOAD = FRAME_HEADER + PACKET_SIZE;
+
+    using Key = std::array<uint8_t, KEY_SIZE>;
+
+    struct Frame {
+        uint8_t type;
+        int destination;                 // -1 = broadcast
+        size_t len;
+        uint8_t payload[MAX_FRAME_PAYLOAD];
+    };
+
+    // seed: per node, for the Trickle timer and request backoff
+    explicit MeshTransfer(uint32_t seed = 1);
+
+    // Adverts follow a Trickle timer from advert_imin to advert_imax.
+    // request_timeout: quiet time after the last useful packet before
+    // asking again. packet_gap: time between two data frames this node
+    // sends (airtime over the duty share).
+    void configure(Clock::duration advert_imin, Clock::duration advert_imax, int redundancy,
+                   Clock::duration request_timeout, Clock::duration packet_gap);
+
+    // Mesh key for the MACs. Files already held are sealed again.
+    void setKey(const Key& key);
+
+    // The file this node holds: advertised and served from now on, and the
+    // source of local chunks for the next version. version 0 keeps the
+    // content as a chunk source only and advertises nothing.
+    bool setFile(TransferKind kind, uint32_t version, const uint8_t* data, size_t len);
+
+    // Start advertising
+    void start(Clock::time_point now);
+
+    // A frame heard on the air; addressed: to this node rather than
+    // overheard or broadcast
+    void receive(uint8_t type, int source, bool addressed, const uint8_t* payload, size_t len,
+                 Clock::time_point now);
+
+    // One frame to send now, if any; call until it returns false
+    bool poll(Clock::time_point now, Frame& frame);
+
+    // When poll() may next have something to send
+    Clock::time_point nextDue() const;
+
+    // A file finished and verified since the last call. The file itself is
+    // file(kind) until the next setFile() or completed transfer.
+    bool takeCompleted(TransferKind& kind, uint32_t& version);
+
+    uint32_t version(TransferKind kind) const;
+    const uint8_t* file(TransferKind kind, size_t& len) const;
+    TransferProgress progress(TransferKind kind) const;
+    const MeshTransferStats& stats() const { return stats_; }
+
+    // Key from 32 hex digits (mesh.update_key)
+    static bool parseKey(const std::string& text, Key& key);
+
+    // Header, manifest and file for data, as sent on the air
+    static std::vector<uint8_t> buildObject(TransferKind kind, uint32_t version,
+                                            const uint8_t* data, size_t len, const Key& key);
+
+private:
+    // A file held: its object, and its chunks by CRC for deduplication
+    struct Held {
+        uint32_t version = 0;
+        std::vector<uint8_t> object;
+        std::unordered_multimap<uint32_t, ContentChunk> chunks;
+        std::vector<bool> pending;       // Packets requested from us
+        size_t pending_count = 0;
+        size_t cursor = 0;               // Next packet to consider sending
+        bool loaded = false;
+    };
+
+    // A newer version being fetched
+    struct Incoming {
+        uint32_t version = 0;
+        int server = -1;                 // -1 = waiting for an advert
+        std::array<int, 4> holders{};    // Recent advertisers of this version
+        size_t holder_count = 0;
+        std::vector<uint8_t> object;
+        std::vector<uint8_t> filled;     // Bytes present per packet
+        size_t packets = 0;              // 0 until the header arrived
+        size_t have = 0;                 // Complete packets
+        size_t manifest_packets = 0;
+        bool manifest_done = false;      // Local chunks looked up
+        bool deduplicated = false;       // ...and some copied in
+        bool local_chunks = true;        // Cleared after a failed check
+        size_t have_at_request = 0;
+        bool requested = false;
+        int stalls = 0;
+        Clock::time_point next_request;
+    };
+
+    static constexpr size_t KINDS = static_cast<size_t>(TransferKind::COUNT);
+
+    static size_t packetLength(size_t object_size, size_t packet);
+
+    void hearAdvert(int source, const uint8_t* payload, size_t len, Clock::time_point now);
+    void hearRequest(int source, bool addressed, const uint8_t* payload, size_t len,
+                     Clock::time_point now);
+    void hearData(int source, const uint8_t* payload, size_t len, Clock::time_point now);
+
+    void beginIncoming(size_t kind, uint32_t version, int source, Clock::time_point now);
+    void addHolder(Incoming& in, int source);
+    void storePacket(size_t kind, size_t packet, const uint8_t* data, size_t len,
+                     Clock::time_point now);
+    bool readHeader(size_t kind, const uint8_t* data, size_t len);
+    static uint64_t headerMac(const Key& key, uint32_t version, const uint8_t* header);
+    void copyLocalChunks(size_t kind);
+    void finish(size_t kind, Clock::time_point now);
+    static void index(Held& held);
+    static const uint8_t* fileData(const std::vector<uint8_t>& object, size_t& len);
+
+    bool buildRequest(size_t kind, Clock::time_point now, Frame& frame);
+    bool buildData(size_t kind, Frame& frame);
+    Clock::duration backoff();
+    Clock::duration random(Clock::duration limit);   // Uniform in [0, limit)
+    uint32_t next();
+
+    TrickleTimer trickle_;
+    Clock::duration request_timeout_;
+    Clock::duration packet_gap_;
+    Clock::time_point next_data_;
+    bool started_;
+    bool changed_;                       // New file to announce at the next poll()
+
+    std::array<Held, KINDS> held_;
+    std::array<Incoming, KINDS> incoming_;
+    std::array<uint32_t, KINDS> rejected_;
+    std::vector<TransferKind> completed_;
+    size_t data_kind_;                   // Round robin among kinds with pending data
+
+    Key key_;
+    uint32_t rng_;
+    MeshTransferStats stats_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_MESH_TRANSFER_H
\ No newline at end of file
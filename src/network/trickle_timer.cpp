@@ -0,0 +1,106 @@
+#include "network/trickle_timer.h"
+#include <algorithm>
+
+namespace sentinel {
+
+TrickleTimer::TrickleTimer(uint32_t seed)
+    : imin_(std::chrono::seconds(30)),
+      imax_(std::chrono::seconds(30)),
+      redundancy_(0),
+      max_suppressed_(0),
+      interval_(imin_),
+      point_done_(true),
+      heard_(0),
+      suppressed_run_(0),
+      rng_(seed ? seed : 1),
+      transmitted_(0),
+      suppressed_(0),
+      resets_(0) {
+}
+
+void TrickleTimer::configure(Clock::duration imin, Clock::duration imax, int redundancy,
+                             int max_suppressed) {
+    imin_ = std::max(imin, Clock::duration(std::chrono::milliseconds(1)));
+    imax_ = imin_;
+    while (imax_ * 2 <= imax) {
+        imax_ *= 2;
+    }
+    redundancy_ = std::max(redundancy, 0);
+    max_suppressed_ = std::max(max_suppressed, 0);
+}
+
+void TrickleTimer::start(Clock::time_point now) {
+    interval_ = imin_;
+    suppressed_run_ = 0;
+    beginInterval(now);
+}
+
+void TrickleTimer::reset(Clock::time_point now) {
+    if (interval_ == imin_) {
+        return;
+    }
+    resets_++;
+    interval_ = imin_;
+    beginInterval(now);
+}
+
+TrickleTimer::Action TrickleTimer::poll(Clock::time_point now) {
+    // Polled late, several points may have passed; one transmission
+    // covers them all
+    Action action = Action::NONE;
+    for (;;) {
+        if (!point_done_ && now >= point_) {
+            point_done_ = true;
+            bool redundant = redundancy_ > 0 && heard_ >= redundancy_ &&
+                             suppressed_run_ < max_suppressed_;
+            if (redundant) {
+                suppressed_run_++;
+                suppressed_++;
+                action = action == Action::TRANSMIT ? action : Action::SUPPRESS;
+            } else {
+                suppressed_run_ = 0;
+                transmitted_++;
+                action = Action::TRANSMIT;
+            }
+        }
+        Clock::time_point end = interval_start_ + interval_;
+        if (now < end) {
+            return action;
+        }
+        interval_ = std::min(interval_ * 2, imax_);
+        beginInterval(end);
+    }
+}
+
+TrickleTimer::Clock::time_point TrickleTimer::nextDue() const {
+    Clock::time_point end = interval_start_ + interval_;
+    return point_done_ ? end : std::min(point_, end);
+}
+
+TrickleTimer::Clock::duration TrickleTimer::silenceBound() const {
+    // Sent at the start of one point range, then max_suppressed intervals
+    // without, then at the end of the next: (max_suppressed + 1.5) imax
+    int suppressed = redundancy_ > 0 ? max_suppressed_ : 0;
+    return imax_ * (2 * suppressed + 3) / 2;
+}
+
+void TrickleTimer::beginInterval(Clock::time_point now) {
+    interval_start_ = now;
+    heard_ = 0;
+    point_done_ = false;
+    // t uniform in [I/2, I)
+    auto half = interval_ / 2;
+    auto ticks = static_cast<uint64_t>(std::max<Clock::rep>(half.count(), 1));
+    uint64_t random = (static_cast<uint64_t>(next()) << 32) | next();
+    point_ = now + half + Clock::duration(static_cast<Clock::rep>(random % ticks));
+}
+
+uint32_t TrickleTimer::next() {
+    // xorshift32: cheap, and reproducible per seed in the simulator
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return rng_;
+}
+
+} // namespace sentinel
\ No newline at end of file
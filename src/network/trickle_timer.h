@@ -0,0 +1,88 @@
+#ifndef SENTINEL_TRICKLE_TIMER_H
+#define SENTINEL_TRICKLE_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace sentinel {
+
+// Trickle timer (RFC 6206) for periodic announcements. Each interval of
+// length I has one transmission point t, drawn from [I/2, I). At t the
+// node transmits unless it has heard at least `redundancy` consistent
+// announcements from its neighbours during the interval. When the interval
+// ends, I doubles, up to imax. An inconsistency sets I back to imin.
+//
+// A node stays visible even where suppression is common: after
+// `max_suppressed` suppressed intervals in a row it transmits anyway.
+// The longest silence is then silenceBound(). Peers use it to time out the
+// node.
+//
+// No clock or thread of its own: the caller passes the time and polls at
+// nextDue() (or more often), so the same timer runs on the radio and in
+// the mesh simulator.
+class TrickleTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Action {
+        NONE,
+        TRANSMIT,                    // Transmission point reached: send now
+        SUPPRESS                     // Transmission point reached, redundant
+    };
+
+    // seed: per-node, so neighbours pick different points
+    explicit TrickleTimer(uint32_t seed = 1);
+
+    // imax is rounded down to imin doubled a whole number of times.
+    // redundancy 0 never suppresses. Takes effect at the next start() or
+    // reset().
+    void configure(Clock::duration imin, Clock::duration imax, int redundancy,
+                   int max_suppressed);
+
+    // First interval, of length imin
+    void start(Clock::time_point now);
+
+    // A neighbour announced state consistent with ours
+    void hearConsistent() { heard_++; }
+
+    // Something changed: back to imin (unless already there, RFC 6206 6.)
+    void reset(Clock::time_point now);
+
+    // Advance to now. Reports the transmission point once per interval.
+    Action poll(Clock::time_point now);
+
+    // Next transmission point or interval end, whichever is first
+    Clock::time_point nextDue() const;
+
+    Clock::duration interval() const { return interval_; }
+    Clock::duration silenceBound() const;
+
+    uint64_t transmitted() const { return transmitted_; }
+    uint64_t suppressed() const { return suppressed_; }
+    uint64_t resets() const { return resets_; }
+
+private:
+    void beginInterval(Clock::time_point now);
+    uint32_t next();
+
+    Clock::duration imin_;
+    Clock::duration imax_;
+    int redundancy_;
+    int max_suppressed_;
+
+    Clock::duration interval_;
+    Clock::time_point interval_start_;
+    Clock::time_point point_;        // This interval's transmission point
+    bool point_done_;
+    int heard_;                      // Consistent announcements this interval
+    int suppressed_run_;             // Suppressed intervals in a row
+
+    uint32_t rng_;
+    uint64_t transmitted_;
+    uint64_t suppressed_;
+    uint64_t resets_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_TRICKLE_TIMER_H
\ No newline at end of file
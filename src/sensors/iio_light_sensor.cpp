@@ -0,0 +1,77 @@
+#include "sensors/iio_light_sensor.h"
+#include "utils/logger.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace sentinel {
+
+namespace {
+
+bool readFloat(const std::string& path, float& value) {
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    char text[32];
+    bool ok = std::fgets(text, sizeof(text), file) != nullptr;
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+    char* end = nullptr;
+    value = std::strtof(text, &end);
+    return end != text;
+}
+
+} // namespace
+
+IioLightSensor::IioLightSensor(const std::string& device_dir)
+    : device_dir_(device_dir),
+      processed_(false),
+      scale_(1.0f),
+      is_initialized_(false),
+      last_read_ok_(false),
+      last_lux_(0.0f) {
+}
+
+bool IioLightSensor::initialize() {
+    float value = 0.0f;
+    value_path_ = device_dir_ + "/in_illuminance_input";
+    processed_ = readFloat(value_path_, value);
+    if (!processed_) {
+        // Raw counts: lux = raw * scale
+        value_path_ = device_dir_ + "/in_illuminance_raw";
+        if (!readFloat(value_path_, value)) {
+            Logger::error("No illuminance channel in " + device_dir_);
+            return false;
+        }
+        if (!readFloat(device_dir_ + "/in_illuminance_scale", scale_)) {
+            scale_ = 1.0f;
+        }
+        value *= scale_;
+    }
+
+    is_initialized_ = true;
+    last_read_ok_ = true;
+    last_lux_ = value;
+    Logger::logf(LogLevel::INFO, "Light sensor %s: %.1f lux", device_dir_.c_str(), value);
+    return true;
+}
+
+void IioLightSensor::shutdown() {
+    is_initialized_ = false;
+}
+
+float IioLightSensor::getLightLux() {
+    if (!is_initialized_) {
+        return last_lux_;
+    }
+    float value = 0.0f;
+    last_read_ok_ = readFloat(value_path_, value);
+    if (last_read_ok_) {
+        last_lux_ = processed_ ? value : value * scale_;
+    }
+    return last_lux_;
+}
+
+} // namespace sentinel
\ No newline at end of file
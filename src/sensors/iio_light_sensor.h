@@ -0,0 +1,41 @@
+#ifndef SENTINEL_IIO_LIGHT_SENSOR_H
+#define SENTINEL_IIO_LIGHT_SENSOR_H
+
+#include "sensors/sensor_interface.h"
+#include <string>
+
+namespace sentinel {
+
+// Ambient light sensor exposed by a Linux IIO driver (BH1750, TSL2561,
+// VEML7700, ...), e.g. /sys/bus/iio/devices/iio:device0. Reads
+// in_illuminance_input (lux), or in_illuminance_raw scaled by
+// in_illuminance_scale when the driver only exposes raw counts.
+class IioLightSensor : public ILightSensor {
+public:
+    explicit IioLightSensor(const std::string& device_dir);
+
+    // ISensor interface
+    bool initialize() override;
+    void shutdown() override;
+    bool isInitialized() const override { return is_initialized_; }
+    bool calibrate() override { return true; }
+    bool isHealthy() const override { return is_initialized_ && last_read_ok_; }
+
+    // ILightSensor interface; the last good value if a read fails
+    float getLightLux() override;
+
+    std::string getName() const override { return "IIO Light Sensor"; }
+
+private:
+    std::string device_dir_;
+    std::string value_path_;         // Channel read by getLightLux()
+    bool processed_;                 // in_illuminance_input is available
+    float scale_;                    // For raw counts
+    bool is_initialized_;
+    bool last_read_ok_;
+    float last_lux_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_IIO_LIGHT_SENSOR_H
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <linux/i2c-dev.h>
 #include <cmath>
 #include <algorithm>
+#include <fstream>
 
 namespace sentinel {
 
@@ -14,11 +15,13 @@ constexpr float RL_VALUE = 5.0f;           // Load resistance in kOhms
 constexpr float RO_CLEAN_AIR = 9.83f;      // Sensor resistance in clean air
 constexpr float SMOKE_CURVE[3] = {2.3f, 0.53f, -0.44f}; // Smoke curve parameters
 
-MQ2Sensor::MQ2Sensor(uint8_t i2c_address)
+MQ2Sensor::MQ2Sensor(uint8_t i2c_address, const SensorConfig& config)
     : i2c_addr_(i2c_address),
+      config_(config),
       i2c_fd_(-1),
       ro_(RO_CLEAN_AIR),
-      is_initialized_(false) {
+      is_initialized_(false),
+      trace_pos_(0) {
 }
 
 MQ2Sensor::~MQ2Sensor() {
@@ -26,6 +29,19 @@ MQ2Sensor::~MQ2Sensor() {
 }
 
 bool MQ2Sensor::initialize() {
+    if (!config_.trace_file.empty()) {
+        Logger::info("Initializing MQ2 sensor from trace " + config_.trace_file);
+        if (!loadTrace(config_.trace_file)) {
+            return false;
+        }
+        if (!calibration_.is_valid && !calibrate()) {
+            Logger::error("Sensor calibration failed");
+            return false;
+        }
+        is_initialized_ = true;
+        return true;
+    }
+    
     Logger::info("Initializing MQ2 sensor on I2C address 0x" + 
                 std::to_string(i2c_addr_));
     
@@ -45,13 +61,18 @@ bool MQ2Sensor::initialize() {
         return false;
     }
     
-    // Calibrate sensor
-    Logger::info("Calibrating MQ2 sensor (30 seconds warm-up)...");
-    if (!calibrate()) {
-        Logger::error("Sensor calibration failed");
-        close(i2c_fd_);
-        i2c_fd_ = -1;
-        return false;
+    // Calibrate sensor, unless a recent calibration was restored
+    if (calibration_.is_valid) {
+        Logger::info("Using restored MQ2 calibration");
+    } else {
+        Logger::info("Calibrating MQ2 sensor (" + std::to_string(config_.calibration_time_sec) +
+                    " seconds warm-up)...");
+        if (!calibrate()) {
+            Logger::error("Sensor calibration failed");
+            close(i2c_fd_);
+            i2c_fd_ = -1;
+            return false;
+        }
     }
     
     is_initialized_ = true;
@@ -60,13 +81,40 @@ bool MQ2Sensor::initialize() {
     return true;
 }
 
+bool MQ2Sensor::loadTrace(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        Logger::error("Failed to open sensor trace: " + path);
+        return false;
+    }
+    
+    trace_.clear();
+    trace_pos_ = 0;
+    trace_start_ = std::chrono::steady_clock::time_point();
+    int value;
+    while (file >> value) {
+        trace_.push_back(static_cast<uint16_t>(std::clamp(value, 0, 4095)));
+    }
+    
+    if (trace_.empty()) {
+        Logger::error("Sensor trace is empty: " + path);
+        return false;
+    }
+    return true;
+}
+
 bool MQ2Sensor::calibrate() {
-    // Warm-up period (30 seconds)
-    for (int i = 0; i < 30; i++) {
+    // A replayed trace has no heater to warm up and no need for pacing
+    const bool replay = !trace_.empty();
+    
+    // Warm-up period (sensor.calibration_time_sec)
+    const int warmup_sec = replay ? 0 : config_.calibration_time_sec;
+    for (int i = 0; i < warmup_sec; i++) {
         readAnalog();
         sleep(1);
         if (i % 5 == 0) {
-            Logger::info("Calibrating... " + std::to_string(i) + "/30s");
+            Logger::info("Calibrating... " + std::to_string(i) + "/" +
+                        std::to_string(warmup_sec) + "s");
         }
     }
     
@@ -77,7 +125,9 @@ bool MQ2Sensor::calibrate() {
     for (int i = 0; i < samples; i++) {
         float rs = getResistance();
         rs_sum += rs;
-        usleep(100000); // 100ms delay
+        if (!replay) {
+            usleep(100000); // 100ms delay
+        }
     }
     
     ro_ = rs_sum / samples / RO_CLEAN_AIR;
@@ -86,14 +136,56 @@ bool MQ2Sensor::calibrate() {
     if (ro_ <= 0 || ro_ > 50) {
         Logger::error("Invalid calibration value: " + std::to_string(ro_));
         ro_ = RO_CLEAN_AIR; // Use default
+        calibration_ = CalibrationData();
         return false;
     }
     
+    calibration_.offset = 0.0f;
+    calibration_.scale_factor = ro_;
+    calibration_.calibration_time = std::chrono::system_clock::now();
+    calibration_.is_valid = true;
+    return true;
+}
+
+CalibrationData MQ2Sensor::getCalibration() const {
+    return calibration_;
+}
+
+bool MQ2Sensor::restoreCalibration(const CalibrationData& data) {
+    // scale_factor carries R0; apply the same bounds as calibrate()
+    if (!data.is_valid || data.scale_factor <= 0 || data.scale_factor > 50) {
+        return false;
+    }
+    
+    calibration_ = data;
+    ro_ = data.scale_factor;
     return true;
 }
 
 int MQ2Sensor::readAnalog() {
-    if (!is_initialized_ || i2c_fd_ < 0) {
+    if (!trace_.empty()) {
+        if (config_.trace_rate_hz > 0) {
+            // Calibration sees the first sample; replay time starts at the
+            // first reading after initialization
+            if (!is_initialized_) {
+                return trace_[0];
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (trace_start_ == std::chrono::steady_clock::time_point()) {
+                trace_start_ = now;
+            }
+            auto elapsed = now - trace_start_;
+            auto sample = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() *
+                          config_.trace_rate_hz / 1000000;
+            return trace_[static_cast<size_t>(sample) % trace_.size()];
+        }
+        int value = trace_[trace_pos_];
+        trace_pos_ = (trace_pos_ + 1) % trace_.size();
+        return value;
+    }
+    
+    // calibrate() runs before is_initialized_ is set, so only the bus matters
+    if (i2c_fd_ < 0) {
         return -1;
     }
     
@@ -110,7 +202,14 @@ int MQ2Sensor::readAnalog() {
 }
 
 float MQ2Sensor::getResistance() {
-    int analog_value = readAnalog();
+    return analogToResistance(readAnalog());
+}
+
+float MQ2Sensor::getPPM() {
+    return analogToPPM(readAnalog());
+}
+
+float MQ2Sensor::analogToResistance(int analog_value) {
     if (analog_value < 0) {
         return -1.0f;
     }
@@ -128,8 +227,8 @@ float MQ2Sensor::getResistance() {
     return rs;
 }
 
-float MQ2Sensor::getPPM() {
-    float rs = getResistance();
+float MQ2Sensor::analogToPPM(int analog_value) const {
+    float rs = analogToResistance(analog_value);
     if (rs < 0) {
         return -1.0f;
     }
@@ -148,19 +247,13 @@ float MQ2Sensor::getPPM() {
 bool MQ2Sensor::detectSmoke() {
     float ppm = getPPM();
     
-    // Threshold for smoke detection (adjustable based on environment)
-    const float SMOKE_THRESHOLD = 200.0f; // PPM
-    
     // Apply temporal filtering to reduce noise
-    detection_history_.push_back(ppm > SMOKE_THRESHOLD);
-    if (detection_history_.size() > 5) {
-        detection_history_.erase(detection_history_.begin());
-    }
+    detection_history_.push(ppm > config_.smoke_threshold_ppm);
     
     // Require 3 out of 5 recent readings to be positive
     int positive_count = 0;
-    for (bool detected : detection_history_) {
-        if (detected) positive_count++;
+    for (size_t i = 0; i < detection_history_.size(); i++) {
+        if (detection_history_[i]) positive_count++;
     }
     
     return positive_count >= 3;
@@ -176,6 +269,21 @@ SensorReading MQ2Sensor::getReading() {
     return reading;
 }
 
+const MQ2Sensor::DetectionHistory& MQ2Sensor::getDetectionHistory() const {
+    return detection_history_;
+}
+
+void MQ2Sensor::restoreDetectionHistory(const std::vector<bool>& history) {
+    detection_history_.clear();
+    for (bool detected : history) {
+        detection_history_.push(detected);
+    }
+}
+
+void MQ2Sensor::applyConfig(const SensorConfig& config) {
+    config_ = config;
+}
+
 bool MQ2Sensor::isInitialized() const {
     return is_initialized_;
 }
@@ -2,7 +2,10 @@
 #define MQ2_SENSOR_H
 
 #include "sensors/sensor_interface.h"
+#include "core/sentinel_core.h"
+#include "utils/ring_buffer.h"
 #include <cstdint>
+#include <string>
 #include <vector>
 #include <chrono>
 
@@ -18,7 +21,11 @@ struct SensorReading {
 
 class MQ2Sensor : public IGasSensor {
 public:
-    explicit MQ2Sensor(uint8_t i2c_address);
+    // Readings in the temporal filter
+    static constexpr size_t DETECTION_WINDOW = 5;
+    using DetectionHistory = RingBuffer<bool, DETECTION_WINDOW>;
+    
+    explicit MQ2Sensor(uint8_t i2c_address, const SensorConfig& config = SensorConfig());
     ~MQ2Sensor();
     
     // ISensor interface
@@ -27,6 +34,8 @@ public:
     bool isInitialized() const override;
     bool calibrate() override;
     bool isHealthy() const override;
+    CalibrationData getCalibration() const override;
+    bool restoreCalibration(const CalibrationData& data) override;
     
     // IGasSensor interface
     int readAnalog() override;
@@ -37,12 +46,36 @@ public:
     // Additional methods
     SensorReading getReading();
     
+    // Convert a raw 12-bit ADC value using the current calibration
+    // (-1 for invalid readings)
+    static float analogToResistance(int analog_value);
+    float analogToPPM(int analog_value) const;
+    
+    // Temporal filter window (oldest first), for warm restarts
+    const DetectionHistory& getDetectionHistory() const;
+    void restoreDetectionHistory(const std::vector<bool>& history);
+    
+    // Apply runtime settings (threshold, sampling interval). Calibration
+    // time only takes effect on the next calibrate().
+    void applyConfig(const SensorConfig& config);
+    
 private:
+    // Load sensor.trace_file: one ADC value (0-4095) per line
+    bool loadTrace(const std::string& path);
+    
     uint8_t i2c_addr_;
+    SensorConfig config_;
     int i2c_fd_;
     float ro_; // Sensor resistance in clean air
     bool is_initialized_;
-    std::vector<bool> detection_history_;
+    CalibrationData calibration_;
+    DetectionHistory detection_history_;
+    
+    // Replayed ADC samples (sensor.trace_file), looped. With a trace rate
+    // the sample is chosen by time since the first reading.
+    std::vector<uint16_t> trace_;
+    size_t trace_pos_;
+    std::chrono::steady_clock::time_point trace_start_;
 };
 
 } // namespace sentinel
@@ -48,6 +48,18 @@ public:
     // Calibrate sensor (if applicable)
     virtual bool calibrate() = 0;
     
+    // Current calibration (is_valid is false if the sensor has none)
+    virtual CalibrationData getCalibration() const {
+        return CalibrationData();
+    }
+    
+    // Reuse a previously computed calibration instead of calibrating on
+    // the next initialize(). Returns false if the data is not usable.
+    virtual bool restoreCalibration(const CalibrationData& data) {
+        (void)data;
+        return false;
+    }
+    
     // Get sensor health status
     virtual bool isHealthy() const = 0;
     
@@ -261,6 +273,40 @@ public:
     }
 };
 
+// Helper functions for sensor data processing (sensor_interface.cpp)
+namespace SensorUtils {
+
+// Gas sensor power-law curve: PPM <-> Rs/R0
+float resistanceRatioToPPM(float rs_r0_ratio, float slope, float intercept);
+float ppmToResistanceRatio(float ppm, float slope, float intercept);
+
+// Filters
+float applyEMA(float new_value, float old_value, float alpha);
+float lowPassFilter(float new_value, float filtered_value, float alpha);
+float highPassFilter(float new_value, float old_value, float old_filtered, float alpha);
+float medianOfThree(float a, float b, float c);
+
+// Ranges
+bool isInRange(float value, float min_val, float max_val);
+float clamp(float value, float min_val, float max_val);
+float mapRange(float value, float in_min, float in_max, float out_min, float out_max);
+
+// Statistics over a window of count samples
+float calculateMovingAverage(const float* values, int count);
+float calculateStdDev(const float* values, int count);
+bool isOutlier(float value, const float* values, int count, float threshold_sigma);
+
+// Unit conversions and derived quantities
+float celsiusToFahrenheit(float celsius);
+float fahrenheitToCelsius(float fahrenheit);
+float celsiusToKelvin(float celsius);
+float kelvinToCelsius(float kelvin);
+float calculateDewPoint(float temperature_c, float humidity_percent);
+float calculateHeatIndex(float temperature_f, float humidity_percent);
+float calculateAltitude(float pressure_pa, float sea_level_pressure_pa);
+
+} // namespace SensorUtils
+
 } // namespace sentinel
 
 #endif // SENTINEL_SENSOR_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "utils/checksum.h"
+
+namespace sentinel {
+
+namespace {
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+const Crc32Table& table() {
+    static const Crc32Table instance;
+    return instance;
+}
+
+uint64_t readLe64(const uint8_t* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = value << 8 | p[i];
+    }
+    return value;
+}
+
+uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+void sipRound(uint64_t* v) {
+    v[0] += v[1];
+    v[1] = rotl(v[1], 13);
+    v[1] ^= v[0];
+    v[0] = rotl(v[0], 32);
+    v[2] += v[3];
+    v[3] = rotl(v[3], 16);
+    v[3] ^= v[2];
+    v[0] += v[3];
+    v[3] = rotl(v[3], 21);
+    v[3] ^= v[0];
+    v[2] += v[1];
+    v[1] = rotl(v[1], 17);
+    v[1] ^= v[2];
+    v[2] = rotl(v[2], 32);
+}
+
+} // namespace
+
+uint32_t crc32(const void* data, size_t len, uint32_t crc) {
+    const uint32_t* entries = table().entries;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint64_t siphash24(const uint8_t* key, const void* data, size_t len) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t k0 = readLe64(key);
+    uint64_t k1 = readLe64(key + 8);
+    uint64_t v[4] = {k0 ^ 0x736F6D6570736575ull, k1 ^ 0x646F72616E646F6Dull,
+                     k0 ^ 0x6C7967656E657261ull, k1 ^ 0x7465646279746573ull};
+
+    size_t whole = len & ~size_t(7);
+    for (size_t i = 0; i < whole; i += 8) {
+        uint64_t m = readLe64(bytes + i);
+        v[3] ^= m;
+        sipRound(v);
+        sipRound(v);
+        v[0] ^= m;
+    }
+    // Last 0-7 bytes, with the length in the top byte
+    uint64_t last = static_cast<uint64_t>(len) << 56;
+    for (size_t i = whole; i < len; i++) {
+        last |= static_cast<uint64_t>(bytes[i]) << (8 * (i - whole));
+    }
+    v[3] ^= last;
+    sipRound(v);
+    sipRound(v);
+    v[0] ^= last;
+
+    v[2] ^= 0xFF;
+    for (int i = 0; i < 4; i++) {
+        sipRound(v);
+    }
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef SENTINEL_CHECKSUM_H
+#define SENTINEL_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sentinel {
+
+// CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320). Pass the previous
+// result as crc to checksum data in several pieces.
+uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+
+// SipHash-2-4: 64-bit keyed hash (MAC) of data under a 16-byte key.
+// Without the key, a matching tag cannot be forged.
+constexpr size_t SIPHASH_KEY_SIZE = 16;
+uint64_t siphash24(const uint8_t* key, const void* data, size_t len);
+
+} // namespace sentinel
+
+#endif // SENTINEL_CHECKSUM_H
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "utils/content_chunker.h"
+#include "utils/checksum.h"
+#include <algorithm>
+
+namespace sentinel {
+
+namespace {
+
+// Random value per byte (splitmix64), fixed so every node cuts alike
+struct GearTable {
+    uint64_t entries[256];
+
+    GearTable() {
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (uint64_t& entry : entries) {
+            state += 0x9E3779B97F4A7C15ull;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            entry = z ^ (z >> 31);
+        }
+    }
+};
+
+const GearTable& gear() {
+    static const GearTable instance;
+    return instance;
+}
+
+// Top bits of the hash: they depend on the most recent 64 bytes only
+uint64_t topMask(int bits) {
+    bits = std::clamp(bits, 1, 63);
+    return ~uint64_t(0) << (64 - bits);
+}
+
+} // namespace
+
+std::vector<ContentChunk> chunkContent(const uint8_t* data, size_t len,
+                                       const ChunkerParams& params) {
+    size_t min_size = std::max<size_t>(params.min_size, 1);
+    size_t max_size = std::max(params.max_size, min_size);
+    size_t avg_size = std::clamp(params.avg_size, min_size, max_size);
+    int bits = 0;
+    while ((size_t(2) << bits) <= avg_size) {
+        bits++;
+    }
+    uint64_t mask_small = topMask(bits + 1);
+    uint64_t mask_large = topMask(bits - 1);
+    const uint64_t* table = gear().entries;
+
+    std::vector<ContentChunk> chunks;
+    chunks.reserve(len / avg_size + 1);
+    size_t start = 0;
+    while (start < len) {
+        const uint8_t* bytes = data + start;
+        size_t limit = std::min(len - start, max_size);
+        size_t normal = std::min(limit, avg_size);
+        size_t cut = limit;
+        uint64_t hash = 0;
+        for (size_t i = min_size; i < limit; i++) {
+            hash = (hash << 1) + table[bytes[i]];
+            if ((hash & (i < normal ? mask_small : mask_large)) == 0) {
+                cut = i + 1;
+                break;
+            }
+        }
+        chunks.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(cut),
+                          crc32(bytes, cut)});
+        start += cut;
+    }
+    return chunks;
+}
+
+} // namespace sentinel
\ No newline at end of file
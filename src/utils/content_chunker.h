@@ -0,0 +1,33 @@
+#ifndef SENTINEL_CONTENT_CHUNKER_H
+#define SENTINEL_CONTENT_CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sentinel {
+
+// Content-defined chunking: a gear rolling hash over the bytes, cut where
+// the hash matches a mask (FastCDC). Boundaries depend on content, not on
+// position, so bytes inserted or removed in one place change only the
+// chunks around it, and two files that share most of their content share
+// most of their chunks. A stricter mask below avg_size and a looser one
+// above it keep chunk sizes close to the average.
+struct ContentChunk {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t hash;                   // CRC-32 of the chunk's bytes
+};
+
+struct ChunkerParams {
+    size_t min_size = 256;
+    size_t avg_size = 1024;          // Rounded down to a power of two
+    size_t max_size = 4096;
+};
+
+std::vector<ContentChunk> chunkContent(const uint8_t* data, size_t len,
+                                       const ChunkerParams& params = ChunkerParams());
+
+} // namespace sentinel
+
+#endif // SENTINEL_CONTENT_CHUNKER_H
\ No newline at end of file
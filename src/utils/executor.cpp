@@ -0,0 +1,564 @@
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "utils/realtime.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace sentinel {
+
+namespace {
+
+constexpr size_t PRIORITY_COUNT = static_cast<size_t>(TaskPriority::COUNT);
+
+// Tasks per worker and priority; beyond that post() runs tasks inline
+constexpr size_t QUEUE_CAPACITY = 256;
+
+// Bounded deque of tasks. Slots are reused, so pushing a task that is
+// stored inline does not allocate.
+class TaskDeque {
+public:
+    bool pushBack(Task& task) {
+        if (size_ == QUEUE_CAPACITY) {
+            return false;
+        }
+        slots_[(head_ + size_) % QUEUE_CAPACITY] = std::move(task);
+        size_++;
+        return true;
+    }
+
+    // Owner end: newest task first
+    bool popBack(Task& out) {
+        if (size_ == 0) {
+            return false;
+        }
+        size_--;
+        Task& slot = slots_[(head_ + size_) % QUEUE_CAPACITY];
+        out = std::move(slot);
+        slot = nullptr;
+        return true;
+    }
+
+    // Thief end: oldest task first
+    bool popFront(Task& out) {
+        if (size_ == 0) {
+            return false;
+        }
+        Task& slot = slots_[head_];
+        out = std::move(slot);
+        slot = nullptr;
+        head_ = (head_ + 1) % QUEUE_CAPACITY;
+        size_--;
+        return true;
+    }
+
+    size_t clear() {
+        size_t dropped = size_;
+        Task task;
+        while (popBack(task)) {
+        }
+        head_ = 0;
+        return dropped;
+    }
+
+private:
+    Task slots_[QUEUE_CAPACITY];
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+struct Worker {
+    std::mutex mutex;
+    TaskDeque deques[PRIORITY_COUNT];
+    std::thread thread;
+};
+
+struct TimerEntry {
+    Executor::Clock::time_point due;
+    Executor::Clock::duration period;
+    Task task;
+    TaskPriority priority;
+    JitterTask jitter;
+    bool armed;                      // Waiting for due (not queued or running)
+    bool running;
+    bool cancelled;
+};
+
+struct ParallelJob {
+    void (*fn)(void* context, size_t begin, size_t end);
+    void* context;
+    size_t count;
+    size_t chunk;
+    std::atomic<size_t> next;
+    std::atomic<int> helpers;        // Workers currently inside the job
+};
+
+struct ExecutorState {
+    std::mutex control_mutex;        // start() / stop()
+    std::unique_ptr<Worker[]> workers;
+    int worker_count = 0;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> next_worker{0};
+    std::atomic<int64_t> pending{0};     // Queued tasks
+
+    // Idle workers sleep here. Lock order: idle, then timer or job.
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+
+    std::mutex timer_mutex;
+    std::condition_variable timer_cv;    // cancel() waiting for a running timer
+    std::map<Executor::TimerId, TimerEntry> timers;
+    Executor::TimerId next_timer_id = 1;
+
+    std::mutex job_mutex;
+    ParallelJob* job = nullptr;          // At most one parallelFor at a time
+
+    std::atomic<uint64_t> tasks_run{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> timers_fired{0};
+    std::atomic<uint64_t> parallel_jobs{0};
+    std::atomic<uint64_t> chunks_helped{0};
+    std::atomic<uint64_t> inline_runs{0};
+};
+
+ExecutorState& state() {
+    // Never destroyed: worker threads may outlive static destruction
+    static ExecutorState* const executor = new ExecutorState();
+    return *executor;
+}
+
+thread_local int t_worker = -1;                  // Index of this worker, -1 elsewhere
+thread_local Executor::TimerId t_timer = 0;      // Timer whose task this thread is running
+
+int defaultWorkers() {
+    // CPUs this thread may run on (the inference CPUs in real-time mode)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 0) {
+        return CPU_COUNT(&cpus);
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void wakeOne() {
+    ExecutorState& s = state();
+    { std::lock_guard<std::mutex> lock(s.idle_mutex); }
+    s.idle_cv.notify_one();
+}
+
+void wakeAll() {
+    ExecutorState& s = state();
+    { std::lock_guard<std::mutex> lock(s.idle_mutex); }
+    s.idle_cv.notify_all();
+}
+
+bool pushTask(int index, Task& task, TaskPriority priority) {
+    ExecutorState& s = state();
+    Worker& worker = s.workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.deques[static_cast<size_t>(priority)].pushBack(task)) {
+            return false;
+        }
+    }
+    s.pending.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+// Highest priority first: own deque, then steal from the others
+bool takeTask(int index, Task& out) {
+    ExecutorState& s = state();
+    if (s.pending.load(std::memory_order_acquire) <= 0) {
+        return false;
+    }
+    for (size_t p = 0; p < PRIORITY_COUNT; p++) {
+        {
+            Worker& own = s.workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.deques[p].popBack(out)) {
+                s.pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (int i = 1; i < s.worker_count; i++) {
+            Worker& victim = s.workers[(index + i) % s.worker_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.deques[p].popFront(out)) {
+                s.pending.fetch_sub(1, std::memory_order_relaxed);
+                s.steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void runTimer(Executor::TimerId id);
+
+// Queue every timer that is due; returns the next due time
+Executor::Clock::time_point dispatchTimers(int index) {
+    ExecutorState& s = state();
+    auto now = Executor::Clock::now();
+    auto next = Executor::Clock::time_point::max();
+
+    std::lock_guard<std::mutex> lock(s.timer_mutex);
+    for (auto& pair : s.timers) {
+        TimerEntry& timer = pair.second;
+        if (!timer.armed || timer.cancelled) {
+            continue;
+        }
+        if (timer.due > now) {
+            next = std::min(next, timer.due);
+            continue;
+        }
+        Executor::TimerId id = pair.first;
+        Task fire = [id]() { runTimer(id); };
+        if (pushTask(index, fire, timer.priority)) {
+            timer.armed = false;
+        }
+    }
+    return next;
+}
+
+Executor::Clock::time_point nextTimerDue() {
+    ExecutorState& s = state();
+    auto next = Executor::Clock::time_point::max();
+    std::lock_guard<std::mutex> lock(s.timer_mutex);
+    for (const auto& pair : s.timers) {
+        if (pair.second.armed && !pair.second.cancelled) {
+            next = std::min(next, pair.second.due);
+        }
+    }
+    return next;
+}
+
+void runTimer(Executor::TimerId id) {
+    ExecutorState& s = state();
+    TimerEntry* timer = nullptr;
+    Executor::Clock::time_point due;
+    Executor::Clock::duration period;
+    {
+        std::lock_guard<std::mutex> lock(s.timer_mutex);
+        auto it = s.timers.find(id);
+        if (it == s.timers.end() || it->second.cancelled) {
+            return;
+        }
+        timer = &it->second;
+        timer->running = true;
+        due = timer->due;
+        period = timer->period;
+    }
+
+    // The entry stays in place while running: cancel() waits for it and
+    // reschedule() only changes the period (under timer_mutex, so it is
+    // read above)
+    auto start = Executor::Clock::now();
+    if (timer->jitter != JitterTask::COUNT && period.count() > 0) {
+        JitterMonitor::recordWakeup(timer->jitter, due, start, period);
+    }
+    t_timer = id;
+    timer->task();
+    t_timer = 0;
+    if (timer->jitter != JitterTask::COUNT) {
+        JitterMonitor::recordRun(timer->jitter, start, Executor::Clock::now());
+    }
+    s.timers_fired.fetch_add(1, std::memory_order_relaxed);
+
+    bool rearmed = false;
+    {
+        std::lock_guard<std::mutex> lock(s.timer_mutex);
+        timer->running = false;
+        if (timer->cancelled || timer->period.count() == 0) {
+            s.timers.erase(id);
+            s.timer_cv.notify_all();
+        } else {
+            timer->due = std::max(due + timer->period, Executor::Clock::now());
+            timer->armed = true;
+            rearmed = true;
+        }
+    }
+    if (rearmed) {
+        // A sleeping worker may be waiting without a deadline
+        wakeOne();
+    }
+}
+
+size_t runChunks(ParallelJob& job) {
+    size_t chunks = 0;
+    for (;;) {
+        size_t begin = job.next.fetch_add(job.chunk, std::memory_order_relaxed);
+        if (begin >= job.count) {
+            return chunks;
+        }
+        job.fn(job.context, begin, std::min(begin + job.chunk, job.count));
+        chunks++;
+    }
+}
+
+bool jobAvailable() {
+    ExecutorState& s = state();
+    std::lock_guard<std::mutex> lock(s.job_mutex);
+    return s.job && s.job->next.load(std::memory_order_relaxed) < s.job->count;
+}
+
+bool helpParallelJob() {
+    ExecutorState& s = state();
+    ParallelJob* job = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s.job_mutex);
+        job = s.job;
+        if (!job || job->next.load(std::memory_order_relaxed) >= job->count) {
+            return false;
+        }
+        job->helpers.fetch_add(1, std::memory_order_relaxed);
+    }
+    size_t chunks = runChunks(*job);
+    s.chunks_helped.fetch_add(chunks, std::memory_order_relaxed);
+    // Last access to the job: the caller may return once helpers is zero
+    job->helpers.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void workerLoop(int index) {
+    ExecutorState& s = state();
+    t_worker = index;
+    char name[16];
+    std::snprintf(name, sizeof(name), "exec-%d", index);
+    pthread_setname_np(pthread_self(), name);
+    Realtime::applyRole(ThreadRole::INFERENCE);
+
+    Task task;
+    while (s.running.load(std::memory_order_acquire)) {
+        if (helpParallelJob()) {
+            continue;
+        }
+        auto next_due = dispatchTimers(index);
+        if (takeTask(index, task)) {
+            task();
+            task = nullptr;
+            s.tasks_run.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(s.idle_mutex);
+        if (!s.running.load(std::memory_order_acquire) ||
+            s.pending.load(std::memory_order_acquire) > 0 || jobAvailable()) {
+            continue;
+        }
+        next_due = std::min(next_due, nextTimerDue());
+        if (next_due == Executor::Clock::time_point::max()) {
+            s.idle_cv.wait(lock);
+        } else {
+            s.idle_cv.wait_until(lock, next_due);
+        }
+    }
+    t_worker = -1;
+}
+
+} // namespace
+
+bool Executor::start(int threads) {
+    ExecutorState& s = state();
+    std::lock_guard<std::mutex> control(s.control_mutex);
+    if (s.running.load()) {
+        return false;
+    }
+
+    int count = threads > 0 ? threads : defaultWorkers();
+    s.workers.reset(new Worker[count]);
+    s.worker_count = count;
+    s.pending.store(0);
+    s.running.store(true, std::memory_order_release);
+    for (int i = 0; i < count; i++) {
+        s.workers[i].thread = std::thread(workerLoop, i);
+    }
+
+    Logger::logf(LogLevel::INFO, "Executor started with %d workers", count);
+    return true;
+}
+
+void Executor::stop() {
+    ExecutorState& s = state();
+    std::lock_guard<std::mutex> control(s.control_mutex);
+    if (!s.running.load()) {
+        return;
+    }
+
+    s.running.store(false, std::memory_order_release);
+    wakeAll();
+    for (int i = 0; i < s.worker_count; i++) {
+        if (s.workers[i].thread.joinable()) {
+            s.workers[i].thread.join();
+        }
+    }
+
+    size_t dropped = 0;
+    for (int i = 0; i < s.worker_count; i++) {
+        for (TaskDeque& deque : s.workers[i].deques) {
+            dropped += deque.clear();
+        }
+    }
+    s.pending.store(0);
+
+    // Timers that were queued but never ran wait for the next start()
+    {
+        std::lock_guard<std::mutex> lock(s.timer_mutex);
+        for (auto& pair : s.timers) {
+            pair.second.armed = !pair.second.cancelled;
+        }
+    }
+
+    s.workers.reset();
+    s.worker_count = 0;
+    if (dropped > 0) {
+        Logger::logf(LogLevel::WARN, "Executor stopped with %zu tasks pending", dropped);
+    }
+}
+
+bool Executor::running() {
+    return state().running.load(std::memory_order_acquire);
+}
+
+int Executor::threadBudget() {
+    ExecutorState& s = state();
+    return s.running.load(std::memory_order_acquire) ? s.worker_count : defaultWorkers();
+}
+
+void Executor::post(Task task, TaskPriority priority) {
+    ExecutorState& s = state();
+    if (s.running.load(std::memory_order_acquire) && s.worker_count > 0) {
+        int index = t_worker >= 0 ? t_worker :
+                    static_cast<int>(s.next_worker.fetch_add(1, std::memory_order_relaxed) %
+                                     s.worker_count);
+        if (pushTask(index, task, priority)) {
+            wakeOne();
+            return;
+        }
+    }
+    s.inline_runs.fetch_add(1, std::memory_order_relaxed);
+    task();
+}
+
+Executor::TimerId Executor::schedule(Clock::duration delay, Clock::duration period, Task task,
+                                     TaskPriority priority, JitterTask jitter) {
+    ExecutorState& s = state();
+    TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(s.timer_mutex);
+        id = s.next_timer_id++;
+        TimerEntry& timer = s.timers[id];
+        timer.due = Clock::now() + delay;
+        timer.period = period;
+        timer.task = std::move(task);
+        timer.priority = priority;
+        timer.jitter = jitter;
+        timer.armed = true;
+        timer.running = false;
+        timer.cancelled = false;
+    }
+    wakeAll();
+    return id;
+}
+
+void Executor::reschedule(TimerId id, Clock::duration period) {
+    ExecutorState& s = state();
+    {
+        std::lock_guard<std::mutex> lock(s.timer_mutex);
+        auto it = s.timers.find(id);
+        if (it == s.timers.end() || it->second.period == period) {
+            return;
+        }
+        TimerEntry& timer = it->second;
+        timer.period = period;
+        if (timer.armed) {
+            timer.due = std::min(timer.due, Clock::now() + period);
+        }
+    }
+    wakeAll();
+}
+
+void Executor::cancel(TimerId id) {
+    ExecutorState& s = state();
+    std::unique_lock<std::mutex> lock(s.timer_mutex);
+    auto it = s.timers.find(id);
+    if (it == s.timers.end()) {
+        return;
+    }
+    it->second.cancelled = true;
+    if (!it->second.running) {
+        // Queued firings find the entry gone and do nothing
+        s.timers.erase(it);
+        return;
+    }
+    if (t_timer == id) {
+        return;                      // runTimer() erases it when the task returns
+    }
+    s.timer_cv.wait(lock, [&]() { return s.timers.find(id) == s.timers.end(); });
+}
+
+void Executor::parallelForImpl(size_t count, size_t grain, ChunkFn fn, void* context) {
+    ExecutorState& s = state();
+    grain = std::max<size_t>(1, grain);
+    int workers = s.running.load(std::memory_order_acquire) ? s.worker_count : 0;
+    if (workers == 0 || count <= grain) {
+        if (count > 0) {
+            fn(context, 0, count);
+        }
+        return;
+    }
+
+    // One chunk per participant, unless that would go below grain
+    size_t participants = static_cast<size_t>(workers) + 1;
+    ParallelJob job;
+    job.fn = fn;
+    job.context = context;
+    job.count = count;
+    job.chunk = std::max(grain, (count + participants - 1) / participants);
+    job.next.store(0, std::memory_order_relaxed);
+    job.helpers.store(0, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(s.job_mutex);
+        if (s.job) {
+            // Another parallelFor is in flight: run this one sequentially
+            fn(context, 0, count);
+            return;
+        }
+        s.job = &job;
+    }
+    s.parallel_jobs.fetch_add(1, std::memory_order_relaxed);
+    wakeAll();
+
+    runChunks(job);
+
+    {
+        std::lock_guard<std::mutex> lock(s.job_mutex);
+        s.job = nullptr;
+    }
+    // Only workers already running a chunk remain
+    while (job.helpers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+ExecutorStats Executor::stats() {
+    ExecutorState& s = state();
+    ExecutorStats stats;
+    stats.workers = s.running.load() ? s.worker_count : 0;
+    stats.tasks_run = s.tasks_run.load(std::memory_order_relaxed);
+    stats.steals = s.steals.load(std::memory_order_relaxed);
+    stats.timers_fired = s.timers_fired.load(std::memory_order_relaxed);
+    stats.parallel_jobs = s.parallel_jobs.load(std::memory_order_relaxed);
+    stats.chunks_helped = s.chunks_helped.load(std::memory_order_relaxed);
+    stats.inline_runs = s.inline_runs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace sentinel
\ No newline at end of file
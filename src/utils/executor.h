@@ -0,0 +1,110 @@
+#ifndef SENTINEL_EXECUTOR_H
+#define SENTINEL_EXECUTOR_H
+
+#include "utils/jitter_monitor.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace sentinel {
+
+enum class TaskPriority {
+    HIGH = 0,
+    NORMAL,
+    LOW,
+    COUNT
+};
+
+// Lambdas capturing up to two pointers are stored inline, so posting them
+// does not allocate
+using Task = std::function<void()>;
+
+struct ExecutorStats {
+    int workers;
+    uint64_t tasks_run;              // Queued tasks and timer firings
+    uint64_t steals;                 // Tasks taken from another worker's deque
+    uint64_t timers_fired;
+    uint64_t parallel_jobs;
+    uint64_t chunks_helped;          // parallelFor chunks run by workers
+    uint64_t inline_runs;            // Tasks run by the poster (stopped or queue full)
+};
+
+// Process-wide work-stealing executor: one worker per CPU of the thread
+// budget, each with a bounded deque per priority. Workers take their own
+// newest task first and steal the oldest from other workers when idle,
+// always draining higher priorities first. Idle workers sleep until a
+// task, a parallelFor job or the next timer is due.
+//
+// The thread budget is shared with the inference libraries: TFLite runs
+// with threadBudget() threads and OpenCV's row-parallel work runs here
+// through parallelFor, so the CPUs are not oversubscribed.
+class Executor {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    // Start workers (threads <= 0: one per CPU the process may use).
+    // Returns false if already running.
+    static bool start(int threads);
+
+    // Cancel pending work and join the workers. Timers stay registered and
+    // resume on the next start().
+    static void stop();
+
+    static bool running();
+
+    // Worker count while running, else the count start(0) would use
+    static int threadBudget();
+
+    // Queue a task. From a worker it goes on that worker's deque, otherwise
+    // on the next worker's in turn. Runs inline if the executor is stopped
+    // or the deque is full.
+    //
+    // A posted task has no owner and cannot be cancelled, and stop() drops
+    // it unrun if it is still queued. Whoever posts a task capturing an
+    // object must make sure it has finished before the object goes away
+    // (LoraMesh counts its posted tasks for this); use a timer when the
+    // task has to be cancellable.
+    static void post(Task task, TaskPriority priority = TaskPriority::NORMAL);
+
+    // Run task after delay and then every period (zero = once). A timer
+    // never overlaps itself: the next run is due one period after the
+    // previous one was, or immediately if that has passed. With a jitter
+    // task, lateness and run time are recorded in the JitterMonitor.
+    static TimerId schedule(Clock::duration delay, Clock::duration period, Task task,
+                            TaskPriority priority = TaskPriority::NORMAL,
+                            JitterTask jitter = JitterTask::COUNT);
+
+    // Change a timer's period; takes effect from its next run
+    static void reschedule(TimerId id, Clock::duration period);
+
+    // Remove a timer. Once this returns the task is not running and will
+    // not run again (unless called from the task itself).
+    static void cancel(TimerId id);
+
+    // Run body(begin, end) over [0, count) in chunks of at least grain.
+    // The caller works through chunks itself while idle workers join in,
+    // and it never waits for a queued task, so it is safe to call from
+    // anywhere. Does not allocate.
+    template <typename Body>
+    static void parallelFor(size_t count, size_t grain, Body&& body) {
+        using Fn = typename std::remove_reference<Body>::type;
+        parallelForImpl(count, grain,
+                        [](void* context, size_t begin, size_t end) {
+                            (*static_cast<Fn*>(context))(begin, end);
+                        },
+                        const_cast<void*>(static_cast<const void*>(&body)));
+    }
+
+    static ExecutorStats stats();
+
+private:
+    using ChunkFn = void (*)(void* context, size_t begin, size_t end);
+    static void parallelForImpl(size_t count, size_t grain, ChunkFn fn, void* context);
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_EXECUTOR_H
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "utils/jitter_monitor.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace sentinel {
+
+namespace {
+
+constexpr size_t TASK_COUNT = static_cast<size_t>(JitterTask::COUNT);
+
+const char* const TASK_NAMES[] = {
+    "loop",
+    "sensor_poll",
+    "vision_tick",
+    "mesh_process",
+    "state_save",
+    "memory_report",
+    "config_apply",
+    "heartbeat",
+    "node_cleanup",
+};
+static_assert(sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]) == TASK_COUNT,
+              "one name per task");
+
+struct TaskState {
+    LatencyHistogram lateness;
+    LatencyHistogram period;
+    LatencyHistogram run;
+    std::atomic<int64_t> last_wakeup_ns{0};
+    std::atomic<uint64_t> nominal_period_us{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint64_t> overruns_by[TASK_COUNT + 1] = {};
+    std::atomic<bool> warned{false};     // Overrun logged since the last report
+};
+
+TaskState& state(JitterTask task) {
+    // Never destroyed: threads may still record while statics are torn down
+    static TaskState* const tasks = new TaskState[TASK_COUNT];
+    return tasks[static_cast<size_t>(task)];
+}
+
+// Recent task executions on this thread, for overrun attribution. Plain
+// data, so thread_local access needs no initialization guard.
+struct RecentRun {
+    int task;                            // -1 = empty
+    int64_t start_ns;
+    int64_t end_ns;
+};
+
+constexpr size_t RECENT_RUNS = 8;
+thread_local RecentRun t_recent[RECENT_RUNS] = {
+    {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0},
+    {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0}, {-1, 0, 0},
+};
+thread_local size_t t_recent_next = 0;
+
+int64_t toNs(JitterMonitor::Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+uint64_t toUs(int64_t ns) {
+    return ns > 0 ? static_cast<uint64_t>(ns / 1000) : 0;
+}
+
+// Task on this thread whose execution overlapped the interval
+// [from_ns, to_ns] the most, or the scheduler if nothing covered at least
+// half of it
+size_t attributeDelay(int64_t from_ns, int64_t to_ns) {
+    size_t culprit = JITTER_CULPRIT_SCHEDULER;
+    int64_t best = 0;
+    for (const RecentRun& recent : t_recent) {
+        if (recent.task < 0) {
+            continue;
+        }
+        int64_t overlap = std::min(recent.end_ns, to_ns) - std::max(recent.start_ns, from_ns);
+        if (overlap > best) {
+            best = overlap;
+            culprit = static_cast<size_t>(recent.task);
+        }
+    }
+    return best * 2 >= to_ns - from_ns ? culprit : JITTER_CULPRIT_SCHEDULER;
+}
+
+const char* culpritName(size_t culprit) {
+    return culprit < TASK_COUNT ? TASK_NAMES[culprit] : "scheduler";
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0),
+      sum_us_(0),
+      max_us_(0) {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::add(uint64_t us) {
+    size_t index = us < 2 ? 0 : static_cast<size_t>(63 - __builtin_clzll(us));
+    if (index >= BUCKETS) {
+        index = BUCKETS - 1;
+    }
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t max = max_us_.load(std::memory_order_relaxed);
+    while (us > max && !max_us_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::meanUs() const {
+    uint64_t n = count();
+    return n ? static_cast<double>(sum_us_.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+uint64_t LatencyHistogram::percentileUs(double p) const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p / 100.0 * n + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, n));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += bucket(i);
+        if (seen >= rank) {
+            // The maximum is a tighter bound for the top bucket
+            return std::min(uint64_t(2) << i, maxUs());
+        }
+    }
+    return maxUs();
+}
+
+std::atomic<bool> JitterMonitor::enabled_(true);
+std::atomic<int> JitterMonitor::overrun_percent_(50);
+
+void JitterMonitor::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void JitterMonitor::setOverrunPercent(int percent) {
+    overrun_percent_.store(percent, std::memory_order_relaxed);
+}
+
+const char* JitterMonitor::taskName(JitterTask task) {
+    return TASK_NAMES[static_cast<size_t>(task)];
+}
+
+void JitterMonitor::recordWakeup(JitterTask task, Clock::time_point scheduled,
+                                 Clock::time_point actual, Clock::duration period) {
+    if (!enabled()) {
+        return;
+    }
+    TaskState& entry = state(task);
+
+    int64_t scheduled_ns = toNs(scheduled);
+    int64_t actual_ns = toNs(actual);
+    int64_t late_ns = actual_ns - scheduled_ns;
+    uint64_t late_us = toUs(late_ns);
+    uint64_t period_us = toUs(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count());
+
+    entry.lateness.add(late_us);
+    entry.nominal_period_us.store(period_us, std::memory_order_relaxed);
+    int64_t previous_ns = entry.last_wakeup_ns.exchange(actual_ns, std::memory_order_relaxed);
+    if (previous_ns != 0) {
+        entry.period.add(toUs(actual_ns - previous_ns));
+    }
+
+    int percent = overrun_percent_.load(std::memory_order_relaxed);
+    if (period_us == 0 || late_us * 100 <= period_us * static_cast<uint64_t>(percent)) {
+        return;
+    }
+
+    size_t culprit = attributeDelay(scheduled_ns, actual_ns);
+    entry.overruns.fetch_add(1, std::memory_order_relaxed);
+    entry.overruns_by[culprit].fetch_add(1, std::memory_order_relaxed);
+
+    // First overrun of each task per report interval; the rest are counted
+    if (!entry.warned.exchange(true, std::memory_order_relaxed)) {
+        Logger::logf(LogLevel::WARN, "Jitter: %s overrun, %llu us late (period %llu us), "
+                     "caused by %s", taskName(task), static_cast<unsigned long long>(late_us),
+                     static_cast<unsigned long long>(period_us), culpritName(culprit));
+    }
+}
+
+void JitterMonitor::recordRun(JitterTask task, Clock::time_point start, Clock::time_point end) {
+    if (!enabled()) {
+        return;
+    }
+    int64_t start_ns = toNs(start);
+    int64_t end_ns = toNs(end);
+    state(task).run.add(toUs(end_ns - start_ns));
+
+    RecentRun& recent = t_recent[t_recent_next];
+    recent.task = static_cast<int>(task);
+    recent.start_ns = start_ns;
+    recent.end_ns = end_ns;
+    t_recent_next = (t_recent_next + 1) % RECENT_RUNS;
+}
+
+JitterReport JitterMonitor::report() {
+    JitterReport report;
+    for (size_t i = 0; i < TASK_COUNT; i++) {
+        TaskState& entry = state(static_cast<JitterTask>(i));
+        JitterTaskStats& stats = report.tasks[i];
+        stats.name = TASK_NAMES[i];
+        stats.lateness = &entry.lateness;
+        stats.period = &entry.period;
+        stats.run = &entry.run;
+        stats.nominal_period_us = entry.nominal_period_us.load(std::memory_order_relaxed);
+        stats.overruns = entry.overruns.load(std::memory_order_relaxed);
+        for (size_t c = 0; c <= TASK_COUNT; c++) {
+            stats.overruns_by[c] = entry.overruns_by[c].load(std::memory_order_relaxed);
+        }
+    }
+    return report;
+}
+
+void JitterMonitor::logReport() {
+    // Runs from the main loop, so it uses the non-allocating logf
+    JitterReport report = JitterMonitor::report();
+
+    Logger::logf(LogLevel::INFO, "Jitter (us; p50/p99 are log2 bucket bounds):");
+    for (size_t i = 0; i < TASK_COUNT; i++) {
+        const JitterTaskStats& stats = report.tasks[i];
+        state(static_cast<JitterTask>(i)).warned.store(false, std::memory_order_relaxed);
+
+        if (stats.lateness->count() > 0) {
+            Logger::logf(LogLevel::INFO, "  %-13s %llu wakeups, period %llu: late p50 %llu "
+                         "p99 %llu max %llu",
+                         stats.name,
+                         static_cast<unsigned long long>(stats.lateness->count()),
+                         static_cast<unsigned long long>(stats.nominal_period_us),
+                         static_cast<unsigned long long>(stats.lateness->percentileUs(50)),
+                         static_cast<unsigned long long>(stats.lateness->percentileUs(99)),
+                         static_cast<unsigned long long>(stats.lateness->maxUs()));
+        }
+        if (stats.run->count() > 0) {
+            Logger::logf(LogLevel::INFO, "  %-13s %llu runs: run p50 %llu p99 %llu max %llu",
+                         stats.name,
+                         static_cast<unsigned long long>(stats.run->count()),
+                         static_cast<unsigned long long>(stats.run->percentileUs(50)),
+                         static_cast<unsigned long long>(stats.run->percentileUs(99)),
+                         static_cast<unsigned long long>(stats.run->maxUs()));
+        }
+
+        if (stats.overruns == 0) {
+            continue;
+        }
+        char culprits[256];
+        size_t used = 0;
+        culprits[0] = '\0';
+        for (size_t c = 0; c <= TASK_COUNT && used < sizeof(culprits); c++) {
+            if (stats.overruns_by[c] == 0) {
+                continue;
+            }
+            int n = std::snprintf(culprits + used, sizeof(culprits) - used, "%s%s %llu",
+                                  used ? ", " : "", culpritName(c),
+                                  static_cast<unsigned long long>(stats.overruns_by[c]));
+            if (n < 0) {
+                break;
+            }
+            used += static_cast<size_t>(n);
+        }
+        Logger::logf(LogLevel::WARN, "  %-13s %llu overruns (%s)", stats.name,
+                     static_cast<unsigned long long>(stats.overruns), culprits);
+    }
+}
+
+} // namespace sentinel
\ No newline at end of file
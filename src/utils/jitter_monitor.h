@@ -0,0 +1,131 @@
+#ifndef SENTINEL_JITTER_MONITOR_H
+#define SENTINEL_JITTER_MONITOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace sentinel {
+
+// Periodic and timed tasks. LOOP is the main loop's 10 ms sleep: its
+// wakeup lateness is pure scheduling latency (as measured by cyclictest).
+enum class JitterTask {
+    LOOP = 0,
+    SENSOR_POLL,
+    VISION_TICK,
+    MESH_PROCESS,
+    STATE_SAVE,
+    MEMORY_REPORT,
+    CONFIG_APPLY,
+    HEARTBEAT,
+    NODE_CLEANUP,
+    COUNT
+};
+
+// Overruns not explained by an instrumented task on the same thread:
+// preemption, page faults, sleep overshoot
+constexpr size_t JITTER_CULPRIT_SCHEDULER = static_cast<size_t>(JitterTask::COUNT);
+
+// Log2 histogram of microsecond durations: bucket 0 holds [0, 2) us, bucket
+// i holds [2^i, 2^(i+1)) us. Relaxed atomics only, so any thread may add
+// samples without locking or allocating.
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 32;
+
+    LatencyHistogram();
+
+    void add(uint64_t us);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t maxUs() const { return max_us_.load(std::memory_order_relaxed); }
+    uint64_t bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    double meanUs() const;
+
+    // Upper bound of the bucket holding the p-th percentile (0 if empty)
+    uint64_t percentileUs(double p) const;
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKETS];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_us_;
+    std::atomic<uint64_t> max_us_;
+};
+
+struct JitterTaskStats {
+    const char* name;
+    const LatencyHistogram* lateness;    // Wakeup time - scheduled time
+    const LatencyHistogram* period;      // Time between consecutive wakeups
+    const LatencyHistogram* run;         // Execution time
+    uint64_t nominal_period_us;          // Latest configured period
+    uint64_t overruns;
+    uint64_t overruns_by[static_cast<size_t>(JitterTask::COUNT) + 1];   // Per culprit
+};
+
+struct JitterReport {
+    JitterTaskStats tasks[static_cast<size_t>(JitterTask::COUNT)];
+};
+
+// Built-in scheduling jitter monitor, cheap enough to stay on in
+// production. Periodic tasks report when they were due and when they
+// actually ran; every task reports its execution time. A wakeup later
+// than overrun_pct of its period counts as an overrun and is attributed to
+// the task whose execution on the same thread covered most of the delay,
+// or to the scheduler if none did.
+class JitterMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static void setEnabled(bool enabled);
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Lateness threshold for overruns, in percent of the task's period
+    static void setOverrunPercent(int percent);
+
+    // A periodic task due at scheduled started at actual
+    static void recordWakeup(JitterTask task, Clock::time_point scheduled,
+                             Clock::time_point actual, Clock::duration period);
+
+    // Execution of a task on the calling thread
+    static void recordRun(JitterTask task, Clock::time_point start, Clock::time_point end);
+
+    // Histograms are cumulative since startup
+    static JitterReport report();
+
+    // Log report() for every task that has run
+    static void logReport();
+
+    static const char* taskName(JitterTask task);
+
+private:
+    static std::atomic<bool> enabled_;
+    static std::atomic<int> overrun_percent_;
+};
+
+// Times a task from construction to destruction
+class JitterScope {
+public:
+    explicit JitterScope(JitterTask task)
+        : task_(task),
+          start_(JitterMonitor::enabled() ? JitterMonitor::Clock::now() :
+                 JitterMonitor::Clock::time_point()) {
+    }
+
+    ~JitterScope() {
+        if (start_.time_since_epoch().count() != 0) {
+            JitterMonitor::recordRun(task_, start_, JitterMonitor::Clock::now());
+        }
+    }
+
+    JitterScope(const JitterScope&) = delete;
+    JitterScope& operator=(const JitterScope&) = delete;
+
+private:
+    JitterTask task_;
+    JitterMonitor::Clock::time_point start_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_JITTER_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,461 @@
+#include "utils/json_parser.h"
+#include <charconv>
+#include <cstdlib>
+#include <limits>
+
+namespace sentinel {
+
+// JsonValue implementation
+
+bool JsonValue::asInt(long long& out) const {
+    if (type != JsonType::NUMBER) {
+        return false;
+    }
+
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(begin, end, out);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool JsonValue::asDouble(double& out) const {
+    if (type != JsonType::NUMBER) {
+        return false;
+    }
+
+    // Numbers are short; copy into a terminated buffer for strtod
+    char buffer[64];
+    if (text.size() >= sizeof(buffer)) {
+        return false;
+    }
+    text.copy(buffer, text.size());
+    buffer[text.size()] = '\0';
+
+    char* end = nullptr;
+    out = std::strtod(buffer, &end);
+    return end == buffer + text.size();
+}
+
+bool JsonValue::asBool(bool& out) const {
+    if (type != JsonType::BOOLEAN) {
+        return false;
+    }
+    out = (text == "true");
+    return true;
+}
+
+static void appendUtf8(std::string& out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+static bool parseHex4(std::string_view text, size_t pos, uint32_t& out) {
+    if (pos + 4 > text.size()) {
+        return false;
+    }
+    out = 0;
+    for (size_t i = pos; i < pos + 4; i++) {
+        char c = text[i];
+        out <<= 4;
+        if (c >= '0' && c <= '9') out |= static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') out |= static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') out |= static_cast<uint32_t>(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+std::string JsonValue::asString() const {
+    if (!has_escapes) {
+        return std::string(text);
+    }
+
+    // Escapes were validated by the tokenizer
+    std::string out;
+    out.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c != '\\' || i + 1 >= text.size()) {
+            out += c;
+            continue;
+        }
+
+        char esc = text[++i];
+        switch (esc) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                uint32_t codepoint = 0;
+                if (parseHex4(text, i + 1, codepoint)) {
+                    i += 4;
+                    // Combine UTF-16 surrogate pairs
+                    uint32_t low = 0;
+                    if (codepoint >= 0xD800 && codepoint <= 0xDBFF &&
+                        i + 2 < text.size() && text[i + 1] == '\\' && text[i + 2] == 'u' &&
+                        parseHex4(text, i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                    appendUtf8(out, codepoint);
+                }
+                break;
+            }
+            default:
+                out += esc; // \" \\ \/
+                break;
+        }
+    }
+
+    return out;
+}
+
+const char* JsonValue::typeName() const {
+    switch (type) {
+        case JsonType::STRING:     return "string";
+        case JsonType::NUMBER:     return "number";
+        case JsonType::BOOLEAN:    return "boolean";
+        case JsonType::NULL_VALUE: return "null";
+        default:                   return "unknown";
+    }
+}
+
+// JsonPath implementation
+
+JsonPath::JsonPath() : depth_(0) {
+    path_.reserve(128);
+}
+
+size_t JsonPath::pushKey(std::string_view key) {
+    size_t previous = path_.size();
+    if (!path_.empty()) {
+        path_ += '.';
+    }
+    path_.append(key.data(), key.size());
+    depth_++;
+    return previous;
+}
+
+size_t JsonPath::pushIndex(size_t index) {
+    size_t previous = path_.size();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), index);
+    path_ += '[';
+    path_.append(buffer, result.ptr);
+    path_ += ']';
+    depth_++;
+    return previous;
+}
+
+void JsonPath::pop(size_t previous_length) {
+    path_.resize(previous_length);
+    depth_--;
+}
+
+// JsonParser implementation
+
+JsonParser::JsonParser() : pos_(0), line_(1), line_start_(0) {}
+
+bool JsonParser::parse(std::string_view text, JsonVisitor& visitor) {
+    text_ = text;
+    pos_ = 0;
+    line_ = 1;
+    line_start_ = 0;
+    error_.clear();
+    path_ = JsonPath();
+
+    skipWhitespace();
+    if (!parseValue(visitor, 0)) {
+        return false;
+    }
+
+    skipWhitespace();
+    if (pos_ != text_.size()) {
+        return fail("unexpected trailing content");
+    }
+
+    return true;
+}
+
+void JsonParser::skipWhitespace() {
+    while (pos_ < text_.size()) {
+        char c = text_[pos_];
+        if (c == '\n') {
+            line_++;
+            line_start_ = pos_ + 1;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            break;
+        }
+        pos_++;
+    }
+}
+
+bool JsonParser::fail(const std::string& message) {
+    error_ = std::to_string(line_) + ":" + std::to_string(pos_ - line_start_ + 1) + ": ";
+    if (!path_.str().empty()) {
+        error_ += std::string(path_.str()) + ": ";
+    }
+    error_ += message;
+    return false;
+}
+
+bool JsonParser::parseValue(JsonVisitor& visitor, size_t depth) {
+    if (pos_ >= text_.size()) {
+        return fail("unexpected end of input");
+    }
+
+    JsonValue value;
+    value.line = line_;
+    value.column = pos_ - line_start_ + 1;
+
+    char c = text_[pos_];
+    switch (c) {
+        case '{':
+            return parseObject(visitor, depth + 1);
+        case '[':
+            return parseArray(visitor, depth + 1);
+        case '"':
+            value.type = JsonType::STRING;
+            if (!parseString(value.text, value.has_escapes)) {
+                return false;
+            }
+            break;
+        case 't':
+            value.type = JsonType::BOOLEAN;
+            value.text = text_.substr(pos_, 4);
+            if (!parseLiteral("true")) return false;
+            break;
+        case 'f':
+            value.type = JsonType::BOOLEAN;
+            value.text = text_.substr(pos_, 5);
+            if (!parseLiteral("false")) return false;
+            break;
+        case 'n':
+            value.type = JsonType::NULL_VALUE;
+            value.text = text_.substr(pos_, 4);
+            if (!parseLiteral("null")) return false;
+            break;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                value.type = JsonType::NUMBER;
+                if (!parseNumber(value.text)) {
+                    return false;
+                }
+                break;
+            }
+            return fail(std::string("unexpected character '") + c + "'");
+    }
+
+    return visitor.onValue(path_, value);
+}
+
+bool JsonParser::parseObject(JsonVisitor& visitor, size_t depth) {
+    if (depth > MAX_DEPTH) {
+        return fail("nesting too deep");
+    }
+    if (!visitor.onContainer(path_, false)) {
+        return false;
+    }
+
+    pos_++; // Skip '{'
+    skipWhitespace();
+
+    if (pos_ < text_.size() && text_[pos_] == '}') {
+        pos_++;
+        return true;
+    }
+
+    while (true) {
+        if (pos_ >= text_.size() || text_[pos_] != '"') {
+            return fail("expected object key");
+        }
+
+        std::string_view key;
+        bool has_escapes = false;
+        if (!parseString(key, has_escapes)) {
+            return false;
+        }
+        if (has_escapes) {
+            return fail("escape sequences are not supported in keys");
+        }
+
+        skipWhitespace();
+        if (pos_ >= text_.size() || text_[pos_] != ':') {
+            return fail("expected ':' after key \"" + std::string(key) + "\"");
+        }
+        pos_++;
+        skipWhitespace();
+
+        size_t previous = path_.pushKey(key);
+        if (!parseValue(visitor, depth)) {
+            return false;
+        }
+        path_.pop(previous);
+
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            return fail("unterminated object");
+        }
+        if (text_[pos_] == ',') {
+            pos_++;
+            skipWhitespace();
+            continue;
+        }
+        if (text_[pos_] == '}') {
+            pos_++;
+            return true;
+        }
+        return fail("expected ',' or '}'");
+    }
+}
+
+bool JsonParser::parseArray(JsonVisitor& visitor, size_t depth) {
+    if (depth > MAX_DEPTH) {
+        return fail("nesting too deep");
+    }
+    if (!visitor.onContainer(path_, true)) {
+        return false;
+    }
+
+    pos_++; // Skip '['
+    skipWhitespace();
+
+    if (pos_ < text_.size() && text_[pos_] == ']') {
+        pos_++;
+        return true;
+    }
+
+    for (size_t index = 0;; index++) {
+        size_t previous = path_.pushIndex(index);
+        if (!parseValue(visitor, depth)) {
+            return false;
+        }
+        path_.pop(previous);
+
+        skipWhitespace();
+        if (pos_ >= text_.size()) {
+            return fail("unterminated array");
+        }
+        if (text_[pos_] == ',') {
+            pos_++;
+            skipWhitespace();
+            continue;
+        }
+        if (text_[pos_] == ']') {
+            pos_++;
+            return true;
+        }
+        return fail("expected ',' or ']'");
+    }
+}
+
+bool JsonParser::parseString(std::string_view& out, bool& has_escapes) {
+    pos_++; // Skip opening quote
+    size_t start = pos_;
+    has_escapes = false;
+
+    while (pos_ < text_.size()) {
+        char c = text_[pos_];
+        if (c == '"') {
+            out = text_.substr(start, pos_ - start);
+            pos_++;
+            return true;
+        }
+        if (c == '\\') {
+            has_escapes = true;
+            if (pos_ + 1 >= text_.size()) {
+                break;
+            }
+            char esc = text_[pos_ + 1];
+            if (esc == 'u') {
+                uint32_t codepoint = 0;
+                if (!parseHex4(text_, pos_ + 2, codepoint)) {
+                    return fail("invalid \\u escape");
+                }
+                pos_ += 6;
+                continue;
+            }
+            if (esc != '"' && esc != '\\' && esc != '/' && esc != 'b' &&
+                esc != 'f' && esc != 'n' && esc != 'r' && esc != 't') {
+                return fail(std::string("invalid escape '\\") + esc + "'");
+            }
+            pos_ += 2;
+            continue;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return fail("control character in string");
+        }
+        pos_++;
+    }
+
+    return fail("unterminated string");
+}
+
+bool JsonParser::parseNumber(std::string_view& out) {
+    size_t start = pos_;
+
+    if (text_[pos_] == '-') {
+        pos_++;
+    }
+
+    auto isDigit = [this]() {
+        return pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9';
+    };
+
+    if (!isDigit()) {
+        return fail("invalid number");
+    }
+    if (text_[pos_] == '0') {
+        pos_++;
+    } else {
+        while (isDigit()) pos_++;
+    }
+
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+        pos_++;
+        if (!isDigit()) {
+            return fail("expected digit after decimal point");
+        }
+        while (isDigit()) pos_++;
+    }
+
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+        pos_++;
+        if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+            pos_++;
+        }
+        if (!isDigit()) {
+            return fail("expected digit in exponent");
+        }
+        while (isDigit()) pos_++;
+    }
+
+    out = text_.substr(start, pos_ - start);
+    return true;
+}
+
+bool JsonParser::parseLiteral(std::string_view literal) {
+    if (text_.compare(pos_, literal.size(), literal) != 0) {
+        return fail("invalid literal");
+    }
+    pos_ += literal.size();
+    return true;
+}
+
+} // namespace sentinel
\ No newline at end of file
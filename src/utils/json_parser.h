@@ -0,0 +1,115 @@
+#ifndef SENTINEL_JSON_PARSER_H
+#define SENTINEL_JSON_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sentinel {
+
+enum class JsonType {
+    STRING,
+    NUMBER,
+    BOOLEAN,
+    NULL_VALUE
+};
+
+// Scalar value produced by the tokenizer. Text is a view into the
+// document being parsed and is only valid during the visitor callback.
+struct JsonValue {
+    JsonType type = JsonType::NULL_VALUE;
+    std::string_view text;      // String contents without quotes, or raw literal
+    bool has_escapes = false;   // String contains backslash escapes
+    size_t line = 0;
+    size_t column = 0;
+
+    // Typed accessors (return false on type mismatch or overflow)
+    bool asInt(long long& out) const;
+    bool asDouble(double& out) const;
+    bool asBool(bool& out) const;
+
+    // Decode string value (only copies when the caller needs ownership)
+    std::string asString() const;
+
+    // Human-readable type name for error messages
+    const char* typeName() const;
+};
+
+// Dotted path of the value currently being visited, e.g. "lora.frequency_mhz"
+// or "alert.notification_methods[1]". Storage is reused across the whole
+// parse, so pushing and popping segments does not allocate after warm-up.
+class JsonPath {
+public:
+    JsonPath();
+
+    std::string_view str() const { return path_; }
+    size_t depth() const { return depth_; }
+
+private:
+    friend class JsonParser;
+
+    size_t pushKey(std::string_view key);
+    size_t pushIndex(size_t index);
+    void pop(size_t previous_length);
+
+    std::string path_;
+    size_t depth_;
+};
+
+// Receives every scalar in document order
+class JsonVisitor {
+public:
+    virtual ~JsonVisitor() = default;
+
+    // Return false to abort the parse (the visitor keeps its own error)
+    virtual bool onValue(const JsonPath& path, const JsonValue& value) = 0;
+
+    // Called when an object or array starts (optional)
+    virtual bool onContainer(const JsonPath& path, bool is_array) {
+        (void)path;
+        (void)is_array;
+        return true;
+    }
+};
+
+// Single-pass, zero-copy JSON tokenizer. Walks the document once and hands
+// each scalar to the visitor together with its fully qualified path.
+class JsonParser {
+public:
+    static constexpr size_t MAX_DEPTH = 32;
+
+    JsonParser();
+
+    // Parse a complete document. Returns false with getError() set on failure.
+    bool parse(std::string_view text, JsonVisitor& visitor);
+
+    // Error message including line and column ("12:7: expected ':'")
+    const std::string& getError() const { return error_; }
+
+    // Current path (valid during visitor callbacks)
+    const JsonPath& path() const { return path_; }
+
+private:
+    bool parseValue(JsonVisitor& visitor, size_t depth);
+    bool parseObject(JsonVisitor& visitor, size_t depth);
+    bool parseArray(JsonVisitor& visitor, size_t depth);
+    bool parseString(std::string_view& out, bool& has_escapes);
+    bool parseNumber(std::string_view& out);
+    bool parseLiteral(std::string_view literal);
+
+    void skipWhitespace();
+    bool fail(const std::string& message);
+
+    std::string_view text_;
+    size_t pos_;
+    size_t line_;
+    size_t line_start_;
+
+    JsonPath path_;
+    std::string error_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_JSON_PARSER_H
\ No newline at end of file
@@ -1,30 +1,90 @@
 #include "utils/logger.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include "utils/memory_tracker.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
 
 namespace sentinel {
 
+// Lines up to this length are assembled on the stack
+constexpr size_t LOG_LINE_SIZE = 512;
+
 LogLevel Logger::current_level_ = LogLevel::INFO;
+std::atomic<std::FILE*> Logger::file_{nullptr};
+
+namespace {
+
+// Write the whole line with one call so lines from different threads
+// do not interleave. Oversized messages go through the (accounted)
+// logging memory resource.
+void writeLine(std::FILE* out, const char* prefix, size_t prefix_len, const char* message,
+               size_t length) {
+    char stack_line[LOG_LINE_SIZE];
+    size_t line_len = prefix_len + length + 1;
+    std::pmr::string heap_line(&MemoryTracker::resource(MemorySubsystem::LOGGING));
+    char* line = stack_line;
+    if (line_len > sizeof(stack_line)) {
+        heap_line.resize(line_len);
+        line = &heap_line[0];
+    }
+    
+    std::memcpy(line, prefix, prefix_len);
+    std::memcpy(line + prefix_len, message, length);
+    line[line_len - 1] = '\n';
+    
+    std::fwrite(line, 1, line_len, out);
+    std::fflush(out);
+}
+
+} // namespace
 
 void Logger::setLevel(LogLevel level) {
     current_level_ = level;
 }
 
-std::string Logger::getCurrentTime() {
+bool Logger::setFile(const std::string& path) {
+    std::FILE* file = nullptr;
+    if (!path.empty()) {
+        file = std::fopen(path.c_str(), "ae");
+        if (!file) {
+            logf(LogLevel::ERROR, "Cannot open log file %s: %s", path.c_str(),
+                 std::strerror(errno));
+            return false;
+        }
+    }
+    std::FILE* previous = file_.exchange(file, std::memory_order_acq_rel);
+    if (previous) {
+        std::fclose(previous);
+    }
+    return true;
+}
+
+LogLevel Logger::levelFromString(const std::string& level) {
+    if (level == "DEBUG") return LogLevel::DEBUG;
+    if (level == "WARN")  return LogLevel::WARN;
+    if (level == "ERROR") return LogLevel::ERROR;
+    return LogLevel::INFO;
+}
+
+size_t Logger::formatTime(char* buffer, size_t size) {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()) % 1000;
     
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    struct tm local_time;
+    localtime_r(&time_t, &local_time);
     
-    return ss.str();
+    size_t len = std::strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &local_time);
+    len += std::snprintf(buffer + len, size - len, ".%03d", static_cast<int>(ms.count()));
+    return len;
 }
 
-std::string Logger::levelToString(LogLevel level) {
+const char* Logger::levelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:   return "DEBUG";
         case LogLevel::INFO:    return "INFO ";
@@ -34,13 +94,15 @@ std::string Logger::levelToString(LogLevel level) {
     }
 }
 
-void Logger::log(LogLevel level, const std::string& message) {
+void Logger::log(LogLevel level, const char* message, size_t length) {
     if (level < current_level_) {
         return;
     }
     
-    std::string timestamp = getCurrentTime();
-    std::string level_str = levelToString(level);
+    // Over its memory budget, logging keeps only warnings and errors
+    if (level < LogLevel::WARN && MemoryTracker::shouldShed(MemorySubsystem::LOGGING)) {
+        return;
+    }
     
     // Color codes for different log levels
     const char* color = "";
@@ -61,25 +123,69 @@ void Logger::log(LogLevel level, const std::string& message) {
             break;
     }
     
-    std::cout << "[" << timestamp << "] "
-              << color << level_str << reset << " - "
-              << message << std::endl;
+    char timestamp[32];
+    formatTime(timestamp, sizeof(timestamp));
+    
+    char prefix[96];
+    int prefix_len = std::snprintf(prefix, sizeof(prefix), "[%s] %s%s%s - ",
+                                   timestamp, color, levelToString(level), reset);
+    writeLine(stdout, prefix, prefix_len, message, length);
+    
+    std::FILE* file = file_.load(std::memory_order_acquire);
+    if (file) {
+        prefix_len = std::snprintf(prefix, sizeof(prefix), "[%s] %s - ",
+                                   timestamp, levelToString(level));
+        writeLine(file, prefix, prefix_len, message, length);
+    }
+}
+
+void Logger::logf(LogLevel level, const char* format, ...) {
+    if (level < current_level_) {
+        return;
+    }
+    
+    char message[LOG_LINE_SIZE - 96];
+    va_list args;
+    va_start(args, format);
+    int len = std::vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    
+    if (len < 0) {
+        return;
+    }
+    log(level, message, std::min(static_cast<size_t>(len), sizeof(message) - 1));
 }
 
 void Logger::debug(const std::string& message) {
-    log(LogLevel::DEBUG, message);
+    log(LogLevel::DEBUG, message.data(), message.size());
 }
 
 void Logger::info(const std::string& message) {
-    log(LogLevel::INFO, message);
+    log(LogLevel::INFO, message.data(), message.size());
 }
 
 void Logger::warn(const std::string& message) {
-    log(LogLevel::WARN, message);
+    log(LogLevel::WARN, message.data(), message.size());
 }
 
 void Logger::error(const std::string& message) {
-    log(LogLevel::ERROR, message);
+    log(LogLevel::ERROR, message.data(), message.size());
+}
+
+void Logger::debug(const char* message) {
+    log(LogLevel::DEBUG, message, std::strlen(message));
+}
+
+void Logger::info(const char* message) {
+    log(LogLevel::INFO, message, std::strlen(message));
+}
+
+void Logger::warn(const char* message) {
+    log(LogLevel::WARN, message, std::strlen(message));
+}
+
+void Logger::error(const char* message) {
+    log(LogLevel::ERROR, message, std::strlen(message));
 }
 
 } // namespace sentinel
\ No newline at end of file
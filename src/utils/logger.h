@@ -3,6 +3,8 @@
 
 #include <string>
 #include <chrono>
+#include <atomic>
+#include <cstdio>
 
 namespace sentinel {
 
@@ -17,17 +19,38 @@ class Logger {
 public:
     static void setLevel(LogLevel level);
     
+    // Also append every line to path (system.log_file), without colours.
+    // Call at startup, before other threads log. Empty path: stdout only.
+    static bool setFile(const std::string& path);
+    
+    // Parse "DEBUG", "INFO", "WARN" or "ERROR" (defaults to INFO)
+    static LogLevel levelFromString(const std::string& level);
+    
     static void debug(const std::string& message);
     static void info(const std::string& message);
     static void warn(const std::string& message);
     static void error(const std::string& message);
     
+    // Literal messages are logged without building a std::string
+    static void debug(const char* message);
+    static void info(const char* message);
+    static void warn(const char* message);
+    static void error(const char* message);
+    
+    // printf-style logging for hot paths: filtered before formatting and
+    // formatted into a stack buffer, so it does not allocate
+    static void logf(LogLevel level, const char* format, ...)
+        __attribute__((format(printf, 2, 3)));
+    
+    static bool isEnabled(LogLevel level) { return level >= current_level_; }
+    
 private:
-    static void log(LogLevel level, const std::string& message);
-    static std::string getCurrentTime();
-    static std::string levelToString(LogLevel level);
+    static void log(LogLevel level, const char* message, size_t length);
+    static size_t formatTime(char* buffer, size_t size);
+    static const char* levelToString(LogLevel level);
     
     static LogLevel current_level_;
+    static std::atomic<std::FILE*> file_;
 };
 
 } // namespace sentinel
@@ -0,0 +1,166 @@
+#include "utils/memory_tracker.h"
+#include "utils/logger.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+namespace sentinel {
+
+TrackingResource::TrackingResource(const char* name, std::pmr::memory_resource* upstream)
+    : name_(name),
+      upstream_(upstream),
+      live_bytes_(0),
+      peak_bytes_(0),
+      total_allocated_(0),
+      allocation_count_(0),
+      budget_bytes_(0) {
+}
+
+void* TrackingResource::do_allocate(size_t bytes, size_t alignment) {
+    void* p = upstream_->allocate(bytes, alignment);
+
+    size_t live = live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    total_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    allocation_count_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (live > peak &&
+           !peak_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return p;
+}
+
+void TrackingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool TrackingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+std::atomic<bool> MemoryTracker::shed_load_(false);
+
+TrackingResource& MemoryTracker::resource(MemorySubsystem subsystem) {
+    // Never destroyed: containers with static storage duration may release
+    // memory after this function's statics would have been torn down
+    static TrackingResource* const resources[] = {
+        new TrackingResource("vision"),
+        new TrackingResource("mesh"),
+        new TrackingResource("sensor"),
+        new TrackingResource("logging"),
+        new TrackingResource("storage"),
+    };
+    static_assert(sizeof(resources) / sizeof(resources[0]) ==
+                  static_cast<size_t>(MemorySubsystem::COUNT),
+                  "one resource per subsystem");
+    return *resources[static_cast<size_t>(subsystem)];
+}
+
+void MemoryTracker::setBudget(MemorySubsystem subsystem, size_t bytes) {
+    resource(subsystem).setBudget(bytes);
+}
+
+void MemoryTracker::setShedLoad(bool enabled) {
+    shed_load_.store(enabled, std::memory_order_relaxed);
+}
+
+bool MemoryTracker::shouldShed(MemorySubsystem subsystem) {
+    return shed_load_.load(std::memory_order_relaxed) && resource(subsystem).overBudget();
+}
+
+size_t MemoryTracker::residentBytes() {
+    // statm: size resident shared text lib data dt (in pages). Read into a
+    // stack buffer: a stdio FILE would allocate on the detection loop.
+    int fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    char text[128];
+    ssize_t len = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (len <= 0) {
+        return 0;
+    }
+    text[len] = '\0';
+
+    unsigned long size_pages = 0;
+    unsigned long resident_pages = 0;
+    if (std::sscanf(text, "%lu %lu", &size_pages, &resident_pages) != 2) {
+        return 0;
+    }
+
+    return static_cast<size_t>(resident_pages) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+MemoryReport MemoryTracker::report() {
+    constexpr size_t count = static_cast<size_t>(MemorySubsystem::COUNT);
+
+    // Totals at the previous report, for allocation rates
+    static std::mutex mutex;
+    static uint64_t last_total[count] = {};
+    static std::chrono::steady_clock::time_point last_time;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // No rate on the first call: there is no interval to measure yet
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = last_time.time_since_epoch().count() == 0 ? 0.0 :
+                     std::chrono::duration<double>(now - last_time).count();
+    last_time = now;
+
+    MemoryReport report;
+    report.tracked_bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        const TrackingResource& res = resource(static_cast<MemorySubsystem>(i));
+        uint64_t total = res.totalAllocated();
+
+        SubsystemMemory& entry = report.subsystems[i];
+        entry.name = res.name();
+        entry.live_bytes = res.liveBytes();
+        entry.peak_bytes = res.peakBytes();
+        entry.budget_bytes = res.budget();
+        entry.allocations = res.allocationCount();
+        entry.allocation_rate = elapsed > 0 ? (total - last_total[i]) / elapsed : 0.0;
+
+        last_total[i] = total;
+        report.tracked_bytes += entry.live_bytes;
+    }
+
+    report.rss_bytes = residentBytes();
+    report.untracked_bytes = report.rss_bytes > report.tracked_bytes ?
+                             report.rss_bytes - report.tracked_bytes : 0;
+    return report;
+}
+
+void MemoryTracker::logReport() {
+    // Runs from the main loop, so it uses the non-allocating logf
+    MemoryReport report = MemoryTracker::report();
+
+    Logger::logf(LogLevel::INFO, "Memory: RSS %zu KB, tracked %zu KB, untracked %zu KB "
+                 "(code, model, OpenCV/TFLite buffers)",
+                 report.rss_bytes / 1024, report.tracked_bytes / 1024,
+                 report.untracked_bytes / 1024);
+
+    for (const SubsystemMemory& entry : report.subsystems) {
+        if (entry.budget_bytes) {
+            Logger::logf(LogLevel::INFO, "  %s: live %zu KB, peak %zu KB, %.0f B/s, budget %zu KB",
+                         entry.name, entry.live_bytes / 1024, entry.peak_bytes / 1024,
+                         entry.allocation_rate, entry.budget_bytes / 1024);
+        } else {
+            Logger::logf(LogLevel::INFO, "  %s: live %zu KB, peak %zu KB, %.0f B/s",
+                         entry.name, entry.live_bytes / 1024, entry.peak_bytes / 1024,
+                         entry.allocation_rate);
+        }
+
+        if (entry.budget_bytes && entry.live_bytes > entry.budget_bytes) {
+            Logger::logf(LogLevel::WARN, "Memory budget exceeded for %s: %zu KB > %zu KB%s",
+                         entry.name, entry.live_bytes / 1024, entry.budget_bytes / 1024,
+                         shed_load_.load(std::memory_order_relaxed) ? " - shedding load" : "");
+        }
+    }
+}
+
+} // namespace sentinel
\ No newline at end of file
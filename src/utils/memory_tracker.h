@@ -0,0 +1,103 @@
+#ifndef SENTINEL_MEMORY_TRACKER_H
+#define SENTINEL_MEMORY_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace sentinel {
+
+// Subsystems with their own accounted memory resource
+enum class MemorySubsystem {
+    VISION = 0,
+    MESH,
+    SENSOR,
+    LOGGING,
+    STORAGE,
+    COUNT
+};
+
+// std::pmr resource that forwards to an upstream resource and counts what
+// passes through it. All counters are relaxed atomics, so a resource can be
+// shared between threads and read by the reporter at any time.
+class TrackingResource : public std::pmr::memory_resource {
+public:
+    explicit TrackingResource(const char* name,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    const char* name() const { return name_; }
+
+    size_t liveBytes() const { return live_bytes_.load(std::memory_order_relaxed); }
+    size_t peakBytes() const { return peak_bytes_.load(std::memory_order_relaxed); }
+    uint64_t totalAllocated() const { return total_allocated_.load(std::memory_order_relaxed); }
+    uint64_t allocationCount() const { return allocation_count_.load(std::memory_order_relaxed); }
+
+    // Budget in bytes (0 = unlimited)
+    void setBudget(size_t bytes) { budget_bytes_.store(bytes, std::memory_order_relaxed); }
+    size_t budget() const { return budget_bytes_.load(std::memory_order_relaxed); }
+    bool overBudget() const {
+        size_t limit = budget();
+        return limit != 0 && liveBytes() > limit;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    const char* name_;
+    std::pmr::memory_resource* upstream_;
+    std::atomic<size_t> live_bytes_;
+    std::atomic<size_t> peak_bytes_;
+    std::atomic<uint64_t> total_allocated_;
+    std::atomic<uint64_t> allocation_count_;
+    std::atomic<size_t> budget_bytes_;
+};
+
+struct SubsystemMemory {
+    const char* name;
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t budget_bytes;
+    uint64_t allocations;
+    double allocation_rate;          // Bytes allocated per second since last report
+};
+
+struct MemoryReport {
+    SubsystemMemory subsystems[static_cast<size_t>(MemorySubsystem::COUNT)];
+    size_t tracked_bytes;            // Sum of live bytes
+    size_t rss_bytes;                // Resident set size from /proc/self/statm
+    size_t untracked_bytes;          // RSS not explained by tracked allocations
+};
+
+// Registry of the per-subsystem resources
+class MemoryTracker {
+public:
+    static TrackingResource& resource(MemorySubsystem subsystem);
+
+    static void setBudget(MemorySubsystem subsystem, size_t bytes);
+
+    // When enabled, subsystems over budget shed load (see shouldShed)
+    static void setShedLoad(bool enabled);
+
+    // True if the subsystem is over budget and load shedding is enabled
+    static bool shouldShed(MemorySubsystem subsystem);
+
+    // Snapshot of all subsystems; allocation rates cover the interval
+    // since the previous call
+    static MemoryReport report();
+
+    // Log report() and warn about subsystems over budget
+    static void logReport();
+
+    // Resident set size in bytes (0 if unavailable)
+    static size_t residentBytes();
+
+private:
+    static std::atomic<bool> shed_load_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_MEMORY_TRACKER_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef SENTINEL_MPSC_QUEUE_H
+#define SENTINEL_MPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sentinel {
+
+// Bounded lock-free queue for many producers and one consumer (after
+// Vyukov's bounded MPMC queue). Each slot carries a sequence number that
+// tells producers whether it is free and the consumer whether it is
+// filled, so push() is one CAS on the tail and pop() needs no atomic
+// read-modify-write at all. Storage is inline: nothing allocates, and a
+// full queue rejects the push instead of blocking the producer.
+template <typename T, size_t N>
+class MpscQueue {
+public:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue capacity must be a power of two");
+
+    MpscQueue() : tail_(0), head_(0) {
+        for (size_t i = 0; i < N; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread. False if the queue is full.
+    bool push(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & (N - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only. False if the queue is empty (or the oldest
+    // push has claimed its slot but not finished writing it).
+    bool pop(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & (N - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        value = slot.value;
+        slot.sequence.store(pos + N, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate when producers are active
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    // Producers and the consumer write different cache lines
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::array<Slot, N> slots_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_MPSC_QUEUE_H
\ No newline at end of file
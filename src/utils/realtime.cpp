@@ -0,0 +1,163 @@
+#include "utils/realtime.h"
+#include "utils/logger.h"
+#include <pthread.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace sentinel {
+
+namespace {
+
+struct RolePolicy {
+    int priority = 0;
+    bool all_cpus = true;
+    cpu_set_t cpus;
+};
+
+// Written by setPolicy() during startup, before the threads that read
+// them exist
+RolePolicy g_policies[static_cast<size_t>(ThreadRole::COUNT)];
+cpu_set_t g_process_cpus;
+bool g_process_cpus_known = false;
+
+std::atomic<bool> g_warned(false);
+
+// COUNT = no role applied yet (process defaults)
+thread_local ThreadRole t_role = ThreadRole::COUNT;
+
+const char* const ROLE_NAMES[] = {
+    "core",
+    "radio",
+    "inference",
+    "background",
+};
+static_assert(sizeof(ROLE_NAMES) / sizeof(ROLE_NAMES[0]) ==
+              static_cast<size_t>(ThreadRole::COUNT), "one name per role");
+
+void warnOnce(const char* what, int error) {
+    if (!g_warned.exchange(true)) {
+        Logger::logf(LogLevel::WARN, "Real-time mode: %s failed (%s)%s", what,
+                     std::strerror(error),
+                     error == EPERM ? " - run as root or grant CAP_SYS_NICE/CAP_IPC_LOCK" : "");
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Realtime::enabled_(false);
+
+void Realtime::setPolicy(ThreadRole role, int priority, const cpu_set_t& cpus) {
+    if (!g_process_cpus_known) {
+        CPU_ZERO(&g_process_cpus);
+        g_process_cpus_known = sched_getaffinity(0, sizeof(g_process_cpus), &g_process_cpus) == 0;
+    }
+
+    RolePolicy& policy = g_policies[static_cast<size_t>(role)];
+    policy.priority = priority;
+    policy.all_cpus = CPU_COUNT(&cpus) == 0;
+    policy.cpus = cpus;
+}
+
+void Realtime::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Realtime::lockMemory() {
+    if (!enabled()) {
+        return true;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        Logger::logf(LogLevel::WARN, "Real-time mode: mlockall failed (%s) - "
+                     "page faults may stall the loop", std::strerror(errno));
+        return false;
+    }
+    Logger::info("Real-time mode: memory locked");
+    return true;
+}
+
+bool Realtime::applyRole(ThreadRole role) {
+    if (!enabled()) {
+        return true;
+    }
+
+    int priority = 0;
+    const cpu_set_t* cpus = g_process_cpus_known ? &g_process_cpus : nullptr;
+    if (role != ThreadRole::COUNT) {
+        const RolePolicy& policy = g_policies[static_cast<size_t>(role)];
+        priority = policy.priority;
+        if (!policy.all_cpus) {
+            cpus = &policy.cpus;
+        }
+    }
+
+    bool ok = true;
+    if (cpus) {
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(*cpus), cpus);
+        if (error != 0) {
+            warnOnce("pthread_setaffinity_np", error);
+            ok = false;
+        }
+    }
+
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    int error = pthread_setschedparam(pthread_self(), priority > 0 ? SCHED_FIFO : SCHED_OTHER,
+                                      &param);
+    if (error != 0) {
+        warnOnce("pthread_setschedparam", error);
+        ok = false;
+    }
+
+    t_role = role;
+    return ok;
+}
+
+ThreadRole Realtime::currentRole() {
+    return t_role;
+}
+
+bool Realtime::parseCpuList(const std::string& text, cpu_set_t& cpus) {
+    CPU_ZERO(&cpus);
+    const char* p = text.c_str();
+    while (*p) {
+        char* end = nullptr;
+        errno = 0;
+        long first = std::strtol(p, &end, 10);
+        if (end == p || errno != 0) {
+            return false;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtol(p + 1, &end, 10);
+            if (end == p + 1 || errno != 0) {
+                return false;
+            }
+            p = end;
+        }
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (*p == ',') {
+            p++;
+            if (!*p) {
+                return false;
+            }
+        } else if (*p) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* Realtime::roleName(ThreadRole role) {
+    return role == ThreadRole::COUNT ? "default" : ROLE_NAMES[static_cast<size_t>(role)];
+}
+
+} // namespace sentinel
\ No newline at end of file
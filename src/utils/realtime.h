@@ -0,0 +1,82 @@
+#ifndef SENTINEL_REALTIME_H
+#define SENTINEL_REALTIME_H
+
+#include <sched.h>
+#include <atomic>
+#include <string>
+
+namespace sentinel {
+
+// Scheduling classes of the node's threads
+enum class ThreadRole {
+    CORE = 0,        // Detection loop and alert state machine
+    RADIO,           // Mesh receive and heartbeat threads
+    INFERENCE,       // TFLite and OpenCV work (and their worker pools)
+    BACKGROUND,      // Config watcher and other housekeeping
+    COUNT
+};
+
+// Opt-in real-time execution: per-role scheduling priority and CPU
+// affinity, and locked memory. Policies are installed once at startup;
+// threads pick up their role's policy with applyRole(). While disabled
+// every call is a no-op, so call sites need no checks.
+class Realtime {
+public:
+    // Priority > 0 selects SCHED_FIFO at that priority, 0 selects
+    // SCHED_OTHER. An empty CPU set means every CPU the process may use.
+    static void setPolicy(ThreadRole role, int priority, const cpu_set_t& cpus);
+
+    static void setEnabled(bool enabled);
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // mlockall(MCL_CURRENT | MCL_FUTURE) so page faults cannot stall the
+    // loop. Needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK.
+    static bool lockMemory();
+
+    // Apply role's policy to the calling thread. Needs CAP_SYS_NICE for
+    // SCHED_FIFO; failures are logged once and leave the thread unchanged.
+    static bool applyRole(ThreadRole role);
+
+    // Role last applied on the calling thread (ThreadRole::COUNT if none;
+    // applying COUNT restores the process defaults)
+    static ThreadRole currentRole();
+
+    // Parse a CPU list such as "3" or "0-2,5" (empty = no CPUs). Returns
+    // false if malformed or out of range.
+    static bool parseCpuList(const std::string& text, cpu_set_t& cpus);
+
+    static const char* roleName(ThreadRole role);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// Runs the enclosing scope under another role's policy, restoring the
+// thread's previous role afterwards
+class RealtimeRoleScope {
+public:
+    explicit RealtimeRoleScope(ThreadRole role)
+        : previous_(Realtime::currentRole()),
+          active_(Realtime::enabled() && role != previous_) {
+        if (active_) {
+            Realtime::applyRole(role);
+        }
+    }
+
+    ~RealtimeRoleScope() {
+        if (active_) {
+            Realtime::applyRole(previous_);
+        }
+    }
+
+    RealtimeRoleScope(const RealtimeRoleScope&) = delete;
+    RealtimeRoleScope& operator=(const RealtimeRoleScope&) = delete;
+
+private:
+    ThreadRole previous_;
+    bool active_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_REALTIME_H
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef SENTINEL_RING_BUFFER_H
+#define SENTINEL_RING_BUFFER_H
+
+#include <array>
+#include <cstddef>
+
+namespace sentinel {
+
+// Fixed-capacity ring that overwrites its oldest element when full.
+// Storage is inline, so pushing never allocates. Index 0 is the oldest
+// element and size() - 1 the newest.
+template <typename T, size_t N>
+class RingBuffer {
+public:
+    static_assert(N > 0, "RingBuffer capacity must be positive");
+
+    RingBuffer() : head_(0), size_(0) {}
+
+    void push(const T& value) {
+        data_[(head_ + size_) % N] = value;
+        if (size_ < N) {
+            size_++;
+        } else {
+            head_ = (head_ + 1) % N;
+        }
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+
+    const T& operator[](size_t index) const { return data_[(head_ + index) % N]; }
+    const T& newest() const { return (*this)[size_ - 1]; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::array<T, N> data_;
+    size_t head_;
+    size_t size_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_RING_BUFFER_H
\ No newline at end of file
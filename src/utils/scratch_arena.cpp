@@ -0,0 +1,62 @@
+#include "utils/scratch_arena.h"
+#include <algorithm>
+
+namespace sentinel {
+
+constexpr size_t ARENA_ALIGNMENT = alignof(std::max_align_t);
+
+void* ScratchArena::Meter::do_allocate(size_t bytes, size_t alignment) {
+    used_ += bytes;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void ScratchArena::Meter::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+}
+
+bool ScratchArena::Meter::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+ScratchArena::ScratchArena(size_t capacity, std::pmr::memory_resource* upstream)
+    : upstream_(upstream),
+      capacity_(0),
+      buffer_(nullptr),
+      high_water_(0),
+      arena_(nullptr) {
+    allocateBuffer(capacity);
+}
+
+ScratchArena::~ScratchArena() {
+    monotonic_.reset();
+    if (buffer_) {
+        upstream_->deallocate(buffer_, capacity_, ARENA_ALIGNMENT);
+    }
+}
+
+void ScratchArena::allocateBuffer(size_t capacity) {
+    monotonic_.reset();
+    if (buffer_) {
+        upstream_->deallocate(buffer_, capacity_, ARENA_ALIGNMENT);
+    }
+
+    capacity_ = capacity;
+    buffer_ = upstream_->allocate(capacity_, ARENA_ALIGNMENT);
+    monotonic_.emplace(buffer_, capacity_, upstream_);
+    arena_ = Meter(&*monotonic_);
+}
+
+void ScratchArena::reset() {
+    high_water_ = std::max(high_water_, arena_.used());
+    arena_.clear();
+
+    if (high_water_ > capacity_) {
+        // A cycle overflowed into upstream: grow once so it does not repeat.
+        // Requests are rounded up for alignment, so leave some headroom.
+        allocateBuffer(high_water_ + high_water_ / 4);
+    } else {
+        monotonic_->release();
+    }
+}
+
+} // namespace sentinel
\ No newline at end of file
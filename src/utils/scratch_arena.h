@@ -0,0 +1,66 @@
+#ifndef SENTINEL_SCRATCH_ARENA_H
+#define SENTINEL_SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+
+namespace sentinel {
+
+// Per-cycle bump allocator. Memory handed out by resource() is released
+// all at once by reset(); nothing may outlive the cycle that allocated it.
+//
+// The backing buffer is allocated once from upstream. If a cycle needs
+// more than that, the arena falls back to upstream for the overflow and
+// grows the buffer to the high-water mark on the next reset(), so steady
+// state settles at zero heap allocations.
+class ScratchArena {
+public:
+    explicit ScratchArena(size_t capacity,
+                          std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &arena_; }
+
+    // Release everything allocated since the previous reset
+    void reset();
+
+    size_t capacity() const { return capacity_; }
+
+    // Largest amount used by a single cycle so far
+    size_t highWater() const { return high_water_; }
+
+private:
+    // Counts bytes requested from the arena in the current cycle
+    class Meter : public std::pmr::memory_resource {
+    public:
+        explicit Meter(std::pmr::memory_resource* upstream) : upstream_(upstream), used_(0) {}
+        size_t used() const { return used_; }
+        void clear() { used_ = 0; }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::pmr::memory_resource* upstream_;
+        size_t used_;
+    };
+
+    // (Re)create the backing buffer and the bump allocator over it
+    void allocateBuffer(size_t capacity);
+
+    std::pmr::memory_resource* upstream_;
+    size_t capacity_;
+    void* buffer_;
+    size_t high_water_;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_;
+    Meter arena_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_SCRATCH_ARENA_H
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef SENTINEL_DAY_NIGHT_H
+#define SENTINEL_DAY_NIGHT_H
+
+#include <chrono>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace sentinel {
+
+enum class VisionMode {
+    DAY,                             // Smoke model on every frame
+    NIGHT                            // Glow detector; the model only when something glows
+};
+
+const char* visionModeName(VisionMode mode);
+
+// One pass over a BGR frame: brightness for the day/night decision and
+// the share of glowing pixels (bright, red-dominant: flame and embers
+// rather than white or blue light)
+struct FrameLight {
+    float mean_luma;                 // 0-255, BT.601 weights
+    float glow_fraction;             // Of the pixels scanned
+    uint32_t glow_pixels;
+};
+
+class GlowDetector {
+public:
+    // Default thresholds: red at least 200 and at least 60 above blue
+    static constexpr uint8_t MIN_RED = 200;
+    static constexpr uint8_t MIN_WARMTH = 60;
+
+    // Scan every row_step-th row (1 for glow, more for brightness only).
+    // The per-row kernel is branchless over interleaved BGR bytes so the
+    // compiler vectorizes it (ld3 on NEON, shuffles on SSE/AVX).
+    static FrameLight analyze(const cv::Mat& bgr, int row_step = 1,
+                              uint8_t min_red = MIN_RED, uint8_t min_warmth = MIN_WARMTH);
+};
+
+// Day/night decision with hysteresis: the light level must cross the far
+// threshold (below night_below to enter night, above day_above to leave
+// it) and stay there for the hold time before the mode changes. Works on
+// lux from a light sensor or on mean frame luminance, whichever the
+// caller passes with matching thresholds.
+class DayNightSwitch {
+public:
+    DayNightSwitch();
+
+    // Returns true when the mode changed
+    bool update(float level, float night_below, float day_above,
+                std::chrono::steady_clock::duration hold,
+                std::chrono::steady_clock::time_point now);
+
+    VisionMode mode() const { return mode_; }
+    void reset();
+
+private:
+    VisionMode mode_;
+    bool pending_;                   // Level is past the threshold for the other mode
+    std::chrono::steady_clock::time_point pending_since_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_DAY_NIGHT_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "vision/interpreter_pool.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include <algorithm>
+
+namespace sentinel {
+
+// More interpreters than this buys nothing on the boards we run on
+constexpr int MAX_INTERPRETERS = 16;
+
+InterpreterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_),
+      index_(other.index_) {
+    other.pool_ = nullptr;
+    other.index_ = -1;
+}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        other.pool_ = nullptr;
+        other.index_ = -1;
+    }
+    return *this;
+}
+
+InterpreterPool::Lease::~Lease() {
+    release();
+}
+
+TFLiteInference* InterpreterPool::Lease::operator->() const {
+    return pool_->interpreters_[index_].get();
+}
+
+void InterpreterPool::Lease::release() {
+    if (pool_) {
+        pool_->release(index_);
+        pool_ = nullptr;
+        index_ = -1;
+    }
+}
+
+InterpreterPool::InterpreterPool() = default;
+
+InterpreterPool::~InterpreterPool() {
+    shutdown();
+}
+
+bool InterpreterPool::load(const std::string& model_path, int size) {
+    shutdown();
+
+    if (size <= 0) {
+        size = Executor::threadBudget();
+    }
+    size = std::clamp(size, 1, MAX_INTERPRETERS);
+
+    model_ = tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
+    if (!model_) {
+        Logger::error("Failed to load model: " + model_path);
+        return false;
+    }
+
+    for (int i = 0; i < size; i++) {
+        auto interpreter = std::make_unique<TFLiteInference>();
+        if (!interpreter->loadModel(model_, model_path)) {
+            shutdown();
+            return false;
+        }
+        interpreters_.push_back(std::move(interpreter));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.clear();
+    for (int i = size - 1; i >= 0; i--) {
+        free_.push_back(i);
+    }
+    if (size > 1) {
+        Logger::logf(LogLevel::INFO, "Interpreter pool: %d interpreters sharing %zu KB model",
+                     size, modelBytes() / 1024);
+    }
+    return true;
+}
+
+InterpreterPool::Lease InterpreterPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_cv_.wait(lock, [this]() { return !free_.empty(); });
+    int index = free_.back();
+    free_.pop_back();
+    return Lease(this, index);
+}
+
+InterpreterPool::Lease InterpreterPool::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        return Lease();
+    }
+    int index = free_.back();
+    free_.pop_back();
+    return Lease(this, index);
+}
+
+void InterpreterPool::release(int index) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(index);
+    }
+    available_cv_.notify_one();
+}
+
+void InterpreterPool::setNumThreads(int threads) {
+    for (auto& interpreter : interpreters_) {
+        interpreter->setNumThreads(threads);
+    }
+}
+
+int InterpreterPool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(free_.size());
+}
+
+size_t InterpreterPool::modelBytes() const {
+    return model_ && model_->allocation() ? model_->allocation()->bytes() : 0;
+}
+
+void InterpreterPool::shutdown() {
+    // Interpreters reference the model; release them first
+    interpreters_.clear();
+    model_.reset();
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.clear();
+}
+
+} // namespace sentinel
\ No newline at end of file
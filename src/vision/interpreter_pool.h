@@ -0,0 +1,93 @@
+#ifndef SENTINEL_INTERPRETER_POOL_H
+#define SENTINEL_INTERPRETER_POOL_H
+
+#include "vision/tflite_inference.h"
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sentinel {
+
+// Interpreters for concurrent inference on one model. The flatbuffer is
+// memory-mapped once and shared read-only; each interpreter only adds its
+// own tensor arena, so an extra one costs the model's activations rather
+// than another copy of its weights. Callers check an interpreter out,
+// run it, and return it by dropping the lease.
+class InterpreterPool {
+public:
+    // A checked-out interpreter; returned to the pool on destruction
+    class Lease {
+    public:
+        Lease() : pool_(nullptr), index_(-1) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return pool_ != nullptr; }
+        TFLiteInference* operator->() const;
+        TFLiteInference& operator*() const { return *operator->(); }
+
+        // Slot of the interpreter, 0 to size() - 1, for per-slot buffers
+        int index() const { return index_; }
+
+        void release();
+
+    private:
+        friend class InterpreterPool;
+        Lease(InterpreterPool* pool, int index) : pool_(pool), index_(index) {}
+
+        InterpreterPool* pool_;
+        int index_;
+    };
+
+    InterpreterPool();
+    ~InterpreterPool();
+
+    InterpreterPool(const InterpreterPool&) = delete;
+    InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+    // Map model_path and build size interpreters (size <= 0: one per
+    // executor worker). Fails if the model or any interpreter fails.
+    bool load(const std::string& model_path, int size);
+
+    // Wait for a free interpreter
+    Lease acquire();
+
+    // A free interpreter, or an empty lease if all are checked out
+    Lease tryAcquire();
+
+    // Direct access for setup (threads, profiling) while nothing is
+    // checked out; interpreter 0 is the one a single caller gets
+    TFLiteInference& interpreter(int index) { return *interpreters_[index]; }
+
+    // Threads each interpreter may use for one invoke
+    void setNumThreads(int threads);
+
+    int size() const { return static_cast<int>(interpreters_.size()); }
+    int available() const;
+
+    // Bytes of the mapped model, shared by all interpreters
+    size_t modelBytes() const;
+
+    void shutdown();
+
+private:
+    void release(int index);
+
+    std::shared_ptr<tflite::FlatBufferModel> model_;
+    std::vector<std::unique_ptr<TFLiteInference>> interpreters_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_cv_;
+    std::vector<int> free_;              // Stack: the most recently used first
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_INTERPRETER_POOL_H
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "vision/op_profiler.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace sentinel {
+
+// Events buffered per invoke; the buffer grows if a model has more
+constexpr uint32_t PROFILE_EVENTS = 1024;
+
+// Rows listed per section of the formatted report
+constexpr size_t REPORT_ROWS = 25;
+
+bool OpProfiler::Key::operator<(const Key& other) const {
+    if (subgraph != other.subgraph) {
+        return subgraph < other.subgraph;
+    }
+    if (node != other.node) {
+        return node < other.node;
+    }
+    if (in_delegate != other.in_delegate) {
+        return in_delegate < other.in_delegate;
+    }
+    return op < other.op;
+}
+
+OpProfiler::OpProfiler(std::string model)
+    : model_(std::move(model)),
+      invokes_(0),
+      remaining_(0),
+      complete_(false),
+      invoke_total_us_(0.0) {
+}
+
+OpProfiler::~OpProfiler() = default;
+
+void OpProfiler::start(tflite::Interpreter& interpreter, int invokes) {
+    if (!profiler_) {
+        profiler_ = std::make_unique<tflite::profiling::BufferedProfiler>(PROFILE_EVENTS, true);
+    }
+    totals_.clear();
+    invokes_ = 0;
+    remaining_ = std::max(0, invokes);
+    complete_ = false;
+    invoke_total_us_ = 0.0;
+    interpreter.SetProfiler(remaining_ > 0 ? profiler_.get() : nullptr);
+}
+
+void OpProfiler::beginInvoke() {
+    profiler_->Reset();
+    profiler_->StartProfiling();
+}
+
+void OpProfiler::endInvoke(tflite::Interpreter& interpreter, double invoke_us) {
+    profiler_->StopProfiling();
+
+    for (const tflite::profiling::ProfileEvent* event : profiler_->GetProfileEvents()) {
+        using EventType = tflite::profiling::ProfileEvent::EventType;
+        bool in_delegate = event->event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT;
+        if (!in_delegate && event->event_type != EventType::OPERATOR_INVOKE_EVENT) {
+            continue;
+        }
+
+        // Operator events carry the node index and subgraph; delegate
+        // events the delegate's own op index
+        Key key;
+        key.subgraph = in_delegate ? -1 : static_cast<int>(event->extra_event_metadata);
+        key.node = static_cast<int>(event->event_metadata);
+        key.in_delegate = in_delegate;
+        key.op = event->tag;
+
+        Totals& totals = totals_[key];
+        if (totals.runs == 0 && !in_delegate) {
+            totals.shapes = describeShapes(interpreter, key.subgraph, key.node);
+        }
+        double us = static_cast<double>(event->elapsed_time);
+        totals.runs++;
+        totals.total_us += us;
+        totals.max_us = std::max(totals.max_us, us);
+    }
+
+    invokes_++;
+    invoke_total_us_ += invoke_us;
+    if (--remaining_ == 0) {
+        interpreter.SetProfiler(nullptr);
+        complete_ = true;
+    }
+}
+
+bool OpProfiler::takeComplete() {
+    bool complete = complete_;
+    complete_ = false;
+    return complete;
+}
+
+std::string OpProfiler::describeShapes(const tflite::Interpreter& interpreter, int subgraph,
+                                       int node) {
+    const auto* node_and_registration = interpreter.node_and_registration(subgraph, node);
+    if (!node_and_registration) {
+        return std::string();
+    }
+
+    auto describe = [&](const TfLiteIntArray* tensors) {
+        std::string text;
+        for (int i = 0; tensors && i < tensors->size; i++) {
+            if (tensors->data[i] < 0) {
+                continue;                // Optional input left out
+            }
+            const TfLiteTensor* tensor = interpreter.tensor(subgraph, tensors->data[i]);
+            if (!text.empty()) {
+                text += ", ";
+            }
+            if (!tensor || !tensor->dims || tensor->dims->size == 0) {
+                text += "scalar";
+                continue;
+            }
+            for (int d = 0; d < tensor->dims->size; d++) {
+                text += (d > 0 ? "x" : "") + std::to_string(tensor->dims->data[d]);
+            }
+        }
+        return text;
+    };
+
+    const TfLiteNode& tflite_node = node_and_registration->first;
+    return describe(tflite_node.inputs) + " -> " + describe(tflite_node.outputs);
+}
+
+OpProfileReport OpProfiler::report() const {
+    OpProfileReport report;
+    report.model = model_;
+    report.invokes = invokes_;
+    report.invoke_total_us = invoke_total_us_;
+    report.invoke_mean_us = invokes_ > 0 ? invoke_total_us_ / invokes_ : 0.0;
+
+    for (const auto& pair : totals_) {
+        OpProfileEntry entry;
+        entry.op = pair.first.op;
+        entry.subgraph = pair.first.subgraph;
+        entry.node = pair.first.node;
+        entry.in_delegate = pair.first.in_delegate;
+        entry.shapes = pair.second.shapes;
+        entry.runs = pair.second.runs;
+        entry.total_us = pair.second.total_us;
+        entry.mean_us = invokes_ > 0 ? pair.second.total_us / invokes_ : 0.0;
+        entry.max_us = pair.second.max_us;
+        entry.share = invoke_total_us_ > 0.0 ? pair.second.total_us / invoke_total_us_ : 0.0;
+        report.ops.push_back(entry);
+    }
+    std::sort(report.ops.begin(), report.ops.end(),
+              [](const OpProfileEntry& a, const OpProfileEntry& b) {
+                  return a.total_us > b.total_us;
+              });
+    return report;
+}
+
+std::string OpProfiler::format(const OpProfileReport& report) {
+    std::string text;
+    char line[512];
+    std::snprintf(line, sizeof(line), "Operator profile: %s, %d invokes, mean %.2f ms\n",
+                  report.model.c_str(), report.invokes, report.invoke_mean_us / 1000.0);
+    text += line;
+
+    // Top-level ops and partitions add up to the invoke time, less the
+    // interpreter's own overhead
+    auto section = [&](const char* title, bool in_delegate) {
+        size_t rows = 0;
+        size_t hidden = 0;
+        double share = 0.0;
+        for (const OpProfileEntry& entry : report.ops) {
+            if (entry.in_delegate != in_delegate) {
+                continue;
+            }
+            share += entry.share;
+            if (rows == REPORT_ROWS) {
+                hidden++;
+                continue;
+            }
+            if (rows++ == 0) {
+                text += title;
+                text += "   rank   share  mean ms   max ms  node  op                              shapes\n";
+            }
+            std::snprintf(line, sizeof(line), "  %5zu  %5.1f%%  %7.3f  %7.3f  %4d  %-30.30s  %s\n",
+                          rows, 100.0 * entry.share, entry.mean_us / 1000.0,
+                          entry.max_us / 1000.0, entry.node, entry.op.c_str(),
+                          entry.shapes.c_str());
+            text += line;
+        }
+        if (hidden > 0) {
+            std::snprintf(line, sizeof(line), "  ... %zu more\n", hidden);
+            text += line;
+        }
+        return share;
+    };
+
+    double measured = section("Operators and delegate partitions\n", false);
+    if (report.invoke_total_us > 0.0) {
+        std::snprintf(line, sizeof(line), "  %5s  %5.1f%%  %7.3f  interpreter overhead\n", "",
+                      100.0 * std::max(0.0, 1.0 - measured),
+                      std::max(0.0, 1.0 - measured) * report.invoke_mean_us / 1000.0);
+        text += line;
+    }
+    section("Inside delegate partitions\n", true);
+
+    // Per op type, to compare model exports whose node numbering differs
+    std::map<std::string, std::pair<double, int>> by_type;
+    for (const OpProfileEntry& entry : report.ops) {
+        if (!entry.in_delegate) {
+            by_type[entry.op].first += entry.share;
+            by_type[entry.op].second++;
+        }
+    }
+    std::vector<std::pair<std::string, std::pair<double, int>>> types(by_type.begin(),
+                                                                      by_type.end());
+    std::sort(types.begin(), types.end(), [](const auto& a, const auto& b) {
+        return a.second.first > b.second.first;
+    });
+    if (!types.empty()) {
+        text += "By op type\n";
+    }
+    for (const auto& type : types) {
+        std::snprintf(line, sizeof(line), "  %-30.30s  %5.1f%%  %7.3f ms  %d nodes\n",
+                      type.first.c_str(), 100.0 * type.second.first,
+                      type.second.first * report.invoke_mean_us / 1000.0, type.second.second);
+        text += line;
+    }
+    return text;
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef SENTINEL_OP_PROFILER_H
+#define SENTINEL_OP_PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+class Interpreter;
+class Profiler;
+namespace profiling {
+class BufferedProfiler;
+}
+}
+
+namespace sentinel {
+
+// One operator (or delegate partition) aggregated over the profiled invokes
+struct OpProfileEntry {
+    std::string op;                  // Op type (CONV_2D), or the delegate kernel for a partition
+    int subgraph;
+    int node;                        // Node index; inside a delegate, the delegate's op index
+    bool in_delegate;                // Runs inside a delegate partition
+    std::string shapes;              // "1x224x224x3, 3x3x3x32 -> 1x112x112x32"
+    uint64_t runs;
+    double total_us;
+    double mean_us;
+    double max_us;
+    double share;                    // Of total invoke time, 0-1
+};
+
+struct OpProfileReport {
+    std::string model;
+    int invokes;
+    double invoke_total_us;
+    double invoke_mean_us;
+    std::vector<OpProfileEntry> ops; // Slowest first; delegate-internal ops flagged
+};
+
+// Per-operator profiling of a TFLite interpreter over a number of invokes.
+// While capturing, a TFLite BufferedProfiler is attached to the
+// interpreter; it is detached again when done, so the steady state pays
+// nothing. Not thread-safe: use from the thread that invokes.
+class OpProfiler {
+public:
+    explicit OpProfiler(std::string model);
+    ~OpProfiler();
+
+    // Capture the next invokes runs of interpreter (replaces any earlier
+    // capture)
+    void start(tflite::Interpreter& interpreter, int invokes);
+
+    // Around each Invoke() while active()
+    bool active() const { return remaining_ > 0; }
+    void beginInvoke();
+    void endInvoke(tflite::Interpreter& interpreter, double invoke_us);
+
+    // True once after the requested invokes have been captured
+    bool takeComplete();
+
+    OpProfileReport report() const;
+
+    // Ranked table: ops and delegate partitions, ops inside delegates,
+    // then totals per op type
+    static std::string format(const OpProfileReport& report);
+
+private:
+    struct Key {
+        int subgraph;
+        int node;
+        bool in_delegate;
+        std::string op;
+
+        bool operator<(const Key& other) const;
+    };
+
+    struct Totals {
+        std::string shapes;
+        uint64_t runs = 0;
+        double total_us = 0.0;
+        double max_us = 0.0;
+    };
+
+    static std::string describeShapes(const tflite::Interpreter& interpreter, int subgraph,
+                                      int node);
+
+    std::string model_;
+    std::unique_ptr<tflite::profiling::BufferedProfiler> profiler_;
+    std::map<Key, Totals> totals_;
+    int invokes_;
+    int remaining_;
+    bool complete_;
+    double invoke_total_us_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_OP_PROFILER_H
\ No newline at end of file
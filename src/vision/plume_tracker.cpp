@@ -0,0 +1,315 @@
+#include "vision/plume_tracker.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace sentinel {
+
+PlumeTracker::PlumeTracker(const PlumeTrackerConfig& config)
+    : cells_x_(0),
+      cells_y_(0),
+      next_id_(1) {
+    setConfig(config);
+}
+
+void PlumeTracker::setConfig(const PlumeTrackerConfig& config) {
+    config_ = config;
+    config_.grid = std::max(1, config_.grid);
+    config_.min_cells = std::max(1, config_.min_cells);
+
+    size_t cells = static_cast<size_t>(config_.grid) * config_.grid;
+    cells_.reserve(cells);
+    rows_per_cell_.reserve(config_.grid);
+    cols_per_cell_.reserve(config_.grid);
+    labels_.reserve(cells);
+    parent_.reserve(cells);
+    label_stats_.reserve(cells);
+    blobs_.reserve(MAX_BLOBS);
+    tracks_.reserve(MAX_TRACKS);
+}
+
+void PlumeTracker::reset() {
+    tracks_.clear();
+    blobs_.clear();
+}
+
+float PlumeTracker::update(const float* mask, int height, int width, int channels,
+                           std::chrono::steady_clock::time_point now) {
+    if (!mask || height <= 0 || width <= 0 || channels <= 0) {
+        return 0.0f;
+    }
+    float peak = pool(mask, height, width, channels);
+    label();
+    associate(now);
+    return peak;
+}
+
+float PlumeTracker::pool(const float* mask, int height, int width, int channels) {
+    cells_x_ = std::min(config_.grid, width);
+    cells_y_ = std::min(config_.grid, height);
+    cells_.assign(static_cast<size_t>(cells_x_) * cells_y_, 0.0f);
+
+    // Channel 1 is smoke for two-class masks, like the classifier output
+    const int channel = channels >= 2 ? 1 : 0;
+    for (int y = 0; y < height; y++) {
+        float* row = &cells_[static_cast<size_t>(y * cells_y_ / height) * cells_x_];
+        const float* in = mask + static_cast<size_t>(y) * width * channels + channel;
+        for (int x = 0; x < width; x++) {
+            row[x * cells_x_ / width] += in[static_cast<size_t>(x) * channels];
+        }
+    }
+
+    // Cells differ by a row or column when the mask does not divide
+    // evenly; divide by each cell's own pixel count
+    rows_per_cell_.assign(cells_y_, 0);
+    cols_per_cell_.assign(cells_x_, 0);
+    for (int y = 0; y < height; y++) {
+        rows_per_cell_[y * cells_y_ / height]++;
+    }
+    for (int x = 0; x < width; x++) {
+        cols_per_cell_[x * cells_x_ / width]++;
+    }
+    float peak = 0.0f;
+    for (int cy = 0; cy < cells_y_; cy++) {
+        for (int cx = 0; cx < cells_x_; cx++) {
+            float& cell = cells_[static_cast<size_t>(cy) * cells_x_ + cx];
+            cell /= static_cast<float>(rows_per_cell_[cy] * cols_per_cell_[cx]);
+            peak = std::max(peak, cell);
+        }
+    }
+    return peak;
+}
+
+int PlumeTracker::find(int label) {
+    while (parent_[label] != label) {
+        parent_[label] = parent_[parent_[label]];   // Path halving
+        label = parent_[label];
+    }
+    return label;
+}
+
+void PlumeTracker::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return;
+    }
+    if (b < a) {
+        std::swap(a, b);
+    }
+
+    // Fold the younger label's statistics into the older root
+    parent_[b] = a;
+    Blob& into = label_stats_[a];
+    const Blob& from = label_stats_[b];
+    into.cells += from.cells;
+    into.sum_x += from.sum_x;
+    into.sum_y += from.sum_y;
+    into.peak = std::max(into.peak, from.peak);
+    into.min_x = std::min(into.min_x, from.min_x);
+    into.min_y = std::min(into.min_y, from.min_y);
+    into.max_x = std::max(into.max_x, from.max_x);
+    into.max_y = std::max(into.max_y, from.max_y);
+}
+
+void PlumeTracker::label() {
+    labels_.assign(cells_.size(), -1);
+    parent_.clear();
+    label_stats_.clear();
+    blobs_.clear();
+
+    // One raster pass, 8-connected: smoke drifts diagonally. A cell joins
+    // the labels of its west, north-west, north and north-east neighbours.
+    for (int y = 0; y < cells_y_; y++) {
+        for (int x = 0; x < cells_x_; x++) {
+            size_t index = static_cast<size_t>(y) * cells_x_ + x;
+            float value = cells_[index];
+            if (value < config_.threshold) {
+                continue;
+            }
+
+            int label = -1;
+            auto join = [&](int nx, int ny) {
+                if (nx < 0 || nx >= cells_x_ || ny < 0) {
+                    return;
+                }
+                int neighbour = labels_[static_cast<size_t>(ny) * cells_x_ + nx];
+                if (neighbour < 0) {
+                    return;
+                }
+                if (label < 0) {
+                    label = find(neighbour);
+                } else {
+                    unite(label, neighbour);
+                    label = find(label);
+                }
+            };
+            join(x - 1, y);
+            join(x - 1, y - 1);
+            join(x, y - 1);
+            join(x + 1, y - 1);
+
+            if (label < 0) {
+                label = static_cast<int>(parent_.size());
+                parent_.push_back(label);
+                label_stats_.push_back(Blob{0, 0.0f, 0.0f, 0.0f, x, y, x, y});
+            }
+            labels_[index] = label;
+
+            Blob& blob = label_stats_[label];
+            blob.cells++;
+            blob.sum_x += x + 0.5f;
+            blob.sum_y += y + 0.5f;
+            blob.peak = std::max(blob.peak, value);
+            blob.min_x = std::min(blob.min_x, x);
+            blob.min_y = std::min(blob.min_y, y);
+            blob.max_x = std::max(blob.max_x, x);
+            blob.max_y = std::max(blob.max_y, y);
+        }
+    }
+
+    // Roots hold the merged statistics; keep the largest blobs
+    for (size_t label = 0; label < parent_.size(); label++) {
+        const Blob& blob = label_stats_[label];
+        if (parent_[label] != static_cast<int>(label) || blob.cells < config_.min_cells) {
+            continue;
+        }
+        if (blobs_.size() < MAX_BLOBS) {
+            blobs_.push_back(blob);
+            continue;
+        }
+        auto smallest = std::min_element(blobs_.begin(), blobs_.end(),
+                                         [](const Blob& a, const Blob& b) {
+                                             return a.cells < b.cells;
+                                         });
+        if (smallest->cells < blob.cells) {
+            *smallest = blob;
+        }
+    }
+}
+
+void PlumeTracker::associate(std::chrono::steady_clock::time_point now) {
+    const float scale_x = 1.0f / cells_x_;
+    const float scale_y = 1.0f / cells_y_;
+    const float cell_area = scale_x * scale_y;
+
+    // Candidate pairs, best first: overlapping boxes by IoU, then nearby
+    // centroids by distance
+    struct Pair {
+        float score;
+        uint8_t track;
+        uint8_t blob;
+    };
+    std::array<Pair, MAX_TRACKS * MAX_BLOBS> pairs;
+    size_t pair_count = 0;
+    for (size_t t = 0; t < tracks_.size(); t++) {
+        const PlumeTrack& track = tracks_[t];
+        for (size_t b = 0; b < blobs_.size(); b++) {
+            const Blob& blob = blobs_[b];
+            float x0 = blob.min_x * scale_x;
+            float y0 = blob.min_y * scale_y;
+            float x1 = (blob.max_x + 1) * scale_x;
+            float y1 = (blob.max_y + 1) * scale_y;
+            float overlap = std::max(0.0f, std::min(x1, track.x1) - std::max(x0, track.x0)) *
+                            std::max(0.0f, std::min(y1, track.y1) - std::max(y0, track.y0));
+            float score;
+            if (overlap > 0.0f) {
+                float both = (x1 - x0) * (y1 - y0) +
+                             (track.x1 - track.x0) * (track.y1 - track.y0) - overlap;
+                score = 1.0f + overlap / both;
+            } else {
+                float dx = blob.sum_x / blob.cells * scale_x - track.centroid_x;
+                float dy = blob.sum_y / blob.cells * scale_y - track.centroid_y;
+                float distance = std::sqrt(dx * dx + dy * dy);
+                if (distance >= config_.match_distance) {
+                    continue;
+                }
+                score = 1.0f - distance / config_.match_distance;
+            }
+            pairs[pair_count++] = Pair{score, static_cast<uint8_t>(t), static_cast<uint8_t>(b)};
+        }
+    }
+    std::sort(pairs.begin(), pairs.begin() + pair_count,
+              [](const Pair& a, const Pair& b) { return a.score > b.score; });
+
+    uint32_t track_matched = 0;
+    uint32_t blob_matched = 0;
+    auto apply = [&](PlumeTrack& track, const Blob& blob, bool fresh) {
+        float area = blob.cells * cell_area;
+        if (!fresh) {
+            float dt = std::chrono::duration<float>(now - track.last_seen).count();
+            if (dt > 0.0f) {
+                float growth = (area - track.area) / dt;
+                track.growth_rate += config_.growth_smoothing * (growth - track.growth_rate);
+            }
+            track.growing_frames = track.growth_rate > 0.0f ? track.growing_frames + 1 : 0;
+        }
+        track.area = area;
+        track.centroid_x = blob.sum_x / blob.cells * scale_x;
+        track.centroid_y = blob.sum_y / blob.cells * scale_y;
+        track.x0 = blob.min_x * scale_x;
+        track.y0 = blob.min_y * scale_y;
+        track.x1 = (blob.max_x + 1) * scale_x;
+        track.y1 = (blob.max_y + 1) * scale_y;
+        track.peak = blob.peak;
+        track.frames++;
+        track.missed = 0;
+        track.last_seen = now;
+    };
+
+    for (size_t i = 0; i < pair_count; i++) {
+        const Pair& pair = pairs[i];
+        if ((track_matched >> pair.track & 1u) || (blob_matched >> pair.blob & 1u)) {
+            continue;
+        }
+        track_matched |= 1u << pair.track;
+        blob_matched |= 1u << pair.blob;
+        apply(tracks_[pair.track], blobs_[pair.blob], false);
+    }
+
+    // Unmatched tracks age out. Walking from the back, the element swapped
+    // into a removed slot has already been visited.
+    for (size_t t = tracks_.size(); t-- > 0;) {
+        if (track_matched >> t & 1u) {
+            continue;
+        }
+        // A plume does not blink: a gap ends the growth streak
+        tracks_[t].growing_frames = 0;
+        if (++tracks_[t].missed > config_.max_missed) {
+            tracks_[t] = tracks_.back();
+            tracks_.pop_back();
+        }
+    }
+
+    // Unmatched blobs start tracks while there is room
+    for (size_t b = 0; b < blobs_.size() && tracks_.size() < MAX_TRACKS; b++) {
+        if (blob_matched >> b & 1u) {
+            continue;
+        }
+        PlumeTrack track{};
+        track.id = next_id_++;
+        track.first_seen = now;
+        apply(track, blobs_[b], true);
+        tracks_.push_back(track);
+    }
+}
+
+bool PlumeTracker::isPersistent(const PlumeTrack& track) const {
+    return track.missed == 0 && track.growing_frames >= config_.growth_frames;
+}
+
+const PlumeTrack* PlumeTracker::primary() const {
+    const PlumeTrack* best = nullptr;
+    for (const PlumeTrack& track : tracks_) {
+        if (track.missed > 0) {
+            continue;
+        }
+        if (!best || isPersistent(track) > isPersistent(*best) ||
+            (isPersistent(track) == isPersistent(*best) && track.area > best->area)) {
+            best = &track;
+        }
+    }
+    return best;
+}
+
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef SENTINEL_PLUME_TRACKER_H
+#define SENTINEL_PLUME_TRACKER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sentinel {
+
+struct PlumeTrackerConfig {
+    int grid = 32;                   // Mask cells per side after downsampling
+    float threshold = 0.5f;          // Cell smoke probability counted as plume
+    int min_cells = 2;               // Smaller blobs are treated as noise
+    int max_missed = 5;              // Frames a track survives without a match
+    float match_distance = 0.15f;    // Centroid gate for non-overlapping blobs (frame widths)
+    float growth_smoothing = 0.3f;   // EMA weight of the newest growth sample
+    int growth_frames = 5;           // Consecutive growing frames for a persistent plume
+};
+
+// One plume followed across frames. Positions and areas are fractions of
+// the frame, so they do not depend on the model's mask resolution.
+struct PlumeTrack {
+    uint32_t id;
+    float area;                      // Fraction of the frame, 0-1
+    float centroid_x;                // 0 (left) - 1 (right)
+    float centroid_y;                // 0 (top) - 1 (bottom)
+    float x0, y0, x1, y1;            // Bounding box
+    float peak;                      // Highest cell probability in the blob
+    float growth_rate;               // Area per second, smoothed (negative: shrinking)
+    int growing_frames;              // Consecutive frames with positive growth
+    int frames;                      // Frames matched since the track started
+    int missed;                      // Frames since the last match (0: seen this frame)
+    std::chrono::steady_clock::time_point first_seen;
+    std::chrono::steady_clock::time_point last_seen;
+};
+
+// Turns per-frame segmentation masks into plume tracks. Each mask is
+// mean-pooled to a small grid, thresholded, and labelled in a single
+// raster pass with union-find: blob statistics are accumulated per label
+// as cells are visited and folded into the root when labels merge, so the
+// grid is scanned once. Blobs are matched to tracks greedily by box
+// overlap, then centroid distance. All buffers are sized up front; update()
+// does not allocate. Not thread-safe.
+class PlumeTracker {
+public:
+    static constexpr size_t MAX_TRACKS = 16;
+    static constexpr size_t MAX_BLOBS = 32;  // Largest blobs kept per frame
+
+    explicit PlumeTracker(const PlumeTrackerConfig& config = PlumeTrackerConfig());
+
+    // Feed one mask (NHWC floats, batch 1). With channels >= 2, channel 1
+    // is the smoke probability, as for the classifier output; with one
+    // channel it is the only one. Returns the highest pooled cell
+    // probability, the frame's smoke confidence.
+    float update(const float* mask, int height, int width, int channels,
+                 std::chrono::steady_clock::time_point now);
+
+    // Live tracks, including ones missed for up to max_missed frames
+    const std::vector<PlumeTrack>& tracks() const { return tracks_; }
+
+    // The track dispatch should look at: the largest persistently growing
+    // plume seen this frame, else the largest one seen this frame.
+    // nullptr when nothing was seen.
+    const PlumeTrack* primary() const;
+
+    // Seen this frame and growing for growth_frames consecutive frames
+    bool isPersistent(const PlumeTrack& track) const;
+
+    void setConfig(const PlumeTrackerConfig& config);
+    void reset();
+
+private:
+    struct Blob {
+        int cells;
+        float sum_x;
+        float sum_y;
+        float peak;
+        int min_x, min_y, max_x, max_y;
+    };
+
+    // Pool the mask onto cells_; returns the highest cell
+    float pool(const float* mask, int height, int width, int channels);
+
+    // Label cells_ into blobs_ (largest MAX_BLOBS, at least min_cells)
+    void label();
+
+    int find(int label);
+    void unite(int a, int b);
+
+    void associate(std::chrono::steady_clock::time_point now);
+
+    PlumeTrackerConfig config_;
+    int cells_x_;
+    int cells_y_;
+    std::vector<float> cells_;       // Pooled probabilities, row-major
+    std::vector<int> rows_per_cell_; // Mask pixels pooled into each cell row and column
+    std::vector<int> cols_per_cell_;
+    std::vector<int> labels_;        // Provisional label per cell, -1 = background
+    std::vector<int> parent_;        // Union-find over provisional labels
+    std::vector<Blob> label_stats_;  // Accumulated per provisional label
+    std::vector<Blob> blobs_;
+    std::vector<PlumeTrack> tracks_;
+    uint32_t next_id_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_PLUME_TRACKER_H
\ No newline at end of file
@@ -0,0 +1,479 @@
+#include "vision/preview_server.h"
+#include "utils/logger.h"
+#include "utils/realtime.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace sentinel {
+
+// Nice value of the server thread: encoding yields to everything else
+static constexpr int PREVIEW_NICE = 10;
+
+// Requests are a single GET; anything longer is not a browser or curl
+static constexpr size_t MAX_REQUEST_SIZE = 2048;
+
+// Per-client socket send buffer. Small, so a slow viewer falls behind by
+// a frame or two and then skips, rather than queueing seconds of video.
+static constexpr int CLIENT_SNDBUF = 128 * 1024;
+
+static const char STREAM_RESPONSE[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Connection: close\r\n"
+    "\r\n";
+
+static const char NOT_FOUND_RESPONSE[] =
+    "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+static const char BUSY_RESPONSE[] =
+    "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+// One encoded frame, shared by every client sending it. part is the
+// multipart chunk; the JPEG itself is part[jpeg_offset, jpeg_offset + jpeg_size).
+struct PreviewServer::EncodedFrame {
+    uint64_t seq;
+    std::string part;
+    size_t jpeg_offset;
+    size_t jpeg_size;
+};
+
+struct PreviewServer::Client {
+    enum class Mode { REQUEST, STREAM, SNAPSHOT, CLOSING };
+
+    int fd;
+    Mode mode = Mode::REQUEST;
+    std::string request;
+
+    // Pending output: owned head bytes, then a range of a shared frame
+    std::string head;
+    size_t head_offset = 0;
+    std::shared_ptr<const EncodedFrame> frame;
+    size_t offset = 0;
+    size_t end = 0;
+    uint64_t last_seq = 0;           // Newest frame started
+
+    bool waiting() const { return mode == Mode::STREAM || mode == Mode::SNAPSHOT; }
+    bool pending() const { return head_offset < head.size() || frame != nullptr; }
+};
+
+PreviewServer::PreviewServer(const PreviewConfig& config)
+    : config_(config),
+      frame_interval_(std::chrono::milliseconds(1000 / std::max(1, config.max_fps))),
+      listen_fd_(-1),
+      wake_fd_(-1),
+      bound_port_(0),
+      staged_confidence_(0.0f),
+      staged_detected_(false),
+      staged_grid_(1),
+      staged_ready_(false),
+      encode_params_{cv::IMWRITE_JPEG_QUALITY, config.jpeg_quality},
+      viewers_(0),
+      connected_(0),
+      frames_offered_(0),
+      frames_encoded_(0),
+      frames_sent_(0),
+      frames_skipped_(0),
+      bytes_sent_(0),
+      clients_accepted_(0),
+      clients_rejected_(0),
+      running_(false) {
+}
+
+PreviewServer::~PreviewServer() {
+    stop();
+}
+
+bool PreviewServer::start() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (inet_pton(AF_INET, config_.bind_address.c_str(), &addr.sin_addr) != 1) {
+        Logger::error("Invalid preview bind address: " + config_.bind_address);
+        return false;
+    }
+    // The stream has no authentication: off the node only when asked for
+    if ((ntohl(addr.sin_addr.s_addr) >> 24) != 127 && !config_.allow_remote) {
+        Logger::error("Preview bind address " + config_.bind_address +
+                      " is not loopback; set preview.allow_remote to serve other hosts");
+        return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        Logger::error("Failed to create preview socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 16) < 0) {
+        Logger::error("Failed to listen on preview port " + std::to_string(config_.port) +
+                      ": " + std::strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port_ = ntohs(addr.sin_port);
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        Logger::error("eventfd failed: " + std::string(std::strerror(errno)));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    serve_thread_ = std::thread(&PreviewServer::serveLoop, this);
+
+    Logger::logf(LogLevel::INFO, "Camera preview at http://%s:%d/ (up to %d clients, %d fps)",
+                 config_.bind_address.c_str(), bound_port_, config_.max_clients,
+                 config_.max_fps);
+    return true;
+}
+
+void PreviewServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        Logger::warn("Failed to wake preview server");
+    }
+    if (serve_thread_.joinable()) {
+        serve_thread_.join();
+    }
+
+    for (auto& client : clients_) {
+        close(client->fd);
+    }
+    clients_.clear();
+    latest_.reset();
+    viewers_ = 0;
+    connected_ = 0;
+
+    close(wake_fd_);
+    close(listen_fd_);
+    wake_fd_ = -1;
+    listen_fd_ = -1;
+}
+
+bool PreviewServer::wantsFrame(Clock::time_point now) const {
+    return viewers_.load(std::memory_order_relaxed) > 0 &&
+           !staged_ready_.load(std::memory_order_acquire) &&
+           now - last_offer_ >= frame_interval_;
+}
+
+void PreviewServer::offerFrame(const cv::Mat& frame, float confidence, bool detected,
+                               int tile_grid, Clock::time_point now) {
+    if (!wantsFrame(now) || frame.empty()) {
+        return;
+    }
+
+    {
+        // Uncontended: the server only takes the lock while staged_ready_
+        // is set, and we only get here while it is clear
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        frame.copyTo(staged_);
+        staged_confidence_ = confidence;
+        staged_detected_ = detected;
+        staged_grid_ = tile_grid;
+    }
+    staged_ready_.store(true, std::memory_order_release);
+    last_offer_ = now;
+    frames_offered_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        Logger::logf(LogLevel::WARN, "Failed to wake preview server: %s", std::strerror(errno));
+    }
+}
+
+PreviewStats PreviewServer::stats() const {
+    PreviewStats stats;
+    stats.frames_offered = frames_offered_.load(std::memory_order_relaxed);
+    stats.frames_encoded = frames_encoded_.load(std::memory_order_relaxed);
+    stats.frames_sent = frames_sent_.load(std::memory_order_relaxed);
+    stats.frames_skipped = frames_skipped_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    stats.clients_accepted = clients_accepted_.load(std::memory_order_relaxed);
+    stats.clients_rejected = clients_rejected_.load(std::memory_order_relaxed);
+    stats.clients = connected_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PreviewServer::serveLoop() {
+    pthread_setname_np(pthread_self(), "preview");
+    Realtime::applyRole(ThreadRole::BACKGROUND);
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), PREVIEW_NICE);
+
+    std::vector<struct pollfd> fds;
+    while (running_) {
+        fds.clear();
+        fds.push_back({wake_fd_, POLLIN, 0});
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (auto& client : clients_) {
+            // POLLIN on streaming clients only detects hangups
+            short events = POLLIN;
+            if (client->pending()) {
+                events |= POLLOUT;
+            }
+            fds.push_back({client->fd, events, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            Logger::error("Preview server poll failed: " + std::string(std::strerror(errno)));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            if (read(wake_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+                break;
+            }
+            if (!running_) {
+                break;
+            }
+            if (staged_ready_.load(std::memory_order_acquire)) {
+                encodeStaged();
+            }
+        }
+
+        // Client events; fds[i + 2] belongs to clients_[i] as polled
+        size_t polled = fds.size() - 2;
+        for (size_t i = 0; i < polled; i++) {
+            Client& client = *clients_[i];
+            short revents = fds[i + 2].revents;
+            bool keep = true;
+
+            if (revents & (POLLERR | POLLHUP)) {
+                keep = false;
+            } else if (revents & POLLIN) {
+                if (client.mode == Client::Mode::REQUEST) {
+                    readRequest(client);
+                } else {
+                    char discard[256];
+                    ssize_t n = recv(client.fd, discard, sizeof(discard), MSG_DONTWAIT);
+                    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                        keep = false;
+                    }
+                }
+            }
+            if (keep && client.pending()) {
+                keep = flush(client);
+            }
+            if (!keep) {
+                close(client.fd);
+                clients_[i].reset();
+            }
+        }
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), nullptr), clients_.end());
+
+        if (fds[1].revents & POLLIN) {
+            acceptClients();
+        }
+
+        int viewers = 0;
+        for (auto& client : clients_) {
+            viewers += client->waiting() ? 1 : 0;
+        }
+        viewers_.store(viewers, std::memory_order_relaxed);
+        connected_.store(static_cast<int>(clients_.size()), std::memory_order_relaxed);
+    }
+}
+
+void PreviewServer::acceptClients() {
+    int fd;
+    while ((fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (static_cast<int>(clients_.size()) >= config_.max_clients) {
+            send(fd, BUSY_RESPONSE, sizeof(BUSY_RESPONSE) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+            close(fd);
+            clients_rejected_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &CLIENT_SNDBUF, sizeof(CLIENT_SNDBUF));
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        clients_.push_back(std::move(client));
+        clients_accepted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PreviewServer::readRequest(Client& client) {
+    char buffer[512];
+    ssize_t n;
+    while ((n = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        client.request.append(buffer, static_cast<size_t>(n));
+        if (client.request.size() > MAX_REQUEST_SIZE) {
+            break;
+        }
+    }
+    if (n == 0 || client.request.size() > MAX_REQUEST_SIZE) {
+        client.mode = Client::Mode::CLOSING;
+        client.head = NOT_FOUND_RESPONSE;
+        return;
+    }
+    if (client.request.find("\r\n\r\n") == std::string::npos) {
+        return;
+    }
+
+    // "GET <path>[?query] HTTP/1.x"
+    std::string path;
+    if (client.request.compare(0, 4, "GET ") == 0) {
+        size_t end = client.request.find_first_of(" ?\r", 4);
+        path = client.request.substr(4, end == std::string::npos ? std::string::npos : end - 4);
+    }
+    client.request.clear();
+    client.request.shrink_to_fit();
+
+    if (path == "/" || path == "/stream") {
+        client.mode = Client::Mode::STREAM;
+        client.head = STREAM_RESPONSE;
+    } else if (path == "/snapshot.jpg") {
+        client.mode = Client::Mode::SNAPSHOT;
+    } else {
+        client.mode = Client::Mode::CLOSING;
+        client.head = NOT_FOUND_RESPONSE;
+    }
+}
+
+void PreviewServer::encodeStaged() {
+    auto encoded = std::make_shared<EncodedFrame>();
+    {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        if (config_.overlay) {
+            // Tile grid (the regions classified separately) and verdict
+            cv::Scalar color = staged_detected_ ? cv::Scalar(0, 0, 255) : cv::Scalar(0, 255, 0);
+            int grid = std::max(1, staged_grid_);
+            for (int ty = 0; ty < grid && grid > 1; ty++) {
+                for (int tx = 0; tx < grid; tx++) {
+                    int x0 = staged_.cols * tx / grid;
+                    int y0 = staged_.rows * ty / grid;
+                    cv::rectangle(staged_, cv::Rect(x0, y0, staged_.cols * (tx + 1) / grid - x0,
+                                                    staged_.rows * (ty + 1) / grid - y0),
+                                  color, 1);
+                }
+            }
+            char label[48];
+            std::snprintf(label, sizeof(label), "%s %.2f", staged_detected_ ? "SMOKE" : "clear",
+                          staged_confidence_);
+            double scale = std::max(0.5, staged_.cols / 640.0);
+            cv::putText(staged_, label, cv::Point(8, static_cast<int>(24 * scale)),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.7 * scale, color, 2);
+        }
+        cv::imencode(".jpg", staged_, jpeg_, encode_params_);
+    }
+    staged_ready_.store(false, std::memory_order_release);
+
+    encoded->seq = frames_encoded_.fetch_add(1, std::memory_order_relaxed) + 1;
+    char header[96];
+    int header_len = std::snprintf(header, sizeof(header),
+                                   "--frame\r\nContent-Type: image/jpeg\r\n"
+                                   "Content-Length: %zu\r\n\r\n", jpeg_.size());
+    encoded->part.reserve(header_len + jpeg_.size() + 2);
+    encoded->part.append(header, header_len);
+    encoded->part.append(reinterpret_cast<const char*>(jpeg_.data()), jpeg_.size());
+    encoded->part.append("\r\n");
+    encoded->jpeg_offset = header_len;
+    encoded->jpeg_size = jpeg_.size();
+    latest_ = std::move(encoded);
+
+    // Idle clients start on it now; busy ones when they finish
+    for (auto& client : clients_) {
+        if (client->waiting() && !client->frame) {
+            startNextFrame(*client);
+        }
+    }
+}
+
+void PreviewServer::startNextFrame(Client& client) {
+    if (!latest_ || latest_->seq <= client.last_seq) {
+        return;
+    }
+    if (client.last_seq > 0) {
+        frames_skipped_.fetch_add(latest_->seq - client.last_seq - 1, std::memory_order_relaxed);
+    }
+    client.last_seq = latest_->seq;
+    client.frame = latest_;
+
+    if (client.mode == Client::Mode::SNAPSHOT) {
+        char header[128];
+        int header_len = std::snprintf(header, sizeof(header),
+                                       "HTTP/1.0 200 OK\r\nContent-Type: image/jpeg\r\n"
+                                       "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                       latest_->jpeg_size);
+        client.head.assign(header, header_len);
+        client.head_offset = 0;
+        client.offset = latest_->jpeg_offset;
+        client.end = latest_->jpeg_offset + latest_->jpeg_size;
+    } else {
+        client.offset = 0;
+        client.end = latest_->part.size();
+    }
+}
+
+bool PreviewServer::flush(Client& client) {
+    while (client.pending()) {
+        struct iovec iov[2];
+        int count = 0;
+        if (client.head_offset < client.head.size()) {
+            iov[count].iov_base = const_cast<char*>(client.head.data()) + client.head_offset;
+            iov[count].iov_len = client.head.size() - client.head_offset;
+            count++;
+        }
+        if (client.frame) {
+            iov[count].iov_base = const_cast<char*>(client.frame->part.data()) + client.offset;
+            iov[count].iov_len = client.end - client.offset;
+            count++;
+        }
+
+        struct msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(client.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        bytes_sent_.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+
+        size_t written = static_cast<size_t>(n);
+        size_t from_head = std::min(written, client.head.size() - client.head_offset);
+        client.head_offset += from_head;
+        client.offset += written - from_head;
+
+        if (client.head_offset == client.head.size() && !client.head.empty()) {
+            client.head.clear();
+            client.head_offset = 0;
+        }
+        if (client.frame && client.offset == client.end) {
+            client.frame.reset();
+            frames_sent_.fetch_add(1, std::memory_order_relaxed);
+            if (client.mode == Client::Mode::SNAPSHOT) {
+                return false;
+            }
+            startNextFrame(client);
+        }
+    }
+    return client.mode != Client::Mode::CLOSING;
+}
+
+} // namespace sentinel
\ No newline at end of file
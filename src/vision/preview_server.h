@@ -0,0 +1,112 @@
+#ifndef SENTINEL_PREVIEW_SERVER_H
+#define SENTINEL_PREVIEW_SERVER_H
+
+#include "core/sentinel_core.h"
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sentinel {
+
+struct PreviewStats {
+    uint64_t frames_offered = 0;     // Frames handed over by the detection loop
+    uint64_t frames_encoded = 0;     // JPEG encodes (at most one per offered frame)
+    uint64_t frames_sent = 0;        // Frames fully written, summed over clients
+    uint64_t frames_skipped = 0;     // Frames a client missed while still sending
+    uint64_t bytes_sent = 0;
+    uint64_t clients_accepted = 0;
+    uint64_t clients_rejected = 0;   // Over max_clients
+    int clients = 0;                 // Connected now
+};
+
+// Live camera preview over HTTP, for aligning cameras on site:
+//   GET /              multipart/x-mixed-replace MJPEG stream
+//   GET /snapshot.jpg  the next frame as a single JPEG
+//
+// The detection loop offers the frames it classified; nothing is taken
+// from the camera, so the preview never competes for /dev/video0. While
+// a client is connected and max_fps allows, offerFrame() copies the frame
+// into a staging buffer. The server thread (background role, niced)
+// draws the overlay, encodes the JPEG once and points every client at
+// the same buffer. Sockets are non-blocking: a client that is still
+// sending the previous frame skips to the newest one when it is done, so
+// a slow viewer never holds up the others or the loop.
+class PreviewServer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit PreviewServer(const PreviewConfig& config);
+    ~PreviewServer();
+
+    bool start();
+    void stop();
+
+    // Port actually bound (useful with port 0)
+    int port() const { return bound_port_; }
+
+    // Cheap check for the detection loop: a client is waiting, the frame
+    // rate limit has passed and the previous frame has been encoded
+    bool wantsFrame(Clock::time_point now) const;
+
+    // Stage a BGR frame with what the overlay shows. No-op unless
+    // wantsFrame(now).
+    void offerFrame(const cv::Mat& frame, float confidence, bool detected, int tile_grid,
+                    Clock::time_point now);
+
+    PreviewStats stats() const;
+
+private:
+    struct Client;
+    struct EncodedFrame;
+
+    void serveLoop();
+    void acceptClients();
+    void readRequest(Client& client);
+    void encodeStaged();
+    void startNextFrame(Client& client);
+    bool flush(Client& client);
+
+    PreviewConfig config_;
+    Clock::duration frame_interval_;
+    int listen_fd_;
+    int wake_fd_;                    // eventfd: frame staged or stop()
+    int bound_port_;
+
+    // Staging between the loop and the server thread
+    std::mutex staging_mutex_;
+    cv::Mat staged_;
+    float staged_confidence_;
+    bool staged_detected_;
+    int staged_grid_;
+    std::atomic<bool> staged_ready_;
+    Clock::time_point last_offer_;   // Detection loop only
+
+    // Server thread only
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::shared_ptr<const EncodedFrame> latest_;
+    std::vector<unsigned char> jpeg_;
+    std::vector<int> encode_params_;
+
+    std::atomic<int> viewers_;       // Clients waiting for frames
+    std::atomic<int> connected_;
+    std::atomic<uint64_t> frames_offered_;
+    std::atomic<uint64_t> frames_encoded_;
+    std::atomic<uint64_t> frames_sent_;
+    std::atomic<uint64_t> frames_skipped_;
+    std::atomic<uint64_t> bytes_sent_;
+    std::atomic<uint64_t> clients_accepted_;
+    std::atomic<uint64_t> clients_rejected_;
+
+    std::atomic<bool> running_;
+    std::thread serve_thread_;
+};
+
+} // namespace sentinel
+
+#endif // SENTINEL_PREVIEW_SERVER_H
\ No newline at end of file
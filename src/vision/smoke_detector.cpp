@@ -1,18 +1,53 @@
 #include "vision/smoke_detector.h"
+#include "vision/interpreter_pool.h"
 #include "vision/tflite_inference.h"
+#include "sensors/iio_light_sensor.h"
+#include "utils/executor.h"
 #include "utils/logger.h"
-// #include <opencv2/opencv.hpp>
-// #include <opencv2/imgproc.hpp>
+#include "utils/memory_tracker.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <sstream>
 
 namespace sentinel {
 
-SmokeDetector::SmokeDetector(const std::string& model_path)
+// By day only the brightness is needed: every 8th row is plenty
+constexpr int DAY_LUMA_ROW_STEP = 8;
+
+// Smoke probability from the classifier output: [no_smoke, smoke], or a
+// single smoke score
+static float smokeProbability(const InferenceResult& result) {
+    if (result.output.size() >= 2) {
+        return result.output[1];
+    }
+    return result.output.empty() ? 0.0f : result.output[0];
+}
+
+static PlumeTrackerConfig plumeTrackerConfig(const VisionConfig& config) {
+    PlumeTrackerConfig tracker;
+    tracker.threshold = config.plume_threshold;
+    tracker.growth_frames = config.plume_growth_frames;
+    return tracker;
+}
+
+SmokeDetector::SmokeDetector(const std::string& model_path, const VisionConfig& config)
     : model_path_(model_path),
+      config_(config),
       inference_engine_(nullptr),
+      active_engine_(nullptr),
+      tile_grid_(std::clamp(config.tile_grid, 1, MAX_TILE_GRID)),
+      threads_(1),
       is_initialized_(false),
       input_height_(224),
       input_width_(224),
-      input_channels_(3) {
+      input_channels_(3),
+      plume_tracker_(plumeTrackerConfig(config)),
+      input_buffer_(&MemoryTracker::resource(MemorySubsystem::VISION)),
+      inference_result_(std::make_unique<InferenceResult>()) {
 }
 
 SmokeDetector::~SmokeDetector() {
@@ -22,13 +57,18 @@ SmokeDetector::~SmokeDetector() {
 bool SmokeDetector::initialize() {
     Logger::info("Initializing Smoke Detector with model: " + model_path_);
     
-    // Initialize TFLite inference engine
-    inference_engine_ = std::make_unique<TFLiteInference>();
-    
-    if (!inference_engine_->loadModel(model_path_)) {
+    // Initialize TFLite inference: the model is mapped once and shared by
+    // the pool's interpreters; the first one serves whole frames
+    pool_ = std::make_unique<InterpreterPool>();
+    if (!pool_->load(model_path_, config_.interpreters)) {
         Logger::error("Failed to load TFLite model");
         return false;
     }
+    inference_engine_ = &pool_->interpreter(0);
+    tile_buffers_.resize(pool_->size());
+    for (TileBuffers& buffers : tile_buffers_) {
+        buffers.result = std::make_unique<InferenceResult>();
+    }
     
     // Get model input dimensions
     inference_engine_->getInputDimensions(input_height_, input_width_, input_channels_);
@@ -36,32 +76,340 @@ bool SmokeDetector::initialize() {
     Logger::info("Model input shape: " + std::to_string(input_height_) + "x" +
                 std::to_string(input_width_) + "x" + 
                 std::to_string(input_channels_));
+    if (inference_engine_->isSegmentation()) {
+        int height = 0;
+        int width = 0;
+        int channels = 0;
+        inference_engine_->getOutputShape(height, width, channels);
+        Logger::logf(LogLevel::INFO, "Segmentation model: %dx%dx%d mask, tracking plumes",
+                     height, width, channels);
+    }
+    
+    // Inference uses the executor's thread budget. OpenCV's own pool is
+    // disabled; preprocessing runs its row bands on the executor instead,
+    // so the two never oversubscribe the CPUs.
+    cv::setNumThreads(0);
+    active_engine_ = inference_engine_;
+    
+    // The lite model is optional: without it the governor skips that step
+    if (!config_.lite_model_path.empty()) {
+        lite_engine_ = std::make_unique<TFLiteInference>();
+        if (lite_engine_->loadModel(config_.lite_model_path)) {
+            Logger::info("Lite model loaded: " + config_.lite_model_path);
+        } else {
+            Logger::warn("Failed to load lite model " + config_.lite_model_path);
+            lite_engine_.reset();
+        }
+    }
     
-    // Set number of threads for inference (optimize for Raspberry Pi)
-    inference_engine_->setNumThreads(2);
+    threads_ = Executor::threadBudget();
+    applyThreads();
+    openLightSensor();
     
     // Initialize camera
-    camera_.open(0); // Open default camera
-    if (!camera_.isOpened()) {
-        Logger::error("Failed to open camera");
+    if (!openCamera()) {
         return false;
     }
     
-    // Set camera properties
-    camera_.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-    camera_.set(cv::CAP_PROP_FRAME_HEIGHT, 480);
-    camera_.set(cv::CAP_PROP_FPS, 30);
+    if (config_.profile_invokes > 0) {
+        startProfiling(config_.profile_invokes);
+    }
     
     is_initialized_ = true;
     Logger::info("Smoke Detector initialized successfully");
     return true;
 }
 
+bool SmokeDetector::openCamera() {
+    if (!config_.video_source.empty()) {
+        // Recorded footage replaces the camera (looped, see detectSmoke)
+        camera_.open(config_.video_source);
+        if (!camera_.isOpened()) {
+            Logger::error("Failed to open video source " + config_.video_source);
+            return false;
+        }
+        return true;
+    }
+    
+    camera_.open(config_.camera_device);
+    if (!camera_.isOpened()) {
+        Logger::error("Failed to open camera " + std::to_string(config_.camera_device));
+        return false;
+    }
+    
+    // Set camera properties
+    camera_.set(cv::CAP_PROP_FRAME_WIDTH, config_.frame_width);
+    camera_.set(cv::CAP_PROP_FRAME_HEIGHT, config_.frame_height);
+    camera_.set(cv::CAP_PROP_FPS, config_.fps);
+    return true;
+}
+
+bool SmokeDetector::applyConfig(const VisionConfig& config) {
+    bool reopen = config.camera_device != config_.camera_device ||
+                  config.video_source != config_.video_source ||
+                  config.frame_width != config_.frame_width ||
+                  config.frame_height != config_.frame_height;
+    bool fps_changed = config.fps != config_.fps;
+    bool profile = config.profile_invokes > 0 && config.profile_invokes != config_.profile_invokes;
+    bool light = config.night_mode != config_.night_mode ||
+                 config.light_sensor != config_.light_sensor;
+    
+    config_ = config;
+    tile_grid_ = std::clamp(config.tile_grid, 1, MAX_TILE_GRID);
+    plume_tracker_.setConfig(plumeTrackerConfig(config_));
+    
+    // A new (nonzero) profile_invokes requests a profile
+    if (profile) {
+        startProfiling(config_.profile_invokes);
+    }
+    
+    if (light) {
+        if (!config_.night_mode) {
+            day_night_.reset();
+        }
+        openLightSensor();
+    }
+    
+    if (reopen) {
+        Logger::info("Camera settings changed, reopening camera");
+        camera_.release();
+        if (!openCamera()) {
+            is_initialized_ = false;
+            return false;
+        }
+        is_initialized_ = (inference_engine_ != nullptr);
+    } else if (fps_changed && camera_.isOpened()) {
+        camera_.set(cv::CAP_PROP_FPS, config_.fps);
+    }
+    
+    return true;
+}
+
+void SmokeDetector::setQuality(int tile_grid, bool lite_model, int threads) {
+    tile_grid_ = std::clamp(tile_grid, 1, MAX_TILE_GRID);
+    if (!inference_engine_) {
+        return;
+    }
+    
+    TFLiteInference* engine = lite_model && lite_engine_ ? lite_engine_.get() :
+                                                           inference_engine_;
+    if (engine != active_engine_) {
+        // Tracks from one model's masks do not carry over to the other's
+        active_engine_ = engine;
+        active_engine_->getInputDimensions(input_height_, input_width_, input_channels_);
+        plume_tracker_.reset();
+    }
+    threads_ = std::max(1, threads);
+    applyThreads();
+}
+
+void SmokeDetector::openLightSensor() {
+    if (light_sensor_) {
+        light_sensor_->shutdown();
+        light_sensor_.reset();
+    }
+    if (!config_.night_mode || config_.light_sensor.empty()) {
+        return;
+    }
+    
+    // Without a working sensor the frame's own brightness decides
+    light_sensor_ = std::make_unique<IioLightSensor>(config_.light_sensor);
+    if (!light_sensor_->initialize()) {
+        Logger::warn("Light sensor unavailable, using frame luminance for day/night");
+        light_sensor_.reset();
+    }
+}
+
+bool SmokeDetector::modelWanted(DetectionResult& result) {
+    if (!config_.night_mode) {
+        return true;
+    }
+    
+    // At night every row is scanned for glow; by day a sample of rows
+    // gives the brightness
+    bool night = day_night_.mode() == VisionMode::NIGHT;
+    FrameLight light = GlowDetector::analyze(frame_, night ? 1 : DAY_LUMA_ROW_STEP);
+    
+    float lux = light_sensor_ ? light_sensor_->getLightLux() : 0.0f;
+    bool sensor = light_sensor_ && light_sensor_->isHealthy();
+    float level = sensor ? lux : light.mean_luma;
+    if (day_night_.update(level, sensor ? config_.night_lux : config_.night_luma,
+                          sensor ? config_.day_lux : config_.day_luma,
+                          std::chrono::seconds(config_.night_hold_sec),
+                          std::chrono::steady_clock::now())) {
+        Logger::logf(LogLevel::INFO, "Vision %s mode (%s %.1f)",
+                     visionModeName(day_night_.mode()), sensor ? "lux" : "luma", level);
+    }
+    
+    result.night = day_night_.mode() == VisionMode::NIGHT;
+    if (!result.night) {
+        return true;
+    }
+    result.glow_fraction = light.glow_fraction;
+    return light.glow_fraction >= config_.night_glow_fraction;
+}
+
+void SmokeDetector::applyThreads() {
+    int per_interpreter = threads_;
+    if (tile_grid_ > 1 && pool_->size() > 1) {
+        per_interpreter = std::max(1, threads_ / pool_->size());
+    }
+    pool_->setNumThreads(per_interpreter);
+    if (lite_engine_) {
+        lite_engine_->setNumThreads(threads_);
+    }
+}
+
+void SmokeDetector::startProfiling(int invokes) {
+    if (inference_engine_) {
+        inference_engine_->startProfiling(invokes);
+    }
+    if (lite_engine_) {
+        lite_engine_->startProfiling(invokes);
+    }
+}
+
+void SmokeDetector::reportProfile(const OpProfileReport& report) {
+    std::string text = OpProfiler::format(report);
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        Logger::info(line);
+    }
+    
+    if (config_.profile_path.empty()) {
+        return;
+    }
+    std::FILE* file = std::fopen(config_.profile_path.c_str(), "a");
+    if (!file) {
+        Logger::warn("Cannot write operator profile to " + config_.profile_path);
+        return;
+    }
+    std::fputs(text.c_str(), file);
+    std::fputs("\n", file);
+    std::fclose(file);
+}
+
+bool SmokeDetector::runModel(const cv::Mat& region, float& inference_time_ms) {
+    // Preprocess frame
+    const cv::Mat& processed = preprocessFrame(region);
+    
+    // The normalized RGB float image is already in the model's HWC layout;
+    // copy only if OpenCV handed back a non-contiguous matrix
+    const float* input_data = processed.ptr<float>();
+    size_t input_size = static_cast<size_t>(input_height_) * input_width_ * input_channels_;
+    if (!processed.isContinuous()) {
+        input_buffer_.resize(input_size);
+        for (int y = 0; y < input_height_; y++) {
+            const float* row = processed.ptr<float>(y);
+            std::copy(row, row + input_width_ * input_channels_,
+                      input_buffer_.begin() + y * input_width_ * input_channels_);
+        }
+        input_data = input_buffer_.data();
+    }
+    
+    // Run inference
+    InferenceResult& inference_result = *inference_result_;
+    if (!active_engine_->runInference(input_data, input_size, inference_result)) {
+        return false;
+    }
+    inference_time_ms += inference_result.inference_time_ms;
+    return true;
+}
+
+bool SmokeDetector::classify(const cv::Mat& region, float& confidence,
+                             float& inference_time_ms) {
+    if (!runModel(region, inference_time_ms)) {
+        return false;
+    }
+    confidence = smokeProbability(*inference_result_);
+    return true;
+}
+
+bool SmokeDetector::segment(DetectionResult& result) {
+    if (!runModel(frame_, result.inference_time_ms)) {
+        return false;
+    }
+    
+    // The frame is as smoky as its smokiest pooled mask cell
+    int height = 0;
+    int width = 0;
+    int channels = 0;
+    active_engine_->getOutputShape(height, width, channels);
+    result.confidence = plume_tracker_.update(inference_result_->output.data(), height, width,
+                                              channels, std::chrono::steady_clock::now());
+    
+    const PlumeTrack* plume = plume_tracker_.primary();
+    if (!plume) {
+        return true;
+    }
+    result.plume = true;
+    result.plume_growing = plume_tracker_.isPersistent(*plume);
+    result.plume_id = plume->id;
+    result.plume_area = plume->area;
+    result.plume_x = plume->centroid_x;
+    result.plume_y = plume->centroid_y;
+    result.plume_growth_rate = plume->growth_rate;
+    
+    // When the track starts to qualify
+    if (result.plume_growing && plume->growing_frames == config_.plume_growth_frames) {
+        Logger::logf(LogLevel::INFO,
+                     "Growing plume %u: %.1f%% of frame at (%.2f, %.2f), %+.2f%%/s",
+                     plume->id, 100.0f * plume->area, plume->centroid_x, plume->centroid_y,
+                     100.0f * plume->growth_rate);
+    }
+    return true;
+}
+
+bool SmokeDetector::classifyTiles(int grid, float& confidence, float& inference_time_ms) {
+    const size_t tiles = static_cast<size_t>(grid) * grid;
+    const size_t input_size = static_cast<size_t>(input_height_) * input_width_ * input_channels_;
+    std::array<float, MAX_TILE_GRID * MAX_TILE_GRID> confidences{};
+    std::atomic<bool> failed{false};
+    
+    // Tiles are independent: the caller and idle executor workers take
+    // them one at a time, each on an interpreter checked out of the pool
+    // with that interpreter's own buffers
+    auto start = std::chrono::steady_clock::now();
+    Executor::parallelFor(tiles, 1, [&](size_t begin, size_t end) {
+        InterpreterPool::Lease lease = pool_->acquire();
+        TileBuffers& buffers = tile_buffers_[lease.index()];
+        for (size_t i = begin; i < end; i++) {
+            int tx = static_cast<int>(i) % grid;
+            int ty = static_cast<int>(i) / grid;
+            int x0 = frame_.cols * tx / grid;
+            int y0 = frame_.rows * ty / grid;
+            cv::Rect tile(x0, y0, frame_.cols * (tx + 1) / grid - x0,
+                          frame_.rows * (ty + 1) / grid - y0);
+            
+            // Same steps as preprocessFrame(), serially: the tiles are the
+            // parallel work here
+            cv::resize(frame_(tile), buffers.resized, cv::Size(input_width_, input_height_));
+            cv::cvtColor(buffers.resized, buffers.rgb, cv::COLOR_BGR2RGB);
+            buffers.rgb.convertTo(buffers.processed, CV_32F, 1.0 / 255.0);
+            
+            if (!lease->runInference(buffers.processed.ptr<float>(), input_size,
+                                     *buffers.result)) {
+                failed = true;
+                continue;
+            }
+            confidences[i] = smokeProbability(*buffers.result);
+        }
+    });
+    
+    // Wall time: the tiles overlap
+    inference_time_ms += std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    confidence = *std::max_element(confidences.begin(), confidences.begin() + tiles);
+    return !failed;
+}
+
 DetectionResult SmokeDetector::detectSmoke() {
     DetectionResult result;
     result.detected = false;
     result.confidence = 0.0f;
     result.smoothed_confidence = 0.0f;
+    result.inference_time_ms = 0.0f;
     result.timestamp = std::chrono::system_clock::now();
     
     if (!is_initialized_) {
@@ -69,81 +417,107 @@ DetectionResult SmokeDetector::detectSmoke() {
         return result;
     }
     
-    // Capture frame
-    cv::Mat frame;
-    if (!camera_.read(frame) || frame.empty()) {
+    // Capture frame (into the reused frame buffer); recorded footage loops
+    bool captured = camera_.read(frame_) && !frame_.empty();
+    if (!captured && !config_.video_source.empty()) {
+        camera_.set(cv::CAP_PROP_POS_FRAMES, 0);
+        captured = camera_.read(frame_) && !frame_.empty();
+    }
+    if (!captured) {
         Logger::error("Failed to capture frame");
         return result;
     }
     
-    // Preprocess frame
-    cv::Mat processed = preprocessFrame(frame);
-    
-    // Convert to float array for inference
-    std::vector<float> input_data(input_height_ * input_width_ * input_channels_);
-    
-    // Copy pixel data (already normalized in preprocessFrame)
-    int idx = 0;
-    for (int y = 0; y < input_height_; y++) {
-        for (int x = 0; x < input_width_; x++) {
-            cv::Vec3f pixel = processed.at<cv::Vec3f>(y, x);
-            input_data[idx++] = pixel[0]; // R
-            input_data[idx++] = pixel[1]; // G
-            input_data[idx++] = pixel[2]; // B
+    // Classify the whole frame, or each tile of an NxN grid: a small,
+    // distant plume survives the downscale to the model input better in a
+    // tile. The frame is as smoky as its smokiest tile. A segmentation
+    // model's mask already localizes the plume, so it sees the whole frame.
+    //
+    // Night mode: dark frames get the glow detector, and the model runs
+    // only when something glows; otherwise the frame counts as clear.
+    const int grid = tile_grid_;
+    if (!modelWanted(result)) {
+        result.confidence = 0.0f;
+    } else if (active_engine_->isSegmentation()) {
+        if (!segment(result)) {
+            Logger::error("Inference failed");
+            return result;
+        }
+    } else if (grid > 1 && pool_->size() > 1 && active_engine_ == inference_engine_) {
+        if (!classifyTiles(grid, result.confidence, result.inference_time_ms)) {
+            Logger::error("Inference failed");
+            return result;
+        }
+    } else {
+        for (int ty = 0; ty < grid; ty++) {
+            for (int tx = 0; tx < grid; tx++) {
+                int x0 = frame_.cols * tx / grid;
+                int y0 = frame_.rows * ty / grid;
+                cv::Rect tile(x0, y0, frame_.cols * (tx + 1) / grid - x0,
+                              frame_.rows * (ty + 1) / grid - y0);
+                float confidence = 0.0f;
+                if (!classify(grid == 1 ? frame_ : frame_(tile), confidence,
+                              result.inference_time_ms)) {
+                    Logger::error("Inference failed");
+                    return result;
+                }
+                result.confidence = std::max(result.confidence, confidence);
+            }
         }
     }
     
-    // Run inference
-    auto inference_result = inference_engine_->runInference(input_data);
-    
-    if (!inference_result.success) {
-        Logger::error("Inference failed");
-        return result;
-    }
-    
-    // Extract smoke detection probability
-    // Assuming binary classification: [no_smoke_prob, smoke_prob]
-    if (inference_result.output.size() >= 2) {
-        result.confidence = inference_result.output[1]; // Smoke probability
-    } else if (inference_result.output.size() == 1) {
-        result.confidence = inference_result.output[0]; // Single output
+    OpProfileReport profile;
+    if (active_engine_->takeProfile(profile)) {
+        reportProfile(profile);
     }
     
-    result.detected = (result.confidence > CONFIDENCE_THRESHOLD);
-    result.inference_time_ms = inference_result.inference_time_ms;
+    result.detected = (result.confidence > config_.confidence_threshold);
     
     // Apply temporal smoothing
-    confidence_history_.push_back(result.confidence);
-    if (confidence_history_.size() > 10) {
-        confidence_history_.erase(confidence_history_.begin());
-    }
+    confidence_history_.push(result.confidence);
     
     // Calculate smoothed confidence
     float smoothed_confidence = 0.0f;
-    for (float c : confidence_history_) {
-        smoothed_confidence += c;
+    for (size_t i = 0; i < confidence_history_.size(); i++) {
+        smoothed_confidence += confidence_history_[i];
     }
     smoothed_confidence /= confidence_history_.size();
     
     result.smoothed_confidence = smoothed_confidence;
-    result.detected = (smoothed_confidence > CONFIDENCE_THRESHOLD);
+    result.detected = (smoothed_confidence > config_.confidence_threshold);
+    
+    // A plume that keeps growing is smoke even while its score is modest
+    result.detected = result.detected || result.plume_growing;
     
     return result;
 }
 
-cv::Mat SmokeDetector::preprocessFrame(const cv::Mat& frame) {
-    cv::Mat processed;
+const cv::Mat& SmokeDetector::preprocessFrame(const cv::Mat& frame) {
+    // Each step writes into a member Mat; OpenCV reuses the existing
+    // allocation when size and type are unchanged
     
     // Resize to model input size
-    cv::resize(frame, processed, cv::Size(input_width_, input_height_));
-    
-    // Convert BGR to RGB
-    cv::cvtColor(processed, processed, cv::COLOR_BGR2RGB);
+    cv::resize(frame, resized_, cv::Size(input_width_, input_height_));
     
-    // Convert to float and normalize pixel values to [0, 1]
-    processed.convertTo(processed, CV_32F, 1.0 / 255.0);
+    // Colour conversion and normalization are row-local: run them in
+    // bands across the executor, writing through row views of the outputs
+    rgb_.create(resized_.size(), resized_.type());
+    processed_.create(resized_.size(), CV_32FC3);
+    Executor::parallelFor(static_cast<size_t>(resized_.rows), 16,
+                          [this](size_t begin, size_t end) {
+        int first = static_cast<int>(begin);
+        int last = static_cast<int>(end);
+        cv::Mat rgb = rgb_.rowRange(first, last);
+        cv::Mat processed = processed_.rowRange(first, last);
+        
+        // Convert BGR to RGB
+        cv::cvtColor(resized_.rowRange(first, last), rgb, cv::COLOR_BGR2RGB);
+        
+        // Convert to float and normalize pixel values to [0, 1]
+        rgb.convertTo(processed, CV_32F, 1.0 / 255.0);
+    });
     
-    return processed;
+    return processed_;
 }
 
 cv::Mat SmokeDetector::captureFrame() {
@@ -163,7 +537,7 @@ void SmokeDetector::saveFrame(const cv::Mat& frame, const std::string& filename)
     }
 }
 
-std::vector<float> SmokeDetector::getConfidenceHistory() const {
+const SmokeDetector::ConfidenceHistory& SmokeDetector::getConfidenceHistory() const {
     return confidence_history_;
 }
 
@@ -171,14 +545,30 @@ void SmokeDetector::clearHistory() {
     confidence_history_.clear();
 }
 
+void SmokeDetector::restoreConfidenceHistory(const std::vector<float>& history) {
+    confidence_history_.clear();
+    for (float confidence : history) {
+        confidence_history_.push(confidence);
+    }
+}
+
 void SmokeDetector::shutdown() {
     if (camera_.isOpened()) {
         camera_.release();
     }
     
-    if (inference_engine_) {
-        inference_engine_->shutdown();
+    if (light_sensor_) {
+        light_sensor_->shutdown();
+        light_sensor_.reset();
+    }
+    if (pool_) {
+        pool_->shutdown();
+    }
+    if (lite_engine_) {
+        lite_engine_->shutdown();
     }
+    inference_engine_ = nullptr;
+    active_engine_ = nullptr;
     
     is_initialized_ = false;
     Logger::info("Smoke Detector shutdown complete");
@@ -4,14 +4,23 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <memory_resource>
 #include <chrono>
-// #include <opencv2/core.hpp>
-// #include <opencv2/videoio.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include "core/sentinel_core.h"
+#include "utils/ring_buffer.h"
+#include "vision/day_night.h"
+#include "vision/plume_tracker.h"
 
 namespace sentinel {
 
-// Forward declaration
+// Forward declarations
 class TFLiteInference;
+class InterpreterPool;
+class ILightSensor;
+struct InferenceResult;
+struct OpProfileReport;
 
 struct DetectionResult {
     bool detected;
@@ -19,11 +28,30 @@ struct DetectionResult {
     float smoothed_confidence;
     float inference_time_ms;
     std::chrono::system_clock::time_point timestamp;
+    
+    // Segmentation models only: the primary plume (see PlumeTracker)
+    bool plume = false;              // A plume was seen this frame
+    bool plume_growing = false;      // It has kept growing for vision.plume_growth_frames
+    uint32_t plume_id = 0;
+    float plume_area = 0.0f;         // Fraction of the frame
+    float plume_x = 0.0f;            // Centroid, 0-1 from the top left
+    float plume_y = 0.0f;
+    float plume_growth_rate = 0.0f;  // Area fraction per second
+    
+    // vision.night_mode: set in night mode, where the model only ran
+    // (inference_time_ms > 0) if the glowing share reached the threshold
+    bool night = false;
+    float glow_fraction = 0.0f;
 };
 
 class SmokeDetector {
 public:
-    explicit SmokeDetector(const std::string& model_path);
+    // Frames averaged for temporal smoothing
+    static constexpr size_t CONFIDENCE_WINDOW = 10;
+    using ConfidenceHistory = RingBuffer<float, CONFIDENCE_WINDOW>;
+    
+    explicit SmokeDetector(const std::string& model_path,
+                           const VisionConfig& config = VisionConfig());
     ~SmokeDetector();
     
     // Initialize vision system and load model
@@ -35,24 +63,88 @@ public:
     // Capture a single frame from camera
     cv::Mat captureFrame();
     
+    // Frame classified by the latest detectSmoke() (BGR); overwritten by
+    // the next call
+    const cv::Mat& lastFrame() const { return frame_; }
+    
     // Save frame to disk
     void saveFrame(const cv::Mat& frame, const std::string& filename);
     
-    // Get confidence history
-    std::vector<float> getConfidenceHistory() const;
+    // Resize, convert to RGB and normalize a BGR frame for the model. The
+    // result lives in an internal buffer until the next call. Usable
+    // before initialize() (at the default 224x224 input size).
+    const cv::Mat& preprocessFrame(const cv::Mat& frame);
+    
+    // Get confidence history (oldest first)
+    const ConfidenceHistory& getConfidenceHistory() const;
     
     // Clear confidence history
     void clearHistory();
     
+    // Replace the confidence history (oldest first), for warm restarts
+    void restoreConfidenceHistory(const std::vector<float>& history);
+    
+    // Apply runtime settings. Threshold and fps are applied in place; a new
+    // camera device or resolution reopens the camera. Returns false if the
+    // camera could not be reopened.
+    bool applyConfig(const VisionConfig& config);
+    
+    // Apply a quality step (see ThermalGovernor): tiles per side, the lite
+    // model instead of the full one (if loaded) and the TFLite thread
+    // count. Both models stay loaded, so switching is immediate.
+    void setQuality(int tile_grid, bool lite_model, int threads);
+    bool hasLiteModel() const { return lite_engine_ != nullptr; }
+    
+    // Current day/night mode (always DAY without vision.night_mode)
+    VisionMode mode() const { return day_night_.mode(); }
+    
+    // Profile the next invokes runs of each model per operator. The
+    // ranked report is logged and, with vision.profile_path set, appended
+    // to that file. Also started by vision.profile_invokes.
+    void startProfiling(int invokes);
+    
     // Cleanup
     void shutdown();
     
 private:
-    // Preprocess frame for model input
-    cv::Mat preprocessFrame(const cv::Mat& frame);
+    // Open and configure the camera from config_
+    bool openCamera();
+    
+    // Run the active model on one region of the frame into inference_result_
+    bool runModel(const cv::Mat& region, float& inference_time_ms);
+    
+    // Classifier: smoke probability of one region
+    bool classify(const cv::Mat& region, float& confidence, float& inference_time_ms);
+    
+    // Segmentation model: mask the whole frame and update the plume tracks
+    bool segment(DetectionResult& result);
+    
+    // Classify the tiles of an NxN grid concurrently, one pool interpreter
+    // each; returns the highest tile confidence
+    bool classifyTiles(int grid, float& confidence, float& inference_time_ms);
+    
+    // Thread budget per interpreter: split between the pool's
+    // interpreters while tiles run in parallel
+    void applyThreads();
+    
+    // Open vision.light_sensor, if set and night mode is on
+    void openLightSensor();
+    
+    // Night mode: update the day/night switch from the light sensor or
+    // the frame and decide whether the model runs on this frame
+    bool modelWanted(DetectionResult& result);
+    
+    // Log and save a finished operator profile
+    void reportProfile(const OpProfileReport& report);
     
     std::string model_path_;
-    std::unique_ptr<TFLiteInference> inference_engine_;
+    VisionConfig config_;
+    std::unique_ptr<InterpreterPool> pool_;          // vision.interpreters, one model mapping
+    TFLiteInference* inference_engine_;              // The pool's first interpreter
+    std::unique_ptr<TFLiteInference> lite_engine_;   // vision.lite_model_path, optional
+    TFLiteInference* active_engine_;
+    int tile_grid_;
+    int threads_;
     
     cv::VideoCapture camera_;
     
@@ -61,9 +153,28 @@ private:
     int input_width_;
     int input_channels_;
     
-    std::vector<float> confidence_history_;
+    ConfidenceHistory confidence_history_;
+    PlumeTracker plume_tracker_;
+    
+    std::unique_ptr<ILightSensor> light_sensor_;     // vision.light_sensor, optional
+    DayNightSwitch day_night_;
+    
+    // Per-frame buffers, reused so steady-state detection does not allocate
+    cv::Mat frame_;
+    cv::Mat resized_;
+    cv::Mat rgb_;
+    cv::Mat processed_;
+    std::pmr::vector<float> input_buffer_;   // Vision memory resource
+    std::unique_ptr<InferenceResult> inference_result_;
     
-    static constexpr float CONFIDENCE_THRESHOLD = 0.75f;
+    // Per pool interpreter, for parallel tiles
+    struct TileBuffers {
+        cv::Mat resized;
+        cv::Mat rgb;
+        cv::Mat processed;
+        std::unique_ptr<InferenceResult> result;
+    };
+    std::vector<TileBuffers> tile_buffers_;
 };
 
 } // namespace sentinel
@@ -1,81 +1,247 @@
-#ifndef TFLITE_INFERENCE_H
-#define TFLITE_INFERENCE_H
-
-#include <string>
-#include <vector>
-#include <memory>
-#include <chrono>
-#include "tensorflow/lite/interpreter.h"
-#include "tensorflow/lite/kernels/register.h"
-#include "tensorflow/lite/model.h"
+#include "vision/tflite_inference.h"
+#include "utils/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 namespace sentinel {
 
-struct InferenceResult {
-    bool success;
-    std::vector<float> output;
-    float inference_time_ms;
-};
-
-struct ModelInfo {
-    bool is_loaded;
-    int input_height;
-    int input_width;
-    int input_channels;
-    int output_size;
-};
-
-class TFLiteInference {
-public:
-    TFLiteInference();
-    ~TFLiteInference();
+TFLiteInference::TFLiteInference()
+    : interpreter_(nullptr),
+      model_(nullptr),
+      is_initialized_(false),
+      input_tensor_idx_(-1),
+      output_tensor_idx_(-1),
+      input_batch_(1),
+      input_height_(0),
+      input_width_(0),
+      input_channels_(0),
+      output_height_(0),
+      output_width_(0),
+      output_channels_(0) {
+}
+
+TFLiteInference::~TFLiteInference() {
+    shutdown();
+}
+
+bool TFLiteInference::loadModel(const std::string& model_path) {
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
+    if (!model) {
+        Logger::error("Failed to load model: " + model_path);
+        return false;
+    }
+    return loadModel(std::move(model), model_path);
+}
+
+bool TFLiteInference::loadModel(std::shared_ptr<tflite::FlatBufferModel> model,
+                                const std::string& model_path) {
+    // A profiler belongs to the interpreter it was attached to
+    interpreter_.reset();
+    profiler_.reset();
+    is_initialized_ = false;
+    model_path_ = model_path;
+    model_ = std::move(model);
     
-    // Load model from file
-    bool loadModel(const std::string& model_path);
+    tflite::ops::builtin::BuiltinOpResolver resolver;
+    tflite::InterpreterBuilder(*model_, resolver)(&interpreter_);
+    if (!interpreter_) {
+        Logger::error("Failed to build TFLite interpreter");
+        return false;
+    }
     
-    // Run inference with raw float data
-    InferenceResult runInference(const float* input_data, size_t data_size);
-    InferenceResult runInference(const std::vector<float>& input_data);
+    if (interpreter_->AllocateTensors() != kTfLiteOk) {
+        Logger::error("Failed to allocate tensors");
+        return false;
+    }
     
-    // Get model dimensions
-    void getInputDimensions(int& height, int& width, int& channels) const;
-    void getOutputDimensions(int& size) const;
+    input_tensor_idx_ = interpreter_->inputs()[0];
+    output_tensor_idx_ = interpreter_->outputs()[0];
     
-    // Configuration
-    bool setNumThreads(int num_threads);
+    // Expect NHWC input
+    const TfLiteIntArray* dims = interpreter_->tensor(input_tensor_idx_)->dims;
+    if (dims->size != 4) {
+        Logger::error("Unexpected input tensor rank: " + std::to_string(dims->size));
+        return false;
+    }
+    input_batch_ = dims->data[0];
+    input_height_ = dims->data[1];
+    input_width_ = dims->data[2];
+    input_channels_ = dims->data[3];
     
-    // Model information
-    ModelInfo getModelInfo() const;
+    // [1, H, W, C] or [1, H, W] is a mask; anything else a vector of scores
+    const TfLiteIntArray* out_dims = interpreter_->tensor(output_tensor_idx_)->dims;
+    output_height_ = 1;
+    output_width_ = 1;
+    output_channels_ = static_cast<int>(interpreter_->tensor(output_tensor_idx_)->bytes /
+                                        sizeof(float));
+    if (out_dims->size == 4 || out_dims->size == 3) {
+        output_height_ = out_dims->data[1];
+        output_width_ = out_dims->data[2];
+        output_channels_ = out_dims->size == 4 ? out_dims->data[3] : 1;
+    }
     
-    // Check if model is loaded and ready
-    bool isInitialized() const;
+    is_initialized_ = true;
+    return true;
+}
+
+InferenceResult TFLiteInference::runInference(const float* input_data, size_t data_size) {
+    InferenceResult result;
+    runInference(input_data, data_size, result);
+    return result;
+}
+
+InferenceResult TFLiteInference::runInference(const std::vector<float>& input_data) {
+    return runInference(input_data.data(), input_data.size());
+}
+
+bool TFLiteInference::runInference(const float* input_data, size_t data_size,
+                                   InferenceResult& result) {
+    result.success = false;
+    result.inference_time_ms = 0.0f;
+    result.output.clear();
     
-    // Cleanup
-    void shutdown();
+    if (!is_initialized_) {
+        Logger::error("Inference engine not initialized");
+        return false;
+    }
     
-    // Utility functions
-    static std::vector<float> preprocessImage(const uint8_t* image_data,
-                                             int height, int width, int channels,
-                                             bool normalize = true);
+    size_t expected = static_cast<size_t>(input_height_) * input_width_ * input_channels_;
+    if (data_size != expected) {
+        Logger::logf(LogLevel::ERROR, "Input size mismatch: %zu != %zu", data_size, expected);
+        return false;
+    }
     
-    static std::vector<float> applySoftmax(const std::vector<float>& logits);
-    static int getMaxProbabilityIndex(const std::vector<float>& probabilities);
+    std::memcpy(interpreter_->typed_tensor<float>(input_tensor_idx_), input_data,
+                data_size * sizeof(float));
     
-private:
-    std::unique_ptr<tflite::Interpreter> interpreter_;
-    std::unique_ptr<tflite::FlatBufferModel> model_;
+    bool profiling = profiler_ && profiler_->active();
+    if (profiling) {
+        profiler_->beginInvoke();
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (interpreter_->Invoke() != kTfLiteOk) {
+        Logger::error("Inference failed");
+        return false;
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (profiling) {
+        profiler_->endInvoke(*interpreter_,
+                             std::chrono::duration<double, std::micro>(end - start).count());
+    }
     
-    bool is_initialized_;
+    const TfLiteTensor* output = interpreter_->tensor(output_tensor_idx_);
+    size_t output_size = output->bytes / sizeof(float);
+    const float* output_data = interpreter_->typed_tensor<float>(output_tensor_idx_);
+    result.output.assign(output_data, output_data + output_size);
     
-    int input_tensor_idx_;
-    int output_tensor_idx_;
+    result.inference_time_ms = std::chrono::duration<float, std::milli>(end - start).count();
+    result.success = true;
+    return true;
+}
+
+void TFLiteInference::getInputDimensions(int& height, int& width, int& channels) const {
+    height = input_height_;
+    width = input_width_;
+    channels = input_channels_;
+}
+
+void TFLiteInference::getOutputDimensions(int& size) const {
+    size = is_initialized_ ?
+           static_cast<int>(interpreter_->tensor(output_tensor_idx_)->bytes / sizeof(float)) : 0;
+}
+
+void TFLiteInference::getOutputShape(int& height, int& width, int& channels) const {
+    height = output_height_;
+    width = output_width_;
+    channels = output_channels_;
+}
+
+bool TFLiteInference::setNumThreads(int num_threads) {
+    if (!interpreter_) {
+        return false;
+    }
+    return interpreter_->SetNumThreads(num_threads) == kTfLiteOk;
+}
+
+bool TFLiteInference::startProfiling(int invokes) {
+    if (!is_initialized_ || invokes <= 0) {
+        return false;
+    }
+    if (!profiler_) {
+        profiler_ = std::make_unique<OpProfiler>(model_path_);
+    }
+    profiler_->start(*interpreter_, invokes);
+    Logger::logf(LogLevel::INFO, "Profiling %d invokes of %s", invokes, model_path_.c_str());
+    return true;
+}
+
+bool TFLiteInference::takeProfile(OpProfileReport& report) {
+    if (!profiler_ || !profiler_->takeComplete()) {
+        return false;
+    }
+    report = profiler_->report();
+    return true;
+}
+
+ModelInfo TFLiteInference::getModelInfo() const {
+    ModelInfo info;
+    info.is_loaded = is_initialized_;
+    info.input_height = input_height_;
+    info.input_width = input_width_;
+    info.input_channels = input_channels_;
+    getOutputDimensions(info.output_size);
+    return info;
+}
+
+bool TFLiteInference::isInitialized() const {
+    return is_initialized_;
+}
+
+void TFLiteInference::shutdown() {
+    // The interpreter may still point at the profiler
+    interpreter_.reset();
+    profiler_.reset();
+    model_.reset();
+    is_initialized_ = false;
+}
+
+std::vector<float> TFLiteInference::preprocessImage(const uint8_t* image_data,
+                                                    int height, int width, int channels,
+                                                    bool normalize) {
+    std::vector<float> data(static_cast<size_t>(height) * width * channels);
+    float scale = normalize ? 1.0f / 255.0f : 1.0f;
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = image_data[i] * scale;
+    }
+    return data;
+}
+
+std::vector<float> TFLiteInference::applySoftmax(const std::vector<float>& logits) {
+    std::vector<float> probabilities(logits.size());
+    if (logits.empty()) {
+        return probabilities;
+    }
     
-    int input_batch_;
-    int input_height_;
-    int input_width_;
-    int input_channels_;
-};
+    float max_logit = *std::max_element(logits.begin(), logits.end());
+    float sum = 0.0f;
+    for (size_t i = 0; i < logits.size(); i++) {
+        probabilities[i] = std::exp(logits[i] - max_logit);
+        sum += probabilities[i];
+    }
+    for (float& p : probabilities) {
+        p /= sum;
+    }
+    return probabilities;
+}
 
-} // namespace sentinel
+int TFLiteInference::getMaxProbabilityIndex(const std::vector<float>& probabilities) {
+    if (probabilities.empty()) {
+        return -1;
+    }
+    return static_cast<int>(std::max_element(probabilities.begin(), probabilities.end()) -
+                            probabilities.begin());
+}
 
-#endif // TFLITE_INFERENCE_H
\ No newline at end of file
+} // namespace sentinel
\ No newline at end of file
@@ -0,0 +1,324 @@
+// Steady-state allocation check
+//
+// Runs the full detection loop (SentinelCore::runCycle) and counts heap
+// allocations made by the loop thread. After the warm-up cycles every
+// cycle must allocate nothing; offending cycles are listed and the exit
+// status is 1.
+//
+// Without --model and --video (as run by ctest) vision results come from a
+// stub and the MQ-2 replays a synthetic ADC trace, each with one smoke
+// episode, so detection, consensus and an alert all run after the warm-up.
+// With them, recorded footage and the real model replace the stub.
+//
+// Allocations from C code (malloc from OpenCV's video decoder, libc) are
+// counted separately and only reported unless --strict is given. The stub
+// run has no decoder and is always strict.
+//
+// Usage: alloc_check_test [--config node_config.json] [--model model.tflite
+//            --video smoke.mp4] [--trace adc.txt] [--warmup N] [--cycles N]
+//            [--strict] [--debug]
+
+#include "core/config_manager.h"
+#include "core/sentinel_core.h"
+#include "utils/logger.h"
+#include "vision/smoke_detector.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+// Only the loop thread is counted, and only once armed
+thread_local bool g_counting = false;
+std::atomic<uint64_t> g_cpp_allocations(0);
+std::atomic<uint64_t> g_c_allocations(0);
+
+void* countedNew(size_t size, size_t alignment) {
+    if (g_counting) {
+        g_cpp_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = alignment > alignof(std::max_align_t) ?
+              __libc_memalign(alignment, size) : __libc_malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void countC() {
+    if (g_counting) {
+        g_c_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+// C++ allocations: global operator new and every variant that can be
+// reached without it
+void* operator new(size_t size) { return countedNew(size, 0); }
+void* operator new[](size_t size) { return countedNew(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return countedNew(size, 0); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return countedNew(size, 0); } catch (...) { return nullptr; }
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedNew(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedNew(size, static_cast<size_t>(alignment));
+}
+void operator delete(void* p) noexcept { __libc_free(p); }
+void operator delete[](void* p) noexcept { __libc_free(p); }
+void operator delete(void* p, size_t) noexcept { __libc_free(p); }
+void operator delete[](void* p, size_t) noexcept { __libc_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { __libc_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { __libc_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { __libc_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { __libc_free(p); }
+
+// C allocations
+extern "C" {
+void* malloc(size_t size) { countC(); return __libc_malloc(size); }
+void* calloc(size_t count, size_t size) { countC(); return __libc_calloc(count, size); }
+void* realloc(void* ptr, size_t size) { countC(); return __libc_realloc(ptr, size); }
+void free(void* ptr) { __libc_free(ptr); }
+void* memalign(size_t alignment, size_t size) { countC(); return __libc_memalign(alignment, size); }
+void* aligned_alloc(size_t alignment, size_t size) { countC(); return __libc_memalign(alignment, size); }
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    countC();
+    void* p = __libc_memalign(alignment, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+}
+
+namespace {
+
+struct CycleAllocations {
+    int cycle;
+    uint64_t cpp;
+    uint64_t c;
+};
+
+// Stub inputs: sensor and vision checks every STUB_INTERVAL_MS. The ADC
+// trace and the vision stub see smoke from their SMOKE_BEGIN-th to their
+// SMOKE_END-th sample.
+constexpr int STUB_INTERVAL_MS = 50;
+constexpr int SMOKE_BEGIN = 200;
+constexpr int SMOKE_END = 320;
+
+// Smooth ADC readings around the clean-air level with one smoke episode,
+// so the alert path runs as well
+bool writeSyntheticTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    for (int i = 0; i < 600; i++) {
+        double base = 400.0 + 20.0 * std::sin(i * 0.1);
+        double smoke = (i >= SMOKE_BEGIN && i < SMOKE_END) ? 1800.0 : 0.0;
+        file << static_cast<int>(base + smoke) << "\n";
+    }
+    return true;
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "Usage: %s [--config FILE] [--model FILE --video FILE] [--trace FILE]\n"
+                 "          [--warmup N] [--cycles N] [--strict] [--debug]\n", argv0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    using namespace sentinel;
+
+    std::string config_path = SENTINEL_SOURCE_DIR "/configs/node_config.json";
+    std::string model_path;
+    std::string video_path;
+    std::string trace_path;
+    int warmup = 500;
+    int cycles = 3000;
+    bool strict = false;
+    bool debug = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            model_path = argv[++i];
+        } else if (arg == "--video" && i + 1 < argc) {
+            video_path = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = std::atoi(argv[++i]);
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            cycles = std::atoi(argv[++i]);
+        } else if (arg == "--strict") {
+            strict = true;
+        } else if (arg == "--debug") {
+            debug = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (model_path.empty() != video_path.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    bool stub = model_path.empty();
+    strict = strict || stub;
+
+    ConfigManager manager;
+    if (!manager.loadFromFile(config_path)) {
+        std::fprintf(stderr, "Failed to load %s: %s\n", config_path.c_str(),
+                     manager.getLastError().c_str());
+        return 2;
+    }
+
+    char scratch_dir[] = "/tmp/sentinel-alloc-XXXXXX";
+    if (!mkdtemp(scratch_dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    if (trace_path.empty()) {
+        trace_path = std::string(scratch_dir) + "/adc_trace.txt";
+        if (!writeSyntheticTrace(trace_path)) {
+            std::fprintf(stderr, "Failed to write %s\n", trace_path.c_str());
+            return 2;
+        }
+    }
+
+    // Recorded inputs instead of hardware; nothing persisted outside the
+    // scratch directory
+    Config config = manager.getConfig();
+    config.sensor_config.trace_file = trace_path;
+    config.sensor_config.calibration_time_sec = 0;
+    config.data_directory = scratch_dir;
+    config.warm_restart = false;
+    config.memory_config.report_interval_sec = 5;
+    config.debug_mode = debug;
+    Logger::setLevel(debug ? LogLevel::DEBUG : LogLevel::WARN);
+
+    if (stub) {
+        // The episode within the run; with no peers the node alerts alone.
+        // The consensus window runs on the simulated clock; the join
+        // handshake waits in real time, which that clock outruns, so it is
+        // skipped.
+        config.sensor_config.sampling_interval_ms = STUB_INTERVAL_MS;
+        config.vision_config.fps = 1000 / STUB_INTERVAL_MS;
+        config.lora_config.join_slots = 0;
+    } else {
+        config.model_path = model_path;
+        config.vision_config.video_source = video_path;
+    }
+
+    SentinelCore core(config);
+    int stub_frames = 0;
+    if (stub) {
+        core.setVisionSource([&stub_frames](DetectionResult& result) {
+            bool smoke = stub_frames >= SMOKE_BEGIN && stub_frames < SMOKE_END;
+            stub_frames++;
+            result.confidence = smoke ? 0.95f : 0.05f;
+            result.smoothed_confidence = result.confidence;
+            result.detected = smoke;
+            result.inference_time_ms = 40.0f;
+            result.timestamp = std::chrono::system_clock::now();
+        });
+    }
+    if (!core.initialize()) {
+        std::fprintf(stderr, "Failed to initialize Sentinel Core\n");
+        return 2;
+    }
+
+    // Simulated clock at the production loop period, so every subsystem
+    // comes due at its configured rate without real-time sleeps
+    auto now = std::chrono::steady_clock::now();
+    const auto period = std::chrono::milliseconds(10);
+
+    std::vector<CycleAllocations> failures;
+    failures.reserve(64);
+    uint64_t total_c = 0;
+
+    for (int cycle = 0; cycle < warmup + cycles; cycle++) {
+        bool measured = cycle >= warmup;
+        uint64_t cpp_before = g_cpp_allocations.load(std::memory_order_relaxed);
+        uint64_t c_before = g_c_allocations.load(std::memory_order_relaxed);
+
+        g_counting = measured;
+        core.runCycle(now);
+        g_counting = false;
+
+        now += period;
+        if (!measured) {
+            continue;
+        }
+
+        uint64_t cpp = g_cpp_allocations.load(std::memory_order_relaxed) - cpp_before;
+        uint64_t c = g_c_allocations.load(std::memory_order_relaxed) - c_before;
+        total_c += c;
+        if (cpp > 0 || (strict && c > 0)) {
+            if (failures.size() < failures.capacity()) {
+                failures.push_back({cycle - warmup, cpp, c});
+            }
+        }
+    }
+
+    core.shutdown();
+
+    std::printf("Cycles:          %d (after %d warm-up)\n", cycles, warmup);
+    std::printf("Alerts:          %llu\n",
+                static_cast<unsigned long long>(core.getStats().alerts));
+    std::printf("C++ allocations: %llu\n",
+                static_cast<unsigned long long>(g_cpp_allocations.load()));
+    std::printf("C allocations:   %llu%s\n", static_cast<unsigned long long>(total_c),
+                strict ? "" : " (informational; video decoding)");
+
+    if (!failures.empty()) {
+        std::printf("FAIL: %zu%s cycles allocated\n", failures.size(),
+                    failures.size() == failures.capacity() ? "+" : "");
+        for (const CycleAllocations& entry : failures) {
+            std::printf("  cycle %d: %llu C++, %llu C\n", entry.cycle,
+                        static_cast<unsigned long long>(entry.cpp),
+                        static_cast<unsigned long long>(entry.c));
+        }
+        return 1;
+    }
+
+    if (stub && core.getStats().alerts == 0) {
+        std::printf("FAIL: the stub smoke episode raised no alert\n");
+        return 1;
+    }
+
+    std::printf("OK: steady-state loop does not allocate\n");
+    return 0;
+}
\ No newline at end of file
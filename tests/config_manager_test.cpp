@@ -0,0 +1,170 @@
+// ConfigManager's JSON binding: values bound by path, and every way a
+// document can be rejected (wrong type, out of range, bad field syntax,
+// malformed JSON), each with a located message and the previous
+// configuration left as it was
+
+#include "core/config_manager.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace sentinel;
+
+namespace {
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+// Rejected, with part in the message, and nothing changed
+bool rejects(ConfigManager& manager, const std::string& document, const std::string& part) {
+    int before = manager.getConfig().lora_config.spreading_factor;
+    if (manager.loadFromString(document, "test.json")) {
+        std::fprintf(stderr, "Accepted: %s\n", document.c_str());
+        return false;
+    }
+    const std::string& error = manager.getLastError();
+    if (!contains(error, part) || error.compare(0, 10, "test.json:") != 0) {
+        std::fprintf(stderr, "Unexpected error \"%s\" for %s\n", error.c_str(), document.c_str());
+        return false;
+    }
+    return manager.getConfig().lora_config.spreading_factor == before;
+}
+
+void testBinding() {
+    ConfigManager manager;
+    CHECK(!manager.isLoaded());
+    CHECK(manager.loadFromString(R"({
+        "node": {"id": 7, "name": "ridge", "location": {"latitude": -33.5}},
+        "sensor": {"i2c_address": "0x4a"},
+        "lora": {"spreading_factor": 9},
+        "alert": {"notification_methods": ["lora"]},
+        "system": {"log_level": "DEBUG"},
+        "future_section": {"anything": [1, 2, {"x": null}]}
+    })"));
+    CHECK(manager.isLoaded());
+    CHECK(manager.getLastError().empty());
+
+    Config config = manager.getConfig();
+    CHECK(config.node_id == 7);
+    CHECK(config.node_name == "ridge");
+    CHECK_NEAR(config.latitude, -33.5, 1e-9);
+    CHECK(config.i2c_address == 0x4a);
+    CHECK(config.lora_config.spreading_factor == 9);
+    CHECK(config.notification_methods.size() == 1 && config.notification_methods[0] == "lora");
+    CHECK(config.debug_mode && config.lora_config.debug_mode);
+
+    // Byte fields also take plain numbers
+    CHECK(manager.loadFromString(R"({"sensor": {"i2c_address": 72}})"));
+    CHECK(manager.getConfig().i2c_address == 72);
+}
+
+void testErrors() {
+    ConfigManager manager;
+    CHECK(manager.loadFromString(R"({"lora": {"spreading_factor": 9}})"));
+
+    // Located: line and column of the value, then its path
+    CHECK(!manager.loadFromString("{\n  \"lora\": {\n    \"spreading_factor\": 13\n  }\n}",
+                                  "node_config.json"));
+    CHECK(manager.getLastError() ==
+          "node_config.json:3:25: lora.spreading_factor: value 13 out of range [7, 12]");
+    CHECK(manager.getConfig().lora_config.spreading_factor == 9);
+    CHECK(manager.isLoaded());
+
+    // Ranges
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 6}})", "out of range [7, 12]"));
+    CHECK(rejects(manager, R"({"node": {"id": 255}})", "node.id: value 255 out of range [1, 254]"));
+    CHECK(rejects(manager, R"({"node": {"location": {"latitude": 91}}})",
+                  "node.location.latitude: value 91 out of range"));
+    CHECK(rejects(manager, R"({"sensor": {"i2c_address": 256}})", "out of range [0x00, 0xFF]"));
+
+    // Types
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": "9"}})", "expected integer, got string"));
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 9.5}})",
+                  "expected integer, got non-integer number"));
+    CHECK(rejects(manager, R"({"node": {"name": 5}})", "node.name: expected string, got number"));
+    CHECK(rejects(manager, R"({"node": {"location": {"latitude": true}}})", "expected number, got"));
+    CHECK(rejects(manager, R"({"alert": {"notification_methods": ["lora", 3]}})",
+                  "alert.notification_methods[1]: expected string"));
+
+    // Field syntax
+    CHECK(rejects(manager, R"({"sensor": {"i2c_address": "0x4g"}})", "invalid byte value \"0x4g\""));
+    CHECK(rejects(manager, R"({"system": {"log_level": "LOUD"}})", "unknown log level \"LOUD\""));
+    CHECK(rejects(manager, R"({"realtime": {"core_cpus": "2-"}})", "invalid CPU list"));
+    CHECK(rejects(manager, R"({"mesh": {"update_key": "00ff"}})", "invalid key"));
+
+    // The first error wins, even after values that bound
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 10, "bandwidth_khz": "wide"}})",
+                  "lora.bandwidth_khz"));
+    CHECK(manager.getConfig().lora_config.spreading_factor == 9);
+
+    // A later good document clears the error
+    CHECK(manager.loadFromString(R"({"lora": {"spreading_factor": 8}})"));
+    CHECK(manager.getLastError().empty());
+    CHECK(manager.getConfig().lora_config.spreading_factor == 8);
+}
+
+void testMalformed() {
+    ConfigManager manager;
+    CHECK(manager.loadFromString(R"({"lora": {"spreading_factor": 9}})"));
+    CHECK(rejects(manager, R"({"lora" {"spreading_factor": 10}})",
+                  "1:9: expected ':' after key \"lora\""));
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 10})", "unterminated object"));
+    CHECK(rejects(manager, R"({"node": {"name": "unterminated}})", "unterminated string"));
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 10}} trailing)",
+                  "unexpected trailing content"));
+    CHECK(rejects(manager, R"({"lora": {"spreading_factor": 10,}})", "expected object key"));
+    CHECK(rejects(manager, "", "unexpected end of input"));
+
+    // Located like binding errors: "test.json:<line>:<column>: ..."
+    CHECK(!manager.loadFromString("{\n\"lora\" 9}", "test.json"));
+    CHECK(manager.getLastError().compare(0, 12, "test.json:2:") == 0);
+}
+
+void testFiles() {
+    char dir[] = "/tmp/sentinel-config-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        std::exit(2);
+    }
+    std::string path = std::string(dir) + "/node.json";
+
+    ConfigManager manager;
+    CHECK(!manager.loadFromFile(path));
+    CHECK(manager.getLastError() == path + ": cannot open file");
+
+    // What saveToFile writes loads back the same
+    Config config = manager.getConfig();
+    config.node_id = 42;
+    config.node_name = "quote \" and \\ backslash";
+    config.lora_config.spreading_factor = 11;
+    config.notification_methods = {"lora", "led"};
+    manager.setConfig(config);
+    CHECK(manager.saveToFile(path));
+
+    ConfigManager loaded;
+    CHECK(loaded.loadFromFile(path));
+    Config back = loaded.getConfig();
+    CHECK(back.node_id == 42);
+    CHECK(back.node_name == config.node_name);
+    CHECK(back.lora_config.spreading_factor == 11);
+    CHECK(back.notification_methods == config.notification_methods);
+
+    std::remove(path.c_str());
+    rmdir(dir);
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::ERROR);
+
+    testBinding();
+    testErrors();
+    testMalformed();
+    testFiles();
+    return sentinel_test::testResult();
+}
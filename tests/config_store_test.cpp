@@ -0,0 +1,201 @@
+// ConfigStore publishing and RCU retirement (a snapshot is freed only once
+// no reader holds it), and ConfigWatcher publishing a reload when the file
+// is rewritten or replaced, ignoring invalid files and other files
+
+#include "core/config_store.h"
+#include "core/config_watcher.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Set when the watched address is deleted
+std::atomic<const void*> g_watched(nullptr);
+std::atomic<bool> g_freed(false);
+
+void* allocate(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void release(void* p) {
+    if (p && p == g_watched.load()) {
+        g_freed = true;
+    }
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+
+using namespace sentinel;
+
+namespace {
+
+// The snapshot holding config (its first member)
+void watch(const Config& config) {
+    g_freed = false;
+    g_watched = &config;
+}
+
+void testPublish() {
+    Config initial;
+    initial.node_id = 1;
+    ConfigStore store(initial);
+    CHECK(store.version() == 1);
+
+    ConfigReader reader(store);
+    CHECK(!reader.stale());
+    CHECK(reader.version() == 1);
+
+    // The held reference does not change under the reader
+    const Config& held = reader.acquire();
+    Config next = initial;
+    next.node_id = 2;
+    store.publish(next);
+    CHECK(store.version() == 2);
+    CHECK(reader.stale());
+    CHECK(held.node_id == 1);
+
+    CHECK(reader.acquire().node_id == 2);
+    CHECK(reader.version() == 2);
+    CHECK(!reader.stale());
+}
+
+void testRetire() {
+    Config config;
+    ConfigStore store(config);
+    ConfigReader first(store);
+    watch(first.acquire());
+
+    // Retired but held by the first reader
+    config.node_id = 2;
+    store.publish(config);
+    store.reclaim();
+    CHECK(!g_freed);
+
+    // A newer reader does not release it either
+    {
+        ConfigReader second(store);
+        CHECK(second.version() == 2);
+        store.reclaim();
+        CHECK(!g_freed);
+    }
+
+    // Freed once the last reader has moved on, but never the current one
+    const Config& current = first.acquire();
+    store.reclaim();
+    CHECK(g_freed);
+    watch(current);
+    store.reclaim();
+    CHECK(!g_freed);
+
+    // A reader that goes away releases what it held
+    auto* third = new ConfigReader(store);
+    watch(third->acquire());
+    config.node_id = 3;
+    store.publish(config);
+    first.acquire();
+    store.reclaim();
+    CHECK(!g_freed);
+    delete third;
+    store.reclaim();
+    CHECK(g_freed);
+    g_watched = nullptr;
+}
+
+bool writeFile(const std::string& path, const std::string& text) {
+    std::ofstream file(path, std::ios::trunc);
+    file << text;
+    return static_cast<bool>(file);
+}
+
+template <typename Condition>
+bool waitFor(Condition condition, std::chrono::milliseconds timeout) {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+void testWatcher() {
+    char dir[] = "/tmp/sentinel-watch-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        std::exit(2);
+    }
+    std::string path = std::string(dir) + "/node.json";
+    std::string other = std::string(dir) + "/other.json";
+    std::string staged = std::string(dir) + "/node.json.new";
+    CHECK(writeFile(path, R"({"lora": {"spreading_factor": 9}})"));
+
+    ConfigStore store(Config{});
+    ConfigReader reader(store);
+    ConfigWatcher watcher(path, store);
+    CHECK(watcher.start());
+
+    const auto timeout = std::chrono::milliseconds(3000);
+    const auto settle = std::chrono::milliseconds(600);
+
+    // Rewritten in place
+    CHECK(writeFile(path, R"({"lora": {"spreading_factor": 10}})"));
+    CHECK(waitFor([&]() { return store.version() == 2; }, timeout));
+    CHECK(reader.stale());
+    CHECK(reader.acquire().lora_config.spreading_factor == 10);
+
+    // Invalid, then another file in the directory: neither is published
+    CHECK(writeFile(path, R"({"lora": {"spreading_factor": 13}})"));
+    CHECK(writeFile(other, R"({"lora": {"spreading_factor": 8}})"));
+    std::this_thread::sleep_for(settle);
+    CHECK(store.version() == 2);
+
+    // Replaced by rename, as deploy scripts do
+    CHECK(writeFile(staged, R"({"lora": {"spreading_factor": 11}})"));
+    CHECK(std::rename(staged.c_str(), path.c_str()) == 0);
+    CHECK(waitFor([&]() { return store.version() == 3; }, timeout));
+    CHECK(reader.acquire().lora_config.spreading_factor == 11);
+
+    // Stopped: changes are no longer picked up
+    watcher.stop();
+    CHECK(writeFile(path, R"({"lora": {"spreading_factor": 12}})"));
+    std::this_thread::sleep_for(settle);
+    CHECK(store.version() == 3);
+
+    std::remove(path.c_str());
+    std::remove(other.c_str());
+    rmdir(dir);
+}
+
+} // namespace
+
+int main() {
+    // Reloads are logged at INFO, the invalid file at ERROR
+    Logger::setLevel(LogLevel::WARN);
+
+    testPublish();
+    testRetire();
+    testWatcher();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,128 @@
+// FastCDC chunking: chunks tile the input within the size limits, cut on
+// content alone, and an edit changes only the chunks around it
+
+#include "utils/content_chunker.h"
+#include "utils/checksum.h"
+#include "test_check.h"
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+std::vector<uint8_t> randomBytes(size_t len, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(len);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+// Contiguous from 0 to the end, each chunk's CRC over its bytes, sizes
+// within [min_size, max_size] except a short last chunk
+bool tiles(const std::vector<uint8_t>& data, const std::vector<ContentChunk>& chunks,
+           const ChunkerParams& params) {
+    size_t offset = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const ContentChunk& chunk = chunks[i];
+        bool last = i + 1 == chunks.size();
+        if (chunk.offset != offset || chunk.length > params.max_size ||
+            (!last && chunk.length < params.min_size) ||
+            chunk.hash != crc32(data.data() + offset, chunk.length)) {
+            return false;
+        }
+        offset += chunk.length;
+    }
+    return offset == data.size();
+}
+
+std::multiset<std::pair<uint32_t, uint32_t>> chunkSet(const std::vector<ContentChunk>& chunks) {
+    std::multiset<std::pair<uint32_t, uint32_t>> set;
+    for (const ContentChunk& chunk : chunks) {
+        set.insert({chunk.hash, chunk.length});
+    }
+    return set;
+}
+
+void testLimits() {
+    ChunkerParams params;
+    CHECK(chunkContent(nullptr, 0).empty());
+
+    // Shorter than min_size: one chunk
+    std::vector<uint8_t> small = randomBytes(100, 1);
+    std::vector<ContentChunk> chunks = chunkContent(small.data(), small.size());
+    CHECK(chunks.size() == 1 && chunks[0].length == 100);
+
+    // Random data: cuts near avg_size, never outside the limits
+    std::vector<uint8_t> data = randomBytes(1 << 20, 2);
+    chunks = chunkContent(data.data(), data.size());
+    CHECK(tiles(data, chunks, params));
+    double average = static_cast<double>(data.size()) / chunks.size();
+    CHECK(average > params.avg_size / 2 && average < params.avg_size * 2);
+
+    // No cut points at all: max_size chunks
+    std::vector<uint8_t> zeros(100000, 0);
+    chunks = chunkContent(zeros.data(), zeros.size());
+    CHECK(tiles(zeros, chunks, params));
+    CHECK(chunks.size() == (zeros.size() + params.max_size - 1) / params.max_size);
+
+    // Other parameters
+    ChunkerParams fine;
+    fine.min_size = 64;
+    fine.avg_size = 256;
+    fine.max_size = 1024;
+    chunks = chunkContent(data.data(), data.size(), fine);
+    CHECK(tiles(data, chunks, fine));
+    average = static_cast<double>(data.size()) / chunks.size();
+    CHECK(average > fine.avg_size / 2 && average < fine.avg_size * 2);
+}
+
+void testBoundaries() {
+    std::vector<uint8_t> data = randomBytes(1 << 18, 3);
+    std::vector<ContentChunk> before = chunkContent(data.data(), data.size());
+
+    // Same content, same cuts
+    std::vector<ContentChunk> again = chunkContent(data.data(), data.size());
+    CHECK(chunkSet(again) == chunkSet(before));
+
+    // Seven bytes inserted: the chunks before the edit are untouched and
+    // the cuts after it fall on the same content, so only the chunks
+    // around the insertion differ
+    std::vector<uint8_t> edited = data;
+    edited.insert(edited.begin() + 100000, 7, 0x55);
+    std::vector<ContentChunk> after = chunkContent(edited.data(), edited.size());
+    CHECK(tiles(edited, after, ChunkerParams()));
+    std::multiset<std::pair<uint32_t, uint32_t>> old_chunks = chunkSet(before);
+    size_t changed = 0;
+    size_t shared_bytes = 0;
+    for (const ContentChunk& chunk : after) {
+        if (old_chunks.count({chunk.hash, chunk.length})) {
+            shared_bytes += chunk.length;
+        } else {
+            changed++;
+            CHECK(chunk.offset + chunk.length >= 100000 &&
+                  chunk.offset <= 100000 + 7 + ChunkerParams().max_size);
+        }
+    }
+    CHECK(changed >= 1 && changed <= 3);
+    CHECK(shared_bytes + 3 * ChunkerParams().max_size >= edited.size());
+
+    // A chunk's cut does not depend on where the chunk starts
+    std::vector<uint8_t> tail(data.begin() + before[10].offset, data.end());
+    std::vector<ContentChunk> shifted = chunkContent(tail.data(), tail.size());
+    CHECK(shifted.size() == before.size() - 10);
+    CHECK(shifted.size() > 0 && shifted[0].hash == before[10].hash &&
+          shifted.back().hash == before.back().hash);
+}
+
+} // namespace
+
+int main() {
+    testLimits();
+    testBoundaries();
+    return sentinel_test::testResult();
+}
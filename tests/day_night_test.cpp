@@ -0,0 +1,115 @@
+// DayNightSwitch: a mode changes only after the level has stayed past the
+// far threshold for the hold time; the band between the thresholds, or a
+// level back on the current side, starts the hold over
+
+#include "vision/day_night.h"
+#include "test_check.h"
+#include <chrono>
+#include <cstring>
+
+using namespace sentinel;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float NIGHT_BELOW = 40.0f;
+constexpr float DAY_ABOVE = 60.0f;
+constexpr auto HOLD = std::chrono::seconds(2);
+
+struct Feed {
+    DayNightSwitch day_night;
+    Clock::time_point now;
+
+    // One reading a second
+    bool step(float level) {
+        bool changed = day_night.update(level, NIGHT_BELOW, DAY_ABOVE, HOLD, now);
+        now += std::chrono::seconds(1);
+        return changed;
+    }
+};
+
+void testHysteresis() {
+    Feed feed;
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+
+    // In the band: day stays day
+    CHECK(!feed.step(100.0f));
+    CHECK(!feed.step(50.0f));
+    CHECK(!feed.step(41.0f));
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+
+    // Dark, but back in the band before the hold ran out
+    CHECK(!feed.step(35.0f));
+    CHECK(!feed.step(35.0f));
+    CHECK(!feed.step(45.0f));
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+
+    // Dark for the hold time: night on the third reading (0, 1, 2 s)
+    CHECK(!feed.step(35.0f));
+    CHECK(!feed.step(35.0f));
+    CHECK(feed.step(35.0f));
+    CHECK(feed.day_night.mode() == VisionMode::NIGHT);
+    CHECK(!feed.step(35.0f));
+
+    // Brighter than night_below is not day yet: day_above is the far side
+    CHECK(!feed.step(55.0f));
+    CHECK(!feed.step(59.0f));
+    CHECK(!feed.step(59.0f));
+    CHECK(!feed.step(59.0f));
+    CHECK(feed.day_night.mode() == VisionMode::NIGHT);
+
+    // A brief flash (headlights) does not end the night
+    CHECK(!feed.step(200.0f));
+    CHECK(!feed.step(30.0f));
+    CHECK(!feed.step(200.0f));
+    CHECK(!feed.step(50.0f));
+    CHECK(feed.day_night.mode() == VisionMode::NIGHT);
+
+    CHECK(!feed.step(65.0f));
+    CHECK(!feed.step(65.0f));
+    CHECK(feed.step(65.0f));
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+}
+
+void testReadingGaps() {
+    // The hold is time, not a number of readings: one reading past the
+    // threshold and one after the hold are enough
+    Feed feed;
+    CHECK(!feed.day_night.update(10.0f, NIGHT_BELOW, DAY_ABOVE, HOLD, feed.now));
+    feed.now += std::chrono::seconds(5);
+    CHECK(feed.day_night.update(10.0f, NIGHT_BELOW, DAY_ABOVE, HOLD, feed.now));
+
+    // No hold: the first reading past the threshold switches
+    CHECK(feed.day_night.update(90.0f, NIGHT_BELOW, DAY_ABOVE, Clock::duration::zero(),
+                                feed.now));
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+}
+
+void testReset() {
+    Feed feed;
+    feed.step(10.0f);
+    feed.step(10.0f);
+    feed.step(10.0f);
+    CHECK(feed.day_night.mode() == VisionMode::NIGHT);
+
+    // Back to day, and a pending change is forgotten
+    feed.step(90.0f);
+    feed.day_night.reset();
+    CHECK(feed.day_night.mode() == VisionMode::DAY);
+    CHECK(!feed.step(90.0f));
+    CHECK(!feed.step(10.0f));
+    CHECK(!feed.step(10.0f));
+    CHECK(feed.step(10.0f));
+
+    CHECK(std::strcmp(visionModeName(VisionMode::DAY), visionModeName(VisionMode::NIGHT)) != 0);
+}
+
+} // namespace
+
+int main() {
+    testHysteresis();
+    testReadingGaps();
+    testReset();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,122 @@
+// EvidenceFusion: SPRT bounds, per-sample ratios and decisions
+
+#include "core/evidence_fusion.h"
+#include "test_check.h"
+#include <cmath>
+
+using namespace sentinel;
+
+namespace {
+
+void testBounds() {
+    FusionConfig config;
+    config.false_alarm_rate = 0.001f;
+    config.miss_rate = 0.01f;
+    EvidenceFusion fusion(config);
+    CHECK_NEAR(fusion.upperBound(), std::log(0.99 / 0.001), 1e-4);
+    CHECK_NEAR(fusion.lowerBound(), std::log(0.01 / 0.999), 1e-4);
+
+    // New parameters move the bounds but keep the running test
+    fusion.addVision(0.9f);
+    float statistic = fusion.statistic();
+    config.false_alarm_rate = 0.01f;
+    fusion.setConfig(config);
+    CHECK_NEAR(fusion.upperBound(), std::log(0.99 / 0.01), 1e-4);
+    CHECK(fusion.statistic() == statistic);
+
+    // Rates are clamped so the bounds stay finite and on either side of 0
+    config.false_alarm_rate = 0.0f;
+    config.miss_rate = 0.9f;
+    fusion.setConfig(config);
+    CHECK(std::isfinite(fusion.upperBound()) && fusion.upperBound() > 0.0f);
+    CHECK(fusion.lowerBound() < 0.0f);
+}
+
+void testRatios() {
+    FusionConfig config;
+    config.clean_ppm = 50.0f;
+    config.smoke_ppm = 400.0f;
+    config.ppm_spread = 0.3f;
+    config.vision_scale = 0.25f;
+    config.vision_bias = 0.0f;
+    EvidenceFusion fusion(config);
+
+    // Linear in log10(PPM), zero halfway between the two levels
+    double gain = std::log10(400.0 / 50.0) / (0.3 * 0.3);
+    CHECK_NEAR(fusion.sensorRatio(std::sqrt(50.0f * 400.0f)), 0.0, 1e-4);
+    CHECK_NEAR(fusion.sensorRatio(400.0f), gain * 0.5 * std::log10(8.0), 1e-3);
+    CHECK_NEAR(fusion.sensorRatio(50.0f), -fusion.sensorRatio(400.0f), 1e-3);
+    CHECK(std::isfinite(fusion.sensorRatio(0.0f)));
+    CHECK(std::isfinite(fusion.sensorRatio(-1.0f)));
+
+    // Scaled logit of the confidence
+    CHECK_NEAR(fusion.visionRatio(0.5f), 0.0, 1e-6);
+    CHECK_NEAR(fusion.visionRatio(0.9f), 0.25 * std::log(9.0), 1e-5);
+    CHECK_NEAR(fusion.visionRatio(0.1f), -0.25 * std::log(9.0), 1e-5);
+    CHECK(std::isfinite(fusion.visionRatio(1.0f)));
+    CHECK(std::isfinite(fusion.visionRatio(0.0f)));
+
+    config.vision_bias = -0.5f;
+    fusion.setConfig(config);
+    CHECK_NEAR(fusion.visionRatio(0.5f), -0.5, 1e-6);
+}
+
+void testDecisions() {
+    FusionConfig config;
+    config.false_alarm_rate = 0.001f;    // Upper bound 6.9
+    config.miss_rate = 0.01f;            // Lower bound -4.6
+    config.max_step = 3.0f;
+    EvidenceFusion fusion(config);
+    CHECK(!fusion.detected());
+
+    // Each strong sample is clamped to max_step: three to decide smoke
+    CHECK(!fusion.addSensor(1e6f));
+    CHECK_NEAR(fusion.statistic(), 3.0, 1e-5);
+    CHECK(!fusion.addSensor(1e6f));
+    CHECK(fusion.addSensor(1e6f));
+    CHECK(fusion.detected());
+    CHECK(fusion.decisions() == 1);
+    CHECK(fusion.statistic() == 0.0f);
+
+    // Smoke again: a decision, but no change
+    CHECK(!fusion.addSensor(1e6f));
+    CHECK(!fusion.addSensor(1e6f));
+    CHECK(!fusion.addSensor(1e6f));
+    CHECK(fusion.detected());
+    CHECK(fusion.decisions() == 2);
+
+    // Clean air decides sooner against the nearer lower bound
+    CHECK(!fusion.addSensor(1.0f));
+    CHECK(fusion.addSensor(1.0f));
+    CHECK(!fusion.detected());
+    CHECK(fusion.decisions() == 3);
+
+    // Conflicting evidence keeps sampling
+    for (int i = 0; i < 100; i++) {
+        fusion.addSensor(1e6f);
+        fusion.addSensor(1.0f);
+    }
+    CHECK(fusion.decisions() == 3);
+    CHECK(!fusion.detected());
+
+    // Sensor and vision evidence add up
+    fusion.reset();
+    fusion.addSensor(400.0f);
+    float sensor_only = fusion.statistic();
+    fusion.addVision(0.9f);
+    CHECK_NEAR(fusion.statistic(), sensor_only + fusion.visionRatio(0.9f), 1e-5);
+
+    fusion.reset();
+    CHECK(fusion.statistic() == 0.0f);
+    CHECK(!fusion.detected());
+    CHECK(fusion.decisions() == 0);
+}
+
+} // namespace
+
+int main() {
+    testBounds();
+    testRatios();
+    testDecisions();
+    return sentinel_test::testResult();
+}
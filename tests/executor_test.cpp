@@ -0,0 +1,254 @@
+// Executor: priority order and newest-first on a worker's own deque,
+// oldest-first stealing by an idle worker, cancel() waiting for a timer
+// that is running, parallelFor finishing on the caller when every worker
+// is busy, and stop() dropping queued tasks while timers survive it
+
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+// Holds the tasks that wait() on it until open()
+class Gate {
+public:
+    void open() { open_ = true; }
+    void wait() const {
+        while (!open_) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+
+private:
+    std::atomic<bool> open_{false};
+};
+
+template <typename Condition>
+bool waitFor(Condition condition, milliseconds timeout = milliseconds(3000)) {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+// Tasks append their tag here
+class Order {
+public:
+    void add(int tag) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tags_.push_back(tag);
+    }
+    std::vector<int> tags() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tags_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<int> tags_;
+};
+
+void testPriorities() {
+    // One worker, kept busy while the tasks are queued on its deque
+    CHECK(Executor::start(1));
+    Gate gate;
+    std::atomic<bool> blocked(false);
+    Executor::post([&]() {
+        blocked = true;
+        gate.wait();
+    });
+    CHECK(waitFor([&]() { return blocked.load(); }));
+
+    Order order;
+    Executor::post([&]() { order.add(1); }, TaskPriority::LOW);
+    Executor::post([&]() { order.add(2); }, TaskPriority::NORMAL);
+    Executor::post([&]() { order.add(3); }, TaskPriority::LOW);
+    Executor::post([&]() { order.add(4); }, TaskPriority::HIGH);
+    Executor::post([&]() { order.add(5); }, TaskPriority::NORMAL);
+    gate.open();
+
+    // Higher priorities first, the newest first within one
+    CHECK(waitFor([&]() { return order.tags().size() == 5; }));
+    CHECK(order.tags() == std::vector<int>({4, 5, 2, 3, 1}));
+    Executor::stop();
+}
+
+void testStealing() {
+    CHECK(Executor::start(2));
+    uint64_t steals = Executor::stats().steals;
+
+    // A worker queues four tasks on its own deque and then stays busy:
+    // the other worker takes them, oldest first
+    Order order;
+    std::atomic<int> done(0);
+    std::thread::id owner;
+    std::atomic<bool> stolen(true);
+    Executor::post([&]() {
+        owner = std::this_thread::get_id();
+        for (int tag = 0; tag < 4; tag++) {
+            Executor::post([&, tag]() {
+                stolen = stolen && std::this_thread::get_id() != owner;
+                order.add(tag);
+                done++;
+            });
+        }
+        while (done < 4) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    });
+
+    CHECK(waitFor([&]() { return done == 4; }));
+    CHECK(stolen);
+    CHECK(order.tags() == std::vector<int>({0, 1, 2, 3}));
+
+    // The outer task may have been stolen too
+    CHECK(Executor::stats().steals - steals >= 4);
+    Executor::stop();
+}
+
+void testCancel() {
+    CHECK(Executor::start(2));
+    std::atomic<int> runs(0);
+    std::atomic<bool> running(false);
+    std::atomic<bool> finished(false);
+    Executor::TimerId id = Executor::schedule(milliseconds(0), milliseconds(10), [&]() {
+        runs++;
+        running = true;
+        std::this_thread::sleep_for(milliseconds(100));
+        finished = true;
+        running = false;
+    });
+    CHECK(waitFor([&]() { return running.load(); }));
+
+    // Returns only once the run in progress is over, and there is no other
+    Executor::cancel(id);
+    CHECK(finished);
+    CHECK(!running);
+    int after = runs;
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(runs == after);
+
+    // Unknown and already cancelled timers are ignored
+    Executor::cancel(id);
+    Executor::cancel(0);
+    Executor::stop();
+}
+
+void testParallelFor() {
+    constexpr size_t COUNT = 1000;
+    CHECK(Executor::start(2));
+
+    // Idle workers: every index once
+    std::vector<std::atomic<int>> visits(COUNT);
+    Executor::parallelFor(COUNT, 10, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            visits[i]++;
+        }
+    });
+    bool once = true;
+    for (const auto& count : visits) {
+        once = once && count == 1;
+    }
+    CHECK(once);
+
+    // Both workers busy: the caller runs every chunk itself rather than
+    // wait for one of them, here from inside one of the busy workers
+    Gate gate;
+    std::atomic<int> blocked(0);
+    std::atomic<bool> finished(false);
+    std::atomic<bool> caller_only(true);
+    Executor::post([&]() {
+        blocked++;
+        gate.wait();
+    });
+    Executor::post([&]() {
+        blocked++;
+        CHECK(waitFor([&]() { return blocked == 2; }));
+        std::thread::id caller = std::this_thread::get_id();
+        size_t covered = 0;
+        Executor::parallelFor(COUNT, 10, [&](size_t begin, size_t end) {
+            caller_only = caller_only && std::this_thread::get_id() == caller;
+            covered += end - begin;
+        });
+        finished = covered == COUNT;
+    });
+    CHECK(waitFor([&]() { return finished.load(); }));
+    CHECK(caller_only);
+    gate.open();
+    Executor::stop();
+
+    // Stopped: runs inline in one piece
+    size_t calls = 0;
+    Executor::parallelFor(COUNT, 10, [&](size_t begin, size_t end) {
+        calls++;
+        CHECK(begin == 0 && end == COUNT);
+    });
+    CHECK(calls == 1);
+}
+
+void testStop() {
+    CHECK(Executor::start(1));
+    CHECK(!Executor::start(1));
+    Gate gate;
+    std::atomic<bool> blocked(false);
+    std::atomic<int> ran(0);
+    Executor::post([&]() {
+        blocked = true;
+        gate.wait();
+    });
+    CHECK(waitFor([&]() { return blocked.load(); }));
+    for (int i = 0; i < 5; i++) {
+        Executor::post([&]() { ran++; });
+    }
+
+    // Stopped while the worker is busy: the queued tasks never run
+    std::thread stopper([]() { Executor::stop(); });
+    CHECK(waitFor([]() { return !Executor::running(); }));
+    gate.open();
+    stopper.join();
+    CHECK(ran == 0);
+    CHECK(Executor::stats().workers == 0);
+
+    // While stopped, posting runs the task on the spot
+    uint64_t inline_runs = Executor::stats().inline_runs;
+    Executor::post([&]() { ran++; });
+    CHECK(ran == 1);
+    CHECK(Executor::stats().inline_runs - inline_runs == 1);
+
+    // Timers stay registered and fire after the next start()
+    std::atomic<bool> fired(false);
+    Executor::schedule(milliseconds(0), milliseconds(0), [&]() { fired = true; });
+    std::this_thread::sleep_for(milliseconds(20));
+    CHECK(!fired);
+    CHECK(Executor::start(1));
+    CHECK(waitFor([&]() { return fired.load(); }));
+    CHECK(ran == 1);
+    Executor::stop();
+}
+
+} // namespace
+
+int main() {
+    // stop() warns about the tasks it drops
+    Logger::setLevel(LogLevel::ERROR);
+
+    testPriorities();
+    testStealing();
+    testCancel();
+    testParallelFor();
+    testStop();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,170 @@
+// Jitter histogram buckets and percentiles, and JitterMonitor's lateness,
+// period and overrun accounting with its culprit attribution
+
+#include "utils/jitter_monitor.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using Clock = JitterMonitor::Clock;
+using std::chrono::milliseconds;
+
+void testBuckets() {
+    LatencyHistogram histogram;
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.percentileUs(50.0) == 0);
+    CHECK(histogram.meanUs() == 0.0);
+
+    // [0, 2) in bucket 0, then powers of two
+    histogram.add(0);
+    histogram.add(1);
+    histogram.add(2);
+    histogram.add(3);
+    histogram.add(4);
+    histogram.add(1000);
+    histogram.add(1024);
+    CHECK(histogram.bucket(0) == 2);
+    CHECK(histogram.bucket(1) == 2);
+    CHECK(histogram.bucket(2) == 1);
+    CHECK(histogram.bucket(9) == 1);
+    CHECK(histogram.bucket(10) == 1);
+
+    // Beyond the last bucket: clamped into it
+    histogram.add(uint64_t(1) << 40);
+    CHECK(histogram.bucket(LatencyHistogram::BUCKETS - 1) == 1);
+    CHECK(histogram.maxUs() == uint64_t(1) << 40);
+    CHECK(histogram.count() == 8);
+}
+
+void testPercentiles() {
+    // 90 samples at 10 us, 10 at 1000 us
+    LatencyHistogram histogram;
+    for (int i = 0; i < 90; i++) {
+        histogram.add(10);
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram.add(1000);
+    }
+    CHECK_NEAR(histogram.meanUs(), 109.0, 1e-9);
+
+    // Upper bound of the bucket, [8, 16) for 10 us
+    CHECK(histogram.percentileUs(50.0) == 16);
+    CHECK(histogram.percentileUs(90.0) == 16);
+
+    // In the top bucket the maximum is the tighter bound
+    CHECK(histogram.percentileUs(99.0) == 1000);
+    CHECK(histogram.percentileUs(100.0) == 1000);
+    CHECK(histogram.percentileUs(0.0) == 16);
+}
+
+void testConcurrentAdds() {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram, t]() {
+            for (uint64_t i = 0; i < 10000; i++) {
+                histogram.add(i % 64 + t);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        total += histogram.bucket(i);
+    }
+    CHECK(histogram.count() == 40000);
+    CHECK(total == 40000);
+    CHECK(histogram.maxUs() == 66);
+}
+
+const JitterTaskStats& statsOf(const JitterReport& report, JitterTask task) {
+    return report.tasks[static_cast<size_t>(task)];
+}
+
+void testMonitor() {
+    const auto period = milliseconds(100);
+    const size_t heartbeat = static_cast<size_t>(JitterTask::HEARTBEAT);
+    const size_t state_save = static_cast<size_t>(JitterTask::STATE_SAVE);
+    Clock::time_point t0 = Clock::time_point() + std::chrono::hours(1);
+
+    // 10 ms late against a 100 ms period: lateness only
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, t0, t0 + milliseconds(10), period);
+    JitterReport report = JitterMonitor::report();
+    const JitterTaskStats& stats = statsOf(report, JitterTask::HEARTBEAT);
+    CHECK(std::strcmp(stats.name, "heartbeat") == 0);
+    CHECK(stats.lateness->count() == 1);
+    CHECK(stats.lateness->maxUs() == 10000);
+    CHECK(stats.period->count() == 0);
+    CHECK(stats.nominal_period_us == 100000);
+    CHECK(stats.overruns == 0);
+
+    // The next wakeup adds a period sample
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, t0 + period,
+                                t0 + period + milliseconds(10), period);
+    CHECK(statsOf(JitterMonitor::report(), JitterTask::HEARTBEAT).period->maxUs() == 100000);
+
+    // 80 ms late while a state save ran on this thread: its overrun
+    Clock::time_point due = t0 + 2 * period;
+    JitterMonitor::recordRun(JitterTask::STATE_SAVE, due - milliseconds(5), due + milliseconds(75));
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, due, due + milliseconds(80), period);
+    report = JitterMonitor::report();
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).overruns == 1);
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).overruns_by[state_save] == 1);
+    CHECK(statsOf(report, JitterTask::STATE_SAVE).run->count() == 1);
+    CHECK(statsOf(report, JitterTask::STATE_SAVE).run->maxUs() == 80000);
+
+    // 80 ms late with nothing running for most of it: the scheduler's
+    due = t0 + 3 * period;
+    JitterMonitor::recordRun(JitterTask::STATE_SAVE, due, due + milliseconds(20));
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, due, due + milliseconds(80), period);
+    report = JitterMonitor::report();
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).overruns == 2);
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).overruns_by[JITTER_CULPRIT_SCHEDULER] == 1);
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).overruns_by[heartbeat] == 0);
+
+    // A higher threshold: 80 ms late is no overrun at 90 %
+    JitterMonitor::setOverrunPercent(90);
+    due = t0 + 4 * period;
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, due, due + milliseconds(80), period);
+    CHECK(statsOf(JitterMonitor::report(), JitterTask::HEARTBEAT).overruns == 2);
+    JitterMonitor::setOverrunPercent(50);
+
+    // Disabled: nothing recorded, JitterScope included
+    JitterMonitor::setEnabled(false);
+    due = t0 + 5 * period;
+    JitterMonitor::recordWakeup(JitterTask::HEARTBEAT, due, due + milliseconds(80), period);
+    {
+        JitterScope scope(JitterTask::NODE_CLEANUP);
+    }
+    report = JitterMonitor::report();
+    CHECK(statsOf(report, JitterTask::HEARTBEAT).lateness->count() == 5);
+    CHECK(statsOf(report, JitterTask::NODE_CLEANUP).run->count() == 0);
+
+    JitterMonitor::setEnabled(true);
+    {
+        JitterScope scope(JitterTask::NODE_CLEANUP);
+    }
+    CHECK(statsOf(JitterMonitor::report(), JitterTask::NODE_CLEANUP).run->count() == 1);
+}
+
+} // namespace
+
+int main() {
+    // Overruns are logged at WARN
+    Logger::setLevel(LogLevel::ERROR);
+
+    testBuckets();
+    testPercentiles();
+    testConcurrentAdds();
+    testMonitor();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,217 @@
+// LiveExport and LiveReader: the region handed over the socket, state and
+// frames read back, a frame view invalidated once its slot is reused, and
+// no torn state or frame accepted while the writer publishes concurrently
+
+#include "core/live_export.h"
+#include "core/live_reader.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+constexpr int WIDTH = 32;
+constexpr int HEIGHT = 8;
+constexpr size_t ROW = WIDTH * 3;
+constexpr int TYPE_BGR = 16;         // CV_8UC3
+
+LiveExportConfig exportConfig(int slots) {
+    LiveExportConfig config;
+    config.enabled = true;
+    config.frame_slots = slots;
+    return config;
+}
+
+// Every field derived from n, so a mix of two publishes shows
+LiveState stateFor(int64_t n) {
+    LiveState state;
+    std::memset(&state, 0, sizeof(state));
+    state.timestamp_ns = n;
+    state.sensor_time_ms = n * 2;
+    state.vision_time_ms = n * 3;
+    state.smoke_ppm = static_cast<float>(n % 1000);
+    state.alert_state = static_cast<uint8_t>(n % 3);
+    state.active_nodes = static_cast<int32_t>(n);
+    state.vision_frames = static_cast<uint64_t>(n);
+    return state;
+}
+
+bool consistent(const LiveState& state) {
+    int64_t n = state.timestamp_ns;
+    return state.sensor_time_ms == n * 2 && state.vision_time_ms == n * 3 &&
+           state.smoke_ppm == static_cast<float>(n % 1000) &&
+           state.alert_state == n % 3 && state.active_nodes == n &&
+           state.vision_frames == static_cast<uint64_t>(n);
+}
+
+// A frame filled with one value, rows step bytes apart
+std::vector<uint8_t> image(uint8_t value, size_t step) {
+    return std::vector<uint8_t>(step * HEIGHT, value);
+}
+
+bool filled(const LiveFrame& frame, uint8_t value) {
+    for (size_t i = 0; i < frame.bytes; i++) {
+        if (frame.data[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testHandoff(const std::string& socket_path) {
+    LiveReader reader;
+    CHECK(!reader.open(socket_path));
+    CHECK(!reader.getLastError().empty());
+
+    LiveExport live(exportConfig(3), ROW * HEIGHT);
+    CHECK(live.start(socket_path));
+    CHECK(reader.open(socket_path));
+    CHECK(reader.writerPid() == getpid());
+
+    // Nothing published yet
+    LiveState state;
+    LiveFrame frame;
+    CHECK(!reader.readState(state));
+    CHECK(!reader.latestFrame(frame));
+    CHECK(reader.latestFrameNumber() == 0);
+
+    live.publishState(stateFor(42));
+    CHECK(reader.readState(state));
+    CHECK(state.timestamp_ns == 42 && consistent(state));
+
+    // Rows with padding are packed into the slot
+    std::vector<uint8_t> padded = image(7, ROW + 16);
+    CHECK(live.publishFrame(padded.data(), WIDTH, HEIGHT, TYPE_BGR, ROW, ROW + 16, 1234));
+    CHECK(reader.latestFrameNumber() == 1);
+    CHECK(reader.latestFrame(frame));
+    CHECK(frame.frame_number == 1 && frame.timestamp_ns == 1234);
+    CHECK(frame.width == WIDTH && frame.height == HEIGHT && frame.type == TYPE_BGR);
+    CHECK(frame.step == ROW && frame.bytes == ROW * HEIGHT);
+    CHECK(filled(frame, 7));
+    CHECK(reader.valid(frame));
+
+    // Valid until frame_slots more frames have been published
+    std::vector<uint8_t> packed = image(9, ROW);
+    CHECK(live.publishFrame(packed.data(), WIDTH, HEIGHT, TYPE_BGR, ROW, ROW, 0));
+    CHECK(live.publishFrame(packed.data(), WIDTH, HEIGHT, TYPE_BGR, ROW, ROW, 0));
+    CHECK(reader.valid(frame));
+    CHECK(live.publishFrame(packed.data(), WIDTH, HEIGHT, TYPE_BGR, ROW, ROW, 0));
+    CHECK(!reader.valid(frame));
+    CHECK(reader.latestFrame(frame));
+    CHECK(frame.frame_number == 4 && filled(frame, 9));
+
+    // Larger than a slot: dropped, the newest frame unchanged
+    std::vector<uint8_t> large(ROW * HEIGHT * 2, 1);
+    CHECK(!live.publishFrame(large.data(), WIDTH, HEIGHT * 2, TYPE_BGR, ROW, ROW, 0));
+    CHECK(live.framesDropped() == 1);
+    CHECK(live.framesPublished() == 4);
+    CHECK(reader.latestFrameNumber() == 4);
+
+    // The reader's mapping outlives the export
+    live.stop();
+    CHECK(reader.readState(state));
+    CHECK(state.timestamp_ns == 42);
+    reader.close();
+    CHECK(!reader.isOpen());
+}
+
+void testConcurrent(const std::string& socket_path) {
+    // Two slots, so frames are overwritten while readers use them
+    LiveExport live(exportConfig(2), ROW * HEIGHT);
+    CHECK(live.start(socket_path));
+    LiveReader reader;
+    CHECK(reader.open(socket_path));
+
+    // Neither side yields, so with fewer CPUs than threads the scheduler
+    // preempts the writer in the middle of a publish
+    std::atomic<bool> done(false);
+    std::atomic<int64_t> published(0);
+    std::thread writer([&]() {
+        std::vector<uint8_t> pixels(ROW * HEIGHT);
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+        int64_t n = 0;
+        while (std::chrono::steady_clock::now() < end) {
+            n++;
+            live.publishState(stateFor(n));
+            std::memset(pixels.data(), static_cast<int>(n & 0xff), pixels.size());
+            live.publishFrame(pixels.data(), WIDTH, HEIGHT, TYPE_BGR, ROW, ROW, n);
+        }
+        published = n;
+        done = true;
+    });
+
+    uint64_t states = 0;
+    uint64_t torn_states = 0;
+    uint64_t frames = 0;
+    uint64_t torn_frames = 0;
+    uint64_t discarded = 0;
+    int64_t last = 0;
+    bool ordered = true;
+    while (!done) {
+        LiveState state;
+        if (reader.readState(state)) {
+            states++;
+            torn_states += consistent(state) ? 0 : 1;
+            ordered = ordered && state.timestamp_ns >= last;
+            last = state.timestamp_ns;
+        }
+
+        // A view whose pixels were mixed must fail valid()
+        LiveFrame frame;
+        if (reader.latestFrame(frame)) {
+            bool intact = filled(frame, static_cast<uint8_t>(frame.frame_number & 0xff)) &&
+                          frame.timestamp_ns == static_cast<int64_t>(frame.frame_number);
+            if (reader.valid(frame)) {
+                frames++;
+                torn_frames += intact ? 0 : 1;
+            } else {
+                discarded++;
+            }
+        }
+    }
+    writer.join();
+
+    CHECK(states > 0);
+    CHECK(torn_states == 0);
+    CHECK(ordered);
+    CHECK(frames > 0);
+    CHECK(torn_frames == 0);
+    std::printf("%llu states, %llu frames read, %llu frame views discarded\n",
+                static_cast<unsigned long long>(states),
+                static_cast<unsigned long long>(frames),
+                static_cast<unsigned long long>(discarded));
+
+    LiveState state;
+    CHECK(reader.readState(state));
+    CHECK(state.timestamp_ns == published && consistent(state));
+    CHECK(reader.latestFrameNumber() == static_cast<uint64_t>(published.load()));
+}
+
+} // namespace
+
+int main() {
+    // start() logs the region at INFO
+    Logger::setLevel(LogLevel::WARN);
+
+    char dir[] = "/tmp/sentinel-live-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string socket_path = std::string(dir) + "/live.sock";
+
+    testHandoff(socket_path);
+    testConcurrent(socket_path);
+    rmdir(dir);
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,184 @@
+// TrackingResource live, peak and total accounting, per-subsystem resources
+// kept apart, budgets and load shedding, and MemoryTracker::report() sums
+// and allocation rates
+
+#include "utils/memory_tracker.h"
+#include "test_check.h"
+#include <chrono>
+#include <cstring>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+constexpr size_t SUBSYSTEMS = static_cast<size_t>(MemorySubsystem::COUNT);
+
+// Counts what reaches it, to check the tracker forwards everything
+class CountingUpstream : public std::pmr::memory_resource {
+public:
+    size_t live = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        live += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        live -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+void testAccounting() {
+    CountingUpstream upstream;
+    TrackingResource resource("test", &upstream);
+    CHECK(std::strcmp(resource.name(), "test") == 0);
+
+    void* a = resource.allocate(100, 8);
+    void* b = resource.allocate(300, 16);
+    CHECK(resource.liveBytes() == 400);
+    CHECK(resource.peakBytes() == 400);
+    CHECK(upstream.live == 400);
+
+    // Freeing lowers live bytes, the peak stays
+    resource.deallocate(b, 300, 16);
+    CHECK(resource.liveBytes() == 100);
+    CHECK(resource.peakBytes() == 400);
+    void* c = resource.allocate(200, 8);
+    CHECK(resource.peakBytes() == 400);
+    CHECK(resource.totalAllocated() == 600);
+    CHECK(resource.allocationCount() == 3);
+
+    resource.deallocate(a, 100, 8);
+    resource.deallocate(c, 200, 8);
+    CHECK(resource.liveBytes() == 0);
+    CHECK(upstream.live == 0);
+
+    // Through a container
+    {
+        std::pmr::vector<int> values(&resource);
+        values.resize(1000);
+        CHECK(resource.liveBytes() == 1000 * sizeof(int));
+    }
+    CHECK(resource.liveBytes() == 0);
+    CHECK(resource.peakBytes() == 1000 * sizeof(int));
+}
+
+void testConcurrent() {
+    TrackingResource resource("concurrent");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&resource]() {
+            for (int i = 0; i < 10000; i++) {
+                void* p = resource.allocate(64, 8);
+                resource.deallocate(p, 64, 8);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    CHECK(resource.liveBytes() == 0);
+    CHECK(resource.allocationCount() == 40000);
+    CHECK(resource.totalAllocated() == 40000 * 64);
+    CHECK(resource.peakBytes() >= 64 && resource.peakBytes() <= 4 * 64);
+}
+
+void testSubsystems() {
+    // One resource per subsystem, each named
+    for (size_t i = 0; i < SUBSYSTEMS; i++) {
+        for (size_t j = i + 1; j < SUBSYSTEMS; j++) {
+            CHECK(&MemoryTracker::resource(static_cast<MemorySubsystem>(i)) !=
+                  &MemoryTracker::resource(static_cast<MemorySubsystem>(j)));
+        }
+    }
+    CHECK(std::strcmp(MemoryTracker::resource(MemorySubsystem::MESH).name(), "mesh") == 0);
+
+    // Memory on one subsystem is not charged to the others
+    size_t before[SUBSYSTEMS];
+    for (size_t i = 0; i < SUBSYSTEMS; i++) {
+        before[i] = MemoryTracker::resource(static_cast<MemorySubsystem>(i)).liveBytes();
+    }
+    std::pmr::vector<char> mesh(4096, 0, &MemoryTracker::resource(MemorySubsystem::MESH));
+    for (size_t i = 0; i < SUBSYSTEMS; i++) {
+        size_t live = MemoryTracker::resource(static_cast<MemorySubsystem>(i)).liveBytes();
+        if (static_cast<MemorySubsystem>(i) == MemorySubsystem::MESH) {
+            CHECK(live == before[i] + 4096);
+        } else {
+            CHECK(live == before[i]);
+        }
+    }
+}
+
+void testBudget() {
+    TrackingResource& storage = MemoryTracker::resource(MemorySubsystem::STORAGE);
+    size_t base = storage.liveBytes();
+
+    // Unlimited by default
+    std::pmr::vector<char> data(8192, 0, &storage);
+    CHECK(!storage.overBudget());
+
+    MemoryTracker::setBudget(MemorySubsystem::STORAGE, base + 4096);
+    CHECK(storage.budget() == base + 4096);
+    CHECK(storage.overBudget());
+
+    // Over budget sheds load only when enabled, and only for that subsystem
+    CHECK(!MemoryTracker::shouldShed(MemorySubsystem::STORAGE));
+    MemoryTracker::setShedLoad(true);
+    CHECK(MemoryTracker::shouldShed(MemorySubsystem::STORAGE));
+    CHECK(!MemoryTracker::shouldShed(MemorySubsystem::SENSOR));
+
+    // Back under budget
+    data.clear();
+    data.shrink_to_fit();
+    CHECK(!MemoryTracker::shouldShed(MemorySubsystem::STORAGE));
+
+    MemoryTracker::setShedLoad(false);
+    MemoryTracker::setBudget(MemorySubsystem::STORAGE, 0);
+}
+
+void testReport() {
+    // The first report has no interval to measure a rate over
+    MemoryReport report = MemoryTracker::report();
+    size_t tracked = 0;
+    for (const SubsystemMemory& entry : report.subsystems) {
+        CHECK(entry.allocation_rate == 0.0);
+        tracked += entry.live_bytes;
+    }
+    CHECK(report.tracked_bytes == tracked);
+    CHECK(report.rss_bytes > 0);
+    CHECK(report.rss_bytes == report.tracked_bytes + report.untracked_bytes);
+
+    // Allocated since: a rate for that subsystem only
+    TrackingResource& sensor = MemoryTracker::resource(MemorySubsystem::SENSOR);
+    void* p = sensor.allocate(10000, 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    report = MemoryTracker::report();
+    const size_t index = static_cast<size_t>(MemorySubsystem::SENSOR);
+    CHECK(std::strcmp(report.subsystems[index].name, "sensor") == 0);
+    CHECK(report.subsystems[index].live_bytes == sensor.liveBytes());
+    CHECK(report.subsystems[index].allocation_rate > 0.0);
+    CHECK(report.subsystems[static_cast<size_t>(MemorySubsystem::VISION)].allocation_rate == 0.0);
+    sensor.deallocate(p, 10000, 8);
+
+    // Nothing new since the last report
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(MemoryTracker::report().subsystems[index].allocation_rate == 0.0);
+}
+
+} // namespace
+
+int main() {
+    testAccounting();
+    testConcurrent();
+    testSubsystems();
+    testBudget();
+    testReport();
+    return sentinel_test::testResult();
+}
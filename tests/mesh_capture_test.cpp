@@ -0,0 +1,279 @@
+// Mesh capture files written and read back field for field, a capture cut
+// short ending at its last whole record, traffic captured from a running
+// mesh replayed into another with the same outcome, and scaled replays
+
+#include "network/lora_mesh.h"
+#include "network/mesh_capture.h"
+#include "network/mesh_replay.h"
+#include "utils/logger.h"
+#include "mesh_test_util.h"
+#include "test_check.h"
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace sentinel;
+using namespace sentinel_test;
+
+namespace {
+
+CaptureRecord record(uint64_t time_us, CaptureDirection direction, const std::vector<uint8_t>& data,
+                     int rssi = 0, float snr = 0.0f) {
+    CaptureRecord result;
+    result.time_us = time_us;
+    result.direction = direction;
+    result.rssi = rssi;
+    result.snr = snr;
+    result.data = data.data();
+    result.len = data.size();
+    return result;
+}
+
+std::vector<uint8_t> bytes(const CaptureRecord& record) {
+    return std::vector<uint8_t>(record.data, record.data + record.len);
+}
+
+size_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<size_t>(file.tellg());
+}
+
+void testFormat(const std::string& path) {
+    std::vector<uint8_t> small = {1, 2, 3};
+    std::vector<uint8_t> large(300, 0xAB);
+    std::vector<uint8_t> empty;
+    {
+        MeshCaptureWriter writer;
+        CHECK(writer.open(path, 42));
+        CHECK(writer.isOpen());
+        CHECK(writer.write(record(100, CaptureDirection::RX, small, -97, 6.25f)));
+        CHECK(writer.write(record(100, CaptureDirection::TX, small)));
+
+        // A delta needing a three-byte varint, and a frame over the limit
+        CHECK(writer.write(record(1000100, CaptureDirection::RX, large, -300, -40.0f)));
+        CHECK(writer.write(record(1000200, CaptureDirection::RX, empty)));
+
+        // Time running backwards
+        CHECK(!writer.write(record(1000000, CaptureDirection::RX, small)));
+        CHECK(writer.records() == 4);
+        writer.close();
+        CHECK(!writer.isOpen());
+    }
+    CHECK(fileSize(path) == CAPTURE_HEADER_SIZE + (1 + 4 + 3) * 2 + (3 + 4 + 255) + (1 + 4));
+
+    MeshCaptureReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.nodeId() == 42);
+    CHECK(reader.startUnixNs() > 0);
+
+    CaptureRecord out;
+    CHECK(reader.next(out));
+    CHECK(out.time_us == 100 && out.direction == CaptureDirection::RX);
+    CHECK(out.rssi == -97 && out.snr == 6.25f);
+    CHECK(bytes(out) == small);
+
+    CHECK(reader.next(out));
+    CHECK(out.time_us == 100 && out.direction == CaptureDirection::TX);
+    CHECK(out.rssi == 0 && out.snr == 0.0f);
+
+    // Truncated to CAPTURE_MAX_FRAME, RSSI and SNR clamped to their fields
+    CHECK(reader.next(out));
+    CHECK(out.time_us == 1000100);
+    CHECK(out.len == CAPTURE_MAX_FRAME && out.data[0] == 0xAB);
+    CHECK(out.rssi == -255 && out.snr == -32.0f);
+
+    CHECK(reader.next(out));
+    CHECK(out.time_us == 1000200 && out.len == 0);
+    CHECK(!reader.next(out));
+}
+
+void testTruncated(const std::string& path) {
+    std::vector<uint8_t> frame(20, 7);
+    {
+        MeshCaptureWriter writer;
+        CHECK(writer.open(path, 1));
+        for (uint64_t i = 0; i < 3; i++) {
+            CHECK(writer.write(record(i * 1000, CaptureDirection::RX, frame)));
+        }
+    }
+
+    // Cut inside the last frame, as power loss would
+    std::vector<char> contents;
+    {
+        std::ifstream file(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(file), {});
+    }
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(contents.data(), static_cast<std::streamsize>(contents.size() - 5));
+
+    MeshCaptureReader reader;
+    CHECK(reader.open(path));
+    CaptureRecord out;
+    int count = 0;
+    while (reader.next(out)) {
+        count++;
+    }
+    CHECK(count == 2);
+
+    // Not a capture at all
+    std::ofstream(path, std::ios::trunc) << "{\"node_id\": 1}\n";
+    CHECK(!reader.open(path));
+    CHECK(!reader.getLastError().empty());
+    MeshReplay replay;
+    CHECK(!replay.load(path));
+}
+
+LoraConfig meshConfig() {
+    LoraConfig config;
+    config.spreading_factor = 7;
+    config.bandwidth = 500;
+    config.join_slots = 0;
+    config.heartbeat_interval_sec = 30;
+    return config;
+}
+
+NodeInfo nodeOf(const LoraMesh& mesh, uint8_t id) {
+    std::pmr::vector<NodeInfo> nodes;
+    mesh.getNodes(nodes);
+    for (const NodeInfo& node : nodes) {
+        if (node.node_id == id) {
+            return node;
+        }
+    }
+    NodeInfo none{};
+    return none;
+}
+
+void testRoundTrip(const std::string& path) {
+    // Three neighbours heard, one of them detecting, and a frame of our own
+    {
+        LoraMesh mesh(1, meshConfig());
+        MeshProbe probe(mesh);
+        CHECK(mesh.initialize());
+        CHECK(mesh.startCapture(path));
+        probe.inject(MESH_HEARTBEAT, 2, 0xFF, announcement(ROUTE_COST_NONE), -80, 5.0f);
+        probe.inject(MESH_HEARTBEAT, 3, 0xFF, announcement(ROUTE_COST_NONE, true), -95, -2.5f);
+        probe.inject(MESH_HEARTBEAT, 4, 0xFF, announcement(ROUTE_COST_NONE), -70, 9.0f);
+        mesh.broadcastDetection(true);
+        CHECK(probe.waitSent(MESH_DETECTION).size() == 1);
+        mesh.stopCapture();
+        CHECK(mesh.getActiveNodeCount() == 3);
+        CHECK(mesh.getDetectingNodeCount() == 1);
+    }
+
+    MeshReplay replay;
+    CHECK(replay.load(path));
+    CHECK(replay.receivedCount() == 3);
+    CHECK(replay.size() >= 4);
+
+    // Into a fresh node: the same neighbours, as they were heard
+    LoraMesh mesh(1, meshConfig());
+    MeshProbe probe(mesh);
+    CHECK(mesh.initialize());
+    ReplayStats stats = replay.run(mesh, 0.0);
+    CHECK(stats.frames == 3);
+    CHECK(mesh.getActiveNodeCount() == 3);
+    CHECK(mesh.getDetectingNodeCount() == 1);
+    CHECK(nodeOf(mesh, 2).rssi == -80);
+    CHECK(nodeOf(mesh, 3).detecting);
+    CHECK(mesh.getEventStats().frames_rejected == 0);
+
+    // save() writes what load() reads back
+    std::string copy = path + ".copy";
+    CHECK(replay.save(copy, 1));
+    MeshReplay reloaded;
+    CHECK(reloaded.load(copy));
+    CHECK(reloaded.size() == replay.size());
+    CHECK(reloaded.receivedCount() == 3);
+    std::remove(copy.c_str());
+}
+
+void testScaled() {
+    MeshMessage msg{};
+    msg.type = MESH_HEARTBEAT;
+    msg.destination_id = 0xFF;
+    std::vector<uint8_t> payload = announcement(ROUTE_COST_NONE);
+    msg.payload_len = static_cast<uint8_t>(payload.size());
+    std::copy(payload.begin(), payload.end(), msg.payload);
+
+    MeshReplay replay;
+    uint8_t frame[MAX_PAYLOAD_SIZE + 5];
+    for (uint8_t i = 0; i < 4; i++) {
+        msg.source_id = static_cast<uint8_t>(10 * (i + 1));
+        size_t len = LoraMesh::serializeMessage(msg, frame);
+        std::vector<uint8_t> data(frame, frame + len);
+        replay.add(record(i * 100000u, CaptureDirection::RX, data, -80, 5.0f));
+    }
+    std::vector<uint8_t> own = {MESH_DETECTION, 1, 0xFF};
+    replay.add(record(350000, CaptureDirection::TX, own));
+
+    // Each received frame three times, from new senders (the next ids,
+    // skipping ours) with valid checksums, in time order; our own frame
+    // is not scaled
+    constexpr uint8_t SELF = 11;
+    MeshReplay scaled = replay.scaled(3, SELF);
+    CHECK(scaled.size() == 12);
+    CHECK(scaled.receivedCount() == 12);
+
+    std::string path = "/tmp/sentinel-scaled-" + std::to_string(getpid()) + ".cap";
+    CHECK(scaled.save(path, SELF));
+    MeshCaptureReader reader;
+    CHECK(reader.open(path));
+    CaptureRecord out;
+    std::set<uint8_t> senders;
+    uint64_t last = 0;
+    bool valid = true;
+    bool ordered = true;
+    while (reader.next(out)) {
+        MeshMessage parsed;
+        valid = valid && LoraMesh::deserializeMessage(out.data, out.len, parsed);
+        ordered = ordered && out.time_us >= last;
+        last = out.time_us;
+        senders.insert(parsed.source_id);
+    }
+    CHECK(valid);
+    CHECK(ordered);
+    CHECK(senders.size() == 12);
+    CHECK(senders.count(SELF) == 0 && senders.count(12) == 1 && senders.count(13) == 1);
+    reader.close();
+    std::remove(path.c_str());
+
+    // Timed replay keeps the schedule: 300 ms of traffic at ten times
+    // speed, the last copy 2/3 of the default 1 ms gap after its original
+    LoraMesh mesh(SELF, meshConfig());
+    MeshProbe probe(mesh);
+    CHECK(mesh.initialize());
+    ReplayStats stats = scaled.run(mesh, 10.0);
+    CHECK(stats.frames == 12);
+    CHECK_NEAR(stats.capture_sec, 0.300666, 1e-6);
+    CHECK(stats.elapsed_sec >= 0.030);
+    CHECK(mesh.getActiveNodeCount() == 12);
+}
+
+} // namespace
+
+int main() {
+    // Captures and mesh start-up log at INFO
+    Logger::setLevel(LogLevel::WARN);
+
+    char dir[] = "/tmp/sentinel-capture-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string path = std::string(dir) + "/mesh.cap";
+
+    testFormat(path);
+    testTruncated(path);
+    testRoundTrip(path);
+    std::remove(path.c_str());
+    testScaled();
+    rmdir(dir);
+    return sentinel_test::testResult();
+}
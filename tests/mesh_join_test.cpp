@@ -0,0 +1,139 @@
+// Join handshake: solicitation rounds, digests naming missing neighbours,
+// and the replies of a node solicited by others
+
+#include "network/lora_mesh.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "mesh_test_util.h"
+#include "test_check.h"
+
+using namespace sentinel;
+using namespace sentinel_test;
+
+namespace {
+
+void testNextSlots() {
+    // Nobody missing, or out of rounds: done
+    CHECK(LoraMesh::joinNextSlots(1, 0, 3, 16) == 0);
+    CHECK(LoraMesh::joinNextSlots(LoraMesh::JOIN_MAX_ROUNDS, 3, 1, 16) == 0);
+
+    // Two slots per missing peer, within [JOIN_MIN_SLOTS, first round]
+    CHECK(LoraMesh::joinNextSlots(1, 3, 5, 16) == 6);
+    CHECK(LoraMesh::joinNextSlots(1, 1, 5, 16) == LoraMesh::JOIN_MIN_SLOTS);
+    CHECK(LoraMesh::joinNextSlots(1, 20, 5, 16) == 16);
+    CHECK(LoraMesh::joinNextSlots(1, 20, 5, 2) == LoraMesh::JOIN_MIN_SLOTS);
+
+    // A repeat round that found nobody new ends it: the rest are two hops
+    // away
+    CHECK(LoraMesh::joinNextSlots(2, 3, 0, 16) == 0);
+    CHECK(LoraMesh::joinNextSlots(2, 3, 1, 16) == 6);
+}
+
+bool lists(const MeshMessage& msg, size_t offset, uint8_t id) {
+    for (size_t i = offset; i < msg.payload_len; i++) {
+        if (msg.payload[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void testHandshake() {
+    LoraConfig config;
+    config.spreading_factor = 7;         // Short slots
+    config.bandwidth = 500;
+    config.join_slots = 16;
+    config.heartbeat_interval_sec = 30;
+    LoraMesh mesh(1, config);
+    MeshProbe probe(mesh);
+    CHECK(mesh.initialize());
+    CHECK(mesh.joining());
+
+    // Round 1: join_slots reply slots, nobody known yet, no route
+    std::vector<MeshMessage> solicits = probe.waitSent(MESH_SOLICIT);
+    CHECK(solicits.size() == 1);
+    if (solicits.size() == 1) {
+        const MeshMessage& first = solicits[0];
+        CHECK(first.destination_id == 0xFF);
+        CHECK(first.payload_len == 6);
+        CHECK(first.payload[5] == 16);
+        CHECK(first.payload[3] == 0xFF && first.payload[4] == 0xFF);
+    }
+
+    // Two neighbours answer; their digests name node 4, not heard directly
+    std::vector<uint8_t> digest = announcement(ROUTE_COST_NONE);
+    digest.insert(digest.end(), {3, 4});
+    probe.inject(MESH_DIGEST, 2, 1, digest);
+    digest = announcement(ROUTE_COST_NONE);
+    digest.push_back(2);
+    probe.inject(MESH_DIGEST, 3, 1, digest);
+    CHECK(mesh.getActiveNodeCount() == 2);
+
+    // Round 2 asks again with two slots per missing peer (at least
+    // JOIN_MIN_SLOTS), listing the peers it already has
+    solicits = probe.waitSent(MESH_SOLICIT);
+    CHECK(solicits.size() == 1);
+    if (solicits.size() == 1) {
+        const MeshMessage& second = solicits[0];
+        CHECK(second.payload[5] == LoraMesh::JOIN_MIN_SLOTS);
+        CHECK(second.payload_len == 8);
+        CHECK(lists(second, 6, 2) && lists(second, 6, 3));
+    }
+
+    // Node 4 never answers: the round finds nobody new and the handshake ends
+    CHECK(waitUntil([&]() { return !mesh.joining(); }));
+    CHECK(mesh.getAirtimeStats().solicitations_sent == 2);
+    CHECK(mesh.getActiveNodeCount() == 2);
+
+    // Solicited by a joining neighbour: a digest of our peers, in one of
+    // its reply slots
+    std::vector<uint8_t> solicit = announcement(ROUTE_COST_NONE);
+    solicit.insert(solicit.end(), {2, 5});
+    probe.inject(MESH_SOLICIT, 9, 0xFF, solicit);
+    std::vector<MeshMessage> digests = probe.waitSent(MESH_DIGEST);
+    CHECK(digests.size() == 1);
+    if (digests.size() == 1) {
+        const MeshMessage& reply = digests[0];
+        CHECK(reply.destination_id == 9);
+        CHECK(reply.payload_len == 7);
+        CHECK(lists(reply, 5, 2) && lists(reply, 5, 3));
+        CHECK(!lists(reply, 5, 9));
+    }
+    CHECK(mesh.getAirtimeStats().digests_sent == 1);
+
+    // Listed as known by the solicitor: stays quiet
+    solicit = announcement(ROUTE_COST_NONE);
+    solicit.insert(solicit.end(), {2, 1});
+    probe.inject(MESH_SOLICIT, 8, 0xFF, solicit);
+    CHECK(probe.waitSent(MESH_DIGEST, 1, std::chrono::milliseconds(500)).empty());
+
+    mesh.shutdown();
+}
+
+void testNoHandshake() {
+    // join_slots 0: just announce with a heartbeat
+    LoraConfig config;
+    config.spreading_factor = 7;
+    config.bandwidth = 500;
+    config.join_slots = 0;
+    LoraMesh mesh(1, config);
+    MeshProbe probe(mesh);
+    CHECK(mesh.initialize());
+    CHECK(!mesh.joining());
+    CHECK(probe.waitSent(MESH_HEARTBEAT).size() == 1);
+    CHECK(mesh.getAirtimeStats().solicitations_sent == 0);
+    mesh.shutdown();
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::WARN);
+
+    Executor::start(2);
+    testNextSlots();
+    testHandshake();
+    testNoHandshake();
+    Executor::stop();
+    return sentinel_test::testResult();
+}
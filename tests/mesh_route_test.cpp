@@ -0,0 +1,297 @@
+// Gradient routing: link and path costs, parent selection with its switch
+// threshold, hop-by-hop upstream delivery with acknowledgements, fallback
+// past a silent parent, relaying and delivery on a gateway
+
+#include "network/lora_mesh.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "mesh_test_util.h"
+#include "test_check.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+using namespace sentinel_test;
+
+namespace {
+
+// Heard with a comfortable margin: link cost ROUTE_HOP_COST
+constexpr int RSSI = -80;
+constexpr float SNR = 5.0f;
+
+LoraConfig routeConfig() {
+    LoraConfig config;
+    config.spreading_factor = 7;         // Short acknowledgement timeouts
+    config.bandwidth = 500;
+    config.join_slots = 0;
+    config.heartbeat_interval_sec = 30;
+    return config;
+}
+
+std::vector<uint8_t> upstream(uint8_t origin, uint8_t seq, uint8_t ttl, uint16_t cost,
+                              std::initializer_list<uint8_t> data) {
+    std::vector<uint8_t> payload = {origin, seq, ttl, static_cast<uint8_t>(cost & 0xFF),
+                                    static_cast<uint8_t>(cost >> 8)};
+    payload.insert(payload.end(), data);
+    return payload;
+}
+
+void testCosts() {
+    // One hop cost per 5 dB of margin below 10 dB, at most four
+    CHECK(LoraMesh::linkCost(12.0f) == LoraMesh::ROUTE_HOP_COST);
+    CHECK(LoraMesh::linkCost(10.0f) == LoraMesh::ROUTE_HOP_COST);
+    CHECK(LoraMesh::linkCost(7.0f) == 2 * LoraMesh::ROUTE_HOP_COST);
+    CHECK(LoraMesh::linkCost(0.0f) == 3 * LoraMesh::ROUTE_HOP_COST);
+    CHECK(LoraMesh::linkCost(-20.0f) == 4 * LoraMesh::ROUTE_HOP_COST);
+
+    // A link keeps its band until the margin leaves it by
+    // LINK_HYSTERESIS_DB
+    CHECK(LoraMesh::linkCost(9.0f, 16) == 16);
+    CHECK(LoraMesh::linkCost(7.5f, 16) == 32);
+    CHECK(LoraMesh::linkCost(11.5f, 32) == 32);
+    CHECK(LoraMesh::linkCost(12.5f, 32) == 16);
+
+    // Margin over the demodulation floor of the spreading factor
+    LoraConfig config;
+    config.spreading_factor = 7;
+    CHECK_NEAR(LoraMesh::snrMargin(config, 0.0f), 7.5f, 1e-4f);
+    config.spreading_factor = 12;
+    CHECK_NEAR(LoraMesh::snrMargin(config, 0.0f), 20.0f, 1e-4f);
+
+    // Gaining or losing a route, or a change of ROUTE_RESET_COST
+    CHECK(LoraMesh::routeCostChanged(ROUTE_COST_NONE, 100));
+    CHECK(LoraMesh::routeCostChanged(100, ROUTE_COST_NONE));
+    CHECK(!LoraMesh::routeCostChanged(ROUTE_COST_NONE, ROUTE_COST_NONE));
+    CHECK(LoraMesh::routeCostChanged(16, 16 + LoraMesh::ROUTE_RESET_COST));
+    CHECK(!LoraMesh::routeCostChanged(16, 16 + LoraMesh::ROUTE_RESET_COST - 1));
+}
+
+void testNode() {
+    LoraMesh mesh(1, routeConfig());
+    MeshProbe probe(mesh);
+    CHECK(mesh.initialize());
+
+    // Nobody heard: no route, nothing to send through
+    const uint8_t data[] = {0xAB, 0xCD};
+    CHECK(!mesh.sendUpstream(data, sizeof(data)));
+    CHECK(mesh.getRouteStats().parent == -1);
+
+    // Gateway 2 one hop away, node 3 one hop from a gateway
+    probe.inject(MESH_HEARTBEAT, 2, 0xFF, announcement(10), RSSI, SNR);
+    probe.inject(MESH_HEARTBEAT, 3, 0xFF, announcement(16), RSSI, SNR);
+    MeshRouteStats stats = mesh.getRouteStats();
+    CHECK(stats.parent == 2);
+    CHECK(stats.cost == 10 + LoraMesh::ROUTE_HOP_COST);
+
+    // 40 against 32 through node 3: within ROUTE_SWITCH_THRESHOLD, kept
+    probe.inject(MESH_HEARTBEAT, 2, 0xFF, announcement(24), RSSI, SNR);
+    stats = mesh.getRouteStats();
+    CHECK(stats.parent == 2);
+    CHECK(stats.cost == 40);
+
+    // 41 against 32: switches
+    probe.inject(MESH_HEARTBEAT, 2, 0xFF, announcement(25), RSSI, SNR);
+    stats = mesh.getRouteStats();
+    CHECK(stats.parent == 3);
+    CHECK(stats.cost == 32);
+    CHECK(stats.parent_changes == 2);
+
+    // Own message to the parent, with the full hop limit and our cost
+    CHECK(mesh.sendUpstream(data, sizeof(data)));
+    std::vector<MeshMessage> sent = probe.waitSent(MESH_UPSTREAM);
+    CHECK(sent.size() == 1);
+    if (sent.size() == 1) {
+        std::vector<uint8_t> expected = upstream(1, 0, LoraMesh::ROUTE_MAX_HOPS, 32, {0xAB, 0xCD});
+        CHECK(sent[0].destination_id == 3);
+        CHECK(std::vector<uint8_t>(sent[0].payload, sent[0].payload + sent[0].payload_len) ==
+              expected);
+    }
+    probe.inject(MESH_ACK, 3, 1, {1, 0});
+    CHECK(waitUntil([&]() { return mesh.getRouteStats().forwarded == 1; }));
+
+    // Node 3 goes silent: ROUTE_ATTEMPTS tries, then node 2 takes over
+    CHECK(mesh.sendUpstream(data, sizeof(data)));
+    sent = probe.waitSent(MESH_UPSTREAM, LoraMesh::ROUTE_ATTEMPTS + 1,
+                          std::chrono::milliseconds(5000));
+    CHECK(sent.size() == LoraMesh::ROUTE_ATTEMPTS + 1);
+    if (sent.size() == LoraMesh::ROUTE_ATTEMPTS + 1) {
+        for (int i = 0; i < LoraMesh::ROUTE_ATTEMPTS; i++) {
+            CHECK(sent[i].destination_id == 3 && sent[i].payload[1] == 1);
+        }
+        CHECK(sent.back().destination_id == 2 && sent.back().payload[1] == 1);
+    }
+    stats = mesh.getRouteStats();
+    CHECK(stats.fallbacks == 1);
+    CHECK(stats.parent == 2);
+    CHECK(stats.cost == 41);
+    probe.inject(MESH_ACK, 2, 1, {1, 1});
+    CHECK(waitUntil([&]() { return mesh.getRouteStats().forwarded == 2; }));
+
+    // Relayed for node 4: acknowledged, then forwarded with one hop less
+    probe.inject(MESH_UPSTREAM, 4, 1, upstream(4, 7, 10, 57, {0x11}));
+    std::vector<MeshMessage> acks = probe.waitSent(MESH_ACK);
+    CHECK(acks.size() == 1);
+    if (acks.size() == 1) {
+        CHECK(acks[0].destination_id == 4);
+        CHECK(acks[0].payload_len == 2 && acks[0].payload[0] == 4 && acks[0].payload[1] == 7);
+    }
+    sent = probe.waitSent(MESH_UPSTREAM);
+    CHECK(sent.size() == 1);
+    if (sent.size() == 1) {
+        CHECK(sent[0].destination_id == 2);
+        CHECK(std::vector<uint8_t>(sent[0].payload, sent[0].payload + sent[0].payload_len) ==
+              upstream(4, 7, 9, 41, {0x11}));
+    }
+    probe.inject(MESH_ACK, 2, 1, {4, 7});
+    CHECK(waitUntil([&]() { return mesh.getRouteStats().forwarded == 3; }));
+
+    // Out of hops: acknowledged so the sender stops, but not forwarded
+    probe.inject(MESH_UPSTREAM, 4, 1, upstream(4, 8, 0, 57, {0x12}));
+    CHECK(probe.waitSent(MESH_ACK).size() == 1);
+    CHECK(mesh.getRouteStats().dropped == 1);
+    CHECK(probe.waitSent(MESH_UPSTREAM, 1, std::chrono::milliseconds(500)).empty());
+
+    mesh.shutdown();
+}
+
+void testGateway() {
+    LoraConfig config = routeConfig();
+    config.gateway = true;
+    LoraMesh mesh(1, config);
+    MeshProbe probe(mesh);
+    std::vector<std::vector<uint8_t>> delivered;
+    mesh.setUpstreamCallback([&](uint8_t origin, const uint8_t* data, size_t len) {
+        std::vector<uint8_t> message = {origin};
+        message.insert(message.end(), data, data + len);
+        delivered.push_back(message);
+    });
+    CHECK(mesh.initialize());
+    CHECK(mesh.getRouteStats().cost == 0);
+
+    probe.inject(MESH_UPSTREAM, 5, 1, upstream(5, 3, 20, 16, {0x21, 0x22}));
+    CHECK(probe.waitSent(MESH_ACK).size() == 1);
+    CHECK(waitUntil([&]() {
+        mesh.processMessages();
+        return !delivered.empty();
+    }));
+    CHECK(delivered.size() == 1 && delivered[0] == std::vector<uint8_t>({5, 0x21, 0x22}));
+
+    // A repeat (our acknowledgement was lost) is acknowledged again but
+    // delivered once
+    probe.inject(MESH_UPSTREAM, 5, 1, upstream(5, 3, 20, 16, {0x21, 0x22}));
+    CHECK(probe.waitSent(MESH_ACK).size() == 1);
+    mesh.processMessages();
+    CHECK(delivered.size() == 1);
+
+    // The gateway's own data goes straight to the callback
+    const uint8_t data[] = {0x31};
+    CHECK(mesh.sendUpstream(data, sizeof(data)));
+    mesh.processMessages();
+    CHECK(delivered.size() == 2 && delivered[1] == std::vector<uint8_t>({1, 0x31}));
+    CHECK(mesh.getRouteStats().delivered == 2);
+    CHECK(probe.waitSent(MESH_UPSTREAM, 1, std::chrono::milliseconds(500)).empty());
+
+    mesh.shutdown();
+}
+
+void inject(LoraMesh& mesh, uint8_t type, uint8_t source, uint8_t destination,
+            const std::vector<uint8_t>& payload) {
+    MeshMessage msg{};
+    msg.type = type;
+    msg.source_id = source;
+    msg.destination_id = destination;
+    msg.payload_len = static_cast<uint8_t>(payload.size());
+    std::copy(payload.begin(), payload.end(), msg.payload);
+    uint8_t frame[MAX_PAYLOAD_SIZE + 5];
+    mesh.receiveFrame(frame, LoraMesh::serializeMessage(msg, frame), RSSI, SNR);
+}
+
+void testCorruptFrames() {
+    MeshMessage msg{};
+    msg.type = MESH_HEARTBEAT;
+    msg.source_id = 2;
+    msg.destination_id = 0xFF;
+    std::vector<uint8_t> payload = announcement(0);
+    msg.payload_len = static_cast<uint8_t>(payload.size());
+    std::copy(payload.begin(), payload.end(), msg.payload);
+    uint8_t frame[MAX_PAYLOAD_SIZE + 5];
+    size_t len = LoraMesh::serializeMessage(msg, frame);
+    MeshMessage decoded;
+    CHECK(LoraMesh::deserializeMessage(frame, len, decoded));
+    CHECK(decoded.source_id == 2 && decoded.payload_len == payload.size());
+
+    // One flipped bit in the cost: rejected, or it would be a route
+    frame[8] ^= 0x01;
+    CHECK(!LoraMesh::deserializeMessage(frame, len, decoded));
+    CHECK(!LoraMesh::deserializeMessage(frame, 4, decoded));
+
+    LoraMesh mesh(1, routeConfig());
+    CHECK(mesh.initialize());
+    mesh.receiveFrame(frame, len, RSSI, SNR);
+    mesh.receiveFrame(frame, len - 1, RSSI, SNR);
+    CHECK(mesh.getEventStats().frames_rejected == 2);
+    CHECK(mesh.getRouteStats().parent == -1);
+    CHECK(mesh.getActiveNodeCount() == 0);
+    mesh.shutdown();
+}
+
+void testRestart() {
+    // A node id change replaces the mesh (SentinelCore::applyConfig) while
+    // relayed and own messages keep coming: the routing tasks they post
+    // must be done by the time shutdown() returns, before the mesh is freed
+    for (int round = 0; round < 20; round++) {
+        uint8_t id = static_cast<uint8_t>(1 + round % 2);
+        std::atomic<bool> stopped(false);
+        std::atomic<int> sent(0);
+        std::atomic<int> late(0);
+        auto mesh = std::make_unique<LoraMesh>(id, routeConfig());
+        mesh->setFrameSink([&](const uint8_t*, size_t) {
+            (stopped ? late : sent).fetch_add(1);
+        });
+        CHECK(mesh->initialize());
+        inject(*mesh, MESH_HEARTBEAT, 9, 0xFF, announcement(0));
+
+        std::atomic<bool> done(false);
+        std::thread traffic([&]() {
+            const uint8_t data[] = {0x42};
+            uint8_t seq = 0;
+            uint8_t own = 0;
+            while (!done) {
+                inject(*mesh, MESH_UPSTREAM, 4, id, upstream(4, seq, 10, 57, {0x11}));
+                inject(*mesh, MESH_ACK, 9, id, {4, seq});
+                seq++;
+                if (mesh->sendUpstream(data, sizeof(data))) {
+                    inject(*mesh, MESH_ACK, 9, id, {id, own++});
+                }
+                std::this_thread::yield();
+            }
+        });
+
+        waitUntil([&]() { return sent > 10; });
+        mesh->shutdown();
+        stopped = true;
+        done = true;
+        traffic.join();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        CHECK(sent > 10);
+        CHECK(late == 0);
+        mesh.reset();
+    }
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::WARN);
+
+    Executor::start(2);
+    testCosts();
+    testNode();
+    testGateway();
+    testCorruptFrames();
+    testRestart();
+    Executor::stop();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,103 @@
+#ifndef SENTINEL_MESH_TEST_UTIL_H
+#define SENTINEL_MESH_TEST_UTIL_H
+
+#include "network/lora_mesh.h"
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Drives one LoraMesh from a test: frames are handed to it as if received,
+// and what it transmits is collected from its frame sink, so the mesh runs
+// unmodified with its own timers.
+
+namespace sentinel_test {
+
+// Frame types on the air (lora_mesh.cpp)
+constexpr uint8_t MESH_HEARTBEAT = 0x01;
+constexpr uint8_t MESH_DETECTION = 0x02;
+constexpr uint8_t MESH_ACK = 0x03;
+constexpr uint8_t MESH_SOLICIT = 0x04;
+constexpr uint8_t MESH_DIGEST = 0x05;
+constexpr uint8_t MESH_UPSTREAM = 0x06;
+
+// Flags, silence bound and route cost: the start of heartbeats,
+// solicitations and digests
+inline std::vector<uint8_t> announcement(uint16_t cost, bool detecting = false,
+                                         uint16_t silence_bound_sec = 0) {
+    return {static_cast<uint8_t>(detecting ? 1 : 0),
+            static_cast<uint8_t>(silence_bound_sec & 0xFF),
+            static_cast<uint8_t>(silence_bound_sec >> 8),
+            static_cast<uint8_t>(cost & 0xFF), static_cast<uint8_t>(cost >> 8)};
+}
+
+// Until condition() holds or timeout passes
+template <typename Condition>
+bool waitUntil(Condition condition,
+               std::chrono::milliseconds timeout = std::chrono::milliseconds(3000)) {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+class MeshProbe {
+public:
+    // Before mesh.initialize()
+    explicit MeshProbe(sentinel::LoraMesh& mesh) : mesh_(mesh) {
+        mesh_.setFrameSink([this](const uint8_t* frame, size_t len) {
+            sentinel::MeshMessage msg;
+            if (sentinel::LoraMesh::deserializeMessage(frame, len, msg)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                sent_.push_back(msg);
+            }
+        });
+    }
+
+    // Hand the mesh a frame as the radio would
+    void inject(uint8_t type, uint8_t source, uint8_t destination,
+                const std::vector<uint8_t>& payload, int rssi = 0, float snr = 0.0f) {
+        sentinel::MeshMessage msg{};
+        msg.type = type;
+        msg.source_id = source;
+        msg.destination_id = destination;
+        msg.payload_len = static_cast<uint8_t>(payload.size());
+        std::copy(payload.begin(), payload.end(), msg.payload);
+        uint8_t frame[sentinel::MAX_PAYLOAD_SIZE + 5];
+        size_t len = sentinel::LoraMesh::serializeMessage(msg, frame);
+        mesh_.receiveFrame(frame, len, rssi, snr);
+    }
+
+    // Transmitted frames of one type, collected until count have been
+    // sent or timeout passes. Frames of other types stay for later calls.
+    std::vector<sentinel::MeshMessage> waitSent(uint8_t type, size_t count = 1,
+                                                std::chrono::milliseconds timeout =
+                                                    std::chrono::milliseconds(3000)) {
+        std::vector<sentinel::MeshMessage> frames;
+        waitUntil([&]() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto other = std::stable_partition(sent_.begin(), sent_.end(),
+                [type](const sentinel::MeshMessage& msg) { return msg.type != type; });
+            frames.insert(frames.end(), other, sent_.end());
+            sent_.erase(other, sent_.end());
+            return frames.size() >= count;
+        }, timeout);
+        return frames;
+    }
+
+private:
+    sentinel::LoraMesh& mesh_;
+    std::mutex mutex_;
+    std::vector<sentinel::MeshMessage> sent_;
+};
+
+} // namespace sentinel_test
+
+#endif // SENTINEL_MESH_TEST_UTIL_H
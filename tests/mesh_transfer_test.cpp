@@ -0,0 +1,243 @@
+// MeshTransfer between nodes on a fake clock: the object layout, a fetch
+// that reuses local chunks, a full fetch, and versions rejected for a
+// header or file MAC that does not match
+
+#include "network/lora_mesh.h"
+#include "network/mesh_transfer.h"
+#include "utils/content_chunker.h"
+#include "test_check.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using Clock = MeshTransfer::Clock;
+
+const MeshTransfer::Key KEY = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+std::vector<uint8_t> randomBytes(size_t len, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(len);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+uint32_t get32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+struct Node {
+    int id;
+    MeshTransfer transfer;
+
+    explicit Node(int node_id) : id(node_id), transfer(static_cast<uint32_t>(node_id)) {
+        transfer.configure(std::chrono::seconds(1), std::chrono::seconds(60), 1,
+                           std::chrono::seconds(2), std::chrono::milliseconds(50));
+    }
+};
+
+// Every frame reaches every other node; time jumps to the next due node
+template <typename Condition>
+void run(std::vector<Node*> nodes, Clock::time_point& now, Clock::duration limit,
+         Condition done) {
+    Clock::time_point end = now + limit;
+    MeshTransfer::Frame frame;
+    while (!done() && now < end) {
+        for (Node* sender : nodes) {
+            while (sender->transfer.poll(now, frame)) {
+                for (Node* receiver : nodes) {
+                    if (receiver != sender) {
+                        receiver->transfer.receive(frame.type, sender->id,
+                                                   frame.destination == receiver->id,
+                                                   frame.payload, frame.len, now);
+                    }
+                }
+            }
+        }
+        Clock::time_point next = end;
+        for (Node* node : nodes) {
+            next = std::min(next, node->transfer.nextDue());
+        }
+        now = std::max(next, now + std::chrono::milliseconds(1));
+    }
+}
+
+bool holds(const MeshTransfer& transfer, const std::vector<uint8_t>& data) {
+    size_t len;
+    const uint8_t* file = transfer.file(TransferKind::MODEL, len);
+    return len == data.size() && std::equal(data.begin(), data.end(), file);
+}
+
+void testKey() {
+    MeshTransfer::Key key;
+    CHECK(MeshTransfer::parseKey("0102030405060708090a0B0c0D0e0F10", key));
+    CHECK(key == KEY);
+    CHECK(!MeshTransfer::parseKey("0102030405060708090a0b0c0d0e0f", key));
+    CHECK(!MeshTransfer::parseKey("0102030405060708090a0b0c0d0e0f1g", key));
+
+    // Updates need a key as well as a duty share
+    LoraConfig config;
+    config.update_duty_percent = 10;
+    config.update_key = "0102030405060708090a0b0c0d0e0f10";
+    CHECK(LoraMesh::updatesEnabled(config));
+    config.update_key.clear();
+    CHECK(!LoraMesh::updatesEnabled(config));
+    config.update_key = "0102030405060708090a0b0c0d0e0f10";
+    config.update_duty_percent = 0;
+    CHECK(!LoraMesh::updatesEnabled(config));
+}
+
+void testObject() {
+    std::vector<uint8_t> data = randomBytes(10000, 1);
+    std::vector<uint8_t> object = MeshTransfer::buildObject(TransferKind::CONFIG, 5, data.data(),
+                                                            data.size(), KEY);
+    std::vector<ContentChunk> chunks = chunkContent(data.data(), data.size());
+    CHECK(object.size() == MeshTransfer::HEADER_SIZE +
+                           chunks.size() * MeshTransfer::MANIFEST_ENTRY_SIZE + data.size());
+    CHECK(object[1] == static_cast<uint8_t>(TransferKind::CONFIG));
+    CHECK((object[2] | (object[3] << 8)) == static_cast<int>(chunks.size()));
+    CHECK(get32(object.data() + 4) == data.size());
+
+    // Manifest: CRC-32 and length of each chunk, then the file
+    bool manifest = true;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const uint8_t* entry = object.data() + MeshTransfer::HEADER_SIZE +
+                               i * MeshTransfer::MANIFEST_ENTRY_SIZE;
+        manifest = manifest && get32(entry) == chunks[i].hash &&
+                   (entry[4] | (entry[5] << 8)) == static_cast<int>(chunks[i].length);
+    }
+    CHECK(manifest);
+    CHECK(std::equal(data.begin(), data.end(), object.end() - data.size()));
+
+    // The MACs cover the version and depend on the key
+    std::vector<uint8_t> other = MeshTransfer::buildObject(TransferKind::CONFIG, 6, data.data(),
+                                                           data.size(), KEY);
+    CHECK(std::equal(object.begin(), object.begin() + 16, other.begin()));
+    CHECK(!std::equal(object.begin() + 16, object.begin() + 24, other.begin() + 16));
+    MeshTransfer::Key key = KEY;
+    key[0] ^= 1;
+    other = MeshTransfer::buildObject(TransferKind::CONFIG, 5, data.data(), data.size(), key);
+    CHECK(!std::equal(object.begin() + 8, object.begin() + 16, other.begin() + 8));
+}
+
+void testFetch() {
+    // Version 2 changes 100 bytes in the middle of version 1
+    std::vector<uint8_t> old_model = randomBytes(20000, 2);
+    std::vector<uint8_t> new_model = old_model;
+    for (size_t i = 10000; i < 10100; i++) {
+        new_model[i] ^= 0xFF;
+    }
+
+    Node server(1);
+    Node updated(2);
+    Node fresh(3);
+    for (Node* node : {&server, &updated, &fresh}) {
+        node->transfer.setKey(KEY);
+    }
+    server.transfer.setFile(TransferKind::MODEL, 2, new_model.data(), new_model.size());
+    updated.transfer.setFile(TransferKind::MODEL, 1, old_model.data(), old_model.size());
+
+    Clock::time_point now = Clock::time_point() + std::chrono::hours(1);
+    for (Node* node : {&server, &updated, &fresh}) {
+        node->transfer.start(now);
+    }
+    run({&server, &updated, &fresh}, now, std::chrono::minutes(10), [&]() {
+        return updated.transfer.version(TransferKind::MODEL) == 2 &&
+               fresh.transfer.version(TransferKind::MODEL) == 2;
+    });
+    CHECK(updated.transfer.version(TransferKind::MODEL) == 2);
+    CHECK(fresh.transfer.version(TransferKind::MODEL) == 2);
+    CHECK(holds(updated.transfer, new_model));
+    CHECK(holds(fresh.transfer, new_model));
+
+    TransferKind kind;
+    uint32_t version;
+    CHECK(updated.transfer.takeCompleted(kind, version));
+    CHECK(kind == TransferKind::MODEL && version == 2);
+    CHECK(!updated.transfer.takeCompleted(kind, version));
+
+    // The node with version 1 copied all but the changed chunks; the new
+    // node found nothing locally
+    const MeshTransferStats& reused = updated.transfer.stats();
+    CHECK(reused.deduplicated_bytes + 2 * ChunkerParams().max_size >= new_model.size());
+    CHECK(reused.deduplicated_bytes < new_model.size());
+    CHECK(reused.verify_failures == 0);
+    CHECK(fresh.transfer.stats().deduplicated_bytes == 0);
+    CHECK(fresh.transfer.stats().completed == 1);
+}
+
+void testWrongKey() {
+    // An advertiser without our key: its header fails, nothing installed
+    std::vector<uint8_t> model = randomBytes(5000, 3);
+    Node server(1);
+    Node client(2);
+    MeshTransfer::Key key = KEY;
+    key[15] ^= 0x80;
+    server.transfer.setKey(key);
+    client.transfer.setKey(KEY);
+    server.transfer.setFile(TransferKind::MODEL, 4, model.data(), model.size());
+
+    Clock::time_point now = Clock::time_point() + std::chrono::hours(1);
+    server.transfer.start(now);
+    client.transfer.start(now);
+    run({&server, &client}, now, std::chrono::minutes(2), []() { return false; });
+    CHECK(client.transfer.stats().verify_failures > 0);
+    CHECK(client.transfer.stats().completed == 0);
+    CHECK(client.transfer.version(TransferKind::MODEL) == 0);
+    CHECK(client.transfer.progress(TransferKind::MODEL).packets == 0);
+}
+
+void testBadFile() {
+    // A valid header over altered file bytes: fetched in full, rejected
+    // at the end, and that version is not fetched again
+    std::vector<uint8_t> model = randomBytes(3000, 4);
+    std::vector<uint8_t> object = MeshTransfer::buildObject(TransferKind::MODEL, 7, model.data(),
+                                                            model.size(), KEY);
+    object.back() ^= 1;
+
+    Node client(2);
+    client.transfer.setKey(KEY);
+    Clock::time_point now = Clock::time_point() + std::chrono::hours(1);
+    client.transfer.start(now);
+
+    uint8_t advert[8] = {7, 0, 0, 0, 0, 0, 0, 0};
+    client.transfer.receive(MeshTransfer::FRAME_ADVERT, 1, false, advert, sizeof(advert), now);
+    CHECK(client.transfer.progress(TransferKind::MODEL).version == 7);
+
+    size_t packets = (object.size() + MeshTransfer::PACKET_SIZE - 1) / MeshTransfer::PACKET_SIZE;
+    for (size_t p = 0; p < packets; p++) {
+        size_t len = std::min(MeshTransfer::PACKET_SIZE, object.size() - p * MeshTransfer::PACKET_SIZE);
+        uint8_t frame[MeshTransfer::MAX_FRAME_PAYLOAD] = {0, 7, 0, 0, 0,
+                                                          static_cast<uint8_t>(p),
+                                                          static_cast<uint8_t>(p >> 8), 0};
+        std::copy(object.begin() + p * MeshTransfer::PACKET_SIZE,
+                  object.begin() + p * MeshTransfer::PACKET_SIZE + len,
+                  frame + MeshTransfer::FRAME_HEADER);
+        client.transfer.receive(MeshTransfer::FRAME_DATA, 1, false, frame,
+                                MeshTransfer::FRAME_HEADER + len, now);
+    }
+    CHECK(client.transfer.stats().data_received == packets);
+    CHECK(client.transfer.stats().verify_failures == 1);
+    CHECK(client.transfer.stats().completed == 0);
+    CHECK(client.transfer.version(TransferKind::MODEL) == 0);
+    CHECK(client.transfer.progress(TransferKind::MODEL).version == 0);
+
+    client.transfer.receive(MeshTransfer::FRAME_ADVERT, 1, false, advert, sizeof(advert), now);
+    CHECK(client.transfer.progress(TransferKind::MODEL).version == 0);
+}
+
+} // namespace
+
+int main() {
+    testKey();
+    testObject();
+    testFetch();
+    testWrongKey();
+    testBadFile();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,105 @@
+// MpscQueue: FIFO order, a full queue refusing pushes, wrap-around, and
+// every value from concurrent producers popped once, in each producer's
+// order
+
+#include "utils/mpsc_queue.h"
+#include "test_check.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+void testSingleThread() {
+    MpscQueue<int, 4> queue;
+    int value = -1;
+    CHECK(queue.capacity() == 4);
+    CHECK(queue.size() == 0);
+    CHECK(!queue.pop(value));
+
+    for (int i = 0; i < 4; i++) {
+        CHECK(queue.push(i));
+    }
+    CHECK(queue.size() == 4);
+    CHECK(!queue.push(4));
+
+    CHECK(queue.pop(value) && value == 0);
+    CHECK(queue.push(4));                // The freed slot is usable again
+    for (int expected = 1; expected <= 4; expected++) {
+        CHECK(queue.pop(value) && value == expected);
+    }
+    CHECK(!queue.pop(value));
+    CHECK(queue.size() == 0);
+
+    // Many laps around the ring
+    bool ordered = true;
+    for (int i = 0; i < 1000; i++) {
+        ordered = ordered && queue.push(i) && queue.push(-i);
+        int first = 0;
+        int second = 0;
+        ordered = ordered && queue.pop(first) && queue.pop(second) && first == i && second == -i;
+    }
+    CHECK(ordered);
+}
+
+void testProducers() {
+    constexpr int PRODUCERS = 4;
+    constexpr uint32_t PER_PRODUCER = 100000;
+
+    // Producer in the top byte, sequence number below
+    MpscQueue<uint32_t, 64> queue;
+    std::atomic<int> running(PRODUCERS);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&queue, &running, p]() {
+            for (uint32_t i = 0; i < PER_PRODUCER; i++) {
+                uint32_t value = (static_cast<uint32_t>(p) << 24) | i;
+                while (!queue.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    bool ordered = true;
+    uint64_t popped = 0;
+    uint32_t value;
+    for (;;) {
+        bool done = running.load() == 0;
+        while (queue.pop(value)) {
+            uint32_t producer = value >> 24;
+            ordered = ordered && producer < PRODUCERS && (value & 0xFFFFFF) == next[producer];
+            if (producer < PRODUCERS) {
+                next[producer] = (value & 0xFFFFFF) + 1;
+            }
+            popped++;
+        }
+        if (done) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+    for (std::thread& thread : producers) {
+        thread.join();
+    }
+
+    CHECK(ordered);
+    CHECK(popped == static_cast<uint64_t>(PRODUCERS) * PER_PRODUCER);
+    for (int p = 0; p < PRODUCERS; p++) {
+        CHECK(next[p] == PER_PRODUCER);
+    }
+    CHECK(queue.size() == 0);
+}
+
+} // namespace
+
+int main() {
+    testSingleThread();
+    testProducers();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,165 @@
+// PlumeTracker: pooling, union-find labelling of shapes whose parts only
+// meet late in the raster pass, blob statistics, and tracks that keep
+// their id, grow and age out
+
+#include "vision/plume_tracker.h"
+#include "test_check.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int SIZE = 16;
+
+// One mask pixel per cell; '#' is smoke
+std::vector<float> draw(const std::vector<std::string>& rows) {
+    std::vector<float> mask(SIZE * SIZE, 0.0f);
+    for (size_t y = 0; y < rows.size(); y++) {
+        for (size_t x = 0; x < rows[y].size(); x++) {
+            if (rows[y][x] == '#') {
+                mask[y * SIZE + x] = 0.9f;
+            }
+        }
+    }
+    return mask;
+}
+
+PlumeTrackerConfig cellConfig() {
+    PlumeTrackerConfig config;
+    config.grid = SIZE;
+    return config;
+}
+
+void testPool() {
+    // 32x32 onto 16x16: 2x2 pixels per cell, channel 1 of two
+    PlumeTrackerConfig config = cellConfig();
+    config.threshold = 0.2f;
+    PlumeTracker tracker(config);
+    std::vector<float> mask(32 * 32 * 2, 0.0f);
+    mask[(4 * 32 + 4) * 2 + 1] = 1.0f;
+    mask[(4 * 32 + 5) * 2 + 1] = 1.0f;
+    mask[(4 * 32 + 6) * 2] = 1.0f;         // Channel 0: not smoke
+    CHECK_NEAR(tracker.update(mask.data(), 32, 32, 2, Clock::time_point()), 0.5f, 1e-6f);
+
+    // A 2x1-pixel blob is one cell: below min_cells
+    CHECK(tracker.tracks().empty());
+    CHECK(tracker.primary() == nullptr);
+
+    // Bad input
+    CHECK(tracker.update(nullptr, 32, 32, 2, Clock::time_point()) == 0.0f);
+}
+
+void testLabels() {
+    PlumeTracker tracker(cellConfig());
+    Clock::time_point now;
+
+    // A comb: three arms labelled apart on the way down and joined by the
+    // bottom row, a diagonal rising to the right (joined through the
+    // north-east neighbour), a separate bar, and a single-cell speck
+    std::vector<float> mask = draw({
+        "................",
+        ".#.#.#......#...",
+        ".#.#.#.....#....",
+        ".#.#.#....#.....",
+        ".#####...#......",
+        "................",
+        "................",
+        "..####.......#..",
+        "................",
+    });
+    tracker.update(mask.data(), SIZE, SIZE, 1, now);
+    const std::vector<PlumeTrack>& tracks = tracker.tracks();
+    CHECK(tracks.size() == 3);
+
+    const PlumeTrack* comb = nullptr;
+    const PlumeTrack* diagonal = nullptr;
+    const PlumeTrack* bar = nullptr;
+    for (const PlumeTrack& track : tracks) {
+        int cells = static_cast<int>(track.area * SIZE * SIZE + 0.5f);
+        if (cells == 14) {
+            comb = &track;
+        } else if (cells == 4 && track.y0 < 0.1f) {
+            diagonal = &track;
+        } else if (cells == 4) {
+            bar = &track;
+        }
+    }
+    CHECK(comb && diagonal && bar);
+    if (comb && diagonal && bar) {
+        // Statistics of all merged labels, in fractions of the frame
+        CHECK_NEAR(comb->x0, 1.0f / SIZE, 1e-6f);
+        CHECK_NEAR(comb->x1, 6.0f / SIZE, 1e-6f);
+        CHECK_NEAR(comb->y0, 1.0f / SIZE, 1e-6f);
+        CHECK_NEAR(comb->y1, 5.0f / SIZE, 1e-6f);
+        CHECK_NEAR(comb->peak, 0.9f, 1e-6f);
+        CHECK_NEAR(diagonal->x0, 9.0f / SIZE, 1e-6f);
+        CHECK_NEAR(diagonal->x1, 13.0f / SIZE, 1e-6f);
+        CHECK_NEAR(bar->centroid_x, 4.0f / SIZE, 1e-6f);
+        CHECK_NEAR(bar->centroid_y, 7.5f / SIZE, 1e-6f);
+        CHECK(tracker.primary() == comb);
+    }
+}
+
+void testTracks() {
+    PlumeTrackerConfig config = cellConfig();
+    config.growth_frames = 3;
+    config.max_missed = 2;
+    PlumeTracker tracker(config);
+    Clock::time_point now;
+
+    // A blob widening by a column per frame keeps its track and grows
+    uint32_t id = 0;
+    for (int frame = 0; frame < 5; frame++) {
+        std::string row = "....";
+        row.append(2 + frame, '#');
+        tracker.update(draw({"", "", "", row, row}).data(), SIZE, SIZE, 1, now);
+        CHECK(tracker.tracks().size() == 1);
+        const PlumeTrack* plume = tracker.primary();
+        CHECK(plume != nullptr);
+        if (!plume) {
+            return;
+        }
+        if (frame == 0) {
+            id = plume->id;
+        }
+        CHECK(plume->id == id);
+        CHECK(plume->frames == frame + 1);
+        CHECK(plume->growing_frames == frame);
+        CHECK(tracker.isPersistent(*plume) == (frame >= config.growth_frames));
+        if (frame > 0) {
+            CHECK(plume->growth_rate > 0.0f);
+        }
+        now += std::chrono::milliseconds(500);
+    }
+
+    // Gone: kept for max_missed frames without a primary, then dropped
+    std::vector<float> empty(SIZE * SIZE, 0.0f);
+    for (int frame = 1; frame <= config.max_missed; frame++) {
+        tracker.update(empty.data(), SIZE, SIZE, 1, now);
+        CHECK(tracker.tracks().size() == 1 && tracker.tracks()[0].missed == frame);
+        CHECK(tracker.tracks()[0].growing_frames == 0);
+        CHECK(tracker.primary() == nullptr);
+        now += std::chrono::milliseconds(500);
+    }
+    tracker.update(empty.data(), SIZE, SIZE, 1, now);
+    CHECK(tracker.tracks().empty());
+
+    // A new blob far away is a new track
+    tracker.update(draw({"", "", "", "", "", "", "", "", "", "", "", "", "###########"}).data(),
+                   SIZE, SIZE, 1, now);
+    CHECK(tracker.tracks().size() == 1 && tracker.tracks()[0].id == id + 1);
+}
+
+} // namespace
+
+int main() {
+    testPool();
+    testLabels();
+    testTracks();
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,212 @@
+// StateSnapshot: sections written only when changed, alternating slots
+// with the newest valid one read back, a corrupt slot falling back to the
+// other copy, the age limit, and state from another node or boot ignored
+
+#include "core/state_snapshot.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+
+namespace {
+
+using std::chrono::milliseconds;
+
+constexpr uint8_t NODE = 7;
+const milliseconds FRESH(60000);
+
+std::vector<char> load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), {});
+}
+
+void store(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Flip the first byte of where part occurs in the file; false if it does not
+bool corrupt(const std::string& path, const void* part, size_t len) {
+    std::vector<char> bytes = load(path);
+    const char* begin = static_cast<const char*>(part);
+    auto it = std::search(bytes.begin(), bytes.end(), begin, begin + len);
+    if (it == bytes.end()) {
+        return false;
+    }
+    *it ^= 0x5A;
+    store(path, bytes);
+    return true;
+}
+
+CalibrationRecord calibration(float r0) {
+    CalibrationRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.r0 = r0;
+    record.offset = 0.25f;
+    record.calibration_time_ms = 1234567;
+    return record;
+}
+
+// r0 of the calibration the previous process left, 0 if none
+float previousR0(const std::string& path, uint8_t node = NODE, milliseconds max_age = FRESH) {
+    StateSnapshot state(path, node);
+    CalibrationRecord record;
+    if (!state.open() ||
+        state.read(StateSection::CALIBRATION, &record, sizeof(record), max_age) !=
+            sizeof(record)) {
+        return 0.0f;
+    }
+    return record.r0;
+}
+
+void testWrites(const std::string& path) {
+    StateSnapshot state(path, NODE);
+    CHECK(state.open());
+    CHECK(!state.hasPreviousState());
+
+    // Unchanged contents are not written again
+    CalibrationRecord first = calibration(9.5f);
+    CHECK(state.write(StateSection::CALIBRATION, &first, sizeof(first)));
+    CHECK(!state.write(StateSection::CALIBRATION, &first, sizeof(first)));
+
+    // Only state from a previous process is read
+    CalibrationRecord out;
+    CHECK(state.read(StateSection::CALIBRATION, &out, sizeof(out), FRESH) == 0);
+    state.flush();
+    state.close();
+
+    StateSnapshot next(path, NODE);
+    CHECK(next.open());
+    CHECK(next.hasPreviousState());
+    CHECK(next.read(StateSection::CALIBRATION, &out, sizeof(out), FRESH) == sizeof(out));
+    CHECK(out.r0 == 9.5f && out.offset == 0.25f && out.calibration_time_ms == 1234567);
+
+    // Never written
+    AlertRecord alert;
+    CHECK(next.read(StateSection::ALERT, &alert, sizeof(alert), FRESH) == 0);
+}
+
+void testSlots(const std::string& path) {
+    CalibrationRecord older = calibration(11.0f);
+    CalibrationRecord newer = calibration(12.0f);
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        CHECK(state.write(StateSection::CALIBRATION, &older, sizeof(older)));
+        CHECK(state.write(StateSection::CALIBRATION, &newer, sizeof(newer)));
+    }
+    CHECK(previousR0(path) == 12.0f);
+
+    // A torn write of the newer slot: its CRC fails, the older copy is used
+    CHECK(corrupt(path, &newer.r0, sizeof(newer.r0)));
+    CHECK(previousR0(path) == 11.0f);
+
+    // The next write goes to the slot with the older sequence number
+    CalibrationRecord third = calibration(13.0f);
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        CHECK(state.write(StateSection::CALIBRATION, &third, sizeof(third)));
+    }
+    CHECK(previousR0(path) == 13.0f);
+
+    // Both bad: nothing
+    CHECK(corrupt(path, &third.r0, sizeof(third.r0)));
+    CHECK(previousR0(path) == 0.0f);
+}
+
+void testAge(const std::string& path) {
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        CalibrationRecord record = calibration(14.0f);
+        CHECK(state.write(StateSection::CALIBRATION, &record, sizeof(record)));
+    }
+    std::this_thread::sleep_for(milliseconds(300));
+    CHECK(previousR0(path, NODE, milliseconds(150)) == 0.0f);
+    CHECK(previousR0(path, NODE, FRESH) == 14.0f);
+
+    // A flush vouches for unchanged sections
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        state.flush();
+    }
+    CHECK(previousR0(path, NODE, milliseconds(150)) == 14.0f);
+}
+
+void testOwnership(const std::string& path) {
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        CalibrationRecord record = calibration(15.0f);
+        CHECK(state.write(StateSection::CALIBRATION, &record, sizeof(record)));
+    }
+    CHECK(previousR0(path) == 15.0f);
+
+    // Another boot: the recorded boot id no longer matches
+    std::ifstream boot_file("/proc/sys/kernel/random/boot_id");
+    std::string boot_id;
+    std::getline(boot_file, boot_id);
+    if (boot_id.empty()) {
+        std::fprintf(stderr, "No boot id: skipping the reboot check\n");
+    } else {
+        CHECK(corrupt(path, boot_id.data(), boot_id.size()));
+        CHECK(previousR0(path) == 0.0f);
+    }
+
+    // Another node: ignored, and the file is reset for the new owner
+    {
+        StateSnapshot state(path, NODE);
+        CHECK(state.open());
+        CalibrationRecord record = calibration(16.0f);
+        CHECK(state.write(StateSection::CALIBRATION, &record, sizeof(record)));
+    }
+    CHECK(previousR0(path, NODE + 1) == 0.0f);
+    CHECK(previousR0(path, NODE) == 0.0f);
+
+    // A file of the wrong size is replaced
+    std::vector<char> bytes = load(path);
+    bytes.resize(bytes.size() / 2);
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    StateSnapshot state(path, NODE);
+    CHECK(state.open());
+    CHECK(!state.hasPreviousState());
+}
+
+} // namespace
+
+int main() {
+    // Discarded files are logged at INFO
+    Logger::setLevel(LogLevel::WARN);
+
+    char dir[] = "/tmp/sentinel-state-XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string path = std::string(dir) + "/state.bin";
+
+    testWrites(path);
+    std::remove(path.c_str());
+    testSlots(path);
+    std::remove(path.c_str());
+    testAge(path);
+    std::remove(path.c_str());
+    testOwnership(path);
+    std::remove(path.c_str());
+    rmdir(dir);
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,47 @@
+#ifndef SENTINEL_TEST_CHECK_H
+#define SENTINEL_TEST_CHECK_H
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks for the unit tests. A failed CHECK is reported and
+// counted, the test carries on, and main() returns testResult().
+
+namespace sentinel_test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int testResult() {
+    if (failures() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace sentinel_test
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                         #condition);                                           \
+            sentinel_test::failures()++;                                        \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance)                                  \
+    do {                                                                        \
+        double check_value = (value);                                           \
+        double check_expected = (expected);                                     \
+        if (std::fabs(check_value - check_expected) > (tolerance)) {            \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %g, expected %g\n", \
+                         __FILE__, __LINE__, #value, check_value, check_expected); \
+            sentinel_test::failures()++;                                        \
+        }                                                                       \
+    } while (0)
+
+#endif // SENTINEL_TEST_CHECK_H
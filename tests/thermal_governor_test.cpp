@@ -0,0 +1,219 @@
+// ThermalGovernor against a fake sysfs tree: steps down when hot, slow or
+// throttled, holds inside the hysteresis band and steps back up only after
+// the step-up dwell.
+
+#include "core/thermal_governor.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace sentinel;
+
+namespace {
+
+std::string g_root;
+
+void makeDirs(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+        if (slash == std::string::npos) {
+            break;
+        }
+    }
+}
+
+// Written to a temporary name and renamed, so a poll never sees half a file
+void writeFile(const std::string& relative, const std::string& text) {
+    std::string path = g_root + "/" + relative;
+    makeDirs(path.substr(0, path.rfind('/')));
+    std::string tmp = path + ".tmp";
+    FILE* file = std::fopen(tmp.c_str(), "w");
+    if (!file) {
+        std::perror(tmp.c_str());
+        std::exit(2);
+    }
+    std::fprintf(file, "%s\n", text.c_str());
+    std::fclose(file);
+    std::rename(tmp.c_str(), path.c_str());
+}
+
+void setTemp(int temp_mc) {
+    writeFile("class/thermal/thermal_zone0/temp", std::to_string(temp_mc));
+}
+
+void setFreq(int cpu, int cur_khz, int max_khz) {
+    std::string dir = "devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/";
+    writeFile(dir + "scaling_cur_freq", std::to_string(cur_khz));
+    writeFile(dir + "scaling_max_freq", std::to_string(max_khz));
+}
+
+void setFirmwareThrottled(unsigned flags) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "0x%x", flags);
+    writeFile("devices/platform/soc/soc:firmware/get_throttled", text);
+}
+
+// Until the governor's poll has published the expected reading
+bool waitFor(const ThermalGovernor& governor, int temp_mc, bool throttled) {
+    for (int i = 0; i < 500; i++) {
+        ThermalReading reading = governor.reading();
+        if (reading.temp_mc == temp_mc && reading.throttled == throttled) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return false;
+}
+
+void testReadSysfs() {
+    setTemp(48000);
+    writeFile("class/thermal/thermal_zone1/temp", "52500");
+    writeFile("class/thermal/cooling_device0/temp", "99000");     // Not a zone
+    setFreq(0, 1500000, 1500000);
+    setFreq(1, 600000, 1500000);
+
+    std::vector<int> max_freq;
+    ThermalReading reading = ThermalGovernor::readSysfs(g_root, max_freq);
+    CHECK(reading.temp_mc == 52500);            // Hottest zone
+    CHECK(reading.cur_freq_khz == 600000);      // Slowest CPU
+    CHECK(!reading.throttled);
+    CHECK(max_freq.size() == 2 && max_freq[1] == 1500000);
+
+    // A lower policy maximum than at the first read is throttling; an
+    // administrator's cap present from the start is not
+    setFreq(1, 600000, 1200000);
+    CHECK(ThermalGovernor::readSysfs(g_root, max_freq).throttled);
+    std::vector<int> fresh;
+    CHECK(!ThermalGovernor::readSysfs(g_root, fresh).throttled);
+    setFreq(1, 600000, 1500000);
+
+    std::remove((g_root + "/class/thermal/thermal_zone1/temp").c_str());
+    std::vector<int> none;
+    CHECK(ThermalGovernor::readSysfs(g_root + "/missing", none).temp_mc == INT_MIN);
+}
+
+void testLadder() {
+    GovernorConfig config;
+    config.sysfs_root = g_root;
+    config.max_temp_c = 75.0f;
+    config.temp_hysteresis_c = 5.0f;
+    config.target_latency_ms = 150.0f;
+    config.latency_hysteresis_pct = 30;
+    config.poll_interval_ms = 5;
+    config.step_down_sec = 4;
+    config.step_up_sec = 30;
+
+    // Levels: 0 {4 fps, 2x2}, 1 {4 fps, 1x1}, 2 {2 fps}, 3 {1 fps},
+    // 4 {1 thread}
+    VisionQuality best = {4, 2, false, 2};
+    ThermalGovernor governor(config, best, false);
+    CHECK(governor.levels() == 5);
+
+    setTemp(60000);
+    setFreq(0, 1500000, 1500000);
+    governor.start();
+    CHECK(waitFor(governor, 60000, false));
+
+    auto t0 = ThermalGovernor::Clock::now();
+    auto at = [t0](int seconds) { return t0 + std::chrono::seconds(seconds); };
+    governor.recordFrame(50.0f);
+    CHECK(!governor.update(at(0)));
+    CHECK(governor.level() == 0);
+
+    // 81 C: above max_temp_c
+    setTemp(81000);
+    CHECK(waitFor(governor, 81000, false));
+    governor.recordFrame(50.0f);
+    CHECK(governor.update(at(5)));
+    CHECK(governor.level() == 1);
+
+    // 72 C: cooler, but inside the hysteresis band
+    setTemp(72000);
+    CHECK(waitFor(governor, 72000, false));
+    governor.recordFrame(50.0f);
+    CHECK(!governor.update(at(20)));
+    CHECK(governor.level() == 1);
+
+    // 60 C: comfortably cool, but only after step_up_sec at the level
+    setTemp(60000);
+    CHECK(waitFor(governor, 60000, false));
+    governor.recordFrame(50.0f);
+    CHECK(!governor.update(at(30)));
+    governor.recordFrame(50.0f);
+    CHECK(governor.update(at(36)));
+    CHECK(governor.level() == 0);
+
+    // 400 ms per frame: lighter frames, then a lower frame rate while
+    // frames take longer than the frame interval (250 ms at 4 fps, 500 ms
+    // at 2 fps), never fewer threads
+    governor.recordFrame(400.0f);
+    CHECK(governor.update(at(41)));
+    CHECK(governor.level() == 1);
+    governor.recordFrame(400.0f);
+    CHECK(governor.update(at(46)));
+    CHECK(governor.level() == 2);
+    CHECK(governor.quality().fps == 2);
+    governor.recordFrame(400.0f);
+    CHECK(!governor.update(at(51)));
+    CHECK(governor.level() == 2);
+
+    // cpufreq capped below its initial maximum at 60 C
+    setFreq(0, 1000000, 1000000);
+    CHECK(waitFor(governor, 60000, true));
+    governor.recordFrame(50.0f);
+    CHECK(governor.update(at(56)));
+    CHECK(governor.level() == 3);
+
+    // Firmware throttling alone; heat may shed threads
+    setFreq(0, 1500000, 1500000);
+    setFirmwareThrottled(0x4);
+    CHECK(waitFor(governor, 60000, true));
+    governor.recordFrame(50.0f);
+    CHECK(governor.update(at(61)));
+    CHECK(governor.level() == 4);
+    CHECK(governor.quality().threads == 1);
+
+    // Past the bottom of the ladder nothing changes
+    governor.recordFrame(50.0f);
+    CHECK(!governor.update(at(66)));
+
+    // A new sysfs root restarts polling there
+    setFirmwareThrottled(0);
+    GovernorConfig moved = config;
+    moved.sysfs_root = g_root + "/missing";
+    governor.applyConfig(moved, best, false);
+    CHECK(waitFor(governor, INT_MIN, false));
+
+    governor.stop();
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::WARN);
+
+    char root[] = "/tmp/sentinel-governor-XXXXXX";
+    if (!mkdtemp(root)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    g_root = root;
+
+    Executor::start(1);
+    testReadSysfs();
+    testLadder();
+    Executor::stop();
+
+    std::string remove = "rm -rf '" + g_root + "'";
+    if (std::system(remove.c_str()) != 0) {
+        std::fprintf(stderr, "Failed to remove %s\n", g_root.c_str());
+    }
+    return sentinel_test::testResult();
+}
@@ -0,0 +1,231 @@
+// TrickleTimer: interval doubling, transmission points, suppression and
+// the silence bound; the peer timeout it leads to, and detections that
+// expire sooner than the peer
+
+#include "network/lora_mesh.h"
+#include "network/trickle_timer.h"
+#include "utils/executor.h"
+#include "utils/logger.h"
+#include "test_check.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace sentinel;
+using Clock = TrickleTimer::Clock;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+
+// From the start of an interval: hears `heard` consistent announcements,
+// runs to the transmission point (now) and returns what the timer did
+// there, then runs on to the start of the next interval
+TrickleTimer::Action nextPoint(TrickleTimer& timer, Clock::time_point& now, int heard) {
+    for (int i = 0; i < heard; i++) {
+        timer.hearConsistent();
+    }
+    now = timer.nextDue();
+    TrickleTimer::Action action = timer.poll(now);
+    timer.poll(timer.nextDue());
+    return action;
+}
+
+void testDoubling() {
+    TrickleTimer timer(7);
+    timer.configure(seconds(1), seconds(10), 0, 0);
+    Clock::time_point t0 = Clock::now();
+    timer.start(t0);
+    CHECK(timer.interval() == seconds(1));
+
+    // One transmission per interval, in its second half; I doubles up to
+    // imax, which is rounded down to 8 s
+    Clock::time_point start = t0;
+    Clock::duration expected[] = {seconds(1), seconds(2), seconds(4), seconds(8), seconds(8),
+                                  seconds(8)};
+    for (Clock::duration interval : expected) {
+        CHECK(timer.interval() == interval);
+        Clock::time_point due = timer.nextDue();
+        CHECK(due >= start + interval / 2 && due < start + interval);
+        CHECK(timer.poll(due - milliseconds(1)) == TrickleTimer::Action::NONE);
+        CHECK(timer.poll(due) == TrickleTimer::Action::TRANSMIT);
+        CHECK(timer.poll(due) == TrickleTimer::Action::NONE);
+
+        // Then the interval end, where the next one starts
+        CHECK(timer.nextDue() == start + interval);
+        timer.poll(start + interval);
+        start += interval;
+    }
+    CHECK(timer.transmitted() == 6);
+    CHECK(timer.suppressed() == 0);
+
+    // Polled late: one transmission covers the points that passed
+    CHECK(timer.poll(start + seconds(100)) == TrickleTimer::Action::TRANSMIT);
+    CHECK(timer.interval() == seconds(8));
+
+    // An inconsistency goes back to imin, once
+    Clock::time_point now = start + seconds(101);
+    timer.reset(now);
+    CHECK(timer.interval() == seconds(1));
+    CHECK(timer.resets() == 1);
+    timer.reset(now);
+    CHECK(timer.resets() == 1);
+    CHECK(timer.nextDue() >= now + milliseconds(500) && timer.nextDue() < now + seconds(1));
+}
+
+void testSuppression() {
+    TrickleTimer timer(11);
+    timer.configure(seconds(1), seconds(8), 2, 3);
+    Clock::time_point now = Clock::now();
+    timer.start(now);
+
+    // Fewer than `redundancy` announcements heard: transmit
+    CHECK(nextPoint(timer, now, 1) == TrickleTimer::Action::TRANSMIT);
+
+    // Enough heard: suppressed, but never more than max_suppressed
+    // intervals in a row
+    std::vector<TrickleTimer::Action> actions;
+    for (int i = 0; i < 8; i++) {
+        actions.push_back(nextPoint(timer, now, 2));
+    }
+    const TrickleTimer::Action S = TrickleTimer::Action::SUPPRESS;
+    const TrickleTimer::Action T = TrickleTimer::Action::TRANSMIT;
+    std::vector<TrickleTimer::Action> expected = {S, S, S, T, S, S, S, T};
+    CHECK(actions == expected);
+    CHECK(timer.suppressed() == 6);
+    CHECK(timer.transmitted() == 3);
+
+    // Announcements heard in an earlier interval do not count
+    CHECK(nextPoint(timer, now, 0) == TrickleTimer::Action::TRANSMIT);
+}
+
+void testSilenceBound() {
+    TrickleTimer timer(3);
+    timer.configure(seconds(1), seconds(8), 2, 3);
+    CHECK(timer.silenceBound() == seconds(36));        // (3 + 1.5) * 8 s
+
+    // Without suppression: sent early in one interval, late in the next
+    timer.configure(seconds(1), seconds(8), 0, 3);
+    CHECK(timer.silenceBound() == seconds(12));
+
+    // Always suppressed where allowed: no gap between transmissions
+    // exceeds the bound
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        TrickleTimer busy(seed);
+        busy.configure(seconds(1), seconds(8), 1, 3);
+        Clock::time_point now = Clock::now();
+        busy.start(now);
+        Clock::time_point last = now;
+        Clock::duration longest(0);
+        for (int i = 0; i < 200; i++) {
+            if (nextPoint(busy, now, 1) == TrickleTimer::Action::TRANSMIT) {
+                longest = std::max(longest, now - last);
+                last = now;
+            }
+        }
+        CHECK(longest <= busy.silenceBound());
+    }
+}
+
+void testSeeds() {
+    Clock::time_point now = Clock::now();
+    TrickleTimer a(42);
+    TrickleTimer b(42);
+    TrickleTimer c(43);
+    for (TrickleTimer* timer : {&a, &b, &c}) {
+        timer->configure(seconds(30), seconds(120), 0, 0);
+        timer->start(now);
+    }
+    // Reproducible per seed, different between neighbours
+    CHECK(a.nextDue() == b.nextDue());
+    CHECK(a.nextDue() != c.nextDue());
+}
+
+void testPeerTimeout() {
+    // Shipped settings: a 300 s silence bound, so a dead peer is listed for
+    // at most two bounds plus node_timeout_sec rather than three bounds
+    LoraConfig config;
+    TrickleTimer timer;
+    timer.configure(seconds(config.heartbeat_interval_sec),
+                    seconds(config.heartbeat_max_interval_sec), config.heartbeat_redundancy,
+                    LoraMesh::MAX_SUPPRESSED_HEARTBEATS);
+    CHECK(timer.silenceBound() == seconds(300));
+    CHECK(LoraMesh::peerTimeout(config.node_timeout_sec, config.heartbeat_interval_sec, 300) ==
+          seconds(690));
+
+    // Short bounds scale, unknown ones get node_timeout_sec
+    CHECK(LoraMesh::peerTimeout(90, 30, 45) == seconds(135));
+    CHECK(LoraMesh::peerTimeout(90, 30, 0) == seconds(90));
+    CHECK(LoraMesh::peerTimeout(90, 30, 20) == seconds(90));
+}
+
+void testDetectionExpiry() {
+    LoraConfig config;
+    config.join_slots = 0;
+    config.heartbeat_interval_sec = 1;
+    config.heartbeat_max_interval_sec = 4;
+    config.heartbeat_redundancy = 0;
+    config.node_timeout_sec = 3;
+
+    // A detecting peer with a long silence bound, last heard 2 s ago: still
+    // listed long after its detection has expired
+    LoraMesh mesh(1, config);
+    std::vector<NodeInfo> nodes(1);
+    nodes[0].node_id = 5;
+    nodes[0].detecting = true;
+    nodes[0].last_seen = std::chrono::steady_clock::now() - seconds(2);
+    nodes[0].rssi = 0;
+    nodes[0].silence_bound_sec = 100;
+    mesh.restoreNodes(nodes);
+    std::atomic<int> cleared(0);
+    mesh.setDetectionCallback([&](uint8_t node_id, bool detected) {
+        cleared += node_id == 5 && !detected;
+    });
+    CHECK(mesh.initialize());
+    CHECK(mesh.getDetectingNodeCount() == 1);
+
+    auto end = std::chrono::steady_clock::now() + seconds(4);
+    while (mesh.getDetectingNodeCount() > 0 && std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(milliseconds(20));
+    }
+    mesh.processMessages();
+    CHECK(mesh.getDetectingNodeCount() == 0);
+    CHECK(mesh.getActiveNodeCount() == 1);
+    CHECK(cleared == 1);
+    mesh.shutdown();
+
+    // Our own heartbeats stay at the shortest interval while detecting:
+    // once the quiet node is at 4 s, the detecting one still sends every
+    // second
+    LoraMesh detecting(2, config);
+    LoraMesh quiet(3, config);
+    CHECK(detecting.initialize());
+    CHECK(quiet.initialize());
+    detecting.broadcastDetection(true);
+    std::this_thread::sleep_for(seconds(3));
+    uint64_t detecting_before = detecting.getAirtimeStats().heartbeats_sent;
+    uint64_t quiet_before = quiet.getAirtimeStats().heartbeats_sent;
+    std::this_thread::sleep_for(seconds(4));
+    CHECK(detecting.getAirtimeStats().heartbeats_sent - detecting_before >= 3);
+    CHECK(quiet.getAirtimeStats().heartbeats_sent - quiet_before <= 2);
+    detecting.shutdown();
+    quiet.shutdown();
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::WARN);
+
+    testDoubling();
+    testSuppression();
+    testSilenceBound();
+    testSeeds();
+    testPeerTimeout();
+
+    Executor::start(2);
+    testDetectionExpiry();
+    Executor::stop();
+    return sentinel_test::testResult();
+}